@@ -0,0 +1,107 @@
+/*
+ * Copyright (C) 2022 Samsung Electronics Co. LTD
+ *
+ * This software is a property of Samsung Electronics.
+ * No part of this software, either material or conceptual may be copied or distributed, transmitted,
+ * transcribed, stored in a retrieval system or translated into any human or computer language in any form by any means,
+ * electronic, mechanical, manual or otherwise, or disclosed
+ * to third parties without the express written permission of Samsung Electronics.
+ * (Use of the Software is restricted to non-commercial, personal or academic, research purpose only)
+ */
+
+#include <assert.h>
+#include <gtest/gtest.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <iostream>
+#include "half.hpp"
+#include "pim_runtime_api.h"
+#include "utility/pim_debug.hpp"
+
+using namespace std;
+using half_float::half;
+
+static uint16_t to_fp16_bits(float value)
+{
+    half h_value(value);
+    uint16_t bits;
+    memcpy(&bits, &h_value, sizeof(bits));
+    return bits;
+}
+
+/* relu((input0 + input1) * input2) * 0.5 + 1 as a single fused launch */
+int pim_elt_chain(uint32_t input_len)
+{
+    int ret = 0;
+
+    /* __PIM_API__ call : Initialize PimRuntime */
+    PimInitialize(RT_TYPE_HIP, PIM_FP16);
+
+    PimDesc* pim_desc = PimCreateDesc(1, 1, 1, input_len, PIM_FP16);
+
+    /* __PIM_API__ call : Create PIM Buffer Object */
+    PimBo* host_input0 = PimCreateBo(pim_desc, MEM_TYPE_HOST);
+    PimBo* host_input1 = PimCreateBo(pim_desc, MEM_TYPE_HOST);
+    PimBo* host_input2 = PimCreateBo(pim_desc, MEM_TYPE_HOST);
+    PimBo* host_output = PimCreateBo(pim_desc, MEM_TYPE_HOST);
+    PimBo* golden_output = PimCreateBo(pim_desc, MEM_TYPE_HOST);
+    PimBo* pim_input0 = PimCreateBo(pim_desc, MEM_TYPE_PIM);
+    PimBo* pim_input1 = PimCreateBo(pim_desc, MEM_TYPE_PIM);
+    PimBo* pim_input2 = PimCreateBo(pim_desc, MEM_TYPE_PIM);
+    PimBo* device_output = PimCreateBo(pim_desc, MEM_TYPE_PIM);
+
+    set_rand_half_data((half*)host_input0->data, (half)0.5, input_len);
+    set_rand_half_data((half*)host_input1->data, (half)0.5, input_len);
+    set_rand_half_data((half*)host_input2->data, (half)0.5, input_len);
+
+    half* in0 = (half*)host_input0->data;
+    half* in1 = (half*)host_input1->data;
+    half* in2 = (half*)host_input2->data;
+    half* golden = (half*)golden_output->data;
+    for (uint32_t i = 0; i < input_len; i++) {
+        half acc = (half)((in0[i] + in1[i]) * in2[i]);
+        golden[i] = (half)(std::max((float)acc, 0.0f) * 0.5f + 1.0f);
+    }
+
+    /* __PIM_API__ call : Copy input data from HOST to PIM */
+    PimCopyMemory(pim_input0, host_input0, HOST_TO_PIM);
+    PimCopyMemory(pim_input1, host_input1, HOST_TO_PIM);
+    PimCopyMemory(pim_input2, host_input2, HOST_TO_PIM);
+
+    PimEltChainStep steps[] = {{ELT_CHAIN_ADD, pim_input1, 0},
+                               {ELT_CHAIN_MUL, pim_input2, 0},
+                               {ELT_CHAIN_RELU, nullptr, 0},
+                               {ELT_CHAIN_MUL_SCALAR, nullptr, to_fp16_bits(0.5f)},
+                               {ELT_CHAIN_ADD_SCALAR, nullptr, to_fp16_bits(1.0f)}};
+
+    /* __PIM_API__ call : Execute the whole chain with one CRF program */
+    ret = PimExecuteEltChain(device_output, pim_input0, steps, sizeof(steps) / sizeof(steps[0]), nullptr, true);
+    if (ret != 0) {
+        printf("fail to execute elt chain\n");
+    } else {
+        PimCopyMemory(host_output, device_output, PIM_TO_HOST);
+        ret = compare_half_relative((half*)golden_output->data, (half*)host_output->data, input_len);
+    }
+
+    /* __PIM_API__ call : Free memory */
+    PimDestroyBo(host_input0);
+    PimDestroyBo(host_input1);
+    PimDestroyBo(host_input2);
+    PimDestroyBo(host_output);
+    PimDestroyBo(golden_output);
+    PimDestroyBo(pim_input0);
+    PimDestroyBo(pim_input1);
+    PimDestroyBo(pim_input2);
+    PimDestroyBo(device_output);
+    PimDestroyDesc(pim_desc);
+
+    /* __PIM_API__ call : Deinitialize PimRuntime */
+    PimDeinitialize();
+
+    return ret;
+}
+
+TEST(HIPIntegrationTest, PimEltChain1) { EXPECT_TRUE(pim_elt_chain(128 * 1024) == 0); }
+TEST(HIPIntegrationTest, PimEltChain2) { EXPECT_TRUE(pim_elt_chain(512 * 1024) == 0); }
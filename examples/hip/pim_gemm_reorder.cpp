@@ -0,0 +1,139 @@
+/*
+ * Copyright (C) 2022 Samsung Electronics Co. LTD
+ *
+ * This software is a property of Samsung Electronics.
+ * No part of this software, either material or conceptual may be copied or distributed, transmitted,
+ * transcribed, stored in a retrieval system or translated into any human or computer language in any form by any means,
+ * electronic, mechanical, manual or otherwise, or disclosed
+ * to third parties without the express written permission of Samsung Electronics.
+ * (Use of the Software is restricted to non-commercial, personal or academic, research purpose only)
+ */
+
+#include <gtest/gtest.h>
+#include <stdio.h>
+#include <string.h>
+#include <random>
+#include "pim_runtime_api.h"
+
+/* the device reorder kernels give the same bytes as the host converter */
+int pim_gemm_reorder_device_vs_host(int n, int c, int in_h, int in_w, int out_h, int out_w, PimGemmOrder gemm_order)
+{
+    int ret = 0;
+    PimGemmDesc* desc = PimCreateGemmDesc(n, c, in_h, in_w, out_h, out_w, PIM_FP16, gemm_order);
+    PimBo* h_w = PimCreateBo(desc, MEM_TYPE_HOST, GEMM_WEIGHT);
+    PimBo* d_w = PimCreateBo(desc, MEM_TYPE_DEVICE, GEMM_WEIGHT);
+
+    std::mt19937 gen(in_w * 31 + out_h);
+    uint16_t* data = (uint16_t*)h_w->data;
+    for (size_t i = 0; i < h_w->size / sizeof(uint16_t); i++) data[i] = (uint16_t)gen();
+    PimCopyMemory(d_w, h_w, HOST_TO_DEVICE);
+
+    PimBo* host_reordered = PimConvertGemmWeight(d_w, gemm_order, false);
+    PimBo* device_reordered = PimConvertGemmWeight(d_w, gemm_order, true);
+    if (host_reordered == nullptr || device_reordered == nullptr || host_reordered->size != device_reordered->size) {
+        printf("fail to reorder gemm weight\n");
+        ret = -1;
+    } else {
+        PimBShape* bs = &host_reordered->bshape;
+        PimBo* h_host = PimCreateBo(bs->n, bs->c, bs->h, bs->w, PIM_FP16, MEM_TYPE_HOST);
+        PimBo* h_device = PimCreateBo(bs->n, bs->c, bs->h, bs->w, PIM_FP16, MEM_TYPE_HOST);
+        PimCopyMemory(h_host, host_reordered, PIM_TO_HOST);
+        PimCopyMemory(h_device, device_reordered, PIM_TO_HOST);
+        if (memcmp(h_host->data, h_device->data, h_host->size) != 0) {
+            printf("device reordered weight differs from the host one\n");
+            ret = -1;
+        }
+        PimDestroyBo(h_host);
+        PimDestroyBo(h_device);
+    }
+
+    if (host_reordered != nullptr) PimDestroyBo(host_reordered);
+    if (device_reordered != nullptr) PimDestroyBo(device_reordered);
+    PimDestroyBo(h_w);
+    PimDestroyBo(d_w);
+    PimDestroyGemmDesc(desc);
+    return ret;
+}
+
+/* converting a weight to the PIM layout and restoring it gives back the raw weight */
+int pim_gemm_restore(int n, int c, int in_h, int in_w, int out_h, int out_w, PimGemmOrder gemm_order,
+                     bool restore_on_device)
+{
+    int ret = 0;
+    PimGemmDesc* desc = PimCreateGemmDesc(n, c, in_h, in_w, out_h, out_w, PIM_FP16, gemm_order);
+    PimBo* h_w = PimCreateBo(desc, MEM_TYPE_HOST, GEMM_WEIGHT);
+    PimBo* d_w = PimCreateBo(desc, MEM_TYPE_DEVICE, GEMM_WEIGHT);
+    PimBo* d_back = PimCreateBo(desc, MEM_TYPE_DEVICE, GEMM_WEIGHT);
+    PimBo* h_back = PimCreateBo(desc, MEM_TYPE_HOST, GEMM_WEIGHT);
+    PimBShape* bs_r = &h_w->bshape_r;
+    size_t packed_size = (size_t)bs_r->n * bs_r->c * bs_r->h * bs_r->w * sizeof(uint16_t);
+
+    std::mt19937 gen(in_w * 31 + out_h);
+    uint16_t* data = (uint16_t*)h_w->data;
+    memset(h_w->data, 0, h_w->size);
+    for (size_t i = 0; i < packed_size / sizeof(uint16_t); i++) data[i] = (uint16_t)gen();
+    PimCopyMemory(d_w, h_w, HOST_TO_DEVICE);
+
+    PimBo* reordered = PimConvertGemmWeight(d_w, gemm_order, restore_on_device);
+    if (reordered == nullptr || PimRestoreGemmWeight(d_back, reordered, gemm_order, restore_on_device) != 0 ||
+        PimRestoreGemmWeight(h_back, reordered, gemm_order, restore_on_device) != 0) {
+        printf("fail to restore gemm weight\n");
+        ret = -1;
+    } else {
+        PimBo* h_device = PimCreateBo(desc, MEM_TYPE_HOST, GEMM_WEIGHT);
+        PimCopyMemory(h_device, d_back, DEVICE_TO_HOST);
+        if (memcmp(h_w->data, h_device->data, packed_size) != 0 || memcmp(h_w->data, h_back->data, packed_size) != 0) {
+            printf("restored weight differs from the raw one\n");
+            ret = -1;
+        }
+        PimDestroyBo(h_device);
+    }
+
+    if (reordered != nullptr) PimDestroyBo(reordered);
+    PimDestroyBo(h_w);
+    PimDestroyBo(d_w);
+    PimDestroyBo(d_back);
+    PimDestroyBo(h_back);
+    PimDestroyGemmDesc(desc);
+    return ret;
+}
+
+class PimGemmReorderTestFixture : public ::testing::Test
+{
+   protected:
+    virtual void SetUp(void) override { PimInitialize(RT_TYPE_HIP, PIM_FP16); }
+    virtual void TearDown(void) override { PimDeinitialize(); }
+};
+
+TEST_F(PimGemmReorderTestFixture, pim_gemm_reorder_device_1024x4096)
+{
+    EXPECT_TRUE(pim_gemm_reorder_device_vs_host(1, 1, 1, 1024, 1, 4096, I_X_W) == 0);
+}
+TEST_F(PimGemmReorderTestFixture, pim_gemm_reorder_device_2x1024x4096)
+{
+    EXPECT_TRUE(pim_gemm_reorder_device_vs_host(1, 2, 1, 1024, 1, 4096, I_X_W) == 0);
+}
+TEST_F(PimGemmReorderTestFixture, pim_gemm_reorder_device_w_x_i_4096x1024)
+{
+    EXPECT_TRUE(pim_gemm_reorder_device_vs_host(1, 1, 1024, 1, 4096, 1, W_X_I) == 0);
+}
+TEST_F(PimGemmReorderTestFixture, pim_gemm_reorder_device_64x256x64)
+{
+    EXPECT_TRUE(pim_gemm_reorder_device_vs_host(1, 64, 1, 256, 1, 64, I_X_W) == 0);
+}
+TEST_F(PimGemmReorderTestFixture, pim_gemm_restore_host_1024x4096)
+{
+    EXPECT_TRUE(pim_gemm_restore(1, 1, 1, 1024, 1, 4096, I_X_W, false) == 0);
+}
+TEST_F(PimGemmReorderTestFixture, pim_gemm_restore_device_1024x4096)
+{
+    EXPECT_TRUE(pim_gemm_restore(1, 1, 1, 1024, 1, 4096, I_X_W, true) == 0);
+}
+TEST_F(PimGemmReorderTestFixture, pim_gemm_restore_device_w_x_i_4096x1024)
+{
+    EXPECT_TRUE(pim_gemm_restore(1, 1, 1024, 1, 4096, 1, W_X_I, true) == 0);
+}
+TEST_F(PimGemmReorderTestFixture, pim_gemm_restore_device_64x256x64)
+{
+    EXPECT_TRUE(pim_gemm_restore(1, 64, 1, 256, 1, 64, I_X_W, true) == 0);
+}
@@ -0,0 +1,109 @@
+/*
+ * Copyright (C) 2022 Samsung Electronics Co. LTD
+ *
+ * This software is a property of Samsung Electronics.
+ * No part of this software, either material or conceptual may be copied or distributed, transmitted,
+ * transcribed, stored in a retrieval system or translated into any human or computer language in any form by any means,
+ * electronic, mechanical, manual or otherwise, or disclosed
+ * to third parties without the express written permission of Samsung Electronics.
+ * (Use of the Software is restricted to non-commercial, personal or academic, research purpose only)
+ */
+
+#include <assert.h>
+#include <gtest/gtest.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <iostream>
+#include "half.hpp"
+#include "pim_runtime_api.h"
+#include "utility/pim_debug.hpp"
+
+#define NUM_REPLAY (3)
+
+using namespace std;
+using half_float::half;
+
+/* issues relu(input0 + input1) * input1 */
+static int issue_elt_chain(PimBo* output, PimBo* tmp, PimBo* input0, PimBo* input1)
+{
+    int ret = 0;
+
+    ret |= PimExecuteAdd(tmp, input0, input1, nullptr, false);
+    ret |= PimExecuteRelu(output, tmp, nullptr, false);
+    ret |= PimExecuteMul(tmp, output, input1, nullptr, false);
+    ret |= PimExecuteRelu(output, tmp, nullptr, false);
+
+    return ret;
+}
+
+int pim_graph_elt_chain(uint32_t input_len)
+{
+    int ret = 0;
+
+    /* __PIM_API__ call : Initialize PimRuntime */
+    PimInitialize(RT_TYPE_HIP, PIM_FP16);
+
+    PimDesc* pim_desc = PimCreateDesc(1, 1, 1, input_len, PIM_FP16);
+
+    /* __PIM_API__ call : Create PIM Buffer Object */
+    PimBo* host_input0 = PimCreateBo(pim_desc, MEM_TYPE_HOST);
+    PimBo* host_input1 = PimCreateBo(pim_desc, MEM_TYPE_HOST);
+    PimBo* host_output = PimCreateBo(pim_desc, MEM_TYPE_HOST);
+    PimBo* eager_output = PimCreateBo(pim_desc, MEM_TYPE_HOST);
+    PimBo* pim_input0 = PimCreateBo(pim_desc, MEM_TYPE_PIM);
+    PimBo* pim_input1 = PimCreateBo(pim_desc, MEM_TYPE_PIM);
+    PimBo* pim_tmp = PimCreateBo(pim_desc, MEM_TYPE_PIM);
+    PimBo* device_output = PimCreateBo(pim_desc, MEM_TYPE_PIM);
+
+    /* __PIM_API__ call : Record the op chain once */
+    PimGraph* graph = nullptr;
+    PimBeginGraphCapture();
+    issue_elt_chain(device_output, pim_tmp, pim_input0, pim_input1);
+    ret = PimEndGraphCapture(&graph);
+    if (ret != 0) {
+        printf("fail to capture graph\n");
+    }
+
+    for (int i = 0; i < NUM_REPLAY && ret == 0; i++) {
+        /* new operand data is picked up by every replay */
+        set_rand_half_data((half*)host_input0->data, (half)0.5, input_len);
+        set_rand_half_data((half*)host_input1->data, (half)0.5, input_len);
+        PimCopyMemory(pim_input0, host_input0, HOST_TO_PIM);
+        PimCopyMemory(pim_input1, host_input1, HOST_TO_PIM);
+
+        issue_elt_chain(device_output, pim_tmp, pim_input0, pim_input1);
+        PimSynchronize();
+        PimCopyMemory(eager_output, device_output, PIM_TO_HOST);
+
+        /* clear the eager result so that it has to be produced by the replay */
+        set_half_data((half*)host_output->data, (half)0, input_len);
+        PimCopyMemory(device_output, host_output, HOST_TO_PIM);
+
+        /* __PIM_API__ call : Replay the chain with a single submission and a single sync */
+        PimLaunchGraph(graph, nullptr, true);
+        PimCopyMemory(host_output, device_output, PIM_TO_HOST);
+
+        ret = compare_half_relative((half*)eager_output->data, (half*)host_output->data, input_len);
+    }
+
+    /* __PIM_API__ call : Free memory */
+    if (graph != nullptr) PimDestroyGraph(graph);
+    PimDestroyBo(host_input0);
+    PimDestroyBo(host_input1);
+    PimDestroyBo(host_output);
+    PimDestroyBo(eager_output);
+    PimDestroyBo(pim_input0);
+    PimDestroyBo(pim_input1);
+    PimDestroyBo(pim_tmp);
+    PimDestroyBo(device_output);
+    PimDestroyDesc(pim_desc);
+
+    /* __PIM_API__ call : Deinitialize PimRuntime */
+    PimDeinitialize();
+
+    return ret;
+}
+
+TEST(HIPIntegrationTest, PimGraphEltChain1) { EXPECT_TRUE(pim_graph_elt_chain(1 * 1024) == 0); }
+TEST(HIPIntegrationTest, PimGraphEltChain2) { EXPECT_TRUE(pim_graph_elt_chain(128 * 1024) == 0); }
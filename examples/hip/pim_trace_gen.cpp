@@ -0,0 +1,114 @@
+/*
+ * Copyright (C) 2022 Samsung Electronics Co. LTD
+ *
+ * This software is a property of Samsung Electronics.
+ * No part of this software, either material or conceptual may be copied or distributed, transmitted,
+ * transcribed, stored in a retrieval system or translated into any human or computer language in any form by any means,
+ * electronic, mechanical, manual or otherwise, or disclosed
+ * to third parties without the express written permission of Samsung Electronics.
+ * (Use of the Software is restricted to non-commercial, personal or academic, research purpose only)
+ */
+
+#include <gtest/gtest.h>
+#include <stdio.h>
+#include <vector>
+#include "hip/hip_runtime.h"
+
+#ifdef EMULATOR
+#include "executor/hip/pim_trace.pimk"
+
+#define TRACE_BLOCKS (64)
+#define TRACE_THREADS (64)
+#define TRACE_BURSTS (128)
+#define TRACE_ITER (10)
+
+/* the command mix of an elementwise kernel, a read and a write per burst and a fence every eight bursts */
+template <bool per_lane>
+__global__ void trace_gen_kernel(uint8_t* base, PimMemTracer* emulator_trace, int num_burst)
+{
+    uint8_t src[16];
+    for (int i = 0; i < 16; i++) src[i] = hipThreadIdx_x + i;
+
+    for (int i = 0; i < num_burst; i++) {
+        uint8_t* addr = base + (((hipBlockIdx_x * num_burst + i) * hipBlockDim_x + hipThreadIdx_x) << 4);
+        _R_CMD<per_lane>(addr, emulator_trace);
+        _W_CMD_R<per_lane>(addr, src, emulator_trace);
+        if (i % 8 == 7) _B_CMD<per_lane>(1, emulator_trace);
+    }
+}
+
+template <bool per_lane>
+double run_trace_gen(PimMemTracer* h_tracer, PimMemTracer* d_tracer, int* num_rec)
+{
+    hipEvent_t start, stop;
+    float total_ms = 0.0f;
+
+    hipEventCreate(&start);
+    hipEventCreate(&stop);
+    for (int iter = 0; iter < TRACE_ITER; iter++) {
+        memset(h_tracer->g_ridx, 0, sizeof(h_tracer->g_ridx));
+        hipMemcpy(d_tracer, h_tracer, sizeof(PimMemTracer), hipMemcpyHostToDevice);
+
+        float ms = 0.0f;
+        hipEventRecord(start, 0);
+        hipLaunchKernelGGL(trace_gen_kernel<per_lane>, dim3(TRACE_BLOCKS), dim3(TRACE_THREADS), 0, 0,
+                           (uint8_t*)h_tracer->g_fba, d_tracer, TRACE_BURSTS);
+        hipEventRecord(stop, 0);
+        hipEventSynchronize(stop);
+        hipEventElapsedTime(&ms, start, stop);
+        total_ms += ms;
+    }
+    hipEventDestroy(start);
+    hipEventDestroy(stop);
+
+    hipMemcpy(h_tracer, d_tracer, sizeof(PimMemTracer), hipMemcpyDeviceToHost);
+    *num_rec = 0;
+    for (int b = 0; b < TRACE_BLOCKS; b++) *num_rec += h_tracer->g_ridx[b];
+    return total_ms / TRACE_ITER;
+}
+
+int trace_gen_throughput(void)
+{
+    int rec_per_block = TRACE_THREADS * (TRACE_BURSTS * 2 + TRACE_BURSTS / 8);
+    size_t num_rec = (size_t)TRACE_BLOCKS * rec_per_block;
+    PimMemTracer h_tracer;
+    PimMemTracer* d_tracer;
+    int ret = 0;
+
+    memset(&h_tracer, 0, sizeof(h_tracer));
+    /* the addresses are only recorded, never accessed */
+    h_tracer.g_fba = 0x100000000ULL;
+    h_tracer.m_width = rec_per_block;
+    hipMalloc((void**)&h_tracer.g_fmtd16, num_rec * sizeof(PimMemTraceData));
+    hipMalloc((void**)&d_tracer, sizeof(PimMemTracer));
+
+    int num_lane_rec = 0, num_wave_rec = 0;
+    double lane_ms = run_trace_gen<true>(&h_tracer, d_tracer, &num_lane_rec);
+    double wave_ms = run_trace_gen<false>(&h_tracer, d_tracer, &num_wave_rec);
+
+    printf("trace records per launch : %zu\n", num_rec);
+    printf("per lane atomics      : %8.3f ms %8.1f Mrecords/s\n", lane_ms, num_rec / lane_ms / 1e3);
+    printf("per wavefront atomics : %8.3f ms %8.1f Mrecords/s (x%.2f)\n", wave_ms, num_rec / wave_ms / 1e3,
+           lane_ms / wave_ms);
+    if (num_lane_rec != (int)num_rec || num_wave_rec != (int)num_rec) ret = -1;
+
+    /* every call of a full wavefront takes consecutive slots in lane order */
+    std::vector<PimMemTraceData> trace(num_rec);
+    hipMemcpy(trace.data(), h_tracer.g_fmtd16, num_rec * sizeof(PimMemTraceData), hipMemcpyDeviceToHost);
+    for (size_t i = 0; i < num_rec; i++) {
+        const PimMemTraceData& group = trace[i - i % TRACE_THREADS];
+        if (trace[i].thread_id != (int)(i % TRACE_THREADS) || trace[i].cmd != group.cmd ||
+            trace[i].block_id != (int)(i / rec_per_block)) {
+            printf("record %zu is out of order\n", i);
+            ret = -1;
+            break;
+        }
+    }
+
+    hipFree(h_tracer.g_fmtd16);
+    hipFree(d_tracer);
+    return ret;
+}
+
+TEST(HIPIntegrationTest, PimTraceGenThroughput) { EXPECT_TRUE(trace_gen_throughput() == 0); }
+#endif
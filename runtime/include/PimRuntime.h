@@ -22,12 +22,20 @@
 #include "executor/IPimExecutor.h"
 #include "manager/PimInfo.h"
 #include "manager/PimManager.h"
+#include "manager/PimWeightCache.h"
 #include "pim_data_types.h"
 
 namespace pim
 {
 namespace runtime
 {
+#if PIM_COMPILER_ENABLE == 1
+namespace pimc_driver
+{
+class PimCDriver;
+}
+#endif
+
 class PimRuntime
 {
    public:
@@ -49,17 +57,32 @@ class PimRuntime
 
     int execute_add(PimBo* output, PimBo* operand0, PimBo* operand1, void* stream, bool block = false);
     int execute_mul(PimBo* output, PimBo* operand0, PimBo* operand1, void* stream, bool block = false);
+    int execute_add_scalar(PimBo* output, uint16_t scalar, PimBo* operand, void* stream, bool block = false);
+    int execute_mul_scalar(PimBo* output, uint16_t scalar, PimBo* operand, void* stream, bool block = false);
     int execute_relu(PimBo* output, PimBo* pim_data, void* stream, bool block = false);
+    int execute_elt_chain(PimBo* output, PimBo* input, const PimEltChainStep* steps, int num_steps, void* stream,
+                          bool block = false);
     int execute_gemm(PimBo* output, PimBo* input, PimBo* weight, PimBo* bias, PimActFunc act_func,
                      PimGemmOrder gemm_order, void* stream, bool block);
     int execute_bn(PimBo* output, PimBo* pim_data, PimBo* beta, PimBo* gamma, PimBo* mean, PimBo* variance,
                    double epsilon, void* stream, bool block = false);
     int execute_sync(void* stream);
     int execute_dummy(void);
+    int load_crf_program(PimOpType op_type, const char* file_path);
+    int begin_graph_capture(void);
+    int end_graph_capture(PimGraph** graph);
+    int launch_graph(PimGraph* graph, void* stream, bool block);
+    int destroy_graph(PimGraph* graph);
     PimBo* generate_gemm_weight_from_buffer(PimBo* src, PimGemmOrder gemm_order, bool reorder_on_device = false,
                                             void* stream = nullptr, bool save_for_reuse = false);
+    /* pin keeps a cached weight allocated for the caller until unpin_preloaded_pim_weight */
     PimBo* get_preloaded_pim_gemm_weight(PimBo* dev_wei, PimGemmOrder gemm_order, bool reorder_on_device = false,
-                                         void* stream = nullptr, bool save_for_reuse = true);
+                                         void* stream = nullptr, bool save_for_reuse = true, bool pin = false);
+    void unpin_preloaded_pim_weight(PimBo* pim_wei, void* stream);
+    int restore_gemm_weight(PimBo* dst, PimBo* src, PimGemmOrder gemm_order, bool restore_on_device = false,
+                            void* stream = nullptr);
+    int set_weight_cache_budget(size_t budget);
+    int get_weight_cache_stats(PimWeightCacheStats* stats);
 
 #if PIM_COMPILER_ENABLE == 1
     /**
@@ -95,14 +118,22 @@ class PimRuntime
     bool check_need_for_transpose(PimGemmOrder gemm_order, PimBo* dev_wei);
 
    private:
-    int insert_preloaded_pim_weight(PimBo* dev_wei, PimBo* pim_wei);
-    PimBo* find_preloaded_pim_weight(PimBo* dev_wei);
+    int record_graph_node(const executor::PimGraphNode& node);
+    int get_weight_key(PimBo* dev_wei, PimGemmOrder gemm_order, manager::PimWeightKey* key);
+    PimBo* insert_preloaded_pim_weight(const manager::PimWeightKey& key, PimBo* pim_wei, void* stream,
+                                       bool pin = false);
+    PimBo* find_preloaded_pim_weight(const manager::PimWeightKey& key, bool pin = false);
+    void release_evicted_weights(std::vector<manager::PimEvictedWeight>* evicted, void* stream);
     pim::runtime::manager::PimManager* pim_manager_;
     std::shared_ptr<pim::runtime::manager::PimDevice> pim_device_;
     std::shared_ptr<executor::IPimExecutor> pim_executor_;
     PimRuntimeType rt_type_;
     PimPrecision precision_;
-    std::unordered_map<uint32_t, PimBo*> weight_map_;
+    manager::PimWeightCache weight_cache_;
+#if PIM_COMPILER_ENABLE == 1
+    /* kept for the runtime lifetime so that compiled kernels and CRF buffers are reused */
+    std::shared_ptr<pimc_driver::PimCDriver> pimc_driver_;
+#endif
 };
 
 } /* namespace runtime */
@@ -43,6 +43,8 @@ class IPimEmulator
                                       PimActFunc act_func) = 0;
     virtual int execute_gemv_add_tile_accum(PimBo* output, PimBo* pim_data, PimMemTraceData* fmtd32, int fmtd32_size,
                                             PimOpType op_type, uint64_t pim_base_addr, uint8_t* temp_buf) = 0;
+    /* memory clock cycles the last op took on the timing model, 0 in the functional mode */
+    virtual uint64_t get_kernel_cycle(void) = 0;
 };
 
 } /* namespace emulator */
@@ -0,0 +1,114 @@
+/*
+ * Copyright (C) 2022 Samsung Electronics Co. LTD
+ *
+ * This software is a property of Samsung Electronics.
+ * No part of this software, either material or conceptual may be copied or distributed, transmitted,
+ * transcribed, stored in a retrieval system or translated into any human or computer language in any form by any means,
+ * electronic, mechanical, manual or otherwise, or disclosed
+ * to third parties without the express written permission of Samsung Electronics.
+ * (Use of the Software is restricted to non-commercial, personal or academic, research purpose only)
+ */
+
+#ifndef _PIM_FUNCTIONAL_SIMULATOR_H_
+#define _PIM_FUNCTIONAL_SIMULATOR_H_
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include "executor/PimCommand.h"
+#include "half.hpp"
+#include "manager/PimInfo.h"
+#include "pim_data_types.h"
+
+namespace pim
+{
+namespace runtime
+{
+namespace emulator
+{
+/* one column access, sixteen FP16 lanes */
+typedef struct __PimFuncBurst {
+    half_float::half lanes[16];
+} PimFuncBurst;
+
+/* PIM registers and CRF sequencer of one rank, shared by its PIM blocks */
+typedef struct __PimFuncRank {
+    bool pim_op_mode;
+    bool crf_exit;
+    int pc;
+    int repeat_pc;
+    int num_repeat;
+    int jump_pc;
+    int num_jump;
+    uint32_t crf[32];
+    std::vector<PimFuncBurst> grf_a; /* num_pim_blocks * num_grf */
+    std::vector<PimFuncBurst> grf_b;
+    std::vector<PimFuncBurst> srf; /* one per PIM block */
+} PimFuncRank;
+
+typedef struct __PimFuncAddr {
+    uint32_t chan;
+    uint32_t rank;
+    uint32_t bg;
+    uint32_t bank;
+    uint32_t row;
+    uint32_t col;
+    uint64_t upper; /* bits above the rank, passed through unchanged */
+} PimFuncAddr;
+
+/*
+ * Functional model of the PIM device without DRAM timing. The coalesced trace is applied in order to a sparse
+ * host image of the PIM memory, and the CRF programs are interpreted per rank with the register map, AAM indexing
+ * and per operation FP16 rounding of the cycle model. The interface mirrors PimSimulator, addresses are offsets
+ * from the PIM base.
+ */
+class PimFunctionalSimulator
+{
+   public:
+    PimFunctionalSimulator(void);
+    virtual ~PimFunctionalSimulator(void);
+
+    void initialize(void);
+    void deinitialize(void);
+    void preload_data_with_addr(uint64_t addr, void* data, size_t data_size);
+    /* trace_data points to num_trace coalesced PimMemTraceData records */
+    void execute_kernel(void* trace_data, size_t num_trace);
+    void read_result(uint16_t* output_data, uint64_t addr, size_t data_size);
+    /* sums the lanes of each GEMV output the PIM blocks wrote to their odd banks */
+    void read_result_gemv(uint16_t* output_data, uint64_t addr, size_t data_dim);
+
+    PimFuncAddr decode_addr(uint64_t addr);
+    uint64_t encode_addr(const PimFuncAddr& fa);
+    /* where output idx of a GEMV result buffer at addr is stored, pb is the PIM block that computed it */
+    PimFuncAddr get_gemv_output_addr(uint64_t addr, size_t idx, int* pb);
+    /* the odd bank burst holding output idx, and the sum of its lanes which is the output */
+    uint64_t get_gemv_result_addr(uint64_t addr, size_t idx);
+    uint16_t reduce_gemv_burst(const uint8_t* burst);
+
+   private:
+    void execute_cmd(PimMemTraceData* trace);
+    void write_register(PimFuncRank* rank, const PimFuncAddr& fa, const PimFuncBurst& data);
+    void do_pim(PimFuncRank* rank, const PimFuncAddr& fa, bool is_write);
+    void do_pim_block(PimFuncRank* rank, const executor::PimCommand& cmd, const PimFuncAddr& fa, int pb);
+    void read_opd(PimFuncRank* rank, PimFuncBurst* bst, executor::PimOpdType type, const PimFuncAddr& fa, int pb,
+                  int idx);
+    void write_opd(PimFuncRank* rank, const PimFuncBurst& bst, executor::PimOpdType type, const PimFuncAddr& fa,
+                   int pb, int idx);
+    uint64_t get_bank_addr(const PimFuncAddr& fa, int pb, int odd);
+    PimFuncRank* get_rank(uint32_t chan, uint32_t rank);
+    uint8_t* get_page(uint64_t addr);
+    void read_burst(uint64_t addr, PimFuncBurst* bst);
+    void write_burst(uint64_t addr, const PimFuncBurst& bst);
+
+   private:
+    PimBlockInfo pbi_;
+    std::vector<PimFuncRank> ranks_;
+    std::unordered_map<uint64_t, std::unique_ptr<uint8_t[]>> pages_;
+    int page_shift_;
+};
+
+} /* namespace emulator */
+} /* namespace runtime */
+} /* namespace pim */
+
+#endif /* _PIM_FUNCTIONAL_SIMULATOR_H_ */
@@ -0,0 +1,103 @@
+/*
+ * Copyright (C) 2022 Samsung Electronics Co. LTD
+ *
+ * This software is a property of Samsung Electronics.
+ * No part of this software, either material or conceptual may be copied or distributed, transmitted,
+ * transcribed, stored in a retrieval system or translated into any human or computer language in any form by any means,
+ * electronic, mechanical, manual or otherwise, or disclosed
+ * to third parties without the express written permission of Samsung Electronics.
+ * (Use of the Software is restricted to non-commercial, personal or academic, research purpose only)
+ */
+
+#ifndef _PIM_SIM_BACKEND_H_
+#define _PIM_SIM_BACKEND_H_
+
+#include <sys/types.h>
+#include <memory>
+#include <string>
+#include <vector>
+#include "emulator/PimFunctionalSimulator.h"
+#include "emulator/PimSimInstance.h"
+#include "emulator/PimTraceFile.h"
+#include "tools/emulator_api/PimSimulator.h"
+
+namespace pim
+{
+namespace runtime
+{
+namespace emulator
+{
+typedef enum __PimEmulatorMode {
+    EMULATOR_TIMING,     /* DRAMSim2 cycle model */
+    EMULATOR_FUNCTIONAL, /* results only, no DRAM timing */
+} PimEmulatorMode;
+
+/* a simulator instance running in its own process, requests and replies go over a socket pair */
+typedef struct __PimSimWorker {
+    pid_t pid;
+    int fd;
+} PimSimWorker;
+
+/*
+ * Runs the emulator traces on the model chosen by PIM_EMULATOR_MODE ("timing" or "functional") when the
+ * runtime is initialized. The interface is the one of PimSimulator, so the emulators do not see the difference.
+ * The timing model runs on the prebuilt PimSimulator by default. PIM_EMULATOR_NUM_THREADS > 1 (0 for every
+ * hardware thread) spreads the HBM channels over that many DRAMSim2 instances instead. DRAMSim2 keeps its
+ * configuration in globals, so every extra instance runs in a worker process of its own. Channel c is always
+ * simulated by instance c % num_sims, which also keeps the preloaded data of those channels only. Instances take
+ * their part of a kernel in trace order, the results are gathered per channel, and the cycles of a kernel are the
+ * most memory clock cycles any instance took, so neither depends on process scheduling. PimSimulator does not
+ * expose its clock, so kernel cycles are only counted with several instances.
+ * Every call returns 0 on success and -1 when an instance did not complete it, e.g. because its worker died.
+ * With PIM_EMULATOR_RECORD=<file> every preload and kernel trace is also written to a binary trace file, which
+ * the pimtrace tool replays offline.
+ */
+class PimSimBackend
+{
+   public:
+    PimSimBackend(void);
+    virtual ~PimSimBackend(void);
+
+    void initialize(const std::string& device_ini_file_name, const std::string& system_ini_file_name,
+                    size_t megs_of_memory, size_t num_pim_chan, size_t num_pim_rank);
+    int preload_data_with_addr(uint64_t addr, void* data, size_t data_size);
+    int execute_kernel(void* trace_data, size_t num_trace);
+    int read_result(uint16_t* output_data, uint64_t addr, size_t data_size);
+    int read_result_gemv(uint16_t* output_data, uint64_t addr, size_t data_dim);
+    PimEmulatorMode get_mode(void) { return mode_; }
+    int get_num_sims(void) { return num_sims_; }
+    /* memory clock cycles of the last kernel and of every kernel so far, 0 unless several instances run */
+    uint64_t get_kernel_cycle(void) { return kernel_cycle_; }
+    uint64_t get_cycle(void) { return cycle_; }
+
+   private:
+    int get_sim_id(const PimMemTraceData& trace);
+    int start_workers(const std::string& device_ini_file_name, const std::string& system_ini_file_name,
+                      size_t megs_of_memory, size_t num_pim_chan, int num_workers);
+    void stop_workers(void);
+    int write_on_sims(void);
+    int execute_on_sims(uint64_t* max_cycle);
+    int read_on_sims(std::vector<std::vector<uint8_t>>* results);
+
+   private:
+    PimEmulatorMode mode_;
+    PimBlockInfo pbi_;
+    int num_sims_;
+    /* the only instance when a single one simulates every channel */
+    std::unique_ptr<PimSimulator> pim_sim_;
+    /* with several instances, instance 0 runs in this process and the others in workers_[i - 1] */
+    std::unique_ptr<PimSimInstance> local_sim_;
+    std::vector<PimSimWorker> workers_;
+    std::vector<std::vector<PimMemTraceData>> sim_traces_;
+    std::vector<std::vector<uint64_t>> sim_addrs_;
+    uint64_t kernel_cycle_;
+    uint64_t cycle_;
+    PimFunctionalSimulator func_sim_;
+    PimTraceWriter recorder_;
+};
+
+} /* namespace emulator */
+} /* namespace runtime */
+} /* namespace pim */
+
+#endif /* _PIM_SIM_BACKEND_H_ */
@@ -0,0 +1,65 @@
+/*
+ * Copyright (C) 2022 Samsung Electronics Co. LTD
+ *
+ * This software is a property of Samsung Electronics.
+ * No part of this software, either material or conceptual may be copied or distributed, transmitted,
+ * transcribed, stored in a retrieval system or translated into any human or computer language in any form by any means,
+ * electronic, mechanical, manual or otherwise, or disclosed
+ * to third parties without the express written permission of Samsung Electronics.
+ * (Use of the Software is restricted to non-commercial, personal or academic, research purpose only)
+ */
+
+#ifndef _PIM_SIM_INSTANCE_H_
+#define _PIM_SIM_INSTANCE_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+#include "MultiChannelMemorySystem.h"
+#include "manager/PimInfo.h"
+
+namespace pim
+{
+namespace runtime
+{
+namespace emulator
+{
+/*
+ * One DRAMSim2 memory system driven with emulator records. Every record is one 32B burst, barriers are issued to
+ * the channel of their block. The memory clock only advances while transactions are pending, so the cycles of a
+ * kernel are the updates it takes to drain.
+ */
+class PimSimInstance
+{
+   public:
+    PimSimInstance(void);
+    virtual ~PimSimInstance(void) {}
+
+    void initialize(const std::string& device_ini_file_name, const std::string& system_ini_file_name,
+                    size_t megs_of_memory, size_t num_pim_chan);
+    /* host writes of preloaded data, not counted as kernel cycles */
+    void write_bursts(const PimMemTraceData* bursts, size_t num_burst);
+    /* returns the memory clock cycles the kernel took */
+    uint64_t execute_kernel(const PimMemTraceData* trace, size_t num_trace);
+    void read_bursts(const uint64_t* addrs, size_t num_burst, uint8_t* out);
+    uint64_t get_cycle(void) { return cycle_; }
+
+   private:
+    void push_trace(const PimMemTraceData* trace, size_t num_trace);
+    void update(void);
+    /* advances until no transaction is pending, returns the cycle count */
+    uint64_t run(void);
+
+   private:
+    std::shared_ptr<DRAMSim::MultiChannelMemorySystem> mem_;
+    /* data of the pending transactions, DRAMSim2 keeps pointers to them until they complete */
+    std::vector<DRAMSim::BurstType> bursts_;
+    size_t num_pim_chan_;
+    uint64_t cycle_;
+};
+
+} /* namespace emulator */
+} /* namespace runtime */
+} /* namespace pim */
+
+#endif /* _PIM_SIM_INSTANCE_H_ */
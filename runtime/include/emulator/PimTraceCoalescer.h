@@ -13,7 +13,9 @@
 #define _PIM_TRACE_COALESCER_H_
 
 #include <string.h>
+#include <condition_variable>
 #include <iostream>
+#include <mutex>
 #include <sstream>
 #include <vector>
 #include "manager/PimInfo.h"
@@ -33,11 +35,41 @@ namespace emulator
 class TraceParser
 {
    public:
+    TraceParser(int num_threads = 0);
     void coalesce_trace(PimMemTraceData *fmtd32, int *fmtd32_size, PimMemTraceData *fmtd16, int fmtd16_size);
 
    private:
+    int coalesce_range(PimMemTraceData *fmtd32, PimMemTraceData *fmtd16, int fmtd16_size,
+                       std::vector<bool> *chan_seen);
     void append_data(uint8_t *dst, uint8_t *src, int size);
     void move_data(uint8_t *dst, uint8_t *src, int size);
+
+   private:
+    int num_threads_;
+};
+
+/* Coalesced trace published chunk by chunk so that simulation can start before the whole trace is ready */
+class TraceChunkQueue
+{
+   public:
+    TraceChunkQueue(void) : base_(nullptr), total_size_(0), head_(0), closed_(true) {}
+
+    void reset(PimMemTraceData *base);
+    void push(int size);
+    void close(void);
+    bool pop(PimMemTraceData **chunk, int *size);
+    /* waits for the last chunk and returns the whole trace, the chunks are stored back to back */
+    PimMemTraceData *wait_all(int *size);
+    int get_total_size(void);
+
+   private:
+    std::mutex lock_;
+    std::condition_variable cond_;
+    std::vector<std::pair<int, int>> chunks_;
+    PimMemTraceData *base_;
+    int total_size_;
+    size_t head_;
+    bool closed_;
 };
 
 } /* namespace emulator */
@@ -0,0 +1,113 @@
+/*
+ * Copyright (C) 2022 Samsung Electronics Co. LTD
+ *
+ * This software is a property of Samsung Electronics.
+ * No part of this software, either material or conceptual may be copied or distributed, transmitted,
+ * transcribed, stored in a retrieval system or translated into any human or computer language in any form by any means,
+ * electronic, mechanical, manual or otherwise, or disclosed
+ * to third parties without the express written permission of Samsung Electronics.
+ * (Use of the Software is restricted to non-commercial, personal or academic, research purpose only)
+ */
+
+#ifndef _PIM_TRACE_FILE_H_
+#define _PIM_TRACE_FILE_H_
+
+#include <stdio.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "manager/PimInfo.h"
+#include "pim_data_types.h"
+
+namespace pim
+{
+namespace runtime
+{
+namespace emulator
+{
+/*
+ * Binary trace file, a stream of events after an 8 byte magic and a version word.
+ * TRACE_EVENT_PRELOAD : varint addr, varint size, raw data
+ * TRACE_EVENT_KERNEL  : varint num_trace, then one record per trace
+ * A record is a head byte (command, same block, same thread), the block and thread ids when they changed, the
+ * zigzag varint address delta from the previous record of the same block (channel), and the 32B payload for
+ * writes only. Address deltas restart at every kernel.
+ */
+typedef enum __PimTraceEventType {
+    TRACE_EVENT_NONE = 0,
+    TRACE_EVENT_PRELOAD = 1,
+    TRACE_EVENT_KERNEL = 2,
+} PimTraceEventType;
+
+typedef struct __PimTraceEvent {
+    PimTraceEventType type;
+    uint64_t addr;      /* PRELOAD */
+    uint64_t size;      /* PRELOAD, bytes */
+    uint64_t num_trace; /* KERNEL */
+} PimTraceEvent;
+
+class PimTraceWriter
+{
+   public:
+    PimTraceWriter(void);
+    virtual ~PimTraceWriter(void);
+
+    int open(const std::string& file_path);
+    int close(void);
+    bool is_open(void) { return fp_ != nullptr; }
+    int write_preload(uint64_t addr, const void* data, size_t data_size);
+    int write_kernel(const PimMemTraceData* trace, size_t num_trace);
+    uint64_t get_file_size(void) { return file_size_; }
+
+   private:
+    void put_varint(uint64_t value);
+    void put_bytes(const void* data, size_t size);
+    int flush(void);
+
+   private:
+    FILE* fp_;
+    std::vector<uint8_t> buf_;
+    std::unordered_map<int, uint64_t> last_addr_;
+    int last_block_;
+    int last_thread_;
+    uint64_t file_size_;
+};
+
+class PimTraceReader
+{
+   public:
+    PimTraceReader(void);
+    virtual ~PimTraceReader(void);
+
+    int open(const std::string& file_path);
+    int close(void);
+    /* 1 with the next event, 0 at the end of the file, -1 on a corrupt file */
+    int next_event(PimTraceEvent* event);
+    /* the data of the PRELOAD event just returned */
+    int read_preload(void* data);
+    /* decodes up to max_trace records of the current KERNEL event, returns the number decoded or -1 */
+    int64_t read_trace(PimMemTraceData* trace, size_t max_trace);
+
+   private:
+    bool get_byte(uint8_t* value);
+    bool get_varint(uint64_t* value);
+    bool get_bytes(void* data, size_t size);
+    int skip_event(void);
+
+   private:
+    FILE* fp_;
+    std::vector<uint8_t> buf_;
+    size_t buf_pos_;
+    size_t buf_end_;
+    PimTraceEvent event_;
+    uint64_t remain_; /* records or bytes left in the current event */
+    std::unordered_map<int, uint64_t> last_addr_;
+    int last_block_;
+    int last_thread_;
+};
+
+} /* namespace emulator */
+} /* namespace runtime */
+} /* namespace pim */
+
+#endif /* _PIM_TRACE_FILE_H_ */
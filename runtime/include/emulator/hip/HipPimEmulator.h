@@ -16,7 +16,7 @@
 #include "emulator/PimTraceCoalescer.h"
 #include "manager/PimInfo.h"
 #include "pim_data_types.h"
-#include "tools/emulator_api/PimSimulator.h"
+#include "emulator/PimSimBackend.h"
 
 namespace pim
 {
@@ -38,6 +38,10 @@ class HipPimEmulator : public IPimEmulator
                    uint8_t* temp_buf);
     int execute_elt_op(PimBo* output, PimBo* operand0, PimBo* operand1, PimMemTraceData* fmtd32, int fmtd32_size,
                        uint64_t pim_base_addr);
+    int execute_elt_scalar_op(PimBo* output, PimBo* operand, PimMemTraceData* fmtd32, int fmtd32_size,
+                              uint64_t pim_base_addr);
+    int execute_elt_chain_op(PimBo* output, PimBo** operands, int num_operands, PimMemTraceData* fmtd32,
+                             int fmtd32_size, uint64_t pim_base_addr);
     int execute_relu(PimBo* output, PimBo* pim_data, PimMemTraceData* fmtd32, int fmtd32_size, uint64_t pim_base_addr);
     int execute_copy(PimBo* output, PimBo* pim_data, PimMemTraceData* fmtd32, int fmtd32_size, uint64_t pim_base_addr);
     int execute_gemm_bias_act(PimBo* output, PimBo* pim_data, PimMemTraceData* fmtd32, int fmtd32_size,
@@ -45,14 +49,22 @@ class HipPimEmulator : public IPimEmulator
                               PimActFunc act_func);
     int execute_gemv_add_tile_accum(PimBo* output, PimBo* pim_data, PimMemTraceData* fmtd32, int fmtd32_size,
                                     PimOpType op_type, uint64_t pim_base_addr, uint8_t* temp_buf);
+    void dump_mem_trace(PimMemTraceData* fmtd32, int fmtd32_size, PimMemTraceData* fmtd16, int fmtd16_size,
+                        PimOpType op_type);
+    void set_trace_queue(TraceChunkQueue* trace_queue) { trace_queue_ = trace_queue; }
+    uint64_t get_kernel_cycle(void) { return kernel_cycle_; }
 
    private:
+    int execute_trace(PimMemTraceData* fmtd32, int fmtd32_size);
     int execute_relu_bn_copy(PimBo* output, PimBo* pim_data, PimMemTraceData* fmtd32, int fmtd32_size,
                              uint64_t pim_base_addr);
 
    private:
     PimBlockInfo fbi_;
-    PimSimulator pim_sim_;
+    PimSimBackend pim_sim_;
+    TraceChunkQueue* trace_queue_;
+    bool sim_chunks_; /* PIM_EMULATOR_SIM_CHUNKS=1, results are the same but the cycles are not */
+    uint64_t kernel_cycle_; /* sum over the chunks of the last op */
 };
 
 } /* namespace emulator */
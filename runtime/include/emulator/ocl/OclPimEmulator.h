@@ -16,7 +16,7 @@
 #include "emulator/PimTraceCoalescer.h"
 #include "manager/PimInfo.h"
 #include "pim_data_types.h"
-#include "tools/emulator_api/PimSimulator.h"
+#include "emulator/PimSimBackend.h"
 
 namespace pim
 {
@@ -38,6 +38,8 @@ class OclPimEmulator : public IPimEmulator
                    uint8_t* temp_buf);
     int execute_elt_op(PimBo* output, PimBo* operand0, PimBo* operand1, PimMemTraceData* fmtd32, int fmtd32_size,
                        uint64_t pim_base_addr);
+    int execute_elt_scalar_op(PimBo* output, PimBo* operand, PimMemTraceData* fmtd32, int fmtd32_size,
+                              uint64_t pim_base_addr);
     int execute_relu(PimBo* output, PimBo* pim_data, PimMemTraceData* fmtd32, int fmtd32_size, uint64_t pim_base_addr);
     int execute_copy(PimBo* output, PimBo* pim_data, PimMemTraceData* fmtd32, int fmtd32_size, uint64_t pim_base_addr);
     int execute_gemm_bias_act(PimBo* output, PimBo* pim_data, PimMemTraceData* fmtd32, int fmtd32_size,
@@ -45,14 +47,18 @@ class OclPimEmulator : public IPimEmulator
                               PimActFunc act_func);
     int execute_gemv_add_tile_accum(PimBo* output, PimBo* pim_data, PimMemTraceData* fmtd32, int fmtd32_size,
                                     PimOpType op_type, uint64_t pim_base_addr, uint8_t* temp_buf);
+    uint64_t get_kernel_cycle(void) { return kernel_cycle_; }
 
    private:
+    int execute_trace(PimMemTraceData* fmtd32, int fmtd32_size);
     int execute_relu_bn_copy(PimBo* output, PimBo* pim_data, PimMemTraceData* fmtd32, int fmtd32_size,
                              uint64_t pim_base_addr);
 
    private:
     PimBlockInfo fbi_;
-    PimSimulator pim_sim_;
+    PimSimBackend pim_sim_;
+    PimOpType op_type_; /* op of the last converted trace, to report its cycles */
+    uint64_t kernel_cycle_;
 };
 
 } /* namespace emulator */
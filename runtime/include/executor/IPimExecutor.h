@@ -12,6 +12,9 @@
 #ifndef _IPIM_EXECUTOR_H_
 #define _IPIM_EXECUTOR_H_
 
+#include "executor/PimCrfAssembler.h"
+#include "executor/PimEltChain.h"
+#include "executor/PimGraph.h"
 #include "manager/PimInfo.h"
 #include "manager/PimManager.h"
 #include "pim_data_types.h"
@@ -29,7 +32,12 @@ class IPimExecutor
     virtual int deinitialize(void) = 0;
     virtual int execute_add(PimBo* output, PimBo* operand0, PimBo* operand1, void* stream, bool block) = 0;
     virtual int execute_mul(PimBo* output, PimBo* operand0, PimBo* operand1, void* stream, bool block) = 0;
+    virtual int execute_add_scalar(PimBo* output, uint16_t scalar, PimBo* operand, void* stream, bool block) = 0;
+    virtual int execute_mul_scalar(PimBo* output, uint16_t scalar, PimBo* operand, void* stream, bool block) = 0;
     virtual int execute_relu(PimBo* output, PimBo* pim_data, void* stream, bool block) = 0;
+    /* runs a chain of elementwise steps starting from input as a single fused program where supported */
+    virtual int execute_elt_chain(PimBo* output, PimBo* input, const PimEltChainStep* steps, int num_steps,
+                                  void* stream, bool block) = 0;
     virtual int execute_copy(PimBo* output, PimBo* pim_data, void* stream, bool block) = 0;
     virtual int execute_bn(PimBo* output, PimBo* pim_data, PimBo* beta, PimBo* gamma, PimBo* mean, PimBo* variance,
                            double epsilon, void* stream, bool block) = 0;
@@ -40,9 +48,14 @@ class IPimExecutor
     virtual int execute_custom_gemv_add(PimBo* output, PimBo* operand0, PimBo* operand1, PimBo* operand2, bool relu,
                                         void* stream, bool block) = 0;
     virtual int execute_sync(void* stream) = 0;
+    /* prepares the recorded nodes of a graph once so that execute_graph only issues them */
+    virtual int instantiate_graph(PimGraph* graph) = 0;
+    virtual int execute_graph(PimGraph* graph, void* stream, bool block) = 0;
     virtual int execute_dummy(void) = 0;
     virtual void* createStream(void) = 0;
     virtual void set_gemm_order(PimGemmOrder gemm_order) = 0;
+    /* replaces the CRF program the executor generates for op_type */
+    virtual int load_crf_program(PimOpType op_type, const PimCrfProgram& program) = 0;
 };
 
 } /* namespace executor */
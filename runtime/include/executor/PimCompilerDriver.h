@@ -18,6 +18,8 @@
 #include <hip/hip_runtime.h>
 #include <hip/hiprtc.h>
 
+#include <mutex>
+#include <unordered_map>
 #include <vector>
 
 extern uint64_t g_pim_base_addr[MAX_NUM_GPUS];
@@ -34,12 +36,16 @@ class HIPCompiler
     /**
      * @brief Constructor for HIPCompiler class
      *
-     * @param pim_op pim_op object returned from compiler along with buffers from PIMLibrary
+     * Compiled code objects are cached in memory by a hash of the kernel source, target architecture, compile
+     * options and hiprtc version, and also written to PIM_KERNEL_CACHE_DIR (default $XDG_CACHE_HOME/pim/kernels or
+     * $HOME/.cache/pim/kernels) so that later processes load them without running hiprtc. An empty
+     * PIM_KERNEL_CACHE_DIR disables the on-disk cache.
      */
-    HIPCompiler() {}
-    ~HIPCompiler() {}
-    void execute(std::string hip_kernel, std::string crf_binary);
+    HIPCompiler();
+    ~HIPCompiler();
+    hipFunction_t execute(std::string hip_kernel, std::string crf_binary);
     hipFunction_t get_kernel_function() { return kernel_; }
+    void clear_cache(void);
 
    private:
     HIPCompiler(HIPCompiler &&) = delete;
@@ -48,7 +54,22 @@ class HIPCompiler
     HIPCompiler &operator=(const HIPCompiler &) = delete;
 
 #if PIM_COMPILER_ENABLE == 1
-    hipModule_t module_;
+    typedef struct __KernelModule {
+        hipModule_t module;
+        hipFunction_t kernel;
+    } KernelModule;
+
+    std::string get_cache_key(const std::string &hip_kernel, const std::string &compile_opts);
+    bool compile_code_object(const std::string &hip_kernel, const std::string &compile_opts,
+                             std::vector<char> *code);
+    bool load_code_object(const std::string &key, std::vector<char> *code);
+    void save_code_object(const std::string &key, const std::vector<char> &code);
+    bool load_module(const std::vector<char> &code, KernelModule *kernel_module);
+
+    std::unordered_map<std::string, KernelModule> module_cache_;
+    std::mutex mutex_;
+    std::string arch_;
+    std::string cache_dir_;
 #endif
     hipFunction_t kernel_;
 };
@@ -57,6 +78,7 @@ class PimCDriver
 {
    public:
     PimCDriver() = default;
+    ~PimCDriver();
     PimCDriver(PimCDriver &&) = delete;
     PimCDriver(const PimCDriver &) = delete;
     PimCDriver &operator=(PimCDriver &&) = delete;
@@ -71,11 +93,18 @@ class PimCDriver
     void pim_memcpy(void *dest, const void *src, size_t size, PimTarget *target);
     void pim_launch_kernel(std::string kernel, std::string crf_binary, uint32_t num_blocks, uint32_t num_threads,
                            uint8_t *args[], size_t num_args, PimTarget *target);
+    uint8_t *get_crf_buffer(const std::string &crf_binary, PimTarget *target);
 #endif
+    void clear_cache(void);
     // todo:: Pass HW information from user
 
    private:
     HIPCompiler compile_;
+#if PIM_COMPILER_ENABLE == 1
+    /* device copies of CRF binaries, keyed by the binary itself */
+    std::unordered_map<std::string, uint8_t *> crf_buffers_;
+    std::mutex crf_mutex_;
+#endif
 };
 }  // namespace pimc_driver
 }  // namespace runtime
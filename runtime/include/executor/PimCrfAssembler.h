@@ -0,0 +1,66 @@
+/*
+ * Copyright (C) 2022 Samsung Electronics Co. LTD
+ *
+ * This software is a property of Samsung Electronics.
+ * No part of this software, either material or conceptual may be copied or distributed, transmitted,
+ * transcribed, stored in a retrieval system or translated into any human or computer language in any form by any means,
+ * electronic, mechanical, manual or otherwise, or disclosed
+ * to third parties without the express written permission of Samsung Electronics.
+ * (Use of the Software is restricted to non-commercial, personal or academic, research purpose only)
+ */
+
+#ifndef _PIM_CRF_ASSEMBLER_H_
+#define _PIM_CRF_ASSEMBLER_H_
+
+#include <string>
+#include <vector>
+#include "executor/PimCommand.h"
+
+namespace pim
+{
+namespace runtime
+{
+namespace executor
+{
+/* CRF program parsed from text, the JUMPs listed in lc_jumps take the loop counter of the data size at launch */
+typedef struct __PimCrfProgram {
+    std::vector<PimCommand> cmds;
+    std::vector<int> lc_jumps;
+} PimCrfProgram;
+
+/*
+ * One command per line in the form printed by PimCommand::to_str, '#' starts a comment.
+ *   FILL GRF_A[0], EVEN_BANK, relu, auto
+ *   ADD GRF_A[0], GRF_A[0], EVEN_BANK, auto
+ *   MAD GRF_A[0], EVEN_BANK, SRF_M[0], SRF_A[0], auto
+ *   NOP 24x
+ *   JUMP lc [PC - 6]
+ *   EXIT
+ * A JUMP count of lc is replaced by the loop counter of the data size the program runs on.
+ */
+class PimCrfAssembler
+{
+   public:
+    PimCrfAssembler(void);
+    virtual ~PimCrfAssembler(void);
+
+    /* returns 0 if the text parses and the program passes PimCrfValidator, -1 otherwise */
+    int assemble(const std::string& text, PimCrfProgram* program);
+    int assemble_file(const std::string& file_path, PimCrfProgram* program);
+    /* one line per CRF word of binary, followed by its index and encoding as a comment */
+    int disassemble(const uint8_t* binary, int size, std::string* text);
+
+   private:
+    int parse_line(const std::string& line, PimCrfProgram* program);
+    int parse_operand(const std::string& token, PimOpdType* opd, int* idx);
+    int parse_count(const std::string& token, int* count);
+
+   private:
+    int max_crf_cmds_;
+};
+
+} /* namespace executor */
+} /* namespace runtime */
+} /* namespace pim */
+
+#endif /* _PIM_CRF_ASSEMBLER_H_ */
@@ -12,13 +12,31 @@
 #ifndef _PIM_CRF_BIN_GEN_H_
 #define _PIM_CRF_BIN_GEN_H_
 
+#include <atomic>
 #include <map>
+#include <mutex>
+#include <string>
 #include <vector>
 #include "executor/PimCommand.h"
+#include "executor/PimCrfAssembler.h"
+#include "executor/PimCrfScheduler.h"
 #include "manager/PimInfo.h"
 #include "manager/PimManager.h"
 #include "pim_data_types.h"
 
+#define PIM_OP_MAX_STATEMENTS 16
+
+/*
+ * bank reads which drive a single op program, the kernel issues the writes and reads of its write back NOPs itself.
+ * the kernels take it by value, so it is declared outside of the namespace
+ */
+typedef struct __PimOpStmtArgs {
+    int stmt_src[PIM_OP_MAX_STATEMENTS];  /* 1 if a statement reads the second vector of a binary op */
+    int stmt_cols[PIM_OP_MAX_STATEMENTS]; /* GRF indices which issue a read in each statement */
+    int num_even_stmt;                    /* statements before this one read the even bank half */
+    int num_stmt;
+} PimOpStmtArgs;
+
 namespace pim
 {
 namespace runtime
@@ -26,6 +44,24 @@ namespace runtime
 namespace executor
 {
 #define CRF_BIN_SIZE 32
+#define ELT_CHAIN_MAX_OPERANDS 4
+#define ELT_CHAIN_MAX_STATEMENTS 16
+/* elementwise programs with a loop counter in [CRF_ARENA_MIN_LC, max lc] are preloaded into the CRF arena */
+#define CRF_ARENA_MIN_LC (-1)
+#define CRF_ARENA_DEFAULT_MAX_LC 1023
+
+/* CRF program of a fused elementwise chain together with the bank reads which drive it */
+typedef struct __PimEltChainProgram {
+    std::vector<PimCommand> cmds;
+    /* source read by each kernel statement of a bank half, 0 is the chain input and k the k-th vector operand */
+    std::vector<int> stmt_src;
+    /* column commands issued by each statement, eight for an instruction and fewer for a hazard NOP */
+    std::vector<int> stmt_cols;
+    int num_operand;
+    bool use_srf;
+    uint16_t scale; /* SRF_M and SRF_A of the folded scalar steps */
+    uint16_t shift;
+} PimEltChainProgram;
 
 class PimCrfBinGen
 {
@@ -39,20 +75,58 @@ class PimCrfBinGen
     void change_to_binary(uint8_t* crf_binary, int* crf_size);
     void set_gemv_tile_tree(bool is_gemv_tile_tree);
     int preprocess_srf(PimBo* beta, PimBo* gamma, PimBo* mean, PimBo* variance, double epsilon, uint8_t* srf_binary);
+    int preprocess_srf_scalar(PimOpType op_type, uint16_t scalar, uint8_t* srf_binary);
+    int preprocess_srf_affine(uint16_t scale, uint16_t shift, uint8_t* srf_binary);
+    int create_elt_chain_cmd(const PimEltChainStep* steps, int num_steps, int lc, PimEltChainProgram* program);
+    /* compiles the chain and returns its CRF binary in device memory, shared by chains with the same program */
+    uint8_t* get_elt_chain_crf(const PimEltChainStep* steps, int num_steps, int data_size,
+                               PimEltChainProgram* program, int* crf_size);
     int get_loop_counter(PimOpType op_type, int input_size);
+    /* returns the CRF binary of (op_type, loop counter of data_size), creating it when it is not cached yet */
     void* make_crf_bin(PimOpType op_type, int data_size);
+    /* returns the cached CRF binary of (op_type, loop counter of data_size) or nullptr */
     uint8_t* find_crf(PimOpType op_type, int data_size);
+    int get_arena_max_lc(void) { return arena_max_lc_; }
+    /* bank reads the kernel of op_type issues for its program, a hazard NOP takes fewer than eight */
+    const PimOpStmtArgs& get_stmt_args(PimOpType op_type) { return stmt_args_[op_type]; }
+    /* bytes of the program of (op_type, loop counter of data_size) which the kernel writes to the CRF */
+    int get_crf_size(PimOpType op_type, int data_size);
+    /*
+     * replaces the generated program of op_type, binaries already made from the old program are freed or rewritten.
+     * the caller waits for the device to be idle and runs no launch concurrently.
+     */
+    int set_crf_program(PimOpType op_type, const PimCrfProgram& program);
+    /* changes whenever a program is replaced, launch state resolved under an older version is stale */
+    uint64_t get_crf_version(void) { return crf_version_; }
 
    private:
     void gen_binary_with_loop(PimOpType op_type, int lc, uint8_t* bin_buf, int* crf_sz);
+    int schedule_op_cmd(const std::vector<PimCommand>& even_cmds, int num_wb_cycle, bool is_wb_per_half, int lc);
+    void create_padded_op_cmd(PimOpType op_type, int lc);
+    int update_op_info(PimOpType op_type);
+    uint8_t* find_arena_crf(PimOpType op_type, int lc);
+    int push_elt_chain_cmd(PimCrfScheduler* scheduler, PimEltChainProgram* program, const PimCommand& cmd, int src);
 
    private:
     pim::runtime::manager::PimManager* pim_manager_;
     std::shared_ptr<pim::runtime::manager::PimDevice> pim_device_;
     std::vector<PimCommand> cmds_;
+    /* programs generated at initialize, one row of max_crf_size_ slots per op indexed by loop counter */
+    uint8_t* crf_arena_;
+    int arena_row_[OP_DUMMY + 1];
+    int arena_max_lc_;
+    /* programs outside the arena, keyed by loop counter so that every size sharing it reuses the binary */
+    std::mutex crf_lut_mutex_;
     std::map<std::pair<PimOpType, int>, uint8_t*> crf_lut_;
+    std::map<std::string, uint8_t*> elt_chain_crf_lut_;
+    std::map<PimOpType, PimCrfProgram> crf_programs_;
+    std::atomic<uint64_t> crf_version_;
+    /* kernel launch information of the single op programs, only changed together with the programs */
+    PimOpStmtArgs stmt_args_[OP_DUMMY + 1];
+    int crf_size_[OP_DUMMY + 1][2];
     PimBlockInfo* pbi_;
     bool is_gemv_tile_tree_;
+    bool is_op_scheduled_; /* false keeps the padded single op programs, which the kernels drive the same way */
     int max_crf_size_;
 };
 
@@ -0,0 +1,55 @@
+/*
+ * Copyright (C) 2022 Samsung Electronics Co. LTD
+ *
+ * This software is a property of Samsung Electronics.
+ * No part of this software, either material or conceptual may be copied or distributed, transmitted,
+ * transcribed, stored in a retrieval system or translated into any human or computer language in any form by any means,
+ * electronic, mechanical, manual or otherwise, or disclosed
+ * to third parties without the express written permission of Samsung Electronics.
+ * (Use of the Software is restricted to non-commercial, personal or academic, research purpose only)
+ */
+
+#ifndef _PIM_CRF_SCHEDULER_H_
+#define _PIM_CRF_SCHEDULER_H_
+
+#include <vector>
+#include "executor/PimCommand.h"
+#include "executor/PimCrfValidator.h"
+
+namespace pim
+{
+namespace runtime
+{
+namespace executor
+{
+/* builds a CRF loop body with the fewest NOP cycles the hazard rules of PimCrfValidator allow */
+class PimCrfScheduler
+{
+   public:
+    PimCrfScheduler(void);
+    virtual ~PimCrfScheduler(void);
+
+    void clear(void);
+    /* appends cmd after the fewest NOP cycles which clear its hazards, returns those cycles or -1 */
+    int push_cmd(const PimCommand& cmd);
+    /* appends cycles the kernel spends on other column commands, e.g. writing the GRF back to the bank */
+    void push_nop(int num_cycle);
+    /* closes the body with a legal JUMP, EXIT and padding, returns 0 if the program passes the checker */
+    int finish(int lc, std::vector<PimCommand>* cmds);
+    /* column commands consumed by one iteration of the body */
+    int get_num_cycle(void);
+
+   private:
+    void append_nop(std::vector<PimCommand>* cmds, int num_cycle);
+
+   private:
+    std::vector<PimCommand> cmds_;
+    PimCrfValidator validator_;
+    int max_hazard_cycle_;
+};
+
+} /* namespace executor */
+} /* namespace runtime */
+} /* namespace pim */
+
+#endif /* _PIM_CRF_SCHEDULER_H_ */
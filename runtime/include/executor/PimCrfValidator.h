@@ -0,0 +1,52 @@
+/*
+ * Copyright (C) 2022 Samsung Electronics Co. LTD
+ *
+ * This software is a property of Samsung Electronics.
+ * No part of this software, either material or conceptual may be copied or distributed, transmitted,
+ * transcribed, stored in a retrieval system or translated into any human or computer language in any form by any means,
+ * electronic, mechanical, manual or otherwise, or disclosed
+ * to third parties without the express written permission of Samsung Electronics.
+ * (Use of the Software is restricted to non-commercial, personal or academic, research purpose only)
+ */
+
+#ifndef _PIM_CRF_VALIDATOR_H_
+#define _PIM_CRF_VALIDATOR_H_
+
+#include <vector>
+#include "executor/PimCommand.h"
+
+namespace pim
+{
+namespace runtime
+{
+namespace executor
+{
+/* ISA 1.0 rules of CRF programs, checked on the programs generated at runtime and by tools/crfcodegen */
+class PimCrfValidator
+{
+   public:
+    PimCrfValidator(void);
+    virtual ~PimCrfValidator(void);
+
+    /* returns 0 if the program passes every check, -1 otherwise */
+    int validate(const std::vector<PimCommand>& cmds);
+    int check_cmd_validation(const std::vector<PimCommand>& cmds);
+    int check_isa_restriction(const std::vector<PimCommand>& cmds);
+    /* returns the number of data and structural hazards without logging them, so it can be used to place NOPs */
+    int check_hazard(const std::vector<PimCommand>& cmds);
+
+   private:
+    int check_validate_pair(const PimCommand& cmd);
+    void find_next_op(const std::vector<PimCommand>& cmds, int cur_idx, int* next_idx, int* num_nop);
+    int detect_data_hazard(const std::vector<PimCommand>& cmds, int cur_idx, int next_idx, int num_nop);
+    int detect_structural_hazard(const std::vector<PimCommand>& cmds, int cur_idx, int next_idx, int num_nop);
+    int get_hazard_table_idx(const PimCommand& cmd);
+    int is_register(PimOpdType opd_type);
+    int is_read_register(const PimCommand& cmd);
+};
+
+} /* namespace executor */
+} /* namespace runtime */
+} /* namespace pim */
+
+#endif /* _PIM_CRF_VALIDATOR_H_ */
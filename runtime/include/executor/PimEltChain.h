@@ -0,0 +1,34 @@
+/*
+ * Copyright (C) 2022 Samsung Electronics Co. LTD
+ *
+ * This software is a property of Samsung Electronics.
+ * No part of this software, either material or conceptual may be copied or distributed, transmitted,
+ * transcribed, stored in a retrieval system or translated into any human or computer language in any form by any means,
+ * electronic, mechanical, manual or otherwise, or disclosed
+ * to third parties without the express written permission of Samsung Electronics.
+ * (Use of the Software is restricted to non-commercial, personal or academic, research purpose only)
+ */
+
+#ifndef _PIM_ELT_CHAIN_H_
+#define _PIM_ELT_CHAIN_H_
+
+#include "pim_data_types.h"
+
+namespace pim
+{
+namespace runtime
+{
+namespace executor
+{
+class IPimExecutor;
+
+/* checks the buffers and steps of a chain, returns 0 if it can be executed */
+int check_elt_chain(PimBo* output, PimBo* input, const PimEltChainStep* steps, int num_steps);
+/* runs the chain step by step in place on output, as the reference of the fused program */
+int execute_elt_chain_steps(IPimExecutor* executor, PimBo* output, PimBo* input, const PimEltChainStep* steps,
+                            int num_steps, void* stream, bool block);
+} /* namespace executor */
+} /* namespace runtime */
+} /* namespace pim */
+
+#endif /* _PIM_ELT_CHAIN_H_ */
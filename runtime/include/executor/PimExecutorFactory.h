@@ -13,6 +13,7 @@
 #define _PIM_EXECUTOR_FACTORY_H_
 
 #include "executor/IPimExecutor.h"
+#include "executor/cpu/CpuPimExecutor.h"
 #include "executor/hip/HipPimExecutor.h"
 #include "executor/ocl/OclPimExecutor.h"
 #include "manager/PimInfo.h"
@@ -36,6 +37,8 @@ class PimExecutorFactory
             return std::make_shared<HipPimExecutor>(pim_manager, pim_runtime, precision);
         } else if (rt_type == RT_TYPE_OPENCL) {
             return std::make_shared<OclPimExecutor>(pim_manager, pim_runtime, precision);
+        } else if (rt_type == RT_TYPE_CPU) {
+            return std::make_shared<CpuPimExecutor>(pim_manager, pim_runtime, precision);
         } else {
             throw std::invalid_argument("invalid type of runtime");
         }
@@ -0,0 +1,59 @@
+/*
+ * Copyright (C) 2022 Samsung Electronics Co. LTD
+ *
+ * This software is a property of Samsung Electronics.
+ * No part of this software, either material or conceptual may be copied or distributed, transmitted,
+ * transcribed, stored in a retrieval system or translated into any human or computer language in any form by any means,
+ * electronic, mechanical, manual or otherwise, or disclosed
+ * to third parties without the express written permission of Samsung Electronics.
+ * (Use of the Software is restricted to non-commercial, personal or academic, research purpose only)
+ */
+
+#ifndef _PIM_GRAPH_H_
+#define _PIM_GRAPH_H_
+
+#include <memory>
+#include <vector>
+#include "pim_data_types.h"
+
+namespace pim
+{
+namespace runtime
+{
+namespace executor
+{
+class IPimExecutor;
+
+typedef struct __PimGraphNode {
+    PimOpType op_type;
+    PimBo* output;
+    PimBo* operand0;
+    PimBo* operand1; /* second operand of add/mul, weight of gemm */
+    PimBo* bias;
+    PimBo* beta;
+    PimBo* gamma;
+    PimBo* mean;
+    PimBo* variance;
+    double epsilon;
+    uint16_t scalar; /* FP16 scalar of add/mul with a scalar */
+    PimActFunc act_func;
+    PimGemmOrder gemm_order;
+    std::vector<PimEltChainStep> chain; /* steps of a fused elementwise chain applied to operand0 */
+} PimGraphNode;
+
+PimGraphNode make_graph_node(PimOpType op_type, PimBo* output, PimBo* operand0, PimBo* operand1 = nullptr);
+/* runs one recorded node like the matching execute_* call, without synchronization */
+int execute_graph_node(IPimExecutor* executor, const PimGraphNode& node, void* stream);
+/* runs every node in order and synchronizes once if block is set */
+int execute_graph_nodes(IPimExecutor* executor, const PimGraph* graph, void* stream, bool block);
+} /* namespace executor */
+} /* namespace runtime */
+} /* namespace pim */
+
+struct __PimGraph {
+    std::vector<pim::runtime::executor::PimGraphNode> nodes;
+    /* launch state prepared by the executor when the capture ended, released with the graph */
+    std::shared_ptr<void> launch_data;
+};
+
+#endif /* _PIM_GRAPH_H_ */
@@ -0,0 +1,92 @@
+/*
+ * Copyright (C) 2022 Samsung Electronics Co. LTD
+ *
+ * This software is a property of Samsung Electronics.
+ * No part of this software, either material or conceptual may be copied or distributed, transmitted,
+ * transcribed, stored in a retrieval system or translated into any human or computer language in any form by any means,
+ * electronic, mechanical, manual or otherwise, or disclosed
+ * to third parties without the express written permission of Samsung Electronics.
+ * (Use of the Software is restricted to non-commercial, personal or academic, research purpose only)
+ */
+
+#ifndef _CPU_PIM_EXECUTOR_H_
+#define _CPU_PIM_EXECUTOR_H_
+
+#include <memory>
+#include <vector>
+#include "PimRuntime.h"
+#include "executor/IPimExecutor.h"
+#include "executor/cpu/CpuPimKernels.h"
+#include "manager/PimGemmWeightReorder.h"
+#include "manager/PimInfo.h"
+#include "manager/PimManager.h"
+#include "pim_data_types.h"
+
+namespace pim
+{
+namespace runtime
+{
+namespace executor
+{
+class CpuPimExecutor : public IPimExecutor
+{
+    /**
+     * @brief Reference executor computing PIM operations on the host CPU
+     *
+     * Selected with PimInitialize(RT_TYPE_CPU). Operands follow the same buffer objects and layouts as on PIM:
+     * elementwise ops work on the whole padded buffer, GEMM weights may be RAW (optionally transposed) or
+     * reordered to CHWISE/ALIGNED layouts, which are read back through the host reorder engine.
+     * Every call completes before it returns, so streams are not used.
+     */
+
+   public:
+    CpuPimExecutor(pim::runtime::manager::PimManager* pim_manager, pim::runtime::PimRuntime* pim_runtime,
+                   PimPrecision precision);
+    virtual ~CpuPimExecutor(void);
+
+    int initialize(void);
+    int deinitialize(void);
+    int execute_add(PimBo* output, PimBo* operand0, PimBo* operand1, void* stream, bool block);
+    int execute_mul(PimBo* output, PimBo* operand0, PimBo* operand1, void* stream, bool block);
+    int execute_add_scalar(PimBo* output, uint16_t scalar, PimBo* operand, void* stream, bool block);
+    int execute_mul_scalar(PimBo* output, uint16_t scalar, PimBo* operand, void* stream, bool block);
+    int execute_relu(PimBo* output, PimBo* pim_data, void* stream, bool block);
+    int execute_elt_chain(PimBo* output, PimBo* input, const PimEltChainStep* steps, int num_steps, void* stream,
+                          bool block);
+    int execute_copy(PimBo* output, PimBo* pim_data, void* stream, bool block);
+    int execute_bn(PimBo* output, PimBo* pim_data, PimBo* beta, PimBo* gamma, PimBo* mean, PimBo* variance,
+                   double epsilon, void* stream, bool block);
+    int execute_gemm(PimBo* output, PimBo* input, PimBo* weight, PimBo* bias, PimActFunc act_func, void* stream,
+                     bool block);
+    int execute_custom_gemv(PimBo* output, PimBo* operand0, PimBo* operand1, bool is_gemv_add, void* stream,
+                            bool block);
+    int execute_custom_gemv_add(PimBo* output, PimBo* operand0, PimBo* operand1, PimBo* operand2, bool relu,
+                                void* stream, bool block);
+    int execute_sync(void* stream);
+    int instantiate_graph(PimGraph* graph);
+    int execute_graph(PimGraph* graph, void* stream, bool block);
+    int execute_dummy(void);
+    void* createStream(void);
+    void set_gemm_order(PimGemmOrder gemm_order) { gemm_order_ = gemm_order; }
+    int load_crf_program(PimOpType op_type, const PimCrfProgram& program);
+
+   private:
+    int check_elt_operands(PimBo* output, PimBo* operand0, PimBo* operand1, size_t* len);
+    int get_gemm_weight(PimBo* weight, std::vector<float>* wei_f, size_t* ldb);
+    int get_gemm_input(PimBo* input, std::vector<float>* in_f, size_t* lda);
+
+   private:
+    pim::runtime::manager::PimManager* pim_manager_;
+    pim::runtime::PimRuntime* pim_runtime_;
+    std::shared_ptr<pim::runtime::manager::PimDevice> pim_device_;
+    std::shared_ptr<CpuPimKernels> kernels_;
+    std::shared_ptr<pim::runtime::manager::PimGemmWeightReorder> weight_reorder_;
+    PimPrecision precision_;
+    PimBlockInfo* pbi_;
+    PimGemmOrder gemm_order_;
+};
+}  // namespace executor
+}  // namespace runtime
+}  // namespace pim
+
+#endif /* _CPU_PIM_EXECUTOR_H_ */
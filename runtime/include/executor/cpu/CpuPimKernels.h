@@ -0,0 +1,64 @@
+/*
+ * Copyright (C) 2022 Samsung Electronics Co. LTD
+ *
+ * This software is a property of Samsung Electronics.
+ * No part of this software, either material or conceptual may be copied or distributed, transmitted,
+ * transcribed, stored in a retrieval system or translated into any human or computer language in any form by any means,
+ * electronic, mechanical, manual or otherwise, or disclosed
+ * to third parties without the express written permission of Samsung Electronics.
+ * (Use of the Software is restricted to non-commercial, personal or academic, research purpose only)
+ */
+
+#ifndef _CPU_PIM_KERNELS_H_
+#define _CPU_PIM_KERNELS_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace pim
+{
+namespace runtime
+{
+namespace executor
+{
+class CpuPimKernels
+{
+    /**
+     * @brief FP16 host kernels of the CPU executor
+     *
+     * FP16 values are passed as raw uint16_t bits and computed in fp32, the way PIM units accumulate.
+     * Work is split over std::threads and uses AVX2/FMA/F16C when the host CPU supports them,
+     * otherwise a scalar path gives the same results.
+     */
+
+   public:
+    CpuPimKernels(int num_threads = 0);
+
+    void add(uint16_t* out, const uint16_t* in0, const uint16_t* in1, size_t len);
+    void mul(uint16_t* out, const uint16_t* in0, const uint16_t* in1, size_t len);
+    void relu(uint16_t* out, const uint16_t* in, size_t len);
+    /* out = in * scale[c] + shift[c] for every channel c of num_batch x num_ch planes of plane_len elements */
+    void scale_shift(uint16_t* out, const uint16_t* in, const float* scale, const float* shift, size_t num_batch,
+                     size_t num_ch, size_t plane_len);
+    /* c[i * ldc + j] = dot(a + i * lda, b + j * ldb, k) for i < m, j < n */
+    void gemm_nt(float* c, size_t ldc, const float* a, size_t lda, const float* b, size_t ldb, int m, int n, int k);
+    /* dst[j * ldd + i] = src[i * lds + j] for i < rows, j < cols */
+    void transpose(float* dst, size_t ldd, const float* src, size_t lds, int rows, int cols);
+
+    void half_to_float(float* dst, const uint16_t* src, size_t len);
+    void float_to_half(uint16_t* dst, const float* src, size_t len);
+    int num_threads(void) const { return num_threads_; }
+    bool is_simd_enabled(void) const { return use_avx2_; }
+
+   private:
+    template <typename Func>
+    void parallel_for(size_t count, size_t min_per_thread, Func func);
+
+    int num_threads_;
+    bool use_avx2_;
+};
+} /* namespace executor */
+} /* namespace runtime */
+} /* namespace pim */
+
+#endif /* _CPU_PIM_KERNELS_H_ */
@@ -12,6 +12,8 @@
 #ifndef _HIP_PIM_EXECUTOR_H_
 #define _HIP_PIM_EXECUTOR_H_
 
+#include <thread>
+#include <vector>
 #include "PimRuntime.h"
 #include "emulator/hip/HipPimEmulator.h"
 #include "executor/IPimExecutor.h"
@@ -39,7 +41,11 @@ class HipPimExecutor : public IPimExecutor
     int deinitialize(void);
     int execute_add(PimBo* output, PimBo* operand0, PimBo* operand1, void* stream, bool block);
     int execute_mul(PimBo* output, PimBo* operand0, PimBo* operand1, void* stream, bool block);
+    int execute_add_scalar(PimBo* output, uint16_t scalar, PimBo* operand, void* stream, bool block);
+    int execute_mul_scalar(PimBo* output, uint16_t scalar, PimBo* operand, void* stream, bool block);
     int execute_relu(PimBo* output, PimBo* pim_data, void* stream, bool block);
+    int execute_elt_chain(PimBo* output, PimBo* input, const PimEltChainStep* steps, int num_steps, void* stream,
+                          bool block);
     int execute_copy(PimBo* output, PimBo* pim_data, void* stream, bool block);
     int execute_bn(PimBo* output, PimBo* pim_data, PimBo* beta, PimBo* gamma, PimBo* mean, PimBo* variance,
                    double epsilon, void* stream, bool block);
@@ -54,17 +60,27 @@ class HipPimExecutor : public IPimExecutor
     int execute_custom_gemv_add(PimBo* output, PimBo* operand0, PimBo* operand1, PimBo* operand2, bool relu,
                                 void* stream, bool block);
     int execute_sync(void* stream);
+    int instantiate_graph(PimGraph* graph);
+    int execute_graph(PimGraph* graph, void* stream, bool block);
     int execute_dummy(void);
     void* createStream(void);
     void set_gemm_order(PimGemmOrder gemm_order) { gemm_order_ = gemm_order; }
+    int load_crf_program(PimOpType op_type, const PimCrfProgram& program);
 
    private:
+    uint8_t* get_crf_bin(PimOpType op_type, int output_size);
+    int execute_elt_scalar_op(PimOpType op_type, PimBo* output, uint16_t scalar, PimBo* operand, void* stream,
+                              bool block);
     int execute_gemv_next_pim(PimBo* output, PimBo* operand0, PimBo* operand1, int is_gemv_add, void* stream,
                               bool block);
     int execute_aligned_gemm_tile_accum(PimBo* output, PimBo* input, PimBo* weight, PimBo* bias, PimActFunc act_func,
                                         void* stream, bool block);
     int execute_chwise_gemm_tile_accum(PimBo* output, PimBo* input, PimBo* weight, PimBo* bias, PimActFunc act_func,
                                        void* stream, bool block);
+#ifdef EMULATOR
+    void start_trace_collection(unsigned blocks, hipStream_t stream);
+    void finish_trace_collection(PimOpType op_type);
+#endif
 
    private:
     pim::runtime::manager::PimManager* pim_manager_;
@@ -94,6 +110,12 @@ class HipPimExecutor : public IPimExecutor
     int fmtd_size_per_ch_;
     int max_block_size_;
     int max_fmtd_size_;
+    int trace_chunk_chans_;
+    hipStream_t trace_stream_;
+    std::vector<hipEvent_t> trace_events_;
+    std::vector<int> trace_chunk_end_;
+    std::thread trace_collector_;
+    pim::runtime::emulator::TraceChunkQueue trace_queue_;
 #endif
 };
 }  // namespace executor
@@ -39,7 +39,11 @@ class OclPimExecutor : public IPimExecutor
     int deinitialize(void);
     int execute_add(PimBo* output, PimBo* operand0, PimBo* operand1, void* stream, bool block);
     int execute_mul(PimBo* output, PimBo* operand0, PimBo* operand1, void* stream, bool block);
+    int execute_add_scalar(PimBo* output, uint16_t scalar, PimBo* operand, void* stream, bool block);
+    int execute_mul_scalar(PimBo* output, uint16_t scalar, PimBo* operand, void* stream, bool block);
     int execute_relu(PimBo* output, PimBo* pim_data, void* stream, bool block);
+    int execute_elt_chain(PimBo* output, PimBo* input, const PimEltChainStep* steps, int num_steps, void* stream,
+                          bool block);
     int execute_copy(PimBo* output, PimBo* pim_data, void* stream, bool block);
     int execute_bn(PimBo* output, PimBo* pim_data, PimBo* beta, PimBo* gamma, PimBo* mean, PimBo* variance,
                    double epsilon, void* stream, bool block);
@@ -51,9 +55,12 @@ class OclPimExecutor : public IPimExecutor
                                 void* stream, bool block);
 
     int execute_sync(void* stream);
+    int instantiate_graph(PimGraph* graph);
+    int execute_graph(PimGraph* graph, void* stream, bool block);
     int execute_dummy(void) { return -1; }
     void* createStream(void) { return nullptr; }
     void set_gemm_order(PimGemmOrder gemm_order) { gemm_order_ = gemm_order; }
+    int load_crf_program(PimOpType op_type, const PimCrfProgram& program);
 
    private:
     int check_cl_program_path(void);
@@ -61,8 +68,12 @@ class OclPimExecutor : public IPimExecutor
     int save_cl_program_binary(void);
     int build_cl_program_with_binary(void);
     std::string load_cl_file(std::string filename);
+    void load_cl_program_source(void);
+    std::string get_cl_program_key(void);
 
     int execute_eltwise(PimOpType eltop, PimBo* output, PimBo* operand0, PimBo* operand1, void* stream, bool block);
+    int execute_eltwise_scalar(PimOpType eltop, PimBo* output, uint16_t scalar, PimBo* operand, void* stream,
+                               bool block);
     int execute_aligned_gemm_tile_accum(PimBo* output, PimBo* input, PimBo* weight, PimBo* bias, PimActFunc act_func,
                                         void* stream, bool block);
     int execute_chwise_gemm_tile_accum(PimBo* output, PimBo* input, PimBo* weight, PimBo* bias, PimActFunc act_func,
@@ -90,6 +101,9 @@ class OclPimExecutor : public IPimExecutor
 
     std::string cl_binary_path_;
     std::string cl_binary_;
+    std::string cl_source_;
+    std::string cl_build_options_;
+    std::string cl_cache_dir_;
     void* base_address_;
 
     cl_program program_;
@@ -101,6 +115,7 @@ class OclPimExecutor : public IPimExecutor
     cl_kernel relu_kernel_;
     cl_kernel copy_kernel_;
     cl_kernel bn_kernel_;
+    cl_kernel elt_scalar_kernel_;
     cl_kernel pim_aligned_gemm_bias_relu_8tile_fp16_;
     cl_kernel pim_aligned_gemm_bias_relu_fp16_;
     cl_kernel pim_chwise_gemm_bias_relu_32tile_fp16_;
@@ -16,6 +16,7 @@
 #define PIM_GEMV_IN_ALIGN (256)
 #define PIM_GEMV_OUT_ALIGN (4096)
 #define PIM_ELTWISE_ALIGN (256 * 1024)
+#define PIM_OP_MAX_STATEMENTS 16
 
 typedef unsigned long uint64_t;
 typedef unsigned int uint32_t;
@@ -84,6 +85,14 @@ typedef enum __PimKrnlType {
     CUSTOM_GPU,
 } PimKrnlType;
 
+/* bank reads which drive a single op program, mirrors PimOpStmtArgs of PimCrfBinGen.h */
+typedef struct __PimOpStmtArgs {
+    int stmt_src[PIM_OP_MAX_STATEMENTS];
+    int stmt_cols[PIM_OP_MAX_STATEMENTS];
+    int num_even_stmt;
+    int num_stmt;
+} PimOpStmtArgs;
+
 #ifdef EMULATOR
 typedef struct __PimMemTracer {
     uint64_t g_fba;
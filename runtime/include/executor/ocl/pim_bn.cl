@@ -25,7 +25,8 @@ static __constant uint8_t bn_hab_to_hab_pim[32] = {
 
 __kernel void bn_pim_nr_sip(__global uint8_t* __restrict__ pim_data, __global uint8_t* __restrict__ output,
                             __global uint8_t* __restrict__ pim_ctr, int num_tile, __global uint8_t* crf_binary,
-                            int crf_size, __global uint8_t* srf_binary, int srf_size
+                            int crf_size, __global uint8_t* srf_binary, int srf_size,
+                            PimOpStmtArgs args
 #ifdef EMULATOR
                             ,
                             __global PimMemTraceData* fmtd16, __global size_t* frd_size, int mt_width,
@@ -93,26 +94,11 @@ __kernel void bn_pim_nr_sip(__global uint8_t* __restrict__ pim_data, __global ui
             addr_even = addr + offset;
             addr_odd = addr_even + 0x2000;
 
-            R_CMD(&pim_data[addr_even]);
-            B_CMD(1);
-
-            R_CMD(&pim_data[addr_even]);
-            B_CMD(1);
-
-            R_CMD(&pim_data[addr_even]);
-            B_CMD(1);
-
-            R_CMD(&pim_data[addr_even]);
-            B_CMD(1);
-
-            R_CMD(&pim_data[addr_odd]);
-            B_CMD(1);
-
-            R_CMD(&pim_data[addr_odd]);
-            B_CMD(1);
-
-            R_CMD(&pim_data[addr_odd]);
-            B_CMD(1);
+            /* the hazard NOPs between the MADs take only the reads the scheduled NOP needs */
+            for (int stmt = 0; stmt < args.num_stmt; stmt++) {
+                if (gidx < args.stmt_cols[stmt]) R_CMD(&pim_data[stmt < args.num_even_stmt ? addr_even : addr_odd]);
+                B_CMD(1);
+            }
 
             W_CMD(&output[addr_even]);
             B_CMD(1);
@@ -15,7 +15,8 @@
 #define COMPUTE_COPY 1
 
 __kernel void copy_pim(__global uint8_t* __restrict__ pim_data, __global uint8_t* __restrict__ output,
-                       __global uint8_t* __restrict__ pim_ctr, int size, __global uint8_t* crf_binary, int crf_size
+                       __global uint8_t* __restrict__ pim_ctr, int size, __global uint8_t* crf_binary, int crf_size,
+                       PimOpStmtArgs args
 #ifdef EMULATOR
                        ,
                        __global PimMemTraceData* fmtd16, __global size_t* frd_size, int mt_width,
@@ -67,10 +68,19 @@ __kernel void copy_pim(__global uint8_t* __restrict__ pim_data, __global uint8_t
         W_CMD(&pim_ctr[addr + offset]);
         B_CMD(1);
 #endif
+    }
+
 #if PROGRAM_CRF
+    /* a scheduled program can be longer than eight commands */
+    if (get_local_id(0) < (crf_size >> 4)) {
         addr = addr_gen_(get_group_id(0), 0, 0, 1, 0x3fff, 0x4 + gidx);
         W_CMD_R(&pim_ctr[addr + offset], crf_binary + (get_local_id(0) << 4));
+        R_CMD(&pim_ctr[addr + offset]);
+    }
+    B_CMD(1);
 #endif
+
+    if (get_local_id(0) < 2) {
 #if CHANGE_HAB_HABPIM
         addr = addr_gen_(get_group_id(0), 0, 0, 0, 0x3fff, 0x0);
         W_CMD_R_C(&pim_ctr[addr + offset], elt_add_hab_to_hab_pim + offset);
@@ -90,15 +100,19 @@ __kernel void copy_pim(__global uint8_t* __restrict__ pim_data, __global uint8_t
             addr_even = addr + offset;
             addr_odd = addr_even + 0x2000;
 
-            R_CMD(&pim_data[addr_even]);
-            B_CMD(1);
+            for (int stmt = 0; stmt < args.num_even_stmt; stmt++) {
+                if (gidx < args.stmt_cols[stmt]) R_CMD(&pim_data[addr_even]);
+                B_CMD(1);
+            }
 
             W_CMD(&output[addr_even]);
             R_CMD(&output[addr_even]);
             B_CMD(1);
 
-            R_CMD(&pim_data[addr_odd]);
-            B_CMD(1);
+            for (int stmt = args.num_even_stmt; stmt < args.num_stmt; stmt++) {
+                if (gidx < args.stmt_cols[stmt]) R_CMD(&pim_data[addr_odd]);
+                B_CMD(1);
+            }
 
             W_CMD(&output[addr_odd]);
             R_CMD(&output[addr_odd]);
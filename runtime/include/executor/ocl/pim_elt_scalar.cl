@@ -0,0 +1,127 @@
+/*
+ * Copyright (C) 2022 Samsung Electronics Co. LTD
+ *
+ * This software is a property of Samsung Electronics.
+ * No part of this software, either material or conceptual may be copied or distributed, transmitted,
+ * transcribed, stored in a retrieval system or translated into any human or computer language in any form by any means,
+ * electronic, mechanical, manual or otherwise, or disclosed
+ * to third parties without the express written permission of Samsung Electronics.
+ * (Use of the Software is restricted to non-commercial, personal or academic, research purpose only)
+ */
+
+#ifndef _PIM_ELT_SCALAR_KERNELS_PIMK_
+#define _PIM_ELT_SCALAR_KERNELS_PIMK_
+
+/* scalar operand is programmed into the SRF with the same mode change as BN (pim_bn.cl) */
+__kernel void elt_scalar_op_pim(__global uint8_t* __restrict__ operand, __global uint8_t* __restrict__ output,
+                                __global uint8_t* __restrict__ pim_ctr, int num_tile, __global uint8_t* crf_binary,
+                                int crf_size, __global uint8_t* srf_binary, PimOpStmtArgs args
+#ifdef EMULATOR
+                                ,
+                                __global PimMemTraceData* fmtd16, __global size_t* frd_size, int mt_width,
+                                __global PimMemTracer* emulator_trace
+#endif
+                                )
+{
+#ifdef EMULATOR
+    emulator_trace->g_fba = (uint64_t)pim_ctr;
+    emulator_trace->g_fmtd16 = fmtd16;
+    emulator_trace->g_ridx[get_group_id(0)] = 0;
+    emulator_trace->m_width = mt_width;
+    barrier(CLK_LOCAL_MEM_FENCE);
+#endif
+    int num_col = 32;
+    int num_grf = 8;
+    int num_ba = 4;
+    int gidx = get_local_id(0) / 2;
+    uint64_t offset = (get_local_id(0) % 2) * 0x10;
+    uint64_t addr, addr_even, addr_odd;
+
+    addr = addr_gen_(get_group_id(0), 0, gidx / num_ba, gidx % num_ba, (1 << 13), 0);
+    W_CMD(&pim_ctr[addr + offset]);
+    B_CMD(1);
+
+    if (get_local_id(0) < 2) {
+        addr = addr_gen_(get_group_id(0), 0, 2, 0, 0x27ff, 0x1f);
+        W_CMD(&pim_ctr[addr + offset]);
+        B_CMD(1);
+        addr = addr_gen_(get_group_id(0), 0, 2, 1, 0x27ff, 0x1f);
+        W_CMD(&pim_ctr[addr + offset]);
+        B_CMD(1);
+        addr = addr_gen_(get_group_id(0), 0, 0, 0, 0x27ff, 0x1f);
+        W_CMD(&pim_ctr[addr + offset]);
+        B_CMD(1);
+        addr = addr_gen_(get_group_id(0), 0, 0, 1, 0x27ff, 0x1f);
+        W_CMD(&pim_ctr[addr + offset]);
+        B_CMD(1);
+    }
+
+    /* a scheduled program can be longer than eight commands */
+    if (get_local_id(0) < (crf_size >> 4)) {
+        addr = addr_gen_(get_group_id(0), 0, 0, 1, 0x3fff, 0x4 + gidx);
+        W_CMD_R(&pim_ctr[addr + offset], crf_binary + (get_local_id(0) << 4));
+        R_CMD(&pim_ctr[addr + offset]);
+    }
+    B_CMD(1);
+
+    if (get_local_id(0) < 2) {
+        addr = addr_gen_(get_group_id(0), 0, 0, 0, 0x3fff, 0x0);
+        W_CMD_R(&pim_ctr[addr + 32 + offset], srf_binary + offset);
+        W_CMD_R_C(&pim_ctr[addr + offset], bn_hab_to_hab_pim + offset);
+        R_CMD(&pim_ctr[addr + offset]);
+        B_CMD(1);
+    }
+
+    if (get_local_id(0) < 16) {
+        for (int tile_idx = 0; tile_idx < num_tile; tile_idx++) {
+            unsigned int loc = tile_idx * num_grf + gidx;
+            unsigned int row = loc / num_col;
+            unsigned int col = loc % num_col;
+
+            addr = addr_gen_(get_group_id(0), 0, 0, 0, row, col);
+            addr_even = addr + offset;
+            addr_odd = addr_even + 0x2000;
+
+            for (int stmt = 0; stmt < args.num_even_stmt; stmt++) {
+                if (gidx < args.stmt_cols[stmt]) R_CMD(&operand[addr_even]);
+                B_CMD(1);
+            }
+
+            W_CMD(&output[addr_even]);
+            R_CMD(&output[addr_even]);
+            B_CMD(1);
+
+            for (int stmt = args.num_even_stmt; stmt < args.num_stmt; stmt++) {
+                if (gidx < args.stmt_cols[stmt]) R_CMD(&operand[addr_odd]);
+                B_CMD(1);
+            }
+
+            W_CMD(&output[addr_odd]);
+            R_CMD(&output[addr_odd]);
+            B_CMD(1);
+        }
+    }
+
+    if (get_local_id(0) < 4) {
+        addr = addr_gen_(get_group_id(0), 0, 0, 0, 0x3fff, 0x0);
+        W_CMD_R_C(&pim_ctr[addr + offset], bn_hab_pim_to_hab + offset);
+        R_CMD(&pim_ctr[addr + offset]);
+        B_CMD(1);
+
+        addr = addr_gen_(get_group_id(0), 0, 0, gidx, 0x2fff, 0x1f);
+        W_CMD(&pim_ctr[addr + offset]);
+        R_CMD(&pim_ctr[addr + offset]);
+        B_CMD(1);
+    }
+
+    addr = addr_gen_(get_group_id(0), 0, gidx / num_ba, gidx % num_ba, (1 << 13), 0);
+    W_CMD(&pim_ctr[addr + offset]);
+
+#ifdef EMULATOR
+    if (get_group_id(0) == 0 && get_local_id(0) == 0) {
+        frd_size[0] = emulator_trace->g_ridx[0];
+    }
+#endif
+}
+
+#endif /* _PIM_ELT_SCALAR_KERNELS_PIMK_ */
@@ -247,7 +247,8 @@ void _B_CMD(int type)
 
 __kernel void elt_op_pim(__global uint8_t* __restrict__ operand0, __global uint8_t* __restrict__ operand1,
                          __global uint8_t* __restrict__ output, __global uint8_t* __restrict__ pim_ctr, int num_tile,
-                         __global uint8_t* crf_binary, int crf_size
+                         __global uint8_t* crf_binary, int crf_size,
+                         PimOpStmtArgs args
 #ifdef EMULATOR
                          ,
                          __global PimMemTraceData* fmtd16, __global size_t* frd_size, int mt_width,
@@ -294,10 +295,19 @@ __kernel void elt_op_pim(__global uint8_t* __restrict__ operand0, __global uint8
         W_CMD(&pim_ctr[addr + offset]);
         B_CMD(1);
 #endif
+    }
+
 #if PROGRAM_CRF
+    /* a scheduled program can be longer than eight commands */
+    if (get_local_id(0) < (crf_size >> 4)) {
         addr = addr_gen_(get_group_id(0), 0, 0, 1, 0x3fff, 0x4 + gidx);
-        W_CMD_R(&pim_ctr[addr + offset], crf_binary + offset);
+        W_CMD_R(&pim_ctr[addr + offset], crf_binary + (get_local_id(0) << 4));
+        R_CMD(&pim_ctr[addr + offset]);
+    }
+    B_CMD(1);
 #endif
+
+    if (get_local_id(0) < 2) {
 #if CHANGE_HAB_HABPIM
         addr = addr_gen_(get_group_id(0), 0, 0, 0, 0x3fff, 0x0);
         W_CMD_R_C(&pim_ctr[addr + offset], elt_add_hab_to_hab_pim + offset);
@@ -319,15 +329,13 @@ __kernel void elt_op_pim(__global uint8_t* __restrict__ operand0, __global uint8
 
             /*
             compute for even bank
-            1. fill to GRFA (opr0).
-            2. ADD GRFA and even bank (opr1).
-            3. issue NOP which inturn write data to even bank.
+            1. issue the reads of the scheduled statements (fill GRFA with opr0, op with opr1, hazard NOPs).
+            2. issue NOP which inturn write data to even bank.
             */
-            R_CMD(&operand0[addr_even]);
-            B_CMD(1);
-
-            R_CMD(&operand1[addr_even]);
-            B_CMD(1);
+            for (int stmt = 0; stmt < args.num_even_stmt; stmt++) {
+                if (gidx < args.stmt_cols[stmt]) R_CMD(&(args.stmt_src[stmt] ? operand1 : operand0)[addr_even]);
+                B_CMD(1);
+            }
 
             W_CMD(&output[addr_even]);
             W_CMD(&output[addr_even]);
@@ -337,11 +345,10 @@ __kernel void elt_op_pim(__global uint8_t* __restrict__ operand0, __global uint8
             /*
             compute for odd bank : same as even bank.
             */
-            R_CMD(&operand0[addr_odd]);
-            B_CMD(1);
-
-            R_CMD(&operand1[addr_odd]);
-            B_CMD(1);
+            for (int stmt = args.num_even_stmt; stmt < args.num_stmt; stmt++) {
+                if (gidx < args.stmt_cols[stmt]) R_CMD(&(args.stmt_src[stmt] ? operand1 : operand0)[addr_odd]);
+                B_CMD(1);
+            }
 
             W_CMD(&output[addr_odd]);
             W_CMD(&output[addr_odd]);
@@ -385,7 +392,7 @@ __kernel void elt_op_pim(__global uint8_t* __restrict__ operand0, __global uint8
 
 __kernel void relu_pim_operation(__global uint8_t* __restrict__ pim_data, __global uint8_t* __restrict__ output,
                                  __global uint8_t* __restrict__ pim_ctr, int size, __global uint8_t* crf_binary,
-                                 int crf_size
+                                 int crf_size, PimOpStmtArgs args
 #ifdef EMULATOR
                                  ,
                                  __global PimMemTraceData* fmtd16, __global size_t* frd_size, int mt_width,
@@ -437,10 +444,19 @@ __kernel void relu_pim_operation(__global uint8_t* __restrict__ pim_data, __glob
         W_CMD(&pim_ctr[addr + offset]);
         B_CMD(1);
 #endif
+    }
+
 #if PROGRAM_CRF
+    /* a scheduled program can be longer than eight commands */
+    if (get_local_id(0) < (crf_size >> 4)) {
         addr = addr_gen_(get_group_id(0), 0, 0, 1, 0x3fff, 0x4 + gidx);
         W_CMD_R(&pim_ctr[addr + offset], crf_binary + (get_local_id(0) << 4));
+        R_CMD(&pim_ctr[addr + offset]);
+    }
+    B_CMD(1);
 #endif
+
+    if (get_local_id(0) < 2) {
 #if CHANGE_HAB_HABPIM
         addr = addr_gen_(get_group_id(0), 0, 0, 0, 0x3fff, 0x0);
         W_CMD_R_C(&pim_ctr[addr + offset], elt_add_hab_to_hab_pim + offset);
@@ -460,15 +476,19 @@ __kernel void relu_pim_operation(__global uint8_t* __restrict__ pim_data, __glob
             addr_even = addr + offset;
             addr_odd = addr_even + 0x2000;
 
-            R_CMD(&pim_data[addr_even]);
-            B_CMD(1);
+            for (int stmt = 0; stmt < args.num_even_stmt; stmt++) {
+                if (gidx < args.stmt_cols[stmt]) R_CMD(&pim_data[addr_even]);
+                B_CMD(1);
+            }
 
             W_CMD(&output[addr_even]);
             R_CMD(&output[addr_even]);
             B_CMD(1);
 
-            R_CMD(&pim_data[addr_odd]);
-            B_CMD(1);
+            for (int stmt = args.num_even_stmt; stmt < args.num_stmt; stmt++) {
+                if (gidx < args.stmt_cols[stmt]) R_CMD(&pim_data[addr_odd]);
+                B_CMD(1);
+            }
 
             W_CMD(&output[addr_odd]);
             R_CMD(&output[addr_odd]);
@@ -13,6 +13,7 @@
 #define _PIM_MEMORY_MANAGER_H_
 
 #include "pim_data_types.h"
+#include "utility/pim_hash.h"
 
 namespace pim
 {
@@ -32,7 +33,13 @@ class IPimMemoryManager
     virtual int copy_memory(void* dst, void* src, size_t size, PimMemCpyType cpy_type) = 0;
     virtual int copy_memory(PimBo* dst, PimBo* src, PimMemCpyType cpy_type) = 0;
     virtual int copy_memory_3d(const PimCopy3D* copy_params) = 0;
-    virtual int convert_data_layout(PimBo* dst, PimBo* src, bool reorder_on_device, void* stream = nullptr) = 0;
+    /* src_transposed: src holds the [in][out] transpose of the gemm_order layout */
+    virtual int convert_data_layout(PimBo* dst, PimBo* src, bool reorder_on_device, void* stream = nullptr,
+                                    bool src_transposed = false) = 0;
+    /* inverse of convert_data_layout, dst_transposed: dst gets the [in][out] transpose of the gemm_order layout */
+    virtual int restore_data_layout(PimBo* dst, PimBo* src, bool restore_on_device, void* stream = nullptr,
+                                    bool dst_transposed = false) = 0;
+    virtual int get_content_hash(PimBo* pim_bo, PimContentHash* hash) = 0;
     virtual void set_gemm_order(PimGemmOrder gemm_order) = 0;
     virtual void* get_base_memobj(void) = 0;
 };
@@ -0,0 +1,143 @@
+/*
+ * Copyright (C) 2022 Samsung Electronics Co. LTD
+ *
+ * This software is a property of Samsung Electronics.
+ * No part of this software, either material or conceptual may be copied or distributed, transmitted,
+ * transcribed, stored in a retrieval system or translated into any human or computer language in any form by any means,
+ * electronic, mechanical, manual or otherwise, or disclosed
+ * to third parties without the express written permission of Samsung Electronics.
+ * (Use of the Software is restricted to non-commercial, personal or academic, research purpose only)
+ */
+
+#ifndef _PIM_GEMM_WEIGHT_REORDER_H_
+#define _PIM_GEMM_WEIGHT_REORDER_H_
+
+#include <vector>
+#include "manager/PimInfo.h"
+#include "pim_data_types.h"
+
+namespace pim
+{
+namespace runtime
+{
+namespace manager
+{
+class PimGemmWeightReorder
+{
+    /**
+     * @brief Host reorder engine for CHWISE/ALIGNED GEMM weight layouts
+     *
+     * The bank/row/column walk of the layout is first planned per GRF block (num_grf_A x num_grf_B transfers),
+     * then the blocks are copied by several threads with vector loads and stores. Both buffers have to be
+     * host accessible; memory managers stage device memory around it with one bulk copy in each direction.
+     * restore_* walk the same plan backwards and rebuild the [out][in] source order of a reordered weight.
+     * With src_transposed (dst_transposed for restore) the FP16 weight is kept as the [h][w] matrices which
+     * transpose_pimbo would turn into the source, as an I_X_W weight or a transposed W_X_I weight is stored, and
+     * every GRF block is transposed in a small tile on its way, so no transposed copy of the weight is made.
+     * plan_tiles cuts the same plan into pieces of about tile_size bytes, each with its own source and reordered
+     * byte range, so a preload can stage, reorder and write back one piece while the next one is transferred.
+     * plan_block_bases turns the same plan into the start addresses a device kernel copies the blocks from.
+     */
+
+   public:
+    typedef struct __GrfBlock {
+        uint64_t data_offset; /* offset of the batch in src and dst */
+        uint32_t out_idx;     /* first output row of the block */
+        uint32_t in_idx;      /* first input transfer of the block */
+        uint32_t chan;
+        uint32_t rank;
+        uint32_t bg;
+        uint32_t bank;
+        uint32_t row;
+        uint32_t col;
+    } GrfBlock;
+
+    /*
+     * A piece of a tiled reorder. It reads the [out][in] rows [raw_offset, raw_offset + raw_size) of the source,
+     * staged as num_rows packed rows of row_size bytes which lie src_pitch apart from src_offset in the stored
+     * source; a transposed source is staged as the [in][out] slab of those columns. It writes only
+     * [pim_offset, pim_offset + pim_size) of the reordered weight, and the ranges of the tiles never overlap.
+     */
+    typedef struct __ReorderTile {
+        uint64_t raw_offset;
+        uint64_t raw_size;
+        uint64_t src_offset;
+        uint64_t src_pitch;
+        uint64_t row_size;
+        uint64_t num_rows;
+        uint64_t pim_offset;
+        uint64_t pim_size;
+        size_t first_block;
+        size_t num_blocks;
+        bool covered; /* every byte of the pim range is written, so it needs no read back */
+    } ReorderTile;
+
+    typedef struct __ReorderPlan {
+        std::vector<GrfBlock> blocks;
+        std::vector<ReorderTile> tiles;
+        PimBShape bshape;
+        int in_cnt;
+        bool src_transposed;
+        uint64_t max_raw_size; /* largest staging buffers a tile needs */
+        uint64_t max_pim_size;
+    } ReorderPlan;
+
+    /*
+     * Start addresses of a GRF block for a device reorder. Transfer t of the block is read from
+     * src_base + ((t / num_grf) * in_cnt + t % num_grf) * trans_size (the quotient and the remainder are swapped on
+     * the emulator) and written to dst_base plus the address of column col + t, counted on from the block's row.
+     */
+    typedef struct __BlockBase {
+        uint64_t src_base;
+        uint64_t dst_base;
+        uint32_t col;
+    } BlockBase;
+
+    PimGemmWeightReorder(PimBlockInfo* pbi, int num_threads = 0);
+
+    int reorder_chwise(void* dst, size_t dst_size, const void* src, const PimBo* src_bo, PimGemmOrder gemm_order,
+                       bool src_transposed = false);
+    int reorder_aligned(void* dst, size_t dst_size, const void* src, const PimBo* src_bo, PimGemmOrder gemm_order,
+                        bool src_transposed = false);
+    int restore_chwise(void* dst, const PimBo* dst_bo, const void* src, size_t src_size, PimGemmOrder gemm_order,
+                       bool dst_transposed = false);
+    int restore_aligned(void* dst, const PimBo* dst_bo, const void* src, size_t src_size, PimGemmOrder gemm_order,
+                        bool dst_transposed = false);
+    int plan_tiles(const PimBo* raw_bo, size_t pim_size, PimGemmOrder gemm_order, bool is_chwise, bool src_transposed,
+                   size_t tile_size, ReorderPlan* plan);
+    int reorder_tile(void* dst, const void* src, const ReorderPlan& plan, size_t tile_idx);
+    int plan_block_bases(const PimBo* raw_bo, size_t pim_size, PimGemmOrder gemm_order, bool is_chwise,
+                         std::vector<BlockBase>* bases, int* in_cnt);
+    static void pad_aligned_source(void* dst, const void* src, const PimBo* src_bo);
+    static void unpad_aligned_source(void* dst, const void* src, const PimBo* dst_bo);
+
+   private:
+    /* a staged part of a buffer, starting at byte offset of the whole buffer */
+    typedef struct __Window {
+        char* data;
+        uint64_t offset;
+        uint64_t size;
+    } Window;
+
+    void plan_batch(uint64_t data_offset, int out_cnt, int in_cnt, std::vector<GrfBlock>* blocks);
+    void plan_chwise(const PimBo* raw_bo, PimGemmOrder gemm_order, std::vector<GrfBlock>* blocks, int* in_cnt);
+    void plan_aligned(const PimBo* raw_bo, PimGemmOrder gemm_order, std::vector<GrfBlock>* blocks, int* in_cnt);
+    int copy_blocks(const Window& pim, const Window& raw, int in_cnt, const GrfBlock* blocks, size_t num_blocks,
+                    bool to_raw, const PimBShape* t_shape = nullptr);
+    int copy_block_range(const Window& pim, const Window& raw, int in_cnt, const GrfBlock* blocks, size_t num_blocks,
+                         bool to_raw, const PimBShape* t_shape);
+    void transpose_block(const Window& raw, const GrfBlock& blk, int in_cnt, const PimBShape* t_shape,
+                         uint16_t* tile, int tile_in, bool to_raw);
+    void add_block_extent(const GrfBlock& blk, int in_cnt, ReorderTile* tile);
+    void finish_tile(const PimBo* raw_bo, size_t pim_size, bool src_transposed, ReorderTile* tile);
+    bool check_tile_source(const PimBo* raw_bo, bool src_transposed, const ReorderTile& tile);
+    bool check_transposable(const PimBo* raw_bo);
+
+    PimBlockInfo* pbi_;
+    int num_threads_;
+};
+} /* namespace manager */
+} /* namespace runtime */
+} /* namespace pim */
+
+#endif /* _PIM_GEMM_WEIGHT_REORDER_H_ */
@@ -39,7 +39,11 @@ class PimManager
     int copy_memory(void* dst, void* src, size_t size, PimMemCpyType cpy_type);
     int copy_memory(PimBo* dst, PimBo* src, PimMemCpyType);
     int copy_memory_3d(const PimCopy3D* copy_params);
-    int convert_data_layout(PimBo* dst, PimBo* src, bool reorder_on_device, void* stream = nullptr);
+    int convert_data_layout(PimBo* dst, PimBo* src, bool reorder_on_device, void* stream = nullptr,
+                            bool src_transposed = false);
+    int restore_data_layout(PimBo* dst, PimBo* src, bool restore_on_device, void* stream = nullptr,
+                            bool dst_transposed = false);
+    int get_content_hash(PimBo* pim_bo, PimContentHash* hash);
     void set_gemm_order(PimGemmOrder gemm_order);
 
     uint8_t* get_crf_binary(void);
@@ -15,6 +15,7 @@
 #include "manager/IPimMemoryManager.h"
 #include "manager/PimDevice.h"
 #include "manager/PimInfo.h"
+#include "manager/cpu/CpuMemoryManager.h"
 #include "manager/hip/HipMemoryManager.h"
 #include "manager/ocl/OclMemoryManager.h"
 #include "pim_data_types.h"
@@ -35,6 +36,8 @@ class PimMemoryManagerFactory
             return std::make_shared<HipMemoryManager>(pim_device, precision);
         } else if (rt_type == RT_TYPE_OPENCL) {
             return std::make_shared<OclMemoryManager>(pim_device, precision);
+        } else if (rt_type == RT_TYPE_CPU) {
+            return std::make_shared<CpuMemoryManager>(pim_device, precision);
         } else {
             throw std::invalid_argument("invalid type of runtime");
         }
@@ -0,0 +1,110 @@
+/*
+ * Copyright (C) 2022 Samsung Electronics Co. LTD
+ *
+ * This software is a property of Samsung Electronics.
+ * No part of this software, either material or conceptual may be copied or distributed, transmitted,
+ * transcribed, stored in a retrieval system or translated into any human or computer language in any form by any means,
+ * electronic, mechanical, manual or otherwise, or disclosed
+ * to third parties without the express written permission of Samsung Electronics.
+ * (Use of the Software is restricted to non-commercial, personal or academic, research purpose only)
+ */
+
+#ifndef _PIM_WEIGHT_CACHE_H_
+#define _PIM_WEIGHT_CACHE_H_
+
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include "pim_data_types.h"
+#include "utility/pim_hash.h"
+
+/* default byte budget of preloaded weights, half of the PIM area reserved by the block allocator */
+#if EMULATOR
+#define DEFAULT_WEIGHT_CACHE_BUDGET (256ULL << 20)
+#elif RADEON7
+#define DEFAULT_WEIGHT_CACHE_BUDGET (4ULL << 30)
+#else
+#define DEFAULT_WEIGHT_CACHE_BUDGET (8ULL << 30)
+#endif
+
+namespace pim
+{
+namespace runtime
+{
+namespace manager
+{
+/* identity of a source weight; content hash plus everything that changes the reordered result */
+typedef struct __PimWeightKey {
+    PimContentHash hash;
+    PimBShape bshape;
+    PimBShape bshape_r;
+    PimPrecision precision;
+    size_t size;
+    bool transposed;
+    PimGemmOrder gemm_order;
+} PimWeightKey;
+
+bool operator==(const PimWeightKey& lhs, const PimWeightKey& rhs);
+
+struct PimWeightKeyHash {
+    size_t operator()(const PimWeightKey& key) const { return key.hash.h0; }
+};
+
+/* a weight which left the cache; it is freed once every stream that used it has completed */
+typedef struct __PimEvictedWeight {
+    PimBo* pim_wei;
+    std::vector<void*> streams;
+} PimEvictedWeight;
+
+class PimWeightCache
+{
+    /**
+     * @brief LRU cache of weights reordered into PIM memory
+     *
+     * Entries are charged by the size of the reordered PimBo. An insert evicts least recently used entries
+     * until the new entry fits into the byte budget; evicted PimBos are handed back to the caller to be freed.
+     * A single entry larger than the budget is still cached alone so that its owner can be served.
+     *
+     * A weight found or inserted with pin stays allocated until it is unpinned, even when it is evicted
+     * meanwhile. unpin records the stream of the user, and an evicted weight carries every stream that
+     * used it so that the caller can wait for them before the free.
+     */
+
+   public:
+    PimWeightCache(size_t budget = DEFAULT_WEIGHT_CACHE_BUDGET);
+
+    PimBo* find(const PimWeightKey& key, bool pin = false);
+    PimBo* insert(const PimWeightKey& key, PimBo* pim_wei, std::vector<PimEvictedWeight>* evicted, bool pin = false);
+    void unpin(PimBo* pim_wei, void* stream, std::vector<PimEvictedWeight>* evicted);
+    void set_budget(size_t budget, std::vector<PimEvictedWeight>* evicted);
+    void clear(std::vector<PimEvictedWeight>* evicted);
+    void get_stats(PimWeightCacheStats* stats);
+
+   private:
+    typedef struct __Entry {
+        PimWeightKey key;
+        PimBo* pim_wei;
+        int pins;
+        std::vector<void*> streams; /* streams which used the weight since it was cached */
+    } Entry;
+
+    void evict_until(size_t target, std::vector<PimEvictedWeight>* evicted);
+    static void add_stream(Entry* entry, void* stream);
+
+    std::list<Entry> lru_; /* front is the most recently used entry */
+    std::unordered_map<PimWeightKey, std::list<Entry>::iterator, PimWeightKeyHash> map_;
+    std::unordered_map<PimBo*, std::list<Entry>::iterator> bo_map_;
+    std::unordered_map<PimBo*, Entry> retired_; /* evicted while pinned */
+    std::mutex mutex_;
+    size_t budget_;
+    size_t used_bytes_;
+    uint64_t hits_;
+    uint64_t misses_;
+    uint64_t evictions_;
+};
+} /* namespace manager */
+} /* namespace runtime */
+} /* namespace pim */
+
+#endif /* _PIM_WEIGHT_CACHE_H_ */
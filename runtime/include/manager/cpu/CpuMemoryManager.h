@@ -0,0 +1,69 @@
+/*
+ * Copyright (C) 2022 Samsung Electronics Co. LTD
+ *
+ * This software is a property of Samsung Electronics.
+ * No part of this software, either material or conceptual may be copied or distributed, transmitted,
+ * transcribed, stored in a retrieval system or translated into any human or computer language in any form by any means,
+ * electronic, mechanical, manual or otherwise, or disclosed
+ * to third parties without the express written permission of Samsung Electronics.
+ * (Use of the Software is restricted to non-commercial, personal or academic, research purpose only)
+ */
+
+#ifndef _CPU_MEM_MANAGER_H_
+#define _CPU_MEM_MANAGER_H_
+
+#include <memory>
+#include "manager/IPimMemoryManager.h"
+#include "manager/PimDevice.h"
+#include "manager/PimGemmWeightReorder.h"
+#include "manager/PimInfo.h"
+#include "pim_data_types.h"
+
+namespace pim
+{
+namespace runtime
+{
+namespace manager
+{
+class CpuMemoryManager : public IPimMemoryManager
+{
+    /**
+     * @brief Memory manager of the CPU reference runtime
+     *
+     * Host, device and PIM buffers are all page aligned host memory, so every copy is a memcpy and
+     * PIM layouts are produced by the host reorder engine.
+     */
+
+   public:
+    CpuMemoryManager(std::shared_ptr<PimDevice> pim_device, PimPrecision precision);
+    virtual ~CpuMemoryManager(void);
+
+    int initialize(void);
+    int deinitialize(void);
+    int alloc_memory(void** ptr, size_t size, PimMemType mem_type);
+    int alloc_memory(PimBo* pim_bo);
+    int free_memory(void* ptr, PimMemType mem_type);
+    int free_memory(PimBo* pim_bo);
+    int copy_memory(void* dst, void* src, size_t size, PimMemCpyType cpy_type);
+    int copy_memory(PimBo* dst, PimBo* src, PimMemCpyType cpy_type);
+    int copy_memory_3d(const PimCopy3D* copy_params);
+    int convert_data_layout(PimBo* dst, PimBo* src, bool reorder_on_device = false, void* stream = nullptr,
+                            bool src_transposed = false);
+    int restore_data_layout(PimBo* dst, PimBo* src, bool restore_on_device = false, void* stream = nullptr,
+                            bool dst_transposed = false);
+    int get_content_hash(PimBo* pim_bo, PimContentHash* hash);
+    void set_gemm_order(PimGemmOrder gemm_order) { gemm_order_ = gemm_order; }
+    void* get_base_memobj(void) { return nullptr; }
+
+   private:
+    std::shared_ptr<PimDevice> pim_device_;
+    PimPrecision precision_;
+    PimBlockInfo* pbi_;
+    PimGemmOrder gemm_order_;
+    std::shared_ptr<PimGemmWeightReorder> weight_reorder_;
+};
+}  // namespace manager
+}  // namespace runtime
+}  // namespace pim
+
+#endif /*_CPU_MEM_MANAGER_H_*/
@@ -13,10 +13,12 @@
 #define _HIP_MEM_MANAGER_H_
 
 #include <map>
+#include <mutex>
 #include <vector>
 #include "manager/HostInfo.h"
 #include "manager/IPimMemoryManager.h"
 #include "manager/PimDevice.h"
+#include "manager/PimGemmWeightReorder.h"
 #include "manager/PimInfo.h"
 #include "manager/hip/HipBlockAllocator.h"
 #include "manager/simple_heap.hpp"
@@ -43,16 +45,25 @@ class HipMemoryManager : public IPimMemoryManager
     int copy_memory(void* dst, void* src, size_t size, PimMemCpyType cpy_type);
     int copy_memory(PimBo* dst, PimBo* src, PimMemCpyType cpy_type);
     int copy_memory_3d(const PimCopy3D* copy_params);
-    int convert_data_layout(PimBo* dst, PimBo* src, bool reorder_on_device = false, void* stream = nullptr);
+    int convert_data_layout(PimBo* dst, PimBo* src, bool reorder_on_device = false, void* stream = nullptr,
+                            bool src_transposed = false);
+    int restore_data_layout(PimBo* dst, PimBo* src, bool restore_on_device = false, void* stream = nullptr,
+                            bool dst_transposed = false);
+    int get_content_hash(PimBo* pim_bo, PimContentHash* hash);
     void set_gemm_order(PimGemmOrder gemm_order) { gemm_order_ = gemm_order; }
     void* get_base_memobj(void) { return nullptr; }
 
    private:
     int convert_data_layout_for_gemm_weight(PimBo* dst, PimBo* src);
     int convert_data_layout_for_aligned_gemm_weight(PimBo* dst, PimBo* src, bool reorder_on_device,
-                                                    void* stream = nullptr);
+                                                    void* stream = nullptr, bool src_transposed = false);
     int convert_data_layout_for_chwise_gemm_weight(PimBo* dst, PimBo* src, bool reorder_on_device,
-                                                   void* stream = nullptr);
+                                                   void* stream = nullptr, bool src_transposed = false);
+    int reorder_gemm_weight_on_host(PimBo* dst, PimBo* src, bool is_chwise, bool src_transposed = false);
+    int reorder_gemm_weight_tiled(PimBo* dst, PimBo* src, bool is_chwise, bool src_transposed);
+    int reorder_gemm_weight_on_device(PimBo* dst, PimBo* src, bool is_chwise, bool src_transposed, void* stream);
+    int restore_gemm_weight_on_host(PimBo* dst, PimBo* src, bool is_chwise, bool dst_transposed);
+    int restore_gemm_weight_on_device(PimBo* dst, PimBo* src, bool is_chwise, bool dst_transposed, void* stream);
     int convert_data_layout_for_gemv_weight(PimBo* dst, PimBo* src, int data_offset);
     int convert_data_layout_for_gemv_weight(PimBo* dst, PimBo* src, int data_offset, int ch_per_op);
 
@@ -64,6 +75,13 @@ class HipMemoryManager : public IPimMemoryManager
     PimPrecision precision_;
     PimBlockInfo* pbi_;
     PimGemmOrder gemm_order_;
+    std::shared_ptr<PimGemmWeightReorder> weight_reorder_;
+    /* bytes of the source staged at once by a tiled host reorder */
+    size_t reorder_tile_size_;
+    /* per-chunk results of the content hash kernel */
+    uint64_t* d_hash_buffer_;
+    uint64_t hash_buffer_chunks_;
+    std::mutex hash_mutex_;
 };
 }  // namespace manager
 }  // namespace runtime
@@ -15,6 +15,7 @@
 #include <CL/cl.h>
 #include "manager/IPimMemoryManager.h"
 #include "manager/PimDevice.h"
+#include "manager/PimGemmWeightReorder.h"
 #include "manager/PimInfo.h"
 #include "manager/ocl/OclBlockAllocator.h"
 #include "manager/simple_heap.hpp"
@@ -50,19 +51,26 @@ class OclMemoryManager : public IPimMemoryManager
     int copy_memory(PimBo* dst, PimBo* src, PimMemCpyType cpy_type);
     int copy_memory_3d(const PimCopy3D* copy_params);
     int get_physical_id(void);
-    int convert_data_layout(PimBo* dst, PimBo* src, bool reorder_on_device = false, void* stream = nullptr);
+    int convert_data_layout(PimBo* dst, PimBo* src, bool reorder_on_device = false, void* stream = nullptr,
+                            bool src_transposed = false);
+    int restore_data_layout(PimBo* dst, PimBo* src, bool restore_on_device = false, void* stream = nullptr,
+                            bool dst_transposed = false);
+    int get_content_hash(PimBo* pim_bo, PimContentHash* hash);
     void set_gemm_order(PimGemmOrder gemm_order) { gemm_order_ = gemm_order; }
     void* get_base_memobj(void) { return fragment_allocator_[0]->get_pim_base(); }
 
    private:
-    int convert_data_layout_for_aligned_gemm_weight(PimBo* dst, PimBo* src);
-    int convert_data_layout_for_chwise_gemm_weight(PimBo* dst, PimBo* src);
+    int convert_data_layout_for_aligned_gemm_weight(PimBo* dst, PimBo* src, bool src_transposed = false);
+    int convert_data_layout_for_chwise_gemm_weight(PimBo* dst, PimBo* src, bool src_transposed = false);
+    int reorder_gemm_weight_on_host(PimBo* dst, PimBo* src, bool is_chwise, bool src_transposed = false);
+    int restore_gemm_weight_on_host(PimBo* dst, PimBo* src, bool is_chwise, bool dst_transposed);
 
    private:
     std::vector<std::shared_ptr<SimpleHeap<OclBlockAllocator>>> fragment_allocator_;
     std::shared_ptr<PimDevice> pim_device_;
     PimBlockInfo* pbi_;
     PimGemmOrder gemm_order_;
+    std::shared_ptr<PimGemmWeightReorder> weight_reorder_;
 
     cl_uint num_gpu_devices_;
 };
@@ -44,14 +44,26 @@
 // sub-allocation.
 // For use when memory efficiency is more important than allocation speed.
 // O(log n) time.
+//
+// Thread safe.  Allocations are rounded up to units of align_size, which is
+// the PIM row stride for PIM memory so that every buffer starts on a row of
+// all channels and banks.  Allocations of up to MAX_CACHED_UNITS units are
+// kept by the freeing thread and handed out again in O(1) without taking the
+// heap lock.  A thread keeps at most THREAD_CACHE_BYTES and its cache is
+// returned to the heap when the thread exits.
 
 #ifndef _SIMPLE_HEAP_HPP_
 #define _SIMPLE_HEAP_HPP_
 
-#include <cmath>
+#include <algorithm>
+#include <atomic>
 #include <deque>
 #include <map>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include "pim_data_types.h"
 #include "utility/pim_log.h"
@@ -60,6 +72,11 @@
 template <typename Allocator>
 class SimpleHeap
 {
+   public:
+    static const size_t MAX_CACHED_UNITS = 16;                 // largest allocation kept by a thread, in units
+    static const size_t THREAD_CACHE_BYTES = 4 * 1024 * 1024;  // bytes a thread may keep in total
+    static const size_t NUM_SIZE_SHARDS = 64;
+
    private:
     struct Fragment_T {
         typedef std::multimap<size_t, uintptr_t>::iterator ptr_t;
@@ -78,18 +95,54 @@ class SimpleHeap
         Block() = default;
     };
 
+    // Freed allocations kept by one thread, binned by size in units.  The lock
+    // is only contended when the heap reclaims the cache.
+    struct ThreadCache {
+        std::mutex lock_;
+        std::vector<uintptr_t> bins_[MAX_CACHED_UNITS + 1];
+        size_t cached_units_ = 0;
+    };
+
+    // Sizes of live allocations, sharded by address.
+    struct SizeShard {
+        std::mutex lock_;
+        std::unordered_map<uintptr_t, size_t> sizes_;
+    };
+
     Allocator block_allocator_;
-    void* pim_base_;
+    std::atomic<void*> pim_base_;
 
+    // Guarded by mutex_.
+    std::mutex mutex_;
     std::multimap<size_t, uintptr_t> free_list_;
     std::map<uintptr_t, std::map<uintptr_t, Fragment_T>> block_list_;
     std::deque<Block> block_cache_;
-
+    std::vector<std::shared_ptr<ThreadCache>> thread_caches_;
     size_t in_use_size_;
     size_t cache_size_;
-    size_t align_size_;
 
-    __forceinline size_t get_aligned_bytes(size_t bytes) { return (align_size_ * ceil((float)bytes / align_size_)); }
+    SizeShard size_shards_[NUM_SIZE_SHARDS];
+    const size_t align_size_;
+    const size_t thread_cache_units_;
+    const size_t max_cached_units_;
+    const uint64_t heap_id_;
+
+    // Caches of one thread, returned to their heaps when the thread exits.
+    struct ThreadCacheOwner {
+        std::unordered_map<uint64_t, std::shared_ptr<ThreadCache>> caches_;
+
+        ~ThreadCacheOwner()
+        {
+            for (auto& cache : caches_) flush_exited_thread(cache.first, cache.second);
+        }
+    };
+
+    __forceinline size_t get_units(size_t bytes)
+    {
+        size_t units = (bytes + align_size_ - 1) / align_size_;
+        return units == 0 ? 1 : units;
+    }
+    __forceinline SizeShard& get_shard(uintptr_t base) { return size_shards_[(base / align_size_) % NUM_SIZE_SHARDS]; }
     __forceinline bool isFree(const Fragment_T& node) { return node.free_list_entry_ != free_list_.end(); }
     __forceinline void setUsed(Fragment_T& node) { node.free_list_entry_ = free_list_.end(); }
     __forceinline void setFree(Fragment_T& node, typename Fragment_T::ptr_t Iterator)
@@ -102,34 +155,60 @@ class SimpleHeap
         return Fragment_T(Iterator, Len);
     }
 
-   public:
-    explicit SimpleHeap(const Allocator& BlockAllocator = Allocator())
-        : block_allocator_(BlockAllocator), in_use_size_(0), cache_size_(0), align_size_(2 * 1024 * 1024)
+    static uint64_t next_heap_id()
     {
+        static std::atomic<uint64_t> heap_id(0);
+        return heap_id++;
     }
-    ~SimpleHeap()
+
+    // Live heaps by id, so that an exiting thread only touches heaps that still exist.
+    // Lock order is registry, then heap mutex_, then cache lock_.
+    static std::mutex& registry_mutex()
     {
-        trim();
-        // Leak here may be due to the user.  Check is for debugging only.
-        // assert(in_use_size_ == 0 && "Leak in SimpleHeap.");
+        static std::mutex mutex;
+        return mutex;
+    }
+    static std::unordered_map<uint64_t, SimpleHeap*>& registry()
+    {
+        static std::unordered_map<uint64_t, SimpleHeap*> heaps;
+        return heaps;
     }
 
-    SimpleHeap(const SimpleHeap& rhs) = delete;
-    SimpleHeap(SimpleHeap&& rhs) = delete;
-    SimpleHeap& operator=(const SimpleHeap& rhs) = delete;
-    SimpleHeap& operator=(SimpleHeap&& rhs) = delete;
-
-    void set_pim_base(void* pim_base) { pim_base_ = pim_base; }
-    void* get_pim_base() { return pim_base_; }
-    void* alloc(size_t bytes, const int device_id)
+    static void flush_exited_thread(uint64_t heap_id, const std::shared_ptr<ThreadCache>& cache)
     {
-        size_t aligned_bytes = get_aligned_bytes(bytes);
+        std::lock_guard<std::mutex> registry_lock(registry_mutex());
+        auto found = registry().find(heap_id);
+        if (found == registry().end()) return;
+
+        SimpleHeap* heap = found->second;
+        std::lock_guard<std::mutex> lock(heap->mutex_);
+        heap->flush_cache_locked(*cache);
+        auto& caches = heap->thread_caches_;
+        caches.erase(std::remove(caches.begin(), caches.end(), cache), caches.end());
+    }
 
-        if (aligned_bytes > max_alloc()) {
-            DLOG(ERROR) << "Requested allocation is larger than block size.";
-            return nullptr;
+    ThreadCache* get_thread_cache()
+    {
+        // Heap ids are never reused, so entries of destroyed heaps are never looked up again.
+        static thread_local uint64_t last_heap_id = UINT64_MAX;
+        static thread_local ThreadCache* last_cache = nullptr;
+        static thread_local ThreadCacheOwner owner;
+
+        if (last_heap_id == heap_id_) return last_cache;
+
+        auto& cache = owner.caches_[heap_id_];
+        if (cache == nullptr) {
+            cache = std::make_shared<ThreadCache>();
+            std::lock_guard<std::mutex> lock(mutex_);
+            thread_caches_.push_back(cache);
         }
+        last_heap_id = heap_id_;
+        last_cache = cache.get();
+        return last_cache;
+    }
 
+    uintptr_t alloc_locked(size_t aligned_bytes, const int device_id)
+    {
         // Find best fit.
         auto free_fragment = free_list_.lower_bound(aligned_bytes);
         uintptr_t base;
@@ -159,7 +238,7 @@ class SimpleHeap
                 free_fragment = free_list_.insert(std::make_pair(size - aligned_bytes, base + aligned_bytes));
                 frag_map[base + aligned_bytes] = makeFragment(free_fragment, size - aligned_bytes);
             }
-            return reinterpret_cast<void*>(base);
+            return base;
         }
 
         // No usable fragment, check block cache
@@ -177,7 +256,7 @@ class SimpleHeap
             set_pim_base(block_allocator_.get_pim_base());
 
             base = reinterpret_cast<uintptr_t>(ptr);
-            if (ptr == nullptr) return ptr;
+            if (ptr == nullptr) return 0;
         }
 
         in_use_size_ += size;
@@ -190,15 +269,11 @@ class SimpleHeap
         // Track used region
         block_list_[base][base] = makeFragment(aligned_bytes);
 
-        return reinterpret_cast<void*>(base);
+        return base;
     }
 
-    bool free(void* ptr)
+    bool free_locked(uintptr_t base)
     {
-        if (ptr == nullptr) return true;
-
-        uintptr_t base = reinterpret_cast<uintptr_t>(ptr);
-
         // Find fragment and validate.
         auto frag_map_it = block_list_.upper_bound(base);
         if (frag_map_it == block_list_.begin()) return false;
@@ -256,15 +331,147 @@ class SimpleHeap
         return true;
     }
 
+    void flush_cache_locked(ThreadCache& cache)
+    {
+        std::lock_guard<std::mutex> lock(cache.lock_);
+        for (auto& bin : cache.bins_) {
+            for (auto base : bin) free_locked(base);
+            bin.clear();
+        }
+        cache.cached_units_ = 0;
+    }
+
+    // Returns allocations kept by threads to the heap.  Caches of exited threads are dropped.
+    void flush_thread_caches_locked()
+    {
+        for (auto it = thread_caches_.begin(); it != thread_caches_.end();) {
+            flush_cache_locked(**it);
+            if (it->use_count() == 1)
+                it = thread_caches_.erase(it);
+            else
+                it++;
+        }
+    }
+
+   public:
+    explicit SimpleHeap(const Allocator& BlockAllocator = Allocator(), size_t align_size = 2 * 1024 * 1024)
+        : block_allocator_(BlockAllocator),
+          pim_base_(nullptr),
+          in_use_size_(0),
+          cache_size_(0),
+          align_size_(align_size),
+          thread_cache_units_(THREAD_CACHE_BYTES / align_size),
+          max_cached_units_(std::min(MAX_CACHED_UNITS, thread_cache_units_)),
+          heap_id_(next_heap_id())
+    {
+        std::lock_guard<std::mutex> lock(registry_mutex());
+        registry()[heap_id_] = this;
+    }
+    ~SimpleHeap()
+    {
+        {
+            std::lock_guard<std::mutex> lock(registry_mutex());
+            registry().erase(heap_id_);
+        }
+        trim();
+        // Leak here may be due to the user.  Check is for debugging only.
+        // assert(in_use_size_ == 0 && "Leak in SimpleHeap.");
+    }
+
+    SimpleHeap(const SimpleHeap& rhs) = delete;
+    SimpleHeap(SimpleHeap&& rhs) = delete;
+    SimpleHeap& operator=(const SimpleHeap& rhs) = delete;
+    SimpleHeap& operator=(SimpleHeap&& rhs) = delete;
+
+    void set_pim_base(void* pim_base) { pim_base_ = pim_base; }
+    void* get_pim_base() { return pim_base_; }
+    void* alloc(size_t bytes, const int device_id)
+    {
+        size_t units = get_units(bytes);
+        size_t aligned_bytes = units * align_size_;
+        uintptr_t base = 0;
+
+        if (aligned_bytes > max_alloc()) {
+            DLOG(ERROR) << "Requested allocation is larger than block size.";
+            return nullptr;
+        }
+
+        // Fast path, reuse an allocation freed by this thread.
+        if (units <= max_cached_units_) {
+            ThreadCache* cache = get_thread_cache();
+            std::lock_guard<std::mutex> lock(cache->lock_);
+            auto& bin = cache->bins_[units];
+            if (!bin.empty()) {
+                base = bin.back();
+                bin.pop_back();
+                cache->cached_units_ -= units;
+            }
+        }
+
+        if (base == 0) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            base = alloc_locked(aligned_bytes, device_id);
+            if (base == 0 && !thread_caches_.empty()) {
+                flush_thread_caches_locked();
+                base = alloc_locked(aligned_bytes, device_id);
+            }
+            if (base == 0) return nullptr;
+        }
+
+        SizeShard& shard = get_shard(base);
+        std::lock_guard<std::mutex> lock(shard.lock_);
+        shard.sizes_[base] = aligned_bytes;
+
+        return reinterpret_cast<void*>(base);
+    }
+
+    bool free(void* ptr)
+    {
+        if (ptr == nullptr) return true;
+
+        uintptr_t base = reinterpret_cast<uintptr_t>(ptr);
+        size_t units;
+        {
+            SizeShard& shard = get_shard(base);
+            std::lock_guard<std::mutex> lock(shard.lock_);
+            auto found = shard.sizes_.find(base);
+            if (found == shard.sizes_.end()) return false;
+            units = found->second / align_size_;
+            shard.sizes_.erase(found);
+        }
+
+        // Fast path, keep the allocation for this thread.
+        if (units <= max_cached_units_) {
+            ThreadCache* cache = get_thread_cache();
+            std::lock_guard<std::mutex> lock(cache->lock_);
+            if (cache->cached_units_ + units <= thread_cache_units_) {
+                cache->bins_[units].push_back(base);
+                cache->cached_units_ += units;
+                return true;
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        return free_locked(base);
+    }
+
     void trim()
     {
+        std::lock_guard<std::mutex> lock(mutex_);
+        flush_thread_caches_locked();
         for (const auto& block : block_cache_)
             block_allocator_.free(reinterpret_cast<void*>(block.base_ptr_), block.length_);
         block_cache_.clear();
         cache_size_ = 0;
     }
 
+    size_t in_use_size()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return in_use_size_;
+    }
     size_t max_alloc() const { return block_allocator_.block_size(); }
+    size_t align_size() const { return align_size_; }
 };
 
 #endif  // SIMPLE_HEAP_H_
@@ -22,6 +22,7 @@
 typedef enum __PimRuntimeType {
     RT_TYPE_HIP,
     RT_TYPE_OPENCL,
+    RT_TYPE_CPU,
 } PimRuntimeType;
 
 typedef enum __PimDevice {
@@ -65,6 +66,9 @@ typedef enum __PimOpType {
     OP_RELU,
     OP_BN,
     OP_COPY,
+    OP_ELT_ADD_SCALAR,
+    OP_ELT_MUL_SCALAR,
+    OP_ELT_CHAIN,
     OP_DUMMY,
 } PimOpType;
 
@@ -143,6 +147,15 @@ typedef struct __PimGemmDescriptor {
     PimGemmOrder gemm_order;
 } PimGemmDesc;
 
+typedef struct __PimWeightCacheStats {
+    uint64_t hits;         /* lookups served by an already reordered weight */
+    uint64_t misses;       /* lookups which reordered the weight again */
+    uint64_t evictions;    /* weights dropped to stay within the byte budget */
+    uint64_t entries;      /* weights currently cached */
+    uint64_t used_bytes;   /* PIM memory held by cached weights */
+    uint64_t budget_bytes; /* PIM memory budget of the cache */
+} PimWeightCacheStats;
+
 typedef struct __PimDescriptor {
     PimBShape bshape;
     PimBShape bshape_r;
@@ -171,4 +184,22 @@ typedef struct __PimCopy3D {
     size_t depth;          /* Depth of the slice to copy (scalar) */
 } PimCopy3D;
 
+typedef enum __PimEltChainOpType {
+    ELT_CHAIN_ADD,        /* acc + operand */
+    ELT_CHAIN_MUL,        /* acc * operand */
+    ELT_CHAIN_ADD_SCALAR, /* acc + scalar */
+    ELT_CHAIN_MUL_SCALAR, /* acc * scalar */
+    ELT_CHAIN_RELU,       /* max(acc, 0) */
+} PimEltChainOpType;
+
+/* one step of a fused elementwise chain, applied to the result of the previous step */
+typedef struct __PimEltChainStep {
+    PimEltChainOpType op_type;
+    PimBo *operand;  /* vector operand of ELT_CHAIN_ADD and ELT_CHAIN_MUL */
+    uint16_t scalar; /* FP16 scalar of ELT_CHAIN_ADD_SCALAR and ELT_CHAIN_MUL_SCALAR */
+} PimEltChainStep;
+
+/* sequence of recorded PIM operations, see PimBeginGraphCapture */
+typedef struct __PimGraph PimGraph;
+
 #endif /* _PIM_DATA_TYPE_H_ */
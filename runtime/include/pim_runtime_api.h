@@ -41,8 +41,12 @@
  *
  * This API initializes PIM System with either OpenCL/HIP runtime
  * Precision supported are FP16 and INT8
+ * In emulator builds, PIM_EMULATOR_MODE=functional at PimInitialize runs the recorded traces on a functional
+ * model of the PIM device instead of the cycle accurate DRAM simulator, and PIM_EMULATOR_NUM_THREADS simulates the
+ * channels of the cycle accurate model in that many processes (0 for every hardware thread). PIM_EMULATOR_RECORD=<file>
+ * records the preloads and kernel traces for offline replay with tools/pimtrace.
  *
- * @param rt_type       SDK runtime options (RT_TYPE_HIP, RT_TYPE_OPENCL)
+ * @param rt_type       SDK runtime options (RT_TYPE_HIP, RT_TYPE_OPENCL, RT_TYPE_CPU)
  * @param PimPrecision  Options to choose PIM operations precision (PIM_FP16, PIM_INT8)
  *
  * @return Return success/failure
@@ -290,11 +294,14 @@ __PIM_API__ int PimExecuteAdd(PimBo* output, PimBo* operand0, PimBo* operand1, v
 /**
  * @brief Execute add scalar operation on PIM
  *
- * Executes add scalar operation using PIM
+ * Executes add scalar operation using PIM. The scalar is loaded once into the SRF of every PIM unit,
+ * so only the vector is read from memory.
  *
  * @param output output buffer object
- * @param scalar scalar value to be added
+ * @param scalar host pointer to the FP16 scalar value to be added
  * @param vector input vector for add operations
+ * @param stream void pointer to stream identifier. default=nullptr
+ * @param block enable/disable synchronization. default=false
  *
  * @return success/failure
  */
@@ -317,8 +324,10 @@ __PIM_API__ int PimExecuteMul(PimBo* output, PimBo* operand0, PimBo* operand1, v
 /**
  * @brief Executes Mul Scalar operation in PIM
  *
+ * The scalar is loaded once into the SRF of every PIM unit, so only the vector is read from memory.
+ *
  * @param output output buffer object
- * @param scalar scalar value to be multiplied to vector
+ * @param scalar host pointer to the FP16 scalar value to be multiplied to vector
  * @param vector vector input
  * @param stream void pointer to stream identifier. default=nullptr
  * @param block enable/disable synchronization. default=false
@@ -339,6 +348,26 @@ __PIM_API__ int PimExecuteMul(PimBo* output, void* scalar, PimBo* vector, void*
  */
 __PIM_API__ int PimExecuteRelu(PimBo* output, PimBo* pim_data, void* stream = nullptr, bool block = false);
 
+/**
+ * @brief Executes a chain of elementwise operations as one fused PIM program
+ *
+ * Each step is applied to the result of the previous one, starting from input, so
+ * relu((input + a) * b) * 0.5 is { ADD a, MUL b, RELU, MUL_SCALAR 0.5 }. Up to four vector operands
+ * are supported and scalar steps have to be adjacent, since they are folded into one SRF multiply-add.
+ * Chains which do not fit in a single CRF program are rejected.
+ *
+ * @param output Output Buffer object
+ * @param input first operand of the chain
+ * @param steps elementwise steps applied in order
+ * @param num_steps number of steps
+ * @param stream void pointer to stream identifier. default=nullptr
+ * @param block enable/disable synchronization. default=false
+ *
+ * @return success/failure
+ */
+__PIM_API__ int PimExecuteEltChain(PimBo* output, PimBo* input, const PimEltChainStep* steps, int num_steps,
+                                   void* stream = nullptr, bool block = false);
+
 /**
  * @brief Executes PIM GEMM operation
  *
@@ -388,6 +417,24 @@ __PIM_API__ int PimExecuteBN(PimBo* output, PimBo* pim_data, PimBo* beta, PimBo*
  */
 __PIM_API__ int PimSynchronize(void* stream = nullptr);
 
+/**
+ * @brief Replace the CRF program of an op with a text program from a file
+ *
+ * The file holds one CRF command per line in the form printed by the CRF disassembler, e.g.
+ * "ADD GRF_A[0], GRF_A[0], EVEN_BANK, auto", "NOP 24x", "JUMP lc [PC - 6]" or "EXIT".
+ * A JUMP count of lc takes the loop counter of the data size the op runs on.
+ * The program is validated against the ISA rules before it is used, and it has to consume the
+ * column commands the kernel of the op issues within the CRF range the kernel programs.
+ * The device is synchronized before the old binaries are released, so no launch may run concurrently
+ * with this call. Instantiated graphs pick up the new program on their next launch.
+ *
+ * @param op_type op whose program is replaced
+ * @param file_path path of the text program
+ *
+ * @return success or failure
+ */
+__PIM_API__ int PimLoadCrfProgram(PimOpType op_type, const char* file_path);
+
 /**
  * @brief Execute Dummy operation in PIM
  *
@@ -395,6 +442,48 @@ __PIM_API__ int PimSynchronize(void* stream = nullptr);
  */
 __PIM_API__ int PimExecuteDummy(void);
 
+/**
+ * @brief Start recording PIM operations issued by the calling thread into a graph
+ *
+ * Until PimEndGraphCapture is called, PimExecuteAdd/Mul/Relu/BN/Gemm calls of this thread are only recorded
+ * and return immediately without touching any data. Their stream and block arguments are ignored.
+ *
+ * @return success or failure
+ */
+__PIM_API__ int PimBeginGraphCapture(void);
+
+/**
+ * @brief Finish recording and prepare the graph for replay
+ *
+ * CRF binaries, scalar operands and BN statistics (SRF images) are resolved here once, so later changes to the
+ * BN statistics Bos need a new capture. Other operands are read and written again on every launch.
+ *
+ * @param graph returns the recorded graph, destroy it with PimDestroyGraph
+ *
+ * @return success or failure
+ */
+__PIM_API__ int PimEndGraphCapture(PimGraph** graph);
+
+/**
+ * @brief Replay all recorded operations in order with a single submission
+ *
+ * @param graph graph returned by PimEndGraphCapture
+ * @param stream void pointer to stream identifier. default=nullptr
+ * @param block wait once for the whole graph to finish. default=false
+ *
+ * @return success or failure
+ */
+__PIM_API__ int PimLaunchGraph(PimGraph* graph, void* stream = nullptr, bool block = false);
+
+/**
+ * @brief Release a recorded graph
+ *
+ * @param graph graph returned by PimEndGraphCapture
+ *
+ * @return success or failure
+ */
+__PIM_API__ int PimDestroyGraph(PimGraph* graph);
+
 /**
  * @brief Returns source buffer reordered to desired type
  *
@@ -412,6 +501,72 @@ __PIM_API__ int PimExecuteDummy(void);
 __PIM_API__ PimBo* PimConvertGemmWeight(PimBo* src, PimGemmOrder gemm_order, bool reorder_on_device = false,
                                         void* stream = nullptr, bool save_for_reuse = false);
 
+/**
+ * @brief Restores a weight reordered by PimConvertGemmWeight back to the RAW layout
+ *
+ * @param dst buffer of the raw weight, created as the source of PimConvertGemmWeight was.
+ *            dst->transposed gives the stored order the same way
+ * @param src weight in a PIM gemm layout
+ * @param gemm_order representing whether execution order is weight x input or input x weight
+ * @param restore_on_device defines whether restoring is produced on device or on host
+ * @param stream defines stream for device restoring
+ *
+ * @return success or failure
+ */
+__PIM_API__ int PimRestoreGemmWeight(PimBo* dst, PimBo* src, PimGemmOrder gemm_order, bool restore_on_device = false,
+                                     void* stream = nullptr);
+
+/**
+ * @brief Set PIM memory budget of the preloaded GEMM weight cache
+ *
+ * Weights reordered for PIM are cached by their content and shape. When the budget is exceeded
+ * the least recently used weights are freed. The budget can also be given in MB by PIM_WEIGHT_CACHE_MB.
+ * Buffers returned by PimConvertGemmWeight with save_for_reuse=true are owned by this cache.
+ *
+ * @param budget budget in bytes
+ *
+ * @return success or failure
+ */
+__PIM_API__ int PimSetWeightCacheBudget(size_t budget);
+
+/**
+ * @brief Get hit/miss/eviction counters and usage of the preloaded GEMM weight cache
+ *
+ * @param stats pointer to counters to be filled
+ *
+ * @return success or failure
+ */
+__PIM_API__ int PimGetWeightCacheStats(PimWeightCacheStats* stats);
+
+/**
+ * @brief Switch tracing of runtime calls on or off
+ *
+ * Each traced call records its begin/end time, op, operand shape and bytes, and stream into a per-thread
+ * ring buffer. Tracing can also be enabled by PIM_TRACE=1 at PimInitialize; the ring size in events is given
+ * by PIM_TRACE_BUFFER_EVENTS, and PIM_TRACE_FILE names a file written at PimDeinitialize.
+ *
+ * @param enable true to record events
+ *
+ * @return success or failure
+ */
+__PIM_API__ int PimTraceEnable(bool enable);
+
+/**
+ * @brief Discard all recorded trace events
+ *
+ * @return success or failure
+ */
+__PIM_API__ int PimTraceClear(void);
+
+/**
+ * @brief Write recorded trace events as Chrome trace JSON (chrome://tracing, Perfetto)
+ *
+ * @param file_path output file
+ *
+ * @return success or failure
+ */
+__PIM_API__ int PimTraceDump(const char* file_path);
+
 #if PIM_COMPILER_ENABLE == 1
 /**
  * @brief Create PIM Target
@@ -18,6 +18,7 @@
 #include "manager/PimInfo.h"
 #include "pim_data_types.h"
 #include "stdio.h"
+#include "utility/pim_reference.h"
 
 inline void print_pimbo(PimBo* bo, const char* str = nullptr, const char* func = nullptr, int line = 0)
 {
@@ -56,16 +57,7 @@ inline void print_fp16(half_float::half* buffer, size_t size, size_t step = 0)
 inline void matmulCPU(half_float::half* input, half_float::half* weight, half_float::half* output, int m, int n, int k,
                       half_float::half alpha, half_float::half beta)
 {
-    for (int mi = 0; mi < m; mi++) {
-        for (int ni = 0; ni < n; ni++) {
-            float temp = 0;
-            for (int ki = 0; ki < k; ki++) {
-                temp += (input[mi * k + ki] * weight[ki * n + ni]);
-            }
-            int out_idx = mi * n + ni;
-            output[out_idx] = alpha * temp + beta * output[out_idx];
-        }
-    }
+    pim::runtime::reference::matmul(output, input, weight, m, n, k, alpha, beta);
 }
 
 #if 0 /* need to verify */
@@ -108,39 +100,27 @@ inline void gemmCPU(PimBo* output, PimBo* input, PimBo* weight, PimBo* bias, Pim
 
 inline void addBiasCPU(half_float::half* output, half_float::half* bias, int size)
 {
-    for (int i = 0; i < size; i++) {
-        output[i] += bias[i];
-    }
+    pim::runtime::reference::add(output, output, bias, size);
 }
 
 inline void addCPU(half_float::half* inp1, half_float::half* inp2, half_float::half* output, int length)
 {
-    for (int i = 0; i < length; i++) {
-        output[i] = inp1[i] + inp2[i];
-    }
+    pim::runtime::reference::add(output, inp1, inp2, length);
 }
 
 inline void mulCPU(half_float::half* inp1, half_float::half* inp2, half_float::half* output, int length)
 {
-    for (int i = 0; i < length; i++) {
-        output[i] = inp1[i] * inp2[i];
-    }
+    pim::runtime::reference::mul(output, inp1, inp2, length);
 }
 
 inline void reluCPU(half_float::half* data, int size)
 {
-    for (int i = 0; i < size; i++) {
-        if (data[i] < 0) data[i] = 0;
-    }
+    pim::runtime::reference::relu(data, size);
 }
 
 inline void transposeCPU(half_float::half* in, half_float::half* out, int row, int col)
 {
-    for (int ri = 0; ri < row; ri++) {
-        for (int ci = 0; ci < col; ci++) {
-            out[ci * row + ri] = in[ri * col + ci];
-        }
-    }
+    pim::runtime::reference::transpose(out, in, row, col);
 }
 
 inline const char* get_pim_op_string(PimOpType op_type)
@@ -166,6 +146,15 @@ inline const char* get_pim_op_string(PimOpType op_type)
         case OP_COPY:
             op_str = "copy";
             break;
+        case OP_ELT_ADD_SCALAR:
+            op_str = "elt_add_scalar";
+            break;
+        case OP_ELT_MUL_SCALAR:
+            op_str = "elt_mul_scalar";
+            break;
+        case OP_ELT_CHAIN:
+            op_str = "elt_chain";
+            break;
         case OP_DUMMY:
             op_str = "dummy";
             break;
@@ -312,54 +301,30 @@ inline int compare_half_Ulps_and_absoulte(half_float::half data_a, half_float::h
 inline int compare_half_relative(half_float::half* data_a, half_float::half* data_b, int size,
                                  float absTolerance = 0.0001)
 {
-    int pass_cnt = 0;
-    int warning_cnt = 0;
-    int fail_cnt = 0;
-    int ret = 0;
-    std::vector<int> fail_idx;
-    std::vector<float> fail_data_pim;
-    std::vector<float> fail_data_goldeny;
-
-    float max_diff = 0.0;
-    int pass_bit_cnt = 4;
-    int warn_bit_cnt = 8;
-
-    for (int i = 0; i < size; i++) {
-        if (compare_half_Ulps_and_absoulte(data_a[i], data_b[i], pass_bit_cnt)) {
-            // std::cout << "c data_a : " << (float)data_a[i] << " data_b : " << (float)data_b[i] << std::endl;
-            pass_cnt++;
-        } else if (compare_half_Ulps_and_absoulte(data_a[i], data_b[i], warn_bit_cnt, absTolerance)) {
-            // std::cout << "w data_a : " << (float)data_a[i] << " data_b : " << (float)data_b[i] << std::endl;
-            warning_cnt++;
-        } else {
-            if (abs(float(data_a[i]) - float(data_b[i])) > max_diff) {
-                max_diff = abs(float(data_a[i]) - float(data_b[i]));
-            }
-            //  std::cout << "f data_a : " << (float)data_a[i] << " data_b : "  <<(float)data_b[i]  << std::endl;
-
-            fail_idx.push_back(pass_cnt + warning_cnt + fail_cnt);
-            fail_data_pim.push_back((float)data_a[i]);
-            fail_data_goldeny.push_back((float)data_b[i]);
+    pim::runtime::reference::CompareResult result;
+    std::vector<size_t> fail_idx;
+    std::vector<size_t>* fail_list = nullptr;
+#ifdef DEBUG_PIM
+    fail_list = &fail_idx;
+#endif
 
-            fail_cnt++;
-            ret = 1;
-        }
+    if (pim::runtime::reference::compare_half_relative(data_a, data_b, size, absTolerance, &result, fail_list) == 0) {
+        return 0;
     }
 
+    int pass_cnt = result.pass_cnt;
+    int warning_cnt = result.warning_cnt;
+    int fail_cnt = result.fail_cnt;
     int quasi_cnt = pass_cnt + warning_cnt;
-    if (ret) {
-        printf("relative - pass_cnt : %d, warning_cnt : %d, fail_cnt : %d, pass ratio : %f, max diff : %f\n", pass_cnt,
-               warning_cnt, fail_cnt,
-               ((float)quasi_cnt / ((float)fail_cnt + (float)warning_cnt + (float)pass_cnt) * 100), max_diff);
-#ifdef DEBUG_PIM
-        for (int i = 0; i < fail_idx.size(); i++) {
-            std::cout << fail_idx[i] << " pim : " << fail_data_pim[i] << " golden :" << fail_data_goldeny[i]
-                      << std::endl;
-        }
-#endif
+    printf("relative - pass_cnt : %d, warning_cnt : %d, fail_cnt : %d, pass ratio : %f, max diff : %f\n", pass_cnt,
+           warning_cnt, fail_cnt, ((float)quasi_cnt / ((float)fail_cnt + (float)warning_cnt + (float)pass_cnt) * 100),
+           result.max_diff);
+    for (size_t i = 0; i < fail_idx.size(); i++) {
+        std::cout << fail_idx[i] << " pim : " << (float)data_a[fail_idx[i]] << " golden :" << (float)data_b[fail_idx[i]]
+                  << std::endl;
     }
 
-    return ret;
+    return 1;
 }
 
 inline void addressMapping(uint64_t physicalAddress, unsigned& newTransactionChan, unsigned& newTransactionRank,
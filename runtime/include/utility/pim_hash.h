@@ -0,0 +1,188 @@
+/*
+ * Copyright (C) 2022 Samsung Electronics Co. LTD
+ *
+ * This software is a property of Samsung Electronics.
+ * No part of this software, either material or conceptual may be copied or distributed, transmitted,
+ * transcribed, stored in a retrieval system or translated into any human or computer language in any form by any means,
+ * electronic, mechanical, manual or otherwise, or disclosed
+ * to third parties without the express written permission of Samsung Electronics.
+ * (Use of the Software is restricted to non-commercial, personal or academic, research purpose only)
+ */
+
+#ifndef _PIM_HASH_H_
+#define _PIM_HASH_H_
+
+#include <stdint.h>
+#include "hip/hip_runtime.h"
+
+/*
+ * 128-bit content hash of a memory buffer.
+ *
+ * The buffer is viewed as 64-bit words (the last word is zero padded) and split into chunks of
+ * PIM_HASH_LANES x PIM_HASH_LANE_WORDS words. Inside a chunk, lane j consumes words j, j + PIM_HASH_LANES, ...
+ * so that a GPU wavefront reads consecutive words. Lanes are folded into a chunk hash and chunk hashes are
+ * folded in order, therefore the host and the device produce the same value for the same bytes.
+ * The hash is not cryptographic; two independent 64-bit lanes keep accidental collisions negligible.
+ */
+#define PIM_HASH_LANES 64
+#define PIM_HASH_LANE_WORDS 64
+#define PIM_HASH_CHUNK_WORDS (PIM_HASH_LANES * PIM_HASH_LANE_WORDS)
+
+typedef struct __PimContentHash {
+    uint64_t h0;
+    uint64_t h1;
+} PimContentHash;
+
+inline bool operator==(const PimContentHash& lhs, const PimContentHash& rhs)
+{
+    return lhs.h0 == rhs.h0 && lhs.h1 == rhs.h1;
+}
+
+namespace pim
+{
+namespace runtime
+{
+namespace hash
+{
+static const uint64_t P1 = 0x9e3779b185ebca87ULL;
+static const uint64_t P2 = 0xc2b2ae3d27d4eb4fULL;
+static const uint64_t P3 = 0x165667b19e3779f9ULL;
+static const uint64_t P4 = 0x85ebca77c2b2ae63ULL;
+
+__host__ __device__ inline uint64_t rotl64(uint64_t x, int r) { return (x << r) | (x >> (64 - r)); }
+
+__host__ __device__ inline uint64_t fmix64(uint64_t x)
+{
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdULL;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ULL;
+    x ^= x >> 33;
+    return x;
+}
+
+__host__ __device__ inline void hash_init(uint64_t seed, uint64_t* h0, uint64_t* h1)
+{
+    *h0 = seed * P1 + P4;
+    *h1 = (seed ^ P3) * P2;
+}
+
+__host__ __device__ inline void hash_update(uint64_t word, uint64_t* h0, uint64_t* h1)
+{
+    *h0 = rotl64(*h0 ^ (word * P2), 31) * P1;
+    *h1 = rotl64(*h1 + (word * P3), 29) * P4 + P1;
+}
+
+__host__ __device__ inline void hash_fold(uint64_t v0, uint64_t v1, uint64_t* h0, uint64_t* h1)
+{
+    hash_update(fmix64(v0), h0, h1);
+    hash_update(fmix64(v1 ^ P2), h0, h1);
+}
+
+__host__ __device__ inline uint64_t num_words(size_t size) { return (size + sizeof(uint64_t) - 1) / sizeof(uint64_t); }
+
+__host__ __device__ inline uint64_t num_chunks(size_t size)
+{
+    return (num_words(size) + PIM_HASH_CHUNK_WORDS - 1) / PIM_HASH_CHUNK_WORDS;
+}
+
+/* reads word idx of an 8-byte aligned buffer, the tail word is zero padded */
+__host__ __device__ inline uint64_t load_word(const uint8_t* data, size_t size, uint64_t idx)
+{
+    size_t offset = idx * sizeof(uint64_t);
+    if (offset + sizeof(uint64_t) <= size) {
+        return reinterpret_cast<const uint64_t*>(data)[idx];
+    }
+    uint64_t word = 0;
+    for (size_t i = offset; i < size; i++) {
+        word |= (uint64_t)data[i] << ((i - offset) * 8);
+    }
+    return word;
+}
+
+__host__ __device__ inline void hash_lane(const uint8_t* data, size_t size, uint64_t chunk, uint32_t lane,
+                                          uint64_t* h0, uint64_t* h1)
+{
+    uint64_t words = num_words(size);
+    uint64_t idx = chunk * PIM_HASH_CHUNK_WORDS + lane;
+
+    hash_init(idx, h0, h1);
+    for (int i = 0; i < PIM_HASH_LANE_WORDS && idx < words; i++, idx += PIM_HASH_LANES) {
+        hash_update(load_word(data, size, idx), h0, h1);
+    }
+}
+
+/* folds PIM_HASH_LANES lane hashes (h0, h1 pairs) of a chunk into one chunk hash */
+__host__ __device__ inline void hash_chunk_from_lanes(const uint64_t* lanes, uint64_t chunk, uint64_t* h0,
+                                                      uint64_t* h1)
+{
+    hash_init(chunk ^ P4, h0, h1);
+    for (int lane = 0; lane < PIM_HASH_LANES; lane++) {
+        hash_fold(lanes[2 * lane], lanes[2 * lane + 1], h0, h1);
+    }
+}
+
+/* host version of a chunk; all lanes advance together to keep independent multiply chains in flight */
+inline void hash_chunk(const uint8_t* data, size_t size, uint64_t chunk, uint64_t* h0, uint64_t* h1)
+{
+    uint64_t lanes[2 * PIM_HASH_LANES];
+    uint64_t base = chunk * PIM_HASH_CHUNK_WORDS;
+
+    for (int lane = 0; lane < PIM_HASH_LANES; lane++) {
+        hash_init(base + lane, &lanes[2 * lane], &lanes[2 * lane + 1]);
+    }
+    if (base + PIM_HASH_CHUNK_WORDS <= size / sizeof(uint64_t)) {
+        const uint64_t* w = reinterpret_cast<const uint64_t*>(data) + base;
+        for (int i = 0; i < PIM_HASH_LANE_WORDS; i++, w += PIM_HASH_LANES) {
+            for (int lane = 0; lane < PIM_HASH_LANES; lane++) {
+                hash_update(w[lane], &lanes[2 * lane], &lanes[2 * lane + 1]);
+            }
+        }
+    } else {
+        for (int lane = 0; lane < PIM_HASH_LANES; lane++) {
+            hash_lane(data, size, chunk, lane, &lanes[2 * lane], &lanes[2 * lane + 1]);
+        }
+    }
+    hash_chunk_from_lanes(lanes, chunk, h0, h1);
+}
+
+inline void hash_finalize(size_t size, PimContentHash* hash)
+{
+    hash->h0 = fmix64(hash->h0 ^ size);
+    hash->h1 = fmix64(hash->h1 + hash->h0);
+}
+
+/* folds chunk hashes (h0, h1 pairs) in order and mixes in the buffer size */
+inline PimContentHash hash_from_chunks(const uint64_t* chunks, uint64_t chunk_cnt, size_t size)
+{
+    PimContentHash hash;
+    hash_init(size, &hash.h0, &hash.h1);
+    for (uint64_t c = 0; c < chunk_cnt; c++) {
+        hash_fold(chunks[2 * c], chunks[2 * c + 1], &hash.h0, &hash.h1);
+    }
+    hash_finalize(size, &hash);
+    return hash;
+}
+
+/* host reference; data must be 8-byte aligned */
+inline PimContentHash hash_host_memory(const void* data, size_t size)
+{
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(data);
+    uint64_t chunk_cnt = num_chunks(size);
+    uint64_t h0 = 0;
+    uint64_t h1 = 0;
+    PimContentHash hash;
+
+    hash_init(size, &hash.h0, &hash.h1);
+    for (uint64_t c = 0; c < chunk_cnt; c++) {
+        hash_chunk(bytes, size, c, &h0, &h1);
+        hash_fold(h0, h1, &hash.h0, &hash.h1);
+    }
+    hash_finalize(size, &hash);
+    return hash;
+}
+} /* namespace hash */
+} /* namespace runtime */
+} /* namespace pim */
+
+#endif /* _PIM_HASH_H_ */
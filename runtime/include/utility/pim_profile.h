@@ -13,31 +13,17 @@
 #define _PIM_PROFILE_H_
 
 #include "utility/pim_log.h"
+#include "utility/pim_trace.h"
 
 long long getTickCount(void);
 double getTickFrequency(void);
 
 #ifdef PROFILE
-#define PIM_PROFILE_TICK(name) long long __tick_##name = getTickCount()
-
-#if CONSOLE
-#define PIM_PROFILE_TOCK(name)                                                                                     \
-    std::cout << #name                                                                                             \
-              << " time (ms) : " << ((double(getTickCount() - __tick_##name) / (double)getTickFrequency())) * 1000 \
-              << std::endl;
-#define PIM_PROFILE_TOCK_ITER(name, iter_cnt)                                                                  \
-    std::cout << #name << " time (ms) : "                                                                      \
-              << ((((double(getTickCount() - __tick_##name) / (double)getTickFrequency())) * 1000) / iter_cnt) \
-              << std::endl;
-#else
-#define PIM_PROFILE_TOCK(name) \
-    DLOG(INFO) << #name        \
-               << " time (ms) : " << ((double(getTickCount() - __tick_##name) / (double)getTickFrequency())) * 1000;
-#define PIM_PROFILE_TOCK_ITER(name, iter_cnt)                                                                   \
-    DLOG(INFO) << #name << " time (ms) : "                                                                      \
-               << ((((double(getTickCount() - __tick_##name) / (double)getTickFrequency())) * 1000) / iter_cnt) \
-               << std::endl;
-#endif
+/* spans are recorded as trace events while tracing is enabled, see utility/pim_trace.h */
+#define PIM_PROFILE_TICK(name) \
+    uint64_t __tick_##name = pim::runtime::trace::is_enabled() ? pim::runtime::trace::now_ns() : 0
+#define PIM_PROFILE_TOCK(name) pim::runtime::trace::record(#name, "profile", __tick_##name)
+#define PIM_PROFILE_TOCK_ITER(name, iter_cnt) pim::runtime::trace::record(#name, "profile", __tick_##name)
 #else /* !PROFILE */
 
 #define PIM_PROFILE_TICK(name)
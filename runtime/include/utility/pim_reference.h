@@ -0,0 +1,66 @@
+/*
+ * Copyright (C) 2022 Samsung Electronics Co. LTD
+ *
+ * This software is a property of Samsung Electronics.
+ * No part of this software, either material or conceptual may be copied or distributed, transmitted,
+ * transcribed, stored in a retrieval system or translated into any human or computer language in any form by any means,
+ * electronic, mechanical, manual or otherwise, or disclosed
+ * to third parties without the express written permission of Samsung Electronics.
+ * (Use of the Software is restricted to non-commercial, personal or academic, research purpose only)
+ */
+
+#ifndef _PIM_REFERENCE_H_
+#define _PIM_REFERENCE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+#include "half.hpp"
+
+/*
+ * Host reference kernels for golden outputs of examples, pimbench and unit tests.
+ *
+ * Every function gives bit-identical results to the scalar half_float::half loop it replaces: each half op is
+ * rounded once to nearest even, and the gemm accumulator is a float that adds the half rounded products in
+ * k order. Work is split over host threads and uses AVX2 with F16C conversions when the CPU has them.
+ * The thread count is taken from PIM_REF_NUM_THREADS (0 or unset uses all hardware threads).
+ */
+
+namespace pim
+{
+namespace runtime
+{
+namespace reference
+{
+typedef struct __CompareResult {
+    size_t pass_cnt;
+    size_t warning_cnt;
+    size_t fail_cnt;
+    float max_diff; /* largest absolute difference among failed elements */
+} CompareResult;
+
+void set_num_threads(int num_threads);
+int get_num_threads(void);
+bool is_simd_enabled(void);
+
+void add(half_float::half* out, const half_float::half* in0, const half_float::half* in1, size_t len);
+void mul(half_float::half* out, const half_float::half* in0, const half_float::half* in1, size_t len);
+/* data < 0 becomes +0, -0 and nan are kept */
+void relu(half_float::half* data, size_t len);
+/* out (col x row) = transpose of in (row x col) */
+void transpose(half_float::half* out, const half_float::half* in, int row, int col);
+/* out (m x n) = alpha * in (m x k) * weight (k x n) + beta * out */
+void matmul(half_float::half* out, const half_float::half* in, const half_float::half* weight, int m, int n, int k,
+            half_float::half alpha, half_float::half beta);
+
+/*
+ * An element passes within 16 ulps or 0.001, warns within 256 ulps or abs_tolerance and fails otherwise.
+ * Returns the number of failed elements, whose indices are appended to fail_idx in order when it is given.
+ */
+size_t compare_half_relative(const half_float::half* data_a, const half_float::half* data_b, size_t size,
+                             float abs_tolerance, CompareResult* result, std::vector<size_t>* fail_idx = nullptr);
+} /* namespace reference */
+} /* namespace runtime */
+} /* namespace pim */
+
+#endif /* _PIM_REFERENCE_H_ */
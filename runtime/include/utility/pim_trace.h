@@ -0,0 +1,122 @@
+/*
+ * Copyright (C) 2022 Samsung Electronics Co. LTD
+ *
+ * This software is a property of Samsung Electronics.
+ * No part of this software, either material or conceptual may be copied or distributed, transmitted,
+ * transcribed, stored in a retrieval system or translated into any human or computer language in any form by any means,
+ * electronic, mechanical, manual or otherwise, or disclosed
+ * to third parties without the express written permission of Samsung Electronics.
+ * (Use of the Software is restricted to non-commercial, personal or academic, research purpose only)
+ */
+
+#ifndef _PIM_TRACE_H_
+#define _PIM_TRACE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+#include "pim_data_types.h"
+
+/*
+ * Structured tracing of runtime calls.
+ *
+ * Every traced span is stored as one complete event (begin and end time, op name, shape of the first operand,
+ * bytes of all operands and the stream) in a ring buffer owned by the calling thread, so recording takes no
+ * shared lock. Buffers outlive their threads and are exported together as Chrome trace JSON, which
+ * chrome://tracing and Perfetto load directly.
+ * Tracing is switched at runtime (PimTraceEnable or PIM_TRACE=1); while it is off a span costs one relaxed
+ * atomic load, so it stays compiled into release builds.
+ */
+#define PIM_TRACE_DEFAULT_BUFFER_EVENTS (1 << 16)
+
+namespace pim
+{
+namespace runtime
+{
+namespace trace
+{
+typedef struct __TraceEvent {
+    const char* name;     /* string literal, not copied */
+    const char* category; /* string literal, not copied */
+    uint64_t begin_ns;
+    uint64_t end_ns;
+    uint32_t shape[4];
+    uint64_t bytes;
+    const void* stream;
+} TraceEvent;
+
+extern std::atomic<bool> g_trace_enabled;
+
+inline bool is_enabled(void) { return g_trace_enabled.load(std::memory_order_relaxed); }
+uint64_t now_ns(void);
+void set_enabled(bool enable);
+/* capacity of per-thread ring buffers created or cleared afterwards */
+void set_buffer_events(size_t num_events);
+/* reads PIM_TRACE and PIM_TRACE_BUFFER_EVENTS */
+void configure_from_env(void);
+void record(const TraceEvent& event);
+void record(const char* name, const char* category, uint64_t begin_ns);
+void clear(void);
+size_t get_num_events(void);
+uint64_t get_num_dropped(void);
+int dump(const char* file_path);
+
+class TraceScope
+{
+    /**
+     * @brief Records the lifetime of the scope as one trace event
+     *
+     * Operand information is attached with add_bo/add_bytes/set_stream and ignored while tracing is off.
+     */
+
+   public:
+    TraceScope(const char* name, const char* category = "api")
+    {
+        event_.begin_ns = 0;
+        if (!is_enabled()) return;
+        event_.name = name;
+        event_.category = category;
+        event_.shape[0] = event_.shape[1] = event_.shape[2] = event_.shape[3] = 0;
+        event_.bytes = 0;
+        event_.stream = nullptr;
+        event_.begin_ns = now_ns();
+    }
+
+    ~TraceScope(void)
+    {
+        if (event_.begin_ns == 0) return;
+        event_.end_ns = now_ns();
+        record(event_);
+    }
+
+    /* the first buffer object gives the shape of the event, all of them add their size */
+    void add_bo(const PimBo* bo)
+    {
+        if (event_.begin_ns == 0 || bo == nullptr) return;
+        if (event_.bytes == 0) {
+            event_.shape[0] = bo->bshape.n;
+            event_.shape[1] = bo->bshape.c;
+            event_.shape[2] = bo->bshape.h;
+            event_.shape[3] = bo->bshape.w;
+        }
+        event_.bytes += bo->size;
+    }
+
+    void add_bytes(size_t bytes)
+    {
+        if (event_.begin_ns != 0) event_.bytes += bytes;
+    }
+
+    void set_stream(const void* stream)
+    {
+        if (event_.begin_ns != 0) event_.stream = stream;
+    }
+
+   private:
+    TraceEvent event_;
+};
+} /* namespace trace */
+} /* namespace runtime */
+} /* namespace pim */
+
+#endif /* _PIM_TRACE_H_ */
@@ -100,6 +100,10 @@ __host__ __device__ inline uint64_t addr_gen_safe(uint32_t chan, uint32_t rank,
     return addr_gen(chan, rank, bg, bank, row, col);
 }
 void transpose_pimbo(PimBo* dst, PimBo* src);
+/* dst (col x row) = src (row x col) for each of batch FP16 matrices, in cache blocked tiles on several threads */
+void transpose_fp16(void* dst, const void* src, size_t batch, size_t row, size_t col);
+/* dst[c * dst_pitch + r] = src[r * src_pitch + c] for r < rows and c < cols, pitches in elements */
+void transpose_fp16_tile(uint16_t* dst, size_t dst_pitch, const uint16_t* src, size_t src_pitch, int rows, int cols);
 void set_pimbo_t(PimBo* bo0, PimBo* bo1, PimBo* bo2, PimBo* bo3);
 void set_pimbo_t(PimBo* inout);
 void set_pimbo_t(PimBo* dst, PimBo* src);
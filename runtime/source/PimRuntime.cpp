@@ -13,6 +13,8 @@
 #include <assert.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <algorithm>
 #include <iostream>
 #include "executor/IPimExecutor.h"
 #include "executor/PimCompilerDriver.h"
@@ -28,6 +30,9 @@ namespace pim
 {
 namespace runtime
 {
+/* graph recording ops issued by this thread, nullptr while ops are executed eagerly */
+static thread_local PimGraph* t_capture_graph = nullptr;
+
 PimRuntime::PimRuntime(PimRuntimeType rt_type, PimPrecision precision) : rt_type_(rt_type), precision_(precision)
 {
     DLOG(INFO) << "[START] " << __FUNCTION__ << " called";
@@ -35,6 +40,16 @@ PimRuntime::PimRuntime(PimRuntimeType rt_type, PimPrecision precision) : rt_type
     pim_manager_ = manager::PimManager::get_instance(rt_type, precision);
     pim_executor_ = executor::PimExecutorFactory::getPimExecutor(pim_manager_, this, rt_type, precision);
 
+#if PIM_COMPILER_ENABLE == 1
+    pimc_driver_ = std::make_shared<pimc_driver::PimCDriver>();
+#endif
+
+    const char* env_w = std::getenv("PIM_WEIGHT_CACHE_MB");
+    if (env_w != nullptr) {
+        std::vector<manager::PimEvictedWeight> evicted;
+        weight_cache_.set_budget((size_t)atoll(env_w) << 20, &evicted);
+    }
+
     DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
 }
 
@@ -62,10 +77,17 @@ int PimRuntime::deinitialize(void)
     DLOG(INFO) << "[START] " << __FUNCTION__ << " called";
     int ret = 0;
 
-    for (auto it = weight_map_.begin(); it != weight_map_.end(); ++it) {
-        free_memory(it->second);
-        delete it->second;
-    }
+    PimWeightCacheStats stats;
+    weight_cache_.get_stats(&stats);
+    DLOG(INFO) << "weight cache hits:" << stats.hits << " misses:" << stats.misses << " evictions:" << stats.evictions;
+
+    std::vector<manager::PimEvictedWeight> evicted;
+    weight_cache_.clear(&evicted);
+    release_evicted_weights(&evicted, nullptr);
+
+#if PIM_COMPILER_ENABLE == 1
+    pimc_driver_->clear_cache();
+#endif
 
     pim_manager_->deinitialize();
     pim_executor_->deinitialize();
@@ -78,6 +100,10 @@ int PimRuntime::set_device(uint32_t device_id)
 {
     DLOG(INFO) << "[START] " << __FUNCTION__ << " called";
     int ret = 0;
+    if (rt_type_ == RT_TYPE_CPU) {
+        /* the host is the only device */
+        return device_id == 0 ? 0 : -1;
+    }
     hipError_t deviceSet = hipSetDevice(device_id);
     if (hipSuccess != deviceSet) {
         DLOG(ERROR) << "Failed to set device " << deviceSet << "Device ID: " << device_id << std::endl;
@@ -91,6 +117,10 @@ int PimRuntime::get_device(uint32_t* device_id)
 {
     DLOG(INFO) << "[START] " << __FUNCTION__ << " called";
     int ret = 0;
+    if (rt_type_ == RT_TYPE_CPU) {
+        *device_id = 0;
+        return 0;
+    }
     hipError_t deviceGet = hipGetDevice((int*)device_id);
     if (hipSuccess != deviceGet) {
         DLOG(ERROR) << "Failed to get device " << deviceGet << "Device ID: " << device_id << std::endl;
@@ -218,6 +248,10 @@ int PimRuntime::execute_add(PimBo* output, PimBo* operand0, PimBo* operand1, voi
     DLOG(INFO) << "called";
     int ret = 0;
 
+    if (t_capture_graph != nullptr) {
+        return record_graph_node(executor::make_graph_node(OP_ELT_ADD, output, operand0, operand1));
+    }
+
     ret = pim_executor_->execute_add(output, operand0, operand1, stream, block);
 
     return ret;
@@ -228,16 +262,61 @@ int PimRuntime::execute_mul(PimBo* output, PimBo* operand0, PimBo* operand1, voi
     DLOG(INFO) << "called";
     int ret = 0;
 
+    if (t_capture_graph != nullptr) {
+        return record_graph_node(executor::make_graph_node(OP_ELT_MUL, output, operand0, operand1));
+    }
+
     ret = pim_executor_->execute_mul(output, operand0, operand1, stream, block);
 
     return ret;
 }
 
+int PimRuntime::execute_add_scalar(PimBo* output, uint16_t scalar, PimBo* operand, void* stream, bool block)
+{
+    DLOG(INFO) << "called";
+    int ret = 0;
+
+    if (t_capture_graph != nullptr) {
+        executor::PimGraphNode node = executor::make_graph_node(OP_ELT_ADD_SCALAR, output, operand);
+        node.scalar = scalar;
+        return record_graph_node(node);
+    }
+
+    ret = pim_executor_->execute_add_scalar(output, scalar, operand, stream, block);
+
+    return ret;
+}
+
+int PimRuntime::execute_mul_scalar(PimBo* output, uint16_t scalar, PimBo* operand, void* stream, bool block)
+{
+    DLOG(INFO) << "called";
+    int ret = 0;
+
+    if (t_capture_graph != nullptr) {
+        executor::PimGraphNode node = executor::make_graph_node(OP_ELT_MUL_SCALAR, output, operand);
+        node.scalar = scalar;
+        return record_graph_node(node);
+    }
+
+    ret = pim_executor_->execute_mul_scalar(output, scalar, operand, stream, block);
+
+    return ret;
+}
+
 int PimRuntime::execute_gemm(PimBo* output, PimBo* input, PimBo* weight, PimBo* bias, PimActFunc act_func,
                              PimGemmOrder gemm_order, void* stream, bool block)
 {
     DLOG(INFO) << "[START] " << __FUNCTION__ << " called";
     int ret = 0;
+
+    if (t_capture_graph != nullptr) {
+        executor::PimGraphNode node = executor::make_graph_node(OP_GEMM, output, input, weight);
+        node.bias = bias;
+        node.act_func = act_func;
+        node.gemm_order = gemm_order;
+        return record_graph_node(node);
+    }
+
     pim_executor_->set_gemm_order(gemm_order);
     ret = pim_executor_->execute_gemm(output, input, weight, bias, act_func, stream, block);
 
@@ -250,18 +329,51 @@ int PimRuntime::execute_relu(PimBo* output, PimBo* pim_data, void* stream, bool
     DLOG(INFO) << "[START] " << __FUNCTION__ << " called";
     int ret = 0;
 
+    if (t_capture_graph != nullptr) {
+        return record_graph_node(executor::make_graph_node(OP_RELU, output, pim_data));
+    }
+
     ret = pim_executor_->execute_relu(output, pim_data, stream, block);
 
     DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
     return ret;
 }
 
+int PimRuntime::execute_elt_chain(PimBo* output, PimBo* input, const PimEltChainStep* steps, int num_steps,
+                                  void* stream, bool block)
+{
+    DLOG(INFO) << "[START] " << __FUNCTION__ << " called";
+    int ret = 0;
+
+    if (t_capture_graph != nullptr) {
+        if (executor::check_elt_chain(output, input, steps, num_steps) != 0) return -1;
+        executor::PimGraphNode node = executor::make_graph_node(OP_ELT_CHAIN, output, input);
+        node.chain.assign(steps, steps + num_steps);
+        return record_graph_node(node);
+    }
+
+    ret = pim_executor_->execute_elt_chain(output, input, steps, num_steps, stream, block);
+
+    DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
+    return ret;
+}
+
 int PimRuntime::execute_bn(PimBo* output, PimBo* pim_data, PimBo* beta, PimBo* gamma, PimBo* mean, PimBo* variance,
                            double epsilon, void* stream, bool block)
 {
     DLOG(INFO) << "[START] " << __FUNCTION__ << " called";
     int ret = 0;
 
+    if (t_capture_graph != nullptr) {
+        executor::PimGraphNode node = executor::make_graph_node(OP_BN, output, pim_data);
+        node.beta = beta;
+        node.gamma = gamma;
+        node.mean = mean;
+        node.variance = variance;
+        node.epsilon = epsilon;
+        return record_graph_node(node);
+    }
+
     ret = pim_executor_->execute_bn(output, pim_data, beta, gamma, mean, variance, epsilon, stream, block);
 
     DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
@@ -279,6 +391,24 @@ int PimRuntime::execute_sync(void* stream)
     return ret;
 }
 
+int PimRuntime::load_crf_program(PimOpType op_type, const char* file_path)
+{
+    DLOG(INFO) << "[START] " << __FUNCTION__ << " called";
+    int ret = 0;
+    executor::PimCrfAssembler assembler;
+    executor::PimCrfProgram program;
+
+    if (file_path == nullptr || assembler.assemble_file(file_path, &program) != 0) {
+        DLOG(ERROR) << "fail to assemble the CRF program of " << get_pim_op_string(op_type);
+        DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
+        return -1;
+    }
+    ret = pim_executor_->load_crf_program(op_type, program);
+
+    DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
+    return ret;
+}
+
 int PimRuntime::execute_dummy(void)
 {
     DLOG(INFO) << "[START] " << __FUNCTION__ << " called";
@@ -290,44 +420,165 @@ int PimRuntime::execute_dummy(void)
     return ret;
 }
 
-PimBo* PimRuntime::find_preloaded_pim_weight(PimBo* weight)
+int PimRuntime::begin_graph_capture(void)
 {
     DLOG(INFO) << "[START] " << __FUNCTION__ << " called";
-    PimBo* addr = nullptr;
 
-    uint32_t w_key = 0;
-    uint32_t* w_addr_ptr = reinterpret_cast<uint32_t*>(weight->data);
-    int step = weight->size >> 1;
+    if (t_capture_graph != nullptr) {
+        DLOG(ERROR) << "graph capture is already in progress on this thread";
+        return -1;
+    }
+    t_capture_graph = new PimGraph;
+
+    DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
+    return 0;
+}
+
+int PimRuntime::end_graph_capture(PimGraph** graph)
+{
+    DLOG(INFO) << "[START] " << __FUNCTION__ << " called";
+    int ret = 0;
 
-    for (int i = 0; i < weight->size / sizeof(uint32_t); i += step) {
-        w_key ^= w_addr_ptr[i];
+    if (t_capture_graph == nullptr) {
+        DLOG(ERROR) << "graph capture is not in progress on this thread";
+        return -1;
     }
-    std::unordered_map<uint32_t, PimBo*>::const_iterator found = weight_map_.find(w_key);
-    if (found != weight_map_.end()) {
-        addr = found->second;
-    } else {
-        DLOG(INFO) << "[%s] not found\tw_addr:%p, w_key:%X, weight_map_size:%d\n"
-                   << __func__ << weight->data << w_key << weight_map_.size();
+
+    PimGraph* captured = t_capture_graph;
+    t_capture_graph = nullptr;
+    ret = pim_executor_->instantiate_graph(captured);
+    if (ret != 0 || graph == nullptr) {
+        delete captured;
+        return ret != 0 ? ret : -1;
     }
+    *graph = captured;
 
     DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
-    return addr;
+    return ret;
 }
 
-int PimRuntime::insert_preloaded_pim_weight(PimBo* dev_wei, PimBo* pim_wei)
+int PimRuntime::launch_graph(PimGraph* graph, void* stream, bool block)
 {
     DLOG(INFO) << "[START] " << __FUNCTION__ << " called";
     int ret = 0;
 
-    uint32_t w_key = 0;
-    uint32_t* w_addr_ptr = reinterpret_cast<uint32_t*>(dev_wei->data);
-    int step = dev_wei->size >> 1;
-    for (int i = 0; i < dev_wei->size / sizeof(uint32_t); i += step) {
-        w_key ^= w_addr_ptr[i];
+    ret = pim_executor_->execute_graph(graph, stream, block);
+
+    DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
+    return ret;
+}
+
+int PimRuntime::destroy_graph(PimGraph* graph)
+{
+    DLOG(INFO) << "[START] " << __FUNCTION__ << " called";
+    delete graph;
+    DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
+    return 0;
+}
+
+int PimRuntime::record_graph_node(const executor::PimGraphNode& node)
+{
+    if (node.output == nullptr || node.operand0 == nullptr) {
+        DLOG(ERROR) << "fail to record " << get_pim_op_string(node.op_type) << " without operands";
+        return -1;
+    }
+    t_capture_graph->nodes.push_back(node);
+    return 0;
+}
+
+int PimRuntime::get_weight_key(PimBo* dev_wei, PimGemmOrder gemm_order, manager::PimWeightKey* key)
+{
+    DLOG(INFO) << "[START] " << __FUNCTION__ << " called";
+    int ret = 0;
+
+    memset(key, 0, sizeof(*key));
+    /* the weight is hashed on every lookup since it can be written by means the runtime does not see */
+    ret = pim_manager_->get_content_hash(dev_wei, &key->hash);
+    key->bshape = dev_wei->bshape;
+    key->bshape_r = dev_wei->bshape_r;
+    key->precision = dev_wei->precision;
+    key->size = dev_wei->size;
+    key->transposed = dev_wei->transposed;
+    key->gemm_order = gemm_order;
+
+    DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
+    return ret;
+}
+
+PimBo* PimRuntime::find_preloaded_pim_weight(const manager::PimWeightKey& key, bool pin)
+{
+    DLOG(INFO) << "[START] " << __FUNCTION__ << " called";
+
+    PimBo* addr = weight_cache_.find(key, pin);
+    if (addr == nullptr) {
+        DLOG(INFO) << "[" << __func__ << "] not found\tw_key:" << std::hex << key.hash.h0 << key.hash.h1 << std::dec;
+    }
+
+    DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
+    return addr;
+}
+
+PimBo* PimRuntime::insert_preloaded_pim_weight(const manager::PimWeightKey& key, PimBo* pim_wei, void* stream,
+                                               bool pin)
+{
+    DLOG(INFO) << "[START] " << __FUNCTION__ << " called";
+
+    std::vector<manager::PimEvictedWeight> evicted;
+    PimBo* cached = weight_cache_.insert(key, pim_wei, &evicted, pin);
+    release_evicted_weights(&evicted, stream);
+    DLOG(INFO) << "[" << __func__ << "] insert\tw_key:" << std::hex << key.hash.h0 << key.hash.h1 << std::dec;
+
+    DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
+    return cached;
+}
+
+void PimRuntime::unpin_preloaded_pim_weight(PimBo* pim_wei, void* stream)
+{
+    std::vector<manager::PimEvictedWeight> evicted;
+    weight_cache_.unpin(pim_wei, stream, &evicted);
+    release_evicted_weights(&evicted, stream);
+}
+
+void PimRuntime::release_evicted_weights(std::vector<manager::PimEvictedWeight>* evicted, void* stream)
+{
+    if (evicted->empty()) return;
+
+    /* gemms launched before on any stream which used an evicted weight may still read it */
+    std::vector<void*> streams(1, stream);
+    for (auto& weight : *evicted) {
+        for (auto* s : weight.streams) {
+            if (std::find(streams.begin(), streams.end(), s) == streams.end()) streams.push_back(s);
+        }
+    }
+    for (auto* s : streams) {
+        pim_executor_->execute_sync(s);
     }
-    weight_map_.insert(std::make_pair(w_key, pim_wei));
-    DLOG(INFO) << "[%s] insert\tw_addr:%p, w_key:%X, weight_map_size:%lu\n"
-               << __func__ << dev_wei->data << w_key << weight_map_.size();
+    for (auto& weight : *evicted) {
+        free_memory(weight.pim_wei);
+        delete weight.pim_wei;
+    }
+    evicted->clear();
+}
+
+int PimRuntime::set_weight_cache_budget(size_t budget)
+{
+    DLOG(INFO) << "[START] " << __FUNCTION__ << " called";
+    int ret = 0;
+
+    std::vector<manager::PimEvictedWeight> evicted;
+    weight_cache_.set_budget(budget, &evicted);
+    release_evicted_weights(&evicted, nullptr);
+
+    DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
+    return ret;
+}
+
+int PimRuntime::get_weight_cache_stats(PimWeightCacheStats* stats)
+{
+    DLOG(INFO) << "[START] " << __FUNCTION__ << " called";
+    int ret = 0;
+
+    weight_cache_.get_stats(stats);
 
     DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
     return ret;
@@ -354,21 +605,30 @@ bool PimRuntime::check_need_for_transpose(PimGemmOrder gemm_order, PimBo* dev_we
 }
 
 PimBo* PimRuntime::get_preloaded_pim_gemm_weight(PimBo* dev_wei, PimGemmOrder gemm_order, bool reorder_on_device,
-                                                 void* stream, bool save_for_reuse)
+                                                 void* stream, bool save_for_reuse, bool pin)
 {
     DLOG(INFO) << "[START] " << __FUNCTION__ << " called";
-    PimBo* pre_wei = find_preloaded_pim_weight(dev_wei);
+    PimBo* pre_wei = nullptr;
+    manager::PimWeightKey key;
+
+    if (save_for_reuse) {
+        if (get_weight_key(dev_wei, gemm_order, &key) != 0) {
+            DLOG(ERROR) << "fail to hash gemm weight";
+            DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
+            return nullptr;
+        }
+        pre_wei = find_preloaded_pim_weight(key, pin);
+    }
 
     if (pre_wei == nullptr) {
         if (reorder_on_device) {
             pim_manager_->set_gemm_order(gemm_order);
             pre_wei = PimCreateBo(dev_wei->bshape.n, dev_wei->bshape.c, dev_wei->bshape.h, dev_wei->bshape.w, PIM_FP16,
                                   MEM_TYPE_PIM);
-            pim_manager_->convert_data_layout(pre_wei, dev_wei, true, stream);
+            /* an I_X_W weight is stored [in][out], the device reorder transposes it as the host reorder does */
+            bool fuse_transpose = check_need_for_transpose(gemm_order, dev_wei) && gemm_order == I_X_W;
+            pim_manager_->convert_data_layout(pre_wei, dev_wei, true, stream, fuse_transpose);
         } else {
-            PimBo* host_weight = nullptr;
-            PimBo* host_weight_t = nullptr;
-            PimBo* host_reordered_weight = nullptr;
             PimBShape* bshape = &dev_wei->bshape;
 
             if (dev_wei->data == nullptr) {
@@ -376,29 +636,27 @@ PimBo* PimRuntime::get_preloaded_pim_gemm_weight(PimBo* dev_wei, PimGemmOrder ge
                 return nullptr;
             }
 
-            host_weight = PimCreateBo(bshape->n, bshape->c, bshape->h, bshape->w, PIM_FP16, MEM_TYPE_HOST);
-            host_weight_t = PimCreateBo(bshape->n, bshape->c, bshape->h, bshape->w, PIM_FP16, MEM_TYPE_HOST);
-            host_reordered_weight = PimCreateBo(bshape->n, bshape->c, bshape->h, bshape->w, PIM_FP16, MEM_TYPE_HOST);
-            pre_wei = PimCreateBo(bshape->n, bshape->c, bshape->h, bshape->w, PIM_FP16, MEM_TYPE_PIM);
-
-            if (check_need_for_transpose(gemm_order, dev_wei) == true) {
-                pim_manager_->copy_memory(host_weight_t, dev_wei, DEVICE_TO_HOST);
-                transpose_pimbo(host_weight, host_weight_t);
-            } else {
-                pim_manager_->copy_memory(host_weight, dev_wei, DEVICE_TO_HOST);
-            }
+            /*
+             * a weight stored transposed, an I_X_W one in [in][out] order or a transposed W_X_I one, is reordered
+             * straight from the stored order without a transposed copy
+             */
+            bool fuse_transpose = check_need_for_transpose(gemm_order, dev_wei);
 
+            pre_wei = PimCreateBo(bshape->n, bshape->c, bshape->h, bshape->w, PIM_FP16, MEM_TYPE_PIM);
             pim_manager_->set_gemm_order(gemm_order);
-            pim_manager_->convert_data_layout(host_reordered_weight, host_weight, false, nullptr);
-            PimCopyMemory(pre_wei, host_reordered_weight, HOST_TO_PIM);
 
-            PimDestroyBo(host_weight);
-            PimDestroyBo(host_weight_t);
-            PimDestroyBo(host_reordered_weight);
+            /*
+             * the memory manager stages the device weight in bounded tiles and overlaps the device reads,
+             * the host reorder and the PIM writes; the view keeps the whole bshape as the staged copy had it
+             */
+            PimBo src_view = *dev_wei;
+            src_view.bshape_r = src_view.bshape;
+            src_view.size = (size_t)bshape->n * bshape->c * bshape->h * bshape->w * sizeof(half);
+            pim_manager_->convert_data_layout(pre_wei, &src_view, false, nullptr, fuse_transpose);
         }
 
         if (save_for_reuse) {
-            insert_preloaded_pim_weight(dev_wei, pre_wei);
+            pre_wei = insert_preloaded_pim_weight(key, pre_wei, stream, pin);
         }
     }
 
@@ -438,14 +696,52 @@ PimBo* PimRuntime::generate_gemm_weight_from_buffer(PimBo* src, PimGemmOrder gem
     return pim_reordered_buff;
 }
 
+int PimRuntime::restore_gemm_weight(PimBo* dst, PimBo* src, PimGemmOrder gemm_order, bool restore_on_device,
+                                    void* stream)
+{
+    DLOG(INFO) << "[START] " << __FUNCTION__ << " called";
+    int ret = 0;
+    PimBShape* bshape = &dst->bshape;
+
+    if (src->data_layout_type != PimDataLayoutType::ALIGNED_GEMM_WEIGHT &&
+        src->data_layout_type != PimDataLayoutType::CHWISE_GEMM_WEIGHT) {
+        DLOG(ERROR) << "GEMM weight restoring from provided layout is not supported";
+        DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
+        return -1;
+    }
+    if (dst->data == nullptr || bshape->n != src->bshape.n || bshape->c != src->bshape.c ||
+        bshape->h != src->bshape.h || bshape->w != src->bshape.w) {
+        DLOG(ERROR) << "restored buffer does not match the shape of the gemm weight";
+        DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
+        return -1;
+    }
+
+    /* the inverse of get_preloaded_pim_gemm_weight, dst->transposed tells the stored order as dev_wei did there */
+    bool need_transpose = check_need_for_transpose(gemm_order, dst);
+    pim_manager_->set_gemm_order(gemm_order);
+
+    if (restore_on_device) {
+        ret = pim_manager_->restore_data_layout(dst, src, true, stream, need_transpose);
+    } else {
+        /* the same whole bshape view the host reorder reads from */
+        PimBo dst_view = *dst;
+        dst_view.bshape_r = dst_view.bshape;
+        dst_view.size = (size_t)bshape->n * bshape->c * bshape->h * bshape->w * sizeof(half);
+        ret = pim_manager_->restore_data_layout(&dst_view, src, false, nullptr, need_transpose);
+    }
+    if (ret == 0) dst->data_layout_type = PimDataLayoutType::RAW;
+
+    DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
+    return ret;
+}
+
 #if PIM_COMPILER_ENABLE == 1
 PimCompiledObj* PimRuntime::build_program(pimc::frontend::Var output, std::vector<pimc::frontend::Buffer> inputs,
                                           std::vector<PimBo*> input_pimbo, PimTarget* target, std::string compile_opts)
 {
     DLOG(INFO) << "[START] " << __FUNCTION__ << " called";
 
-    pimc_driver::PimCDriver pimc_driver;
-    PimCompiledObj* pim_co = pimc_driver.build_program(output, inputs, input_pimbo, target, compile_opts);
+    PimCompiledObj* pim_co = pimc_driver_->build_program(output, inputs, input_pimbo, target, compile_opts);
 
     DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
     return pim_co;
@@ -455,8 +751,7 @@ PimBo* PimRuntime::execute_program(PimCompiledObj* obj, PimTarget* target, std::
 {
     DLOG(INFO) << "[START] " << __FUNCTION__ << " called";
 
-    pimc_driver::PimCDriver pimc_driver;
-    PimBo* output_pimbo = pimc_driver.execute_program(obj, target, launch_opts);
+    PimBo* output_pimbo = pimc_driver_->execute_program(obj, target, launch_opts);
 
     DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
     return output_pimbo;
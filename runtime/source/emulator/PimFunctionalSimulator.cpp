@@ -0,0 +1,470 @@
+/*
+ * Copyright (C) 2022 Samsung Electronics Co. LTD
+ *
+ * This software is a property of Samsung Electronics.
+ * No part of this software, either material or conceptual may be copied or distributed, transmitted,
+ * transcribed, stored in a retrieval system or translated into any human or computer language in any form by any means,
+ * electronic, mechanical, manual or otherwise, or disclosed
+ * to third parties without the express written permission of Samsung Electronics.
+ * (Use of the Software is restricted to non-commercial, personal or academic, research purpose only)
+ */
+
+#include "emulator/PimFunctionalSimulator.h"
+#include <string.h>
+#include <algorithm>
+#include "utility/pim_log.h"
+
+using namespace pim::runtime::executor;
+
+namespace pim
+{
+namespace runtime
+{
+namespace emulator
+{
+/* register row and its columns, see the W_CMD_R targets of the PIM kernels */
+#define PIM_REG_ROW (0x3fff)
+#define CTRL_COL (0x0)
+#define SRF_COL (0x1)
+#define CRF_COL (0x4)
+#define GRF_A_COL (0x8)
+#define GRF_B_COL (0x18)
+/* bytes of the mode register burst */
+#define CTRL_PIM_OP_MODE (0)
+#define CTRL_GRF_A_ZERO (20)
+#define CTRL_GRF_B_ZERO (21)
+/* JUMPs followed within one column command before the program is taken as broken */
+#define MAX_JUMP_HOPS (32)
+
+static inline uint32_t get_bits(uint64_t* addr, int num_bit)
+{
+    uint32_t val = *addr & ((1ULL << num_bit) - 1);
+    *addr >>= num_bit;
+    return val;
+}
+
+PimFunctionalSimulator::PimFunctionalSimulator(void) : page_shift_(16)
+{
+    memcpy(&pbi_, &vega20_pbi, sizeof(PimBlockInfo));
+}
+
+PimFunctionalSimulator::~PimFunctionalSimulator(void) { deinitialize(); }
+void PimFunctionalSimulator::initialize(void)
+{
+    DLOG(INFO) << "[START] " << __FUNCTION__ << " called";
+    int num_ranks = pbi_.num_pim_chan * pbi_.num_pim_rank;
+    int num_grf = pbi_.num_pim_blocks * pbi_.num_grf;
+
+    ranks_.resize(num_ranks);
+    for (auto& rank : ranks_) {
+        rank.pim_op_mode = false;
+        rank.crf_exit = false;
+        rank.pc = 0;
+        rank.repeat_pc = rank.jump_pc = -1;
+        rank.num_repeat = rank.num_jump = 0;
+        memset(rank.crf, 0, sizeof(rank.crf));
+        rank.grf_a.assign(num_grf, PimFuncBurst());
+        rank.grf_b.assign(num_grf, PimFuncBurst());
+        rank.srf.assign(pbi_.num_pim_blocks, PimFuncBurst());
+    }
+    DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
+}
+
+void PimFunctionalSimulator::deinitialize(void)
+{
+    ranks_.clear();
+    pages_.clear();
+}
+
+PimFuncAddr PimFunctionalSimulator::decode_addr(uint64_t addr)
+{
+    /* inverse of addr_gen */
+    PimFuncAddr fa;
+    uint32_t chan_low, chan_high, col_low, col_mid, bank_low, bank_high, col_high;
+
+    get_bits(&addr, pbi_.num_offset_bit);
+    col_low = get_bits(&addr, 1);
+    chan_low = get_bits(&addr, 1);
+    col_mid = get_bits(&addr, 1);
+    chan_high = get_bits(&addr, pbi_.num_chan_bit - 1);
+    bank_low = get_bits(&addr, pbi_.num_bank_low_bit);
+    fa.bg = get_bits(&addr, pbi_.num_bankgroup_bit);
+    bank_high = get_bits(&addr, pbi_.num_bank_high_bit);
+    col_high = get_bits(&addr, pbi_.num_col_high_bit);
+    fa.row = get_bits(&addr, pbi_.num_row_bit);
+    fa.rank = get_bits(&addr, pbi_.num_rank_bit);
+    fa.upper = addr;
+
+    fa.chan = (chan_high << 1) | chan_low;
+    fa.bank = (bank_high << 1) | bank_low;
+    fa.col = (col_high << 2) | (col_mid << 1) | col_low;
+    return fa;
+}
+
+uint64_t PimFunctionalSimulator::encode_addr(const PimFuncAddr& fa)
+{
+    uint64_t addr = fa.upper;
+
+    addr = (addr << pbi_.num_rank_bit) | fa.rank;
+    addr = (addr << pbi_.num_row_bit) | fa.row;
+    addr = (addr << pbi_.num_col_high_bit) | (fa.col >> 2);
+    addr = (addr << pbi_.num_bank_high_bit) | (fa.bank >> 1);
+    addr = (addr << pbi_.num_bankgroup_bit) | fa.bg;
+    addr = (addr << pbi_.num_bank_low_bit) | (fa.bank & 1);
+    addr = (addr << (pbi_.num_chan_bit - 1)) | (fa.chan >> 1);
+    addr = (addr << 1) | ((fa.col >> 1) & 1);
+    addr = (addr << 1) | (fa.chan & 1);
+    addr = (addr << 1) | (fa.col & 1);
+    addr <<= pbi_.num_offset_bit;
+    return addr;
+}
+
+uint8_t* PimFunctionalSimulator::get_page(uint64_t addr)
+{
+    auto& page = pages_[addr >> page_shift_];
+    if (page == nullptr) {
+        page.reset(new uint8_t[1 << page_shift_]);
+        memset(page.get(), 0, 1 << page_shift_);
+    }
+    return page.get() + (addr & ((1 << page_shift_) - 1));
+}
+
+void PimFunctionalSimulator::read_burst(uint64_t addr, PimFuncBurst* bst)
+{
+    memcpy(bst->lanes, get_page(addr), pbi_.trans_size);
+}
+
+void PimFunctionalSimulator::write_burst(uint64_t addr, const PimFuncBurst& bst)
+{
+    memcpy(get_page(addr), bst.lanes, pbi_.trans_size);
+}
+
+void PimFunctionalSimulator::preload_data_with_addr(uint64_t addr, void* data, size_t data_size)
+{
+    uint8_t* src = (uint8_t*)data;
+    size_t page_size = 1 << page_shift_;
+
+    while (data_size > 0) {
+        size_t size = std::min(data_size, page_size - (addr & (page_size - 1)));
+        memcpy(get_page(addr), src, size);
+        addr += size;
+        src += size;
+        data_size -= size;
+    }
+}
+
+void PimFunctionalSimulator::read_result(uint16_t* output_data, uint64_t addr, size_t data_size)
+{
+    uint8_t* dst = (uint8_t*)output_data;
+    size_t page_size = 1 << page_shift_;
+
+    while (data_size > 0) {
+        size_t size = std::min(data_size, page_size - (addr & (page_size - 1)));
+        memcpy(dst, get_page(addr), size);
+        addr += size;
+        dst += size;
+        data_size -= size;
+    }
+}
+
+void PimFunctionalSimulator::read_result_gemv(uint16_t* output_data, uint64_t addr, size_t data_dim)
+{
+    for (size_t i = 0; i < data_dim; i++) {
+        PimFuncBurst bst;
+        read_burst(get_gemv_result_addr(addr, i), &bst);
+        output_data[i] = reduce_gemv_burst((const uint8_t*)bst.lanes);
+    }
+}
+
+uint64_t PimFunctionalSimulator::get_gemv_result_addr(uint64_t addr, size_t idx)
+{
+    int pb;
+    PimFuncAddr fa = get_gemv_output_addr(addr, idx, &pb);
+
+    /* the kernel writes bank 1 of the buffer, each PIM block stores to its own odd bank */
+    return get_bank_addr(fa, pb, 1);
+}
+
+uint16_t PimFunctionalSimulator::reduce_gemv_burst(const uint8_t* burst)
+{
+    half_float::half lanes[16];
+    half_float::half sum(0.0f);
+    uint16_t out;
+
+    memcpy(lanes, burst, sizeof(lanes));
+    for (int l = 0; l < pbi_.num_out_per_grf; l++) sum += lanes[l];
+    memcpy(&out, &sum, sizeof(uint16_t));
+    return out;
+}
+
+PimFuncAddr PimFunctionalSimulator::get_gemv_output_addr(uint64_t addr, size_t idx, int* pb)
+{
+    /* outputs follow the weight layout, eight per GRF_B, then PIM block, rank and channel */
+    int num_grf = pbi_.num_grf;
+    int num_col_per_row = pbi_.num_col / pbi_.bl;
+    int tile_size = num_grf * pbi_.num_pim_blocks * pbi_.num_pim_rank * pbi_.num_pim_chan;
+    int tile = idx / tile_size;
+    int blk = (idx % tile_size) / num_grf;
+    int loc = tile * num_grf + idx % num_grf;
+    PimFuncAddr fa;
+
+    fa.chan = blk / (pbi_.num_pim_blocks * pbi_.num_pim_rank);
+    fa.rank = (blk / pbi_.num_pim_blocks) % pbi_.num_pim_rank;
+    fa.bg = 0;
+    fa.bank = 1;
+    fa.row = loc / num_col_per_row;
+    fa.col = loc % num_col_per_row;
+    fa.upper = 0;
+
+    *pb = blk % pbi_.num_pim_blocks;
+    return decode_addr(addr + encode_addr(fa));
+}
+
+PimFuncRank* PimFunctionalSimulator::get_rank(uint32_t chan, uint32_t rank)
+{
+    if (ranks_.empty()) initialize();
+    return &ranks_[(chan * pbi_.num_pim_rank + rank) % ranks_.size()];
+}
+
+uint64_t PimFunctionalSimulator::get_bank_addr(const PimFuncAddr& fa, int pb, int odd)
+{
+    int num_banks_per_bg = pbi_.num_banks / pbi_.num_bank_groups;
+    int bank = pb * (pbi_.num_banks / pbi_.num_pim_blocks) + odd;
+    PimFuncAddr bank_fa = fa;
+
+    bank_fa.bg = bank / num_banks_per_bg;
+    bank_fa.bank = bank % num_banks_per_bg;
+    return encode_addr(bank_fa);
+}
+
+void PimFunctionalSimulator::execute_kernel(void* trace_data, size_t num_trace)
+{
+    DLOG(INFO) << "[START] " << __FUNCTION__ << " called";
+    PimMemTraceData* trace = (PimMemTraceData*)trace_data;
+
+    for (size_t i = 0; i < num_trace; i++) execute_cmd(&trace[i]);
+    DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
+}
+
+void PimFunctionalSimulator::execute_cmd(PimMemTraceData* trace)
+{
+    if (trace->cmd != 'R' && trace->cmd != 'O' && trace->cmd != 'W') return;
+
+    /* every record is one burst, as in the cycle model */
+    PimFuncAddr fa = decode_addr(trace->addr & ~(uint64_t)(pbi_.trans_size - 1));
+    PimFuncRank* rank = get_rank(fa.chan, fa.rank);
+    bool is_write = (trace->cmd == 'W');
+
+    if (fa.row == PIM_REG_ROW) {
+        if (is_write) {
+            PimFuncBurst data;
+            memcpy(data.lanes, trace->data, pbi_.trans_size);
+            write_register(rank, fa, data);
+        }
+        return;
+    }
+
+    /* outside PIM mode the kernels only park rows and switch modes, host data arrives through preload */
+    if (rank->pim_op_mode && !rank->crf_exit) do_pim(rank, fa, is_write);
+}
+
+void PimFunctionalSimulator::write_register(PimFuncRank* rank, const PimFuncAddr& fa, const PimFuncBurst& data)
+{
+    const uint8_t* bytes = (const uint8_t*)data.lanes;
+    int num_grf = pbi_.num_grf;
+
+    if (fa.col == CTRL_COL) {
+        rank->pim_op_mode = bytes[CTRL_PIM_OP_MODE] & 1;
+        if (bytes[CTRL_GRF_A_ZERO] & 1) rank->grf_a.assign(rank->grf_a.size(), PimFuncBurst());
+        if (bytes[CTRL_GRF_B_ZERO] & 1) rank->grf_b.assign(rank->grf_b.size(), PimFuncBurst());
+        if (rank->pim_op_mode) {
+            rank->pc = 0;
+            rank->crf_exit = false;
+            rank->repeat_pc = rank->jump_pc = -1;
+            rank->num_repeat = rank->num_jump = 0;
+        }
+    } else if (fa.col == SRF_COL) {
+        for (auto& srf : rank->srf) srf = data;
+    } else if (fa.col >= CRF_COL && fa.col < GRF_A_COL) {
+        memcpy(&rank->crf[(fa.col - CRF_COL) * 8], bytes, pbi_.trans_size);
+    } else if (fa.col >= GRF_A_COL && fa.col < GRF_A_COL + num_grf) {
+        for (int pb = 0; pb < pbi_.num_pim_blocks; pb++) rank->grf_a[pb * num_grf + fa.col - GRF_A_COL] = data;
+    } else if (fa.col >= GRF_B_COL && fa.col < GRF_B_COL + num_grf) {
+        for (int pb = 0; pb < pbi_.num_pim_blocks; pb++) rank->grf_b[pb * num_grf + fa.col - GRF_B_COL] = data;
+    }
+}
+
+void PimFunctionalSimulator::do_pim(PimFuncRank* rank, const PimFuncAddr& fa, bool is_write)
+{
+    PimCommand cmd;
+
+    for (int hop = 0; hop < MAX_JUMP_HOPS; hop++) {
+        if (rank->pc < 0 || rank->pc >= 32) {
+            DLOG(ERROR) << "CRF program counter out of range : " << rank->pc;
+            rank->crf_exit = true;
+            return;
+        }
+        cmd = PimCommand();
+        cmd.from_int(rank->crf[rank->pc]);
+
+        if (cmd.type_ == PimCmdType::EXIT) {
+            rank->crf_exit = true;
+            return;
+        }
+
+        /* JUMP takes no column command, the one at hand runs at the target */
+        if (cmd.type_ == PimCmdType::JUMP) {
+            if (rank->jump_pc != rank->pc) {
+                rank->jump_pc = rank->pc;
+                rank->num_jump = cmd.loop_counter_;
+            }
+            if (rank->num_jump-- > 0) {
+                rank->pc = rank->pc - cmd.loop_offset_ + 1;
+            } else {
+                rank->jump_pc = -1;
+                rank->pc++;
+            }
+            continue;
+        }
+
+        int num_repeat = 0;
+        if (cmd.type_ == PimCmdType::NOP) {
+            num_repeat = cmd.loop_counter_;
+            /* a write during NOP cycles stores the GRF of the written bank half */
+            if (is_write) {
+                int num_grf = pbi_.num_grf;
+                int odd = fa.bank & 1;
+                for (int pb = 0; pb < pbi_.num_pim_blocks; pb++) {
+                    auto& grf = odd ? rank->grf_b : rank->grf_a;
+                    write_burst(get_bank_addr(fa, pb, odd), grf[pb * num_grf + (fa.col & (num_grf - 1))]);
+                }
+            }
+        } else {
+            /* FILL and MOV have no AAM bit in their encoding and always run in AAM */
+            if (cmd.is_auto_ || cmd.type_ == PimCmdType::FILL || cmd.type_ == PimCmdType::MOV) {
+                num_repeat = pbi_.num_grf - 1;
+            }
+            for (int pb = 0; pb < pbi_.num_pim_blocks; pb++) do_pim_block(rank, cmd, fa, pb);
+        }
+
+        if (rank->repeat_pc != rank->pc) {
+            rank->repeat_pc = rank->pc;
+            rank->num_repeat = num_repeat;
+        }
+        if (rank->num_repeat-- <= 0) {
+            rank->repeat_pc = -1;
+            rank->pc++;
+        }
+        return;
+    }
+
+    DLOG(ERROR) << "CRF program does not reach a column command";
+    rank->crf_exit = true;
+}
+
+void PimFunctionalSimulator::do_pim_block(PimFuncRank* rank, const PimCommand& cmd, const PimFuncAddr& fa, int pb)
+{
+    int num_grf = pbi_.num_grf;
+    bool is_aam = cmd.is_auto_ || cmd.type_ == PimCmdType::FILL || cmd.type_ == PimCmdType::MOV;
+    /* AAM takes the GRF index from the column, a MAC reads GRF_A by the row parity and the column group */
+    int low_idx = fa.col & (num_grf - 1);
+    int high_idx = ((fa.row & 1) << 2) | ((fa.col >> 3) & 3);
+    int is_mac = (cmd.type_ == PimCmdType::MAC);
+    int dst_idx = is_aam ? low_idx : cmd.dst_idx_;
+    int src0_idx = cmd.src0_idx_;
+    int src1_idx = cmd.src1_idx_;
+    PimFuncBurst dst, src0, src1, src2;
+
+    auto grf_src_idx = [&](PimOpdType type, int idx) {
+        if (!is_aam || (type != PimOpdType::GRF_A && type != PimOpdType::GRF_B)) return idx;
+        return is_mac ? high_idx : low_idx;
+    };
+
+    read_opd(rank, &src0, cmd.src0_, fa, pb, grf_src_idx(cmd.src0_, src0_idx));
+    switch (cmd.type_) {
+        case PimCmdType::FILL:
+        case PimCmdType::MOV:
+            dst = src0;
+            if (cmd.is_relu_) {
+                for (int l = 0; l < 16; l++) {
+                    if (dst.lanes[l] < half_float::half(0.0f)) dst.lanes[l] = half_float::half(0.0f);
+                }
+            }
+            break;
+        case PimCmdType::ADD:
+            read_opd(rank, &src1, cmd.src1_, fa, pb, grf_src_idx(cmd.src1_, src1_idx));
+            for (int l = 0; l < 16; l++) dst.lanes[l] = src0.lanes[l] + src1.lanes[l];
+            break;
+        case PimCmdType::MUL:
+            read_opd(rank, &src1, cmd.src1_, fa, pb, grf_src_idx(cmd.src1_, src1_idx));
+            for (int l = 0; l < 16; l++) dst.lanes[l] = src0.lanes[l] * src1.lanes[l];
+            break;
+        case PimCmdType::MAC:
+            read_opd(rank, &src1, cmd.src1_, fa, pb, grf_src_idx(cmd.src1_, src1_idx));
+            read_opd(rank, &dst, cmd.dst_, fa, pb, dst_idx);
+            for (int l = 0; l < 16; l++) dst.lanes[l] += src0.lanes[l] * src1.lanes[l];
+            break;
+        case PimCmdType::MAD:
+            /* src2 has no index field of its own and shares the one of src1 */
+            read_opd(rank, &src1, cmd.src1_, fa, pb, grf_src_idx(cmd.src1_, src1_idx));
+            read_opd(rank, &src2, cmd.src2_, fa, pb, grf_src_idx(cmd.src2_, src1_idx));
+            for (int l = 0; l < 16; l++) dst.lanes[l] = src0.lanes[l] * src1.lanes[l] + src2.lanes[l];
+            break;
+        default:
+            return;
+    }
+    write_opd(rank, dst, cmd.dst_, fa, pb, dst_idx);
+}
+
+void PimFunctionalSimulator::read_opd(PimFuncRank* rank, PimFuncBurst* bst, PimOpdType type, const PimFuncAddr& fa,
+                                      int pb, int idx)
+{
+    int num_grf = pbi_.num_grf;
+
+    switch (type) {
+        case PimOpdType::EVEN_BANK:
+        case PimOpdType::ODD_BANK:
+            read_burst(get_bank_addr(fa, pb, type == PimOpdType::ODD_BANK), bst);
+            break;
+        case PimOpdType::GRF_A:
+            *bst = rank->grf_a[pb * num_grf + (idx & (num_grf - 1))];
+            break;
+        case PimOpdType::GRF_B:
+            *bst = rank->grf_b[pb * num_grf + (idx & (num_grf - 1))];
+            break;
+        case PimOpdType::SRF_M:
+            for (int l = 0; l < 16; l++) bst->lanes[l] = rank->srf[pb].lanes[idx & 7];
+            break;
+        case PimOpdType::SRF_A:
+            for (int l = 0; l < 16; l++) bst->lanes[l] = rank->srf[pb].lanes[8 + (idx & 7)];
+            break;
+        default:
+            /* A_OUT and M_OUT are not used by the programs of this runtime */
+            *bst = PimFuncBurst();
+            break;
+    }
+}
+
+void PimFunctionalSimulator::write_opd(PimFuncRank* rank, const PimFuncBurst& bst, PimOpdType type,
+                                       const PimFuncAddr& fa, int pb, int idx)
+{
+    int num_grf = pbi_.num_grf;
+
+    switch (type) {
+        case PimOpdType::EVEN_BANK:
+        case PimOpdType::ODD_BANK:
+            write_burst(get_bank_addr(fa, pb, type == PimOpdType::ODD_BANK), bst);
+            break;
+        case PimOpdType::GRF_A:
+            rank->grf_a[pb * num_grf + (idx & (num_grf - 1))] = bst;
+            break;
+        case PimOpdType::GRF_B:
+            rank->grf_b[pb * num_grf + (idx & (num_grf - 1))] = bst;
+            break;
+        default:
+            break;
+    }
+}
+} /* namespace emulator */
+} /* namespace runtime */
+} /* namespace pim */
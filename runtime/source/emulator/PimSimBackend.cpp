@@ -0,0 +1,404 @@
+/*
+ * Copyright (C) 2022 Samsung Electronics Co. LTD
+ *
+ * This software is a property of Samsung Electronics.
+ * No part of this software, either material or conceptual may be copied or distributed, transmitted,
+ * transcribed, stored in a retrieval system or translated into any human or computer language in any form by any means,
+ * electronic, mechanical, manual or otherwise, or disclosed
+ * to third parties without the express written permission of Samsung Electronics.
+ * (Use of the Software is restricted to non-commercial, personal or academic, research purpose only)
+ */
+
+#include "emulator/PimSimBackend.h"
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include "utility/pim_log.h"
+
+namespace pim
+{
+namespace runtime
+{
+namespace emulator
+{
+namespace
+{
+typedef enum __PimSimMsgType {
+    SIM_MSG_WRITE,  /* preload bursts, no reply */
+    SIM_MSG_KERNEL, /* kernel records, replies the cycles it took */
+    SIM_MSG_READ,   /* burst addresses, replies their data */
+} PimSimMsgType;
+
+typedef struct __PimSimMsg {
+    int32_t type;
+    uint64_t count;
+} PimSimMsg;
+
+int send_all(int fd, const void* buf, size_t size)
+{
+    const uint8_t* ptr = (const uint8_t*)buf;
+    while (size > 0) {
+        ssize_t ret = send(fd, ptr, size, MSG_NOSIGNAL);
+        if (ret < 0 && errno == EINTR) continue;
+        if (ret <= 0) return -1;
+        ptr += ret;
+        size -= ret;
+    }
+    return 0;
+}
+
+int recv_all(int fd, void* buf, size_t size)
+{
+    uint8_t* ptr = (uint8_t*)buf;
+    while (size > 0) {
+        ssize_t ret = recv(fd, ptr, size, 0);
+        if (ret < 0 && errno == EINTR) continue;
+        if (ret <= 0) return -1;
+        ptr += ret;
+        size -= ret;
+    }
+    return 0;
+}
+
+int send_msg(int fd, PimSimMsgType type, const void* payload, uint64_t count, size_t record_size)
+{
+    PimSimMsg msg = {type, count};
+    if (send_all(fd, &msg, sizeof(msg)) != 0) return -1;
+    return send_all(fd, payload, count * record_size);
+}
+
+/* request loop of a worker process, it returns when the backend closes its end */
+void serve_requests(PimSimInstance* sim, int fd)
+{
+    PimSimMsg msg;
+    std::vector<PimMemTraceData> trace;
+    std::vector<uint64_t> addrs;
+    std::vector<uint8_t> data;
+
+    while (recv_all(fd, &msg, sizeof(msg)) == 0) {
+        if (msg.type == SIM_MSG_WRITE || msg.type == SIM_MSG_KERNEL) {
+            trace.resize(msg.count);
+            if (recv_all(fd, trace.data(), msg.count * sizeof(PimMemTraceData)) != 0) return;
+            if (msg.type == SIM_MSG_WRITE) {
+                sim->write_bursts(trace.data(), trace.size());
+                continue;
+            }
+            uint64_t cycle = sim->execute_kernel(trace.data(), trace.size());
+            if (send_all(fd, &cycle, sizeof(cycle)) != 0) return;
+        } else if (msg.type == SIM_MSG_READ) {
+            addrs.resize(msg.count);
+            data.resize(msg.count * sizeof(((PimMemTraceData*)0)->data));
+            if (recv_all(fd, addrs.data(), msg.count * sizeof(uint64_t)) != 0) return;
+            sim->read_bursts(addrs.data(), addrs.size(), data.data());
+            if (send_all(fd, data.data(), data.size()) != 0) return;
+        } else {
+            return;
+        }
+    }
+}
+}  // namespace
+
+PimSimBackend::PimSimBackend(void) : mode_(EMULATOR_TIMING), num_sims_(0), kernel_cycle_(0), cycle_(0)
+{
+    memcpy(&pbi_, &vega20_pbi, sizeof(PimBlockInfo));
+}
+
+PimSimBackend::~PimSimBackend(void) { stop_workers(); }
+void PimSimBackend::initialize(const std::string& device_ini_file_name, const std::string& system_ini_file_name,
+                               size_t megs_of_memory, size_t num_pim_chan, size_t num_pim_rank)
+{
+    DLOG(INFO) << "[START] " << __FUNCTION__ << " called";
+    mode_ = EMULATOR_TIMING;
+    const char* env_m = std::getenv("PIM_EMULATOR_MODE");
+    if (env_m != nullptr && strcmp(env_m, "functional") == 0) {
+        mode_ = EMULATOR_FUNCTIONAL;
+    }
+
+    stop_workers();
+    pim_sim_.reset();
+    local_sim_.reset();
+    num_sims_ = 0;
+    kernel_cycle_ = 0;
+    cycle_ = 0;
+    const char* env_r = std::getenv("PIM_EMULATOR_RECORD");
+    if (env_r != nullptr && recorder_.open(env_r) == 0) {
+        DLOG(INFO) << "recording emulator traces to " << env_r;
+    }
+
+    if (mode_ == EMULATOR_FUNCTIONAL) {
+        /* the DRAMSim2 memory system is never built, which is most of the start up time */
+        func_sim_.initialize();
+        DLOG(INFO) << "functional emulator mode";
+    } else {
+        int num_sims = 1;
+        const char* env_t = std::getenv("PIM_EMULATOR_NUM_THREADS");
+        if (env_t != nullptr) {
+            num_sims = atoi(env_t);
+            if (num_sims <= 0) num_sims = std::max(1u, std::thread::hardware_concurrency());
+        }
+        num_sims = std::min(num_sims, (int)num_pim_chan);
+
+        /* workers are forked before this process builds its own instance, so they do not inherit it */
+        int ret = 0;
+        if (num_sims > 1) {
+            ret = start_workers(device_ini_file_name, system_ini_file_name, megs_of_memory, num_pim_chan, num_sims - 1);
+        }
+        if (ret != 0) {
+            LOG(ERROR) << "fail to start the simulator workers, simulating every channel in this process";
+            stop_workers();
+        }
+        if (workers_.empty()) {
+            pim_sim_.reset(new PimSimulator());
+            pim_sim_->initialize(device_ini_file_name, system_ini_file_name, megs_of_memory, num_pim_chan,
+                                 num_pim_rank);
+            num_sims_ = 1;
+        } else {
+            local_sim_.reset(new PimSimInstance());
+            local_sim_->initialize(device_ini_file_name, system_ini_file_name, megs_of_memory, num_pim_chan);
+            num_sims_ = 1 + workers_.size();
+            sim_traces_.assign(num_sims_, std::vector<PimMemTraceData>());
+            sim_addrs_.assign(num_sims_, std::vector<uint64_t>());
+        }
+        DLOG(INFO) << "timing emulator mode, " << num_sims_ << " simulator instances";
+    }
+    DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
+}
+
+int PimSimBackend::start_workers(const std::string& device_ini_file_name, const std::string& system_ini_file_name,
+                                 size_t megs_of_memory, size_t num_pim_chan, int num_workers)
+{
+    /*
+     * The workers are forked without exec, when the emulator is built and before any kernel is traced, so no trace
+     * collector thread is running yet. Other threads of the process, e.g. of the HIP runtime, are not copied.
+     * A worker never calls into HIP or OpenCL and does not log; it only builds its DRAMSim2 instance and serves
+     * requests with plain libc and libstdc++ calls, whose allocator and stream locks are reset across fork by glibc.
+     */
+    for (int i = 0; i < num_workers; i++) {
+        int fds[2];
+        if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0) return -1;
+        pid_t pid = fork();
+        if (pid < 0) {
+            close(fds[0]);
+            close(fds[1]);
+            return -1;
+        }
+        if (pid == 0) {
+            /* the worker only touches its own DRAMSim2 instance and leaves through _exit */
+            for (auto& worker : workers_) close(worker.fd);
+            close(fds[0]);
+            PimSimInstance sim;
+            sim.initialize(device_ini_file_name, system_ini_file_name, megs_of_memory, num_pim_chan);
+            serve_requests(&sim, fds[1]);
+            _exit(0);
+        }
+        close(fds[1]);
+        workers_.push_back({pid, fds[0]});
+    }
+    return 0;
+}
+
+void PimSimBackend::stop_workers(void)
+{
+    /* closing the socket ends the request loop of the worker */
+    for (auto& worker : workers_) close(worker.fd);
+    for (auto& worker : workers_) waitpid(worker.pid, nullptr, 0);
+    workers_.clear();
+}
+
+int PimSimBackend::get_sim_id(const PimMemTraceData& trace)
+{
+    /* barriers carry no address, the block of a trace is its channel */
+    int chan = (trace.cmd == 'B') ? trace.block_id % pbi_.num_pim_chan : func_sim_.decode_addr(trace.addr).chan;
+    return chan % num_sims_;
+}
+
+int PimSimBackend::write_on_sims(void)
+{
+    int ret = 0;
+    for (int i = 1; i < num_sims_; i++) {
+        if (send_msg(workers_[i - 1].fd, SIM_MSG_WRITE, sim_traces_[i].data(), sim_traces_[i].size(),
+                     sizeof(PimMemTraceData)) != 0) {
+            LOG(ERROR) << "fail to send preload data to simulator worker " << i;
+            ret = -1;
+        }
+    }
+    local_sim_->write_bursts(sim_traces_[0].data(), sim_traces_[0].size());
+    return ret;
+}
+
+int PimSimBackend::execute_on_sims(uint64_t* max_cycle)
+{
+    int ret = 0;
+    std::vector<bool> sent(num_sims_, true);
+
+    /* the workers run their part while this process runs instance 0 */
+    for (int i = 1; i < num_sims_; i++) {
+        if (send_msg(workers_[i - 1].fd, SIM_MSG_KERNEL, sim_traces_[i].data(), sim_traces_[i].size(),
+                     sizeof(PimMemTraceData)) != 0) {
+            LOG(ERROR) << "fail to send a kernel to simulator worker " << i;
+            sent[i] = false;
+            ret = -1;
+        }
+    }
+    *max_cycle = local_sim_->execute_kernel(sim_traces_[0].data(), sim_traces_[0].size());
+    for (int i = 1; i < num_sims_; i++) {
+        uint64_t cycle = 0;
+        if (!sent[i]) continue;
+        if (recv_all(workers_[i - 1].fd, &cycle, sizeof(cycle)) != 0) {
+            LOG(ERROR) << "simulator worker " << i << " did not finish the kernel";
+            ret = -1;
+        }
+        *max_cycle = std::max(*max_cycle, cycle);
+    }
+    return ret;
+}
+
+int PimSimBackend::read_on_sims(std::vector<std::vector<uint8_t>>* results)
+{
+    int ret = 0;
+    std::vector<bool> sent(num_sims_, true);
+
+    results->resize(num_sims_);
+    for (int i = 0; i < num_sims_; i++) (*results)[i].resize(sim_addrs_[i].size() * pbi_.trans_size);
+    for (int i = 1; i < num_sims_; i++) {
+        if (send_msg(workers_[i - 1].fd, SIM_MSG_READ, sim_addrs_[i].data(), sim_addrs_[i].size(),
+                     sizeof(uint64_t)) != 0) {
+            LOG(ERROR) << "fail to send a read to simulator worker " << i;
+            sent[i] = false;
+            ret = -1;
+        }
+    }
+    local_sim_->read_bursts(sim_addrs_[0].data(), sim_addrs_[0].size(), (*results)[0].data());
+    for (int i = 1; i < num_sims_; i++) {
+        if (!sent[i]) continue;
+        if (recv_all(workers_[i - 1].fd, (*results)[i].data(), (*results)[i].size()) != 0) {
+            LOG(ERROR) << "simulator worker " << i << " did not return the read data";
+            ret = -1;
+        }
+    }
+    return ret;
+}
+
+int PimSimBackend::preload_data_with_addr(uint64_t addr, void* data, size_t data_size)
+{
+    if (recorder_.is_open()) recorder_.write_preload(addr, data, data_size);
+    if (mode_ == EMULATOR_FUNCTIONAL) {
+        func_sim_.preload_data_with_addr(addr, data, data_size);
+        return 0;
+    }
+    if (pim_sim_ != nullptr) {
+        pim_sim_->preload_data_with_addr(addr, data, data_size);
+        return 0;
+    }
+
+    /* each instance gets the bursts of the channels it owns, a short last burst is padded with zeros */
+    PimMemTraceData burst;
+    memset(&burst, 0, sizeof(burst));
+    burst.cmd = 'W';
+    for (auto& sim_trace : sim_traces_) sim_trace.clear();
+    for (size_t offset = 0; offset < data_size; offset += pbi_.trans_size) {
+        size_t size = std::min((size_t)pbi_.trans_size, data_size - offset);
+        memset(burst.data, 0, sizeof(burst.data));
+        memcpy(burst.data, (uint8_t*)data + offset, size);
+        burst.addr = addr + offset;
+        sim_traces_[get_sim_id(burst)].push_back(burst);
+    }
+    return write_on_sims();
+}
+
+int PimSimBackend::execute_kernel(void* trace_data, size_t num_trace)
+{
+    if (recorder_.is_open()) recorder_.write_kernel((PimMemTraceData*)trace_data, num_trace);
+    if (mode_ == EMULATOR_FUNCTIONAL) {
+        func_sim_.execute_kernel(trace_data, num_trace);
+        return 0;
+    }
+    if (pim_sim_ != nullptr) {
+        pim_sim_->execute_kernel(trace_data, num_trace);
+        return 0;
+    }
+
+    /* split the trace by channel, keeping the order of each channel */
+    PimMemTraceData* traces = (PimMemTraceData*)trace_data;
+    for (auto& sim_trace : sim_traces_) sim_trace.clear();
+    for (size_t i = 0; i < num_trace; i++) {
+        sim_traces_[get_sim_id(traces[i])].push_back(traces[i]);
+    }
+
+    /* channels only share the clock, so the kernel ends with the slowest instance */
+    int ret = execute_on_sims(&kernel_cycle_);
+    cycle_ += kernel_cycle_;
+    return ret;
+}
+
+int PimSimBackend::read_result(uint16_t* output_data, uint64_t addr, size_t data_size)
+{
+    if (mode_ == EMULATOR_FUNCTIONAL) {
+        func_sim_.read_result(output_data, addr, data_size);
+        return 0;
+    }
+    if (pim_sim_ != nullptr) {
+        pim_sim_->read_result(output_data, addr, data_size);
+        return 0;
+    }
+
+    PimMemTraceData trace;
+    trace.cmd = 'R';
+    for (auto& sim_addr : sim_addrs_) sim_addr.clear();
+    for (size_t offset = 0; offset < data_size; offset += pbi_.trans_size) {
+        trace.addr = addr + offset;
+        sim_addrs_[get_sim_id(trace)].push_back(trace.addr);
+    }
+    std::vector<std::vector<uint8_t>> results;
+    if (read_on_sims(&results) != 0) return -1;
+
+    /* each 32B burst is taken from the instance that owns its channel, in the order it was requested */
+    std::vector<size_t> next(num_sims_, 0);
+    for (size_t offset = 0; offset < data_size; offset += pbi_.trans_size) {
+        trace.addr = addr + offset;
+        int id = get_sim_id(trace);
+        size_t size = std::min((size_t)pbi_.trans_size, data_size - offset);
+        memcpy((uint8_t*)output_data + offset, results[id].data() + next[id] * pbi_.trans_size, size);
+        next[id]++;
+    }
+    return 0;
+}
+
+int PimSimBackend::read_result_gemv(uint16_t* output_data, uint64_t addr, size_t data_dim)
+{
+    if (mode_ == EMULATOR_FUNCTIONAL) {
+        func_sim_.read_result_gemv(output_data, addr, data_dim);
+        return 0;
+    }
+    if (pim_sim_ != nullptr) {
+        pim_sim_->read_result_gemv(output_data, addr, data_dim);
+        return 0;
+    }
+
+    PimMemTraceData trace;
+    trace.cmd = 'R';
+    std::vector<int> ids(data_dim);
+    for (auto& sim_addr : sim_addrs_) sim_addr.clear();
+    for (size_t i = 0; i < data_dim; i++) {
+        trace.addr = func_sim_.get_gemv_result_addr(addr, i);
+        ids[i] = get_sim_id(trace);
+        sim_addrs_[ids[i]].push_back(trace.addr);
+    }
+    std::vector<std::vector<uint8_t>> results;
+    if (read_on_sims(&results) != 0) return -1;
+
+    std::vector<size_t> next(num_sims_, 0);
+    for (size_t i = 0; i < data_dim; i++) {
+        output_data[i] = func_sim_.reduce_gemv_burst(results[ids[i]].data() + next[ids[i]] * pbi_.trans_size);
+        next[ids[i]]++;
+    }
+    return 0;
+}
+} /* namespace emulator */
+} /* namespace runtime */
+} /* namespace pim */
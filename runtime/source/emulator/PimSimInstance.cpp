@@ -0,0 +1,84 @@
+/*
+ * Copyright (C) 2022 Samsung Electronics Co. LTD
+ *
+ * This software is a property of Samsung Electronics.
+ * No part of this software, either material or conceptual may be copied or distributed, transmitted,
+ * transcribed, stored in a retrieval system or translated into any human or computer language in any form by any means,
+ * electronic, mechanical, manual or otherwise, or disclosed
+ * to third parties without the express written permission of Samsung Electronics.
+ * (Use of the Software is restricted to non-commercial, personal or academic, research purpose only)
+ */
+
+#include "emulator/PimSimInstance.h"
+#include <cstring>
+
+namespace pim
+{
+namespace runtime
+{
+namespace emulator
+{
+PimSimInstance::PimSimInstance(void) : num_pim_chan_(1), cycle_(0) {}
+void PimSimInstance::initialize(const std::string& device_ini_file_name, const std::string& system_ini_file_name,
+                                size_t megs_of_memory, size_t num_pim_chan)
+{
+    mem_ = std::make_shared<DRAMSim::MultiChannelMemorySystem>(device_ini_file_name, system_ini_file_name, ".",
+                                                                "pim_emulator", (unsigned)megs_of_memory);
+    num_pim_chan_ = num_pim_chan;
+    cycle_ = 0;
+}
+
+void PimSimInstance::push_trace(const PimMemTraceData* trace, size_t num_trace)
+{
+    bursts_.resize(num_trace);
+    for (size_t i = 0; i < num_trace; i++) {
+        /* a full transaction queue only takes the record once the memory system has drained some of it */
+        if (trace[i].cmd == 'B') {
+            while (!mem_->addBarrier(trace[i].block_id % num_pim_chan_)) update();
+            continue;
+        }
+        memcpy(bursts_[i].u8Data_, trace[i].data, sizeof(bursts_[i].u8Data_));
+        while (!mem_->addTransaction(trace[i].cmd == 'W', trace[i].addr, &bursts_[i])) update();
+    }
+}
+
+void PimSimInstance::update(void)
+{
+    mem_->update();
+    cycle_++;
+}
+
+uint64_t PimSimInstance::run(void)
+{
+    while (mem_->hasPendingTransactions()) update();
+    return cycle_;
+}
+
+void PimSimInstance::write_bursts(const PimMemTraceData* bursts, size_t num_burst)
+{
+    push_trace(bursts, num_burst);
+    run();
+}
+
+uint64_t PimSimInstance::execute_kernel(const PimMemTraceData* trace, size_t num_trace)
+{
+    /* cycles spent waiting for queue space count towards the kernel */
+    uint64_t start = cycle_;
+    push_trace(trace, num_trace);
+    return run() - start;
+}
+
+void PimSimInstance::read_bursts(const uint64_t* addrs, size_t num_burst, uint8_t* out)
+{
+    bursts_.resize(num_burst);
+    for (size_t i = 0; i < num_burst; i++) {
+        while (!mem_->addTransaction(false, addrs[i], &bursts_[i])) update();
+    }
+    run();
+    for (size_t i = 0; i < num_burst; i++) {
+        memcpy(out + i * sizeof(bursts_[i].u8Data_), bursts_[i].u8Data_, sizeof(bursts_[i].u8Data_));
+    }
+}
+} /* namespace emulator */
+} /* namespace runtime */
+} /* namespace pim */
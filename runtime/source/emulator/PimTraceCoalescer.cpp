@@ -10,6 +10,9 @@
  */
 
 #include "emulator/PimTraceCoalescer.h"
+#include <algorithm>
+#include <atomic>
+#include <thread>
 
 namespace pim
 {
@@ -17,97 +20,217 @@ namespace runtime
 {
 namespace emulator
 {
-void TraceParser::append_data(uint8_t *dst, uint8_t *src, int size) { memcpy(dst, src, size); }
-void TraceParser::move_data(uint8_t *dst, uint8_t *src, int size) { memcpy(dst, src, size); }
-inline void coalesced_update(PimMemTraceData *fmtd32, int &coalesced_trace_it, PimMemTraceData *fmtd16, int &trace_it,
-                             char prev_cmd, uint64_t &prev_addr)
+/* traces smaller than this are coalesced on the calling thread */
+#define MIN_PARALLEL_TRACE_SIZE (16 * 1024)
+/* number of open 32B records tracked per range, must be a power of two */
+#define OPEN_LINE_TABLE_SIZE 1024
+
+struct OpenLine {
+    uint64_t line_addr;
+    int block_id;
+    int trace_it;
+    int covered;
+    uint32_t segment;
+};
+
+TraceParser::TraceParser(int num_threads) : num_threads_(num_threads)
 {
-    fmtd32[coalesced_trace_it].cmd = prev_cmd;
-    fmtd32[coalesced_trace_it].block_id = fmtd16[trace_it].block_id;
-    fmtd32[coalesced_trace_it].thread_id = fmtd16[trace_it].thread_id;
-    fmtd32[coalesced_trace_it].addr = fmtd16[trace_it].addr;
-    coalesced_trace_it++;
-    prev_addr = fmtd16[trace_it].addr & MASK;
+    if (num_threads_ <= 0) {
+        num_threads_ = std::max(1, (int)std::thread::hardware_concurrency());
+    }
 }
 
-void TraceParser::coalesce_trace(PimMemTraceData *fmtd32, int *fmtd32_size, PimMemTraceData *fmtd16, int fmtd16_size)
+void TraceParser::append_data(uint8_t *dst, uint8_t *src, int size) { memcpy(dst, src, size); }
+void TraceParser::move_data(uint8_t *dst, uint8_t *src, int size) { memcpy(dst, src, size); }
+
+int TraceParser::coalesce_range(PimMemTraceData *fmtd32, PimMemTraceData *fmtd16, int fmtd16_size,
+                                std::vector<bool> *chan_seen)
 {
-    uint64_t prev_addr = -1;
-    char prev_cmd = 'B';
+    /* 32B records still open for merging in the current barrier segment of their channel, hashed by */
+    /* channel and aligned address. Every access to an address overwrites its slot, so a record is never */
+    /* merged across an access with another command to the same address. Entries of older segments */
+    /* are invalidated by tag. */
+    std::vector<OpenLine> open_line(OPEN_LINE_TABLE_SIZE);
+    std::vector<uint32_t> segment;
     int coalesced_trace_it = 0;
+
     for (int trace_it = 0; trace_it < fmtd16_size; trace_it++) {
-        switch (fmtd16[trace_it].cmd) {
-            case 'B':
-                fmtd32[coalesced_trace_it].cmd = 'B';
-                fmtd32[coalesced_trace_it].block_id = fmtd16[trace_it].block_id;
-                fmtd32[coalesced_trace_it].thread_id = fmtd16[trace_it].thread_id;
-                fmtd32[coalesced_trace_it].addr = 0;
-                coalesced_trace_it++;
-                prev_addr = -1;
-                prev_cmd = 'B';
-                break;
-            case 'R':
-                if (prev_addr != -1 && prev_cmd == 'R') {
-                    if ((prev_addr) == (fmtd16[trace_it].addr & MASK)) {
-                        if (fmtd16[trace_it].addr < fmtd32[coalesced_trace_it - 1].addr) {
-                            fmtd32[coalesced_trace_it - 1].thread_id = fmtd16[trace_it].thread_id;
-                            fmtd32[coalesced_trace_it - 1].addr = fmtd16[trace_it].addr & MASK;
-                        }
-                        VLOG(3) << "Coalescing two read on address 0x" << std::hex << prev_addr << " and 0x"
-                                << fmtd16[trace_it].addr << "\n";
-                    } else
-                        coalesced_update(fmtd32, coalesced_trace_it, fmtd16, trace_it, 'R', prev_addr);
-                } else {
-                    coalesced_update(fmtd32, coalesced_trace_it, fmtd16, trace_it, 'R', prev_addr);
-                }
-                prev_cmd = 'R';
-                break;
-            case 'O':
-                if (prev_addr != -1 && prev_cmd == 'O') {
-                    if ((prev_addr) == (fmtd16[trace_it].addr & MASK)) {
-                        if (fmtd16[trace_it].addr < fmtd32[coalesced_trace_it - 1].addr) {
-                            fmtd32[coalesced_trace_it - 1].thread_id = fmtd16[trace_it].thread_id;
-                            fmtd32[coalesced_trace_it - 1].addr = fmtd16[trace_it].addr & MASK;
-                        }
-                        VLOG(3) << "Coalescing two read output on address 0x" << std::hex << prev_addr << " and 0x"
-                                << fmtd16[trace_it].addr << "\n";
-                    } else
-                        coalesced_update(fmtd32, coalesced_trace_it, fmtd16, trace_it, 'O', prev_addr);
-                } else {
-                    coalesced_update(fmtd32, coalesced_trace_it, fmtd16, trace_it, 'O', prev_addr);
-                }
-                prev_cmd = 'O';
-                break;
-            case 'W':
-                if (prev_addr != -1 && prev_cmd == 'W') {
-                    if ((prev_addr) == (fmtd16[trace_it].addr & MASK)) {
-                        // Writes came out of order. Move the data before appending
-                        if (fmtd16[trace_it].addr < fmtd32[coalesced_trace_it - 1].addr) {
-                            move_data(fmtd32[coalesced_trace_it - 1].data + 16, fmtd32[coalesced_trace_it - 1].data,
-                                      16);
-                            append_data(fmtd32[coalesced_trace_it - 1].data, fmtd16[trace_it].data, 16);
-                            fmtd32[coalesced_trace_it - 1].thread_id = fmtd16[trace_it].thread_id;
-                            fmtd32[coalesced_trace_it - 1].addr = fmtd16[trace_it].addr & MASK;
-                        } else {
-                            append_data(fmtd32[coalesced_trace_it - 1].data + 16, fmtd16[trace_it].data, 16);
-                        }
-                        VLOG(3) << "Coalescing two writes on address 0x" << std::hex << prev_addr << " and 0x"
-                                << fmtd16[trace_it].addr << "\n";
-                    } else {
-                        memcpy(fmtd32[coalesced_trace_it].data, fmtd16[trace_it].data, 16);
-                        coalesced_update(fmtd32, coalesced_trace_it, fmtd16, trace_it, 'W', prev_addr);
+        PimMemTraceData &trace = fmtd16[trace_it];
+        int ch = trace.block_id;
+        if (ch >= (int)segment.size()) {
+            segment.resize(ch + 1, 1);
+            chan_seen->resize(ch + 1, false);
+        }
+        (*chan_seen)[ch] = true;
+
+        if (trace.cmd == 'B') {
+            PimMemTraceData &barrier = fmtd32[coalesced_trace_it++];
+            barrier.cmd = 'B';
+            barrier.block_id = trace.block_id;
+            barrier.thread_id = trace.thread_id;
+            barrier.addr = 0;
+            segment[ch]++;
+            continue;
+        }
+        if (trace.cmd != 'R' && trace.cmd != 'O' && trace.cmd != 'W') continue;
+
+        uint64_t line_addr = trace.addr & MASK;
+        int half = (trace.addr & TRANS_SIZE) ? 2 : 1;
+        uint64_t hash = (line_addr >> 5) ^ (line_addr >> 15) ^ ((uint64_t)ch * 0x9e37);
+        OpenLine &slot = open_line[hash & (OPEN_LINE_TABLE_SIZE - 1)];
+
+        if (slot.segment == segment[ch] && slot.line_addr == line_addr && slot.block_id == ch) {
+            PimMemTraceData &coalesced = fmtd32[slot.trace_it];
+            /* a second write to the same half must not be folded into the first one */
+            if (coalesced.cmd == trace.cmd && (trace.cmd != 'W' || (slot.covered & half) == 0)) {
+                if (trace.addr < coalesced.addr) {
+                    // Halves came out of order. Move the data before appending
+                    if (trace.cmd == 'W') {
+                        move_data(coalesced.data + 16, coalesced.data, 16);
+                        append_data(coalesced.data, trace.data, 16);
                     }
-                } else {
-                    memcpy(fmtd32[coalesced_trace_it].data, fmtd16[trace_it].data, 16);
-                    coalesced_update(fmtd32, coalesced_trace_it, fmtd16, trace_it, 'W', prev_addr);
+                    coalesced.thread_id = trace.thread_id;
+                    coalesced.addr = line_addr;
+                } else if (trace.cmd == 'W') {
+                    append_data(coalesced.data + 16, trace.data, 16);
                 }
-                prev_cmd = 'W';
-                break;
+                slot.covered |= half;
+                VLOG(3) << "Coalescing " << trace.cmd << " on address 0x" << std::hex << line_addr << "\n";
+                continue;
+            }
         }
+
+        PimMemTraceData &coalesced = fmtd32[coalesced_trace_it];
+        if (trace.cmd == 'W') memcpy(coalesced.data, trace.data, 16);
+        coalesced.cmd = trace.cmd;
+        coalesced.block_id = trace.block_id;
+        coalesced.thread_id = trace.thread_id;
+        coalesced.addr = trace.addr;
+        slot.line_addr = line_addr;
+        slot.block_id = ch;
+        slot.trace_it = coalesced_trace_it;
+        slot.covered = half;
+        slot.segment = segment[ch];
+        coalesced_trace_it++;
+    }
+
+    return coalesced_trace_it;
+}
+
+void TraceParser::coalesce_trace(PimMemTraceData *fmtd32, int *fmtd32_size, PimMemTraceData *fmtd16, int fmtd16_size)
+{
+    std::vector<bool> chan_seen;
+    int num_threads = std::min(num_threads_, fmtd16_size / MIN_PARALLEL_TRACE_SIZE);
+    if (num_threads <= 1) {
+        fmtd32_size[0] = coalesce_range(fmtd32, fmtd16, fmtd16_size, &chan_seen);
+        return;
+    }
+
+    /* split the trace into ranges at channel boundaries; traces collected per channel are grouped, */
+    /* so the ranges are independent and each one is coalesced into its own output window */
+    std::vector<int> range_begin(1, 0);
+    for (int i = 1; i < num_threads; i++) {
+        int split = std::max((int)((int64_t)fmtd16_size * i / num_threads), range_begin.back() + 1);
+        while (split < fmtd16_size && fmtd16[split].block_id == fmtd16[split - 1].block_id) split++;
+        if (split >= fmtd16_size) break;
+        range_begin.push_back(split);
+    }
+    range_begin.push_back(fmtd16_size);
+    int num_range = range_begin.size() - 1;
+
+    std::vector<int> range_size(num_range, 0);
+    std::vector<std::vector<bool>> range_chan(num_range);
+    std::vector<std::thread> threads;
+    for (int r = 0; r < num_range; r++) {
+        threads.emplace_back([&, r]() {
+            range_size[r] = coalesce_range(fmtd32 + range_begin[r], fmtd16 + range_begin[r],
+                                           range_begin[r + 1] - range_begin[r], &range_chan[r]);
+        });
+    }
+    for (auto &t : threads) {
+        t.join();
+    }
+
+    /* a channel spread over several ranges would miss merges, so fall back to a single pass */
+    for (int r = 0; r < num_range; r++) {
+        for (int ch = 0; ch < (int)range_chan[r].size(); ch++) {
+            if (!range_chan[r][ch]) continue;
+            if (ch < (int)chan_seen.size() && chan_seen[ch]) {
+                fmtd32_size[0] = coalesce_range(fmtd32, fmtd16, fmtd16_size, &chan_seen);
+                return;
+            }
+            if (ch >= (int)chan_seen.size()) chan_seen.resize(ch + 1, false);
+            chan_seen[ch] = true;
+        }
+    }
+
+    /* pack the output windows back to back */
+    int coalesced_trace_it = 0;
+    for (int r = 0; r < num_range; r++) {
+        if (coalesced_trace_it != range_begin[r]) {
+            memmove(fmtd32 + coalesced_trace_it, fmtd32 + range_begin[r], range_size[r] * sizeof(PimMemTraceData));
+        }
+        coalesced_trace_it += range_size[r];
     }
     fmtd32_size[0] = coalesced_trace_it;
 }
 
+void TraceChunkQueue::reset(PimMemTraceData *base)
+{
+    std::lock_guard<std::mutex> guard(lock_);
+    chunks_.clear();
+    base_ = base;
+    total_size_ = 0;
+    head_ = 0;
+    closed_ = false;
+}
+
+void TraceChunkQueue::push(int size)
+{
+    {
+        std::lock_guard<std::mutex> guard(lock_);
+        chunks_.push_back(std::make_pair(total_size_, size));
+        total_size_ += size;
+    }
+    cond_.notify_one();
+}
+
+void TraceChunkQueue::close(void)
+{
+    {
+        std::lock_guard<std::mutex> guard(lock_);
+        closed_ = true;
+    }
+    cond_.notify_all();
+}
+
+bool TraceChunkQueue::pop(PimMemTraceData **chunk, int *size)
+{
+    std::unique_lock<std::mutex> guard(lock_);
+    cond_.wait(guard, [this] { return head_ < chunks_.size() || closed_; });
+    if (head_ == chunks_.size()) return false;
+
+    *chunk = base_ + chunks_[head_].first;
+    *size = chunks_[head_].second;
+    head_++;
+    return true;
+}
+
+PimMemTraceData *TraceChunkQueue::wait_all(int *size)
+{
+    std::unique_lock<std::mutex> guard(lock_);
+    cond_.wait(guard, [this] { return closed_; });
+    head_ = chunks_.size();
+    *size = total_size_;
+    return base_;
+}
+
+int TraceChunkQueue::get_total_size(void)
+{
+    std::lock_guard<std::mutex> guard(lock_);
+    return total_size_;
+}
+
 } /* namespace emulator */
 } /* namespace runtime */
 } /* namespace pim */
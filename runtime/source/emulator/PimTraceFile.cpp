@@ -0,0 +1,337 @@
+/*
+ * Copyright (C) 2022 Samsung Electronics Co. LTD
+ *
+ * This software is a property of Samsung Electronics.
+ * No part of this software, either material or conceptual may be copied or distributed, transmitted,
+ * transcribed, stored in a retrieval system or translated into any human or computer language in any form by any means,
+ * electronic, mechanical, manual or otherwise, or disclosed
+ * to third parties without the express written permission of Samsung Electronics.
+ * (Use of the Software is restricted to non-commercial, personal or academic, research purpose only)
+ */
+
+#include "emulator/PimTraceFile.h"
+#include <string.h>
+#include <algorithm>
+#include "utility/pim_log.h"
+
+namespace pim
+{
+namespace runtime
+{
+namespace emulator
+{
+#define TRACE_FILE_MAGIC "PIMTRACE"
+#define TRACE_FILE_VERSION (1)
+#define TRACE_BUF_SIZE (1 << 20)
+#define TRACE_PAYLOAD_SIZE (32)
+
+/* head byte of a record */
+#define REC_CMD_MASK (0x3)
+#define REC_SAME_BLOCK (0x4)
+#define REC_SAME_THREAD (0x8)
+
+namespace
+{
+const char rec_cmds[] = {'R', 'W', 'O', 'B'};
+
+int get_cmd_code(char cmd)
+{
+    for (int i = 0; i < 4; i++) {
+        if (rec_cmds[i] == cmd) return i;
+    }
+    return -1;
+}
+
+uint64_t zigzag(int64_t value) { return ((uint64_t)value << 1) ^ (uint64_t)(value >> 63); }
+int64_t unzigzag(uint64_t value) { return (int64_t)(value >> 1) ^ -(int64_t)(value & 1); }
+} /* namespace */
+
+PimTraceWriter::PimTraceWriter(void) : fp_(nullptr), last_block_(-1), last_thread_(-1), file_size_(0) {}
+PimTraceWriter::~PimTraceWriter(void) { close(); }
+int PimTraceWriter::open(const std::string& file_path)
+{
+    close();
+    fp_ = fopen(file_path.c_str(), "wb");
+    if (fp_ == nullptr) {
+        DLOG(ERROR) << "fail to open " << file_path;
+        return -1;
+    }
+
+    uint32_t version = TRACE_FILE_VERSION;
+    file_size_ = 0;
+    buf_.clear();
+    buf_.reserve(TRACE_BUF_SIZE + TRACE_PAYLOAD_SIZE * 2);
+    put_bytes(TRACE_FILE_MAGIC, 8);
+    put_bytes(&version, sizeof(version));
+    return 0;
+}
+
+int PimTraceWriter::close(void)
+{
+    if (fp_ == nullptr) return 0;
+
+    int ret = flush();
+    if (fclose(fp_) != 0) ret = -1;
+    fp_ = nullptr;
+    return ret;
+}
+
+void PimTraceWriter::put_varint(uint64_t value)
+{
+    while (value >= 0x80) {
+        buf_.push_back((uint8_t)(value | 0x80));
+        value >>= 7;
+    }
+    buf_.push_back((uint8_t)value);
+}
+
+void PimTraceWriter::put_bytes(const void* data, size_t size)
+{
+    const uint8_t* bytes = (const uint8_t*)data;
+    buf_.insert(buf_.end(), bytes, bytes + size);
+}
+
+int PimTraceWriter::flush(void)
+{
+    if (buf_.empty()) return 0;
+
+    size_t size = fwrite(buf_.data(), 1, buf_.size(), fp_);
+    file_size_ += size;
+    bool ok = (size == buf_.size());
+    buf_.clear();
+    return ok ? 0 : -1;
+}
+
+int PimTraceWriter::write_preload(uint64_t addr, const void* data, size_t data_size)
+{
+    if (fp_ == nullptr) return -1;
+
+    buf_.push_back(TRACE_EVENT_PRELOAD);
+    put_varint(addr);
+    put_varint(data_size);
+    /* large images go straight to the file */
+    if (flush() != 0) return -1;
+    if (fwrite(data, 1, data_size, fp_) != data_size) return -1;
+    file_size_ += data_size;
+    return 0;
+}
+
+int PimTraceWriter::write_kernel(const PimMemTraceData* trace, size_t num_trace)
+{
+    if (fp_ == nullptr) return -1;
+    for (size_t i = 0; i < num_trace; i++) {
+        if (get_cmd_code(trace[i].cmd) < 0) {
+            DLOG(ERROR) << "unknown trace command " << (int)trace[i].cmd << " at " << i;
+            return -1;
+        }
+    }
+
+    buf_.push_back(TRACE_EVENT_KERNEL);
+    put_varint(num_trace);
+    last_addr_.clear();
+    last_block_ = -1;
+    last_thread_ = -1;
+
+    for (size_t i = 0; i < num_trace; i++) {
+        const PimMemTraceData& rec = trace[i];
+        uint8_t head = get_cmd_code(rec.cmd);
+        if (rec.block_id == last_block_) head |= REC_SAME_BLOCK;
+        if (rec.thread_id == last_thread_) head |= REC_SAME_THREAD;
+        buf_.push_back(head);
+        if (rec.block_id != last_block_) put_varint((uint32_t)rec.block_id);
+        if (rec.thread_id != last_thread_) put_varint((uint32_t)rec.thread_id);
+        last_block_ = rec.block_id;
+        last_thread_ = rec.thread_id;
+
+        if (rec.cmd != 'B') {
+            uint64_t& last_addr = last_addr_[rec.block_id];
+            put_varint(zigzag((int64_t)(rec.addr - last_addr)));
+            last_addr = rec.addr;
+        }
+        if (rec.cmd == 'W') put_bytes(rec.data, TRACE_PAYLOAD_SIZE);
+        if (buf_.size() >= TRACE_BUF_SIZE && flush() != 0) return -1;
+    }
+    /* a kernel is complete on disk even if the process never closes the file */
+    return flush();
+}
+
+PimTraceReader::PimTraceReader(void)
+    : fp_(nullptr), buf_pos_(0), buf_end_(0), remain_(0), last_block_(-1), last_thread_(-1)
+{
+    memset(&event_, 0, sizeof(event_));
+}
+
+PimTraceReader::~PimTraceReader(void) { close(); }
+int PimTraceReader::open(const std::string& file_path)
+{
+    close();
+    fp_ = fopen(file_path.c_str(), "rb");
+    if (fp_ == nullptr) {
+        DLOG(ERROR) << "fail to open " << file_path;
+        return -1;
+    }
+
+    char magic[8];
+    uint32_t version = 0;
+    buf_.resize(TRACE_BUF_SIZE);
+    buf_pos_ = buf_end_ = 0;
+    remain_ = 0;
+    memset(&event_, 0, sizeof(event_));
+    if (!get_bytes(magic, sizeof(magic)) || memcmp(magic, TRACE_FILE_MAGIC, sizeof(magic)) != 0 ||
+        !get_bytes(&version, sizeof(version)) || version != TRACE_FILE_VERSION) {
+        DLOG(ERROR) << file_path << " is not a PIM trace file of version " << TRACE_FILE_VERSION;
+        close();
+        return -1;
+    }
+    return 0;
+}
+
+int PimTraceReader::close(void)
+{
+    if (fp_ == nullptr) return 0;
+
+    int ret = fclose(fp_);
+    fp_ = nullptr;
+    return (ret == 0) ? 0 : -1;
+}
+
+bool PimTraceReader::get_byte(uint8_t* value)
+{
+    if (buf_pos_ == buf_end_) {
+        buf_pos_ = 0;
+        buf_end_ = fread(buf_.data(), 1, buf_.size(), fp_);
+        if (buf_end_ == 0) return false;
+    }
+    *value = buf_[buf_pos_++];
+    return true;
+}
+
+bool PimTraceReader::get_varint(uint64_t* value)
+{
+    uint8_t byte;
+    *value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (!get_byte(&byte)) return false;
+        *value |= (uint64_t)(byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0) return true;
+    }
+    return false;
+}
+
+bool PimTraceReader::get_bytes(void* data, size_t size)
+{
+    uint8_t* bytes = (uint8_t*)data;
+    while (size > 0) {
+        if (buf_pos_ == buf_end_) {
+            uint8_t byte;
+            if (!get_byte(&byte)) return false;
+            *bytes++ = byte;
+            size--;
+            continue;
+        }
+        size_t chunk = std::min(size, buf_end_ - buf_pos_);
+        memcpy(bytes, &buf_[buf_pos_], chunk);
+        buf_pos_ += chunk;
+        bytes += chunk;
+        size -= chunk;
+    }
+    return true;
+}
+
+int PimTraceReader::skip_event(void)
+{
+    if (event_.type == TRACE_EVENT_PRELOAD) {
+        std::vector<uint8_t> data(std::min(remain_, (uint64_t)TRACE_BUF_SIZE));
+        while (remain_ > 0) {
+            size_t size = std::min(remain_, (uint64_t)data.size());
+            if (!get_bytes(data.data(), size)) return -1;
+            remain_ -= size;
+        }
+    } else if (event_.type == TRACE_EVENT_KERNEL) {
+        std::vector<PimMemTraceData> trace(1024);
+        while (remain_ > 0) {
+            if (read_trace(trace.data(), trace.size()) < 0) return -1;
+        }
+    }
+    return 0;
+}
+
+int PimTraceReader::next_event(PimTraceEvent* event)
+{
+    if (fp_ == nullptr) return -1;
+    if (remain_ > 0 && skip_event() != 0) return -1;
+
+    uint8_t type;
+    memset(&event_, 0, sizeof(event_));
+    if (!get_byte(&type)) return 0;
+
+    if (type == TRACE_EVENT_PRELOAD) {
+        event_.type = TRACE_EVENT_PRELOAD;
+        if (!get_varint(&event_.addr) || !get_varint(&event_.size)) return -1;
+        remain_ = event_.size;
+    } else if (type == TRACE_EVENT_KERNEL) {
+        event_.type = TRACE_EVENT_KERNEL;
+        if (!get_varint(&event_.num_trace)) return -1;
+        remain_ = event_.num_trace;
+        last_addr_.clear();
+        last_block_ = -1;
+        last_thread_ = -1;
+    } else {
+        DLOG(ERROR) << "unknown trace event " << (int)type;
+        return -1;
+    }
+
+    *event = event_;
+    return 1;
+}
+
+int PimTraceReader::read_preload(void* data)
+{
+    if (event_.type != TRACE_EVENT_PRELOAD || remain_ != event_.size) return -1;
+    if (!get_bytes(data, event_.size)) return -1;
+    remain_ = 0;
+    return 0;
+}
+
+int64_t PimTraceReader::read_trace(PimMemTraceData* trace, size_t max_trace)
+{
+    if (event_.type != TRACE_EVENT_KERNEL) return -1;
+
+    size_t num_trace = std::min((uint64_t)max_trace, remain_);
+    for (size_t i = 0; i < num_trace; i++) {
+        PimMemTraceData& rec = trace[i];
+        uint8_t head;
+        uint64_t value;
+
+        if (!get_byte(&head)) return -1;
+        rec.cmd = rec_cmds[head & REC_CMD_MASK];
+        if (!(head & REC_SAME_BLOCK)) {
+            if (!get_varint(&value)) return -1;
+            last_block_ = (int)value;
+        }
+        if (!(head & REC_SAME_THREAD)) {
+            if (!get_varint(&value)) return -1;
+            last_thread_ = (int)value;
+        }
+        rec.block_id = last_block_;
+        rec.thread_id = last_thread_;
+
+        rec.addr = 0;
+        if (rec.cmd != 'B') {
+            uint64_t& last_addr = last_addr_[rec.block_id];
+            if (!get_varint(&value)) return -1;
+            last_addr += (uint64_t)unzigzag(value);
+            rec.addr = last_addr;
+        }
+        if (rec.cmd == 'W') {
+            if (!get_bytes(rec.data, TRACE_PAYLOAD_SIZE)) return -1;
+        } else {
+            memset(rec.data, 0, TRACE_PAYLOAD_SIZE);
+        }
+    }
+    remain_ -= num_trace;
+    return (int64_t)num_trace;
+}
+} /* namespace emulator */
+} /* namespace runtime */
+} /* namespace pim */
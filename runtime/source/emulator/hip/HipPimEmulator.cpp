@@ -28,10 +28,12 @@ namespace runtime
 {
 namespace emulator
 {
-HipPimEmulator::HipPimEmulator(void)
+HipPimEmulator::HipPimEmulator(void) : trace_queue_(nullptr), sim_chunks_(false), kernel_cycle_(0)
 {
     DLOG(INFO) << "[START] " << __FUNCTION__ << " called ";
     get_pim_block_info(&fbi_);
+    const char* env_s = std::getenv("PIM_EMULATOR_SIM_CHUNKS");
+    if (env_s != nullptr && env_s[0] == '1') sim_chunks_ = true;
     this->initialize();
 }
 
@@ -62,17 +64,55 @@ int HipPimEmulator::convert_mem_trace_from_16B_to_32B(PimMemTraceData* fmtd32, i
     int ret = 0;
     TraceParser trace_converter;
     trace_converter.coalesce_trace(fmtd32, fmtd32_size, fmtd16, fmtd16_size);
+    dump_mem_trace(fmtd32, fmtd32_size[0], fmtd16, fmtd16_size, op_type);
+
+    return ret;
+}
+
+void HipPimEmulator::dump_mem_trace(PimMemTraceData* fmtd32, int fmtd32_size, PimMemTraceData* fmtd16,
+                                    int fmtd16_size, PimOpType op_type)
+{
 #ifdef DEBUG_PIM
     const char* op_str = get_pim_op_string(op_type);
     std::string dump_data = TEST_VECTORS_DATA;
     dump_data.append("dump/");
     dump_data.append(op_str);
     std::string dump_fmtd16 = dump_data + "/fmtd16.dat";
-    std::string dump_fmtd32 = dump_data + "/fmtd32.dat";
+    std::string dump_fmtd32 = dump_data + "/fmtd32.pimtrace";
     dump_fmtd<16>(dump_fmtd16.c_str(), fmtd16, fmtd16_size);
-    dump_fmtd<32>(dump_fmtd32.c_str(), fmtd32, fmtd32_size[0]);
+    /* the coalesced trace is the large one, it is written in the binary format pimtrace replays */
+    PimTraceWriter trace_writer;
+    if (trace_writer.open(dump_fmtd32) == 0) trace_writer.write_kernel(fmtd32, fmtd32_size);
 #endif
+}
 
+int HipPimEmulator::execute_trace(PimMemTraceData* fmtd32, int fmtd32_size)
+{
+    int ret = 0;
+    if (trace_queue_ == nullptr) {
+        ret = pim_sim_.execute_kernel((void*)fmtd32, (size_t)fmtd32_size);
+        kernel_cycle_ = pim_sim_.get_kernel_cycle();
+        return ret;
+    }
+
+    PimMemTraceData* chunk = nullptr;
+    int chunk_size = 0;
+    if (!sim_chunks_) {
+        /* only the copy and coalescing are pipelined, one kernel keeps the channels concurrent in simulated time */
+        chunk = trace_queue_->wait_all(&chunk_size);
+        ret = pim_sim_.execute_kernel((void*)chunk, (size_t)chunk_size);
+        kernel_cycle_ = pim_sim_.get_kernel_cycle();
+        return ret;
+    }
+
+    /* each chunk is simulated as soon as it has been coalesced, which serializes the chunks in simulated time */
+    kernel_cycle_ = 0;
+    while (trace_queue_->pop(&chunk, &chunk_size)) {
+        if (chunk_size == 0) continue;
+        /* the queue is drained to the end even after a failure, so that the collector can finish */
+        if (ret == 0) ret = pim_sim_.execute_kernel((void*)chunk, (size_t)chunk_size);
+        kernel_cycle_ += pim_sim_.get_kernel_cycle();
+    }
     return ret;
 }
 
@@ -101,9 +141,15 @@ int HipPimEmulator::execute_gemm_bias_act(PimBo* output, PimBo* pim_data, PimMem
     pim_data_addr = reinterpret_cast<uint64_t>(pim_data->data);
     input_data = pim_data->data;
 
-    pim_sim_.preload_data_with_addr(pim_data_addr - pim_base_addr, input_data, pim_data->size);
-    pim_sim_.execute_kernel((void*)fmtd32, fmtd32_size);
-    pim_sim_.read_result_gemv(sim_output, tmp_data_addr - pim_base_addr, out_dim);
+    ret = pim_sim_.preload_data_with_addr(pim_data_addr - pim_base_addr, input_data, pim_data->size);
+    if (ret == 0) ret = execute_trace(fmtd32, fmtd32_size);
+    if (ret == 0) ret = pim_sim_.read_result_gemv(sim_output, tmp_data_addr - pim_base_addr, out_dim);
+    if (ret != 0) {
+        DLOG(ERROR) << "fail to simulate the kernel";
+        delete[] sim_output;
+        delete[] h_bias;
+        return ret;
+    }
 
     if (is_bias) {
         hipMemcpy(h_bias, bias->data, bias->size, hipMemcpyDeviceToHost);
@@ -155,9 +201,15 @@ int HipPimEmulator::execute_gemv_add_tile_accum(PimBo* output, PimBo* pim_data,
     int out_size_r = out_num_r * num_batch * sizeof(uint16_t);
     void* output_host = malloc(out_size_r);
 
-    pim_sim_.preload_data_with_addr(pim_data_addr - pim_base_addr, pim_data->data, pim_data->size);
-    pim_sim_.execute_kernel((void*)fmtd32, fmtd32_size);
-    pim_sim_.read_result_gemv(sim_output, tmp_data_addr - pim_base_addr, out_dim);
+    ret = pim_sim_.preload_data_with_addr(pim_data_addr - pim_base_addr, pim_data->data, pim_data->size);
+    if (ret == 0) ret = execute_trace(fmtd32, fmtd32_size);
+    if (ret == 0) ret = pim_sim_.read_result_gemv(sim_output, tmp_data_addr - pim_base_addr, out_dim);
+    if (ret != 0) {
+        DLOG(ERROR) << "fail to simulate the kernel";
+        free(output_host);
+        delete[] sim_output;
+        return ret;
+    }
 
     hipMemcpy(output_host, output->data, out_size_r, hipMemcpyDeviceToHost);
     for (int b = 0; b < num_batch; b++) {
@@ -190,10 +242,45 @@ int HipPimEmulator::execute_elt_op(PimBo* output, PimBo* operand0, PimBo* operan
     input_addr[1] = reinterpret_cast<uint64_t>(operand1->data);
     output_addr = reinterpret_cast<uint64_t>(output->data);
 
-    pim_sim_.preload_data_with_addr(input_addr[0] - pim_base_addr, operand0->data, operand0->size);
-    pim_sim_.preload_data_with_addr(input_addr[1] - pim_base_addr, operand1->data, operand1->size);
-    pim_sim_.execute_kernel((void*)fmtd32, (size_t)fmtd32_size);
-    pim_sim_.read_result(sim_output, output_addr - pim_base_addr, output->size);
+    ret = pim_sim_.preload_data_with_addr(input_addr[0] - pim_base_addr, operand0->data, operand0->size);
+    if (ret == 0) ret = pim_sim_.preload_data_with_addr(input_addr[1] - pim_base_addr, operand1->data, operand1->size);
+    if (ret == 0) ret = execute_trace(fmtd32, fmtd32_size);
+    if (ret == 0) ret = pim_sim_.read_result(sim_output, output_addr - pim_base_addr, output->size);
+    if (ret != 0) {
+        DLOG(ERROR) << "fail to simulate the kernel";
+        delete[] sim_output;
+        return ret;
+    }
+
+    hipMemcpy((half*)output->data, (half*)sim_output, output->size, hipMemcpyHostToDevice);
+
+    delete[] sim_output;
+
+    return ret;
+}
+
+int HipPimEmulator::execute_elt_chain_op(PimBo* output, PimBo** operands, int num_operands,
+                                         PimMemTraceData* fmtd32, int fmtd32_size, uint64_t pim_base_addr)
+{
+    DLOG(INFO) << "called";
+    int ret = 0;
+    int num_element = output->size / sizeof(uint16_t);
+    uint16_t* sim_output = new uint16_t[num_element];
+    uint64_t output_addr = reinterpret_cast<uint64_t>(output->data);
+
+    /* the chain input and every vector operand are read by the fused program */
+    for (int i = 0; i < num_operands; i++) {
+        uint64_t input_addr = reinterpret_cast<uint64_t>(operands[i]->data);
+        if (ret == 0) ret = pim_sim_.preload_data_with_addr(input_addr - pim_base_addr, operands[i]->data,
+                                                            operands[i]->size);
+    }
+    if (ret == 0) ret = execute_trace(fmtd32, fmtd32_size);
+    if (ret == 0) ret = pim_sim_.read_result(sim_output, output_addr - pim_base_addr, output->size);
+    if (ret != 0) {
+        DLOG(ERROR) << "fail to simulate the kernel";
+        delete[] sim_output;
+        return ret;
+    }
 
     hipMemcpy((half*)output->data, (half*)sim_output, output->size, hipMemcpyHostToDevice);
 
@@ -216,9 +303,14 @@ int HipPimEmulator::execute_relu_bn_copy(PimBo* output, PimBo* pim_data, PimMemT
     input_addr = reinterpret_cast<uint64_t>(pim_data->data);
     output_addr = reinterpret_cast<uint64_t>(output->data);
 
-    pim_sim_.preload_data_with_addr(input_addr - pim_base_addr, pim_data->data, pim_data->size);
-    pim_sim_.execute_kernel((void*)fmtd32, (size_t)fmtd32_size);
-    pim_sim_.read_result(sim_output, output_addr - pim_base_addr, output->size);
+    ret = pim_sim_.preload_data_with_addr(input_addr - pim_base_addr, pim_data->data, pim_data->size);
+    if (ret == 0) ret = execute_trace(fmtd32, fmtd32_size);
+    if (ret == 0) ret = pim_sim_.read_result(sim_output, output_addr - pim_base_addr, output->size);
+    if (ret != 0) {
+        DLOG(ERROR) << "fail to simulate the kernel";
+        delete[] sim_output;
+        return ret;
+    }
 
     hipMemcpy((half*)output->data, (half*)sim_output, output->size, hipMemcpyHostToDevice);
 
@@ -233,6 +325,13 @@ int HipPimEmulator::execute_bn(PimBo* output, PimBo* pim_data, PimMemTraceData*
     return execute_relu_bn_copy(output, pim_data, fmtd32, fmtd32_size, pim_base_addr);
 }
 
+int HipPimEmulator::execute_elt_scalar_op(PimBo* output, PimBo* operand, PimMemTraceData* fmtd32, int fmtd32_size,
+                                          uint64_t pim_base_addr)
+{
+    /* the scalar reaches the simulator through the SRF write in the trace */
+    return execute_relu_bn_copy(output, operand, fmtd32, fmtd32_size, pim_base_addr);
+}
+
 int HipPimEmulator::execute_relu(PimBo* output, PimBo* pim_data, PimMemTraceData* fmtd32, int fmtd32_size,
                                  uint64_t pim_base_addr)
 {
@@ -30,7 +30,7 @@ extern cl_command_queue queue;
 
 namespace emulator
 {
-OclPimEmulator::OclPimEmulator(void)
+OclPimEmulator::OclPimEmulator(void) : op_type_(OP_DUMMY), kernel_cycle_(0)
 {
     DLOG(INFO) << "[START] " << __FUNCTION__ << " called ";
     get_pim_block_info(&fbi_);
@@ -64,20 +64,31 @@ int OclPimEmulator::convert_mem_trace_from_16B_to_32B(PimMemTraceData* fmtd32, i
     int ret = 0;
     TraceParser trace_converter;
     trace_converter.coalesce_trace(fmtd32, fmtd32_size, fmtd16, fmtd16_size);
+    op_type_ = op_type;
 #ifdef DEBUG_PIM
     const char* op_str = get_pim_op_string(op_type);
     std::string dump_data = TEST_VECTORS_DATA;
     dump_data.append("dump/");
     dump_data.append(op_str);
     std::string dump_fmtd16 = dump_data + "/fmtd16.dat";
-    std::string dump_fmtd32 = dump_data + "/fmtd32.dat";
+    std::string dump_fmtd32 = dump_data + "/fmtd32.pimtrace";
     dump_fmtd<16>(dump_fmtd16.c_str(), fmtd16, fmtd16_size);
-    dump_fmtd<32>(dump_fmtd32.c_str(), fmtd32, fmtd32_size[0]);
+    /* the coalesced trace is the large one, it is written in the binary format pimtrace replays */
+    PimTraceWriter trace_writer;
+    if (trace_writer.open(dump_fmtd32) == 0) trace_writer.write_kernel(fmtd32, fmtd32_size[0]);
 #endif
 
     return ret;
 }
 
+int OclPimEmulator::execute_trace(PimMemTraceData* fmtd32, int fmtd32_size)
+{
+    int ret = pim_sim_.execute_kernel((void*)fmtd32, (size_t)fmtd32_size);
+    kernel_cycle_ = pim_sim_.get_kernel_cycle();
+    if (kernel_cycle_ > 0) LOG(INFO) << get_pim_op_string(op_type_) << " : " << kernel_cycle_ << " emulator cycles";
+    return ret;
+}
+
 int OclPimEmulator::execute_gemm_bias_act(PimBo* output, PimBo* pim_data, PimMemTraceData* fmtd32, int fmtd32_size,
                                           PimOpType op_type, uint64_t pim_base_addr, uint8_t* temp_buf, PimBo* bias,
                                           PimActFunc act_func)
@@ -102,9 +113,15 @@ int OclPimEmulator::execute_gemm_bias_act(PimBo* output, PimBo* pim_data, PimMem
     pim_data_addr = ((manager::OclBufferObj*)pim_data->data)->host_addr;
     input_data = (void*)(((manager::OclBufferObj*)pim_data->data)->host_addr);
 
-    pim_sim_.preload_data_with_addr(pim_data_addr - pim_base_addr, input_data, pim_data->size);
-    pim_sim_.execute_kernel((void*)fmtd32, fmtd32_size);
-    pim_sim_.read_result_gemv(sim_output, tmp_data_addr - pim_base_addr, out_dim);
+    ret = pim_sim_.preload_data_with_addr(pim_data_addr - pim_base_addr, input_data, pim_data->size);
+    if (ret == 0) ret = execute_trace(fmtd32, fmtd32_size);
+    if (ret == 0) ret = pim_sim_.read_result_gemv(sim_output, tmp_data_addr - pim_base_addr, out_dim);
+    if (ret != 0) {
+        DLOG(ERROR) << "fail to simulate the kernel";
+        delete[] sim_output;
+        delete[] h_bias;
+        return ret;
+    }
 
     if (is_bias) {
         clEnqueueReadBuffer(queue, (cl_mem)bias->data, CL_TRUE, 0, bias->size, (void*)h_bias, 0, NULL, NULL);
@@ -161,9 +178,15 @@ int OclPimEmulator::execute_gemv_add_tile_accum(PimBo* output, PimBo* pim_data,
     int out_size_r = out_num_r * num_batch * sizeof(uint16_t);
     void* output_host = malloc(out_size_r);
 
-    pim_sim_.preload_data_with_addr(pim_data_addr - pim_base_addr, pim_data->data, pim_data->size);
-    pim_sim_.execute_kernel((void*)fmtd32, fmtd32_size);
-    pim_sim_.read_result_gemv(sim_output, tmp_data_addr - pim_base_addr, out_dim);
+    ret = pim_sim_.preload_data_with_addr(pim_data_addr - pim_base_addr, pim_data->data, pim_data->size);
+    if (ret == 0) ret = execute_trace(fmtd32, fmtd32_size);
+    if (ret == 0) ret = pim_sim_.read_result_gemv(sim_output, tmp_data_addr - pim_base_addr, out_dim);
+    if (ret != 0) {
+        DLOG(ERROR) << "fail to simulate the kernel";
+        free(output_host);
+        delete[] sim_output;
+        return ret;
+    }
 
     clEnqueueReadBuffer(queue, (cl_mem)output->data, CL_TRUE, 0, out_size_r, (void*)output_host, 0, NULL, NULL);
     for (int b = 0; b < num_batch; b++) {
@@ -212,10 +235,15 @@ int OclPimEmulator::execute_elt_op(PimBo* output, PimBo* operand0, PimBo* operan
     input_data[0] = (void*)(((manager::OclBufferObj*)operand0->data)->host_addr);
     input_data[1] = (void*)(((manager::OclBufferObj*)operand1->data)->host_addr);
 
-    pim_sim_.preload_data_with_addr(input_addr[0] - pim_base_addr, input_data[0], operand0->size);
-    pim_sim_.preload_data_with_addr(input_addr[1] - pim_base_addr, input_data[1], operand1->size);
-    pim_sim_.execute_kernel((void*)fmtd32, (size_t)fmtd32_size);
-    pim_sim_.read_result(sim_output, output_addr - pim_base_addr, output->size);
+    ret = pim_sim_.preload_data_with_addr(input_addr[0] - pim_base_addr, input_data[0], operand0->size);
+    if (ret == 0) ret = pim_sim_.preload_data_with_addr(input_addr[1] - pim_base_addr, input_data[1], operand1->size);
+    if (ret == 0) ret = execute_trace(fmtd32, fmtd32_size);
+    if (ret == 0) ret = pim_sim_.read_result(sim_output, output_addr - pim_base_addr, output->size);
+    if (ret != 0) {
+        DLOG(ERROR) << "fail to simulate the kernel";
+        delete[] sim_output;
+        return ret;
+    }
 
     memcpy((void*)output_addr, sim_output, output->size);
 
@@ -250,9 +278,14 @@ int OclPimEmulator::execute_relu_bn_copy(PimBo* output, PimBo* pim_data, PimMemT
 
     input_data = (void*)(((manager::OclBufferObj*)pim_data->data)->host_addr);
 
-    pim_sim_.preload_data_with_addr(input_addr - pim_base_addr, input_data, pim_data->size);
-    pim_sim_.execute_kernel((void*)fmtd32, (size_t)fmtd32_size);
-    pim_sim_.read_result(sim_output, output_addr - pim_base_addr, output->size);
+    ret = pim_sim_.preload_data_with_addr(input_addr - pim_base_addr, input_data, pim_data->size);
+    if (ret == 0) ret = execute_trace(fmtd32, fmtd32_size);
+    if (ret == 0) ret = pim_sim_.read_result(sim_output, output_addr - pim_base_addr, output->size);
+    if (ret != 0) {
+        DLOG(ERROR) << "fail to simulate the kernel";
+        delete[] sim_output;
+        return ret;
+    }
 
     memcpy((void*)output_addr, sim_output, output->size);
 
@@ -267,6 +300,13 @@ int OclPimEmulator::execute_bn(PimBo* output, PimBo* pim_data, PimMemTraceData*
     return execute_relu_bn_copy(output, pim_data, fmtd32, fmtd32_size, pim_base_addr);
 }
 
+int OclPimEmulator::execute_elt_scalar_op(PimBo* output, PimBo* operand, PimMemTraceData* fmtd32, int fmtd32_size,
+                                          uint64_t pim_base_addr)
+{
+    /* the scalar reaches the simulator through the SRF write in the trace */
+    return execute_relu_bn_copy(output, operand, fmtd32, fmtd32_size, pim_base_addr);
+}
+
 int OclPimEmulator::execute_relu(PimBo* output, PimBo* pim_data, PimMemTraceData* fmtd32, int fmtd32_size,
                                  uint64_t pim_base_addr)
 {
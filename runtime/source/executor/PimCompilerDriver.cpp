@@ -1,10 +1,18 @@
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
 #include <fstream>
 #include <iostream>
+#include <sstream>
 #include <string>
 #include <vector>
 
 #include "executor/PimCompilerDriver.h"
 #include "utility/pim_debug.hpp"
+#include "utility/pim_hash.h"
 #include "utility/pim_log.h"
 #include "utility/pim_profile.h"
 #include "utility/pim_util.h"
@@ -15,22 +23,99 @@ namespace runtime
 {
 namespace pimc_driver
 {
+/* size of the device CRF buffer of a compiled program */
+#define CRF_BUFFER_SIZE 128
+
+HIPCompiler::HIPCompiler() : kernel_(nullptr)
+{
 #if PIM_COMPILER_ENABLE == 1
-void HIPCompiler::execute(std::string hip_kernel, std::string crf_binary)
+    arch_ = "gfx906";
+    int device_id = 0;
+    hipDeviceProp_t prop;
+    if (hipGetDevice(&device_id) == hipSuccess && hipGetDeviceProperties(&prop, device_id) == hipSuccess) {
+        /* gcnArchName is the full target such as gfx90a:sramecc+:xnack-, the feature flags are not a target name */
+        std::string arch_name(prop.gcnArchName);
+        arch_name = arch_name.substr(0, arch_name.find(':'));
+        if (arch_name.compare(0, 3, "gfx") == 0) arch_ = arch_name;
+    }
+
+    if (const char* env_dir = std::getenv("PIM_KERNEL_CACHE_DIR")) {
+        cache_dir_ = env_dir;
+    } else if (const char* env_xdg = std::getenv("XDG_CACHE_HOME")) {
+        cache_dir_ = std::string(env_xdg) + "/pim/kernels";
+    } else if (const char* env_home = std::getenv("HOME")) {
+        cache_dir_ = std::string(env_home) + "/.cache/pim/kernels";
+    }
+#endif
+}
+
+HIPCompiler::~HIPCompiler() { clear_cache(); }
+
+void HIPCompiler::clear_cache(void)
 {
-    if (const char* env_p = std::getenv("SAVE_GENERATED_KERNEL")) {
-        int value = *((int*)env_p);
-        if (value == 1) {
-            std::ofstream hip_file("output_hip_kernel.txt");
-            hip_file << hip_kernel;
-            hip_file.close();
+#if PIM_COMPILER_ENABLE == 1
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& entry : module_cache_) {
+        hipModuleUnload(entry.second.module);
+    }
+    module_cache_.clear();
+    kernel_ = nullptr;
+#endif
+}
 
-            std::ofstream crf_file("output_crf_binary.txt");
-            crf_file << crf_binary;
-            crf_file.close();
-        }
+PimCDriver::~PimCDriver() { clear_cache(); }
+
+void PimCDriver::clear_cache(void)
+{
+#if PIM_COMPILER_ENABLE == 1
+    std::lock_guard<std::mutex> lock(crf_mutex_);
+    /* CRF buffers are only allocated for HIP targets */
+    for (auto& entry : crf_buffers_) {
+        hipFree(entry.second);
+    }
+    crf_buffers_.clear();
+#endif
+    compile_.clear_cache();
+}
+
+#if PIM_COMPILER_ENABLE == 1
+static bool make_directory(const std::string& path)
+{
+    for (size_t pos = path.find('/', 1); pos != std::string::npos; pos = path.find('/', pos + 1)) {
+        mkdir(path.substr(0, pos).c_str(), 0755);
     }
-    std::string compile_opts = "-O3 --gpu-architecture=gfx906";
+    mkdir(path.c_str(), 0755);
+
+    struct stat st;
+    return stat(path.c_str(), &st) == 0 && S_ISDIR(st.st_mode);
+}
+
+std::string HIPCompiler::get_cache_key(const std::string& hip_kernel, const std::string& compile_opts)
+{
+    int rtc_major = 0;
+    int rtc_minor = 0;
+    hiprtcVersion(&rtc_major, &rtc_minor);
+
+    /* everything that changes the code object, separated so that fields cannot run into each other */
+    std::string key_src = hip_kernel + '\0' + compile_opts + '\0' + arch_ + '\0' + std::to_string(rtc_major) + "." +
+                          std::to_string(rtc_minor);
+    std::vector<uint64_t> staging(hash::num_words(key_src.size()));
+    memcpy(staging.data(), key_src.data(), key_src.size());
+    PimContentHash hash = hash::hash_host_memory(staging.data(), key_src.size());
+
+    std::stringstream key;
+    key << arch_ << "-" << std::hex;
+    key.width(16);
+    key.fill('0');
+    key << hash.h0;
+    key.width(16);
+    key << hash.h1;
+    return key.str();
+}
+
+bool HIPCompiler::compile_code_object(const std::string& hip_kernel, const std::string& compile_opts,
+                                      std::vector<char>* code)
+{
     const char* options[] = {compile_opts.c_str()};
 
     hiprtcProgram prog;
@@ -47,33 +132,122 @@ void HIPCompiler::execute(std::string hip_kernel, std::string crf_binary)
         DLOG(INFO) << log;
     }
 
-    if (compileResult != HIPRTC_SUCCESS)
+    if (compileResult != HIPRTC_SUCCESS) {
         std::cout << "Compilation failed." << std::endl;
-    else
-        std::cout << "Compilation successful" << std::endl;
+        hiprtcDestroyProgram(&prog);
+        return false;
+    }
+    std::cout << "Compilation successful" << std::endl;
 
     size_t codeSize;
     hiprtcGetCodeSize(prog, &codeSize);
 
-    std::vector<char> code(codeSize);
-    hiprtcGetCode(prog, code.data());
+    code->resize(codeSize);
+    hiprtcGetCode(prog, code->data());
+    hiprtcDestroyProgram(&prog);
+
+    return true;
+}
+
+bool HIPCompiler::load_code_object(const std::string& key, std::vector<char>* code)
+{
+    if (cache_dir_.empty()) return false;
+
+    std::ifstream file(cache_dir_ + "/" + key + ".hsaco", std::ios::binary | std::ios::ate);
+    if (!file.is_open()) return false;
+
+    std::streamsize size = file.tellg();
+    if (size <= 0) return false;
+    file.seekg(0, std::ios::beg);
+    code->resize(size);
+
+    return (bool)file.read(code->data(), size);
+}
+
+void HIPCompiler::save_code_object(const std::string& key, const std::vector<char>& code)
+{
+    if (cache_dir_.empty() || !make_directory(cache_dir_)) return;
+
+    /* written to a private file first so that concurrent processes never read a partial code object */
+    std::string path = cache_dir_ + "/" + key + ".hsaco";
+    std::string tmp_path = path + ".tmp." + std::to_string(getpid());
+    std::ofstream file(tmp_path, std::ios::binary);
+    if (!file.is_open()) return;
+    file.write(code.data(), code.size());
+    file.close();
+
+    if (!file || rename(tmp_path.c_str(), path.c_str()) != 0) {
+        DLOG(ERROR) << "Failed to save code object " << path;
+        remove(tmp_path.c_str());
+    }
+}
 
+bool HIPCompiler::load_module(const std::vector<char>& code, KernelModule* kernel_module)
+{
     hipError_t err;
-    hiprtcDestroyProgram(&prog);
-    err = hipModuleLoadData(&module_, code.data());
+    err = hipModuleLoadData(&kernel_module->module, code.data());
     if (err != hipSuccess) {
         DLOG(INFO) << "Falied to Load Module Err: " << err << std::endl;
+        return false;
     }
-    err = hipModuleGetFunction(&kernel_, module_, "pim_hip_kernel");
+    err = hipModuleGetFunction(&kernel_module->kernel, kernel_module->module, "pim_hip_kernel");
     if (err != hipSuccess) {
         DLOG(INFO) << "Falied to Load function Err: " << err << std::endl;
+        hipModuleUnload(kernel_module->module);
+        return false;
     }
+    return true;
+}
+
+hipFunction_t HIPCompiler::execute(std::string hip_kernel, std::string crf_binary)
+{
+    if (const char* env_p = std::getenv("SAVE_GENERATED_KERNEL")) {
+        int value = *((int*)env_p);
+        if (value == 1) {
+            std::ofstream hip_file("output_hip_kernel.txt");
+            hip_file << hip_kernel;
+            hip_file.close();
+
+            std::ofstream crf_file("output_crf_binary.txt");
+            crf_file << crf_binary;
+            crf_file.close();
+        }
+    }
+    std::string compile_opts = "-O3 --gpu-architecture=" + arch_;
+    std::string key = get_cache_key(hip_kernel, compile_opts);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto found = module_cache_.find(key);
+    if (found != module_cache_.end()) {
+        kernel_ = found->second.kernel;
+        return kernel_;
+    }
+
+    auto start = std::chrono::high_resolution_clock::now();
+    std::vector<char> code;
+    KernelModule kernel_module;
+    bool loaded = load_code_object(key, &code) && load_module(code, &kernel_module);
+    if (loaded) {
+        DLOG(INFO) << "Loaded cached code object " << key;
+    } else {
+        /* a stale or truncated file falls back to compilation and is overwritten */
+        if (!compile_code_object(hip_kernel, compile_opts, &code) || !load_module(code, &kernel_module)) {
+            kernel_ = nullptr;
+            return kernel_;
+        }
+        save_code_object(key, code);
+    }
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - start;
+    DLOG(INFO) << "Kernel " << key << (loaded ? " loaded" : " compiled") << " in " << elapsed.count() << " ms";
+
+    module_cache_[key] = kernel_module;
+    kernel_ = kernel_module.kernel;
+    return kernel_;
 }
 
 hipFunction_t PimCDriver::compile_code_hip(std::string kernel, std::string crf_binary)
 {
-    compile_.execute(kernel, crf_binary);
-    return compile_.get_kernel_function();
+    return compile_.execute(kernel, crf_binary);
 }
 
 PimCompiledObj* PimCDriver::build_program(pimc::frontend::Var output, std::vector<pimc::frontend::Buffer> inputs,
@@ -163,9 +337,12 @@ PimBo* PimCDriver::execute_program(PimCompiledObj* obj, PimTarget* target, std::
     DLOG(INFO) << "[START] " << __FUNCTION__ << " called";
     size_t num_args = obj->op_order.size() + 1;
     uint8_t* args[num_args];  // +1 for gpim_base_addr
-    uint8_t* crf_binary_device;
-    pim_malloc((void**)&crf_binary_device, 128, target);
-    pim_memcpy((void*)crf_binary_device, (uint8_t*)(obj->crf_binary.c_str()), obj->crf_binary.size(), target);
+    uint8_t* crf_binary_device = get_crf_buffer(obj->crf_binary, target);
+    if (crf_binary_device == nullptr) {
+        DLOG(ERROR) << "Failed to allocate CRF buffer";
+        DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
+        return nullptr;
+    }
 
     for (size_t i = 0; i < obj->op_order.size(); i++) {
         if (obj->pimbo_map.find(obj->op_order[i]) != obj->pimbo_map.end()) {
@@ -187,6 +364,26 @@ PimBo* PimCDriver::execute_program(PimCompiledObj* obj, PimTarget* target, std::
     return obj->output_pimbo;
 }
 
+uint8_t* PimCDriver::get_crf_buffer(const std::string& crf_binary, PimTarget* target)
+{
+    std::lock_guard<std::mutex> lock(crf_mutex_);
+
+    auto found = crf_buffers_.find(crf_binary);
+    if (found != crf_buffers_.end()) {
+        return found->second;
+    }
+
+    uint8_t* crf_binary_device = nullptr;
+    pim_malloc((void**)&crf_binary_device, std::max((size_t)CRF_BUFFER_SIZE, crf_binary.size()), target);
+    if (crf_binary_device == nullptr) {
+        return nullptr;
+    }
+    pim_memcpy((void*)crf_binary_device, (uint8_t*)(crf_binary.c_str()), crf_binary.size(), target);
+    crf_buffers_[crf_binary] = crf_binary_device;
+
+    return crf_binary_device;
+}
+
 void PimCDriver::pim_malloc(void** ptr, size_t size, PimTarget* target)
 {
     if (target->runtime == PimRuntimeType::RT_TYPE_HIP) hipMalloc(ptr, size);
@@ -207,6 +404,10 @@ void PimCDriver::pim_launch_kernel(std::string kernel, std::string crf_binary, u
                            HIP_LAUNCH_PARAM_END};
         config[1] = static_cast<void*>(args);
         auto hip_kernel = compile_code_hip(kernel, crf_binary);
+        if (hip_kernel == nullptr) {
+            DLOG(ERROR) << "PIM kernel is not available";
+            return;
+        }
         hipModuleLaunchKernel(hip_kernel, num_blocks, 1, 1, num_threads, 1, 1, 0, nullptr, NULL,
                               reinterpret_cast<void**>(&config));
     }
@@ -0,0 +1,261 @@
+/*
+ * Copyright (C) 2022 Samsung Electronics Co. LTD
+ *
+ * This software is a property of Samsung Electronics.
+ * No part of this software, either material or conceptual may be copied or distributed, transmitted,
+ * transcribed, stored in a retrieval system or translated into any human or computer language in any form by any means,
+ * electronic, mechanical, manual or otherwise, or disclosed
+ * to third parties without the express written permission of Samsung Electronics.
+ * (Use of the Software is restricted to non-commercial, personal or academic, research purpose only)
+ */
+
+#include "executor/PimCrfAssembler.h"
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include "executor/PimCrfValidator.h"
+
+namespace pim
+{
+namespace runtime
+{
+namespace executor
+{
+namespace
+{
+std::vector<std::string> split_tokens(const std::string& line)
+{
+    std::vector<std::string> tokens;
+    std::string token;
+
+    for (char c : line) {
+        if (isspace((unsigned char)c) || c == ',') {
+            if (!token.empty()) tokens.push_back(token);
+            token.clear();
+        } else {
+            token.push_back(toupper((unsigned char)c));
+        }
+    }
+    if (!token.empty()) tokens.push_back(token);
+    return tokens;
+}
+
+/* "[PC - 6]" of a JUMP arrives as "[PC", "-" and "6]" */
+std::string strip_jump_token(std::string token)
+{
+    token.erase(std::remove(token.begin(), token.end(), '['), token.end());
+    token.erase(std::remove(token.begin(), token.end(), ']'), token.end());
+    if (token.compare(0, 2, "PC") == 0) token.erase(0, 2);
+    if (!token.empty() && token[0] == '-') token.erase(0, 1);
+    return token;
+}
+
+bool parse_cmd_type(const std::string& token, PimCmdType* type)
+{
+    static const std::pair<const char*, PimCmdType> names[] = {
+        {"NOP", PimCmdType::NOP}, {"ADD", PimCmdType::ADD},   {"MUL", PimCmdType::MUL},
+        {"MAC", PimCmdType::MAC}, {"MAD", PimCmdType::MAD},   {"MOV", PimCmdType::MOV},
+        {"FILL", PimCmdType::FILL}, {"JUMP", PimCmdType::JUMP}, {"EXIT", PimCmdType::EXIT}};
+
+    for (auto& name : names) {
+        if (token == name.first) {
+            *type = name.second;
+            return true;
+        }
+    }
+    return false;
+}
+} /* namespace */
+
+PimCrfAssembler::PimCrfAssembler(void) : max_crf_cmds_(32) {}
+PimCrfAssembler::~PimCrfAssembler(void) {}
+int PimCrfAssembler::parse_count(const std::string& token, int* count)
+{
+    std::string digits(token);
+    if (!digits.empty() && digits.back() == 'X') digits.pop_back();
+    if (digits.empty()) return -1;
+
+    char* end = nullptr;
+    long value = strtol(digits.c_str(), &end, 0);
+    if (*end != '\0' || value < 0 || value > (1 << 17)) return -1;
+
+    *count = (int)value;
+    return 0;
+}
+
+int PimCrfAssembler::parse_operand(const std::string& token, PimOpdType* opd, int* idx)
+{
+    static const std::pair<const char*, PimOpdType> names[] = {
+        {"A_OUT", PimOpdType::A_OUT}, {"M_OUT", PimOpdType::M_OUT}, {"EVEN_BANK", PimOpdType::EVEN_BANK},
+        {"ODD_BANK", PimOpdType::ODD_BANK}, {"GRF_A", PimOpdType::GRF_A}, {"GRF_B", PimOpdType::GRF_B},
+        {"SRF_M", PimOpdType::SRF_M}, {"SRF_A", PimOpdType::SRF_A}};
+    std::string name = token.substr(0, token.find('['));
+
+    *idx = 0;
+    if (name.size() != token.size()) {
+        std::string index = token.substr(name.size() + 1);
+        if (index.empty() || index.back() != ']') return -1;
+        index.pop_back();
+
+        char* end = nullptr;
+        long value = strtol(index.c_str(), &end, 0);
+        /* the index fields are four bits wide */
+        if (index.empty() || *end != '\0' || value < 0 || value > 15) return -1;
+        *idx = (int)value;
+    }
+
+    for (auto& entry : names) {
+        if (name == entry.first) {
+            *opd = entry.second;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+int PimCrfAssembler::parse_line(const std::string& line, PimCrfProgram* program)
+{
+    std::vector<std::string> tokens = split_tokens(line.substr(0, line.find('#')));
+    if (tokens.empty()) return 0;
+
+    PimCmdType type;
+    if (!parse_cmd_type(tokens[0], &type)) {
+        DLOG(ERROR) << "unknown command " << tokens[0];
+        return -1;
+    }
+
+    PimCommand cmd;
+    cmd.type_ = type;
+    if (type == PimCmdType::EXIT) {
+        if (tokens.size() != 1) return -1;
+    } else if (type == PimCmdType::NOP) {
+        int num_cycle = 1;
+        if (tokens.size() > 2) return -1;
+        if (tokens.size() == 2 && (parse_count(tokens[1], &num_cycle) != 0 || num_cycle < 1 || num_cycle > 2048)) {
+            DLOG(ERROR) << "NOP takes 1 to 2048 cycles";
+            return -1;
+        }
+        cmd.loop_counter_ = num_cycle - 1;
+    } else if (type == PimCmdType::JUMP) {
+        std::vector<std::string> args;
+        for (size_t i = 1; i < tokens.size(); i++) {
+            std::string token = strip_jump_token(tokens[i]);
+            if (!token.empty()) args.push_back(token);
+        }
+        if (args.size() != 2 || parse_count(args[1], &cmd.loop_offset_) != 0) {
+            DLOG(ERROR) << "JUMP needs a count and a [PC - offset]";
+            return -1;
+        }
+        if (args[0] == "LC") {
+            program->lc_jumps.push_back(program->cmds.size());
+        } else if (parse_count(args[0], &cmd.loop_counter_) != 0) {
+            DLOG(ERROR) << "invalid JUMP count " << args[0];
+            return -1;
+        }
+    } else {
+        int num_opd = (type == PimCmdType::MAD) ? 4 : (type == PimCmdType::FILL || type == PimCmdType::MOV) ? 2 : 3;
+        PimOpdType* opds[] = {&cmd.dst_, &cmd.src0_, &cmd.src1_, &cmd.src2_};
+        int* idxs[] = {&cmd.dst_idx_, &cmd.src0_idx_, &cmd.src1_idx_, nullptr};
+
+        if ((int)tokens.size() <= num_opd) {
+            DLOG(ERROR) << tokens[0] << " needs " << num_opd << " operands";
+            return -1;
+        }
+        for (int i = 0; i < num_opd; i++) {
+            int idx = 0;
+            if (parse_operand(tokens[i + 1], opds[i], &idx) != 0) {
+                DLOG(ERROR) << "invalid operand " << tokens[i + 1];
+                return -1;
+            }
+            /* src2 has no index field of its own */
+            if (idxs[i] != nullptr) *idxs[i] = idx;
+        }
+        for (size_t i = num_opd + 1; i < tokens.size(); i++) {
+            if (tokens[i] == "AUTO") {
+                cmd.is_auto_ = 1;
+            } else if (tokens[i] == "RELU" && (type == PimCmdType::FILL || type == PimCmdType::MOV)) {
+                cmd.is_relu_ = 1;
+            } else {
+                DLOG(ERROR) << "unknown flag " << tokens[i];
+                return -1;
+            }
+        }
+    }
+
+    program->cmds.push_back(cmd);
+    return 0;
+}
+
+int PimCrfAssembler::assemble(const std::string& text, PimCrfProgram* program)
+{
+    DLOG(INFO) << "[START] " << __FUNCTION__ << " called";
+    std::istringstream lines(text);
+    std::string line;
+    int line_no = 0;
+
+    program->cmds.clear();
+    program->lc_jumps.clear();
+    while (std::getline(lines, line)) {
+        line_no++;
+        if (parse_line(line, program) != 0) {
+            DLOG(ERROR) << "line " << line_no << " : " << line;
+            return -1;
+        }
+    }
+
+    if (program->cmds.empty() || (int)program->cmds.size() > max_crf_cmds_) {
+        DLOG(ERROR) << "CRF program needs 1 to " << max_crf_cmds_ << " commands, " << program->cmds.size()
+                    << " given";
+        return -1;
+    }
+
+    /* lc is only known at launch, any nonzero count passes the same checks */
+    std::vector<PimCommand> cmds(program->cmds);
+    for (auto idx : program->lc_jumps) cmds[idx].loop_counter_ = 1;
+
+    PimCrfValidator validator;
+    if (validator.validate(cmds) != 0) {
+        DLOG(ERROR) << "CRF program violates the ISA rules";
+        return -1;
+    }
+
+    DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
+    return 0;
+}
+
+int PimCrfAssembler::assemble_file(const std::string& file_path, PimCrfProgram* program)
+{
+    std::ifstream file(file_path);
+    if (!file.is_open()) {
+        DLOG(ERROR) << "fail to open " << file_path;
+        return -1;
+    }
+
+    std::stringstream text;
+    text << file.rdbuf();
+    return assemble(text.str(), program);
+}
+
+int PimCrfAssembler::disassemble(const uint8_t* binary, int size, std::string* text)
+{
+    if (binary == nullptr || size % sizeof(uint32_t) != 0) return -1;
+
+    std::stringstream ss;
+    for (int i = 0; i < size / (int)sizeof(uint32_t); i++) {
+        uint32_t word;
+        char comment[32];
+        PimCommand cmd;
+
+        memcpy(&word, binary + i * sizeof(uint32_t), sizeof(uint32_t));
+        cmd.from_int(word);
+        snprintf(comment, sizeof(comment), "# %2d : 0x%08x", i, word);
+        ss << cmd.to_str() << std::string(std::max(1, 48 - (int)cmd.to_str().size()), ' ') << comment << "\n";
+    }
+    *text = ss.str();
+    return 0;
+}
+} /* namespace executor */
+} /* namespace runtime */
+} /* namespace pim */
@@ -10,7 +10,11 @@
  */
 
 #include "executor/PimCrfBinGen.h"
+#include <algorithm>
 #include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include "utility/pim_debug.hpp"
 
 namespace pim
 {
@@ -19,19 +23,106 @@ namespace runtime
 namespace executor
 {
 PimCrfBinGen::PimCrfBinGen(pim::runtime::manager::PimManager* pim_manager)
-    : pim_manager_(pim_manager), is_gemv_tile_tree_(true), max_crf_size_(128)
+    : pim_manager_(pim_manager),
+      crf_arena_(nullptr),
+      arena_max_lc_(CRF_ARENA_DEFAULT_MAX_LC),
+      crf_version_(0),
+      is_gemv_tile_tree_(true),
+      is_op_scheduled_(true),
+      max_crf_size_(128)
 {
     pim_device_ = pim_manager_->get_pim_device();
     pbi_ = pim_device_->get_pim_block_info();
+    /* PIM_CRF_SCHEDULE=0 keeps the hand padded programs of the single ops */
+    const char* env_s = std::getenv("PIM_CRF_SCHEDULE");
+    if (env_s != nullptr && atoi(env_s) == 0) is_op_scheduled_ = false;
+    for (int i = 0; i <= OP_DUMMY; i++) {
+        arena_row_[i] = -1;
+        memset(&stmt_args_[i], 0, sizeof(stmt_args_[i]));
+        crf_size_[i][0] = crf_size_[i][1] = CRF_BIN_SIZE;
+    }
+    const PimOpType elt_ops[] = {OP_ELT_ADD, OP_ELT_MUL,        OP_RELU,          OP_COPY,
+                                 OP_BN,      OP_ELT_ADD_SCALAR, OP_ELT_MUL_SCALAR};
+    for (auto op_type : elt_ops) update_op_info(op_type);
+
+    /* JUMP holds a 17 bit loop counter */
+    const char* env_lc = std::getenv("PIM_CRF_ARENA_MAX_LC");
+    if (env_lc != nullptr) {
+        arena_max_lc_ = std::min(std::max(atoi(env_lc), CRF_ARENA_MIN_LC - 1), (1 << 17) - 1);
+    }
 }
 
 PimCrfBinGen::~PimCrfBinGen(void)
 {
+    deinitialize();
+    pim_device_.reset();
+}
+
+int PimCrfBinGen::initialize(void)
+{
+    DLOG(INFO) << "[START] " << __FUNCTION__ << " called";
+    const PimOpType arena_ops[] = {OP_ELT_ADD, OP_ELT_MUL,        OP_RELU,          OP_COPY,
+                                   OP_BN,      OP_ELT_ADD_SCALAR, OP_ELT_MUL_SCALAR};
+    int num_op = sizeof(arena_ops) / sizeof(arena_ops[0]);
+    int num_lc = arena_max_lc_ - CRF_ARENA_MIN_LC + 1;
+    int crf_size = 0;
+
+    if (crf_arena_ != nullptr || num_lc <= 0) {
+        DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
+        return 0;
+    }
+
+    /* the programs of one op differ only in the JUMP loop counter, so they are generated here once */
+    /* and uploaded with a single copy instead of an allocation and a copy per new data size */
+    size_t arena_size = (size_t)num_op * num_lc * max_crf_size_;
+    std::vector<uint8_t> h_arena(arena_size, 0);
+    {
+        std::lock_guard<std::mutex> lock(crf_lut_mutex_);
+        for (int row = 0; row < num_op; row++) {
+            for (int lc = CRF_ARENA_MIN_LC; lc <= arena_max_lc_; lc++) {
+                size_t slot = ((size_t)row * num_lc + (lc - CRF_ARENA_MIN_LC)) * max_crf_size_;
+                gen_binary_with_loop(arena_ops[row], lc, &h_arena[slot], &crf_size);
+            }
+        }
+    }
+
+    uint8_t* d_arena = nullptr;
+    if (pim_manager_->alloc_memory((void**)&d_arena, arena_size, MEM_TYPE_DEVICE) != 0 || d_arena == nullptr) {
+        DLOG(ERROR) << "fail to allocate CRF arena of " << arena_size << " bytes";
+        return -1;
+    }
+    pim_manager_->copy_memory((void*)d_arena, (void*)h_arena.data(), arena_size, HOST_TO_DEVICE);
+
+    for (int row = 0; row < num_op; row++) arena_row_[arena_ops[row]] = row;
+    crf_arena_ = d_arena;
+
+    DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
+    return 0;
+}
+
+int PimCrfBinGen::deinitialize(void)
+{
+    DLOG(INFO) << "[START] " << __FUNCTION__ << " called";
+    int ret = 0;
+
+    if (crf_arena_ != nullptr) {
+        ret |= pim_manager_->free_memory((void*)crf_arena_, MEM_TYPE_DEVICE);
+        crf_arena_ = nullptr;
+    }
+    for (int i = 0; i <= OP_DUMMY; i++) arena_row_[i] = -1;
+
+    std::lock_guard<std::mutex> lock(crf_lut_mutex_);
     for (auto it = crf_lut_.begin(); it != crf_lut_.end(); it++) {
-        pim_manager_->free_memory((void*)it->second, MEM_TYPE_DEVICE);
+        ret |= pim_manager_->free_memory((void*)it->second, MEM_TYPE_DEVICE);
     }
     crf_lut_.clear();
-    pim_device_.reset();
+    for (auto it = elt_chain_crf_lut_.begin(); it != elt_chain_crf_lut_.end(); it++) {
+        ret |= pim_manager_->free_memory((void*)it->second, MEM_TYPE_DEVICE);
+    }
+    elt_chain_crf_lut_.clear();
+
+    DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
+    return ret;
 }
 
 void PimCrfBinGen::gen_binary_with_loop(PimOpType op_type, int lc, uint8_t* bin_buf, int* crf_sz)
@@ -46,59 +137,133 @@ void PimCrfBinGen::create_pim_cmd(PimOpType op_type, int lc)
 {
     DLOG(INFO) << "[START] " << __FUNCTION__ << " called";
 
-    if (op_type == OP_ELT_ADD) {
-        std::vector<PimCommand> tmp_cmds{
+    auto loaded = crf_programs_.find(op_type);
+    if (loaded != crf_programs_.end()) {
+        /* a loaded program is used as written, only its lc JUMPs follow the data size */
+        cmds_.assign(loaded->second.cmds.begin(), loaded->second.cmds.end());
+        for (auto idx : loaded->second.lc_jumps) cmds_[idx].loop_counter_ = lc;
+
+        int nop_cnt = (8 - cmds_.size() % 8) % 8;
+        for (int i = 0; i < nop_cnt; i++) cmds_.push_back(PimCommand(PimCmdType::NOP, 0));
+        DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
+        return;
+    }
+
+    if (!is_op_scheduled_ && op_type != OP_GEMV) {
+        create_padded_op_cmd(op_type, lc);
+        DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
+        return;
+    }
+
+    /* hazard NOPs come from the scheduler, write back NOPs span the W and R commands the kernels issue per output */
+    int ret = 0;
+    if (op_type == OP_ELT_ADD || op_type == OP_ELT_MUL) {
+        PimCmdType type = (op_type == OP_ELT_ADD) ? PimCmdType::ADD : PimCmdType::MUL;
+        std::vector<PimCommand> even_cmds{
             PimCommand(PimCmdType::FILL, PimOpdType::GRF_A, PimOpdType::EVEN_BANK),
-            PimCommand(PimCmdType::ADD, PimOpdType::GRF_A, PimOpdType::GRF_A, PimOpdType::EVEN_BANK, 1),
-            PimCommand(PimCmdType::NOP, 23), PimCommand(PimCmdType::FILL, PimOpdType::GRF_B, PimOpdType::ODD_BANK),
-            PimCommand(PimCmdType::ADD, PimOpdType::GRF_B, PimOpdType::GRF_B, PimOpdType::ODD_BANK, 1),
-            PimCommand(PimCmdType::NOP, 23) /*,
-            PimCommand(PimCmdType::NOP, 0)*/};
+            PimCommand(type, PimOpdType::GRF_A, PimOpdType::GRF_A, PimOpdType::EVEN_BANK, 1)};
+        ret = schedule_op_cmd(even_cmds, 3 * pbi_->num_grf, true, lc);
+    } else if (op_type == OP_RELU || op_type == OP_COPY) {
+        int is_relu = (op_type == OP_RELU) ? 1 : 0;
+        std::vector<PimCommand> even_cmds{
+            PimCommand(PimCmdType::FILL, PimOpdType::GRF_A, PimOpdType::EVEN_BANK, 1, 0, 0, 0, is_relu)};
+        ret = schedule_op_cmd(even_cmds, 2 * pbi_->num_grf, true, lc);
+    } else if (op_type == OP_ELT_ADD_SCALAR) {
+        /* the scalar is held in SRF_A, so the vector operand is streamed once */
+        std::vector<PimCommand> even_cmds{
+            PimCommand(PimCmdType::ADD, PimOpdType::GRF_A, PimOpdType::EVEN_BANK, PimOpdType::SRF_A, 1)};
+        ret = schedule_op_cmd(even_cmds, 2 * pbi_->num_grf, true, lc);
+    } else if (op_type == OP_ELT_MUL_SCALAR) {
+        /* ISA 1.0 has no MUL between a bank and SRF_M, so MAD with a zero SRF_A is used */
+        std::vector<PimCommand> even_cmds{PimCommand(PimCmdType::MAD, PimOpdType::GRF_A, PimOpdType::EVEN_BANK,
+                                                     PimOpdType::SRF_M, PimOpdType::SRF_A, 1)};
+        ret = schedule_op_cmd(even_cmds, 2 * pbi_->num_grf, true, lc);
+    } else if (op_type == OP_BN) {
+        /* both halves are computed before the kernel writes the even output and then the odd one */
+        std::vector<PimCommand> even_cmds{PimCommand(PimCmdType::MAD, PimOpdType::GRF_A, PimOpdType::EVEN_BANK,
+                                                     PimOpdType::SRF_M, PimOpdType::SRF_A, 1, 0, 0, 0),
+                                          PimCommand(PimCmdType::MAD, PimOpdType::GRF_A, PimOpdType::GRF_A,
+                                                     PimOpdType::SRF_M, PimOpdType::SRF_A, 1, 0, 0, 1)};
+        ret = schedule_op_cmd(even_cmds, 3 * pbi_->num_grf, false, lc);
+    }
+    if (op_type != OP_GEMV) {
+        if (ret != 0) DLOG(ERROR) << "program of " << get_pim_op_string(op_type) << " violates the ISA rules";
+        DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
+        return;
+    }
+
+    /*
+     * the GEMV loop nests stay as written: the read of the result has to follow the inner JUMP as a NOP,
+     * which the checker does not allow in general, and the accumulating MACs need no hazard NOP
+     */
+    if (is_gemv_tile_tree_) {
+        std::vector<PimCommand> tmp_cmds{
+            PimCommand(PimCmdType::MAC, PimOpdType::GRF_B, PimOpdType::GRF_A, PimOpdType::EVEN_BANK, 1, 0, 0, 0),
+            PimCommand(PimCmdType::JUMP, 7, 2),
+            PimCommand(PimCmdType::NOP, 23),
+            PimCommand(PimCmdType::MAC, PimOpdType::GRF_B, PimOpdType::GRF_A, PimOpdType::ODD_BANK, 1, 0, 0, 0),
+            PimCommand(PimCmdType::JUMP, 7, 2),
+            PimCommand(PimCmdType::NOP, 23),
+        };
         cmds_.assign(tmp_cmds.begin(), tmp_cmds.end());
-    } else if (op_type == OP_ELT_MUL) {
+    } else {
+        int even_lc = 8 * ceil((float)lc / 2) - 1;
+        int odd_lc = 8 * (lc / 2) - 1;
+        std::vector<PimCommand> tmp_cmds{
+            PimCommand(PimCmdType::MAC, PimOpdType::GRF_B, PimOpdType::GRF_A, PimOpdType::EVEN_BANK, 1, 0, 0, 0),
+            PimCommand(PimCmdType::JUMP, even_lc, 2),
+            PimCommand(PimCmdType::MAC, PimOpdType::GRF_B, PimOpdType::GRF_A, PimOpdType::ODD_BANK, 1, 0, 0, 0),
+            PimCommand(PimCmdType::JUMP, odd_lc, 2), PimCommand(PimCmdType::NOP, 23)};
+        cmds_.assign(tmp_cmds.begin(), tmp_cmds.end());
+    }
+
+    if (lc != 0 && is_gemv_tile_tree_) {
+        cmds_.push_back(PimCommand(PimCmdType::JUMP, lc, cmds_.size() + 1));
+    }
+
+    cmds_.push_back(PimCommand(PimCmdType::EXIT, 0));
+
+    int nop_cnt = 8 - cmds_.size() % 8;
+    for (int i = 0; i < nop_cnt; i++) cmds_.push_back(PimCommand(PimCmdType::NOP, 0));
+
+    DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
+}
+
+void PimCrfBinGen::create_padded_op_cmd(PimOpType op_type, int lc)
+{
+    /* every hazard and write back takes a whole statement of eight NOP cycles */
+    if (op_type == OP_ELT_ADD || op_type == OP_ELT_MUL) {
+        PimCmdType type = (op_type == OP_ELT_ADD) ? PimCmdType::ADD : PimCmdType::MUL;
         std::vector<PimCommand> tmp_cmds{
             PimCommand(PimCmdType::FILL, PimOpdType::GRF_A, PimOpdType::EVEN_BANK),
-            PimCommand(PimCmdType::MUL, PimOpdType::GRF_A, PimOpdType::GRF_A, PimOpdType::EVEN_BANK, 1),
+            PimCommand(type, PimOpdType::GRF_A, PimOpdType::GRF_A, PimOpdType::EVEN_BANK, 1),
             PimCommand(PimCmdType::NOP, 23), PimCommand(PimCmdType::FILL, PimOpdType::GRF_B, PimOpdType::ODD_BANK),
-            PimCommand(PimCmdType::MUL, PimOpdType::GRF_B, PimOpdType::GRF_B, PimOpdType::ODD_BANK, 1),
-            PimCommand(PimCmdType::NOP, 23) /*,
-            PimCommand(PimCmdType::NOP, 0)*/};
+            PimCommand(type, PimOpdType::GRF_B, PimOpdType::GRF_B, PimOpdType::ODD_BANK, 1),
+            PimCommand(PimCmdType::NOP, 23)};
         cmds_.assign(tmp_cmds.begin(), tmp_cmds.end());
-    } else if (op_type == OP_RELU) {
+    } else if (op_type == OP_RELU || op_type == OP_COPY) {
+        int is_relu = (op_type == OP_RELU) ? 1 : 0;
         std::vector<PimCommand> tmp_cmds{
-            PimCommand(PimCmdType::FILL, PimOpdType::GRF_A, PimOpdType::EVEN_BANK, 1, 0, 0, 0, 1),
+            PimCommand(PimCmdType::FILL, PimOpdType::GRF_A, PimOpdType::EVEN_BANK, 1, 0, 0, 0, is_relu),
             PimCommand(PimCmdType::NOP, 15),
-            PimCommand(PimCmdType::FILL, PimOpdType::GRF_B, PimOpdType::ODD_BANK, 1, 0, 0, 0, 1),
-            PimCommand(PimCmdType::NOP, 15) /*, PimCommand(PimCmdType::NOP, 0)*/};
+            PimCommand(PimCmdType::FILL, PimOpdType::GRF_B, PimOpdType::ODD_BANK, 1, 0, 0, 0, is_relu),
+            PimCommand(PimCmdType::NOP, 15)};
         cmds_.assign(tmp_cmds.begin(), tmp_cmds.end());
-    } else if (op_type == OP_COPY) {
+    } else if (op_type == OP_ELT_ADD_SCALAR) {
         std::vector<PimCommand> tmp_cmds{
-            PimCommand(PimCmdType::FILL, PimOpdType::GRF_A, PimOpdType::EVEN_BANK, 1, 0, 0, 0, 0),
+            PimCommand(PimCmdType::ADD, PimOpdType::GRF_A, PimOpdType::EVEN_BANK, PimOpdType::SRF_A, 1),
             PimCommand(PimCmdType::NOP, 15),
-            PimCommand(PimCmdType::FILL, PimOpdType::GRF_B, PimOpdType::ODD_BANK, 1, 0, 0, 0, 0),
-            PimCommand(PimCmdType::NOP, 15) /*, PimCommand(PimCmdType::NOP, 0)*/};
+            PimCommand(PimCmdType::ADD, PimOpdType::GRF_B, PimOpdType::ODD_BANK, PimOpdType::SRF_A, 1),
+            PimCommand(PimCmdType::NOP, 15)};
+        cmds_.assign(tmp_cmds.begin(), tmp_cmds.end());
+    } else if (op_type == OP_ELT_MUL_SCALAR) {
+        std::vector<PimCommand> tmp_cmds{PimCommand(PimCmdType::MAD, PimOpdType::GRF_A, PimOpdType::EVEN_BANK,
+                                                    PimOpdType::SRF_M, PimOpdType::SRF_A, 1),
+                                         PimCommand(PimCmdType::NOP, 15),
+                                         PimCommand(PimCmdType::MAD, PimOpdType::GRF_B, PimOpdType::ODD_BANK,
+                                                    PimOpdType::SRF_M, PimOpdType::SRF_A, 1),
+                                         PimCommand(PimCmdType::NOP, 15)};
         cmds_.assign(tmp_cmds.begin(), tmp_cmds.end());
-    } else if (op_type == OP_GEMV) {
-        if (is_gemv_tile_tree_) {
-            std::vector<PimCommand> tmp_cmds{
-                PimCommand(PimCmdType::MAC, PimOpdType::GRF_B, PimOpdType::GRF_A, PimOpdType::EVEN_BANK, 1, 0, 0, 0),
-                PimCommand(PimCmdType::JUMP, 7, 2),
-                PimCommand(PimCmdType::NOP, 23),
-                PimCommand(PimCmdType::MAC, PimOpdType::GRF_B, PimOpdType::GRF_A, PimOpdType::ODD_BANK, 1, 0, 0, 0),
-                PimCommand(PimCmdType::JUMP, 7, 2),
-                PimCommand(PimCmdType::NOP, 23),
-            };
-            cmds_.assign(tmp_cmds.begin(), tmp_cmds.end());
-        } else {
-            int even_lc = 8 * ceil((float)lc / 2) - 1;
-            int odd_lc = 8 * (lc / 2) - 1;
-            std::vector<PimCommand> tmp_cmds{
-                PimCommand(PimCmdType::MAC, PimOpdType::GRF_B, PimOpdType::GRF_A, PimOpdType::EVEN_BANK, 1, 0, 0, 0),
-                PimCommand(PimCmdType::JUMP, even_lc, 2),
-                PimCommand(PimCmdType::MAC, PimOpdType::GRF_B, PimOpdType::GRF_A, PimOpdType::ODD_BANK, 1, 0, 0, 0),
-                PimCommand(PimCmdType::JUMP, odd_lc, 2), PimCommand(PimCmdType::NOP, 23)};
-            cmds_.assign(tmp_cmds.begin(), tmp_cmds.end());
-        }
     } else if (op_type == OP_BN) {
         std::vector<PimCommand> tmp_cmds{PimCommand(PimCmdType::MAD, PimOpdType::GRF_A, PimOpdType::EVEN_BANK,
                                                     PimOpdType::SRF_M, PimOpdType::SRF_A, 1, 0, 0, 0),
@@ -111,21 +276,17 @@ void PimCrfBinGen::create_pim_cmd(PimOpType op_type, int lc)
                                          PimCommand(PimCmdType::NOP, 7),
                                          PimCommand(PimCmdType::MAD, PimOpdType::GRF_B, PimOpdType::GRF_B,
                                                     PimOpdType::SRF_M, PimOpdType::SRF_A, 1, 0, 0, 1),
-                                         PimCommand(PimCmdType::NOP, 23)
-                                         /*PimCommand(PimCmdType::NOP, 0)*/};
+                                         PimCommand(PimCmdType::NOP, 23)};
         cmds_.assign(tmp_cmds.begin(), tmp_cmds.end());
+    } else {
+        cmds_.clear();
     }
 
-    if ((lc != 0 && is_gemv_tile_tree_) == true || op_type != OP_GEMV) {
-        cmds_.push_back(PimCommand(PimCmdType::JUMP, lc, cmds_.size() + 1));
-    }
-
+    cmds_.push_back(PimCommand(PimCmdType::JUMP, lc, cmds_.size() + 1));
     cmds_.push_back(PimCommand(PimCmdType::EXIT, 0));
 
-    int nop_cnt = 8 - cmds_.size() % 8;
+    int nop_cnt = (8 - cmds_.size() % 8) % 8;
     for (int i = 0; i < nop_cnt; i++) cmds_.push_back(PimCommand(PimCmdType::NOP, 0));
-
-    DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
 }
 
 void PimCrfBinGen::change_to_binary(uint8_t* crf_binary, int* crf_size)
@@ -186,6 +347,254 @@ int PimCrfBinGen::preprocess_srf(PimBo* beta, PimBo* gamma, PimBo* mean, PimBo*
     return 0;
 }
 
+int PimCrfBinGen::preprocess_srf_scalar(PimOpType op_type, uint16_t scalar, uint8_t* srf_binary)
+{
+    uint16_t h_one = 0x3c00;
+    uint16_t h_zero = 0x0000;
+
+    if (op_type != OP_ELT_ADD_SCALAR && op_type != OP_ELT_MUL_SCALAR) {
+        DLOG(ERROR) << "SRF can not be prepared for " << get_pim_op_string(op_type);
+        return -1;
+    }
+
+    if (op_type == OP_ELT_MUL_SCALAR) return preprocess_srf_affine(scalar, h_zero, srf_binary);
+    return preprocess_srf_affine(h_one, scalar, srf_binary);
+}
+
+int PimCrfBinGen::preprocess_srf_affine(uint16_t scale, uint16_t shift, uint8_t* srf_binary)
+{
+    /* one SRF image (8 SRF_M entries followed by 8 SRF_A entries) is shared by every channel */
+    int num_half_per_reg = 8;
+    uint16_t* h_srf_binary = reinterpret_cast<uint16_t*>(srf_binary);
+
+    for (int i = 0; i < num_half_per_reg; i++) {
+        h_srf_binary[i] = scale;
+        h_srf_binary[num_half_per_reg + i] = shift;
+    }
+    return 0;
+}
+
+namespace
+{
+/* one CRF instruction of the chain before it is bound to a bank half, src is the vector it reads */
+typedef struct __EltChainStage {
+    PimCmdType type;
+    int src;
+} EltChainStage;
+
+float fp16_to_float(uint16_t bits)
+{
+    half_float::half value;
+    memcpy(&value, &bits, sizeof(bits));
+    return (float)value;
+}
+
+uint16_t float_to_fp16(float value)
+{
+    half_float::half h_value(value);
+    uint16_t bits;
+    memcpy(&bits, &h_value, sizeof(bits));
+    return bits;
+}
+
+PimOpdType to_odd_half(PimOpdType opd)
+{
+    if (opd == PimOpdType::GRF_A) return PimOpdType::GRF_B;
+    if (opd == PimOpdType::EVEN_BANK) return PimOpdType::ODD_BANK;
+    return opd;
+}
+} /* namespace */
+
+int PimCrfBinGen::schedule_op_cmd(const std::vector<PimCommand>& even_cmds, int num_wb_cycle, bool is_wb_per_half,
+                                  int lc)
+{
+    PimCrfScheduler scheduler;
+
+    /* the odd half repeats the even one on GRF_B and the odd bank */
+    for (int odd = 0; odd < 2; odd++) {
+        for (auto cmd : even_cmds) {
+            if (odd) {
+                cmd.dst_ = to_odd_half(cmd.dst_);
+                cmd.src0_ = to_odd_half(cmd.src0_);
+                cmd.src1_ = to_odd_half(cmd.src1_);
+            }
+            if (scheduler.push_cmd(cmd) < 0) return -1;
+        }
+        if (is_wb_per_half || odd) scheduler.push_nop(num_wb_cycle);
+    }
+    return scheduler.finish(lc, &cmds_);
+}
+
+int PimCrfBinGen::push_elt_chain_cmd(PimCrfScheduler* scheduler, PimEltChainProgram* program, const PimCommand& cmd,
+                                     int src)
+{
+    int num_cycle = scheduler->push_cmd(cmd);
+    if (num_cycle < 0) return -1;
+
+    /* a hazard NOP is driven by a statement in which only the first num_cycle GRF indices read the input */
+    if (num_cycle > 0) {
+        program->stmt_src.push_back(0);
+        program->stmt_cols.push_back(num_cycle);
+    }
+    program->stmt_src.push_back(src);
+    program->stmt_cols.push_back(pbi_->num_grf);
+    return 0;
+}
+
+int PimCrfBinGen::create_elt_chain_cmd(const PimEltChainStep* steps, int num_steps, int lc,
+                                       PimEltChainProgram* program)
+{
+    DLOG(INFO) << "[START] " << __FUNCTION__ << " called";
+    std::vector<EltChainStage> stages;
+    float scale = 1.0f;
+    float shift = 0.0f;
+    bool is_pending = false;
+
+    program->cmds.clear();
+    program->stmt_src.clear();
+    program->stmt_cols.clear();
+    program->num_operand = 0;
+    program->use_srf = false;
+
+    /* adjacent scalar steps are folded into one MAD with SRF_M and SRF_A, the SRF holds a single pair */
+    for (int i = 0; i <= num_steps; i++) {
+        bool is_scalar = i < num_steps && (steps[i].op_type == ELT_CHAIN_ADD_SCALAR ||
+                                           steps[i].op_type == ELT_CHAIN_MUL_SCALAR);
+        if (is_pending && !is_scalar) {
+            stages.push_back({PimCmdType::MAD, 0});
+            is_pending = false;
+        }
+        if (i == num_steps) break;
+
+        switch (steps[i].op_type) {
+            case ELT_CHAIN_ADD:
+            case ELT_CHAIN_MUL:
+                if (program->num_operand == ELT_CHAIN_MAX_OPERANDS) {
+                    DLOG(ERROR) << "elt chain supports up to " << ELT_CHAIN_MAX_OPERANDS << " vector operands";
+                    return -1;
+                }
+                program->num_operand++;
+                stages.push_back(
+                    {steps[i].op_type == ELT_CHAIN_ADD ? PimCmdType::ADD : PimCmdType::MUL, program->num_operand});
+                break;
+            case ELT_CHAIN_ADD_SCALAR:
+            case ELT_CHAIN_MUL_SCALAR:
+                if (!is_pending && program->use_srf) {
+                    DLOG(ERROR) << "scalar steps of an elt chain have to be adjacent";
+                    return -1;
+                }
+                if (steps[i].op_type == ELT_CHAIN_MUL_SCALAR) {
+                    scale *= fp16_to_float(steps[i].scalar);
+                    shift *= fp16_to_float(steps[i].scalar);
+                } else {
+                    shift += fp16_to_float(steps[i].scalar);
+                }
+                is_pending = true;
+                program->use_srf = true;
+                break;
+            case ELT_CHAIN_RELU:
+                stages.push_back({PimCmdType::MOV, 0});
+                break;
+            default:
+                DLOG(ERROR) << "unknown elt chain step " << steps[i].op_type;
+                return -1;
+        }
+    }
+    program->scale = float_to_fp16(scale);
+    program->shift = float_to_fp16(shift);
+
+    /* even half: the first stage loads the bank, later stages work on GRF_A */
+    PimCrfScheduler scheduler;
+    std::vector<PimCommand> half_cmds;
+    bool is_loaded = false;
+    int ret = 0;
+    for (size_t i = 0; i < stages.size() && ret == 0; i++) {
+        PimOpdType src = is_loaded ? PimOpdType::GRF_A : PimOpdType::EVEN_BANK;
+        if (stages[i].type == PimCmdType::ADD || stages[i].type == PimCmdType::MUL) {
+            if (!is_loaded) {
+                half_cmds.push_back(PimCommand(PimCmdType::FILL, PimOpdType::GRF_A, PimOpdType::EVEN_BANK, 1));
+                ret = push_elt_chain_cmd(&scheduler, program, half_cmds.back(), 0);
+            }
+            if (ret == 0) {
+                half_cmds.push_back(
+                    PimCommand(stages[i].type, PimOpdType::GRF_A, PimOpdType::GRF_A, PimOpdType::EVEN_BANK, 1));
+                ret = push_elt_chain_cmd(&scheduler, program, half_cmds.back(), stages[i].src);
+            }
+        } else if (stages[i].type == PimCmdType::MAD) {
+            half_cmds.push_back(
+                PimCommand(PimCmdType::MAD, PimOpdType::GRF_A, src, PimOpdType::SRF_M, PimOpdType::SRF_A, 1));
+            ret = push_elt_chain_cmd(&scheduler, program, half_cmds.back(), 0);
+        } else {
+            PimCmdType type = is_loaded ? PimCmdType::MOV : PimCmdType::FILL;
+            half_cmds.push_back(PimCommand(type, PimOpdType::GRF_A, src, 1, 0, 0, 0, 1));
+            ret = push_elt_chain_cmd(&scheduler, program, half_cmds.back(), 0);
+        }
+        is_loaded = true;
+    }
+    if (ret != 0 || stages.empty()) {
+        DLOG(ERROR) << "fail to create elt chain program";
+        return -1;
+    }
+    if (program->stmt_src.size() > ELT_CHAIN_MAX_STATEMENTS) {
+        DLOG(ERROR) << "elt chain needs " << program->stmt_src.size() << " statements per bank half";
+        return -1;
+    }
+
+    /* W, W and R of the output per half, the kernel replays the even statements on the odd bank */
+    PimEltChainProgram odd_half;
+    scheduler.push_nop(3 * pbi_->num_grf);
+    for (auto cmd : half_cmds) {
+        cmd.dst_ = to_odd_half(cmd.dst_);
+        cmd.src0_ = to_odd_half(cmd.src0_);
+        cmd.src1_ = to_odd_half(cmd.src1_);
+        if (push_elt_chain_cmd(&scheduler, &odd_half, cmd, 0) != 0) return -1;
+    }
+    if (odd_half.stmt_cols != program->stmt_cols) {
+        DLOG(ERROR) << "odd half of the elt chain needs other hazard NOPs than the even half";
+        return -1;
+    }
+    scheduler.push_nop(3 * pbi_->num_grf);
+
+    if (scheduler.finish(lc, &program->cmds) != 0) {
+        DLOG(ERROR) << "elt chain program violates the ISA rules";
+        return -1;
+    }
+
+    if (program->cmds.size() * sizeof(uint32_t) > max_crf_size_) {
+        DLOG(ERROR) << "elt chain program of " << program->cmds.size() << " commands does not fit in the CRF";
+        return -1;
+    }
+
+    DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
+    return 0;
+}
+
+uint8_t* PimCrfBinGen::get_elt_chain_crf(const PimEltChainStep* steps, int num_steps, int data_size,
+                                         PimEltChainProgram* program, int* crf_size)
+{
+    DLOG(INFO) << "[START] " << __FUNCTION__ << " called";
+    int lc = get_loop_counter(OP_ELT_CHAIN, data_size);
+    std::lock_guard<std::mutex> lock(crf_lut_mutex_);
+    if (create_elt_chain_cmd(steps, num_steps, lc, program) != 0) return nullptr;
+
+    std::string key(program->cmds.size() * sizeof(uint32_t), '\0');
+    cmds_.assign(program->cmds.begin(), program->cmds.end());
+    change_to_binary((uint8_t*)&key[0], crf_size);
+
+    uint8_t* d_crf = nullptr;
+    auto found = elt_chain_crf_lut_.find(key);
+    if (found != elt_chain_crf_lut_.end()) {
+        d_crf = found->second;
+    } else {
+        pim_manager_->alloc_memory((void**)&d_crf, max_crf_size_, MEM_TYPE_DEVICE);
+        pim_manager_->copy_memory((void*)d_crf, (void*)key.data(), *crf_size, HOST_TO_DEVICE);
+        elt_chain_crf_lut_.insert(std::make_pair(key, d_crf));
+    }
+
+    DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
+    return d_crf;
+}
+
 int PimCrfBinGen::get_loop_counter(PimOpType op_type, int input_size)
 {
     int lc = 0;
@@ -203,19 +612,156 @@ int PimCrfBinGen::get_loop_counter(PimOpType op_type, int input_size)
     return lc;
 }
 
+int PimCrfBinGen::update_op_info(PimOpType op_type)
+{
+    int num_grf = pbi_->num_grf;
+    int num_nop_cycle = 0;
+    PimOpStmtArgs args;
+
+    /* GEMV kernels program their fixed loop nest */
+    if (op_type == OP_GEMV) return 0;
+
+    /* only a JUMP depends on the loop counter, and a body which runs once has none */
+    create_pim_cmd(op_type, 0);
+    crf_size_[op_type][0] = cmds_.size() * sizeof(uint32_t);
+    create_pim_cmd(op_type, 1);
+    crf_size_[op_type][1] = cmds_.size() * sizeof(uint32_t);
+
+    /*
+     * NOP cycles in multiples of eight ahead of the odd half are write backs the kernel drives with its own W and
+     * R commands, BN writes both halves at the end. The rest are hazard NOPs read in statements of the half of the
+     * next instruction, one per eight cycles.
+     */
+    memset(&args, 0, sizeof(args));
+    args.num_even_stmt = -1;
+    for (auto& cmd : cmds_) {
+        if (cmd.type_ == PimCmdType::EXIT) break;
+        if (cmd.type_ == PimCmdType::JUMP) continue;
+        if (cmd.type_ == PimCmdType::NOP) {
+            num_nop_cycle += cmd.loop_counter_ + 1;
+            continue;
+        }
+        bool is_odd_start = args.num_even_stmt < 0 && cmd.dst_ == PimOpdType::GRF_B;
+        if (is_odd_start) args.num_even_stmt = args.num_stmt;
+        if (is_odd_start && op_type != OP_BN) num_nop_cycle %= num_grf;
+        if (args.num_stmt + (num_nop_cycle + num_grf - 1) / num_grf + 1 > PIM_OP_MAX_STATEMENTS) {
+            DLOG(ERROR) << "program of " << get_pim_op_string(op_type) << " needs too many statements";
+            return -1;
+        }
+        for (; num_nop_cycle > 0; num_nop_cycle -= num_grf) {
+            args.stmt_cols[args.num_stmt++] = std::min(num_nop_cycle, num_grf);
+        }
+        num_nop_cycle = 0;
+        bool is_second_vector = cmd.src1_ == PimOpdType::EVEN_BANK || cmd.src1_ == PimOpdType::ODD_BANK;
+        args.stmt_src[args.num_stmt] = is_second_vector ? 1 : 0;
+        args.stmt_cols[args.num_stmt++] = num_grf;
+    }
+    if (args.num_even_stmt < 0) args.num_even_stmt = args.num_stmt;
+    stmt_args_[op_type] = args;
+
+    return 0;
+}
+
+int PimCrfBinGen::get_crf_size(PimOpType op_type, int data_size)
+{
+    return crf_size_[op_type][get_loop_counter(op_type, data_size) > 0];
+}
+
+int PimCrfBinGen::set_crf_program(PimOpType op_type, const PimCrfProgram& program)
+{
+    DLOG(INFO) << "[START] " << __FUNCTION__ << " called";
+    int crf_size = 0;
+
+    if (op_type < 0 || op_type >= OP_DUMMY || op_type == OP_GEMM || op_type == OP_ELT_CHAIN) {
+        DLOG(ERROR) << "CRF program of " << get_pim_op_string(op_type) << " can not be replaced";
+        return -1;
+    }
+    if (program.cmds.empty() || program.cmds.size() * sizeof(uint32_t) > max_crf_size_) {
+        DLOG(ERROR) << "CRF program of " << program.cmds.size() << " commands does not fit in the CRF";
+        return -1;
+    }
+
+    std::lock_guard<std::mutex> lock(crf_lut_mutex_);
+    /* the statements are derived before anything else changes, a program the kernel can not drive is dropped */
+    auto loaded = crf_programs_.find(op_type);
+    bool is_loaded = loaded != crf_programs_.end();
+    PimCrfProgram prev_program = is_loaded ? loaded->second : PimCrfProgram();
+    int prev_crf_size[2] = {crf_size_[op_type][0], crf_size_[op_type][1]};
+    crf_programs_[op_type] = program;
+    if (update_op_info(op_type) != 0) {
+        DLOG(ERROR) << "CRF program of " << get_pim_op_string(op_type) << " can not be driven by its kernel";
+        if (is_loaded)
+            crf_programs_[op_type] = prev_program;
+        else
+            crf_programs_.erase(op_type);
+        crf_size_[op_type][0] = prev_crf_size[0];
+        crf_size_[op_type][1] = prev_crf_size[1];
+        return -1;
+    }
+    crf_version_++;
+
+    for (auto it = crf_lut_.begin(); it != crf_lut_.end();) {
+        if (it->first.first == op_type) {
+            pim_manager_->free_memory((void*)it->second, MEM_TYPE_DEVICE);
+            it = crf_lut_.erase(it);
+        } else {
+            it++;
+        }
+    }
+
+    /* the arena row of the op is rewritten in place with a single copy, no kernel reads it while the device is idle */
+    int row = op_type < 0 ? -1 : arena_row_[op_type];
+    if (crf_arena_ != nullptr && row >= 0) {
+        int num_lc = arena_max_lc_ - CRF_ARENA_MIN_LC + 1;
+        size_t row_size = (size_t)num_lc * max_crf_size_;
+        std::vector<uint8_t> h_row(row_size, 0);
+        for (int lc = CRF_ARENA_MIN_LC; lc <= arena_max_lc_; lc++) {
+            gen_binary_with_loop(op_type, lc, &h_row[(size_t)(lc - CRF_ARENA_MIN_LC) * max_crf_size_], &crf_size);
+        }
+        pim_manager_->copy_memory((void*)(crf_arena_ + row * row_size), (void*)h_row.data(), row_size,
+                                  HOST_TO_DEVICE);
+    }
+
+    DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
+    return 0;
+}
+
+uint8_t* PimCrfBinGen::find_arena_crf(PimOpType op_type, int lc)
+{
+    if (crf_arena_ == nullptr || op_type < 0 || op_type > OP_DUMMY) return nullptr;
+
+    int row = arena_row_[op_type];
+    if (row < 0 || lc < CRF_ARENA_MIN_LC || lc > arena_max_lc_) return nullptr;
+
+    int num_lc = arena_max_lc_ - CRF_ARENA_MIN_LC + 1;
+    return crf_arena_ + ((size_t)row * num_lc + (lc - CRF_ARENA_MIN_LC)) * max_crf_size_;
+}
+
 void* PimCrfBinGen::make_crf_bin(PimOpType op_type, int data_size)
 {
     DLOG(INFO) << "[START] " << __FUNCTION__ << " called";
-    uint8_t* h_crf = new uint8_t[max_crf_size_];
-    uint8_t* d_crf;
+    int lc = get_loop_counter(op_type, data_size);
+    uint8_t* d_crf = find_arena_crf(op_type, lc);
+    if (d_crf != nullptr) {
+        DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
+        return (void*)d_crf;
+    }
+
+    std::lock_guard<std::mutex> lock(crf_lut_mutex_);
+    auto found = crf_lut_.find(std::make_pair(op_type, lc));
+    if (found != crf_lut_.end()) {
+        DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
+        return (void*)found->second;
+    }
+
+    uint8_t* h_crf = new uint8_t[max_crf_size_]();
     int crf_size;
     pim_manager_->alloc_memory((void**)&d_crf, max_crf_size_, MEM_TYPE_DEVICE);
 
-    int lc = get_loop_counter(op_type, data_size);
     gen_binary_with_loop(op_type, lc, h_crf, &crf_size);
 
     pim_manager_->copy_memory((void*)d_crf, (void*)h_crf, max_crf_size_, HOST_TO_DEVICE);
-    crf_lut_.insert(std::make_pair(std::make_pair(op_type, data_size), d_crf));
+    crf_lut_.insert(std::make_pair(std::make_pair(op_type, lc), d_crf));
     delete[] h_crf;
 
     DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
@@ -225,12 +771,20 @@ void* PimCrfBinGen::make_crf_bin(PimOpType op_type, int data_size)
 uint8_t* PimCrfBinGen::find_crf(PimOpType op_type, int data_size)
 {
     DLOG(INFO) << "[START] " << __FUNCTION__ << " called";
-    uint8_t* addr = nullptr;
+    int lc = get_loop_counter(op_type, data_size);
 
-    std::map<std::pair<PimOpType, int>, uint8_t*>::const_iterator found =
-        crf_lut_.find(std::make_pair(op_type, data_size));
-    if (found != crf_lut_.end()) {
-        addr = found->second;
+    /*
+     * the arena address and rows are fixed after initialize, so steady state lookups take no lock.
+     * only set_crf_program rewrites arena contents, and it runs while no launch is in flight.
+     */
+    uint8_t* addr = find_arena_crf(op_type, lc);
+    if (addr == nullptr) {
+        std::lock_guard<std::mutex> lock(crf_lut_mutex_);
+        std::map<std::pair<PimOpType, int>, uint8_t*>::const_iterator found =
+            crf_lut_.find(std::make_pair(op_type, lc));
+        if (found != crf_lut_.end()) {
+            addr = found->second;
+        }
     }
 
     DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
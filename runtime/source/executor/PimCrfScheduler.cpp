@@ -0,0 +1,95 @@
+/*
+ * Copyright (C) 2022 Samsung Electronics Co. LTD
+ *
+ * This software is a property of Samsung Electronics.
+ * No part of this software, either material or conceptual may be copied or distributed, transmitted,
+ * transcribed, stored in a retrieval system or translated into any human or computer language in any form by any means,
+ * electronic, mechanical, manual or otherwise, or disclosed
+ * to third parties without the express written permission of Samsung Electronics.
+ * (Use of the Software is restricted to non-commercial, personal or academic, research purpose only)
+ */
+
+#include "executor/PimCrfScheduler.h"
+#include "utility/pim_log.h"
+
+namespace pim
+{
+namespace runtime
+{
+namespace executor
+{
+/* the checker does not look for hazards across four or more NOP cycles */
+PimCrfScheduler::PimCrfScheduler(void) : max_hazard_cycle_(4) {}
+PimCrfScheduler::~PimCrfScheduler(void) {}
+void PimCrfScheduler::clear(void) { cmds_.clear(); }
+void PimCrfScheduler::append_nop(std::vector<PimCommand>* cmds, int num_cycle)
+{
+    if (num_cycle <= 0) return;
+
+    /* two consecutive multicycle NOPs are not supported, so adjacent cycles share one NOP */
+    if (!cmds->empty() && cmds->back().type_ == PimCmdType::NOP) {
+        cmds->back().loop_counter_ += num_cycle;
+    } else {
+        cmds->push_back(PimCommand(PimCmdType::NOP, num_cycle - 1));
+    }
+}
+
+int PimCrfScheduler::push_cmd(const PimCommand& cmd)
+{
+    for (int num_cycle = 0; num_cycle <= max_hazard_cycle_; num_cycle++) {
+        std::vector<PimCommand> trial(cmds_);
+        append_nop(&trial, num_cycle);
+        trial.push_back(cmd);
+        if (validator_.check_hazard(trial) == 0) {
+            cmds_.swap(trial);
+            return num_cycle;
+        }
+    }
+
+    DLOG(ERROR) << "hazard before ( " << cmd.to_str() << " ) can not be resolved";
+    return -1;
+}
+
+void PimCrfScheduler::push_nop(int num_cycle) { append_nop(&cmds_, num_cycle); }
+int PimCrfScheduler::finish(int lc, std::vector<PimCommand>* cmds)
+{
+    DLOG(INFO) << "[START] " << __FUNCTION__ << " called";
+    cmds->assign(cmds_.begin(), cmds_.end());
+
+    /* a loop counter of zero is not allowed, a body which runs once needs no JUMP at all */
+    if (lc > 0) {
+        /* JUMP can not follow a multicycle NOP, so its last cycle is split off */
+        if (!cmds->empty() && cmds->back().type_ == PimCmdType::NOP && cmds->back().loop_counter_ > 0) {
+            cmds->back().loop_counter_--;
+            cmds->push_back(PimCommand(PimCmdType::NOP, 0));
+        }
+        cmds->push_back(PimCommand(PimCmdType::JUMP, lc, cmds->size() + 1));
+    }
+    cmds->push_back(PimCommand(PimCmdType::EXIT, 0));
+
+    int nop_cnt = (8 - cmds->size() % 8) % 8;
+    for (int i = 0; i < nop_cnt; i++) cmds->push_back(PimCommand(PimCmdType::NOP, 0));
+
+    int ret = validator_.validate(*cmds);
+
+    DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
+    return ret;
+}
+
+int PimCrfScheduler::get_num_cycle(void)
+{
+    int num_cycle = 0;
+
+    for (auto& cmd : cmds_) {
+        if (cmd.type_ == PimCmdType::NOP) {
+            num_cycle += cmd.loop_counter_ + 1;
+        } else if (cmd.type_ != PimCmdType::JUMP && cmd.type_ != PimCmdType::EXIT) {
+            /* an auto command runs once for each of the eight GRF indices */
+            num_cycle += cmd.is_auto_ ? 8 : 1;
+        }
+    }
+    return num_cycle;
+}
+} /* namespace executor */
+} /* namespace runtime */
+} /* namespace pim */
@@ -0,0 +1,329 @@
+/*
+ * Copyright (C) 2022 Samsung Electronics Co. LTD
+ *
+ * This software is a property of Samsung Electronics.
+ * No part of this software, either material or conceptual may be copied or distributed, transmitted,
+ * transcribed, stored in a retrieval system or translated into any human or computer language in any form by any means,
+ * electronic, mechanical, manual or otherwise, or disclosed
+ * to third parties without the express written permission of Samsung Electronics.
+ * (Use of the Software is restricted to non-commercial, personal or academic, research purpose only)
+ */
+
+#include "executor/PimCrfValidator.h"
+#include <algorithm>
+#include "utility/pim_log.h"
+
+namespace pim
+{
+namespace runtime
+{
+namespace executor
+{
+namespace
+{
+enum PimCamType { CAM_INVALID, CAM_ALL, CAM_ONLY, CAM_NONE };
+
+/* [src0][src1][MUL, ADD, MAC, MAD], operands in GRF_A, GRF_B, EVEN_BANK, ODD_BANK, SRF_M, SRF_A order */
+const int src_pair_table[6][6][4] = {
+    {{0, 0, 0, 0}, {1, 1, 2, 1}, {1, 1, 1, 1}, {1, 1, 1, 1}, {0, 0, 0, 1}, {0, 1, 0, 0}},
+    {{1, 1, 2, 1}, {0, 0, 0, 0}, {1, 1, 2, 1}, {1, 1, 2, 1}, {0, 0, 2, 1}, {0, 1, 0, 0}},
+    {{1, 1, 1, 0}, {1, 1, 2, 1}, {1, 1, 1, 3}, {0, 0, 0, 0}, {0, 0, 0, 1}, {0, 1, 0, 0}},
+    {{1, 1, 1, 0}, {1, 1, 2, 1}, {0, 0, 0, 0}, {1, 1, 1, 3}, {0, 0, 0, 1}, {0, 1, 0, 0}},
+    {{0, 0, 0, 0}, {0, 0, 2, 0}, {0, 0, 0, 0}, {0, 0, 0, 0}, {0, 0, 0, 0}, {0, 0, 0, 0}},
+    {{0, 1, 0, 0}, {0, 1, 0, 0}, {0, 1, 0, 0}, {0, 1, 0, 0}, {0, 0, 0, 0}, {0, 0, 0, 0}}};
+
+/* [reads a register][ADD, MUL, MAC, MAD, FILL/MOV] */
+const int data_hazard_table[2][5] = {
+    {1, 1, -1, -1, 0},
+    {2, 2, 3, 3, 1},
+};
+
+/* [same dst][!reads register of cur * 2 + !reads register of next][next op][cur op] */
+const int structural_hazard_table[2][4][5][5] = {
+    {{{1, 1, 1, 2, 0}, {1, 1, 1, 2, 0}, {0, 0, 0, 1, 0}, {0, 0, 1, 1, 0}, {3, 3, 3, 4, 1}},
+     {{2, 2, 2, 3, 0}, {2, 2, 2, 3, 0}, {-1, -1, -1, -1, -1}, {-1, -1, -1, -1, -1}, {3, 3, 3, 4, 1}},
+     {{0, 0, -1, -1, 0}, {0, 0, -1, -1, 0}, {0, 0, -1, -1, 0}, {0, 0, -1, -1, 0}, {2, 2, -1, -1, 1}},
+     {{1, 1, -1, -1, 0}, {1, 1, -1, -1, 0}, {-1, -1, -1, -1, -1}, {-1, -1, -1, -1, -1}, {2, 2, -1, -1, 1}}},
+
+    {{{0, 0, 1, 1, 0}, {0, 0, 1, 1, 0}, {0, 0, 0, 0, 0}, {0, 0, 1, 0, 0}, {2, 2, 3, 3, 0}},
+     {{1, 1, 2, 2, 0}, {1, 1, 2, 2, 0}, {-1, -1, -1, -1, -1}, {-1, -1, -1, -1, -1}, {2, 2, 3, 3, 0}},
+     {{0, 0, -1, -1, 0}, {0, 0, -1, -1, 0}, {0, 0, -1, -1, 0}, {0, 0, -1, -1, 0}, {1, 1, -1, -1, 0}},
+     {{0, 0, -1, -1, 0}, {0, 0, -1, -1, 0}, {-1, -1, -1, -1, -1}, {-1, -1, -1, -1, -1}, {1, 1, -1, -1, 0}}}};
+
+int get_pair_cmd_idx(PimCmdType type)
+{
+    switch (type) {
+        case PimCmdType::MUL:
+            return 0;
+        case PimCmdType::ADD:
+            return 1;
+        case PimCmdType::MAC:
+            return 2;
+        case PimCmdType::MAD:
+            return 3;
+        default:
+            return -1;
+    }
+}
+
+int get_pair_opd_idx(PimOpdType opd)
+{
+    switch (opd) {
+        case PimOpdType::GRF_A:
+            return 0;
+        case PimOpdType::GRF_B:
+            return 1;
+        case PimOpdType::EVEN_BANK:
+            return 2;
+        case PimOpdType::ODD_BANK:
+            return 3;
+        case PimOpdType::SRF_M:
+            return 4;
+        case PimOpdType::SRF_A:
+            return 5;
+        default:
+            return -1;
+    }
+}
+} /* namespace */
+
+PimCrfValidator::PimCrfValidator(void) {}
+PimCrfValidator::~PimCrfValidator(void) {}
+
+int PimCrfValidator::validate(const std::vector<PimCommand>& cmds)
+{
+    DLOG(INFO) << "[START] " << __FUNCTION__ << " called";
+    int ret = 0;
+
+    if (cmds.empty()) {
+        DLOG(ERROR) << "CRF program is empty";
+        return -1;
+    }
+    if (check_cmd_validation(cmds) != 0) ret = -1;
+    if (check_isa_restriction(cmds) != 0) ret = -1;
+
+    int num_hazard = check_hazard(cmds);
+    if (num_hazard != 0) {
+        DLOG(ERROR) << num_hazard << " hazards in the CRF program";
+        ret = -1;
+    }
+
+    DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
+    return ret;
+}
+
+int PimCrfValidator::check_cmd_validation(const std::vector<PimCommand>& cmds)
+{
+    int ret = 0;
+
+    for (auto& cmd : cmds) {
+        if (check_validate_pair(cmd) != 0) ret = -1;
+    }
+    return ret;
+}
+
+int PimCrfValidator::check_validate_pair(const PimCommand& cmd)
+{
+    int i_cmd = get_pair_cmd_idx(cmd.type_);
+    if (i_cmd == -1) return 0;
+
+    int ret = 0;
+    int i_src0 = get_pair_opd_idx(cmd.src0_);
+    int i_src1 = get_pair_opd_idx(cmd.src1_);
+    int cam_type = (i_src0 == -1 || i_src1 == -1) ? CAM_INVALID : src_pair_table[i_src0][i_src1][i_cmd];
+
+    if (cam_type == CAM_INVALID) {
+        DLOG(ERROR) << "( " << cmd.to_str() << " ) - this operation does not support the src pair";
+        ret = -1;
+    }
+    if (cam_type == CAM_ONLY && !cmd.is_auto_) {
+        DLOG(ERROR) << "( " << cmd.to_str() << " ) - this operation and src pair support only CAM mode";
+        ret = -1;
+    }
+    if (cam_type == CAM_NONE && cmd.is_auto_) {
+        DLOG(ERROR) << "( " << cmd.to_str() << " ) - this operation and src pair do not support CAM mode";
+        ret = -1;
+    }
+    if (cmd.src2_ != PimOpdType::SRF_A && cmd.src2_ != PimOpdType::A_OUT) {
+        DLOG(ERROR) << "( " << cmd.to_str() << " ) - src2 can only be SRF_A";
+        ret = -1;
+    }
+    if (cmd.src2_ == PimOpdType::SRF_A && cmd.type_ != PimCmdType::MAD) {
+        DLOG(ERROR) << "( " << cmd.to_str() << " ) - src2 is used only by MAD";
+        ret = -1;
+    }
+    if (cmd.type_ == PimCmdType::MAC && cmd.dst_ == PimOpdType::GRF_A) {
+        DLOG(ERROR) << "( " << cmd.to_str() << " ) - MAC can not use GRF_A as dst";
+        ret = -1;
+    }
+    if (cmd.dst_ != PimOpdType::GRF_A && cmd.dst_ != PimOpdType::GRF_B) {
+        DLOG(ERROR) << "( " << cmd.to_str() << " ) - dst can only be GRF_A or GRF_B";
+        ret = -1;
+    }
+    return ret;
+}
+
+int PimCrfValidator::check_isa_restriction(const std::vector<PimCommand>& cmds)
+{
+    int last_idx = (int)cmds.size() - 1;
+    int ret = 0;
+
+    if (cmds[0].type_ == PimCmdType::NOP) {
+        DLOG(ERROR) << "NOP can not be the first command";
+        ret = -1;
+    }
+
+    for (int i = 0; i <= last_idx; i++) {
+        if (cmds[i].type_ == PimCmdType::JUMP) {
+            int target = i - cmds[i].loop_offset_ + 1;
+            if (cmds[i].loop_counter_ == 0) {
+                DLOG(ERROR) << "JUMP loop counter can not be zero";
+                ret = -1;
+            }
+            if (target < 0) {
+                DLOG(ERROR) << "JUMP at " << i << " is out of range";
+                ret = -1;
+                continue;
+            }
+            if (cmds[target].type_ == PimCmdType::NOP || cmds[target].type_ == PimCmdType::JUMP) {
+                DLOG(ERROR) << "JUMP target can not be JUMP or NOP";
+                ret = -1;
+            }
+            if (i != last_idx && cmds[i + 1].type_ == PimCmdType::NOP) {
+                DLOG(ERROR) << "NOP can not come immediately after JUMP";
+                ret = -1;
+            }
+        }
+
+        if (cmds[i].type_ == PimCmdType::NOP && cmds[i].loop_counter_ > 0 && i != last_idx) {
+            if (cmds[i + 1].type_ == PimCmdType::JUMP) {
+                DLOG(ERROR) << "JUMP can not come immediately after a multicycle NOP";
+                ret = -1;
+            }
+            if (cmds[i + 1].type_ == PimCmdType::NOP && cmds[i + 1].loop_counter_ > 0) {
+                DLOG(ERROR) << "two consecutive multicycle NOPs are not supported";
+                ret = -1;
+            }
+        }
+    }
+    return ret;
+}
+
+void PimCrfValidator::find_next_op(const std::vector<PimCommand>& cmds, int cur_idx, int* next_idx, int* num_nop)
+{
+    for (int i = cur_idx + 1; i < (int)cmds.size(); i++) {
+        if (cmds[i].type_ == PimCmdType::NOP) {
+            *num_nop += cmds[i].loop_counter_ + 1;
+        }
+        if (get_hazard_table_idx(cmds[i]) != -1) {
+            *next_idx = i;
+            break;
+        }
+    }
+}
+
+int PimCrfValidator::check_hazard(const std::vector<PimCommand>& cmds)
+{
+    int max_nop = 4;
+    int num_hazard = 0;
+
+    for (int i = 0; i < (int)cmds.size(); i++) {
+        int next_idx = 0;
+        int num_nop = 0;
+
+        if (get_hazard_table_idx(cmds[i]) == -1) continue;
+
+        find_next_op(cmds, i, &next_idx, &num_nop);
+        if (next_idx == 0) break;
+
+        if (num_nop >= max_nop) {
+            i = next_idx - 1;
+            continue;
+        }
+
+        if (detect_structural_hazard(cmds, i, next_idx, num_nop) != 0) num_hazard++;
+        if (detect_data_hazard(cmds, i, next_idx, num_nop) != 0) num_hazard++;
+    }
+    return num_hazard;
+}
+
+int PimCrfValidator::detect_structural_hazard(const std::vector<PimCommand>& cmds, int cur_idx, int next_idx,
+                                              int num_nop)
+{
+    int cur_op_idx = get_hazard_table_idx(cmds[cur_idx]);
+    int next_op_idx = get_hazard_table_idx(cmds[next_idx]);
+    int is_consecutive = cmds[cur_idx].dst_ == cmds[next_idx].dst_;
+    int r_nonr_idx = !is_read_register(cmds[cur_idx]) * 2 + !is_read_register(cmds[next_idx]);
+    int num_required_nop = structural_hazard_table[is_consecutive][r_nonr_idx][next_op_idx][cur_op_idx];
+
+    /* -1 marks a combination which is not supported at all */
+    if (num_required_nop == -1) return -1;
+    if (num_nop < num_required_nop) return 1;
+
+    return 0;
+}
+
+int PimCrfValidator::detect_data_hazard(const std::vector<PimCommand>& cmds, int cur_idx, int next_idx, int num_nop)
+{
+    const PimCommand& cur = cmds[cur_idx];
+    int num_required_nop = data_hazard_table[is_read_register(cur)][get_hazard_table_idx(cur)];
+    int max_idx = std::min(cur_idx + num_required_nop + 1, (int)cmds.size());
+
+    for (int i = next_idx; i < max_idx && num_nop < num_required_nop; i++) {
+        bool is_dependent = false;
+        if (cur.is_auto_ || cmds[i].is_auto_) {
+            is_dependent = cur.dst_ == cmds[i].src0_ || cur.dst_ == cmds[i].src1_;
+        } else {
+            is_dependent = (cur.dst_ == cmds[i].src0_ && cur.dst_idx_ == cmds[i].src0_idx_) ||
+                           (cur.dst_ == cmds[i].src1_ && cur.dst_idx_ == cmds[i].src1_idx_);
+        }
+        if (is_dependent) return 1;
+
+        /* an auto instruction occupies all eight GRF indices */
+        num_nop += 1 + cmds[i].is_auto_ * 7;
+    }
+    return 0;
+}
+
+int PimCrfValidator::get_hazard_table_idx(const PimCommand& cmd)
+{
+    switch (cmd.type_) {
+        case PimCmdType::ADD:
+            return 0;
+        case PimCmdType::MUL:
+            return 1;
+        case PimCmdType::MAC:
+            return 2;
+        case PimCmdType::MAD:
+            return 3;
+        case PimCmdType::FILL:
+        case PimCmdType::MOV:
+            return 4;
+        default:
+            return -1;
+    }
+}
+
+int PimCrfValidator::is_register(PimOpdType opd_type)
+{
+    switch (opd_type) {
+        case PimOpdType::GRF_A:
+        case PimOpdType::GRF_B:
+        case PimOpdType::SRF_M:
+        case PimOpdType::SRF_A:
+            return 1;
+        default:
+            return 0;
+    }
+}
+
+int PimCrfValidator::is_read_register(const PimCommand& cmd)
+{
+    if (is_register(cmd.src0_) || is_register(cmd.src1_) || is_register(cmd.src2_) || cmd.type_ == PimCmdType::MAC)
+        return 1;
+
+    return 0;
+}
+} /* namespace executor */
+} /* namespace runtime */
+} /* namespace pim */
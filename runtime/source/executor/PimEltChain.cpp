@@ -0,0 +1,87 @@
+/*
+ * Copyright (C) 2022 Samsung Electronics Co. LTD
+ *
+ * This software is a property of Samsung Electronics.
+ * No part of this software, either material or conceptual may be copied or distributed, transmitted,
+ * transcribed, stored in a retrieval system or translated into any human or computer language in any form by any means,
+ * electronic, mechanical, manual or otherwise, or disclosed
+ * to third parties without the express written permission of Samsung Electronics.
+ * (Use of the Software is restricted to non-commercial, personal or academic, research purpose only)
+ */
+
+#include "executor/PimEltChain.h"
+#include "executor/IPimExecutor.h"
+#include "utility/pim_log.h"
+
+namespace pim
+{
+namespace runtime
+{
+namespace executor
+{
+int check_elt_chain(PimBo* output, PimBo* input, const PimEltChainStep* steps, int num_steps)
+{
+    if (output == nullptr || input == nullptr || steps == nullptr || num_steps <= 0) {
+        DLOG(ERROR) << "invalid elt chain";
+        return -1;
+    }
+    if (input->size < output->size) {
+        DLOG(ERROR) << "elt chain input is smaller than the output";
+        return -1;
+    }
+
+    for (int i = 0; i < num_steps; i++) {
+        switch (steps[i].op_type) {
+            case ELT_CHAIN_ADD:
+            case ELT_CHAIN_MUL:
+                if (steps[i].operand == nullptr || steps[i].operand->size < output->size) {
+                    DLOG(ERROR) << "invalid vector operand at elt chain step " << i;
+                    return -1;
+                }
+                break;
+            case ELT_CHAIN_ADD_SCALAR:
+            case ELT_CHAIN_MUL_SCALAR:
+            case ELT_CHAIN_RELU:
+                break;
+            default:
+                DLOG(ERROR) << "unknown elt chain step " << steps[i].op_type;
+                return -1;
+        }
+    }
+    return 0;
+}
+
+int execute_elt_chain_steps(IPimExecutor* executor, PimBo* output, PimBo* input, const PimEltChainStep* steps,
+                            int num_steps, void* stream, bool block)
+{
+    DLOG(INFO) << "[START] " << __FUNCTION__ << " called";
+    int ret = check_elt_chain(output, input, steps, num_steps);
+
+    for (int i = 0; i < num_steps && ret == 0; i++) {
+        PimBo* src = (i == 0) ? input : output;
+        switch (steps[i].op_type) {
+            case ELT_CHAIN_ADD:
+                ret = executor->execute_add(output, src, steps[i].operand, stream, false);
+                break;
+            case ELT_CHAIN_MUL:
+                ret = executor->execute_mul(output, src, steps[i].operand, stream, false);
+                break;
+            case ELT_CHAIN_ADD_SCALAR:
+                ret = executor->execute_add_scalar(output, steps[i].scalar, src, stream, false);
+                break;
+            case ELT_CHAIN_MUL_SCALAR:
+                ret = executor->execute_mul_scalar(output, steps[i].scalar, src, stream, false);
+                break;
+            case ELT_CHAIN_RELU:
+                ret = executor->execute_relu(output, src, stream, false);
+                break;
+        }
+    }
+    if (ret == 0 && block) ret = executor->execute_sync(stream);
+
+    DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
+    return ret;
+}
+} /* namespace executor */
+} /* namespace runtime */
+} /* namespace pim */
@@ -0,0 +1,97 @@
+/*
+ * Copyright (C) 2022 Samsung Electronics Co. LTD
+ *
+ * This software is a property of Samsung Electronics.
+ * No part of this software, either material or conceptual may be copied or distributed, transmitted,
+ * transcribed, stored in a retrieval system or translated into any human or computer language in any form by any means,
+ * electronic, mechanical, manual or otherwise, or disclosed
+ * to third parties without the express written permission of Samsung Electronics.
+ * (Use of the Software is restricted to non-commercial, personal or academic, research purpose only)
+ */
+
+#include "executor/PimGraph.h"
+#include "executor/IPimExecutor.h"
+#include "utility/pim_debug.hpp"
+#include "utility/pim_log.h"
+
+namespace pim
+{
+namespace runtime
+{
+namespace executor
+{
+PimGraphNode make_graph_node(PimOpType op_type, PimBo* output, PimBo* operand0, PimBo* operand1)
+{
+    PimGraphNode node = {};
+    node.op_type = op_type;
+    node.output = output;
+    node.operand0 = operand0;
+    node.operand1 = operand1;
+    node.act_func = NONE;
+    node.gemm_order = I_X_W;
+    return node;
+}
+
+int execute_graph_node(IPimExecutor* executor, const PimGraphNode& node, void* stream)
+{
+    int ret = 0;
+
+    switch (node.op_type) {
+        case OP_ELT_ADD:
+            ret = executor->execute_add(node.output, node.operand0, node.operand1, stream, false);
+            break;
+        case OP_ELT_MUL:
+            ret = executor->execute_mul(node.output, node.operand0, node.operand1, stream, false);
+            break;
+        case OP_ELT_ADD_SCALAR:
+            ret = executor->execute_add_scalar(node.output, node.scalar, node.operand0, stream, false);
+            break;
+        case OP_ELT_MUL_SCALAR:
+            ret = executor->execute_mul_scalar(node.output, node.scalar, node.operand0, stream, false);
+            break;
+        case OP_RELU:
+            ret = executor->execute_relu(node.output, node.operand0, stream, false);
+            break;
+        case OP_COPY:
+            ret = executor->execute_copy(node.output, node.operand0, stream, false);
+            break;
+        case OP_ELT_CHAIN:
+            ret = executor->execute_elt_chain(node.output, node.operand0, node.chain.data(), node.chain.size(), stream,
+                                              false);
+            break;
+        case OP_BN:
+            ret = executor->execute_bn(node.output, node.operand0, node.beta, node.gamma, node.mean, node.variance,
+                                       node.epsilon, stream, false);
+            break;
+        case OP_GEMM:
+            executor->set_gemm_order(node.gemm_order);
+            ret = executor->execute_gemm(node.output, node.operand0, node.operand1, node.bias, node.act_func, stream,
+                                         false);
+            break;
+        default:
+            DLOG(ERROR) << "op " << get_pim_op_string(node.op_type) << " can not be replayed";
+            ret = -1;
+    }
+    return ret;
+}
+
+int execute_graph_nodes(IPimExecutor* executor, const PimGraph* graph, void* stream, bool block)
+{
+    DLOG(INFO) << "[START] " << __FUNCTION__ << " called";
+    int ret = 0;
+
+    for (auto& node : graph->nodes) {
+        ret = execute_graph_node(executor, node, stream);
+        if (ret != 0) {
+            DLOG(ERROR) << "fail to replay " << get_pim_op_string(node.op_type);
+            return ret;
+        }
+    }
+    if (block) ret = executor->execute_sync(stream);
+
+    DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
+    return ret;
+}
+} /* namespace executor */
+} /* namespace runtime */
+} /* namespace pim */
@@ -0,0 +1,418 @@
+/*
+ * Copyright (C) 2022 Samsung Electronics Co. LTD
+ *
+ * This software is a property of Samsung Electronics.
+ * No part of this software, either material or conceptual may be copied or distributed, transmitted,
+ * transcribed, stored in a retrieval system or translated into any human or computer language in any form by any means,
+ * electronic, mechanical, manual or otherwise, or disclosed
+ * to third parties without the express written permission of Samsung Electronics.
+ * (Use of the Software is restricted to non-commercial, personal or academic, research purpose only)
+ */
+
+#include "executor/cpu/CpuPimExecutor.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include "utility/pim_log.h"
+
+namespace pim
+{
+namespace runtime
+{
+namespace executor
+{
+static bool is_fp16_bo(const PimBo* bo) { return bo != nullptr && bo->data != nullptr && bo->precision == PIM_FP16; }
+
+CpuPimExecutor::CpuPimExecutor(pim::runtime::manager::PimManager* pim_manager, pim::runtime::PimRuntime* pim_runtime,
+                               PimPrecision precision)
+    : pim_manager_(pim_manager), pim_runtime_(pim_runtime), precision_(precision), gemm_order_(I_X_W)
+{
+    DLOG(INFO) << "[START] " << __FUNCTION__ << " called";
+    pim_device_ = pim_manager_->get_pim_device();
+    pbi_ = pim_device_->get_pim_block_info();
+
+    /* 0 uses every hardware thread */
+    int num_threads = 0;
+    const char* env_t = std::getenv("PIM_CPU_NUM_THREADS");
+    if (env_t != nullptr) {
+        num_threads = atoi(env_t);
+    }
+    kernels_ = std::make_shared<CpuPimKernels>(num_threads);
+    weight_reorder_ = std::make_shared<pim::runtime::manager::PimGemmWeightReorder>(pbi_, num_threads);
+
+    DLOG(INFO) << "CPU executor threads:" << kernels_->num_threads() << " simd:" << kernels_->is_simd_enabled();
+    DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
+}
+
+CpuPimExecutor::~CpuPimExecutor(void) { pim_device_.reset(); }
+int CpuPimExecutor::initialize(void) { return 0; }
+int CpuPimExecutor::deinitialize(void) { return 0; }
+int CpuPimExecutor::check_elt_operands(PimBo* output, PimBo* operand0, PimBo* operand1, size_t* len)
+{
+    if (!is_fp16_bo(output) || !is_fp16_bo(operand0) || (operand1 != nullptr && !is_fp16_bo(operand1))) {
+        DLOG(ERROR) << "CPU executor supports only allocated FP16 buffers";
+        return -1;
+    }
+
+    /* PIM runs over the whole padded buffer */
+    size_t size = std::min(output->size, operand0->size);
+    if (operand1 != nullptr) size = std::min(size, operand1->size);
+    *len = size / sizeof(uint16_t);
+
+    return 0;
+}
+
+int CpuPimExecutor::execute_add(PimBo* output, PimBo* operand0, PimBo* operand1, void* stream, bool block)
+{
+    DLOG(INFO) << "[START] " << __FUNCTION__ << " called";
+    size_t len = 0;
+
+    if (check_elt_operands(output, operand0, operand1, &len) != 0) return -1;
+    kernels_->add((uint16_t*)output->data, (const uint16_t*)operand0->data, (const uint16_t*)operand1->data, len);
+
+    DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
+    return 0;
+}
+
+int CpuPimExecutor::execute_mul(PimBo* output, PimBo* operand0, PimBo* operand1, void* stream, bool block)
+{
+    DLOG(INFO) << "[START] " << __FUNCTION__ << " called";
+    size_t len = 0;
+
+    if (check_elt_operands(output, operand0, operand1, &len) != 0) return -1;
+    kernels_->mul((uint16_t*)output->data, (const uint16_t*)operand0->data, (const uint16_t*)operand1->data, len);
+
+    DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
+    return 0;
+}
+
+int CpuPimExecutor::execute_add_scalar(PimBo* output, uint16_t scalar, PimBo* operand, void* stream, bool block)
+{
+    DLOG(INFO) << "[START] " << __FUNCTION__ << " called";
+    size_t len = 0;
+    float scale = 1.0f;
+    float shift = 0.0f;
+
+    if (check_elt_operands(output, operand, nullptr, &len) != 0) return -1;
+    /* same as the SRF program on PIM: out = in * 1 + scalar */
+    kernels_->half_to_float(&shift, &scalar, 1);
+    kernels_->scale_shift((uint16_t*)output->data, (const uint16_t*)operand->data, &scale, &shift, 1, 1, len);
+
+    DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
+    return 0;
+}
+
+int CpuPimExecutor::execute_mul_scalar(PimBo* output, uint16_t scalar, PimBo* operand, void* stream, bool block)
+{
+    DLOG(INFO) << "[START] " << __FUNCTION__ << " called";
+    size_t len = 0;
+    float scale = 1.0f;
+    float shift = 0.0f;
+
+    if (check_elt_operands(output, operand, nullptr, &len) != 0) return -1;
+    /* same as the SRF program on PIM: out = in * scalar + 0 */
+    kernels_->half_to_float(&scale, &scalar, 1);
+    kernels_->scale_shift((uint16_t*)output->data, (const uint16_t*)operand->data, &scale, &shift, 1, 1, len);
+
+    DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
+    return 0;
+}
+
+int CpuPimExecutor::execute_relu(PimBo* output, PimBo* pim_data, void* stream, bool block)
+{
+    DLOG(INFO) << "[START] " << __FUNCTION__ << " called";
+    size_t len = 0;
+
+    if (check_elt_operands(output, pim_data, nullptr, &len) != 0) return -1;
+    kernels_->relu((uint16_t*)output->data, (const uint16_t*)pim_data->data, len);
+
+    DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
+    return 0;
+}
+
+int CpuPimExecutor::execute_elt_chain(PimBo* output, PimBo* input, const PimEltChainStep* steps, int num_steps,
+                                      void* stream, bool block)
+{
+    /* the unfused steps are the reference for the fused PIM program */
+    return execute_elt_chain_steps(this, output, input, steps, num_steps, stream, block);
+}
+
+int CpuPimExecutor::execute_copy(PimBo* output, PimBo* pim_data, void* stream, bool block)
+{
+    DLOG(INFO) << "[START] " << __FUNCTION__ << " called";
+
+    if (output == nullptr || pim_data == nullptr || output->data == nullptr || pim_data->data == nullptr) {
+        DLOG(ERROR) << "invalid copy buffer";
+        return -1;
+    }
+    memmove(output->data, pim_data->data, std::min(output->size, pim_data->size));
+
+    DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
+    return 0;
+}
+
+int CpuPimExecutor::execute_bn(PimBo* output, PimBo* pim_data, PimBo* beta, PimBo* gamma, PimBo* mean,
+                               PimBo* variance, double epsilon, void* stream, bool block)
+{
+    DLOG(INFO) << "[START] " << __FUNCTION__ << " called";
+    size_t len = 0;
+    size_t num_batch = output->bshape.n;
+    size_t num_ch = output->bshape.c;
+    size_t plane_len = (size_t)output->bshape.h * output->bshape.w;
+
+    if (check_elt_operands(output, pim_data, nullptr, &len) != 0) return -1;
+    if (!is_fp16_bo(beta) || !is_fp16_bo(gamma) || !is_fp16_bo(mean) || !is_fp16_bo(variance)) return -1;
+    if (num_batch * num_ch * plane_len > len) {
+        DLOG(ERROR) << "bn shape exceeds buffer size";
+        return -1;
+    }
+    for (PimBo* param : {beta, gamma, mean, variance}) {
+        if (param->size / sizeof(uint16_t) < num_ch) {
+            DLOG(ERROR) << "bn parameter has less than " << num_ch << " channels";
+            return -1;
+        }
+    }
+
+    std::vector<float> params(4 * num_ch);
+    float* f_beta = params.data();
+    float* f_gamma = f_beta + num_ch;
+    float* f_mean = f_gamma + num_ch;
+    float* f_var = f_mean + num_ch;
+    kernels_->half_to_float(f_beta, (const uint16_t*)beta->data, num_ch);
+    kernels_->half_to_float(f_gamma, (const uint16_t*)gamma->data, num_ch);
+    kernels_->half_to_float(f_mean, (const uint16_t*)mean->data, num_ch);
+    kernels_->half_to_float(f_var, (const uint16_t*)variance->data, num_ch);
+
+    /* (x - mean) / sqrt(var + eps) * gamma + beta folded to one multiply-add per element */
+    std::vector<float> scale(num_ch);
+    std::vector<float> shift(num_ch);
+    for (size_t ch = 0; ch < num_ch; ch++) {
+        float rstd = 1.0f / sqrtf(f_var[ch] + (float)epsilon);
+        scale[ch] = f_gamma[ch] * rstd;
+        shift[ch] = f_beta[ch] - f_mean[ch] * scale[ch];
+    }
+    kernels_->scale_shift((uint16_t*)output->data, (const uint16_t*)pim_data->data, scale.data(), shift.data(),
+                          num_batch, num_ch, plane_len);
+
+    DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
+    return 0;
+}
+
+int CpuPimExecutor::get_gemm_weight(PimBo* weight, std::vector<float>* wei_f, size_t* ldb)
+{
+    /* returns the weight as [out][in] rows of ldb floats, batches of bshape.h * bshape.w */
+    size_t len = weight->size / sizeof(uint16_t);
+    size_t h = weight->bshape.h;
+    size_t w = weight->bshape.w;
+    size_t num_batch = (size_t)weight->bshape.n * weight->bshape.c;
+    size_t in_pad = (gemm_order_ == I_X_W) ? h : w;
+    size_t out_pad = (gemm_order_ == I_X_W) ? w : h;
+    const uint16_t* src = (const uint16_t*)weight->data;
+    std::vector<uint16_t> restored;
+    bool out_major = false;
+    size_t pitch = 0;
+
+    if (num_batch * h * w > len) {
+        DLOG(ERROR) << "gemm weight shape exceeds buffer size";
+        return -1;
+    }
+
+    if (weight->data_layout_type != PimDataLayoutType::RAW) {
+        /* PIM layouts hold out-major data of the padded shape */
+        PimBo raw_bo = *weight;
+        raw_bo.data_layout_type = PimDataLayoutType::RAW;
+        restored.resize(len);
+        int ret = 0;
+        if (weight->data_layout_type == PimDataLayoutType::CHWISE_GEMM_WEIGHT) {
+            ret = weight_reorder_->restore_chwise(restored.data(), &raw_bo, weight->data, weight->size, gemm_order_);
+        } else {
+            ret = weight_reorder_->restore_aligned(restored.data(), &raw_bo, weight->data, weight->size, gemm_order_);
+        }
+        if (ret != 0) return ret;
+        src = restored.data();
+        out_major = true;
+        pitch = in_pad;
+    } else if (weight->transposed) {
+        /* data holds the transpose of bshape */
+        out_major = (gemm_order_ == I_X_W);
+        pitch = h;
+    } else {
+        out_major = (gemm_order_ == W_X_I);
+        pitch = w;
+    }
+
+    std::vector<float> raw_f(len);
+    kernels_->half_to_float(raw_f.data(), src, len);
+    if (out_major) {
+        wei_f->swap(raw_f);
+        *ldb = pitch;
+        return 0;
+    }
+
+    wei_f->resize(len);
+    for (size_t b = 0; b < num_batch; b++) {
+        kernels_->transpose(wei_f->data() + b * h * w, in_pad, raw_f.data() + b * h * w, pitch, in_pad, out_pad);
+    }
+    *ldb = in_pad;
+
+    return 0;
+}
+
+int CpuPimExecutor::get_gemm_input(PimBo* input, std::vector<float>* in_f, size_t* lda)
+{
+    /* returns the input as [row][in] rows of lda floats, batches of bshape.h * bshape.w */
+    size_t len = input->size / sizeof(uint16_t);
+    size_t h = input->bshape.h;
+    size_t w = input->bshape.w;
+    size_t num_batch = (size_t)input->bshape.n * input->bshape.c;
+
+    if (num_batch * h * w > len) {
+        DLOG(ERROR) << "gemm input shape exceeds buffer size";
+        return -1;
+    }
+
+    std::vector<float> raw_f(len);
+    kernels_->half_to_float(raw_f.data(), (const uint16_t*)input->data, len);
+    if (gemm_order_ == I_X_W) {
+        in_f->swap(raw_f);
+        *lda = w;
+        return 0;
+    }
+
+    in_f->resize(len);
+    for (size_t b = 0; b < num_batch; b++) {
+        kernels_->transpose(in_f->data() + b * h * w, h, raw_f.data() + b * h * w, w, h, w);
+    }
+    *lda = h;
+
+    return 0;
+}
+
+int CpuPimExecutor::execute_gemm(PimBo* output, PimBo* input, PimBo* weight, PimBo* bias, PimActFunc act_func,
+                                 void* stream, bool block)
+{
+    DLOG(INFO) << "[START] " << __FUNCTION__ << " called";
+    int ret = 0;
+    bool i_x_w = (gemm_order_ == I_X_W);
+
+    if (!is_fp16_bo(output) || !is_fp16_bo(input) || !is_fp16_bo(weight) || (bias != nullptr && !is_fp16_bo(bias))) {
+        DLOG(ERROR) << "CPU executor supports only allocated FP16 buffers";
+        return -1;
+    }
+
+    /* I_X_W: out(m, n) = in(m, k) x W(k, n), W_X_I: out(n, m) = W(n, k) x in(k, m) */
+    int m = i_x_w ? input->bshape_r.h : input->bshape_r.w;
+    int k = std::min(i_x_w ? input->bshape_r.w : input->bshape_r.h, i_x_w ? weight->bshape_r.h : weight->bshape_r.w);
+    int n = std::min(i_x_w ? output->bshape_r.w : output->bshape_r.h, i_x_w ? weight->bshape_r.w : weight->bshape_r.h);
+    int rows = i_x_w ? m : n;
+    int cols = i_x_w ? n : m;
+    size_t num_batch = (size_t)output->bshape.n * output->bshape.c;
+    size_t in_batch = (size_t)input->bshape.n * input->bshape.c;
+    size_t wei_batch = (size_t)weight->bshape.n * weight->bshape.c;
+    size_t ldc = output->bshape.w;
+    size_t out_stride = (size_t)output->bshape.h * output->bshape.w;
+
+    if ((in_batch != 1 && in_batch < num_batch) || (wei_batch != 1 && wei_batch < num_batch) ||
+        rows > (int)output->bshape.h || cols > (int)output->bshape.w ||
+        num_batch * out_stride > output->size / sizeof(uint16_t)) {
+        DLOG(ERROR) << "gemm operand shapes do not match";
+        return -1;
+    }
+
+    std::vector<float> in_f;
+    std::vector<float> wei_f;
+    size_t lda = 0;
+    size_t ldb = 0;
+    ret = get_gemm_input(input, &in_f, &lda);
+    if (ret == 0) ret = get_gemm_weight(weight, &wei_f, &ldb);
+    if (ret != 0) {
+        DLOG(ERROR) << "fail to read gemm operands";
+        return ret;
+    }
+
+    /* bias is read before anything is written since it may be the output itself */
+    std::vector<float> bias_f;
+    size_t bias_h = 0, bias_w = 0, bias_batch = 0;
+    if (bias != nullptr) {
+        bias_h = bias->bshape.h;
+        bias_w = bias->bshape.w;
+        bias_batch = (size_t)bias->bshape.n * bias->bshape.c;
+        if ((bias_h != 1 && bias_h < (size_t)rows) || (bias_w != 1 && bias_w < (size_t)cols) ||
+            (bias_batch != 1 && bias_batch < num_batch) ||
+            bias_batch * bias_h * bias_w > bias->size / sizeof(uint16_t)) {
+            DLOG(ERROR) << "gemm bias shape does not match output";
+            return -1;
+        }
+        bias_f.resize(bias->size / sizeof(uint16_t));
+        kernels_->half_to_float(bias_f.data(), (const uint16_t*)bias->data, bias_f.size());
+    }
+
+    /* padding of the output stays zero as on PIM */
+    std::vector<float> out_f(num_batch * out_stride, 0.0f);
+    size_t in_stride = (size_t)input->bshape.h * input->bshape.w;
+    size_t wei_stride = (size_t)weight->bshape.h * weight->bshape.w;
+    for (size_t b = 0; b < num_batch; b++) {
+        const float* a = in_f.data() + (in_batch == 1 ? 0 : b) * in_stride;
+        const float* w = wei_f.data() + (wei_batch == 1 ? 0 : b) * wei_stride;
+        float* c = out_f.data() + b * out_stride;
+
+        if (i_x_w) {
+            kernels_->gemm_nt(c, ldc, a, lda, w, ldb, m, n, k);
+        } else {
+            kernels_->gemm_nt(c, ldc, w, ldb, a, lda, n, m, k);
+        }
+
+        if (bias != nullptr) {
+            const float* bias_b = bias_f.data() + (bias_batch == 1 ? 0 : b) * bias_h * bias_w;
+            for (int r = 0; r < rows; r++) {
+                const float* bias_r = bias_b + (bias_h == 1 ? 0 : r) * bias_w;
+                for (int col = 0; col < cols; col++) {
+                    c[r * ldc + col] += bias_r[bias_w == 1 ? 0 : col];
+                }
+            }
+        }
+        if (act_func == ACT_RELU) {
+            for (int r = 0; r < rows; r++) {
+                for (int col = 0; col < cols; col++) {
+                    c[r * ldc + col] = std::max(c[r * ldc + col], 0.0f);
+                }
+            }
+        }
+    }
+    kernels_->float_to_half((uint16_t*)output->data, out_f.data(), out_f.size());
+
+    DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
+    return ret;
+}
+
+int CpuPimExecutor::execute_custom_gemv(PimBo* output, PimBo* operand0, PimBo* operand1, bool is_gemv_add,
+                                        void* stream, bool block)
+{
+    /* gemv accumulating into the output is a gemm with the output as bias */
+    return execute_gemm(output, operand0, operand1, is_gemv_add ? output : nullptr, NONE, stream, block);
+}
+
+int CpuPimExecutor::execute_custom_gemv_add(PimBo* output, PimBo* operand0, PimBo* operand1, PimBo* operand2,
+                                            bool relu, void* stream, bool block)
+{
+    return execute_gemm(output, operand0, operand1, operand2, relu ? ACT_RELU : NONE, stream, block);
+}
+
+int CpuPimExecutor::execute_sync(void* stream) { return 0; }
+/* nothing to prepare since every node completes before the next one starts */
+int CpuPimExecutor::instantiate_graph(PimGraph* graph) { return 0; }
+int CpuPimExecutor::execute_graph(PimGraph* graph, void* stream, bool block)
+{
+    return execute_graph_nodes(this, graph, stream, block);
+}
+int CpuPimExecutor::execute_dummy(void) { return 0; }
+void* CpuPimExecutor::createStream(void) { return nullptr; }
+int CpuPimExecutor::load_crf_program(PimOpType op_type, const PimCrfProgram& program)
+{
+    DLOG(ERROR) << "the cpu executor computes ops on the host and has no CRF program to replace";
+    return -1;
+}
+}  // namespace executor
+}  // namespace runtime
+}  // namespace pim
@@ -0,0 +1,388 @@
+/*
+ * Copyright (C) 2022 Samsung Electronics Co. LTD
+ *
+ * This software is a property of Samsung Electronics.
+ * No part of this software, either material or conceptual may be copied or distributed, transmitted,
+ * transcribed, stored in a retrieval system or translated into any human or computer language in any form by any means,
+ * electronic, mechanical, manual or otherwise, or disclosed
+ * to third parties without the express written permission of Samsung Electronics.
+ * (Use of the Software is restricted to non-commercial, personal or academic, research purpose only)
+ */
+
+#include "executor/cpu/CpuPimKernels.h"
+#include <string.h>
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+#if (defined(__x86_64__) || defined(__i386__)) && !defined(__HIP_DEVICE_COMPILE__)
+#define CPU_PIM_X86_SIMD 1
+#include <immintrin.h>
+#define CPU_PIM_AVX2 __attribute__((target("avx2,fma,f16c")))
+#endif
+
+/* minimum number of elements handed to one thread by elementwise kernels */
+#define MIN_ELEMS_PER_THREAD (1 << 16)
+/* minimum number of multiply-adds handed to one thread by gemm */
+#define MIN_MACS_PER_THREAD (1 << 18)
+/* outputs sharing one load of the left operand in gemm */
+#define GEMM_N_BLOCK 4
+/* square tile of transpose, kept small enough for both tiles to stay in L1 */
+#define TRANSPOSE_TILE 32
+
+namespace pim
+{
+namespace runtime
+{
+namespace executor
+{
+static inline float half_bits_to_float(uint16_t h)
+{
+    uint32_t sign = (uint32_t)(h & 0x8000) << 16;
+    uint32_t exp = (h >> 10) & 0x1f;
+    uint32_t man = h & 0x3ff;
+    uint32_t bits;
+
+    if (exp == 0x1f) {
+        /* nan stays quiet as in F16C */
+        bits = sign | 0x7f800000 | (man << 13) | (man != 0 ? 0x400000 : 0);
+    } else if (exp != 0) {
+        bits = sign | ((exp + 112) << 23) | (man << 13);
+    } else if (man == 0) {
+        bits = sign;
+    } else {
+        /* subnormal, normalize the mantissa */
+        exp = 113;
+        while ((man & 0x400) == 0) {
+            man <<= 1;
+            exp--;
+        }
+        bits = sign | (exp << 23) | ((man & 0x3ff) << 13);
+    }
+
+    float f;
+    memcpy(&f, &bits, sizeof(f));
+    return f;
+}
+
+static inline uint16_t float_to_half_bits(float f)
+{
+    uint32_t x;
+    memcpy(&x, &f, sizeof(x));
+    uint16_t sign = (x >> 16) & 0x8000;
+    uint32_t absx = x & 0x7fffffff;
+
+    if (absx >= 0x7f800000) return sign | 0x7c00 | (absx > 0x7f800000 ? 0x200 : 0);
+    if (absx >= 0x477ff000) return sign | 0x7c00; /* rounds above 65504 */
+    if (absx < 0x38800000) {
+        /* subnormal half, round to nearest even on the bits shifted out */
+        if (absx <= 0x33000000) return sign;
+        uint32_t shift = 126 - (absx >> 23);
+        uint32_t man = (absx & 0x7fffff) | 0x800000;
+        uint32_t h = man >> shift;
+        uint32_t rem = man & ((1u << shift) - 1);
+        uint32_t halfway = 1u << (shift - 1);
+        if (rem > halfway || (rem == halfway && (h & 1))) h++;
+        return sign | h;
+    }
+
+    uint32_t h = (absx >> 13) - (112 << 10);
+    uint32_t rem = absx & 0x1fff;
+    if (rem > 0x1000 || (rem == 0x1000 && (h & 1))) h++;
+    return sign | h;
+}
+
+#ifdef CPU_PIM_X86_SIMD
+CPU_PIM_AVX2 static void add_avx2(uint16_t* out, const uint16_t* in0, const uint16_t* in1, size_t len, bool is_mul)
+{
+    size_t i = 0;
+    for (; i + 8 <= len; i += 8) {
+        __m256 a = _mm256_cvtph_ps(_mm_loadu_si128((const __m128i*)(in0 + i)));
+        __m256 b = _mm256_cvtph_ps(_mm_loadu_si128((const __m128i*)(in1 + i)));
+        __m256 r = is_mul ? _mm256_mul_ps(a, b) : _mm256_add_ps(a, b);
+        _mm_storeu_si128((__m128i*)(out + i), _mm256_cvtps_ph(r, _MM_FROUND_TO_NEAREST_INT));
+    }
+    for (; i < len; i++) {
+        float a = half_bits_to_float(in0[i]);
+        float b = half_bits_to_float(in1[i]);
+        out[i] = float_to_half_bits(is_mul ? a * b : a + b);
+    }
+}
+
+CPU_PIM_AVX2 static void relu_avx2(uint16_t* out, const uint16_t* in, size_t len)
+{
+    size_t i = 0;
+    for (; i + 16 <= len; i += 16) {
+        __m256i v = _mm256_loadu_si256((const __m256i*)(in + i));
+        __m256i neg = _mm256_srai_epi16(v, 15);
+        _mm256_storeu_si256((__m256i*)(out + i), _mm256_andnot_si256(neg, v));
+    }
+    for (; i < len; i++) {
+        out[i] = (in[i] & 0x8000) ? 0 : in[i];
+    }
+}
+
+CPU_PIM_AVX2 static void scale_shift_avx2(uint16_t* out, const uint16_t* in, float scale, float shift, size_t len)
+{
+    __m256 s = _mm256_set1_ps(scale);
+    __m256 t = _mm256_set1_ps(shift);
+    size_t i = 0;
+    for (; i + 8 <= len; i += 8) {
+        __m256 v = _mm256_cvtph_ps(_mm_loadu_si128((const __m128i*)(in + i)));
+        _mm_storeu_si128((__m128i*)(out + i), _mm256_cvtps_ph(_mm256_fmadd_ps(v, s, t), _MM_FROUND_TO_NEAREST_INT));
+    }
+    for (; i < len; i++) {
+        out[i] = float_to_half_bits(half_bits_to_float(in[i]) * scale + shift);
+    }
+}
+
+CPU_PIM_AVX2 static void half_to_float_avx2(float* dst, const uint16_t* src, size_t len)
+{
+    size_t i = 0;
+    for (; i + 8 <= len; i += 8) {
+        _mm256_storeu_ps(dst + i, _mm256_cvtph_ps(_mm_loadu_si128((const __m128i*)(src + i))));
+    }
+    for (; i < len; i++) {
+        dst[i] = half_bits_to_float(src[i]);
+    }
+}
+
+CPU_PIM_AVX2 static void float_to_half_avx2(uint16_t* dst, const float* src, size_t len)
+{
+    size_t i = 0;
+    for (; i + 8 <= len; i += 8) {
+        _mm_storeu_si128((__m128i*)(dst + i), _mm256_cvtps_ph(_mm256_loadu_ps(src + i), _MM_FROUND_TO_NEAREST_INT));
+    }
+    for (; i < len; i++) {
+        dst[i] = float_to_half_bits(src[i]);
+    }
+}
+
+CPU_PIM_AVX2 static inline float hsum_avx2(__m256 v)
+{
+    __m128 s = _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+    s = _mm_add_ps(s, _mm_movehl_ps(s, s));
+    s = _mm_add_ss(s, _mm_movehdup_ps(s));
+    return _mm_cvtss_f32(s);
+}
+
+CPU_PIM_AVX2 static void dot_block_avx2(float* c, const float* a, const float* b, size_t ldb, int nb, int k)
+{
+    /* nb (<= GEMM_N_BLOCK) rows of b share each load of a */
+    __m256 acc[GEMM_N_BLOCK];
+    for (int j = 0; j < GEMM_N_BLOCK; j++) acc[j] = _mm256_setzero_ps();
+
+    int p = 0;
+    for (; p + 8 <= k; p += 8) {
+        __m256 va = _mm256_loadu_ps(a + p);
+        for (int j = 0; j < nb; j++) {
+            acc[j] = _mm256_fmadd_ps(va, _mm256_loadu_ps(b + j * ldb + p), acc[j]);
+        }
+    }
+    for (int j = 0; j < nb; j++) {
+        float sum = hsum_avx2(acc[j]);
+        for (int q = p; q < k; q++) sum += a[q] * b[j * ldb + q];
+        c[j] = sum;
+    }
+}
+#endif
+
+static void dot_block(float* c, const float* a, const float* b, size_t ldb, int nb, int k)
+{
+    for (int j = 0; j < nb; j++) {
+        const float* bj = b + j * ldb;
+        float sum = 0.0f;
+        for (int p = 0; p < k; p++) sum += a[p] * bj[p];
+        c[j] = sum;
+    }
+}
+
+CpuPimKernels::CpuPimKernels(int num_threads) : num_threads_(num_threads), use_avx2_(false)
+{
+    if (num_threads_ <= 0) {
+        num_threads_ = std::max(1u, std::thread::hardware_concurrency());
+    }
+#ifdef CPU_PIM_X86_SIMD
+    __builtin_cpu_init();
+    use_avx2_ = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma") && __builtin_cpu_supports("f16c");
+#endif
+}
+
+template <typename Func>
+void CpuPimKernels::parallel_for(size_t count, size_t min_per_thread, Func func)
+{
+    size_t num_threads = std::min((size_t)num_threads_, count / std::max(min_per_thread, (size_t)1));
+
+    if (num_threads <= 1) {
+        func(0, count);
+        return;
+    }
+
+    std::vector<std::thread> workers;
+    size_t per_thread = (count + num_threads - 1) / num_threads;
+    for (size_t t = 1; t < num_threads; t++) {
+        size_t begin = t * per_thread;
+        size_t end = std::min(count, begin + per_thread);
+        if (begin >= end) break;
+        workers.emplace_back([&func, begin, end]() { func(begin, end); });
+    }
+    /* the calling thread takes the first range */
+    func(0, std::min(count, per_thread));
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+void CpuPimKernels::add(uint16_t* out, const uint16_t* in0, const uint16_t* in1, size_t len)
+{
+    parallel_for(len, MIN_ELEMS_PER_THREAD, [&](size_t begin, size_t end) {
+#ifdef CPU_PIM_X86_SIMD
+        if (use_avx2_) {
+            add_avx2(out + begin, in0 + begin, in1 + begin, end - begin, false);
+            return;
+        }
+#endif
+        for (size_t i = begin; i < end; i++) {
+            out[i] = float_to_half_bits(half_bits_to_float(in0[i]) + half_bits_to_float(in1[i]));
+        }
+    });
+}
+
+void CpuPimKernels::mul(uint16_t* out, const uint16_t* in0, const uint16_t* in1, size_t len)
+{
+    parallel_for(len, MIN_ELEMS_PER_THREAD, [&](size_t begin, size_t end) {
+#ifdef CPU_PIM_X86_SIMD
+        if (use_avx2_) {
+            add_avx2(out + begin, in0 + begin, in1 + begin, end - begin, true);
+            return;
+        }
+#endif
+        for (size_t i = begin; i < end; i++) {
+            out[i] = float_to_half_bits(half_bits_to_float(in0[i]) * half_bits_to_float(in1[i]));
+        }
+    });
+}
+
+void CpuPimKernels::relu(uint16_t* out, const uint16_t* in, size_t len)
+{
+    parallel_for(len, MIN_ELEMS_PER_THREAD, [&](size_t begin, size_t end) {
+#ifdef CPU_PIM_X86_SIMD
+        if (use_avx2_) {
+            relu_avx2(out + begin, in + begin, end - begin);
+            return;
+        }
+#endif
+        for (size_t i = begin; i < end; i++) {
+            out[i] = (in[i] & 0x8000) ? 0 : in[i];
+        }
+    });
+}
+
+void CpuPimKernels::scale_shift(uint16_t* out, const uint16_t* in, const float* scale, const float* shift,
+                                size_t num_batch, size_t num_ch, size_t plane_len)
+{
+    size_t len = num_batch * num_ch * plane_len;
+
+    if (plane_len == 0) return;
+    parallel_for(len, MIN_ELEMS_PER_THREAD, [&](size_t begin, size_t end) {
+        /* walk the range plane by plane so every run uses one channel's factors */
+        size_t i = begin;
+        while (i < end) {
+            size_t plane = i / plane_len;
+            size_t run = std::min(end, (plane + 1) * plane_len) - i;
+            size_t ch = plane % num_ch;
+#ifdef CPU_PIM_X86_SIMD
+            if (use_avx2_) {
+                scale_shift_avx2(out + i, in + i, scale[ch], shift[ch], run);
+                i += run;
+                continue;
+            }
+#endif
+            for (size_t j = i; j < i + run; j++) {
+                out[j] = float_to_half_bits(half_bits_to_float(in[j]) * scale[ch] + shift[ch]);
+            }
+            i += run;
+        }
+    });
+}
+
+void CpuPimKernels::gemm_nt(float* c, size_t ldc, const float* a, size_t lda, const float* b, size_t ldb, int m, int n,
+                            int k)
+{
+    if (m <= 0 || n <= 0) return;
+
+    size_t n_blocks = (n + GEMM_N_BLOCK - 1) / GEMM_N_BLOCK;
+    size_t macs_per_task = (size_t)GEMM_N_BLOCK * std::max(k, 1);
+
+    /* tasks are (row of a, block of rows of b) pairs, so gemv splits over outputs as well */
+    parallel_for((size_t)m * n_blocks, MIN_MACS_PER_THREAD / macs_per_task, [&](size_t begin, size_t end) {
+        for (size_t task = begin; task < end; task++) {
+            size_t i = task / n_blocks;
+            size_t j = (task % n_blocks) * GEMM_N_BLOCK;
+            int nb = std::min(GEMM_N_BLOCK, n - (int)j);
+#ifdef CPU_PIM_X86_SIMD
+            if (use_avx2_) {
+                dot_block_avx2(c + i * ldc + j, a + i * lda, b + j * ldb, ldb, nb, k);
+                continue;
+            }
+#endif
+            dot_block(c + i * ldc + j, a + i * lda, b + j * ldb, ldb, nb, k);
+        }
+    });
+}
+
+void CpuPimKernels::transpose(float* dst, size_t ldd, const float* src, size_t lds, int rows, int cols)
+{
+    if (rows <= 0 || cols <= 0) return;
+
+    size_t row_tiles = (rows + TRANSPOSE_TILE - 1) / TRANSPOSE_TILE;
+    size_t col_tiles = (cols + TRANSPOSE_TILE - 1) / TRANSPOSE_TILE;
+    size_t min_tiles = MIN_ELEMS_PER_THREAD / (TRANSPOSE_TILE * TRANSPOSE_TILE);
+
+    parallel_for(row_tiles * col_tiles, min_tiles, [&](size_t begin, size_t end) {
+        for (size_t tile = begin; tile < end; tile++) {
+            int r0 = (tile / col_tiles) * TRANSPOSE_TILE;
+            int c0 = (tile % col_tiles) * TRANSPOSE_TILE;
+            int r1 = std::min(rows, r0 + TRANSPOSE_TILE);
+            int c1 = std::min(cols, c0 + TRANSPOSE_TILE);
+            for (int i = r0; i < r1; i++) {
+                for (int j = c0; j < c1; j++) {
+                    dst[j * ldd + i] = src[i * lds + j];
+                }
+            }
+        }
+    });
+}
+
+void CpuPimKernels::half_to_float(float* dst, const uint16_t* src, size_t len)
+{
+    parallel_for(len, MIN_ELEMS_PER_THREAD, [&](size_t begin, size_t end) {
+#ifdef CPU_PIM_X86_SIMD
+        if (use_avx2_) {
+            half_to_float_avx2(dst + begin, src + begin, end - begin);
+            return;
+        }
+#endif
+        for (size_t i = begin; i < end; i++) {
+            dst[i] = half_bits_to_float(src[i]);
+        }
+    });
+}
+
+void CpuPimKernels::float_to_half(uint16_t* dst, const float* src, size_t len)
+{
+    parallel_for(len, MIN_ELEMS_PER_THREAD, [&](size_t begin, size_t end) {
+#ifdef CPU_PIM_X86_SIMD
+        if (use_avx2_) {
+            float_to_half_avx2(dst + begin, src + begin, end - begin);
+            return;
+        }
+#endif
+        for (size_t i = begin; i < end; i++) {
+            dst[i] = float_to_half_bits(src[i]);
+        }
+    });
+}
+} /* namespace executor */
+} /* namespace runtime */
+} /* namespace pim */
@@ -12,6 +12,7 @@
 #include "executor/hip/HipPimExecutor.h"
 #include <assert.h>
 #include <stdlib.h>
+#include <algorithm>
 #include <iostream>
 #include "executor/PimCompilerDriver.h"
 #include "executor/hip/gpu_custom_ops.h"
@@ -29,6 +30,33 @@ namespace runtime
 {
 namespace executor
 {
+namespace
+{
+/* kernel arguments of one graph node which do not change between replays */
+struct HipGraphLaunch {
+    PimOpType op_type;
+    uint8_t* crf_bin;
+    int crf_size;
+    int num_tile;
+    uint8_t* d_srf_bin; /* SRF image of BN and scalar nodes, owned by the launch list */
+    int srf_size;
+    PimOpStmtArgs stmt_args;
+};
+
+struct HipGraphLaunchList {
+    int device_id;
+    uint64_t crf_version; /* CRF programs the launches were resolved with */
+    std::vector<HipGraphLaunch> launches;
+
+    ~HipGraphLaunchList(void)
+    {
+        for (auto& launch : launches) {
+            if (launch.d_srf_bin != nullptr) hipFree((void*)launch.d_srf_bin);
+        }
+    }
+};
+}  // namespace
+
 HipPimExecutor::HipPimExecutor(pim::runtime::manager::PimManager* pim_manager, pim::runtime::PimRuntime* pim_runtime,
                                PimPrecision precision)
     : pim_manager_(pim_manager), pim_runtime_(pim_runtime), precision_(precision)
@@ -43,6 +71,13 @@ HipPimExecutor::HipPimExecutor(pim::runtime::manager::PimManager* pim_manager, p
     fmtd_size_per_ch_ = 100000;
     max_block_size_ = pbi_->num_pim_chan;
     max_fmtd_size_ = fmtd_size_per_ch_ * max_block_size_;
+
+    /* number of channels whose traces are copied, coalesced and simulated together */
+    trace_chunk_chans_ = 8;
+    const char* env_c = std::getenv("PIM_EMULATOR_TRACE_CHUNK");
+    if (env_c != nullptr && atoi(env_c) > 0) {
+        trace_chunk_chans_ = std::min(atoi(env_c), max_block_size_);
+    }
 #endif
     pim_gemv_type_ = TILE_ACCUM;
 
@@ -78,6 +113,7 @@ int HipPimExecutor::initialize(void)
     int ret = 0;
     int is_gemv_tile_tree = pim_gemv_type_ == TILE_TREE ? 1 : 0;
     pim_crf_generator_->set_gemv_tile_tree(is_gemv_tile_tree);
+    ret = pim_crf_generator_->initialize();
 
     int device_id;
     hipGetDevice(&device_id);
@@ -105,10 +141,19 @@ int HipPimExecutor::initialize(void)
     hipMalloc((void**)&d_fmtd16_size_, sizeof(int));
     hipHostMalloc((void**)&d_emulator_trace_, sizeof(PimMemTracer));
 
-    h_fmtd16_ = (PimMemTraceData*)malloc(reserved_fmtd_size);
+    /* pinned so that per-channel trace copies run asynchronously to the coalescer */
+    hipHostMalloc((void**)&h_fmtd16_, reserved_fmtd_size);
     h_fmtd32_ = (PimMemTraceData*)malloc(reserved_fmtd_size);
     h_fmtd16_size_ = (int*)malloc(sizeof(int));
     h_fmtd32_size_ = (int*)malloc(sizeof(int));
+
+    int max_trace_chunk = (max_block_size_ + trace_chunk_chans_ - 1) / trace_chunk_chans_;
+    hipStreamCreateWithFlags(&trace_stream_, hipStreamNonBlocking);
+    trace_events_.resize(max_trace_chunk);
+    trace_chunk_end_.resize(max_trace_chunk);
+    for (auto& event : trace_events_) {
+        hipEventCreateWithFlags(&event, hipEventDisableTiming);
+    }
 #endif
     DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
     return ret;
@@ -118,16 +163,22 @@ int HipPimExecutor::deinitialize(void)
 {
     DLOG(INFO) << " [START] " << __FUNCTION__ << " called";
     int ret = 0;
+    ret = pim_crf_generator_->deinitialize();
     hipFree((void*)d_srf_bin_buffer_);
     hipFree((void*)zero_buffer_);
     pim_manager_->free_memory((void*)pim_gemv_tmp_buffer_, MEM_TYPE_PIM);
 #ifdef EMULATOR
     hipFree((void*)d_fmtd16_);
     hipFree((void*)d_fmtd16_size_);
-    free(h_fmtd16_);
+    hipHostFree(h_fmtd16_);
     free(h_fmtd16_size_);
     free(h_fmtd32_);
     free(h_fmtd32_size_);
+    for (auto& event : trace_events_) {
+        hipEventDestroy(event);
+    }
+    trace_events_.clear();
+    hipStreamDestroy(trace_stream_);
 #endif
     DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
     return ret;
@@ -140,6 +191,63 @@ void* HipPimExecutor::createStream(void)
     return (void*)new_stream;
 }
 
+#ifdef EMULATOR
+void HipPimExecutor::start_trace_collection(unsigned blocks, hipStream_t stream)
+{
+    DLOG(INFO) << "[START] " << __FUNCTION__ << " called";
+    hipStreamSynchronize(stream);
+
+    /* copy only the records each channel has written and pack them back to back, */
+    /* recording an event per chunk of channels so that coalescing can start early */
+    int num_chunk = 0;
+    int fmtd16_size = 0;
+    for (unsigned ch = 0; ch < blocks; ch++) {
+        int ch_size = std::min(d_emulator_trace_->g_ridx[ch], fmtd_size_per_ch_);
+        hipMemcpyAsync((void*)&h_fmtd16_[fmtd16_size], (void*)&d_fmtd16_[ch * fmtd_size_per_ch_],
+                       ch_size * sizeof(PimMemTraceData), hipMemcpyDeviceToHost, trace_stream_);
+        fmtd16_size += ch_size;
+        if ((ch + 1) % trace_chunk_chans_ == 0 || ch + 1 == blocks) {
+            hipEventRecord(trace_events_[num_chunk], trace_stream_);
+            trace_chunk_end_[num_chunk++] = fmtd16_size;
+        }
+    }
+    h_fmtd16_size_[0] = fmtd16_size;
+
+    /* the emulator takes the trace from the queue, so the execute_* calls that follow pass no trace of their own */
+    trace_queue_.reset(h_fmtd32_);
+    pim_emulator_->set_trace_queue(&trace_queue_);
+    trace_collector_ = std::thread([this, num_chunk] {
+        pim::runtime::emulator::TraceParser trace_converter;
+        int fmtd16_begin = 0;
+        int fmtd32_end = 0;
+        for (int i = 0; i < num_chunk; i++) {
+            int fmtd32_size = 0;
+            hipEventSynchronize(trace_events_[i]);
+            trace_converter.coalesce_trace(&h_fmtd32_[fmtd32_end], &fmtd32_size, &h_fmtd16_[fmtd16_begin],
+                                           trace_chunk_end_[i] - fmtd16_begin);
+            fmtd16_begin = trace_chunk_end_[i];
+            fmtd32_end += fmtd32_size;
+            trace_queue_.push(fmtd32_size);
+        }
+        trace_queue_.close();
+    });
+    DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
+}
+
+void HipPimExecutor::finish_trace_collection(PimOpType op_type)
+{
+    DLOG(INFO) << "[START] " << __FUNCTION__ << " called";
+    if (trace_collector_.joinable()) trace_collector_.join();
+    pim_emulator_->set_trace_queue(nullptr);
+    h_fmtd32_size_[0] = trace_queue_.get_total_size();
+    pim_emulator_->dump_mem_trace(h_fmtd32_, h_fmtd32_size_[0], h_fmtd16_, h_fmtd16_size_[0], op_type);
+    if (pim_emulator_->get_kernel_cycle() > 0) {
+        LOG(INFO) << get_pim_op_string(op_type) << " : " << pim_emulator_->get_kernel_cycle() << " emulator cycles";
+    }
+    DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
+}
+#endif
+
 int HipPimExecutor::execute_add(PimBo* output, PimBo* operand0, PimBo* operand1, void* stream, bool block)
 {
     DLOG(INFO) << "called";
@@ -148,7 +256,7 @@ int HipPimExecutor::execute_add(PimBo* output, PimBo* operand0, PimBo* operand1,
     int output_size = output->size;
 
     uint8_t* crf_bin = pim_crf_generator_->find_crf(OP_ELT_ADD, output_size);
-    int crf_size = 32;
+    int crf_size = pim_crf_generator_->get_crf_size(OP_ELT_ADD, output_size);
     if (crf_bin == nullptr) {
         crf_bin = (uint8_t*)pim_crf_generator_->make_crf_bin(OP_ELT_ADD, output_size);
     }
@@ -166,20 +274,11 @@ int HipPimExecutor::execute_add(PimBo* output, PimBo* operand0, PimBo* operand1,
 #ifdef EMULATOR
         (PimMemTraceData*)d_fmtd16_, (int*)d_fmtd16_size_, fmtd_size_per_ch_, (PimMemTracer*)d_emulator_trace_,
 #endif
-        (uint8_t*)crf_bin, crf_size);
+        (uint8_t*)crf_bin, crf_size, pim_crf_generator_->get_stmt_args(OP_ELT_ADD));
 #ifdef EMULATOR
-    hipStreamSynchronize((hipStream_t)stream);
-    hipMemcpy((void*)h_fmtd16_size_, (void*)d_fmtd16_size_, sizeof(int), hipMemcpyDeviceToHost);
-    hipMemcpy((void*)h_fmtd16_, (void*)d_fmtd16_, sizeof(PimMemTraceData) * max_fmtd_size_, hipMemcpyDeviceToHost);
-
-    for (size_t i = 1; i < blocks; i++) {
-        memcpy(&h_fmtd16_[i * h_fmtd16_size_[0]], &h_fmtd16_[i * fmtd_size_per_ch_],
-               h_fmtd16_size_[0] * sizeof(PimMemTraceData));
-    }
-    h_fmtd16_size_[0] *= blocks;
-    pim_emulator_->convert_mem_trace_from_16B_to_32B(h_fmtd32_, h_fmtd32_size_, h_fmtd16_, h_fmtd16_size_[0],
-                                                     OP_ELT_ADD);
-    pim_emulator_->execute_elt_op(output, operand0, operand1, h_fmtd32_, h_fmtd32_size_[0], g_pim_base_addr[device_id]);
+    start_trace_collection(blocks, (hipStream_t)stream);
+    ret = pim_emulator_->execute_elt_op(output, operand0, operand1, nullptr, 0, g_pim_base_addr[device_id]);
+    finish_trace_collection(OP_ELT_ADD);
 #else
     if (block) hipStreamSynchronize((hipStream_t)stream);
 #endif
@@ -194,7 +293,7 @@ int HipPimExecutor::execute_mul(PimBo* output, PimBo* operand0, PimBo* operand1,
     int output_size = output->size;
 
     uint8_t* crf_bin = pim_crf_generator_->find_crf(OP_ELT_MUL, output->size);
-    int crf_size = 32;
+    int crf_size = pim_crf_generator_->get_crf_size(OP_ELT_MUL, output->size);
     if (crf_bin == nullptr) {
         crf_bin = (uint8_t*)pim_crf_generator_->make_crf_bin(OP_ELT_MUL, output->size);
     }
@@ -212,24 +311,74 @@ int HipPimExecutor::execute_mul(PimBo* output, PimBo* operand0, PimBo* operand1,
 #ifdef EMULATOR
         (PimMemTraceData*)d_fmtd16_, (int*)d_fmtd16_size_, fmtd_size_per_ch_, (PimMemTracer*)d_emulator_trace_,
 #endif
-        (uint8_t*)crf_bin, crf_size);
+        (uint8_t*)crf_bin, crf_size, pim_crf_generator_->get_stmt_args(OP_ELT_MUL));
 
 #ifdef EMULATOR
-    hipStreamSynchronize((hipStream_t)stream);
-    hipMemcpy((void*)h_fmtd16_size_, (void*)d_fmtd16_size_, sizeof(int), hipMemcpyDeviceToHost);
-    hipMemcpy((void*)h_fmtd16_, (void*)d_fmtd16_, sizeof(PimMemTraceData) * max_fmtd_size_, hipMemcpyDeviceToHost);
+    start_trace_collection(blocks, (hipStream_t)stream);
+    ret = pim_emulator_->execute_elt_op(output, operand0, operand1, nullptr, 0, g_pim_base_addr[device_id]);
+    finish_trace_collection(OP_ELT_MUL);
+#else
+    if (block) hipStreamSynchronize((hipStream_t)stream);
+#endif
+    return ret;
+}
+
+int HipPimExecutor::execute_add_scalar(PimBo* output, uint16_t scalar, PimBo* operand, void* stream, bool block)
+{
+    return execute_elt_scalar_op(OP_ELT_ADD_SCALAR, output, scalar, operand, stream, block);
+}
+
+int HipPimExecutor::execute_mul_scalar(PimBo* output, uint16_t scalar, PimBo* operand, void* stream, bool block)
+{
+    return execute_elt_scalar_op(OP_ELT_MUL_SCALAR, output, scalar, operand, stream, block);
+}
 
-    for (size_t i = 1; i < blocks; i++) {
-        memcpy(&h_fmtd16_[i * h_fmtd16_size_[0]], &h_fmtd16_[i * fmtd_size_per_ch_],
-               h_fmtd16_size_[0] * sizeof(PimMemTraceData));
+int HipPimExecutor::execute_elt_scalar_op(PimOpType op_type, PimBo* output, uint16_t scalar, PimBo* operand,
+                                          void* stream, bool block)
+{
+    DLOG(INFO) << "[START] " << __FUNCTION__ << " called";
+    int ret = 0;
+
+    int output_size = output->size;
+
+    uint8_t* crf_bin = pim_crf_generator_->find_crf(op_type, output_size);
+    int crf_size = pim_crf_generator_->get_crf_size(op_type, output_size);
+    if (crf_bin == nullptr) {
+        crf_bin = (uint8_t*)pim_crf_generator_->make_crf_bin(op_type, output_size);
     }
-    h_fmtd16_size_[0] *= blocks;
-    pim_emulator_->convert_mem_trace_from_16B_to_32B(h_fmtd32_, h_fmtd32_size_, h_fmtd16_, h_fmtd16_size_[0],
-                                                     OP_ELT_MUL);
-    pim_emulator_->execute_elt_op(output, operand0, operand1, h_fmtd32_, h_fmtd32_size_[0], g_pim_base_addr[device_id]);
+
+    uint8_t srf_binary[32];
+    int srf_size = sizeof(srf_binary);
+    ret = pim_crf_generator_->preprocess_srf_scalar(op_type, scalar, srf_binary);
+    if (ret != 0) return ret;
+
+    hipMemcpy((void*)d_srf_bin_buffer_, (void*)srf_binary, srf_size, hipMemcpyHostToDevice);
+
+    int align_size = (131072 << 1);
+    int num_tile = (output_size + align_size - 1) / align_size;
+
+    unsigned blocks = 64;
+    unsigned threads_per_block = 32;
+    int device_id;
+    hipGetDevice(&device_id);
+    hipLaunchKernelGGL(elt_scalar_op_pim, dim3(blocks), dim3(threads_per_block), 0, (hipStream_t)stream,
+                       (uint8_t*)operand->data, (uint8_t*)(g_pim_base_addr[device_id]), (uint8_t*)output->data,
+                       num_tile,
+#ifdef EMULATOR
+                       (PimMemTraceData*)d_fmtd16_, (int*)d_fmtd16_size_, fmtd_size_per_ch_,
+                       (PimMemTracer*)d_emulator_trace_,
+#endif
+                       (uint8_t*)crf_bin, crf_size, (uint8_t*)d_srf_bin_buffer_,
+                       pim_crf_generator_->get_stmt_args(op_type));
+#ifdef EMULATOR
+    start_trace_collection(blocks, (hipStream_t)stream);
+    ret = pim_emulator_->execute_elt_scalar_op(output, operand, nullptr, 0, g_pim_base_addr[device_id]);
+    finish_trace_collection(op_type);
 #else
     if (block) hipStreamSynchronize((hipStream_t)stream);
 #endif
+
+    DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
     return ret;
 }
 
@@ -239,34 +388,24 @@ int HipPimExecutor::execute_gemm(PimBo* output, PimBo* input, PimBo* weight, Pim
     int ret = 0;
     if (kernel_type_ == CUSTOM_GPU) {
         ret = this->execute_gemv(output, input, weight, bias, act_func, stream, block);
-    } else if (kernel_type_ == PIM) {
+    } else if (kernel_type_ == PIM || is_pim_applicable(weight, gemm_order_)) {
         PimBo* pim_wei;
-        if (weight->data_layout_type == PimDataLayoutType::RAW) {
-            pim_wei = pim_runtime_->get_preloaded_pim_gemm_weight(weight, gemm_order_);
+        bool cached = weight->data_layout_type == PimDataLayoutType::RAW;
+        if (cached) {
+            /* pinned so that an insert on another thread or stream can not free it under this gemm */
+            pim_wei = pim_runtime_->get_preloaded_pim_gemm_weight(weight, gemm_order_, false, stream, true, true);
+            if (pim_wei == nullptr) return -1;
         } else {
             // Assume that user has provided correct layout
             pim_wei = weight;
         }
+        /* gemm kernel is implemented based on I_X_W order */
         if (gemm_order_ == W_X_I) set_pimbo_t(input, pim_wei, bias, output);
         ret = this->execute_hip_gemm(output, input, pim_wei, bias, act_func, stream, block);
         if (gemm_order_ == W_X_I) set_pimbo_t(input, pim_wei, bias, output);
+        if (cached) pim_runtime_->unpin_preloaded_pim_weight(pim_wei, stream);
     } else {
-        if (is_pim_applicable(weight, gemm_order_)) {
-            PimBo* pim_wei;
-            if (weight->data_layout_type == PimDataLayoutType::RAW) {
-                pim_wei = pim_runtime_->get_preloaded_pim_gemm_weight(weight, gemm_order_);
-            } else {
-                // Assume that user has provided correct layout
-                pim_wei = weight;
-            }
-            /* gemm kernel is implemented based on I_X_W order */
-
-            if (gemm_order_ == W_X_I) set_pimbo_t(input, pim_wei, bias, output);
-            ret = this->execute_hip_gemm(output, input, pim_wei, bias, act_func, stream, block);
-            if (gemm_order_ == W_X_I) set_pimbo_t(input, pim_wei, bias, output);
-        } else {
-            ret = this->execute_gemv(output, input, weight, bias, act_func, stream, block);
-        }
+        ret = this->execute_gemv(output, input, weight, bias, act_func, stream, block);
     }
     return ret;
 }
@@ -305,7 +444,7 @@ int HipPimExecutor::execute_relu(PimBo* output, PimBo* pim_data, void* stream, b
     int ret = 0;
 
     uint8_t* crf_bin = pim_crf_generator_->find_crf(OP_RELU, output->size);
-    int crf_size = 32;
+    int crf_size = pim_crf_generator_->get_crf_size(OP_RELU, output->size);
     if (crf_bin == nullptr) {
         crf_bin = (uint8_t*)pim_crf_generator_->make_crf_bin(OP_RELU, output->size);
     }
@@ -320,22 +459,76 @@ int HipPimExecutor::execute_relu(PimBo* output, PimBo* pim_data, void* stream, b
 #ifdef EMULATOR
         (PimMemTraceData*)d_fmtd16_, (int*)d_fmtd16_size_, fmtd_size_per_ch_, (PimMemTracer*)d_emulator_trace_,
 #endif
-        (uint8_t*)crf_bin, crf_size);
+        (uint8_t*)crf_bin, crf_size, pim_crf_generator_->get_stmt_args(OP_RELU));
 #ifdef EMULATOR
-    hipStreamSynchronize((hipStream_t)stream);
-    hipMemcpy((void*)h_fmtd16_size_, (void*)d_fmtd16_size_, sizeof(int), hipMemcpyDeviceToHost);
-    hipMemcpy((void*)h_fmtd16_, (void*)d_fmtd16_, sizeof(PimMemTraceData) * max_fmtd_size_, hipMemcpyDeviceToHost);
+    start_trace_collection(blocks, (hipStream_t)stream);
+    ret = pim_emulator_->execute_relu(output, pim_data, nullptr, 0, g_pim_base_addr[device_id]);
+    finish_trace_collection(OP_RELU);
+#else
+    if (block) hipStreamSynchronize((hipStream_t)stream);
+#endif
+    return ret;
+}
+
+int HipPimExecutor::execute_elt_chain(PimBo* output, PimBo* input, const PimEltChainStep* steps, int num_steps,
+                                      void* stream, bool block)
+{
+    DLOG(INFO) << "[START] " << __FUNCTION__ << " called";
+    int ret = check_elt_chain(output, input, steps, num_steps);
+    if (ret != 0) return ret;
+
+    int output_size = output->size;
+    int crf_size = 0;
+    PimEltChainProgram program;
+    uint8_t* crf_bin = pim_crf_generator_->get_elt_chain_crf(steps, num_steps, output_size, &program, &crf_size);
+    if (crf_bin == nullptr) {
+        DLOG(ERROR) << "elt chain can not be fused into one CRF program";
+        return -1;
+    }
+
+    uint8_t srf_binary[32];
+    int srf_size = sizeof(srf_binary);
+    pim_crf_generator_->preprocess_srf_affine(program.scale, program.shift, srf_binary);
+    hipMemcpy((void*)d_srf_bin_buffer_, (void*)srf_binary, srf_size, hipMemcpyHostToDevice);
 
-    for (size_t i = 1; i < blocks; i++) {
-        memcpy(&h_fmtd16_[i * h_fmtd16_size_[0]], &h_fmtd16_[i * fmtd_size_per_ch_],
-               h_fmtd16_size_[0] * sizeof(PimMemTraceData));
+    EltChainArgs args = {};
+    PimBo* operands[ELT_CHAIN_MAX_OPERANDS + 1] = {input};
+    int num_operand = 1;
+    for (int i = 0; i < num_steps; i++) {
+        if (steps[i].op_type == ELT_CHAIN_ADD || steps[i].op_type == ELT_CHAIN_MUL) {
+            operands[num_operand++] = steps[i].operand;
+        }
+    }
+    for (int i = 0; i < num_operand; i++) args.operand[i] = (uint8_t*)operands[i]->data;
+    for (size_t i = 0; i < program.stmt_src.size(); i++) {
+        args.stmt_src[i] = program.stmt_src[i];
+        args.stmt_cols[i] = program.stmt_cols[i];
     }
-    h_fmtd16_size_[0] *= blocks;
-    pim_emulator_->convert_mem_trace_from_16B_to_32B(h_fmtd32_, h_fmtd32_size_, h_fmtd16_, h_fmtd16_size_[0], OP_RELU);
-    pim_emulator_->execute_relu(output, pim_data, h_fmtd32_, h_fmtd32_size_[0], g_pim_base_addr[device_id]);
+    args.num_stmt = program.stmt_src.size();
+
+    int align_size = (131072 << 1);
+    int num_tile = (output_size + align_size - 1) / align_size;
+
+    unsigned blocks = 64;
+    unsigned threads_per_block = 32;
+    int device_id;
+    hipGetDevice(&device_id);
+    hipLaunchKernelGGL(elt_chain_op_pim, dim3(blocks), dim3(threads_per_block), 0, (hipStream_t)stream, args,
+                       (uint8_t*)(g_pim_base_addr[device_id]), (uint8_t*)output->data, num_tile,
+#ifdef EMULATOR
+                       (PimMemTraceData*)d_fmtd16_, (int*)d_fmtd16_size_, fmtd_size_per_ch_,
+                       (PimMemTracer*)d_emulator_trace_,
+#endif
+                       (uint8_t*)crf_bin, crf_size, (uint8_t*)d_srf_bin_buffer_);
+#ifdef EMULATOR
+    start_trace_collection(blocks, (hipStream_t)stream);
+    ret = pim_emulator_->execute_elt_chain_op(output, operands, num_operand, nullptr, 0, g_pim_base_addr[device_id]);
+    finish_trace_collection(OP_ELT_CHAIN);
 #else
     if (block) hipStreamSynchronize((hipStream_t)stream);
 #endif
+
+    DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
     return ret;
 }
 
@@ -345,7 +538,7 @@ int HipPimExecutor::execute_copy(PimBo* output, PimBo* pim_data, void* stream, b
     int ret = 0;
 
     uint8_t* crf_bin = pim_crf_generator_->find_crf(OP_COPY, output->size);
-    int crf_size = 32;
+    int crf_size = pim_crf_generator_->get_crf_size(OP_COPY, output->size);
     if (crf_bin == nullptr) {
         crf_bin = (uint8_t*)pim_crf_generator_->make_crf_bin(OP_COPY, output->size);
     }
@@ -361,19 +554,11 @@ int HipPimExecutor::execute_copy(PimBo* output, PimBo* pim_data, void* stream, b
 #ifdef EMULATOR
         (PimMemTraceData*)d_fmtd16_, (int*)d_fmtd16_size_, fmtd_size_per_ch_, (PimMemTracer*)d_emulator_trace_,
 #endif
-        (uint8_t*)crf_bin, crf_size);
+        (uint8_t*)crf_bin, crf_size, pim_crf_generator_->get_stmt_args(OP_COPY));
 #ifdef EMULATOR
-    hipStreamSynchronize((hipStream_t)stream);
-    hipMemcpy((void*)h_fmtd16_size_, (void*)d_fmtd16_size_, sizeof(int), hipMemcpyDeviceToHost);
-    hipMemcpy((void*)h_fmtd16_, (void*)d_fmtd16_, sizeof(PimMemTraceData) * max_fmtd_size_, hipMemcpyDeviceToHost);
-
-    for (size_t i = 1; i < blocks; i++) {
-        memcpy(&h_fmtd16_[i * h_fmtd16_size_[0]], &h_fmtd16_[i * fmtd_size_per_ch_],
-               h_fmtd16_size_[0] * sizeof(PimMemTraceData));
-    }
-    h_fmtd16_size_[0] *= blocks;
-    pim_emulator_->convert_mem_trace_from_16B_to_32B(h_fmtd32_, h_fmtd32_size_, h_fmtd16_, h_fmtd16_size_[0], OP_COPY);
-    pim_emulator_->execute_copy(output, pim_data, h_fmtd32_, h_fmtd32_size_[0], g_pim_base_addr[device_id]);
+    start_trace_collection(blocks, (hipStream_t)stream);
+    ret = pim_emulator_->execute_copy(output, pim_data, nullptr, 0, g_pim_base_addr[device_id]);
+    finish_trace_collection(OP_COPY);
 #else
     if (block) hipStreamSynchronize((hipStream_t)stream);
 #endif
@@ -388,7 +573,7 @@ int HipPimExecutor::execute_bn(PimBo* output, PimBo* pim_data, PimBo* beta, PimB
     int output_size = output->size;
 
     uint8_t* crf_bin = pim_crf_generator_->find_crf(OP_BN, output_size);
-    int crf_size = 64;
+    int crf_size = pim_crf_generator_->get_crf_size(OP_BN, output_size);
     if (crf_bin == nullptr) {
         crf_bin = (uint8_t*)pim_crf_generator_->make_crf_bin(OP_BN, output_size);
     }
@@ -413,21 +598,13 @@ int HipPimExecutor::execute_bn(PimBo* output, PimBo* pim_data, PimBo* beta, PimB
                        (PimMemTraceData*)d_fmtd16_, (int*)d_fmtd16_size_, fmtd_size_per_ch_,
                        (PimMemTracer*)d_emulator_trace_,
 #endif
-                       (uint8_t*)crf_bin, crf_size, (uint8_t*)d_srf_bin_buffer_, srf_size);
+                       (uint8_t*)crf_bin, crf_size, (uint8_t*)d_srf_bin_buffer_, srf_size,
+                       pim_crf_generator_->get_stmt_args(OP_BN));
 
 #ifdef EMULATOR
-    hipStreamSynchronize((hipStream_t)stream);
-    hipMemcpy((void*)h_fmtd16_size_, (void*)d_fmtd16_size_, sizeof(int), hipMemcpyDeviceToHost);
-    hipMemcpy((void*)h_fmtd16_, (void*)d_fmtd16_, sizeof(PimMemTraceData) * max_fmtd_size_, hipMemcpyDeviceToHost);
-
-    for (size_t i = 1; i < blocks; i++) {
-        memcpy(&h_fmtd16_[i * h_fmtd16_size_[0]], &h_fmtd16_[i * fmtd_size_per_ch_],
-               h_fmtd16_size_[0] * sizeof(PimMemTraceData));
-    }
-    h_fmtd16_size_[0] *= blocks;
-    pim_emulator_->convert_mem_trace_from_16B_to_32B(h_fmtd32_, h_fmtd32_size_, h_fmtd16_, h_fmtd16_size_[0], OP_BN);
-    pim_emulator_->execute_bn(output, pim_data, h_fmtd32_, h_fmtd32_size_[0], g_pim_base_addr[device_id],
-                              pim_gemv_tmp_buffer_);
+    start_trace_collection(blocks, (hipStream_t)stream);
+    ret = pim_emulator_->execute_bn(output, pim_data, nullptr, 0, g_pim_base_addr[device_id], pim_gemv_tmp_buffer_);
+    finish_trace_collection(OP_BN);
 #else
     if (block) hipStreamSynchronize((hipStream_t)stream);
 #endif
@@ -635,22 +812,14 @@ int HipPimExecutor::execute_aligned_gemm_tile_accum(PimBo* output, PimBo* input,
     PIM_PROFILE_TOCK(RunGemmKernel);
 
     PIM_PROFILE_TICK(RunGemmEmulation);
-    hipMemcpy((void*)h_fmtd16_size_, (void*)d_fmtd16_size_, sizeof(int), hipMemcpyDeviceToHost);
-    hipMemcpy((void*)h_fmtd16_, (void*)d_fmtd16_, sizeof(PimMemTraceData) * max_fmtd_size_, hipMemcpyDeviceToHost);
-
-    for (size_t i = 1; i < blocks; i++) {
-        memcpy(&h_fmtd16_[i * h_fmtd16_size_[0]], &h_fmtd16_[i * fmtd_size_per_ch_],
-               h_fmtd16_size_[0] * sizeof(PimMemTraceData));
-    }
-    h_fmtd16_size_[0] *= blocks;
-
-    pim_emulator_->convert_mem_trace_from_16B_to_32B(h_fmtd32_, h_fmtd32_size_, h_fmtd16_, h_fmtd16_size_[0], OP_GEMV);
+    start_trace_collection(blocks, (hipStream_t)stream);
     if (is_gemv_add)
-        pim_emulator_->execute_gemv_add_tile_accum(output, weight, h_fmtd32_, h_fmtd32_size_[0], OP_GEMV,
-                                                   g_pim_base_addr[device_id], pim_gemv_tmp_buffer_);
+        ret = pim_emulator_->execute_gemv_add_tile_accum(output, weight, nullptr, 0, OP_GEMV,
+                                                         g_pim_base_addr[device_id], pim_gemv_tmp_buffer_);
     else
-        pim_emulator_->execute_gemm_bias_act(output, weight, h_fmtd32_, h_fmtd32_size_[0], OP_GEMV,
-                                             g_pim_base_addr[device_id], pim_gemv_tmp_buffer_, bias, act_func);
+        ret = pim_emulator_->execute_gemm_bias_act(output, weight, nullptr, 0, OP_GEMV, g_pim_base_addr[device_id],
+                                                   pim_gemv_tmp_buffer_, bias, act_func);
+    finish_trace_collection(OP_GEMV);
 
     PIM_PROFILE_TOCK(RunGemmEmulation);
 #endif
@@ -726,22 +895,14 @@ int HipPimExecutor::execute_chwise_gemm_tile_accum(PimBo* output, PimBo* input,
     PIM_PROFILE_TOCK(RunGemmKernel);
 
     PIM_PROFILE_TICK(RunGemmEmulation);
-    hipMemcpy((void*)h_fmtd16_size_, (void*)d_fmtd16_size_, sizeof(int), hipMemcpyDeviceToHost);
-    hipMemcpy((void*)h_fmtd16_, (void*)d_fmtd16_, sizeof(PimMemTraceData) * max_fmtd_size_, hipMemcpyDeviceToHost);
-
-    for (size_t i = 1; i < blocks; i++) {
-        memcpy(&h_fmtd16_[i * h_fmtd16_size_[0]], &h_fmtd16_[i * fmtd_size_per_ch_],
-               h_fmtd16_size_[0] * sizeof(PimMemTraceData));
-    }
-    h_fmtd16_size_[0] *= blocks;
-
-    pim_emulator_->convert_mem_trace_from_16B_to_32B(h_fmtd32_, h_fmtd32_size_, h_fmtd16_, h_fmtd16_size_[0], OP_GEMV);
+    start_trace_collection(blocks, (hipStream_t)stream);
     if (is_gemv_add)
-        pim_emulator_->execute_gemv_add_tile_accum(output, weight, h_fmtd32_, h_fmtd32_size_[0], OP_GEMV,
-                                                   g_pim_base_addr[device_id], pim_gemv_tmp_buffer_);
+        ret = pim_emulator_->execute_gemv_add_tile_accum(output, weight, nullptr, 0, OP_GEMV,
+                                                         g_pim_base_addr[device_id], pim_gemv_tmp_buffer_);
     else
-        pim_emulator_->execute_gemm_bias_act(output, weight, h_fmtd32_, h_fmtd32_size_[0], OP_GEMV,
-                                             g_pim_base_addr[device_id], pim_gemv_tmp_buffer_, bias, act_func);
+        ret = pim_emulator_->execute_gemm_bias_act(output, weight, nullptr, 0, OP_GEMV, g_pim_base_addr[device_id],
+                                                   pim_gemv_tmp_buffer_, bias, act_func);
+    finish_trace_collection(OP_GEMV);
 
     PIM_PROFILE_TOCK(RunGemmEmulation);
 #endif
@@ -750,6 +911,171 @@ int HipPimExecutor::execute_chwise_gemm_tile_accum(PimBo* output, PimBo* input,
 }
 
 int HipPimExecutor::execute_sync(void* stream) { return hipStreamSynchronize((hipStream_t)stream); }
+uint8_t* HipPimExecutor::get_crf_bin(PimOpType op_type, int output_size)
+{
+    uint8_t* crf_bin = pim_crf_generator_->find_crf(op_type, output_size);
+    if (crf_bin == nullptr) {
+        crf_bin = (uint8_t*)pim_crf_generator_->make_crf_bin(op_type, output_size);
+    }
+    return crf_bin;
+}
+
+int HipPimExecutor::instantiate_graph(PimGraph* graph)
+{
+    DLOG(INFO) << "[START] " << __FUNCTION__ << " called";
+    int ret = 0;
+#ifndef EMULATOR
+    /* CRF binaries, SRF images and tile counts are resolved once here instead of on every launch */
+    auto list = std::make_shared<HipGraphLaunchList>();
+    int align_size = (131072 << 1);
+    hipGetDevice(&list->device_id);
+    list->crf_version = pim_crf_generator_->get_crf_version();
+
+    for (auto& node : graph->nodes) {
+        HipGraphLaunch launch = {node.op_type, nullptr, 32, 0, nullptr, 0,
+                                 pim_crf_generator_->get_stmt_args(node.op_type)};
+        int output_size = node.output->size;
+
+        switch (node.op_type) {
+            case OP_ELT_ADD:
+            case OP_ELT_MUL:
+            case OP_RELU:
+            case OP_COPY:
+                launch.crf_bin = get_crf_bin(node.op_type, output_size);
+                launch.crf_size = pim_crf_generator_->get_crf_size(node.op_type, output_size);
+                launch.num_tile = (output_size + align_size - 1) / align_size;
+                break;
+            case OP_ELT_ADD_SCALAR:
+            case OP_ELT_MUL_SCALAR: {
+                uint8_t srf_binary[32];
+                ret = pim_crf_generator_->preprocess_srf_scalar(node.op_type, node.scalar, srf_binary);
+                if (ret != 0) break;
+                launch.crf_bin = get_crf_bin(node.op_type, output_size);
+                launch.crf_size = pim_crf_generator_->get_crf_size(node.op_type, output_size);
+                launch.num_tile = (output_size + align_size - 1) / align_size;
+                launch.srf_size = sizeof(srf_binary);
+                hipMalloc((void**)&launch.d_srf_bin, launch.srf_size);
+                hipMemcpy((void*)launch.d_srf_bin, (void*)srf_binary, launch.srf_size, hipMemcpyHostToDevice);
+                break;
+            }
+            case OP_BN: {
+                int srf_size = pbi_->num_pim_chan * pbi_->num_pim_rank * pbi_->trans_size;
+                std::vector<uint8_t> srf_binary(srf_size);
+                pim_crf_generator_->preprocess_srf(node.beta, node.gamma, node.mean, node.variance, node.epsilon,
+                                                   srf_binary.data());
+                launch.crf_bin = get_crf_bin(OP_BN, output_size);
+                launch.crf_size = pim_crf_generator_->get_crf_size(OP_BN, output_size);
+                launch.num_tile = output_size / align_size;
+                launch.srf_size = srf_size;
+                hipMalloc((void**)&launch.d_srf_bin, srf_size);
+                hipMemcpy((void*)launch.d_srf_bin, (void*)srf_binary.data(), srf_size, hipMemcpyHostToDevice);
+                break;
+            }
+            case OP_GEMM:
+                /* weight layout and kernel are chosen per call, so gemm nodes run through execute_gemm */
+                break;
+            case OP_ELT_CHAIN:
+                /* fused programs are cached by the CRF generator, so chain nodes run through execute_elt_chain */
+                break;
+            default:
+                DLOG(ERROR) << "op " << get_pim_op_string(node.op_type) << " can not be replayed";
+                ret = -1;
+        }
+        list->launches.push_back(launch);
+        if (ret != 0) break;
+    }
+    if (ret == 0) graph->launch_data = list;
+#endif
+    DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
+    return ret;
+}
+
+int HipPimExecutor::execute_graph(PimGraph* graph, void* stream, bool block)
+{
+    DLOG(INFO) << "[START] " << __FUNCTION__ << " called";
+    int ret = 0;
+#ifdef EMULATOR
+    /* every op collects and simulates its own memory trace, so nodes are replayed one by one */
+    ret = execute_graph_nodes(this, graph, stream, block);
+#else
+    auto list = std::static_pointer_cast<HipGraphLaunchList>(graph->launch_data);
+    if (list == nullptr || list->launches.size() != graph->nodes.size()) {
+        DLOG(ERROR) << "graph is not instantiated";
+        return -1;
+    }
+    /* a replaced CRF program freed or rewrote binaries the launches point to, so they are resolved again */
+    if (list->crf_version != pim_crf_generator_->get_crf_version()) {
+        graph->launch_data = nullptr;
+        list = nullptr;
+        if (instantiate_graph(graph) != 0) {
+            DLOG(ERROR) << "fail to instantiate the graph again after a CRF program was replaced";
+            return -1;
+        }
+        list = std::static_pointer_cast<HipGraphLaunchList>(graph->launch_data);
+    }
+
+    uint8_t* pim_base = (uint8_t*)g_pim_base_addr[list->device_id];
+    unsigned blocks = 64;
+    unsigned threads_per_block = 32;
+    for (size_t i = 0; i < graph->nodes.size() && ret == 0; i++) {
+        const PimGraphNode& node = graph->nodes[i];
+        const HipGraphLaunch& launch = list->launches[i];
+
+        switch (node.op_type) {
+            case OP_ELT_ADD:
+            case OP_ELT_MUL:
+                hipLaunchKernelGGL(elt_op_pim, dim3(blocks), dim3(threads_per_block), 0, (hipStream_t)stream,
+                                   (uint8_t*)node.operand0->data, (uint8_t*)node.operand1->data, pim_base,
+                                   (uint8_t*)node.output->data, launch.num_tile, launch.crf_bin, launch.crf_size,
+                                   launch.stmt_args);
+                break;
+            case OP_ELT_ADD_SCALAR:
+            case OP_ELT_MUL_SCALAR:
+                hipLaunchKernelGGL(elt_scalar_op_pim, dim3(blocks), dim3(threads_per_block), 0, (hipStream_t)stream,
+                                   (uint8_t*)node.operand0->data, pim_base, (uint8_t*)node.output->data,
+                                   launch.num_tile, launch.crf_bin, launch.crf_size, launch.d_srf_bin,
+                                   launch.stmt_args);
+                break;
+            case OP_RELU:
+                hipLaunchKernelGGL(relu_pim, dim3(pbi_->num_pim_chan), dim3(threads_per_block), 0,
+                                   (hipStream_t)stream, (uint8_t*)node.operand0->data, pim_base,
+                                   (uint8_t*)node.output->data, (int)node.output->size, launch.crf_bin,
+                                   launch.crf_size, launch.stmt_args);
+                break;
+            case OP_COPY:
+                hipLaunchKernelGGL(copy_pim, dim3(pbi_->num_pim_chan), dim3(threads_per_block), 0,
+                                   (hipStream_t)stream, (uint8_t*)node.operand0->data, pim_base,
+                                   (uint8_t*)node.output->data, (int)node.output->size, launch.crf_bin,
+                                   launch.crf_size, launch.stmt_args);
+                break;
+            case OP_BN:
+                hipLaunchKernelGGL(bn_pim_nr_sip, dim3(blocks), dim3(threads_per_block), 0, (hipStream_t)stream,
+                                   (uint8_t*)node.operand0->data, pim_base, (uint8_t*)pim_gemv_tmp_buffer_,
+                                   (uint8_t*)node.output->data, launch.num_tile, node.output->bshape.n,
+                                   node.output->bshape.c, node.output->bshape.w, launch.crf_bin, launch.crf_size,
+                                   launch.d_srf_bin, launch.srf_size, launch.stmt_args);
+                break;
+            default:
+                ret = execute_graph_node(this, node, stream);
+        }
+    }
+    if (ret == 0 && block) ret = hipStreamSynchronize((hipStream_t)stream);
+#endif
+    DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
+    return ret;
+}
+
+int HipPimExecutor::load_crf_program(PimOpType op_type, const PimCrfProgram& program)
+{
+    DLOG(INFO) << "[START] " << __FUNCTION__ << " called";
+    /* kernels in flight may still read the binaries which are freed or rewritten */
+    int ret = hipDeviceSynchronize();
+    if (ret == 0) ret = pim_crf_generator_->set_crf_program(op_type, program);
+
+    DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
+    return ret;
+}
+
 int HipPimExecutor::execute_dummy(void)
 {
     DLOG(INFO) << "[START] " << __FUNCTION__ << " called";
@@ -11,11 +11,18 @@
 
 #include "executor/ocl/OclPimExecutor.h"
 #include <assert.h>
+#include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <chrono>
+#include <iomanip>
 #include <iostream>
 #include "manager/HostInfo.h"
 #include "utility/assert_cl.h"
 #include "utility/pim_debug.hpp"
+#include "utility/pim_hash.h"
 #include "utility/pim_log.h"
 #include "utility/pim_profile.h"
 #include "utility/pim_util.h"
@@ -54,7 +61,19 @@ OclPimExecutor::OclPimExecutor(pim::runtime::manager::PimManager* pim_manager, p
         }
     }
 
+    auto start = std::chrono::high_resolution_clock::now();
     ret = check_cl_program_path();
+    if (ret == 1 /* binary path */) {
+        ret = build_cl_program_with_binary();
+        if (ret != CL_SUCCESS && !cl_source_.empty()) {
+            /* unreadable cache entry, rebuild and overwrite it */
+            DLOG(ERROR) << "Failed to build Pim Kernels from " << cl_binary_path_;
+            clReleaseProgram(program_);
+            ret = 0;
+        } else {
+            ret = 1;
+        }
+    }
     if (ret == 0 /* source path */) {
         ret = build_cl_program_with_source();
         if (ret != CL_SUCCESS) {
@@ -62,11 +81,12 @@ OclPimExecutor::OclPimExecutor(pim::runtime::manager::PimManager* pim_manager, p
             assert(0);
         }
         save_cl_program_binary();
-    } else if (ret == 1 /* binary path */) {
-        build_cl_program_with_binary();
-    } else {
+    } else if (ret != 1) {
         assert(0);
     }
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - start;
+    LOG(INFO) << "OpenCL program cache " << (ret == 1 ? "hit " : "miss ") << cl_binary_path_ << " load time "
+              << elapsed.count() << " ms";
 
     pim_crf_generator_ = std::make_shared<PimCrfBinGen>(pim_manager_);
     pim_device_ = pim_manager_->get_pim_device();
@@ -82,6 +102,8 @@ OclPimExecutor::OclPimExecutor(pim::runtime::manager::PimManager* pim_manager, p
     cl_ok(exec_err_);
     bn_kernel_ = clCreateKernel(program_, "bn_pim_nr_sip", &exec_err_);
     cl_ok(exec_err_);
+    elt_scalar_kernel_ = clCreateKernel(program_, "elt_scalar_op_pim", &exec_err_);
+    cl_ok(exec_err_);
     pim_aligned_gemm_bias_relu_8tile_fp16_ =
         clCreateKernel(program_, "pim_aligned_gemm_bias_relu_8tile_fp16", &exec_err_);
     cl_ok(exec_err_);
@@ -112,6 +134,7 @@ OclPimExecutor::~OclPimExecutor(void)
     clReleaseKernel(relu_kernel_);
     clReleaseKernel(copy_kernel_);
     clReleaseKernel(bn_kernel_);
+    clReleaseKernel(elt_scalar_kernel_);
     clReleaseKernel(pim_aligned_gemm_bias_relu_8tile_fp16_);
     clReleaseKernel(pim_aligned_gemm_bias_relu_fp16_);
     clReleaseKernel(pim_chwise_gemm_bias_relu_32tile_fp16_);
@@ -120,29 +143,96 @@ OclPimExecutor::~OclPimExecutor(void)
     DLOG(INFO) << "[END] " << __FUNCTION__ << " called ";
 }
 
-int OclPimExecutor::check_cl_program_path(void)
+static std::string get_cl_device_info(cl_device_info param)
 {
-    cl_binary_path_ = CL_KERNEL_BINARY_PATH;
-    cl_binary_path_ += "ocl_pimk.bin";
-    std::ifstream cl_binary_file(cl_binary_path_, std::ios::in);
+    size_t len = 0;
+    if (clGetDeviceInfo(device_id, param, 0, NULL, &len) != CL_SUCCESS || len == 0) return "";
 
-    if (cl_binary_file.is_open()) {
-        // printf("cl binary is available\n");
-        cl_binary_file.close();
-        return 1;
+    std::string info(len, '\0');
+    clGetDeviceInfo(device_id, param, len, &info[0], NULL);
+    return info;
+}
+
+static std::string get_cl_cache_dir(void)
+{
+    if (const char* env_dir = std::getenv("PIM_OCL_CACHE_DIR")) return env_dir;
+    if (const char* env_xdg = std::getenv("XDG_CACHE_HOME")) return std::string(env_xdg) + "/pim/ocl";
+    if (const char* env_home = std::getenv("HOME")) return std::string(env_home) + "/.cache/pim/ocl";
+    return "";
+}
+
+static bool make_directory(const std::string& path)
+{
+    for (size_t pos = path.find('/', 1); pos != std::string::npos; pos = path.find('/', pos + 1)) {
+        mkdir(path.substr(0, pos).c_str(), 0755);
     }
+    mkdir(path.c_str(), 0755);
+
+    struct stat st;
+    return stat(path.c_str(), &st) == 0 && S_ISDIR(st.st_mode);
+}
+
+static bool is_file_available(const std::string& path)
+{
+    std::ifstream file(path.c_str(), std::ios::in);
+    return file.is_open();
+}
+
+std::string OclPimExecutor::get_cl_program_key(void)
+{
+    /* everything that changes the program binary, separated so that fields cannot run into each other */
+    std::string key_src = cl_source_ + '\0' + cl_build_options_ + '\0' + get_cl_device_info(CL_DEVICE_NAME) + '\0' +
+                          get_cl_device_info(CL_DRIVER_VERSION) + '\0' + get_cl_device_info(CL_DEVICE_VERSION);
+    std::vector<uint64_t> staging(hash::num_words(key_src.size()));
+    memcpy(staging.data(), key_src.data(), key_src.size());
+    PimContentHash hash = hash::hash_host_memory(staging.data(), key_src.size());
+
+    std::ostringstream key;
+    key << std::hex << std::setfill('0') << std::setw(16) << hash.h0 << std::setw(16) << hash.h1;
+    return key.str();
+}
 
+int OclPimExecutor::check_cl_program_path(void)
+{
+    /*
+     * binaries are named by a hash of the sources, build options, device and driver, so a change of any of them
+     * misses the cache and rebuilds. The per-user cache directory is searched before the installed binaries.
+     */
     std::string cl_source_path;
     cl_source_path = CL_KERNEL_SOURCE_PATH;
     cl_source_path += "pim_op_kernels.cl";
-    std::ifstream cl_source_file(cl_source_path.c_str(), std::ios::in);
 
-    if (cl_source_file.is_open()) {
-        // printf("cl source is available\n");
-        cl_source_file.close();
+    if (is_file_available(cl_source_path)) {
+        load_cl_program_source();
+        std::string cl_binary_name = "ocl_pimk-" + get_cl_program_key() + ".bin";
+
+        cl_cache_dir_ = get_cl_cache_dir();
+        if (!cl_cache_dir_.empty()) {
+            cl_binary_path_ = cl_cache_dir_ + "/" + cl_binary_name;
+            if (is_file_available(cl_binary_path_)) {
+                return 1;
+            }
+        }
+
+        std::string cl_installed_path = std::string(CL_KERNEL_BINARY_PATH) + cl_binary_name;
+        if (is_file_available(cl_installed_path)) {
+            cl_binary_path_ = cl_installed_path;
+            return 1;
+        }
         return 0;
     }
 
+    /*
+     * without the sources the installed binary can not be validated, it is used as is. build.sh installs it next
+     * to the keyed binaries, built for the device and driver of the build host
+     */
+    cl_binary_path_ = CL_KERNEL_BINARY_PATH;
+    cl_binary_path_ += "ocl_pimk.bin";
+    if (is_file_available(cl_binary_path_)) {
+        DLOG(WARNING) << "OpenCL kernel sources are not available, using " << cl_binary_path_;
+        return 1;
+    }
+
     return -1;
 }
 
@@ -163,44 +253,53 @@ std::string OclPimExecutor::load_cl_file(std::string filename)
     return result;
 }
 
+void OclPimExecutor::load_cl_program_source(void)
+{
+    cl_source_ = load_cl_file("PimInfo.cl");
+    cl_source_ += load_cl_file("pim_op_kernels.cl");
+    cl_source_ += load_cl_file("pim_gemm.cl");
+    cl_source_ += load_cl_file("pim_copy.cl");
+    cl_source_ += load_cl_file("pim_bn.cl");
+    cl_source_ += load_cl_file("pim_elt_scalar.cl");
+
+    cl_build_options_ = "-I" + std::string(CL_KERNEL_INCLUDE_PATH) + "/manager";
+#ifdef EMULATOR
+    cl_build_options_ += " -DEMULATOR";
+#endif
+    // to disable the kernel opt while compliling binary so that it does not remove the dummy read calls meant for PIM.
+    cl_build_options_ += " -cl-opt-disable";
+}
+
 int OclPimExecutor::build_cl_program_with_source(void)
 {
     int ret = 0;
-    std::string cl_source;
     const char* cl_source_ptr = nullptr;
 
-    cl_source = load_cl_file("PimInfo.cl");
-    cl_source += load_cl_file("pim_op_kernels.cl");
-    cl_source += load_cl_file("pim_gemm.cl");
-    cl_source += load_cl_file("pim_copy.cl");
-    cl_source += load_cl_file("pim_bn.cl");
-    cl_source_ptr = cl_source.c_str();
+    if (cl_source_.empty()) {
+        load_cl_program_source();
+    }
+    cl_source_ptr = cl_source_.c_str();
 
     program_ = clCreateProgramWithSource(context, 1, (const char**)&cl_source_ptr, NULL, NULL);
-    string options = "-I" + std::string(CL_KERNEL_INCLUDE_PATH) + "/manager";
-#ifdef EMULATOR
-    options += " -DEMULATOR";
-#endif
-    // to disable the kernel opt while compliling binary so that it does not remove the dummy read calls meant for PIM.
-    options += " -cl-opt-disable";
 
-    ret = clBuildProgram(program_, 1, &device_id, options.c_str(), NULL, NULL);
+    ret = clBuildProgram(program_, 1, &device_id, cl_build_options_.c_str(), NULL, NULL);
     if (ret != CL_SUCCESS) {
         size_t len;
         cl_build_status bldstatus;
+        cl_int info_ret;
 
         printf("\nError %d: Failed to build program executable [ %s ]\n", ret, clGetErrorString(ret));
-        ret = clGetProgramBuildInfo(program_, device_id, CL_PROGRAM_BUILD_STATUS, sizeof(bldstatus), (void*)&bldstatus,
-                                    &len);
+        info_ret = clGetProgramBuildInfo(program_, device_id, CL_PROGRAM_BUILD_STATUS, sizeof(bldstatus),
+                                         (void*)&bldstatus, &len);
         printf("INFO: %s\n", clGetErrorString(bldstatus));
-        ret = clGetProgramBuildInfo(program_, device_id, CL_PROGRAM_BUILD_LOG, 0, NULL, &len);
+        info_ret = clGetProgramBuildInfo(program_, device_id, CL_PROGRAM_BUILD_LOG, 0, NULL, &len);
         char* buffer = new char[len];
 
-        ret = clGetProgramBuildInfo(program_, device_id, CL_PROGRAM_BUILD_OPTIONS, len, buffer, NULL);
-        printf("Build Options %d: %s\n", ret, clGetErrorString(ret));
+        info_ret = clGetProgramBuildInfo(program_, device_id, CL_PROGRAM_BUILD_OPTIONS, len, buffer, NULL);
+        printf("Build Options %d: %s\n", info_ret, clGetErrorString(info_ret));
         printf("INFO: %s\n", buffer);
-        ret = clGetProgramBuildInfo(program_, device_id, CL_PROGRAM_BUILD_LOG, len, buffer, NULL);
-        printf("Build Log %d: %s\n", ret, clGetErrorString(ret));
+        info_ret = clGetProgramBuildInfo(program_, device_id, CL_PROGRAM_BUILD_LOG, len, buffer, NULL);
+        printf("Build Log %d: %s\n", info_ret, clGetErrorString(info_ret));
         printf("%s\n", buffer);
 
         delete[] buffer;
@@ -212,20 +311,32 @@ int OclPimExecutor::build_cl_program_with_source(void)
 int OclPimExecutor::save_cl_program_binary(void)
 {
     int ret = 0;
-    std::string cl_binary_name = "ocl_pimk.bin";
     const char* cl_binary_ptr = nullptr;
     size_t cl_binary_size = 0;
 
+    if (cl_cache_dir_.empty() || !make_directory(cl_cache_dir_)) {
+        DLOG(WARNING) << "OpenCL program cache directory is not available";
+        return -1;
+    }
+    cl_binary_path_ = cl_cache_dir_ + "/ocl_pimk-" + get_cl_program_key() + ".bin";
+
     clGetProgramInfo(program_, CL_PROGRAM_BINARY_SIZES, sizeof(size_t), &cl_binary_size, NULL);
     cl_binary_ptr = new char[cl_binary_size];
     clGetProgramInfo(program_, CL_PROGRAM_BINARIES, sizeof(char*), (char**)&cl_binary_ptr, NULL);
 
-    ofstream bf(cl_binary_name.c_str());
+    /* written to a private file first so that concurrent processes never read a partial binary */
+    std::string tmp_path = cl_binary_path_ + ".tmp." + std::to_string(getpid());
+    ofstream bf(tmp_path.c_str(), ios::binary);
     bf.write(cl_binary_ptr, cl_binary_size);
-
     bf.close();
     delete[] cl_binary_ptr;
 
+    if (!bf || rename(tmp_path.c_str(), cl_binary_path_.c_str()) != 0) {
+        DLOG(ERROR) << "Failed to save OpenCL program binary " << cl_binary_path_;
+        remove(tmp_path.c_str());
+        ret = -1;
+    }
+
     return ret;
 }
 
@@ -248,19 +359,20 @@ int OclPimExecutor::build_cl_program_with_binary(void)
     if (ret != CL_SUCCESS) {
         size_t len;
         cl_build_status bldstatus;
+        cl_int info_ret;
 
         printf("\nError %d: Failed to build program executable [ %s ]\n", ret, clGetErrorString(ret));
-        ret = clGetProgramBuildInfo(program_, device_id, CL_PROGRAM_BUILD_STATUS, sizeof(bldstatus), (void*)&bldstatus,
-                                    &len);
+        info_ret = clGetProgramBuildInfo(program_, device_id, CL_PROGRAM_BUILD_STATUS, sizeof(bldstatus),
+                                         (void*)&bldstatus, &len);
         printf("INFO: %s\n", clGetErrorString(bldstatus));
-        ret = clGetProgramBuildInfo(program_, device_id, CL_PROGRAM_BUILD_LOG, 0, NULL, &len);
+        info_ret = clGetProgramBuildInfo(program_, device_id, CL_PROGRAM_BUILD_LOG, 0, NULL, &len);
         char* buffer = new char[len];
 
-        ret = clGetProgramBuildInfo(program_, device_id, CL_PROGRAM_BUILD_OPTIONS, len, buffer, NULL);
-        printf("Build Options %d: %s\n", ret, clGetErrorString(ret));
+        info_ret = clGetProgramBuildInfo(program_, device_id, CL_PROGRAM_BUILD_OPTIONS, len, buffer, NULL);
+        printf("Build Options %d: %s\n", info_ret, clGetErrorString(info_ret));
         printf("INFO: %s\n", buffer);
-        ret = clGetProgramBuildInfo(program_, device_id, CL_PROGRAM_BUILD_LOG, len, buffer, NULL);
-        printf("Build Log %d: %s\n", ret, clGetErrorString(ret));
+        info_ret = clGetProgramBuildInfo(program_, device_id, CL_PROGRAM_BUILD_LOG, len, buffer, NULL);
+        printf("Build Log %d: %s\n", info_ret, clGetErrorString(info_ret));
         printf("%s\n", buffer);
 
         delete[] buffer;
@@ -320,6 +432,7 @@ int OclPimExecutor::deinitialize(void)
     ret = pim_manager_->free_memory((void*)pim_gemv_tmp_buffer_, MEM_TYPE_PIM);
     ret |= pim_manager_->free_memory((void*)d_srf_bin_buffer_, MEM_TYPE_DEVICE);
     ret |= pim_manager_->free_memory((void*)zero_buffer_, MEM_TYPE_DEVICE);
+    ret |= pim_crf_generator_->deinitialize();
 
 #ifdef EMULATOR
     clReleaseMemObject(cl_d_fmtd16_);
@@ -378,7 +491,8 @@ int OclPimExecutor::execute_eltwise(PimOpType eltop, PimBo* output, PimBo* opera
     int num_tile = (output_size + align_size - 1) / align_size;
 
     uint8_t* crf_bin = get_crf_bin(eltop, output->size);
-    int crf_size = CRF_BIN_SIZE;
+    int crf_size = pim_crf_generator_->get_crf_size(eltop, output->size);
+    PimOpStmtArgs stmt_args = pim_crf_generator_->get_stmt_args(eltop);
 
     cl_ok(clSetKernelArg(eltwise_kernel_, 0, sizeof(cl_mem),
                          (void*)&(((manager::OclBufferObj*)operand0->data)->dev_addr)));
@@ -390,12 +504,13 @@ int OclPimExecutor::execute_eltwise(PimOpType eltop, PimBo* output, PimBo* opera
     cl_ok(clSetKernelArg(eltwise_kernel_, 4, sizeof(cl_int), (void*)&num_tile));
     cl_ok(clSetKernelArg(eltwise_kernel_, 5, sizeof(cl_mem), (void*)&crf_bin));
     cl_ok(clSetKernelArg(eltwise_kernel_, 6, sizeof(cl_int), (void*)&crf_size));
+    cl_ok(clSetKernelArg(eltwise_kernel_, 7, sizeof(PimOpStmtArgs), (void*)&stmt_args));
 
 #ifdef EMULATOR
-    cl_ok(clSetKernelArg(eltwise_kernel_, 7, sizeof(cl_mem), (void*)&cl_d_fmtd16_));
-    cl_ok(clSetKernelArg(eltwise_kernel_, 8, sizeof(cl_mem), (void*)&cl_d_fmtd16_size_));
-    cl_ok(clSetKernelArg(eltwise_kernel_, 9, sizeof(cl_int), (void*)&fmtd_size_per_ch_));
-    cl_ok(clSetKernelArg(eltwise_kernel_, 10, sizeof(cl_mem), (void*)&cl_d_emulator_trace_));
+    cl_ok(clSetKernelArg(eltwise_kernel_, 8, sizeof(cl_mem), (void*)&cl_d_fmtd16_));
+    cl_ok(clSetKernelArg(eltwise_kernel_, 9, sizeof(cl_mem), (void*)&cl_d_fmtd16_size_));
+    cl_ok(clSetKernelArg(eltwise_kernel_, 10, sizeof(cl_int), (void*)&fmtd_size_per_ch_));
+    cl_ok(clSetKernelArg(eltwise_kernel_, 11, sizeof(cl_mem), (void*)&cl_d_emulator_trace_));
 
 #endif
     exec_err_ =
@@ -405,7 +520,8 @@ int OclPimExecutor::execute_eltwise(PimOpType eltop, PimBo* output, PimBo* opera
 
 #ifdef EMULATOR
     emulator_trace_gen(block_size, OP_ELT_ADD);
-    pim_emulator_->execute_elt_op(output, operand0, operand1, h_fmtd32_, (int)h_fmtd32_size_[0], g_pim_base_addr[0]);
+    ret = pim_emulator_->execute_elt_op(output, operand0, operand1, h_fmtd32_, (int)h_fmtd32_size_[0],
+                                        g_pim_base_addr[0]);
 #endif
     DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
     return ret;
@@ -420,6 +536,68 @@ int OclPimExecutor::execute_mul(PimBo* output, PimBo* operand0, PimBo* operand1,
     return execute_eltwise(OP_ELT_MUL, output, operand0, operand1, stream, block);
 }
 
+int OclPimExecutor::execute_eltwise_scalar(PimOpType eltop, PimBo* output, uint16_t scalar, PimBo* operand,
+                                           void* stream, bool block)
+{
+    DLOG(INFO) << "[START] " << __FUNCTION__ << " called";
+    int ret = 0;
+
+    const size_t block_size = 64;
+    const size_t local_work_size = 32;
+    const size_t global_work_size = block_size * local_work_size;
+    int output_size = output->size;
+    int align_size = (131072 << 1);
+    int num_tile = (output_size + align_size - 1) / align_size;
+
+    uint8_t* crf_bin = get_crf_bin(eltop, output->size);
+    int crf_size = pim_crf_generator_->get_crf_size(eltop, output->size);
+    PimOpStmtArgs stmt_args = pim_crf_generator_->get_stmt_args(eltop);
+
+    uint8_t srf_binary[32];
+    ret = pim_crf_generator_->preprocess_srf_scalar(eltop, scalar, srf_binary);
+    if (ret != 0) return ret;
+    pim_manager_->copy_memory((void*)d_srf_bin_buffer_, (void*)srf_binary, sizeof(srf_binary), HOST_TO_DEVICE);
+
+    cl_ok(clSetKernelArg(elt_scalar_kernel_, 0, sizeof(cl_mem),
+                         (void*)&(((manager::OclBufferObj*)operand->data)->dev_addr)));
+    cl_ok(clSetKernelArg(elt_scalar_kernel_, 1, sizeof(cl_mem),
+                         (void*)&(((manager::OclBufferObj*)output->data)->dev_addr)));
+    cl_ok(clSetKernelArg(elt_scalar_kernel_, 2, sizeof(cl_mem), (void*)&base_address_));
+    cl_ok(clSetKernelArg(elt_scalar_kernel_, 3, sizeof(cl_int), (void*)&num_tile));
+    cl_ok(clSetKernelArg(elt_scalar_kernel_, 4, sizeof(cl_mem), (void*)&crf_bin));
+    cl_ok(clSetKernelArg(elt_scalar_kernel_, 5, sizeof(cl_int), (void*)&crf_size));
+    cl_ok(clSetKernelArg(elt_scalar_kernel_, 6, sizeof(cl_mem), (void*)&d_srf_bin_buffer_));
+    cl_ok(clSetKernelArg(elt_scalar_kernel_, 7, sizeof(PimOpStmtArgs), (void*)&stmt_args));
+
+#ifdef EMULATOR
+    cl_ok(clSetKernelArg(elt_scalar_kernel_, 8, sizeof(cl_mem), (void*)&cl_d_fmtd16_));
+    cl_ok(clSetKernelArg(elt_scalar_kernel_, 9, sizeof(cl_mem), (void*)&cl_d_fmtd16_size_));
+    cl_ok(clSetKernelArg(elt_scalar_kernel_, 10, sizeof(cl_int), (void*)&fmtd_size_per_ch_));
+    cl_ok(clSetKernelArg(elt_scalar_kernel_, 11, sizeof(cl_mem), (void*)&cl_d_emulator_trace_));
+#endif
+    exec_err_ =
+        clEnqueueNDRangeKernel(queue, elt_scalar_kernel_, 1, NULL, &global_work_size, &local_work_size, 0, NULL, NULL);
+    cl_ok(exec_err_);
+    clFinish(queue);
+
+#ifdef EMULATOR
+    emulator_trace_gen(block_size, eltop);
+    ret = pim_emulator_->execute_elt_scalar_op(output, operand, h_fmtd32_, (int)h_fmtd32_size_[0], g_pim_base_addr[0]);
+#endif
+    DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
+    return ret;
+}
+
+int OclPimExecutor::execute_add_scalar(PimBo* output, uint16_t scalar, PimBo* operand, void* stream, bool block)
+{
+    return execute_eltwise_scalar(OP_ELT_ADD_SCALAR, output, scalar, operand, stream, block);
+}
+
+int OclPimExecutor::execute_mul_scalar(PimBo* output, uint16_t scalar, PimBo* operand, void* stream, bool block)
+{
+    return execute_eltwise_scalar(OP_ELT_MUL_SCALAR, output, scalar, operand, stream, block);
+}
+
 int OclPimExecutor::execute_relu(PimBo* output, PimBo* pim_data, void* stream, bool block)
 {
     const size_t block_size = pbi_->num_pim_chan;
@@ -428,7 +606,8 @@ int OclPimExecutor::execute_relu(PimBo* output, PimBo* pim_data, void* stream, b
     int align_size = (131072 << 1);
     int aligned_outsize = ((output->size + align_size - 1) / align_size);
     uint8_t* crf_bin = get_crf_bin(OP_RELU, output->size);
-    int crf_size = CRF_BIN_SIZE;
+    int crf_size = pim_crf_generator_->get_crf_size(OP_RELU, output->size);
+    PimOpStmtArgs stmt_args = pim_crf_generator_->get_stmt_args(OP_RELU);
 
     exec_err_ =
         clSetKernelArg(relu_kernel_, 0, sizeof(cl_mem), (void*)&(((manager::OclBufferObj*)pim_data->data)->dev_addr));
@@ -450,17 +629,20 @@ int OclPimExecutor::execute_relu(PimBo* output, PimBo* pim_data, void* stream, b
     exec_err_ = clSetKernelArg(relu_kernel_, 5, sizeof(cl_int), (void*)&crf_size);
     cl_ok(exec_err_);
 
+    exec_err_ = clSetKernelArg(relu_kernel_, 6, sizeof(PimOpStmtArgs), (void*)&stmt_args);
+    cl_ok(exec_err_);
+
 #ifdef EMULATOR
-    exec_err_ = clSetKernelArg(relu_kernel_, 6, sizeof(cl_mem), (void*)&cl_d_fmtd16_);
+    exec_err_ = clSetKernelArg(relu_kernel_, 7, sizeof(cl_mem), (void*)&cl_d_fmtd16_);
     cl_ok(exec_err_);
 
-    exec_err_ = clSetKernelArg(relu_kernel_, 7, sizeof(cl_mem), (void*)&cl_d_fmtd16_size_);
+    exec_err_ = clSetKernelArg(relu_kernel_, 8, sizeof(cl_mem), (void*)&cl_d_fmtd16_size_);
     cl_ok(exec_err_);
 
-    exec_err_ = clSetKernelArg(relu_kernel_, 8, sizeof(cl_int), (void*)&fmtd_size_per_ch_);
+    exec_err_ = clSetKernelArg(relu_kernel_, 9, sizeof(cl_int), (void*)&fmtd_size_per_ch_);
     cl_ok(exec_err_);
 
-    exec_err_ = clSetKernelArg(relu_kernel_, 9, sizeof(cl_mem), (void*)&cl_d_emulator_trace_);
+    exec_err_ = clSetKernelArg(relu_kernel_, 10, sizeof(cl_mem), (void*)&cl_d_emulator_trace_);
     cl_ok(exec_err_);
 #endif
     exec_err_ =
@@ -470,11 +652,18 @@ int OclPimExecutor::execute_relu(PimBo* output, PimBo* pim_data, void* stream, b
 
 #ifdef EMULATOR
     emulator_trace_gen(block_size, OP_RELU);
-    pim_emulator_->execute_relu(output, pim_data, h_fmtd32_, h_fmtd32_size_[0], g_pim_base_addr[0]);
+    if (pim_emulator_->execute_relu(output, pim_data, h_fmtd32_, h_fmtd32_size_[0], g_pim_base_addr[0]) != 0) return -1;
 #endif
     return exec_err_;
 }
 
+int OclPimExecutor::execute_elt_chain(PimBo* output, PimBo* input, const PimEltChainStep* steps, int num_steps,
+                                      void* stream, bool block)
+{
+    /* OpenCL kernels have no fused program yet, so the steps run one by one in place on output */
+    return execute_elt_chain_steps(this, output, input, steps, num_steps, stream, block);
+}
+
 int OclPimExecutor::execute_copy(PimBo* output, PimBo* pim_data, void* stream, bool block)
 {
     DLOG(INFO) << "called";
@@ -484,7 +673,8 @@ int OclPimExecutor::execute_copy(PimBo* output, PimBo* pim_data, void* stream, b
     const size_t global_work_size = block_size * local_work_size;
     size_t output_size = output->size;
     uint8_t* crf_bin = get_crf_bin(OP_COPY, output_size);
-    int crf_size = CRF_BIN_SIZE;
+    int crf_size = pim_crf_generator_->get_crf_size(OP_COPY, output_size);
+    PimOpStmtArgs stmt_args = pim_crf_generator_->get_stmt_args(OP_COPY);
 
     PIM_PROFILE_TICK(RunCopyKernel);
     cl_ok(
@@ -494,12 +684,13 @@ int OclPimExecutor::execute_copy(PimBo* output, PimBo* pim_data, void* stream, b
     cl_ok(clSetKernelArg(copy_kernel_, 3, sizeof(cl_int), (void*)&output_size));
     cl_ok(clSetKernelArg(copy_kernel_, 4, sizeof(cl_mem), (void*)&crf_bin));
     cl_ok(clSetKernelArg(copy_kernel_, 5, sizeof(cl_int), (void*)&crf_size));
+    cl_ok(clSetKernelArg(copy_kernel_, 6, sizeof(PimOpStmtArgs), (void*)&stmt_args));
 
 #ifdef EMULATOR
-    cl_ok(clSetKernelArg(copy_kernel_, 6, sizeof(cl_mem), (void*)&cl_d_fmtd16_));
-    cl_ok(clSetKernelArg(copy_kernel_, 7, sizeof(cl_mem), (void*)&cl_d_fmtd16_size_));
-    cl_ok(clSetKernelArg(copy_kernel_, 8, sizeof(cl_int), (void*)&fmtd_size_per_ch_));
-    cl_ok(clSetKernelArg(copy_kernel_, 9, sizeof(cl_mem), (void*)&cl_d_emulator_trace_));
+    cl_ok(clSetKernelArg(copy_kernel_, 7, sizeof(cl_mem), (void*)&cl_d_fmtd16_));
+    cl_ok(clSetKernelArg(copy_kernel_, 8, sizeof(cl_mem), (void*)&cl_d_fmtd16_size_));
+    cl_ok(clSetKernelArg(copy_kernel_, 9, sizeof(cl_int), (void*)&fmtd_size_per_ch_));
+    cl_ok(clSetKernelArg(copy_kernel_, 10, sizeof(cl_mem), (void*)&cl_d_emulator_trace_));
 #endif
     cl_ok(clEnqueueNDRangeKernel(queue, copy_kernel_, 1, NULL, &global_work_size, &local_work_size, 0, NULL, NULL));
     clFinish(queue);
@@ -507,7 +698,7 @@ int OclPimExecutor::execute_copy(PimBo* output, PimBo* pim_data, void* stream, b
 
 #ifdef EMULATOR
     emulator_trace_gen(block_size, OP_COPY);
-    pim_emulator_->execute_copy(output, pim_data, h_fmtd32_, h_fmtd32_size_[0], g_pim_base_addr[0]);
+    ret = pim_emulator_->execute_copy(output, pim_data, h_fmtd32_, h_fmtd32_size_[0], g_pim_base_addr[0]);
 #endif
     return ret;
 }
@@ -522,7 +713,8 @@ int OclPimExecutor::execute_bn(PimBo* output, PimBo* pim_data, PimBo* beta, PimB
     const size_t global_work_size = block_size * local_work_size;
     size_t output_size = output->size;
     uint8_t* crf_bin = get_crf_bin(OP_BN, output_size);
-    int crf_size = 2 * CRF_BIN_SIZE;
+    int crf_size = pim_crf_generator_->get_crf_size(OP_BN, output_size);
+    PimOpStmtArgs stmt_args = pim_crf_generator_->get_stmt_args(OP_BN);
     int align_size = (131072 << 1);
     int num_tile = ((output->size + align_size - 1) / align_size);
 
@@ -541,12 +733,13 @@ int OclPimExecutor::execute_bn(PimBo* output, PimBo* pim_data, PimBo* beta, PimB
     cl_ok(clSetKernelArg(bn_kernel_, 5, sizeof(cl_int), (void*)&crf_size));
     cl_ok(clSetKernelArg(bn_kernel_, 6, sizeof(cl_mem), (void*)&d_srf_bin_buffer_));
     cl_ok(clSetKernelArg(bn_kernel_, 7, sizeof(cl_int), (void*)&srf_size));
+    cl_ok(clSetKernelArg(bn_kernel_, 8, sizeof(PimOpStmtArgs), (void*)&stmt_args));
 
 #ifdef EMULATOR
-    cl_ok(clSetKernelArg(bn_kernel_, 8, sizeof(cl_mem), (void*)&cl_d_fmtd16_));
-    cl_ok(clSetKernelArg(bn_kernel_, 9, sizeof(cl_mem), (void*)&cl_d_fmtd16_size_));
-    cl_ok(clSetKernelArg(bn_kernel_, 10, sizeof(cl_int), (void*)&fmtd_size_per_ch_));
-    cl_ok(clSetKernelArg(bn_kernel_, 11, sizeof(cl_mem), (void*)&cl_d_emulator_trace_));
+    cl_ok(clSetKernelArg(bn_kernel_, 9, sizeof(cl_mem), (void*)&cl_d_fmtd16_));
+    cl_ok(clSetKernelArg(bn_kernel_, 10, sizeof(cl_mem), (void*)&cl_d_fmtd16_size_));
+    cl_ok(clSetKernelArg(bn_kernel_, 11, sizeof(cl_int), (void*)&fmtd_size_per_ch_));
+    cl_ok(clSetKernelArg(bn_kernel_, 12, sizeof(cl_mem), (void*)&cl_d_emulator_trace_));
 #endif
     cl_ok(clEnqueueNDRangeKernel(queue, bn_kernel_, 1, NULL, &global_work_size, &local_work_size, 0, NULL, NULL));
     clFinish(queue);
@@ -554,7 +747,7 @@ int OclPimExecutor::execute_bn(PimBo* output, PimBo* pim_data, PimBo* beta, PimB
 
 #ifdef EMULATOR
     emulator_trace_gen(block_size, OP_BN);
-    pim_emulator_->execute_bn(output, pim_data, h_fmtd32_, h_fmtd32_size_[0], g_pim_base_addr[0], nullptr);
+    ret = pim_emulator_->execute_bn(output, pim_data, h_fmtd32_, h_fmtd32_size_[0], g_pim_base_addr[0], nullptr);
 #endif
     delete[] srf_binary;
 
@@ -624,8 +817,8 @@ int OclPimExecutor::execute_aligned_gemm_tile_accum(PimBo* output, PimBo* input,
 #ifdef EMULATOR
     PIM_PROFILE_TICK(RunGemmEmulation);
     emulator_trace_gen(block_size, OP_GEMV);
-    pim_emulator_->execute_gemm_bias_act(output, weight, h_fmtd32_, h_fmtd32_size_[0], OP_GEMV, g_pim_base_addr[0],
-                                         (uint8_t*)pim_gemv_tmp_buffer_, bias, act_func);
+    ret = pim_emulator_->execute_gemm_bias_act(output, weight, h_fmtd32_, h_fmtd32_size_[0], OP_GEMV,
+                                               g_pim_base_addr[0], (uint8_t*)pim_gemv_tmp_buffer_, bias, act_func);
 
     PIM_PROFILE_TOCK(RunGemmEmulation);
 #endif
@@ -697,8 +890,8 @@ int OclPimExecutor::execute_chwise_gemm_tile_accum(PimBo* output, PimBo* input,
 #ifdef EMULATOR
     PIM_PROFILE_TICK(RunGemmEmulation);
     emulator_trace_gen(block_size, OP_GEMV);
-    pim_emulator_->execute_gemm_bias_act(output, weight, h_fmtd32_, h_fmtd32_size_[0], OP_GEMV, g_pim_base_addr[0],
-                                         (uint8_t*)pim_gemv_tmp_buffer_, bias, act_func);
+    ret = pim_emulator_->execute_gemm_bias_act(output, weight, h_fmtd32_, h_fmtd32_size_[0], OP_GEMV,
+                                               g_pim_base_addr[0], (uint8_t*)pim_gemv_tmp_buffer_, bias, act_func);
 
     PIM_PROFILE_TOCK(RunGemmEmulation);
 #endif
@@ -746,29 +939,22 @@ int OclPimExecutor::execute_gemm(PimBo* output, PimBo* input, PimBo* weight, Pim
     if (kernel_type_ == CUSTOM_GPU) {
         // ret = this->execute_gemv(output, input, weight, bias, act_func, stream, block);
         DLOG(ERROR) << "OCL Custom GPU UnImplemented ";
-    } else if (kernel_type_ == PIM) {
+    } else if (kernel_type_ == PIM || is_pim_applicable(weight, gemm_order_)) {
         PimBo* pim_wei;
-        if (weight->data_layout_type == PimDataLayoutType::RAW) {
-            pim_wei = pim_runtime_->get_preloaded_pim_gemm_weight(weight, gemm_order_);
+        bool cached = weight->data_layout_type == PimDataLayoutType::RAW;
+        if (cached) {
+            /* pinned so that an insert on another thread can not free it under this gemm */
+            pim_wei = pim_runtime_->get_preloaded_pim_gemm_weight(weight, gemm_order_, false, stream, true, true);
+            if (pim_wei == nullptr) return -1;
         } else {
             // Assume that user has provided correct layout
             pim_wei = weight;
         }
         ret = this->execute_ocl_gemm(output, input, pim_wei, bias, act_func, stream, block);
+        if (cached) pim_runtime_->unpin_preloaded_pim_weight(pim_wei, stream);
     } else {
-        if (is_pim_applicable(weight, gemm_order_)) {
-            PimBo* pim_wei;
-            if (weight->data_layout_type == PimDataLayoutType::RAW) {
-                pim_wei = pim_runtime_->get_preloaded_pim_gemm_weight(weight, gemm_order_);
-            } else {
-                // Assume that user has provided correct layout
-                pim_wei = weight;
-            }
-            ret = this->execute_ocl_gemm(output, input, pim_wei, bias, act_func, stream, block);
-        } else {
-            std::cout << "Pim Not Applicable" << std::endl;
-            ret = this->execute_gemv(output, input, weight, bias, act_func, stream, block);
-        }
+        std::cout << "Pim Not Applicable" << std::endl;
+        ret = this->execute_gemv(output, input, weight, bias, act_func, stream, block);
     }
 
     return ret;
@@ -779,6 +965,20 @@ int OclPimExecutor::execute_sync(void* stream)
     cl_ok(clFinish(queue));
     return 0;
 }
+
+int OclPimExecutor::load_crf_program(PimOpType op_type, const PimCrfProgram& program)
+{
+    /* kernels in flight may still read the binaries which are freed or rewritten */
+    cl_ok(clFinish(queue));
+    return pim_crf_generator_->set_crf_program(op_type, program);
+}
+
+/* kernels of the graph are enqueued in order on the in-order queue, so a replay waits only once */
+int OclPimExecutor::instantiate_graph(PimGraph* graph) { return 0; }
+int OclPimExecutor::execute_graph(PimGraph* graph, void* stream, bool block)
+{
+    return execute_graph_nodes(this, graph, stream, block);
+}
 }  // namespace executor
 }  // namespace runtime
 }  // namespace pim
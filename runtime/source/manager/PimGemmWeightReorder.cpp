@@ -0,0 +1,685 @@
+/*
+ * Copyright (C) 2022 Samsung Electronics Co. LTD
+ *
+ * This software is a property of Samsung Electronics.
+ * No part of this software, either material or conceptual may be copied or distributed, transmitted,
+ * transcribed, stored in a retrieval system or translated into any human or computer language in any form by any means,
+ * electronic, mechanical, manual or otherwise, or disclosed
+ * to third parties without the express written permission of Samsung Electronics.
+ * (Use of the Software is restricted to non-commercial, personal or academic, research purpose only)
+ */
+
+#include "manager/PimGemmWeightReorder.h"
+#include <string.h>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include "utility/pim_log.h"
+#include "utility/pim_util.h"
+#if defined(__AVX__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+/* minimum number of GRF blocks (2KB each on vega20) handed to one thread */
+#define MIN_BLOCKS_PER_THREAD 256
+
+namespace pim
+{
+namespace runtime
+{
+namespace manager
+{
+static inline void copy_trans(char* dst, const char* src, int trans_size)
+{
+#if defined(__AVX__)
+    if (trans_size == 32) {
+        _mm256_storeu_si256((__m256i*)dst, _mm256_loadu_si256((const __m256i*)src));
+        return;
+    }
+#elif defined(__SSE2__)
+    if (trans_size == 32) {
+        __m128i lo = _mm_loadu_si128((const __m128i*)src);
+        __m128i hi = _mm_loadu_si128((const __m128i*)(src + 16));
+        _mm_storeu_si128((__m128i*)dst, lo);
+        _mm_storeu_si128((__m128i*)(dst + 16), hi);
+        return;
+    }
+#endif
+    memcpy(dst, src, trans_size);
+}
+
+static inline void join_range(uint64_t* offset, uint64_t* size, bool empty, uint64_t begin, uint64_t end)
+{
+    if (!empty) {
+        end = std::max(end, *offset + *size);
+        begin = std::min(begin, *offset);
+    }
+    *offset = begin;
+    *size = end - begin;
+}
+
+PimGemmWeightReorder::PimGemmWeightReorder(PimBlockInfo* pbi, int num_threads) : pbi_(pbi), num_threads_(num_threads)
+{
+    if (num_threads_ <= 0) {
+        num_threads_ = std::max(1u, std::thread::hardware_concurrency());
+    }
+}
+
+void PimGemmWeightReorder::pad_aligned_source(void* dst, const void* src, const PimBo* src_bo)
+{
+    /* rows of bshape_r.h elements are spread to a pitch of bshape.h, the rest stays zero */
+    size_t type_size = (src_bo->precision == PIM_FP16) ? 2 : 1;
+    size_t pitch = src_bo->bshape.h * type_size;
+    size_t row_size = src_bo->bshape_r.h * type_size;
+    size_t batch = src_bo->bshape.n * src_bo->bshape.c;
+    size_t batch_size = pitch * src_bo->bshape.w;
+    size_t batch_size_r = row_size * src_bo->bshape_r.w;
+
+    memset(dst, 0, src_bo->size);
+    for (size_t b = 0; b < batch; b++) {
+        char* dst_batch = (char*)dst + b * batch_size;
+        const char* src_batch = (const char*)src + b * batch_size_r;
+        for (size_t i = 0; i < src_bo->bshape_r.w; i++) {
+            memcpy(dst_batch + i * pitch, src_batch + i * row_size, row_size);
+        }
+    }
+}
+
+void PimGemmWeightReorder::unpad_aligned_source(void* dst, const void* src, const PimBo* dst_bo)
+{
+    /* inverse of pad_aligned_source; rows only move down, so dst may be src */
+    size_t type_size = (dst_bo->precision == PIM_FP16) ? 2 : 1;
+    size_t pitch = dst_bo->bshape.h * type_size;
+    size_t row_size = dst_bo->bshape_r.h * type_size;
+    size_t batch = dst_bo->bshape.n * dst_bo->bshape.c;
+    size_t batch_size = pitch * dst_bo->bshape.w;
+    size_t batch_size_r = row_size * dst_bo->bshape_r.w;
+
+    for (size_t b = 0; b < batch; b++) {
+        char* dst_batch = (char*)dst + b * batch_size_r;
+        const char* src_batch = (const char*)src + b * batch_size;
+        for (size_t i = 0; i < dst_bo->bshape_r.w; i++) {
+            memmove(dst_batch + i * row_size, src_batch + i * pitch, row_size);
+        }
+    }
+}
+
+void PimGemmWeightReorder::plan_batch(uint64_t data_offset, int out_cnt, int in_cnt, std::vector<GrfBlock>* blocks)
+{
+    /* same walk as the original per-transfer loops, recorded once per GRF block */
+    int num_grf_A = pbi_->num_grf;
+    int num_grf_B = pbi_->num_grf;
+    int num_pim_blocks = pbi_->num_pim_blocks;
+    int num_pim_chan = pbi_->num_pim_chan;
+    int num_pim_rank = pbi_->num_pim_rank;
+    int num_banks = pbi_->num_banks;
+    int num_bank_groups = pbi_->num_bank_groups;
+    uint32_t num_col_per_row = pbi_->num_col / pbi_->bl;
+
+    int in_tile_size = num_grf_A;
+    int out_tile_size = num_grf_B * num_pim_blocks * num_pim_chan * num_pim_rank;
+
+    uint32_t cidx = 0;
+    uint32_t rank = 0;
+    uint32_t bg = 0;
+    uint32_t bank = 0;
+    uint32_t s_row[2] = {0, 0}; /* starting row of even/odd banks */
+    uint32_t s_col[2] = {0, 0}; /* starting col of even/odd banks */
+
+    for (int y = 0; y < out_cnt; y += out_tile_size) {
+        for (int x = 0; x < in_cnt; x += in_tile_size) {
+            int odd = (x / in_tile_size) % 2;
+            for (int tiled_y = 0; tiled_y < out_tile_size; tiled_y += num_grf_B) {
+                uint32_t row = s_row[odd];
+                uint32_t col = s_col[odd];
+
+                blocks->push_back({data_offset, (uint32_t)(y + tiled_y), (uint32_t)x, cidx, rank, bg, bank + odd, row,
+                                   col});
+                for (int i = 0; i < num_grf_A * num_grf_B; i++) {
+                    while (col >= num_col_per_row) {
+                        row++;
+                        col -= num_col_per_row;
+                    }
+                    col++;
+                }
+
+                bank += (num_banks / num_pim_blocks);
+
+                if (bank >= (num_banks / num_bank_groups)) {
+                    bg++;
+                    bank = 0;
+                }
+
+                if (bg >= num_bank_groups) {
+                    bg = 0;
+                    rank++;
+                }
+
+                if (rank >= num_pim_rank) {
+                    rank = 0;
+                    cidx++;
+                }
+
+                if (cidx >= num_pim_chan) {
+                    cidx = 0;
+                    s_row[odd] = row;
+                    s_col[odd] = col;
+                }
+            }
+        }
+    }
+}
+
+void PimGemmWeightReorder::transpose_block(const Window& raw, const GrfBlock& blk, int in_cnt, const PimBShape* t_shape,
+                                           uint16_t* tile, int tile_in, bool to_raw)
+{
+    /* the [out][in] rows of a block are runs of the transpose of the stored [h][w] matrices of their batch */
+    uint64_t h = t_shape->h;
+    uint64_t w = t_shape->w;
+    uint64_t row_len = (uint64_t)in_cnt * pbi_->trans_size / sizeof(uint16_t);
+    uint64_t in_elem = (uint64_t)blk.in_idx * pbi_->trans_size / sizeof(uint16_t);
+    uint64_t first = (blk.data_offset + (blk.out_idx * row_len + in_elem) * sizeof(uint16_t) - raw.offset) /
+                     sizeof(uint16_t);
+    int num_rows = pbi_->num_grf;
+
+    if (row_len == h) {
+        /* every row is one column of a stored matrix, neighbouring columns are transposed together */
+        for (int o = 0; o < num_rows;) {
+            uint64_t row = first / h + o;
+            uint64_t c = row % w;
+            int cnt = (int)std::min((uint64_t)(num_rows - o), w - c);
+            uint16_t* src = (uint16_t*)raw.data + ((row / w) * h + in_elem) * w + c;
+            if (to_raw) {
+                transpose_fp16_tile(src, w, tile + o * tile_in, tile_in, cnt, tile_in);
+            } else {
+                transpose_fp16_tile(tile + o * tile_in, tile_in, src, w, tile_in, cnt);
+            }
+            o += cnt;
+        }
+        return;
+    }
+
+    /* a W_X_I row runs along w, so its part of a column of the stored matrix is gathered up to the column end */
+    for (int o = 0; o < num_rows; o++) {
+        uint64_t pos = first + o * row_len;
+        for (int i = 0; i < tile_in;) {
+            uint64_t col = (pos + i) / h;
+            uint64_t r = (pos + i) % h;
+            int cnt = (int)std::min((uint64_t)(tile_in - i), h - r);
+            uint16_t* src = (uint16_t*)raw.data + ((col / w) * h + r) * w + col % w;
+            if (to_raw) {
+                transpose_fp16_tile(src, w, tile + o * tile_in + i, cnt, 1, cnt);
+            } else {
+                transpose_fp16_tile(tile + o * tile_in + i, 1, src, w, cnt, 1);
+            }
+            i += cnt;
+        }
+    }
+}
+
+int PimGemmWeightReorder::copy_block_range(const Window& pim, const Window& raw, int in_cnt, const GrfBlock* blocks,
+                                           size_t num_blocks, bool to_raw, const PimBShape* t_shape)
+{
+    int num_grf_A = pbi_->num_grf;
+    int num_grf_B = pbi_->num_grf;
+    int trans_size = pbi_->trans_size;
+    uint32_t num_col_per_row = pbi_->num_col / pbi_->bl;
+
+    /* a GRF block of a transposed source, num_grf_B rows of num_grf_A transfers in [out][in] order */
+    int tile_in = num_grf_A * trans_size / sizeof(uint16_t);
+    std::vector<uint16_t> tile(t_shape != nullptr ? num_grf_B * tile_in : 0);
+
+    /* address fields are disjoint bits, so the column part is looked up and or-ed to the row part */
+    std::vector<uint64_t> col_addr(num_col_per_row);
+    for (uint32_t col = 0; col < num_col_per_row; col++) {
+        col_addr[col] = addr_gen(0, 0, 0, 0, 0, col);
+    }
+
+    for (size_t b = 0; b < num_blocks; b++) {
+        const GrfBlock& blk = blocks[b];
+        uint32_t row = blk.row;
+        uint32_t col = blk.col;
+        uint64_t first_idx = (uint64_t)blk.out_idx * in_cnt + blk.in_idx;
+        uint64_t last_idx = (uint64_t)(blk.out_idx + num_grf_B - 1) * in_cnt + blk.in_idx + num_grf_A - 1;
+
+        if (blk.data_offset + first_idx * trans_size < raw.offset ||
+            blk.data_offset + (last_idx + 1) * trans_size > raw.offset + raw.size) {
+            return -1;
+        }
+        /* the batch may start before the window, only the offsets of the rows are inside it */
+        uint64_t raw_base = blk.data_offset - raw.offset;
+        if (t_shape != nullptr && !to_raw) transpose_block(raw, blk, in_cnt, t_shape, tile.data(), tile_in, false);
+
+        while (col >= num_col_per_row) {
+            row++;
+            col -= num_col_per_row;
+        }
+        uint64_t row_addr = addr_gen(blk.chan, blk.rank, blk.bg, blk.bank, row, 0);
+
+        for (int grfb_idx = 0; grfb_idx < num_grf_B; grfb_idx++) {
+            for (int grfa_idx = 0; grfa_idx < num_grf_A; grfa_idx++) {
+                if (col >= num_col_per_row) {
+                    row++;
+                    col = 0;
+                    row_addr = addr_gen(blk.chan, blk.rank, blk.bg, blk.bank, row, 0);
+                }
+                uint64_t pos = blk.data_offset + (row_addr | col_addr[col]);
+#ifdef EMULATOR
+                int out_l = grfa_idx;
+                int in_l = grfb_idx;
+#else
+                int out_l = grfb_idx;
+                int in_l = grfa_idx;
+#endif
+                char* data =
+                    raw.data + (raw_base + ((uint64_t)(blk.out_idx + out_l) * in_cnt + blk.in_idx + in_l) * trans_size);
+                if (t_shape != nullptr) data = (char*)tile.data() + (out_l * num_grf_A + in_l) * trans_size;
+                if (pos < pim.offset || pos + trans_size > pim.offset + pim.size) return -1;
+                if (to_raw) {
+                    copy_trans(data, pim.data + (pos - pim.offset), trans_size);
+                } else {
+                    copy_trans(pim.data + (pos - pim.offset), data, trans_size);
+                }
+                col++;
+            }
+        }
+        if (t_shape != nullptr && to_raw) transpose_block(raw, blk, in_cnt, t_shape, tile.data(), tile_in, true);
+    }
+    return 0;
+}
+
+int PimGemmWeightReorder::copy_blocks(const Window& pim, const Window& raw, int in_cnt, const GrfBlock* blocks,
+                                      size_t num_blocks, bool to_raw, const PimBShape* t_shape)
+{
+    size_t num_threads = std::min((size_t)num_threads_, num_blocks / MIN_BLOCKS_PER_THREAD);
+
+    if (num_threads <= 1) {
+        return copy_block_range(pim, raw, in_cnt, blocks, num_blocks, to_raw, t_shape);
+    }
+
+    /* GRF blocks never overlap in either layout, so contiguous ranges are copied independently */
+    std::atomic<int> ret(0);
+    std::vector<std::thread> workers;
+    size_t per_thread = (num_blocks + num_threads - 1) / num_threads;
+    for (size_t t = 0; t < num_threads; t++) {
+        size_t begin = t * per_thread;
+        size_t end = std::min(num_blocks, begin + per_thread);
+        if (begin >= end) break;
+        workers.emplace_back([&, begin, end]() {
+            if (copy_block_range(pim, raw, in_cnt, blocks + begin, end - begin, to_raw, t_shape) != 0) {
+                ret = -1;
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    return ret;
+}
+
+void PimGemmWeightReorder::plan_chwise(const PimBo* raw_bo, PimGemmOrder gemm_order, std::vector<GrfBlock>* blocks,
+                                       int* in_cnt)
+{
+    int type_size = (raw_bo->precision == PIM_FP16) ? 2 : 1;
+    int trans_size = pbi_->trans_size;
+    int out_tile_size = pbi_->num_grf * pbi_->num_pim_blocks * pbi_->num_pim_chan * pbi_->num_pim_rank;
+    int iter_cnt = 0;
+
+    if (gemm_order == I_X_W) {
+        iter_cnt = raw_bo->bshape.n * raw_bo->bshape.c * raw_bo->bshape.w / PIM_GEMV_OUT_ALIGN;
+        *in_cnt = raw_bo->bshape.h * type_size / trans_size;
+    } else {
+        iter_cnt = raw_bo->bshape.n * raw_bo->bshape.c * raw_bo->bshape.h / PIM_GEMV_OUT_ALIGN;
+        *in_cnt = raw_bo->bshape.w * type_size / trans_size;
+    }
+
+    uint64_t data_offset = 0;
+    for (int iter = 0; iter < iter_cnt; iter++) {
+        plan_batch(data_offset, out_tile_size, *in_cnt, blocks);
+        data_offset += ((uint64_t)raw_bo->bshape.h * PIM_GEMV_OUT_ALIGN * sizeof(half));
+    }
+}
+
+void PimGemmWeightReorder::plan_aligned(const PimBo* raw_bo, PimGemmOrder gemm_order, std::vector<GrfBlock>* blocks,
+                                        int* in_cnt)
+{
+    int type_size = (raw_bo->precision == PIM_FP16) ? 2 : 1;
+    int trans_size = pbi_->trans_size;
+    int iter_cnt = raw_bo->bshape.n * raw_bo->bshape.c;
+    int out_cnt = 0;
+
+    if (gemm_order == I_X_W) {
+        out_cnt = raw_bo->bshape.w;
+        *in_cnt = raw_bo->bshape.h * type_size / trans_size;
+    } else {
+        out_cnt = raw_bo->bshape.h;
+        *in_cnt = raw_bo->bshape.w * type_size / trans_size;
+    }
+
+    uint64_t data_offset = 0;
+    for (int iter = 0; iter < iter_cnt; iter++) {
+        plan_batch(data_offset, out_cnt, *in_cnt, blocks);
+        data_offset += ((uint64_t)raw_bo->bshape.h * raw_bo->bshape.w * sizeof(half));
+    }
+}
+
+bool PimGemmWeightReorder::check_transposable(const PimBo* raw_bo)
+{
+    /* the rows are read from the transpose of the stored FP16 matrices as transpose_pimbo would write it */
+    if (raw_bo->precision == PIM_FP16) return true;
+    DLOG(ERROR) << "gemm weight of " << raw_bo->bshape.h << "x" << raw_bo->bshape.w
+                << " can not be reordered from the transposed source";
+    return false;
+}
+
+int PimGemmWeightReorder::reorder_chwise(void* dst, size_t dst_size, const void* src, const PimBo* src_bo,
+                                         PimGemmOrder gemm_order, bool src_transposed)
+{
+    DLOG(INFO) << "[START] " << __FUNCTION__ << " called";
+    int in_cnt = 0;
+    std::vector<GrfBlock> blocks;
+
+    plan_chwise(src_bo, gemm_order, &blocks, &in_cnt);
+    if (src_transposed && !check_transposable(src_bo)) {
+        DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
+        return -1;
+    }
+    Window pim = {(char*)dst, 0, dst_size};
+    Window raw = {(char*)src, 0, src_bo->size};
+    int ret = copy_blocks(pim, raw, in_cnt, blocks.data(), blocks.size(), false,
+                          src_transposed ? &src_bo->bshape : nullptr);
+    if (ret != 0) {
+        DLOG(ERROR) << "chwise gemm weight layout exceeds buffer size";
+    }
+
+    DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
+    return ret;
+}
+
+int PimGemmWeightReorder::reorder_aligned(void* dst, size_t dst_size, const void* src, const PimBo* src_bo,
+                                          PimGemmOrder gemm_order, bool src_transposed)
+{
+    DLOG(INFO) << "[START] " << __FUNCTION__ << " called";
+    int in_cnt = 0;
+    std::vector<GrfBlock> blocks;
+
+    plan_aligned(src_bo, gemm_order, &blocks, &in_cnt);
+    if (src_transposed && !check_transposable(src_bo)) {
+        DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
+        return -1;
+    }
+    Window pim = {(char*)dst, 0, dst_size};
+    Window raw = {(char*)src, 0, src_bo->size};
+    int ret = copy_blocks(pim, raw, in_cnt, blocks.data(), blocks.size(), false,
+                          src_transposed ? &src_bo->bshape : nullptr);
+    if (ret != 0) {
+        DLOG(ERROR) << "aligned gemm weight layout exceeds buffer size";
+    }
+
+    DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
+    return ret;
+}
+
+int PimGemmWeightReorder::restore_chwise(void* dst, const PimBo* dst_bo, const void* src, size_t src_size,
+                                         PimGemmOrder gemm_order, bool dst_transposed)
+{
+    DLOG(INFO) << "[START] " << __FUNCTION__ << " called";
+    int in_cnt = 0;
+    std::vector<GrfBlock> blocks;
+
+    plan_chwise(dst_bo, gemm_order, &blocks, &in_cnt);
+    if (dst_transposed && !check_transposable(dst_bo)) {
+        DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
+        return -1;
+    }
+    Window pim = {(char*)src, 0, src_size};
+    Window raw = {(char*)dst, 0, dst_bo->size};
+    int ret = copy_blocks(pim, raw, in_cnt, blocks.data(), blocks.size(), true,
+                          dst_transposed ? &dst_bo->bshape : nullptr);
+    if (ret != 0) {
+        DLOG(ERROR) << "chwise gemm weight layout exceeds buffer size";
+    }
+
+    DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
+    return ret;
+}
+
+int PimGemmWeightReorder::restore_aligned(void* dst, const PimBo* dst_bo, const void* src, size_t src_size,
+                                          PimGemmOrder gemm_order, bool dst_transposed)
+{
+    DLOG(INFO) << "[START] " << __FUNCTION__ << " called";
+    int in_cnt = 0;
+    std::vector<GrfBlock> blocks;
+
+    plan_aligned(dst_bo, gemm_order, &blocks, &in_cnt);
+    if (dst_transposed && !check_transposable(dst_bo)) {
+        DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
+        return -1;
+    }
+    Window pim = {(char*)src, 0, src_size};
+    Window raw = {(char*)dst, 0, dst_bo->size};
+    int ret = copy_blocks(pim, raw, in_cnt, blocks.data(), blocks.size(), true,
+                          dst_transposed ? &dst_bo->bshape : nullptr);
+    if (ret != 0) {
+        DLOG(ERROR) << "aligned gemm weight layout exceeds buffer size";
+    }
+
+    DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
+    return ret;
+}
+void PimGemmWeightReorder::add_block_extent(const GrfBlock& blk, int in_cnt, ReorderTile* tile)
+{
+    int num_grf = pbi_->num_grf;
+    uint64_t row_size = (uint64_t)in_cnt * pbi_->trans_size;
+    uint32_t num_col_per_row = pbi_->num_col / pbi_->bl;
+    uint32_t row = blk.row + blk.col / num_col_per_row;
+    uint32_t last_row = row + (blk.col % num_col_per_row + num_grf * num_grf - 1) / num_col_per_row;
+    uint64_t raw_begin = blk.data_offset + blk.out_idx * row_size;
+    bool empty = tile->num_blocks == 0;
+
+    /* only the rank is above the row in an address, so the block lies in its rows of all channels and banks */
+    join_range(&tile->raw_offset, &tile->raw_size, empty, raw_begin, raw_begin + num_grf * row_size);
+    join_range(&tile->pim_offset, &tile->pim_size, empty, blk.data_offset + addr_gen(0, blk.rank, 0, 0, row, 0),
+               blk.data_offset + addr_gen(0, blk.rank, 0, 0, last_row + 1, 0));
+    tile->num_blocks++;
+}
+
+bool PimGemmWeightReorder::check_tile_source(const PimBo* raw_bo, bool src_transposed, const ReorderTile& tile)
+{
+    if (!src_transposed) return true;
+
+    /* a transposed source is staged as whole columns of one stored matrix or as whole matrices */
+    uint64_t w = raw_bo->bshape.w;
+    uint64_t row_size = raw_bo->bshape.h * sizeof(uint16_t);
+    if (tile.raw_offset % row_size != 0 || tile.raw_size % row_size != 0) return false;
+    uint64_t first = tile.raw_offset / row_size;
+    uint64_t end = (tile.raw_offset + tile.raw_size) / row_size;
+    return first / w == (end - 1) / w || (first % w == 0 && end % w == 0);
+}
+
+void PimGemmWeightReorder::finish_tile(const PimBo* raw_bo, size_t pim_size, bool src_transposed, ReorderTile* tile)
+{
+    uint64_t block_size = (uint64_t)pbi_->num_grf * pbi_->num_grf * pbi_->trans_size;
+
+    tile->raw_size = std::min(tile->raw_size, raw_bo->size - std::min((uint64_t)raw_bo->size, tile->raw_offset));
+    tile->pim_size = std::min(tile->pim_size, pim_size - std::min((uint64_t)pim_size, tile->pim_offset));
+    tile->covered = tile->num_blocks * block_size >= tile->pim_size;
+    tile->src_offset = tile->raw_offset;
+    tile->src_pitch = tile->raw_size;
+    tile->row_size = tile->raw_size;
+    tile->num_rows = 1;
+
+    if (src_transposed) {
+        uint64_t h = raw_bo->bshape.h;
+        uint64_t w = raw_bo->bshape.w;
+        uint64_t first = tile->raw_offset / (h * sizeof(uint16_t));
+        uint64_t cnt = tile->raw_size / (h * sizeof(uint16_t));
+        if (first % w != 0 || cnt % w != 0) {
+            tile->src_offset = ((first / w) * h * w + first % w) * sizeof(uint16_t);
+            tile->src_pitch = w * sizeof(uint16_t);
+            tile->row_size = cnt * sizeof(uint16_t);
+            tile->num_rows = h;
+        }
+    }
+}
+
+int PimGemmWeightReorder::plan_tiles(const PimBo* raw_bo, size_t pim_size, PimGemmOrder gemm_order, bool is_chwise,
+                                     bool src_transposed, size_t tile_size, ReorderPlan* plan)
+{
+    DLOG(INFO) << "[START] " << __FUNCTION__ << " called";
+    int out_tile_size = pbi_->num_grf * pbi_->num_pim_blocks * pbi_->num_pim_chan * pbi_->num_pim_rank;
+    std::vector<GrfBlock>& blocks = plan->blocks;
+    std::vector<ReorderTile>& tiles = plan->tiles;
+
+    blocks.clear();
+    tiles.clear();
+    if (is_chwise) {
+        plan_chwise(raw_bo, gemm_order, &blocks, &plan->in_cnt);
+    } else {
+        plan_aligned(raw_bo, gemm_order, &blocks, &plan->in_cnt);
+    }
+    if (src_transposed && !check_transposable(raw_bo)) {
+        DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
+        return -1;
+    }
+    plan->bshape = raw_bo->bshape;
+    plan->src_transposed = src_transposed;
+
+    /* tiles are made of whole sweeps, the blocks of out_tile_size output rows over all inputs */
+    uint64_t row_size = raw_bo->bshape.h * sizeof(uint16_t);
+    uint64_t w = raw_bo->bshape.w;
+    bool tileable = true;
+    size_t b = 0;
+    while (b < blocks.size()) {
+        ReorderTile tile = {};
+        tile.first_block = b;
+        while (true) {
+            do {
+                add_block_extent(blocks[b++], plan->in_cnt, &tile);
+            } while (b < blocks.size() && !(blocks[b].in_idx == 0 && blocks[b].out_idx % out_tile_size == 0));
+            if (b == blocks.size()) break;
+
+            /* a tile which starts inside a stored matrix can not grow past the end of it */
+            uint64_t end = (tile.raw_offset + tile.raw_size) / row_size;
+            bool matrix_end = src_transposed && (tile.raw_offset / row_size) % w != 0 && end % w == 0;
+            if (check_tile_source(raw_bo, src_transposed, tile) && (tile.raw_size >= tile_size || matrix_end)) break;
+        }
+
+        /* pim ranges of the even and odd banks advance differently, tiles which share bytes are merged */
+        while (!tiles.empty() && tile.pim_offset < tiles.back().pim_offset + tiles.back().pim_size) {
+            ReorderTile& prev = tiles.back();
+            join_range(&prev.raw_offset, &prev.raw_size, false, tile.raw_offset, tile.raw_offset + tile.raw_size);
+            join_range(&prev.pim_offset, &prev.pim_size, false, tile.pim_offset, tile.pim_offset + tile.pim_size);
+            prev.num_blocks += tile.num_blocks;
+            tile = prev;
+            tiles.pop_back();
+        }
+        tileable = tileable && check_tile_source(raw_bo, src_transposed, tile);
+        tiles.push_back(tile);
+    }
+
+    /* a source which can not be cut is staged as a whole */
+    if (!tileable) {
+        ReorderTile tile = tiles[0];
+        join_range(&tile.raw_offset, &tile.raw_size, false, 0, raw_bo->size);
+        for (size_t t = 1; t < tiles.size(); t++) {
+            join_range(&tile.raw_offset, &tile.raw_size, false, tiles[t].raw_offset,
+                       tiles[t].raw_offset + tiles[t].raw_size);
+            join_range(&tile.pim_offset, &tile.pim_size, false, tiles[t].pim_offset,
+                       tiles[t].pim_offset + tiles[t].pim_size);
+            tile.num_blocks += tiles[t].num_blocks;
+        }
+        tiles.assign(1, tile);
+    }
+
+    plan->max_raw_size = 0;
+    plan->max_pim_size = 0;
+    for (auto& tile : tiles) {
+        finish_tile(raw_bo, pim_size, src_transposed, &tile);
+        plan->max_raw_size = std::max(plan->max_raw_size, tile.raw_size);
+        plan->max_pim_size = std::max(plan->max_pim_size, tile.pim_size);
+    }
+
+    DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
+    return 0;
+}
+
+int PimGemmWeightReorder::reorder_tile(void* dst, const void* src, const ReorderPlan& plan, size_t tile_idx)
+{
+    const ReorderTile& tile = plan.tiles[tile_idx];
+    Window pim = {(char*)dst, tile.pim_offset, tile.pim_size};
+    Window raw = {(char*)src, tile.raw_offset, tile.raw_size};
+    PimBShape t_shape = plan.bshape;
+
+    /* the columns of one stored matrix are packed to their own width */
+    if (tile.num_rows > 1) t_shape.w = tile.row_size / sizeof(uint16_t);
+    int ret = copy_blocks(pim, raw, plan.in_cnt, plan.blocks.data() + tile.first_block, tile.num_blocks, false,
+                          plan.src_transposed ? &t_shape : nullptr);
+    if (ret != 0) {
+        DLOG(ERROR) << "gemm weight tile exceeds its staging buffers";
+    }
+    return ret;
+}
+
+int PimGemmWeightReorder::plan_block_bases(const PimBo* raw_bo, size_t pim_size, PimGemmOrder gemm_order,
+                                           bool is_chwise, std::vector<BlockBase>* bases, int* in_cnt)
+{
+    DLOG(INFO) << "[START] " << __FUNCTION__ << " called";
+    int num_grf = pbi_->num_grf;
+    uint64_t trans_size = pbi_->trans_size;
+    uint32_t num_col_per_row = pbi_->num_col / pbi_->bl;
+    uint64_t row_stride = addr_gen(0, 0, 0, 0, 1, 0);
+    std::vector<GrfBlock> blocks;
+
+    if (is_chwise) {
+        plan_chwise(raw_bo, gemm_order, &blocks, in_cnt);
+    } else {
+        plan_aligned(raw_bo, gemm_order, &blocks, in_cnt);
+    }
+
+    /*
+     * the blocks which differ only in their channel share the rest of their address, so they are put next to each
+     * other in channel order and the columns of all channels are written in the same pass
+     */
+    for (auto& blk : blocks) {
+        blk.row += blk.col / num_col_per_row;
+        blk.col %= num_col_per_row;
+    }
+    std::stable_sort(blocks.begin(), blocks.end(), [](const GrfBlock& a, const GrfBlock& b) {
+        if (a.data_offset != b.data_offset) return a.data_offset < b.data_offset;
+        if (a.row != b.row) return a.row < b.row;
+        if (a.col != b.col) return a.col < b.col;
+        if (a.rank != b.rank) return a.rank < b.rank;
+        if (a.bg != b.bg) return a.bg < b.bg;
+        if (a.bank != b.bank) return a.bank < b.bank;
+        return a.chan < b.chan;
+    });
+
+    bases->clear();
+    bases->reserve(blocks.size());
+    for (const auto& blk : blocks) {
+        BlockBase base;
+        base.src_base = blk.data_offset + ((uint64_t)blk.out_idx * *in_cnt + blk.in_idx) * trans_size;
+        base.dst_base = blk.data_offset + addr_gen(blk.chan, blk.rank, blk.bg, blk.bank, blk.row, 0);
+        base.col = blk.col;
+
+        /* both layouts grow with the transfer index, so the last transfer of a block is its highest one */
+        uint32_t last_col = blk.col + num_grf * num_grf - 1;
+        uint64_t src_end = base.src_base + ((uint64_t)(num_grf - 1) * *in_cnt + num_grf) * trans_size;
+        uint64_t dst_end = base.dst_base + (last_col / num_col_per_row) * row_stride +
+                           addr_gen(0, 0, 0, 0, 0, last_col % num_col_per_row) + trans_size;
+        if (src_end > raw_bo->size || dst_end > pim_size) {
+            DLOG(ERROR) << "gemm weight layout exceeds buffer size";
+            DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
+            return -1;
+        }
+        bases->push_back(base);
+    }
+
+    DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
+    return 0;
+}
+
+} /* namespace manager */
+} /* namespace runtime */
+} /* namespace pim */
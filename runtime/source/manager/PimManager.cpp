@@ -149,11 +149,31 @@ int PimManager::copy_memory_3d(const PimCopy3D* copy_params)
     return ret;
 }
 
-int PimManager::convert_data_layout(PimBo* dst, PimBo* src, bool reorder_on_device, void* stream)
+int PimManager::convert_data_layout(PimBo* dst, PimBo* src, bool reorder_on_device, void* stream, bool src_transposed)
 {
     DLOG(INFO) << "[START] " << __FUNCTION__ << " called";
     int ret = 0;
-    ret = pim_memory_manager_->convert_data_layout(dst, src, reorder_on_device, stream);
+    ret = pim_memory_manager_->convert_data_layout(dst, src, reorder_on_device, stream, src_transposed);
+
+    DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
+    return ret;
+}
+
+int PimManager::restore_data_layout(PimBo* dst, PimBo* src, bool restore_on_device, void* stream, bool dst_transposed)
+{
+    DLOG(INFO) << "[START] " << __FUNCTION__ << " called";
+    int ret = 0;
+    ret = pim_memory_manager_->restore_data_layout(dst, src, restore_on_device, stream, dst_transposed);
+
+    DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
+    return ret;
+}
+
+int PimManager::get_content_hash(PimBo* pim_bo, PimContentHash* hash)
+{
+    DLOG(INFO) << "[START] " << __FUNCTION__ << " called";
+    int ret = 0;
+    ret = pim_memory_manager_->get_content_hash(pim_bo, hash);
 
     DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
     return ret;
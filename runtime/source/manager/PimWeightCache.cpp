@@ -0,0 +1,168 @@
+/*
+ * Copyright (C) 2022 Samsung Electronics Co. LTD
+ *
+ * This software is a property of Samsung Electronics.
+ * No part of this software, either material or conceptual may be copied or distributed, transmitted,
+ * transcribed, stored in a retrieval system or translated into any human or computer language in any form by any means,
+ * electronic, mechanical, manual or otherwise, or disclosed
+ * to third parties without the express written permission of Samsung Electronics.
+ * (Use of the Software is restricted to non-commercial, personal or academic, research purpose only)
+ */
+
+#include "manager/PimWeightCache.h"
+#include <iterator>
+#include "utility/pim_log.h"
+
+namespace pim
+{
+namespace runtime
+{
+namespace manager
+{
+static bool is_same_bshape(const PimBShape& lhs, const PimBShape& rhs)
+{
+    return lhs.n == rhs.n && lhs.c == rhs.c && lhs.h == rhs.h && lhs.w == rhs.w;
+}
+
+bool operator==(const PimWeightKey& lhs, const PimWeightKey& rhs)
+{
+    return lhs.hash == rhs.hash && is_same_bshape(lhs.bshape, rhs.bshape) &&
+           is_same_bshape(lhs.bshape_r, rhs.bshape_r) && lhs.precision == rhs.precision && lhs.size == rhs.size &&
+           lhs.transposed == rhs.transposed && lhs.gemm_order == rhs.gemm_order;
+}
+
+PimWeightCache::PimWeightCache(size_t budget)
+    : budget_(budget), used_bytes_(0), hits_(0), misses_(0), evictions_(0)
+{
+}
+
+PimBo* PimWeightCache::find(const PimWeightKey& key, bool pin)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    auto found = map_.find(key);
+    if (found == map_.end()) {
+        misses_++;
+        return nullptr;
+    }
+    hits_++;
+    lru_.splice(lru_.begin(), lru_, found->second);
+    if (pin) found->second->pins++;
+
+    return found->second->pim_wei;
+}
+
+PimBo* PimWeightCache::insert(const PimWeightKey& key, PimBo* pim_wei, std::vector<PimEvictedWeight>* evicted,
+                              bool pin)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    auto found = map_.find(key);
+    if (found != map_.end()) {
+        /* raced with another insert of the same weight, keep the cached one */
+        evicted->push_back({pim_wei, {}});
+        if (pin) found->second->pins++;
+        return found->second->pim_wei;
+    }
+    evict_until(pim_wei->size >= budget_ ? 0 : budget_ - pim_wei->size, evicted);
+
+    lru_.push_front({key, pim_wei, pin ? 1 : 0, {}});
+    map_[key] = lru_.begin();
+    bo_map_[pim_wei] = lru_.begin();
+    used_bytes_ += pim_wei->size;
+    DLOG(INFO) << "weight cache insert size:" << pim_wei->size << " used:" << used_bytes_ << " budget:" << budget_;
+
+    return pim_wei;
+}
+
+void PimWeightCache::unpin(PimBo* pim_wei, void* stream, std::vector<PimEvictedWeight>* evicted)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    auto live = bo_map_.find(pim_wei);
+    if (live != bo_map_.end()) {
+        Entry& entry = *live->second;
+        if (entry.pins > 0) entry.pins--;
+        add_stream(&entry, stream);
+        return;
+    }
+
+    auto retired = retired_.find(pim_wei);
+    if (retired != retired_.end()) {
+        Entry& entry = retired->second;
+        if (entry.pins > 0) entry.pins--;
+        add_stream(&entry, stream);
+        if (entry.pins == 0) {
+            evicted->push_back({entry.pim_wei, entry.streams});
+            retired_.erase(retired);
+        }
+    }
+}
+
+void PimWeightCache::set_budget(size_t budget, std::vector<PimEvictedWeight>* evicted)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    budget_ = budget;
+    evict_until(budget_, evicted);
+}
+
+void PimWeightCache::clear(std::vector<PimEvictedWeight>* evicted)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    for (auto& entry : lru_) {
+        evicted->push_back({entry.pim_wei, entry.streams});
+    }
+    for (auto& retired : retired_) {
+        evicted->push_back({retired.second.pim_wei, retired.second.streams});
+    }
+    lru_.clear();
+    map_.clear();
+    bo_map_.clear();
+    retired_.clear();
+    used_bytes_ = 0;
+}
+
+void PimWeightCache::get_stats(PimWeightCacheStats* stats)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    stats->hits = hits_;
+    stats->misses = misses_;
+    stats->evictions = evictions_;
+    stats->entries = lru_.size();
+    stats->used_bytes = used_bytes_;
+    stats->budget_bytes = budget_;
+}
+
+void PimWeightCache::add_stream(Entry* entry, void* stream)
+{
+    for (auto* s : entry->streams) {
+        if (s == stream) return;
+    }
+    entry->streams.push_back(stream);
+}
+
+void PimWeightCache::evict_until(size_t target, std::vector<PimEvictedWeight>* evicted)
+{
+    while (used_bytes_ > target && !lru_.empty()) {
+        Entry& victim = lru_.back();
+        DLOG(INFO) << "weight cache evict size:" << victim.pim_wei->size << " used:" << used_bytes_
+                   << " pins:" << victim.pins;
+        used_bytes_ -= victim.pim_wei->size;
+        if (victim.pins > 0) {
+            /* still used by a gemm, the last unpin hands it back */
+            retired_[victim.pim_wei] = victim;
+        } else {
+            evicted->push_back({victim.pim_wei, victim.streams});
+        }
+        map_.erase(victim.key);
+        bo_map_.erase(victim.pim_wei);
+        lru_.pop_back();
+        evictions_++;
+    }
+}
+} /* namespace manager */
+} /* namespace runtime */
+} /* namespace pim */
@@ -0,0 +1,224 @@
+/*
+ * Copyright (C) 2022 Samsung Electronics Co. LTD
+ *
+ * This software is a property of Samsung Electronics.
+ * No part of this software, either material or conceptual may be copied or distributed, transmitted,
+ * transcribed, stored in a retrieval system or translated into any human or computer language in any form by any means,
+ * electronic, mechanical, manual or otherwise, or disclosed
+ * to third parties without the express written permission of Samsung Electronics.
+ * (Use of the Software is restricted to non-commercial, personal or academic, research purpose only)
+ */
+
+#include "manager/cpu/CpuMemoryManager.h"
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include "utility/pim_hash.h"
+#include "utility/pim_log.h"
+#include "utility/pim_util.h"
+
+#define CPU_BUFFER_ALIGN 4096
+
+namespace pim
+{
+namespace runtime
+{
+namespace manager
+{
+CpuMemoryManager::CpuMemoryManager(std::shared_ptr<PimDevice> pim_device, PimPrecision precision)
+    : pim_device_(pim_device), precision_(precision), gemm_order_(I_X_W)
+{
+    DLOG(INFO) << "[START] " << __FUNCTION__ << " called";
+    pbi_ = pim_device_->get_pim_block_info();
+    weight_reorder_ = std::make_shared<PimGemmWeightReorder>(pbi_);
+    DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
+}
+
+CpuMemoryManager::~CpuMemoryManager(void)
+{
+    DLOG(INFO) << "[START] " << __FUNCTION__ << " called";
+    pim_device_.reset();
+    DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
+}
+
+int CpuMemoryManager::initialize(void) { return 0; }
+int CpuMemoryManager::deinitialize(void) { return 0; }
+int CpuMemoryManager::alloc_memory(void** ptr, size_t size, PimMemType mem_type)
+{
+    DLOG(INFO) << "[START] " << __FUNCTION__ << " called";
+    int ret = 0;
+
+    /* every memory type lives in host memory */
+    if (posix_memalign(ptr, CPU_BUFFER_ALIGN, size > 0 ? size : 1) != 0) {
+        *ptr = nullptr;
+        ret = -1;
+    }
+
+    DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
+    return ret;
+}
+
+int CpuMemoryManager::alloc_memory(PimBo* pim_bo)
+{
+    return alloc_memory(&pim_bo->data, pim_bo->size, pim_bo->mem_type);
+}
+
+int CpuMemoryManager::free_memory(void* ptr, PimMemType mem_type)
+{
+    DLOG(INFO) << "[START] " << __FUNCTION__ << " called";
+    free(ptr);
+    DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
+    return 0;
+}
+
+int CpuMemoryManager::free_memory(PimBo* pim_bo)
+{
+    int ret = free_memory(pim_bo->data, pim_bo->mem_type);
+    pim_bo->data = nullptr;
+    return ret;
+}
+
+int CpuMemoryManager::copy_memory(void* dst, void* src, size_t size, PimMemCpyType cpy_type)
+{
+    DLOG(INFO) << "[START] " << __FUNCTION__ << " called";
+
+    if (dst == nullptr || src == nullptr) {
+        DLOG(ERROR) << "invalid copy buffer";
+        return -1;
+    }
+    memmove(dst, src, size);
+
+    DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
+    return 0;
+}
+
+int CpuMemoryManager::copy_memory(PimBo* dst, PimBo* src, PimMemCpyType cpy_type)
+{
+    return copy_memory(dst->data, src->data, dst->size, cpy_type);
+}
+
+int CpuMemoryManager::copy_memory_3d(const PimCopy3D* copy_params)
+{
+    DLOG(INFO) << "[START] " << __FUNCTION__ << " called";
+    const char* src = (const char*)copy_params->src_ptr;
+    size_t src_pitch = copy_params->src_pitch;
+    size_t src_height = copy_params->src_height;
+    char* dst = (char*)copy_params->dst_ptr;
+    size_t dst_pitch = copy_params->dst_pitch;
+    size_t dst_height = copy_params->dst_height;
+
+    /* buffer objects replace the pointer and pitch, as in the HIP manager */
+    if (copy_params->src_mem_type != MEM_TYPE_HOST && copy_params->src_bo != nullptr) {
+        const PimBo* bo = copy_params->src_bo;
+        src = (const char*)bo->data;
+        src_pitch = bo->bshape.w * PrecisionSize(bo);
+        src_height = bo->bshape.h;
+    }
+    if (copy_params->dst_mem_type != MEM_TYPE_HOST && copy_params->dst_bo != nullptr) {
+        const PimBo* bo = copy_params->dst_bo;
+        dst = (char*)bo->data;
+        dst_pitch = bo->bshape.w * PrecisionSize(bo);
+        dst_height = bo->bshape.h;
+    }
+    if (src == nullptr || dst == nullptr) {
+        DLOG(ERROR) << "invalid copy buffer";
+        return -1;
+    }
+
+    for (size_t z = 0; z < copy_params->depth; z++) {
+        for (size_t y = 0; y < copy_params->height; y++) {
+            const char* s = src + ((copy_params->src_z + z) * src_height + copy_params->src_y + y) * src_pitch +
+                            copy_params->src_x_in_bytes;
+            char* d = dst + ((copy_params->dst_z + z) * dst_height + copy_params->dst_y + y) * dst_pitch +
+                      copy_params->dst_x_in_bytes;
+            memcpy(d, s, copy_params->width_in_bytes);
+        }
+    }
+
+    DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
+    return 0;
+}
+
+int CpuMemoryManager::convert_data_layout(PimBo* dst, PimBo* src, bool reorder_on_device, void* stream,
+                                          bool src_transposed)
+{
+    DLOG(INFO) << "[START] " << __FUNCTION__ << " called";
+    int ret = 0;
+    bool is_chwise = check_chwise_gemm_bo(src, gemm_order_);
+    bool padded = src->bshape.w != src->bshape_r.w || src->bshape.h != src->bshape_r.h;
+
+    if (is_chwise) {
+        ret = weight_reorder_->reorder_chwise(dst->data, dst->size, src->data, src, gemm_order_, src_transposed);
+        dst->data_layout_type = PimDataLayoutType::CHWISE_GEMM_WEIGHT;
+    } else if (padded && src_transposed) {
+        DLOG(ERROR) << "padded gemm weight can not be reordered from the transposed source";
+        ret = -1;
+    } else {
+        const void* src_data = src->data;
+        std::vector<uint8_t> pad_stage;
+        if (padded) {
+            pad_stage.resize(src->size);
+            PimGemmWeightReorder::pad_aligned_source(pad_stage.data(), src->data, src);
+            src_data = pad_stage.data();
+        }
+        ret = weight_reorder_->reorder_aligned(dst->data, dst->size, src_data, src, gemm_order_, src_transposed);
+        dst->data_layout_type = PimDataLayoutType::ALIGNED_GEMM_WEIGHT;
+    }
+    if (ret != 0) {
+        printf("fail to convert data layout for gemm\n");
+        return ret;
+    }
+
+    DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
+    return ret;
+}
+
+int CpuMemoryManager::restore_data_layout(PimBo* dst, PimBo* src, bool restore_on_device, void* stream,
+                                          bool dst_transposed)
+{
+    DLOG(INFO) << "[START] " << __FUNCTION__ << " called";
+    int ret = 0;
+    bool padded = dst->bshape.w != dst->bshape_r.w || dst->bshape.h != dst->bshape_r.h;
+
+    if (src->data_layout_type == PimDataLayoutType::CHWISE_GEMM_WEIGHT) {
+        ret = weight_reorder_->restore_chwise(dst->data, dst, src->data, src->size, gemm_order_, dst_transposed);
+    } else if (src->data_layout_type != PimDataLayoutType::ALIGNED_GEMM_WEIGHT) {
+        DLOG(ERROR) << "source is not in a gemm weight layout";
+        ret = -1;
+    } else if (padded && dst_transposed) {
+        DLOG(ERROR) << "padded gemm weight can not be restored to the transposed layout";
+        ret = -1;
+    } else {
+        /* the padded layout is restored in place and its rows are packed to bshape_r afterwards */
+        ret = weight_reorder_->restore_aligned(dst->data, dst, src->data, src->size, gemm_order_, dst_transposed);
+        if (ret == 0 && padded) PimGemmWeightReorder::unpad_aligned_source(dst->data, dst->data, dst);
+    }
+    if (ret != 0) {
+        printf("fail to restore data layout for gemm\n");
+        return ret;
+    }
+    dst->data_layout_type = PimDataLayoutType::RAW;
+
+    DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
+    return ret;
+}
+
+int CpuMemoryManager::get_content_hash(PimBo* pim_bo, PimContentHash* hash)
+{
+    DLOG(INFO) << "[START] " << __FUNCTION__ << " called";
+    size_t size = pim_bo->size;
+
+    if ((uintptr_t)pim_bo->data % sizeof(uint64_t) == 0) {
+        *hash = hash::hash_host_memory(pim_bo->data, size);
+    } else {
+        std::vector<uint64_t> staging(hash::num_words(size));
+        memcpy(staging.data(), pim_bo->data, size);
+        *hash = hash::hash_host_memory(staging.data(), size);
+    }
+
+    DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
+    return 0;
+}
+}  // namespace manager
+}  // namespace runtime
+}  // namespace pim
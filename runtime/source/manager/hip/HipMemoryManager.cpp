@@ -13,6 +13,7 @@
 #include <assert.h>
 #include <stdlib.h>
 #include <string.h>
+#include <algorithm>
 #include <iostream>
 #include <list>
 #include "hip/hip_runtime.h"
@@ -20,12 +21,23 @@
 #include "manager/PimInfo.h"
 #include "pim_data_types.h"
 #include "utility/pim_debug.hpp"
+#include "utility/pim_hash.h"
 #include "utility/pim_util.h"
 
 #include "pim_runtime_api.h"
 
 extern std::map<uint32_t, HostInfo*> host_devices;
 
+/* default size of the tiles a device weight is reordered on host in */
+#define DEFAULT_REORDER_TILE_MB (16)
+
+/* a device reorder workgroup moves the GRF blocks of all channels, REORDER_LANE_TRANS transfers of each at a time */
+#define REORDER_GROUP_BLOCKS (64)
+#define REORDER_LANE_TRANS (4)
+#define REORDER_MAX_GROUPS (65536)
+#define TRANSPOSE_TILE (32)
+#define TRANSPOSE_ROWS (8)
+
 namespace pim
 {
 namespace runtime
@@ -185,6 +197,87 @@ __global__ void fill_gemm_weight_aligned(int n, int c, int h, int w, half* dst,
         }
     }
 }
+
+/*
+ * The thread index bits stand for the address bits col0, chan0, col1, chan1.. of the layout, so the lanes of a
+ * wavefront write whole contiguous bursts over the channels of a group, and each lane of a block reads
+ * REORDER_LANE_TRANS neighbouring transfers of one source row. to_raw runs the same walk backwards, from the PIM
+ * layout to the raw buffer.
+ */
+template <bool to_raw>
+__global__ void reorder_gemm_weight_blocks(const PimGemmWeightReorder::BlockBase* bases, uint64_t num_blocks,
+                                           int in_cnt, uint8_t* pim, uint8_t* raw)
+{
+    const PimBlockInfo& pbi = vega20_pbi;
+    int num_grf = pbi.num_grf;
+    int trans_size = pbi.trans_size;
+    uint32_t num_col_per_row = pbi.num_col / pbi.bl;
+    uint64_t row_stride = addr_gen(0, 0, 0, 0, 1, 0);
+    int lane_trans = (threadIdx.x & 1) | ((threadIdx.x >> 1) & 2);
+    uint64_t lane_block = ((threadIdx.x >> 1) & 1) | ((threadIdx.x >> 3) << 1);
+
+    for (uint64_t b = blockIdx.x * REORDER_GROUP_BLOCKS + lane_block; b < num_blocks;
+         b += (uint64_t)gridDim.x * REORDER_GROUP_BLOCKS) {
+        PimGemmWeightReorder::BlockBase base = bases[b];
+        for (int t = lane_trans; t < num_grf * num_grf; t += REORDER_LANE_TRANS) {
+#ifdef EMULATOR
+            uint64_t idx = (uint64_t)(t % num_grf) * in_cnt + t / num_grf;
+#else
+            uint64_t idx = (uint64_t)(t / num_grf) * in_cnt + t % num_grf;
+#endif
+            uint32_t col = base.col + t;
+            uint4* r = (uint4*)(raw + base.src_base + idx * trans_size);
+            uint4* p = (uint4*)(pim + base.dst_base + (col / num_col_per_row) * row_stride +
+                                addr_gen(0, 0, 0, 0, 0, col % num_col_per_row));
+            for (int i = 0; i < trans_size / (int)sizeof(uint4); i++) {
+                if (to_raw) {
+                    r[i] = p[i];
+                } else {
+                    p[i] = r[i];
+                }
+            }
+        }
+    }
+}
+
+/* dst (col x row) = transpose of src (row x col) for each matrix of a batch, through a padded shared tile */
+__global__ void transpose_gemm_weight(uint16_t* dst, const uint16_t* src, int batch, int row, int col)
+{
+    __shared__ uint16_t tile[TRANSPOSE_TILE][TRANSPOSE_TILE + 1];
+
+    for (int b = blockIdx.z; b < batch; b += gridDim.z) {
+        const uint16_t* s = src + (uint64_t)b * row * col;
+        uint16_t* d = dst + (uint64_t)b * row * col;
+        int x = blockIdx.x * TRANSPOSE_TILE + threadIdx.x;
+        int y = blockIdx.y * TRANSPOSE_TILE + threadIdx.y;
+
+        for (int j = 0; j < TRANSPOSE_TILE; j += TRANSPOSE_ROWS) {
+            if (x < col && y + j < row) tile[threadIdx.y + j][threadIdx.x] = s[(uint64_t)(y + j) * col + x];
+        }
+        __syncthreads();
+        x = blockIdx.y * TRANSPOSE_TILE + threadIdx.x;
+        y = blockIdx.x * TRANSPOSE_TILE + threadIdx.y;
+        for (int j = 0; j < TRANSPOSE_TILE; j += TRANSPOSE_ROWS) {
+            if (x < row && y + j < col) d[(uint64_t)(y + j) * row + x] = tile[threadIdx.x][threadIdx.y + j];
+        }
+        __syncthreads();
+    }
+}
+
+__global__ void hash_memory_chunks(const uint8_t* data, size_t size, uint64_t* chunk_hash)
+{
+    __shared__ uint64_t lanes[2 * PIM_HASH_LANES];
+    uint64_t chunk_cnt = hash::num_chunks(size);
+
+    for (uint64_t chunk = blockIdx.x; chunk < chunk_cnt; chunk += gridDim.x) {
+        hash::hash_lane(data, size, chunk, threadIdx.x, &lanes[2 * threadIdx.x], &lanes[2 * threadIdx.x + 1]);
+        __syncthreads();
+        if (threadIdx.x == 0) {
+            hash::hash_chunk_from_lanes(lanes, chunk, &chunk_hash[2 * chunk], &chunk_hash[2 * chunk + 1]);
+        }
+        __syncthreads();
+    }
+}
 }  // namespace
 
 inline std::list<int> get_env(const char* key)
@@ -219,12 +312,28 @@ inline std::list<int> get_env(const char* key)
     return hip_devices;
 }
 
+/* PIM_REORDER_KERNEL=element keeps the per element reorder kernels, only to be measured against */
+inline bool use_element_reorder(void)
+{
+    const char* env_k = std::getenv("PIM_REORDER_KERNEL");
+    return env_k != nullptr && std::string(env_k) == "element";
+}
+
 HipMemoryManager::HipMemoryManager(std::shared_ptr<PimDevice> pim_device, PimPrecision precision)
-    : pim_device_(pim_device), precision_(precision)
+    : pim_device_(pim_device),
+      precision_(precision),
+      reorder_tile_size_((size_t)DEFAULT_REORDER_TILE_MB << 20),
+      d_hash_buffer_(nullptr),
+      hash_buffer_chunks_(0)
 {
     DLOG(INFO) << "[START] " << __FUNCTION__ << " called";
     pbi_ = pim_device_->get_pim_block_info();
 
+    const char* env_t = std::getenv("PIM_REORDER_TILE_MB");
+    if (env_t != nullptr && atoi(env_t) > 0) {
+        reorder_tile_size_ = (size_t)atoi(env_t) << 20;
+    }
+
     int max_topology = 32;
     FILE* fd;
     char path[256];
@@ -278,10 +387,13 @@ HipMemoryManager::HipMemoryManager(std::shared_ptr<PimDevice> pim_device, PimPre
         return;
     }
 
+    /* PIM buffers have to start on a row of all channels and banks, the address of row 1 */
+    size_t pim_row_stride = addr_gen(0, 0, 0, 0, 1, 0);
     for (int device = 0; device < num_gpu_devices_; device++) {
-        fragment_allocator_.push_back(std::make_shared<SimpleHeap<HipBlockAllocator>>());
+        fragment_allocator_.push_back(std::make_shared<SimpleHeap<HipBlockAllocator>>(HipBlockAllocator(), pim_row_stride));
     }
     hipGetDevice(&host_id_);
+    weight_reorder_ = std::make_shared<PimGemmWeightReorder>(pbi_);
     DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
 }
 
@@ -305,6 +417,12 @@ int HipMemoryManager::initialize(void)
 int HipMemoryManager::deinitialize(void)
 {
     int ret = 0;
+
+    if (d_hash_buffer_ != nullptr) {
+        hipFree(d_hash_buffer_);
+        d_hash_buffer_ = nullptr;
+        hash_buffer_chunks_ = 0;
+    }
     return ret;
 }
 
@@ -524,16 +642,16 @@ int HipMemoryManager::copy_memory_3d(const PimCopy3D* copy_params)
     return ret;
 }
 
-int HipMemoryManager::convert_data_layout(PimBo* dst, PimBo* src, bool on_device, void* stream)
+int HipMemoryManager::convert_data_layout(PimBo* dst, PimBo* src, bool on_device, void* stream, bool src_transposed)
 {
     DLOG(INFO) << "[START] " << __FUNCTION__ << " called";
     int ret = 0;
     bool is_chwise = check_chwise_gemm_bo(src, gemm_order_);
 
     if (is_chwise) {
-        ret = convert_data_layout_for_chwise_gemm_weight(dst, src, on_device, stream);
+        ret = convert_data_layout_for_chwise_gemm_weight(dst, src, on_device, stream, src_transposed);
     } else {
-        ret = convert_data_layout_for_aligned_gemm_weight(dst, src, on_device, stream);
+        ret = convert_data_layout_for_aligned_gemm_weight(dst, src, on_device, stream, src_transposed);
     }
     if (ret != 0) {
         printf("fail to convert data layout for gemm\n");
@@ -544,11 +662,91 @@ int HipMemoryManager::convert_data_layout(PimBo* dst, PimBo* src, bool on_device
     return ret;
 }
 
-int HipMemoryManager::convert_data_layout_for_chwise_gemm_weight(PimBo* dst, PimBo* src, bool on_device, void* stream)
+int HipMemoryManager::restore_data_layout(PimBo* dst, PimBo* src, bool on_device, void* stream, bool dst_transposed)
 {
     DLOG(INFO) << "[START] " << __FUNCTION__ << " called";
     int ret = 0;
-    if (on_device) {
+
+    if (src->data_layout_type != PimDataLayoutType::CHWISE_GEMM_WEIGHT &&
+        src->data_layout_type != PimDataLayoutType::ALIGNED_GEMM_WEIGHT) {
+        DLOG(ERROR) << "source is not in a gemm weight layout";
+        ret = -1;
+    } else {
+        bool is_chwise = src->data_layout_type == PimDataLayoutType::CHWISE_GEMM_WEIGHT;
+        if (on_device) {
+            ret = restore_gemm_weight_on_device(dst, src, is_chwise, dst_transposed, stream);
+        } else {
+            ret = restore_gemm_weight_on_host(dst, src, is_chwise, dst_transposed);
+        }
+    }
+    if (ret != 0) {
+        printf("fail to restore data layout for gemm\n");
+        return ret;
+    }
+    dst->data_layout_type = PimDataLayoutType::RAW;
+
+    DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
+    return ret;
+}
+
+int HipMemoryManager::get_content_hash(PimBo* pim_bo, PimContentHash* hash)
+{
+    DLOG(INFO) << "[START] " << __FUNCTION__ << " called";
+    int ret = 0;
+    size_t size = pim_bo->size;
+    bool aligned = ((uintptr_t)pim_bo->data % sizeof(uint64_t)) == 0;
+
+    if (pim_bo->mem_type == MEM_TYPE_HOST || !aligned) {
+        /* hash on host; unaligned buffers are staged first since hashing reads whole words */
+        if (pim_bo->mem_type == MEM_TYPE_HOST && aligned) {
+            *hash = hash::hash_host_memory(pim_bo->data, size);
+        } else {
+            std::vector<uint64_t> staging(hash::num_words(size));
+            if (hipMemcpy(staging.data(), pim_bo->data, size, hipMemcpyDefault) != hipSuccess) {
+                DLOG(INFO) << "[END] " << __FUNCTION__ << " Failed to copy";
+                return -1;
+            }
+            *hash = hash::hash_host_memory(staging.data(), size);
+        }
+        DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
+        return ret;
+    }
+
+    /* the chunk buffer is shared by all callers, the launch and the read back hold it */
+    std::lock_guard<std::mutex> lock(hash_mutex_);
+    uint64_t chunk_cnt = hash::num_chunks(size);
+    if (chunk_cnt > hash_buffer_chunks_) {
+        if (d_hash_buffer_ != nullptr) hipFree(d_hash_buffer_);
+        if (hipMalloc((void**)&d_hash_buffer_, chunk_cnt * 2 * sizeof(uint64_t)) != hipSuccess) {
+            d_hash_buffer_ = nullptr;
+            hash_buffer_chunks_ = 0;
+            DLOG(INFO) << "[END] " << __FUNCTION__ << " Failed to allocate";
+            return -1;
+        }
+        hash_buffer_chunks_ = chunk_cnt;
+    }
+
+    std::vector<uint64_t> chunk_hash(chunk_cnt * 2);
+    unsigned blocks = std::min(chunk_cnt, (uint64_t)4096);
+    hipLaunchKernelGGL(hash_memory_chunks, dim3(blocks), dim3(PIM_HASH_LANES), 0, 0, (const uint8_t*)pim_bo->data, size,
+                       d_hash_buffer_);
+    if (hipMemcpy(chunk_hash.data(), d_hash_buffer_, chunk_cnt * 2 * sizeof(uint64_t), hipMemcpyDeviceToHost) !=
+        hipSuccess) {
+        DLOG(INFO) << "[END] " << __FUNCTION__ << " Failed to copy";
+        return -1;
+    }
+    *hash = hash::hash_from_chunks(chunk_hash.data(), chunk_cnt, size);
+
+    DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
+    return ret;
+}
+
+int HipMemoryManager::convert_data_layout_for_chwise_gemm_weight(PimBo* dst, PimBo* src, bool on_device, void* stream,
+                                                                bool src_transposed)
+{
+    DLOG(INFO) << "[START] " << __FUNCTION__ << " called";
+    int ret = 0;
+    if (on_device && use_element_reorder()) {
         DLOG(INFO) << "reordering on device";
         auto blocks = dim3(src->bshape_r.n, src->bshape_r.c);
         auto threads = dim3(32, 32);  // cover any shape by 32x32 squares
@@ -558,155 +756,14 @@ int HipMemoryManager::convert_data_layout_for_chwise_gemm_weight(PimBo* dst, Pim
         return ret;
     }
 
-    int num_grf_A = pbi_->num_grf;
-    int num_grf_B = pbi_->num_grf;
-    int num_pim_blocks = pbi_->num_pim_blocks;
-    int num_pim_chan = pbi_->num_pim_chan;
-    int num_pim_rank = pbi_->num_pim_rank;
-    int num_banks = pbi_->num_banks;
-    int num_bank_groups = pbi_->num_bank_groups;
-    int trans_size = pbi_->trans_size;
-
-    char* dst_data = nullptr;
-    char* src_data = nullptr;
-
-    int cidx = 0;
-    int rank = 0;
-    int bg = 0;
-    int bank = 0;
-    uint32_t col = 0;
-    uint32_t row = 0;
-    uint64_t addr = 0;
-    uint32_t even_s_row = 0;  // starting_row;
-    uint32_t even_s_col = 0;  // starting_col;
-    uint32_t odd_s_row = 0;   // starting_row;
-    uint32_t odd_s_col = 0;   // starting_col;
-
-    int type_size = (src->precision == PIM_FP16) ? 2 : 1;
-
-    int in_tile_size = num_grf_A;
-    int out_tile_size = num_grf_B * num_pim_blocks * num_pim_chan * num_pim_rank;
-    int data_offset = 0;
-    int in_cnt = 0;
-    int iter_cnt = 0;
-
-    if (gemm_order_ == I_X_W) {
-        iter_cnt = src->bshape.n * src->bshape.c * src->bshape.w / PIM_GEMV_OUT_ALIGN;
-        in_cnt = src->bshape.h * type_size / trans_size;
+    if (on_device) {
+        ret = reorder_gemm_weight_on_device(dst, src, true, src_transposed, stream);
     } else {
-        iter_cnt = src->bshape.n * src->bshape.c * src->bshape.h / PIM_GEMV_OUT_ALIGN;
-        in_cnt = src->bshape.w * type_size / trans_size;
-    }
-
-    for (int iter = 0; iter < iter_cnt; iter++) {
-        cidx = 0;
-        rank = 0;
-        bg = 0;
-        bank = 0;
-        col = 0;
-        row = 0;
-        addr = 0;
-        even_s_row = 0;
-        even_s_col = 0;
-        odd_s_row = 0;
-        odd_s_col = 0;
-        dst_data = (char*)dst->data + data_offset;
-        src_data = (char*)src->data + data_offset;
-
-        for (int x = 0; x < in_cnt; x += in_tile_size) {
-            if ((x / in_tile_size) % 2 == 0) {
-                for (int tiled_y = 0; tiled_y < out_tile_size; tiled_y += num_grf_B) {
-                    col = even_s_col;
-                    row = even_s_row;
-
-                    for (int grfb_idx = 0; grfb_idx < num_grf_B; grfb_idx++) {
-                        for (int grfa_idx = 0; grfa_idx < num_grf_A; grfa_idx++) {
-                            addr = addr_gen_safe(cidx, rank, bg, bank, row, col);
-#ifdef EMULATOR
-                            int d_idx = (tiled_y + grfa_idx) * in_cnt + x + grfb_idx;
-#else
-                            int d_idx = (tiled_y + grfb_idx) * in_cnt + x + grfa_idx;
-#endif
-                            if (hipMemcpy(dst_data + addr, src_data + d_idx * trans_size, trans_size,
-                                          hipMemcpyDeviceToDevice) != hipSuccess) {
-                                DLOG(INFO) << "[END] " << __FUNCTION__ << " Failed to copy";
-                                return -1;
-                            }
-                            col++;
-                        }
-                    }
-
-                    bank += (num_banks / num_pim_blocks);
-
-                    if (bank >= (num_banks / num_bank_groups)) {
-                        bg++;
-                        bank = 0;
-                    }
-
-                    if (bg >= num_bank_groups) {
-                        bg = 0;
-                        rank++;
-                    }
-
-                    if (rank >= num_pim_rank) {
-                        rank = 0;
-                        cidx++;
-                    }
-
-                    if (cidx >= num_pim_chan) {
-                        cidx = 0;
-                        even_s_row = row;
-                        even_s_col = col;
-                    }
-                }
-            } else if ((x / in_tile_size) % 2 == 1) {
-                for (int tiled_y = 0; tiled_y < out_tile_size; tiled_y += num_grf_B) {
-                    col = odd_s_col;
-                    row = odd_s_row;
-
-                    for (int grfb_idx = 0; grfb_idx < num_grf_B; grfb_idx++) {
-                        for (int grfa_idx = 0; grfa_idx < num_grf_A; grfa_idx++) {
-                            addr = addr_gen_safe(cidx, rank, bg, bank + 1, row, col);
-#ifdef EMULATOR
-                            int d_idx = (tiled_y + grfa_idx) * in_cnt + x + grfb_idx;
-#else
-                            int d_idx = (tiled_y + grfb_idx) * in_cnt + x + grfa_idx;
-#endif
-                            if (hipMemcpy(dst_data + addr, src_data + d_idx * trans_size, trans_size,
-                                          hipMemcpyDeviceToDevice) != hipSuccess) {
-                                DLOG(INFO) << "[END] " << __FUNCTION__ << " Failed to copy";
-                                return -1;
-                            }
-                            col++;
-                        }
-                    }
-
-                    bank += (num_banks / num_pim_blocks);
-
-                    if (bank >= (num_banks / num_bank_groups)) {
-                        bg++;
-                        bank = 0;
-                    }
-
-                    if (bg >= num_bank_groups) {
-                        bg = 0;
-                        rank++;
-                    }
-
-                    if (rank >= num_pim_rank) {
-                        rank = 0;
-                        cidx++;
-                    }
-
-                    if (cidx >= num_pim_chan) {
-                        cidx = 0;
-                        odd_s_row = row;
-                        odd_s_col = col;
-                    }
-                }
-            }
-        }
-        data_offset += (src->bshape.h * PIM_GEMV_OUT_ALIGN * sizeof(half));
+        ret = reorder_gemm_weight_on_host(dst, src, true, src_transposed);
+    }
+    if (ret != 0) {
+        DLOG(INFO) << "[END] " << __FUNCTION__ << " Failed to reorder";
+        return ret;
     }
     dst->data_layout_type = PimDataLayoutType::CHWISE_GEMM_WEIGHT;
 
@@ -714,191 +771,406 @@ int HipMemoryManager::convert_data_layout_for_chwise_gemm_weight(PimBo* dst, Pim
     return ret;
 }
 
-int HipMemoryManager::convert_data_layout_for_aligned_gemm_weight(PimBo* dst, PimBo* src, bool on_device, void* stream)
+int HipMemoryManager::convert_data_layout_for_aligned_gemm_weight(PimBo* dst, PimBo* src, bool on_device, void* stream,
+                                                                 bool src_transposed)
 {
     DLOG(INFO) << "[START] " << __FUNCTION__ << " called";
     int ret = 0;
 
-    int num_grf_A = pbi_->num_grf;
-    int num_grf_B = pbi_->num_grf;
-    int num_pim_blocks = pbi_->num_pim_blocks;
-    int num_pim_chan = pbi_->num_pim_chan;
-    int num_pim_rank = pbi_->num_pim_rank;
-    int num_banks = pbi_->num_banks;
-    int num_bank_groups = pbi_->num_bank_groups;
-    int trans_size = pbi_->trans_size;
-
-    int in_tile_size = num_grf_A;
-    int out_tile_size = num_grf_B * num_pim_blocks * num_pim_chan * num_pim_rank;
-    char* dst_data = nullptr;
-    char* src_data = nullptr;
-    char* src_temp = nullptr;
-    int data_offset = 0;
-    int iter_cnt = src->bshape.n * src->bshape.c;
-
-    int cidx = 0;
-    int rank = 0;
-    int bg = 0;
-    int bank = 0;
-    uint32_t col = 0;
-    uint32_t row = 0;
-    uint64_t addr = 0;
-    uint32_t even_s_row = 0;  // starting_row;
-    uint32_t even_s_col = 0;  // starting_col;
-    uint32_t odd_s_row = 0;   // starting_row;
-    uint32_t odd_s_col = 0;   // starting_col;
-
-    int type_size = (src->precision == PIM_FP16) ? 2 : 1;
-    int src_size = src->size;
-    int out_cnt = 0;
-    int in_cnt = 0;
+    if (on_device && use_element_reorder()) {
+        DLOG(INFO) << "reordering on device";
+        auto blocks = dim3(src->bshape_r.n, src->bshape_r.c);
+        auto threads = dim3(1, 1024);  // alignment 256x4096 can't be reached due to 1024 threads limitation
+        hipLaunchKernelGGL(fill_gemm_weight_aligned, blocks, threads, 0, (hipStream_t)stream, src->bshape_r.n,
+                           src->bshape_r.c, src->bshape_r.h, src->bshape_r.w, (half*)dst->data, (half*)src->data);
+        dst->data_layout_type = PimDataLayoutType::ALIGNED_GEMM_WEIGHT;
+        return ret;
+    }
 
-    if (gemm_order_ == I_X_W) {
-        out_cnt = src->bshape.w;
-        in_cnt = src->bshape.h * type_size / trans_size;
+    if (on_device) {
+        ret = reorder_gemm_weight_on_device(dst, src, false, src_transposed, stream);
     } else {
-        out_cnt = src->bshape.h;
-        in_cnt = src->bshape.w * type_size / trans_size;
+        ret = reorder_gemm_weight_on_host(dst, src, false, src_transposed);
     }
+    if (ret != 0) {
+        DLOG(INFO) << "[END] " << __FUNCTION__ << " Failed to reorder";
+        return ret;
+    }
+    dst->data_layout_type = PimDataLayoutType::ALIGNED_GEMM_WEIGHT;
 
-    if (src->bshape.w != src->bshape_r.w || src->bshape.h != src->bshape_r.h) {
-        src_temp = (char*)calloc(src_size, sizeof(half));
-        for (int i = 0; i < src->bshape_r.w; i++) {
-            if (hipMemcpy((half*)src_temp + i * src->bshape.h, (half*)src->data + i * src->bshape_r.h,
-                          src->bshape_r.h * sizeof(half), hipMemcpyDeviceToHost) != hipSuccess) {
-                DLOG(INFO) << "[END] " << __FUNCTION__ << " Failed to copy";
-                return -1;
+    DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
+    return ret;
+}
+
+int HipMemoryManager::reorder_gemm_weight_on_host(PimBo* dst, PimBo* src, bool is_chwise, bool src_transposed)
+{
+    DLOG(INFO) << "[START] " << __FUNCTION__ << " called";
+    int ret = 0;
+    bool padded = src->bshape.w != src->bshape_r.w || src->bshape.h != src->bshape_r.h;
+    void* src_host = src->data;
+    void* dst_host = dst->data;
+    void* src_stage = nullptr;
+    void* pad_stage = nullptr;
+    void* dst_stage = nullptr;
+
+    if (src->mem_type != MEM_TYPE_HOST && dst->mem_type != MEM_TYPE_HOST && (is_chwise || !padded)) {
+        ret = reorder_gemm_weight_tiled(dst, src, is_chwise, src_transposed);
+        DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
+        return ret;
+    }
+
+    /* device buffers are staged in pinned memory with one bulk copy each way */
+    if (src->mem_type != MEM_TYPE_HOST) {
+        if (hipHostMalloc(&src_stage, src->size) != hipSuccess ||
+            hipMemcpy(src_stage, src->data, src->size, hipMemcpyDeviceToHost) != hipSuccess) {
+            ret = -1;
+        }
+        src_host = src_stage;
+    }
+    if (ret == 0 && !is_chwise && padded && src_transposed) {
+        DLOG(ERROR) << "padded gemm weight can not be reordered from the transposed source";
+        ret = -1;
+    } else if (ret == 0 && !is_chwise && padded) {
+        if (hipHostMalloc(&pad_stage, src->size) == hipSuccess) {
+            PimGemmWeightReorder::pad_aligned_source(pad_stage, src_host, src);
+        } else {
+            ret = -1;
+        }
+        src_host = pad_stage;
+    }
+    if (ret == 0 && dst->mem_type != MEM_TYPE_HOST) {
+        /* keep bytes which the layout does not cover */
+        if (hipHostMalloc(&dst_stage, dst->size) != hipSuccess ||
+            hipMemcpy(dst_stage, dst->data, dst->size, hipMemcpyDeviceToHost) != hipSuccess) {
+            ret = -1;
+        }
+        dst_host = dst_stage;
+    }
+
+    if (ret == 0) {
+        if (is_chwise) {
+            ret = weight_reorder_->reorder_chwise(dst_host, dst->size, src_host, src, gemm_order_, src_transposed);
+        } else {
+            ret = weight_reorder_->reorder_aligned(dst_host, dst->size, src_host, src, gemm_order_, src_transposed);
+        }
+    }
+    if (ret == 0 && dst_stage != nullptr) {
+        if (hipMemcpy(dst->data, dst_stage, dst->size, hipMemcpyHostToDevice) != hipSuccess) ret = -1;
+    }
+
+    if (src_stage != nullptr) hipHostFree(src_stage);
+    if (pad_stage != nullptr) hipHostFree(pad_stage);
+    if (dst_stage != nullptr) hipHostFree(dst_stage);
+
+    DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
+    return ret;
+}
+
+int HipMemoryManager::reorder_gemm_weight_on_device(PimBo* dst, PimBo* src, bool is_chwise, bool src_transposed,
+                                                   void* stream)
+{
+    DLOG(INFO) << "[START] " << __FUNCTION__ << " called";
+    int ret = 0;
+    int in_cnt = 0;
+    hipStream_t hip_stream = (hipStream_t)stream;
+    bool padded = src->bshape.w != src->bshape_r.w || src->bshape.h != src->bshape_r.h;
+    std::vector<PimGemmWeightReorder::BlockBase> bases;
+    PimGemmWeightReorder::BlockBase* d_bases = nullptr;
+    const void* src_data = src->data;
+    void* src_stage = nullptr;
+
+    if (!is_chwise && padded && src_transposed) {
+        DLOG(ERROR) << "padded gemm weight can not be reordered from the transposed source";
+        DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
+        return -1;
+    }
+    if (weight_reorder_->plan_block_bases(src, dst->size, gemm_order_, is_chwise, &bases, &in_cnt) != 0) {
+        DLOG(INFO) << "[END] " << __FUNCTION__ << " Failed to plan";
+        return -1;
+    }
+    if (bases.empty()) {
+        DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
+        return ret;
+    }
+
+    size_t bases_size = bases.size() * sizeof(PimGemmWeightReorder::BlockBase);
+    if (hipMalloc((void**)&d_bases, bases_size) != hipSuccess ||
+        hipMemcpyAsync(d_bases, bases.data(), bases_size, hipMemcpyHostToDevice, hip_stream) != hipSuccess) {
+        ret = -1;
+    }
+
+    /* the source is transposed or padded into a device copy first, as the host converter stages it */
+    if (ret == 0 && src_transposed) {
+        int batch = src->bshape.n * src->bshape.c;
+        int row = src->bshape.h;
+        int col = src->bshape.w;
+        auto blocks = dim3((col + TRANSPOSE_TILE - 1) / TRANSPOSE_TILE, (row + TRANSPOSE_TILE - 1) / TRANSPOSE_TILE,
+                           std::min(batch, 65535));
+        if ((size_t)batch * row * col * sizeof(half) <= src->size && hipMalloc(&src_stage, src->size) == hipSuccess) {
+            hipLaunchKernelGGL(transpose_gemm_weight, blocks, dim3(TRANSPOSE_TILE, TRANSPOSE_ROWS), 0, hip_stream,
+                               (uint16_t*)src_stage, (const uint16_t*)src->data, batch, row, col);
+        } else {
+            ret = -1;
+        }
+        src_data = src_stage;
+    } else if (ret == 0 && !is_chwise && padded) {
+        /* same spread as pad_aligned_source, rows of bshape_r.h elements at a pitch of bshape.h */
+        size_t pitch = src->bshape.h * sizeof(half);
+        size_t row_size = src->bshape_r.h * sizeof(half);
+        size_t batch = src->bshape.n * src->bshape.c;
+        if (hipMalloc(&src_stage, src->size) != hipSuccess ||
+            hipMemsetAsync(src_stage, 0, src->size, hip_stream) != hipSuccess) {
+            ret = -1;
+        }
+        for (size_t b = 0; b < batch && ret == 0; b++) {
+            char* dst_batch = (char*)src_stage + b * pitch * src->bshape.w;
+            const char* src_batch = (const char*)src->data + b * row_size * src->bshape_r.w;
+            if (hipMemcpy2DAsync(dst_batch, pitch, src_batch, row_size, row_size, src->bshape_r.w,
+                                 hipMemcpyDeviceToDevice, hip_stream) != hipSuccess) {
+                ret = -1;
             }
         }
-        if (hipMemcpy(src_data, src_temp, src_size, hipMemcpyHostToDevice) != hipSuccess) {
-            DLOG(INFO) << "[END] " << __FUNCTION__ << " Failed to copy";
-            return -1;
+        src_data = src_stage;
+    }
+
+    if (ret == 0) {
+        uint64_t num_groups = (bases.size() + REORDER_GROUP_BLOCKS - 1) / REORDER_GROUP_BLOCKS;
+        auto blocks = dim3((unsigned)std::min(num_groups, (uint64_t)REORDER_MAX_GROUPS));
+        auto threads = dim3(REORDER_GROUP_BLOCKS * REORDER_LANE_TRANS);
+        hipLaunchKernelGGL(reorder_gemm_weight_blocks<false>, blocks, threads, 0, hip_stream, d_bases,
+                           (uint64_t)bases.size(), in_cnt, (uint8_t*)dst->data, (uint8_t*)src_data);
+        if (hipGetLastError() != hipSuccess) ret = -1;
+    }
+
+    /* the block table and the staged source live until the kernels are done */
+    if (hipStreamSynchronize(hip_stream) != hipSuccess) ret = -1;
+    if (d_bases != nullptr) hipFree(d_bases);
+    if (src_stage != nullptr) hipFree(src_stage);
+
+    DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
+    return ret;
+}
+
+int HipMemoryManager::restore_gemm_weight_on_host(PimBo* dst, PimBo* src, bool is_chwise, bool dst_transposed)
+{
+    DLOG(INFO) << "[START] " << __FUNCTION__ << " called";
+    int ret = 0;
+    bool padded = !is_chwise && (dst->bshape.w != dst->bshape_r.w || dst->bshape.h != dst->bshape_r.h);
+    size_t packed_size = (size_t)dst->bshape_r.n * dst->bshape_r.c * dst->bshape_r.h * dst->bshape_r.w * sizeof(half);
+    void* src_host = src->data;
+    void* dst_host = dst->data;
+    void* src_stage = nullptr;
+    void* dst_stage = nullptr;
+
+    if (padded && dst_transposed) {
+        DLOG(ERROR) << "padded gemm weight can not be restored to the transposed layout";
+        DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
+        return -1;
+    }
+
+    /* device buffers are staged in pinned memory with one bulk copy each way */
+    if (src->mem_type != MEM_TYPE_HOST) {
+        if (hipHostMalloc(&src_stage, src->size) != hipSuccess ||
+            hipMemcpy(src_stage, src->data, src->size, hipMemcpyDeviceToHost) != hipSuccess) {
+            ret = -1;
         }
-        free(src_temp);
+        src_host = src_stage;
     }
-    if (on_device) {
-        DLOG(INFO) << "reordering on device";
-        auto blocks = dim3(src->bshape_r.n, src->bshape_r.c);
-        auto threads = dim3(1, 1024);  // alignment 256x4096 can't be reached due to 1024 threads limitation
-        hipLaunchKernelGGL(fill_gemm_weight_aligned, blocks, threads, 0, (hipStream_t)stream, src->bshape_r.n,
-                           src->bshape_r.c, src->bshape_r.h, src->bshape_r.w, (half*)dst->data, (half*)src->data);
-        dst->data_layout_type = PimDataLayoutType::ALIGNED_GEMM_WEIGHT;
+    if (ret == 0 && dst->mem_type != MEM_TYPE_HOST) {
+        if (hipHostMalloc(&dst_stage, dst->size) != hipSuccess) ret = -1;
+        dst_host = dst_stage;
+    }
+
+    if (ret == 0) {
+        if (is_chwise) {
+            ret = weight_reorder_->restore_chwise(dst_host, dst, src_host, src->size, gemm_order_, dst_transposed);
+        } else {
+            ret = weight_reorder_->restore_aligned(dst_host, dst, src_host, src->size, gemm_order_, dst_transposed);
+        }
+    }
+    /* the padded layout is restored in place and its rows are packed to bshape_r afterwards */
+    if (ret == 0 && padded) PimGemmWeightReorder::unpad_aligned_source(dst_host, dst_host, dst);
+    if (ret == 0 && dst_stage != nullptr) {
+        if (hipMemcpy(dst->data, dst_stage, padded ? packed_size : dst->size, hipMemcpyHostToDevice) != hipSuccess) {
+            ret = -1;
+        }
+    }
+
+    if (src_stage != nullptr) hipHostFree(src_stage);
+    if (dst_stage != nullptr) hipHostFree(dst_stage);
+
+    DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
+    return ret;
+}
+
+int HipMemoryManager::restore_gemm_weight_on_device(PimBo* dst, PimBo* src, bool is_chwise, bool dst_transposed,
+                                                   void* stream)
+{
+    DLOG(INFO) << "[START] " << __FUNCTION__ << " called";
+    int ret = 0;
+    int in_cnt = 0;
+    hipStream_t hip_stream = (hipStream_t)stream;
+    bool padded = !is_chwise && (dst->bshape.w != dst->bshape_r.w || dst->bshape.h != dst->bshape_r.h);
+    std::vector<PimGemmWeightReorder::BlockBase> bases;
+    PimGemmWeightReorder::BlockBase* d_bases = nullptr;
+    void* raw_data = dst->data;
+    void* raw_stage = nullptr;
+
+    if (padded && dst_transposed) {
+        DLOG(ERROR) << "padded gemm weight can not be restored to the transposed layout";
+        DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
+        return -1;
+    }
+    if (weight_reorder_->plan_block_bases(dst, src->size, gemm_order_, is_chwise, &bases, &in_cnt) != 0) {
+        DLOG(INFO) << "[END] " << __FUNCTION__ << " Failed to plan";
+        return -1;
+    }
+    if (bases.empty()) {
+        DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
         return ret;
     }
 
-    for (int iter = 0; iter < iter_cnt; iter++) {
-        cidx = 0;
-        rank = 0;
-        bg = 0;
-        bank = 0;
-        col = 0;
-        row = 0;
-        addr = 0;
-        even_s_row = 0;
-        even_s_col = 0;
-        odd_s_row = 0;
-        odd_s_col = 0;
-        dst_data = (char*)dst->data + data_offset;
-        src_data = (char*)src->data + data_offset;
-
-        for (int y = 0; y < out_cnt; y += out_tile_size) {
-            for (int x = 0; x < in_cnt; x += in_tile_size) {
-                if ((x / in_tile_size) % 2 == 0) {
-                    for (int tiled_y = 0; tiled_y < out_tile_size; tiled_y += num_grf_B) {
-                        col = even_s_col;
-                        row = even_s_row;
-
-                        for (int grfb_idx = 0; grfb_idx < num_grf_B; grfb_idx++) {
-                            for (int grfa_idx = 0; grfa_idx < num_grf_A; grfa_idx++) {
-                                addr = addr_gen_safe(cidx, rank, bg, bank, row, col);
-#ifdef EMULATOR
-                                int d_idx = (y + tiled_y + grfa_idx) * in_cnt + x + grfb_idx;
-#else
-                                int d_idx = (y + tiled_y + grfb_idx) * in_cnt + x + grfa_idx;
-#endif
-                                if (hipMemcpy(dst_data + addr, src_data + d_idx * trans_size, trans_size,
-                                              hipMemcpyDeviceToDevice) != hipSuccess) {
-                                    DLOG(INFO) << "[END] " << __FUNCTION__ << " Failed to copy";
-                                    return -1;
-                                }
-                                col++;
-                            }
-                        }
-
-                        bank += (num_banks / num_pim_blocks);
-
-                        if (bank >= (num_banks / num_bank_groups)) {
-                            bg++;
-                            bank = 0;
-                        }
-
-                        if (bg >= num_bank_groups) {
-                            bg = 0;
-                            rank++;
-                        }
-
-                        if (rank >= num_pim_rank) {
-                            rank = 0;
-                            cidx++;
-                        }
-
-                        if (cidx >= num_pim_chan) {
-                            cidx = 0;
-                            even_s_row = row;
-                            even_s_col = col;
-                        }
-                    }
-                } else if ((x / in_tile_size) % 2 == 1) {
-                    for (int tiled_y = 0; tiled_y < out_tile_size; tiled_y += num_grf_B) {
-                        col = odd_s_col;
-                        row = odd_s_row;
-
-                        for (int grfb_idx = 0; grfb_idx < num_grf_B; grfb_idx++) {
-                            for (int grfa_idx = 0; grfa_idx < num_grf_A; grfa_idx++) {
-                                addr = addr_gen_safe(cidx, rank, bg, bank + 1, row, col);
-#ifdef EMULATOR
-                                int d_idx = (y + tiled_y + grfa_idx) * in_cnt + x + grfb_idx;
-#else
-                                int d_idx = (y + tiled_y + grfb_idx) * in_cnt + x + grfa_idx;
-#endif
-                                if (hipMemcpy(dst_data + addr, src_data + d_idx * trans_size, trans_size,
-                                              hipMemcpyDeviceToDevice) != hipSuccess) {
-                                    DLOG(INFO) << "[END] " << __FUNCTION__ << " Failed to copy";
-                                    return -1;
-                                }
-                                col++;
-                            }
-                        }
-
-                        bank += (num_banks / num_pim_blocks);
-
-                        if (bank >= (num_banks / num_bank_groups)) {
-                            bg++;
-                            bank = 0;
-                        }
-
-                        if (bg >= num_bank_groups) {
-                            bg = 0;
-                            rank++;
-                        }
-
-                        if (rank >= num_pim_rank) {
-                            rank = 0;
-                            cidx++;
-                        }
-
-                        if (cidx >= num_pim_chan) {
-                            cidx = 0;
-                            odd_s_row = row;
-                            odd_s_col = col;
-                        }
-                    }
-                }
+    size_t bases_size = bases.size() * sizeof(PimGemmWeightReorder::BlockBase);
+    if (hipMalloc((void**)&d_bases, bases_size) != hipSuccess ||
+        hipMemcpyAsync(d_bases, bases.data(), bases_size, hipMemcpyHostToDevice, hip_stream) != hipSuccess) {
+        ret = -1;
+    }
+    /* a transposed or padded target gets the plain layout in a device copy first, as the host restore does */
+    if (ret == 0 && (dst_transposed || padded)) {
+        if (hipMalloc(&raw_stage, dst->size) != hipSuccess) ret = -1;
+        raw_data = raw_stage;
+    }
+
+    if (ret == 0) {
+        uint64_t num_groups = (bases.size() + REORDER_GROUP_BLOCKS - 1) / REORDER_GROUP_BLOCKS;
+        auto blocks = dim3((unsigned)std::min(num_groups, (uint64_t)REORDER_MAX_GROUPS));
+        auto threads = dim3(REORDER_GROUP_BLOCKS * REORDER_LANE_TRANS);
+        hipLaunchKernelGGL(reorder_gemm_weight_blocks<true>, blocks, threads, 0, hip_stream, d_bases,
+                           (uint64_t)bases.size(), in_cnt, (uint8_t*)src->data, (uint8_t*)raw_data);
+        if (hipGetLastError() != hipSuccess) ret = -1;
+    }
+
+    if (ret == 0 && dst_transposed) {
+        int batch = dst->bshape.n * dst->bshape.c;
+        int row = dst->bshape.w;
+        int col = dst->bshape.h;
+        auto blocks = dim3((col + TRANSPOSE_TILE - 1) / TRANSPOSE_TILE, (row + TRANSPOSE_TILE - 1) / TRANSPOSE_TILE,
+                           std::min(batch, 65535));
+        if ((size_t)batch * row * col * sizeof(half) <= dst->size) {
+            hipLaunchKernelGGL(transpose_gemm_weight, blocks, dim3(TRANSPOSE_TILE, TRANSPOSE_ROWS), 0, hip_stream,
+                               (uint16_t*)dst->data, (const uint16_t*)raw_stage, batch, row, col);
+        } else {
+            ret = -1;
+        }
+    } else if (ret == 0 && padded) {
+        /* inverse of the spread before a reorder, rows of bshape_r.h elements are packed from a pitch of bshape.h */
+        size_t pitch = dst->bshape.h * sizeof(half);
+        size_t row_size = dst->bshape_r.h * sizeof(half);
+        size_t batch = dst->bshape.n * dst->bshape.c;
+        for (size_t b = 0; b < batch && ret == 0; b++) {
+            char* dst_batch = (char*)dst->data + b * row_size * dst->bshape_r.w;
+            const char* src_batch = (const char*)raw_stage + b * pitch * dst->bshape.w;
+            if (hipMemcpy2DAsync(dst_batch, row_size, src_batch, pitch, row_size, dst->bshape_r.w,
+                                 hipMemcpyDeviceToDevice, hip_stream) != hipSuccess) {
+                ret = -1;
             }
         }
-        data_offset += (src->bshape.h * src->bshape.w * sizeof(half));
     }
-    dst->data_layout_type = PimDataLayoutType::ALIGNED_GEMM_WEIGHT;
+
+    /* the block table and the staged layout live until the kernels are done */
+    if (hipStreamSynchronize(hip_stream) != hipSuccess) ret = -1;
+    if (d_bases != nullptr) hipFree(d_bases);
+    if (raw_stage != nullptr) hipFree(raw_stage);
+
+    DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
+    return ret;
+}
+
+int HipMemoryManager::reorder_gemm_weight_tiled(PimBo* dst, PimBo* src, bool is_chwise, bool src_transposed)
+{
+    DLOG(INFO) << "[START] " << __FUNCTION__ << " called";
+    PimGemmWeightReorder::ReorderPlan plan;
+
+    if (weight_reorder_->plan_tiles(src, dst->size, gemm_order_, is_chwise, src_transposed, reorder_tile_size_,
+                                    &plan) != 0) {
+        DLOG(INFO) << "[END] " << __FUNCTION__ << " Failed to plan";
+        return -1;
+    }
+
+    /*
+     * Two staging buffers each way: while tile t is reordered on host, tile t + 1 is read from the device and
+     * tile t - 1 is written to PIM memory, on their own streams so both directions of the link are busy.
+     */
+    int ret = 0;
+    size_t num_tiles = plan.tiles.size();
+    int num_bufs = num_tiles > 1 ? 2 : 1;
+    void* src_stage[2] = {nullptr, nullptr};
+    void* dst_stage[2] = {nullptr, nullptr};
+    hipStream_t streams[2] = {nullptr, nullptr};
+    hipEvent_t src_ready[2] = {nullptr, nullptr};
+    hipEvent_t dst_free[2] = {nullptr, nullptr};
+
+    for (int i = 0; i < 2 && ret == 0; i++) {
+        if (hipStreamCreateWithFlags(&streams[i], hipStreamNonBlocking) != hipSuccess) ret = -1;
+    }
+    for (int i = 0; i < num_bufs && ret == 0; i++) {
+        if (hipHostMalloc(&src_stage[i], plan.max_raw_size) != hipSuccess ||
+            hipHostMalloc(&dst_stage[i], plan.max_pim_size) != hipSuccess ||
+            hipEventCreate(&src_ready[i]) != hipSuccess || hipEventCreate(&dst_free[i]) != hipSuccess) {
+            ret = -1;
+        }
+    }
+
+    auto fetch = [&](size_t t) {
+        const PimGemmWeightReorder::ReorderTile& tile = plan.tiles[t];
+        int buf = t % num_bufs;
+        if (hipMemcpy2DAsync(src_stage[buf], tile.row_size, (char*)src->data + tile.src_offset, tile.src_pitch,
+                             tile.row_size, tile.num_rows, hipMemcpyDeviceToHost, streams[0]) != hipSuccess ||
+            hipEventRecord(src_ready[buf], streams[0]) != hipSuccess) {
+            return -1;
+        }
+        return 0;
+    };
+
+    if (ret == 0) ret = fetch(0);
+    for (size_t t = 0; t < num_tiles && ret == 0; t++) {
+        const PimGemmWeightReorder::ReorderTile& tile = plan.tiles[t];
+        int buf = t % num_bufs;
+        char* pim_data = (char*)dst->data + tile.pim_offset;
+
+        /* the other source buffer was freed by the reorder of tile t - 1 */
+        if (t + 1 < num_tiles) ret = fetch(t + 1);
+        if (ret == 0 && (hipEventSynchronize(src_ready[buf]) != hipSuccess ||
+                         hipEventSynchronize(dst_free[buf]) != hipSuccess)) {
+            ret = -1;
+        }
+        /* keep bytes which the layout does not cover */
+        if (ret == 0 && !tile.covered &&
+            (hipMemcpyAsync(dst_stage[buf], pim_data, tile.pim_size, hipMemcpyDeviceToHost, streams[1]) !=
+                 hipSuccess ||
+             hipStreamSynchronize(streams[1]) != hipSuccess)) {
+            ret = -1;
+        }
+        if (ret == 0) ret = weight_reorder_->reorder_tile(dst_stage[buf], src_stage[buf], plan, t);
+        if (ret == 0 &&
+            (hipMemcpyAsync(pim_data, dst_stage[buf], tile.pim_size, hipMemcpyHostToDevice, streams[1]) != hipSuccess ||
+             hipEventRecord(dst_free[buf], streams[1]) != hipSuccess)) {
+            ret = -1;
+        }
+    }
+
+    for (int i = 0; i < 2; i++) {
+        if (streams[i] != nullptr) {
+            if (hipStreamSynchronize(streams[i]) != hipSuccess) ret = -1;
+            hipStreamDestroy(streams[i]);
+        }
+    }
+    for (int i = 0; i < num_bufs; i++) {
+        if (src_ready[i] != nullptr) hipEventDestroy(src_ready[i]);
+        if (dst_free[i] != nullptr) hipEventDestroy(dst_free[i]);
+        if (src_stage[i] != nullptr) hipHostFree(src_stage[i]);
+        if (dst_stage[i] != nullptr) hipHostFree(dst_stage[i]);
+    }
 
     DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
     return ret;
@@ -15,8 +15,10 @@
 #include <stdlib.h>
 #include <string.h>
 #include <iostream>
+#include <vector>
 #include "manager/HostInfo.h"
 #include "utility/assert_cl.h"
+#include "utility/pim_hash.h"
 #include "utility/pim_util.h"
 
 /*
@@ -47,9 +49,12 @@ OclMemoryManager::OclMemoryManager(std::shared_ptr<PimDevice> pim_device, PimPre
     clGetDeviceIDs(platform, CL_DEVICE_TYPE_GPU, 1, &device_id, NULL);
     context = clCreateContext(NULL, 1, &device_id, NULL, NULL, NULL);
     queue = clCreateCommandQueue(context, device_id, 0, NULL);
+    /* PIM buffers have to start on a row of all channels and banks, the address of row 1 */
+    size_t pim_row_stride = addr_gen(0, 0, 0, 0, 1, 0);
     for (int device = 0; device < num_gpu_devices_; device++) {
-        fragment_allocator_.push_back(std::make_shared<SimpleHeap<OclBlockAllocator>>());
+        fragment_allocator_.push_back(std::make_shared<SimpleHeap<OclBlockAllocator>>(OclBlockAllocator(), pim_row_stride));
     }
+    weight_reorder_ = std::make_shared<PimGemmWeightReorder>(pbi_);
     DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
 }
 
@@ -351,16 +356,17 @@ int OclMemoryManager::copy_memory_3d(const PimCopy3D* copy_params)
     return ret;
 }
 
-int OclMemoryManager::convert_data_layout(PimBo* dst, PimBo* src, bool reorder_on_device, void* stream)
+int OclMemoryManager::convert_data_layout(PimBo* dst, PimBo* src, bool reorder_on_device, void* stream,
+                                          bool src_transposed)
 {
     DLOG(INFO) << "[START] " << __FUNCTION__ << " called";
     int ret = 0;
     bool is_chwise = check_chwise_gemm_bo(src, gemm_order_);
     // TODO: support device reordering for OCL
     if (is_chwise) {
-        ret = convert_data_layout_for_chwise_gemm_weight(dst, src);
+        ret = convert_data_layout_for_chwise_gemm_weight(dst, src, src_transposed);
     } else {
-        ret = convert_data_layout_for_aligned_gemm_weight(dst, src);
+        ret = convert_data_layout_for_aligned_gemm_weight(dst, src, src_transposed);
     }
     if (ret != 0) {
         printf("fail to convert data layout for gemm\n");
@@ -371,153 +377,68 @@ int OclMemoryManager::convert_data_layout(PimBo* dst, PimBo* src, bool reorder_o
     return ret;
 }
 
-int OclMemoryManager::convert_data_layout_for_chwise_gemm_weight(PimBo* dst, PimBo* src)
+int OclMemoryManager::restore_data_layout(PimBo* dst, PimBo* src, bool restore_on_device, void* stream,
+                                          bool dst_transposed)
 {
     DLOG(INFO) << "[START] " << __FUNCTION__ << " called";
     int ret = 0;
-
-    int num_grf_A = pbi_->num_grf;
-    int num_grf_B = pbi_->num_grf;
-    int num_pim_blocks = pbi_->num_pim_blocks;
-    int num_pim_chan = pbi_->num_pim_chan;
-    int num_pim_rank = pbi_->num_pim_rank;
-    int num_banks = pbi_->num_banks;
-    int num_bank_groups = pbi_->num_bank_groups;
-    int trans_size = pbi_->trans_size;
-
-    char* dst_data = nullptr;
-    char* src_data = nullptr;
-
-    int cidx = 0;
-    int rank = 0;
-    int bg = 0;
-    int bank = 0;
-    uint32_t col = 0;
-    uint32_t row = 0;
-    uint64_t addr = 0;
-    uint32_t even_s_row = 0;  // starting_row;
-    uint32_t even_s_col = 0;  // starting_col;
-    uint32_t odd_s_row = 0;   // starting_row;
-    uint32_t odd_s_col = 0;   // starting_col;
-
-    int type_size = (src->precision == PIM_FP16) ? 2 : 1;
-
-    int in_tile_size = num_grf_A;
-    int out_tile_size = num_grf_B * num_pim_blocks * num_pim_chan * num_pim_rank;
-    int data_offset = 0;
-
-    int iter_cnt = 0;
-    int in_cnt = 0;
-
-    if (gemm_order_ == I_X_W) {
-        iter_cnt = src->bshape.n * src->bshape.c * src->bshape.w / PIM_GEMV_OUT_ALIGN;
-        in_cnt = src->bshape.h * type_size / trans_size;
+    // TODO: support device restoring for OCL
+    if (src->data_layout_type == PimDataLayoutType::CHWISE_GEMM_WEIGHT) {
+        ret = restore_gemm_weight_on_host(dst, src, true, dst_transposed);
+    } else if (src->data_layout_type == PimDataLayoutType::ALIGNED_GEMM_WEIGHT) {
+        ret = restore_gemm_weight_on_host(dst, src, false, dst_transposed);
     } else {
-        iter_cnt = src->bshape.n * src->bshape.c * src->bshape.h / PIM_GEMV_OUT_ALIGN;
-        in_cnt = src->bshape.w * type_size / trans_size;
+        DLOG(ERROR) << "source is not in a gemm weight layout";
+        ret = -1;
+    }
+    if (ret != 0) {
+        printf("fail to restore data layout for gemm\n");
+        return ret;
     }
+    dst->data_layout_type = PimDataLayoutType::RAW;
 
-    for (int iter = 0; iter < iter_cnt; iter++) {
-        cidx = 0;
-        rank = 0;
-        bg = 0;
-        bank = 0;
-        col = 0;
-        row = 0;
-        addr = 0;
-        even_s_row = 0;
-        even_s_col = 0;
-        odd_s_row = 0;
-        odd_s_col = 0;
-        dst_data = (char*)dst->data + data_offset;
-        src_data = (char*)src->data + data_offset;
-
-        for (int x = 0; x < in_cnt; x += in_tile_size) {
-            if ((x / in_tile_size) % 2 == 0) {
-                for (int tiled_y = 0; tiled_y < out_tile_size; tiled_y += num_grf_B) {
-                    col = even_s_col;
-                    row = even_s_row;
-
-                    for (int grfb_idx = 0; grfb_idx < num_grf_B; grfb_idx++) {
-                        for (int grfa_idx = 0; grfa_idx < num_grf_A; grfa_idx++) {
-                            addr = addr_gen_safe(cidx, rank, bg, bank, row, col);
-#ifdef EMULATOR
-                            int d_idx = (tiled_y + grfa_idx) * in_cnt + x + grfb_idx;
-#else
-                            int d_idx = (tiled_y + grfb_idx) * in_cnt + x + grfa_idx;
-#endif
-                            memcpy(dst_data + addr, src_data + d_idx * trans_size, trans_size);
-                            col++;
-                        }
-                    }
-
-                    bank += (num_banks / num_pim_blocks);
-
-                    if (bank >= (num_banks / num_bank_groups)) {
-                        bg++;
-                        bank = 0;
-                    }
-
-                    if (bg >= num_bank_groups) {
-                        bg = 0;
-                        rank++;
-                    }
-
-                    if (rank >= num_pim_rank) {
-                        rank = 0;
-                        cidx++;
-                    }
-
-                    if (cidx >= num_pim_chan) {
-                        cidx = 0;
-                        even_s_row = row;
-                        even_s_col = col;
-                    }
-                }
-            } else if ((x / in_tile_size) % 2 == 1) {
-                for (int tiled_y = 0; tiled_y < out_tile_size; tiled_y += num_grf_B) {
-                    col = odd_s_col;
-                    row = odd_s_row;
-
-                    for (int grfb_idx = 0; grfb_idx < num_grf_B; grfb_idx++) {
-                        for (int grfa_idx = 0; grfa_idx < num_grf_A; grfa_idx++) {
-                            addr = addr_gen_safe(cidx, rank, bg, bank + 1, row, col);
-#ifdef EMULATOR
-                            int d_idx = (tiled_y + grfa_idx) * in_cnt + x + grfb_idx;
-#else
-                            int d_idx = (tiled_y + grfb_idx) * in_cnt + x + grfa_idx;
-#endif
-                            memcpy(dst_data + addr, src_data + d_idx * trans_size, trans_size);
-                            col++;
-                        }
-                    }
-
-                    bank += (num_banks / num_pim_blocks);
-
-                    if (bank >= (num_banks / num_bank_groups)) {
-                        bg++;
-                        bank = 0;
-                    }
-
-                    if (bg >= num_bank_groups) {
-                        bg = 0;
-                        rank++;
-                    }
-
-                    if (rank >= num_pim_rank) {
-                        rank = 0;
-                        cidx++;
-                    }
-
-                    if (cidx >= num_pim_chan) {
-                        cidx = 0;
-                        odd_s_row = row;
-                        odd_s_col = col;
-                    }
-                }
-            }
-        }
-        data_offset += (src->bshape.h * PIM_GEMV_OUT_ALIGN * sizeof(half));
+    DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
+    return ret;
+}
+
+int OclMemoryManager::get_content_hash(PimBo* pim_bo, PimContentHash* hash)
+{
+    DLOG(INFO) << "[START] " << __FUNCTION__ << " called";
+    int ret = 0;
+    size_t size = pim_bo->size;
+    void* src = pim_bo->data;
+
+    if (pim_bo->mem_type == MEM_TYPE_PIM) {
+        src = (void*)((OclBufferObj*)pim_bo->data)->host_addr;
+    }
+
+    /* device buffers are read back, host views are staged only when not word aligned */
+    std::vector<uint64_t> staging;
+    if (pim_bo->mem_type == MEM_TYPE_DEVICE) {
+        staging.resize(pim::runtime::hash::num_words(size));
+        int err = clEnqueueReadBuffer(queue, (cl_mem)pim_bo->data, CL_TRUE, 0, size, staging.data(), 0, NULL, NULL);
+        cl_ok(err);
+        src = staging.data();
+    } else if ((uintptr_t)src % sizeof(uint64_t) != 0) {
+        staging.resize(pim::runtime::hash::num_words(size));
+        memcpy(staging.data(), src, size);
+        src = staging.data();
+    }
+    *hash = pim::runtime::hash::hash_host_memory(src, size);
+
+    DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
+    return ret;
+}
+
+int OclMemoryManager::convert_data_layout_for_chwise_gemm_weight(PimBo* dst, PimBo* src, bool src_transposed)
+{
+    DLOG(INFO) << "[START] " << __FUNCTION__ << " called";
+    int ret = 0;
+
+    ret = reorder_gemm_weight_on_host(dst, src, true, src_transposed);
+    if (ret != 0) {
+        DLOG(INFO) << "[END] " << __FUNCTION__ << " Failed to reorder";
+        return ret;
     }
     dst->data_layout_type = PimDataLayoutType::CHWISE_GEMM_WEIGHT;
 
@@ -525,177 +446,120 @@ int OclMemoryManager::convert_data_layout_for_chwise_gemm_weight(PimBo* dst, Pim
     return ret;
 }
 
-int OclMemoryManager::convert_data_layout_for_aligned_gemm_weight(PimBo* dst, PimBo* src)
+int OclMemoryManager::convert_data_layout_for_aligned_gemm_weight(PimBo* dst, PimBo* src, bool src_transposed)
 {
     DLOG(INFO) << "[START] " << __FUNCTION__ << " called";
     int ret = 0;
-    int num_grf_A = pbi_->num_grf;
-    int num_grf_B = pbi_->num_grf;
-    int num_pim_blocks = pbi_->num_pim_blocks;
-    int num_pim_chan = pbi_->num_pim_chan;
-    int num_pim_rank = pbi_->num_pim_rank;
-    int num_banks = pbi_->num_banks;
-    int num_bank_groups = pbi_->num_bank_groups;
-    int trans_size = pbi_->trans_size;
-
-    int in_tile_size = num_grf_A;
-    int out_tile_size = num_grf_B * num_pim_blocks * num_pim_chan * num_pim_rank;
-    char* dst_data = nullptr;
-    char* src_data = nullptr;
-    char* src_temp = nullptr;
-    int data_offset = 0;
-    int iter_cnt = src->bshape.n * src->bshape.c;
-
-    int cidx = 0;
-    int rank = 0;
-    int bg = 0;
-    int bank = 0;
-    uint32_t col = 0;
-    uint32_t row = 0;
-    uint64_t addr = 0;
-    uint32_t even_s_row = 0;  // starting_row;
-    uint32_t even_s_col = 0;  // starting_col;
-    uint32_t odd_s_row = 0;   // starting_row;
-    uint32_t odd_s_col = 0;   // starting_col;
-
-    int src_size = src->size;
-    int type_size = (src->precision == PIM_FP16) ? 2 : 1;
-
-    int out_cnt = 0;
-    int in_cnt = 0;
-
-    if (gemm_order_ == I_X_W) {
-        out_cnt = src->bshape.w;
-        in_cnt = src->bshape.h * type_size / trans_size;
-    } else {
-        out_cnt = src->bshape.h;
-        in_cnt = src->bshape.w * type_size / trans_size;
+
+    ret = reorder_gemm_weight_on_host(dst, src, false, src_transposed);
+    if (ret != 0) {
+        DLOG(INFO) << "[END] " << __FUNCTION__ << " Failed to reorder";
+        return ret;
     }
+    dst->data_layout_type = PimDataLayoutType::ALIGNED_GEMM_WEIGHT;
 
-    if (src->bshape.w != src->bshape_r.w || src->bshape.h != src->bshape_r.h) {
-        src_temp = (char*)calloc(src_size, sizeof(half));
-        int copy_success;
-        for (int i = 0; i < src->bshape_r.w; i++) {
-            copy_success = copy_memory((half*)src_temp + i * src->bshape.h, (half*)src_data + i * src->bshape_r.h,
-                                       src->bshape_r.h * sizeof(half), DEVICE_TO_HOST);
-            if (copy_success != 0) {
-                DLOG(INFO) << "[END] " << __FUNCTION__ << " Failed to copy";
-                return -1;
-            }
-        }
-        copy_success = copy_memory(src_data, src_temp, src_size, HOST_TO_DEVICE);
-        if (copy_success != 0) {
-            DLOG(INFO) << "[END] " << __FUNCTION__ << " Failed to copy";
-            return -1;
+    DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
+    return ret;
+}
+
+int OclMemoryManager::reorder_gemm_weight_on_host(PimBo* dst, PimBo* src, bool is_chwise, bool src_transposed)
+{
+    DLOG(INFO) << "[START] " << __FUNCTION__ << " called";
+    int ret = 0;
+    bool padded = src->bshape.w != src->bshape_r.w || src->bshape.h != src->bshape_r.h;
+    void* src_host = src->data;
+    void* dst_host = dst->data;
+    std::vector<char> src_stage;
+    std::vector<char> pad_stage;
+    std::vector<char> dst_stage;
+
+    /* PIM buffers are host mapped, device buffers are staged with one bulk copy each way */
+    if (src->mem_type == MEM_TYPE_PIM) {
+        src_host = (void*)((OclBufferObj*)src->data)->host_addr;
+    } else if (src->mem_type == MEM_TYPE_DEVICE) {
+        src_stage.resize(src->size);
+        ret = copy_memory(src_stage.data(), src->data, src->size, DEVICE_TO_HOST);
+        src_host = src_stage.data();
+    }
+    if (ret == 0 && !is_chwise && padded && src_transposed) {
+        DLOG(ERROR) << "padded gemm weight can not be reordered from the transposed source";
+        ret = -1;
+    } else if (ret == 0 && !is_chwise && padded) {
+        pad_stage.resize(src->size);
+        PimGemmWeightReorder::pad_aligned_source(pad_stage.data(), src_host, src);
+        src_host = pad_stage.data();
+    }
+    if (dst->mem_type == MEM_TYPE_PIM) {
+        dst_host = (void*)((OclBufferObj*)dst->data)->host_addr;
+    } else if (ret == 0 && dst->mem_type == MEM_TYPE_DEVICE) {
+        /* keep bytes which the layout does not cover */
+        dst_stage.resize(dst->size);
+        ret = copy_memory(dst_stage.data(), dst->data, dst->size, DEVICE_TO_HOST);
+        dst_host = dst_stage.data();
+    }
+
+    if (ret == 0) {
+        if (is_chwise) {
+            ret = weight_reorder_->reorder_chwise(dst_host, dst->size, src_host, src, gemm_order_, src_transposed);
+        } else {
+            ret = weight_reorder_->reorder_aligned(dst_host, dst->size, src_host, src, gemm_order_, src_transposed);
         }
-        free(src_temp);
+    }
+    if (ret == 0 && !dst_stage.empty()) {
+        ret = copy_memory(dst->data, dst_stage.data(), dst->size, HOST_TO_DEVICE);
     }
 
-    for (int iter = 0; iter < iter_cnt; iter++) {
-        cidx = 0;
-        rank = 0;
-        bg = 0;
-        bank = 0;
-        col = 0;
-        row = 0;
-        addr = 0;
-        even_s_row = 0;
-        even_s_col = 0;
-        odd_s_row = 0;
-        odd_s_col = 0;
-        dst_data = (char*)dst->data + data_offset;
-        src_data = (char*)src->data + data_offset;
-
-        for (int y = 0; y < out_cnt; y += out_tile_size) {
-            for (int x = 0; x < in_cnt; x += in_tile_size) {
-                if ((x / in_tile_size) % 2 == 0) {
-                    for (int tiled_y = 0; tiled_y < out_tile_size; tiled_y += num_grf_B) {
-                        col = even_s_col;
-                        row = even_s_row;
-
-                        for (int grfb_idx = 0; grfb_idx < num_grf_B; grfb_idx++) {
-                            for (int grfa_idx = 0; grfa_idx < num_grf_A; grfa_idx++) {
-                                addr = addr_gen_safe(cidx, rank, bg, bank, row, col);
-#ifdef EMULATOR
-                                int d_idx = (y + tiled_y + grfa_idx) * in_cnt + x + grfb_idx;
-#else
-                                int d_idx = (y + tiled_y + grfb_idx) * in_cnt + x + grfa_idx;
-#endif
-                                memcpy(dst_data + addr, src_data + d_idx * trans_size, trans_size);
-                                col++;
-                            }
-                        }
-
-                        bank += (num_banks / num_pim_blocks);
-
-                        if (bank >= (num_banks / num_bank_groups)) {
-                            bg++;
-                            bank = 0;
-                        }
-
-                        if (bg >= num_bank_groups) {
-                            bg = 0;
-                            rank++;
-                        }
-
-                        if (rank >= num_pim_rank) {
-                            rank = 0;
-                            cidx++;
-                        }
-
-                        if (cidx >= num_pim_chan) {
-                            cidx = 0;
-                            even_s_row = row;
-                            even_s_col = col;
-                        }
-                    }
-                } else if ((x / in_tile_size) % 2 == 1) {
-                    for (int tiled_y = 0; tiled_y < out_tile_size; tiled_y += num_grf_B) {
-                        col = odd_s_col;
-                        row = odd_s_row;
-
-                        for (int grfb_idx = 0; grfb_idx < num_grf_B; grfb_idx++) {
-                            for (int grfa_idx = 0; grfa_idx < num_grf_A; grfa_idx++) {
-                                addr = addr_gen_safe(cidx, rank, bg, bank + 1, row, col);
-#ifdef EMULATOR
-                                int d_idx = (y + tiled_y + grfa_idx) * in_cnt + x + grfb_idx;
-#else
-                                int d_idx = (y + tiled_y + grfb_idx) * in_cnt + x + grfa_idx;
-#endif
-                                memcpy(dst_data + addr, src_data + d_idx * trans_size, trans_size);
-                                col++;
-                            }
-                        }
-
-                        bank += (num_banks / num_pim_blocks);
-
-                        if (bank >= (num_banks / num_bank_groups)) {
-                            bg++;
-                            bank = 0;
-                        }
-
-                        if (bg >= num_bank_groups) {
-                            bg = 0;
-                            rank++;
-                        }
-
-                        if (rank >= num_pim_rank) {
-                            rank = 0;
-                            cidx++;
-                        }
-
-                        if (cidx >= num_pim_chan) {
-                            cidx = 0;
-                            odd_s_row = row;
-                            odd_s_col = col;
-                        }
-                    }
-                }
-            }
+    DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
+    return ret;
+}
+
+int OclMemoryManager::restore_gemm_weight_on_host(PimBo* dst, PimBo* src, bool is_chwise, bool dst_transposed)
+{
+    DLOG(INFO) << "[START] " << __FUNCTION__ << " called";
+    int ret = 0;
+    bool padded = !is_chwise && (dst->bshape.w != dst->bshape_r.w || dst->bshape.h != dst->bshape_r.h);
+    size_t packed_size =
+        (size_t)dst->bshape_r.n * dst->bshape_r.c * dst->bshape_r.h * dst->bshape_r.w * PrecisionSize(dst);
+    void* src_host = src->data;
+    void* dst_host = dst->data;
+    std::vector<char> src_stage;
+    std::vector<char> dst_stage;
+
+    if (padded && dst_transposed) {
+        DLOG(ERROR) << "padded gemm weight can not be restored to the transposed layout";
+        DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
+        return -1;
+    }
+
+    /* PIM buffers are host mapped, device buffers are staged with one bulk copy each way */
+    if (src->mem_type == MEM_TYPE_PIM) {
+        src_host = (void*)((OclBufferObj*)src->data)->host_addr;
+    } else if (src->mem_type == MEM_TYPE_DEVICE) {
+        src_stage.resize(src->size);
+        ret = copy_memory(src_stage.data(), src->data, src->size, DEVICE_TO_HOST);
+        src_host = src_stage.data();
+    }
+    if (dst->mem_type == MEM_TYPE_PIM) {
+        dst_host = (void*)((OclBufferObj*)dst->data)->host_addr;
+    } else if (dst->mem_type == MEM_TYPE_DEVICE) {
+        dst_stage.resize(dst->size);
+        dst_host = dst_stage.data();
+    }
+
+    if (ret == 0) {
+        if (is_chwise) {
+            ret = weight_reorder_->restore_chwise(dst_host, dst, src_host, src->size, gemm_order_, dst_transposed);
+        } else {
+            ret = weight_reorder_->restore_aligned(dst_host, dst, src_host, src->size, gemm_order_, dst_transposed);
         }
-        data_offset += (src->bshape.h * src->bshape.w * sizeof(half));
     }
-    dst->data_layout_type = PimDataLayoutType::ALIGNED_GEMM_WEIGHT;
+    /* the padded layout is restored in place and its rows are packed to bshape_r afterwards */
+    if (ret == 0 && padded) {
+        PimGemmWeightReorder::unpad_aligned_source(dst_host, dst_host, dst);
+    }
+    if (ret == 0 && !dst_stage.empty()) {
+        ret = copy_memory(dst->data, dst_stage.data(), padded ? packed_size : dst->size, HOST_TO_DEVICE);
+    }
 
     DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
     return ret;
@@ -10,6 +10,7 @@
  */
 
 #include "pim_runtime_api.h"
+#include <cstdlib>
 #include <iostream>
 #include "PimRuntime.h"
 #include "executor/PimCompilerDriver.h"
@@ -17,7 +18,7 @@
 #include "hip/hip_runtime.h"
 #include "utility/pim_debug.hpp"
 #include "utility/pim_log.h"
-#include "utility/pim_profile.h"
+#include "utility/pim_trace.h"
 #include "utility/pim_util.h"
 
 using namespace pim::runtime;
@@ -44,11 +45,11 @@ int PimInitialize(PimRuntimeType rt_type, PimPrecision precision)
 
     if (!pim_initialized) {
         DLOG(INFO) << "[START] " << __FUNCTION__ << " called";
-        PIM_PROFILE_TICK(Initialize);
+        trace::configure_from_env();
+        trace::TraceScope trace_scope("Initialize");
         pim_runtime = std::make_unique<PimRuntime>(rt_type, precision);
         ret = pim_runtime->initialize();
         pim_initialized = true;
-        PIM_PROFILE_TOCK(Initialize);
         DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
     } else {
         DLOG(INFO) << "PIM Already initialized " << __FUNCTION__ << " called";
@@ -63,11 +64,15 @@ int PimDeinitialize(void)
 
     if (pim_initialized) {
         DLOG(INFO) << "[START] " << __FUNCTION__ << " called";
-        PIM_PROFILE_TICK(Deinitialize);
-        ret = pim_runtime->deinitialize();
-        pim_runtime.reset();
-        pim_initialized = false;
-        PIM_PROFILE_TOCK(Deinitialize);
+        {
+            trace::TraceScope trace_scope("Deinitialize");
+            ret = pim_runtime->deinitialize();
+            pim_runtime.reset();
+            pim_initialized = false;
+        }
+        if (const char* env_f = std::getenv("PIM_TRACE_FILE")) {
+            if (trace::dump(env_f) != 0) DLOG(ERROR) << "fail to write trace to " << env_f;
+        }
         DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
     } else {
         DLOG(INFO) << "PIM has been already deinitialized " << __FUNCTION__ << " called";
@@ -79,7 +84,7 @@ int PimDeinitialize(void)
 int PimSetDevice(uint32_t device_id)
 {
     DLOG(INFO) << "[START] " << __FUNCTION__ << " called";
-    PIM_PROFILE_TICK(PimSetDevice);
+    trace::TraceScope trace_scope("PimSetDevice");
     int ret = 0;
 
     if (pim_runtime == nullptr) {
@@ -94,7 +99,6 @@ int PimSetDevice(uint32_t device_id)
         return ret;
     }
 
-    PIM_PROFILE_TOCK(PimSetDevice);
     DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
     return ret;
 }
@@ -102,7 +106,7 @@ int PimSetDevice(uint32_t device_id)
 int PimGetDevice(uint32_t* device_id)
 {
     DLOG(INFO) << "[START] " << __FUNCTION__ << " called";
-    PIM_PROFILE_TICK(PimGetDevice);
+    trace::TraceScope trace_scope("PimGetDevice");
     int ret = 0;
 
     if (pim_runtime == nullptr) {
@@ -117,7 +121,6 @@ int PimGetDevice(uint32_t* device_id)
         return ret;
     }
 
-    PIM_PROFILE_TOCK(PimGetDevice);
     DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
     return ret;
 }
@@ -126,7 +129,7 @@ PimBo* PimCreateBo(int n, int c, int h, int w, PimPrecision precision, PimMemTyp
                    bool transposed)
 {
     DLOG(INFO) << "[START] " << __FUNCTION__ << " called";
-    PIM_PROFILE_TICK(CreateBo);
+    trace::TraceScope trace_scope("CreateBo");
     int ret = 0;
 
     if (pim_runtime == nullptr) {
@@ -153,7 +156,7 @@ PimBo* PimCreateBo(int n, int c, int h, int w, PimPrecision precision, PimMemTyp
         DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
         return nullptr;
     }
-    PIM_PROFILE_TOCK(CreateBo);
+    trace_scope.add_bo(pim_bo);
 
     DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
     return pim_bo;
@@ -162,7 +165,7 @@ PimBo* PimCreateBo(int n, int c, int h, int w, PimPrecision precision, PimMemTyp
 PimBo* PimCreateBo(PimDesc* pim_desc, PimMemType mem_type, PimMemFlag mem_flag, void* user_ptr, bool transposed)
 {
     DLOG(INFO) << "[START] " << __FUNCTION__ << " called";
-    PIM_PROFILE_TICK(CreateBo);
+    trace::TraceScope trace_scope("CreateBo");
 
     int ret = 0;
 
@@ -188,8 +191,7 @@ PimBo* PimCreateBo(PimDesc* pim_desc, PimMemType mem_type, PimMemFlag mem_flag,
         LOG(INFO) << "[END] " << __FUNCTION__ << " called";
         return nullptr;
     }
-
-    PIM_PROFILE_TOCK(CreateBo);
+    trace_scope.add_bo(pim_bo);
 
     DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
     return pim_bo;
@@ -199,7 +201,7 @@ PimBo* PimCreateBo(PimGemmDesc* pim_gemm_desc, PimMemType mem_type, PimMemFlag m
                    bool transposed)
 {
     DLOG(INFO) << "[START] " << __FUNCTION__ << " called";
-    PIM_PROFILE_TICK(CreateBo);
+    trace::TraceScope trace_scope("CreateBo");
 
     int ret = 0;
 
@@ -219,8 +221,7 @@ PimBo* PimCreateBo(PimGemmDesc* pim_gemm_desc, PimMemType mem_type, PimMemFlag m
         LOG(INFO) << "[END] " << __FUNCTION__ << " called";
         return nullptr;
     }
-
-    PIM_PROFILE_TOCK(CreateBo);
+    trace_scope.add_bo(pim_bo);
 
     DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
     return pim_bo;
@@ -272,7 +273,7 @@ int PimDestroyGemmDesc(PimGemmDesc* pim_gemm_desc)
 PimDesc* PimCreateDesc(int n, int c, int h, int w, PimPrecision precision, PimOpType op_type)
 {
     DLOG(INFO) << "called";
-    PIM_PROFILE_TICK(CreateDesc);
+    trace::TraceScope trace_scope("CreateDesc");
 
     if (pim_runtime == nullptr) {
         DLOG(ERROR) << "PimRuntime is not initialized";
@@ -287,15 +288,14 @@ PimDesc* PimCreateDesc(int n, int c, int h, int w, PimPrecision precision, PimOp
 
     align_shape(pim_desc, op_type);
 
-    PIM_PROFILE_TOCK(CreateDesc);
-
     return pim_desc;
 }
 
 int PimDestroyBo(PimBo* pim_bo)
 {
     DLOG(INFO) << "[START] " << __FUNCTION__ << " called";
-    PIM_PROFILE_TICK(DestroyBo);
+    trace::TraceScope trace_scope("DestroyBo");
+    trace_scope.add_bo(pim_bo);
     int ret = 0;
 
     if (pim_runtime == nullptr) {
@@ -312,7 +312,6 @@ int PimDestroyBo(PimBo* pim_bo)
     }
 
     delete pim_bo;
-    PIM_PROFILE_TOCK(DestroyBo);
 
     DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
     return ret;
@@ -321,7 +320,7 @@ int PimDestroyBo(PimBo* pim_bo)
 int PimDestroyDesc(PimDesc* pim_desc)
 {
     DLOG(INFO) << "called";
-    PIM_PROFILE_TICK(DestroyDesc);
+    trace::TraceScope trace_scope("DestroyDesc");
     int ret = 0;
 
     if (pim_runtime == nullptr) {
@@ -329,7 +328,6 @@ int PimDestroyDesc(PimDesc* pim_desc)
         return -1;
     }
     delete pim_desc;
-    PIM_PROFILE_TOCK(DestroyDesc);
 
     return ret;
 }
@@ -337,7 +335,8 @@ int PimDestroyDesc(PimDesc* pim_desc)
 int PimAllocMemory(void** ptr, size_t size, PimMemType mem_type)
 {
     DLOG(INFO) << "[START] " << __FUNCTION__ << " called";
-    PIM_PROFILE_TICK(AllocMemory);
+    trace::TraceScope trace_scope("AllocMemory");
+    trace_scope.add_bytes(size);
     int ret = 0;
 
     if (pim_runtime == nullptr) {
@@ -345,7 +344,6 @@ int PimAllocMemory(void** ptr, size_t size, PimMemType mem_type)
         return -1;
     }
     ret = pim_runtime->alloc_memory(ptr, size, mem_type);
-    PIM_PROFILE_TOCK(AllocMemory);
 
     if (ptr == nullptr) {
         DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
@@ -359,7 +357,8 @@ int PimAllocMemory(void** ptr, size_t size, PimMemType mem_type)
 int PimAllocMemory(PimBo* pim_bo)
 {
     DLOG(INFO) << "[START] " << __FUNCTION__ << " called";
-    PIM_PROFILE_TICK(AllocMemory);
+    trace::TraceScope trace_scope("AllocMemory");
+    trace_scope.add_bo(pim_bo);
     int ret = 0;
 
     if (pim_runtime == nullptr) {
@@ -367,7 +366,6 @@ int PimAllocMemory(PimBo* pim_bo)
         return -1;
     }
     ret = pim_runtime->alloc_memory(pim_bo);
-    PIM_PROFILE_TOCK(AllocMemory);
 
     if (pim_bo->data == nullptr) {
         DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
@@ -380,14 +378,13 @@ int PimAllocMemory(PimBo* pim_bo)
 int PimFreeMemory(void* ptr, PimMemType mem_type)
 {
     DLOG(INFO) << "[START] " << __FUNCTION__ << " called";
-    PIM_PROFILE_TICK(FreeMemory);
+    trace::TraceScope trace_scope("FreeMemory");
     int ret = 0;
 
     if (pim_runtime == nullptr) {
         return -1;
     }
     ret = pim_runtime->free_memory(ptr, mem_type);
-    PIM_PROFILE_TOCK(FreeMemory);
 
     return ret;
 }
@@ -395,7 +392,8 @@ int PimFreeMemory(void* ptr, PimMemType mem_type)
 int PimFreeMemory(PimBo* pim_bo)
 {
     DLOG(INFO) << "[START] " << __FUNCTION__ << " called";
-    PIM_PROFILE_TICK(FreeMemory);
+    trace::TraceScope trace_scope("FreeMemory");
+    trace_scope.add_bo(pim_bo);
     int ret = 0;
 
     if (pim_runtime == nullptr) {
@@ -403,7 +401,6 @@ int PimFreeMemory(PimBo* pim_bo)
         return -1;
     }
     ret = pim_runtime->free_memory(pim_bo);
-    PIM_PROFILE_TOCK(FreeMemory);
 
     DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
     return ret;
@@ -412,7 +409,8 @@ int PimFreeMemory(PimBo* pim_bo)
 int PimCopyMemory(void* dst, void* src, size_t size, PimMemCpyType cpy_type)
 {
     DLOG(INFO) << "[START] " << __FUNCTION__ << " called";
-    PIM_PROFILE_TICK(CopyMemory);
+    trace::TraceScope trace_scope("CopyMemory");
+    trace_scope.add_bytes(size);
     int ret = 0;
 
     if (pim_runtime == nullptr) {
@@ -420,7 +418,6 @@ int PimCopyMemory(void* dst, void* src, size_t size, PimMemCpyType cpy_type)
         return -1;
     }
     ret = pim_runtime->copy_memory(dst, src, size, cpy_type);
-    PIM_PROFILE_TOCK(CopyMemory);
 
     DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
     return ret;
@@ -429,7 +426,8 @@ int PimCopyMemory(void* dst, void* src, size_t size, PimMemCpyType cpy_type)
 int PimCopyMemory(PimBo* dst, PimBo* src, PimMemCpyType cpy_type)
 {
     DLOG(INFO) << "[START] " << __FUNCTION__ << " called";
-    PIM_PROFILE_TICK(CopyMemory);
+    trace::TraceScope trace_scope("CopyMemory");
+    trace_scope.add_bo(dst);
     int ret = 0;
 
     if (pim_runtime == nullptr) {
@@ -437,7 +435,6 @@ int PimCopyMemory(PimBo* dst, PimBo* src, PimMemCpyType cpy_type)
         return -1;
     }
     ret = pim_runtime->copy_memory(dst, src, cpy_type);
-    PIM_PROFILE_TOCK(CopyMemory);
 
     DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
     return ret;
@@ -446,7 +443,8 @@ int PimCopyMemory(PimBo* dst, PimBo* src, PimMemCpyType cpy_type)
 int PimCopyMemoryRect(const PimCopy3D* copy_params)
 {
     DLOG(INFO) << "[START] " << __FUNCTION__ << " called";
-    PIM_PROFILE_TICK(CopyMemoryRect);
+    trace::TraceScope trace_scope("CopyMemoryRect");
+    trace_scope.add_bytes(copy_params->width_in_bytes * copy_params->height * copy_params->depth);
     int ret = 0;
 
     if (pim_runtime == nullptr) {
@@ -454,7 +452,6 @@ int PimCopyMemoryRect(const PimCopy3D* copy_params)
         return -1;
     }
     ret = pim_runtime->copy_memory_3d(copy_params);
-    PIM_PROFILE_TOCK(CopyMemoryRect);
 
     DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
     return ret;
@@ -480,14 +477,17 @@ void* createStream(PimRuntimeType rt_type)
 int PimExecuteAdd(PimBo* output, PimBo* operand0, PimBo* operand1, void* stream, bool block)
 {
     DLOG(INFO) << "called";
-    PIM_PROFILE_TICK(ExecuteAdd);
+    trace::TraceScope trace_scope("ExecuteAdd");
+    trace_scope.add_bo(output);
+    trace_scope.add_bo(operand0);
+    trace_scope.add_bo(operand1);
+    trace_scope.set_stream(stream);
     int ret = 0;
 
     if (pim_runtime == nullptr) {
         return -1;
     }
     ret = pim_runtime->execute_add(output, operand0, operand1, stream, block);
-    PIM_PROFILE_TOCK(ExecuteAdd);
 
     return ret;
 }
@@ -495,39 +495,38 @@ int PimExecuteAdd(PimBo* output, PimBo* operand0, PimBo* operand1, void* stream,
 int PimExecuteAdd(PimBo* output, void* scalar, PimBo* vector, void* stream, bool block)
 {
     DLOG(INFO) << "called";
-    PIM_PROFILE_TICK(ExecuteAdd);
+    trace::TraceScope trace_scope("ExecuteAdd");
+    trace_scope.add_bo(output);
+    trace_scope.add_bo(vector);
+    trace_scope.set_stream(stream);
     int ret = 0;
 
     if (pim_runtime == nullptr) {
         return -1;
     }
 
-    int num_vector = vector->size / sizeof(uint16_t);
-    PimBo* padded_scalar = PimCreateBo(1, 1, 1, num_vector, PIM_FP16, MEM_TYPE_PIM);
-    for (int i = 0; i < num_vector; i++) {
-        pim_runtime->copy_memory((void*)((char*)padded_scalar->data + i * sizeof(uint16_t)), scalar, sizeof(uint16_t),
-                                 HOST_TO_PIM);
+    if (scalar == nullptr) {
+        return -1;
     }
+    ret = pim_runtime->execute_add_scalar(output, *(uint16_t*)scalar, vector, stream, block);
 
-    ret = pim_runtime->execute_add(output, vector, padded_scalar, stream, block);
-    PIM_PROFILE_TOCK(ExecuteAdd);
-
-    PimDestroyBo(padded_scalar);
-    std::cout << "PimDestryBo called in " << __FUNCTION__ << std::endl;
     return ret;
 }
 
 int PimExecuteMul(PimBo* output, PimBo* operand0, PimBo* operand1, void* stream, bool block)
 {
     DLOG(INFO) << "called";
-    PIM_PROFILE_TICK(ExecuteMul);
+    trace::TraceScope trace_scope("ExecuteMul");
+    trace_scope.add_bo(output);
+    trace_scope.add_bo(operand0);
+    trace_scope.add_bo(operand1);
+    trace_scope.set_stream(stream);
     int ret = 0;
 
     if (pim_runtime == nullptr) {
         return -1;
     }
     ret = pim_runtime->execute_mul(output, operand0, operand1, stream, block);
-    PIM_PROFILE_TOCK(ExecuteMul);
 
     return ret;
 }
@@ -535,25 +534,21 @@ int PimExecuteMul(PimBo* output, PimBo* operand0, PimBo* operand1, void* stream,
 int PimExecuteMul(PimBo* output, void* scalar, PimBo* vector, void* stream, bool block)
 {
     DLOG(INFO) << "called";
-    PIM_PROFILE_TICK(ExecuteMul);
+    trace::TraceScope trace_scope("ExecuteMul");
+    trace_scope.add_bo(output);
+    trace_scope.add_bo(vector);
+    trace_scope.set_stream(stream);
     int ret = 0;
 
     if (pim_runtime == nullptr) {
         return -1;
     }
 
-    int num_vector = vector->size / sizeof(uint16_t);
-    PimBo* padded_scalar = PimCreateBo(1, 1, 1, num_vector, PIM_FP16, MEM_TYPE_PIM);
-    for (int i = 0; i < num_vector; i++) {
-        pim_runtime->copy_memory((void*)((char*)padded_scalar->data + i * sizeof(uint16_t)), scalar, sizeof(uint16_t),
-                                 HOST_TO_PIM);
+    if (scalar == nullptr) {
+        return -1;
     }
+    ret = pim_runtime->execute_mul_scalar(output, *(uint16_t*)scalar, vector, stream, block);
 
-    ret = pim_runtime->execute_mul(output, vector, padded_scalar, stream, block);
-    PIM_PROFILE_TOCK(ExecuteMul);
-
-    PimDestroyBo(padded_scalar);
-    std::cout << "PimDestryBo called in " << __FUNCTION__ << std::endl;
     return ret;
 }
 
@@ -568,7 +563,12 @@ int PimExecuteGemm(PimBo* output, PimBo* input, PimBo* weight, PimBo* bias, PimA
     print_pimbo(output, "output");
 #endif
     DLOG(INFO) << "[START] " << __FUNCTION__ << " called";
-    PIM_PROFILE_TICK(ExecuteGemm);
+    trace::TraceScope trace_scope("ExecuteGemm");
+    trace_scope.add_bo(output);
+    trace_scope.add_bo(input);
+    trace_scope.add_bo(weight);
+    trace_scope.add_bo(bias);
+    trace_scope.set_stream(stream);
     int ret = 0;
 
     if (pim_runtime == nullptr) {
@@ -577,7 +577,6 @@ int PimExecuteGemm(PimBo* output, PimBo* input, PimBo* weight, PimBo* bias, PimA
     }
 
     ret = pim_runtime->execute_gemm(output, input, weight, bias, act_func, gemm_order, stream, block);
-    PIM_PROFILE_TOCK(ExecuteGemm);
 
     DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
     return ret;
@@ -586,7 +585,10 @@ int PimExecuteGemm(PimBo* output, PimBo* input, PimBo* weight, PimBo* bias, PimA
 int PimExecuteRelu(PimBo* output, PimBo* pim_data, void* stream, bool block)
 {
     DLOG(INFO) << "[START] " << __FUNCTION__ << " called";
-    PIM_PROFILE_TICK(ExecuteRelu);
+    trace::TraceScope trace_scope("ExecuteRelu");
+    trace_scope.add_bo(output);
+    trace_scope.add_bo(pim_data);
+    trace_scope.set_stream(stream);
     int ret = 0;
 
     if (pim_runtime == nullptr) {
@@ -594,16 +596,38 @@ int PimExecuteRelu(PimBo* output, PimBo* pim_data, void* stream, bool block)
         return -1;
     }
     ret = pim_runtime->execute_relu(output, pim_data, stream, block);
-    PIM_PROFILE_TOCK(ExecuteRelu);
 
     return ret;
 }
 
+int PimExecuteEltChain(PimBo* output, PimBo* input, const PimEltChainStep* steps, int num_steps, void* stream,
+                       bool block)
+{
+    DLOG(INFO) << "[START] " << __FUNCTION__ << " called";
+    trace::TraceScope trace_scope("ExecuteEltChain");
+    trace_scope.add_bo(output);
+    trace_scope.add_bo(input);
+    trace_scope.set_stream(stream);
+    int ret = 0;
+
+    if (pim_runtime == nullptr) {
+        DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
+        return -1;
+    }
+    ret = pim_runtime->execute_elt_chain(output, input, steps, num_steps, stream, block);
+
+    DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
+    return ret;
+}
+
 int PimExecuteBN(PimBo* output, PimBo* pim_data, PimBo* beta, PimBo* gamma, PimBo* mean, PimBo* variance,
                  double epsilon, void* stream, bool block)
 {
     DLOG(INFO) << "[START] " << __FUNCTION__ << " called";
-    PIM_PROFILE_TICK(ExecuteBN);
+    trace::TraceScope trace_scope("ExecuteBN");
+    trace_scope.add_bo(output);
+    trace_scope.add_bo(pim_data);
+    trace_scope.set_stream(stream);
     int ret = 0;
 
     if (pim_runtime == nullptr) {
@@ -611,7 +635,6 @@ int PimExecuteBN(PimBo* output, PimBo* pim_data, PimBo* beta, PimBo* gamma, PimB
         return -1;
     }
     ret = pim_runtime->execute_bn(output, pim_data, beta, gamma, mean, variance, epsilon, stream, block);
-    PIM_PROFILE_TOCK(ExecuteBN);
 
     DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
     return ret;
@@ -620,7 +643,8 @@ int PimExecuteBN(PimBo* output, PimBo* pim_data, PimBo* beta, PimBo* gamma, PimB
 int PimSynchronize(void* stream)
 {
     DLOG(INFO) << "[START] " << __FUNCTION__ << " called";
-    PIM_PROFILE_TICK(ExecuteSynchronize);
+    trace::TraceScope trace_scope("ExecuteSynchronize");
+    trace_scope.set_stream(stream);
     int ret = 0;
 
     if (pim_runtime == nullptr) {
@@ -628,7 +652,22 @@ int PimSynchronize(void* stream)
         return -1;
     }
     ret = pim_runtime->execute_sync(stream);
-    PIM_PROFILE_TOCK(ExecuteSynchronize);
+
+    DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
+    return ret;
+}
+
+int PimLoadCrfProgram(PimOpType op_type, const char* file_path)
+{
+    DLOG(INFO) << "[START] " << __FUNCTION__ << " called";
+    trace::TraceScope trace_scope("LoadCrfProgram");
+    int ret = 0;
+
+    if (pim_runtime == nullptr) {
+        DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
+        return -1;
+    }
+    ret = pim_runtime->load_crf_program(op_type, file_path);
 
     DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
     return ret;
@@ -637,7 +676,7 @@ int PimSynchronize(void* stream)
 int PimExecuteDummy(void)
 {
     DLOG(INFO) << "[START] " << __FUNCTION__ << " called";
-    PIM_PROFILE_TICK(ExecuteDummy);
+    trace::TraceScope trace_scope("ExecuteDummy");
     int ret = 0;
 
     if (pim_runtime == nullptr) {
@@ -645,7 +684,70 @@ int PimExecuteDummy(void)
         return -1;
     }
     ret = pim_runtime->execute_dummy();
-    PIM_PROFILE_TOCK(ExecuteDummy);
+
+    DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
+    return ret;
+}
+
+int PimBeginGraphCapture(void)
+{
+    DLOG(INFO) << "[START] " << __FUNCTION__ << " called";
+    trace::TraceScope trace_scope("BeginGraphCapture");
+    int ret = 0;
+
+    if (pim_runtime == nullptr) {
+        DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
+        return -1;
+    }
+    ret = pim_runtime->begin_graph_capture();
+
+    DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
+    return ret;
+}
+
+int PimEndGraphCapture(PimGraph** graph)
+{
+    DLOG(INFO) << "[START] " << __FUNCTION__ << " called";
+    trace::TraceScope trace_scope("EndGraphCapture");
+    int ret = 0;
+
+    if (pim_runtime == nullptr) {
+        DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
+        return -1;
+    }
+    ret = pim_runtime->end_graph_capture(graph);
+
+    DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
+    return ret;
+}
+
+int PimLaunchGraph(PimGraph* graph, void* stream, bool block)
+{
+    DLOG(INFO) << "[START] " << __FUNCTION__ << " called";
+    trace::TraceScope trace_scope("LaunchGraph");
+    trace_scope.set_stream(stream);
+    int ret = 0;
+
+    if (pim_runtime == nullptr || graph == nullptr) {
+        DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
+        return -1;
+    }
+    ret = pim_runtime->launch_graph(graph, stream, block);
+
+    DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
+    return ret;
+}
+
+int PimDestroyGraph(PimGraph* graph)
+{
+    DLOG(INFO) << "[START] " << __FUNCTION__ << " called";
+    int ret = 0;
+
+    if (pim_runtime == nullptr || graph == nullptr) {
+        DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
+        return -1;
+    }
+    ret = pim_runtime->destroy_graph(graph);
 
     DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
     return ret;
@@ -655,7 +757,9 @@ PimBo* PimConvertGemmWeight(PimBo* src, PimGemmOrder gemm_order, bool reorder_on
                             bool save_for_reuse)
 {
     DLOG(INFO) << "[START] " << __FUNCTION__ << " called";
-    PIM_PROFILE_TICK(PimGetReorderedBuffer);
+    trace::TraceScope trace_scope("PimGetReorderedBuffer");
+    trace_scope.add_bo(src);
+    trace_scope.set_stream(stream);
 
     if (pim_runtime == nullptr) {
         DLOG(ERROR) << "PimRuntime is not initialized";
@@ -669,18 +773,99 @@ PimBo* PimConvertGemmWeight(PimBo* src, PimGemmOrder gemm_order, bool reorder_on
         DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
         return nullptr;
     }
-    PIM_PROFILE_TOCK(PimGetReorderedBuffer);
 
     DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
     return dst;
 }
 
+int PimRestoreGemmWeight(PimBo* dst, PimBo* src, PimGemmOrder gemm_order, bool restore_on_device, void* stream)
+{
+    DLOG(INFO) << "[START] " << __FUNCTION__ << " called";
+    trace::TraceScope trace_scope("PimRestoreGemmWeight");
+    trace_scope.add_bo(dst);
+    trace_scope.add_bo(src);
+    trace_scope.set_stream(stream);
+    int ret = 0;
+
+    if (pim_runtime == nullptr) {
+        DLOG(ERROR) << "PimRuntime is not initialized";
+        DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
+        return -1;
+    }
+    ret = pim_runtime->restore_gemm_weight(dst, src, gemm_order, restore_on_device, stream);
+    if (ret != 0) {
+        DLOG(ERROR) << "Failed to restore source buffer";
+    }
+
+    DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
+    return ret;
+}
+
+int PimSetWeightCacheBudget(size_t budget)
+{
+    DLOG(INFO) << "[START] " << __FUNCTION__ << " called";
+    int ret = 0;
+
+    if (pim_runtime == nullptr) {
+        DLOG(ERROR) << "PimRuntime is not initialized";
+        DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
+        return -1;
+    }
+    ret = pim_runtime->set_weight_cache_budget(budget);
+
+    DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
+    return ret;
+}
+
+int PimGetWeightCacheStats(PimWeightCacheStats* stats)
+{
+    DLOG(INFO) << "[START] " << __FUNCTION__ << " called";
+    int ret = 0;
+
+    if (pim_runtime == nullptr || stats == nullptr) {
+        DLOG(ERROR) << "PimRuntime is not initialized";
+        DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
+        return -1;
+    }
+    ret = pim_runtime->get_weight_cache_stats(stats);
+
+    DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
+    return ret;
+}
+
+int PimTraceEnable(bool enable)
+{
+    DLOG(INFO) << "[START] " << __FUNCTION__ << " called";
+    trace::set_enabled(enable);
+    DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
+    return 0;
+}
+
+int PimTraceClear(void)
+{
+    DLOG(INFO) << "[START] " << __FUNCTION__ << " called";
+    trace::clear();
+    DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
+    return 0;
+}
+
+int PimTraceDump(const char* file_path)
+{
+    DLOG(INFO) << "[START] " << __FUNCTION__ << " called";
+    int ret = trace::dump(file_path);
+    if (ret != 0) {
+        DLOG(ERROR) << "Fail to write trace";
+    }
+    DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
+    return ret;
+}
+
 #if PIM_COMPILER_ENABLE == 1
 PimTarget* PimCreateTarget(PimRuntimeType rt_type = PimRuntimeType::RT_TYPE_HIP,
                            PimPrecision precision = PimPrecision::PIM_FP16, PimDevice device = PimDevice::GPU)
 {
     DLOG(INFO) << "[START] " << __FUNCTION__ << " called";
-    PIM_PROFILE_TICK(CreateTarget);
+    trace::TraceScope trace_scope("CreateTarget");
 
     if (pim_runtime == nullptr) {
         DLOG(ERROR) << "PimRuntime is not initialized";
@@ -692,7 +877,6 @@ PimTarget* PimCreateTarget(PimRuntimeType rt_type = PimRuntimeType::RT_TYPE_HIP,
     target->precision = precision;
     target->device = device;
 
-    PIM_PROFILE_TOCK(CreateTarget);
     DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
     return target;
 }
@@ -700,7 +884,7 @@ PimTarget* PimCreateTarget(PimRuntimeType rt_type = PimRuntimeType::RT_TYPE_HIP,
 int PimDestroyTarget(PimTarget* target)
 {
     DLOG(INFO) << "[START] " << __FUNCTION__ << " called";
-    PIM_PROFILE_TICK(DestroyTarget);
+    trace::TraceScope trace_scope("DestroyTarget");
     int ret = 0;
 
     if (pim_runtime == nullptr) {
@@ -709,7 +893,6 @@ int PimDestroyTarget(PimTarget* target)
     }
     delete target;
 
-    PIM_PROFILE_TOCK(DestroyTarget);
     DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
     return ret;
 }
@@ -718,7 +901,7 @@ PimCompiledObj* PimBuildProgram(pimc::frontend::Var output, std::vector<pimc::fr
                                 std::vector<PimBo*> input_pimbo, PimTarget* target, std::string compile_opts)
 {
     DLOG(INFO) << "[START] " << __FUNCTION__ << " called";
-    PIM_PROFILE_TICK(PimBuildProgram);
+    trace::TraceScope trace_scope("PimBuildProgram");
 
     if (pim_runtime == nullptr) {
         DLOG(ERROR) << "PimRuntime is not initialized";
@@ -731,7 +914,6 @@ PimCompiledObj* PimBuildProgram(pimc::frontend::Var output, std::vector<pimc::fr
         DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
         return nullptr;
     }
-    PIM_PROFILE_TOCK(PimBuildProgram);
 
     DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
     return pim_co;
@@ -740,7 +922,7 @@ PimCompiledObj* PimBuildProgram(pimc::frontend::Var output, std::vector<pimc::fr
 PimBo* PimExecuteProgram(PimCompiledObj* obj, PimTarget* target, std::string launch_opts)
 {
     DLOG(INFO) << "[START] " << __FUNCTION__ << " called";
-    PIM_PROFILE_TICK(PimExecuteProgram);
+    trace::TraceScope trace_scope("PimExecuteProgram");
 
     if (pim_runtime == nullptr) {
         DLOG(ERROR) << "PimRuntime is not initialized";
@@ -753,7 +935,6 @@ PimBo* PimExecuteProgram(PimCompiledObj* obj, PimTarget* target, std::string lau
         DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
         return nullptr;
     }
-    PIM_PROFILE_TOCK(PimExecuteProgram);
 
     DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
     return output_pimbo;
@@ -762,7 +943,7 @@ PimBo* PimExecuteProgram(PimCompiledObj* obj, PimTarget* target, std::string lau
 int PimDestroyProgram(PimCompiledObj* obj)
 {
     DLOG(INFO) << "[START] " << __FUNCTION__ << " called";
-    PIM_PROFILE_TICK(DestroyProgram);
+    trace::TraceScope trace_scope("DestroyProgram");
     int ret = 0;
 
     if (pim_runtime == nullptr) {
@@ -778,7 +959,6 @@ int PimDestroyProgram(PimCompiledObj* obj)
     obj->pimbo_map.clear();
     delete obj;
 
-    PIM_PROFILE_TOCK(DestroyProgram);
     DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
     return ret;
 }
@@ -0,0 +1,372 @@
+/*
+ * Copyright (C) 2022 Samsung Electronics Co. LTD
+ *
+ * This software is a property of Samsung Electronics.
+ * No part of this software, either material or conceptual may be copied or distributed, transmitted,
+ * transcribed, stored in a retrieval system or translated into any human or computer language in any form by any means,
+ * electronic, mechanical, manual or otherwise, or disclosed
+ * to third parties without the express written permission of Samsung Electronics.
+ * (Use of the Software is restricted to non-commercial, personal or academic, research purpose only)
+ */
+
+#include "utility/pim_reference.h"
+#include <math.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+#if (defined(__x86_64__) || defined(__i386__)) && !defined(__HIP_DEVICE_COMPILE__)
+#define PIM_REF_X86_SIMD 1
+#include <immintrin.h>
+#define PIM_REF_AVX2 __attribute__((target("avx2,f16c,popcnt")))
+#endif
+
+/* minimum number of elements handed to one thread by elementwise kernels and compare */
+#define MIN_ELEMS_PER_THREAD (1 << 16)
+/* minimum number of multiply-adds handed to one thread by matmul */
+#define MIN_MACS_PER_THREAD (1 << 18)
+/* output columns sharing one pass over the input row in matmul, four AVX2 vectors */
+#define MATMUL_N_BLOCK 32
+#define TRANSPOSE_TILE 32
+/* pass and warning limits of compare_half_relative */
+#define PASS_ULPS (1 << 4)
+#define WARN_ULPS (1 << 8)
+#define PASS_ABS_TOLERANCE (0.001f)
+
+namespace pim
+{
+namespace runtime
+{
+namespace reference
+{
+namespace
+{
+typedef half_float::half half;
+
+std::atomic<int> g_num_threads(-1);
+
+int get_env_num_threads(void)
+{
+    const char* env = std::getenv("PIM_REF_NUM_THREADS");
+    int num_threads = (env != nullptr) ? atoi(env) : 0;
+    if (num_threads <= 0) num_threads = std::max(1u, std::thread::hardware_concurrency());
+    return num_threads;
+}
+
+bool check_simd(void)
+{
+#ifdef PIM_REF_X86_SIMD
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("f16c") && __builtin_cpu_supports("popcnt");
+#else
+    return false;
+#endif
+}
+
+inline uint16_t bits(half h) { return *((uint16_t*)&h); }
+template <typename Func>
+void parallel_for(size_t count, size_t min_per_thread, Func func)
+{
+    size_t num_threads = std::min((size_t)get_num_threads(), count / std::max(min_per_thread, (size_t)1));
+
+    if (num_threads <= 1) {
+        func(0, 0, count);
+        return;
+    }
+
+    std::vector<std::thread> workers;
+    size_t per_thread = (count + num_threads - 1) / num_threads;
+    for (size_t t = 1; t < num_threads; t++) {
+        size_t begin = t * per_thread;
+        size_t end = std::min(count, begin + per_thread);
+        if (begin >= end) break;
+        workers.emplace_back([&func, t, begin, end]() { func(t, begin, end); });
+    }
+    /* the calling thread takes the first range */
+    func(0, 0, std::min(count, per_thread));
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+/* classification of one element, the same steps as compare_half_Ulps_and_absoulte */
+inline bool within(half a, half b, int max_ulps, float abs_tolerance)
+{
+    uint16_t ai = bits(a);
+    uint16_t bi = bits(b);
+
+    if (fabs((float)a - (float)b) <= abs_tolerance) return true;
+    if ((ai & 0x8000) != (bi & 0x8000)) return false;
+    return abs(ai - bi) <= max_ulps;
+}
+
+typedef struct __CompareState {
+    CompareResult result;
+    std::vector<size_t> fail_idx;
+} CompareState;
+
+inline void compare_one(const half* data_a, const half* data_b, size_t i, float abs_tolerance, CompareState* state)
+{
+    if (within(data_a[i], data_b[i], PASS_ULPS, PASS_ABS_TOLERANCE)) {
+        state->result.pass_cnt++;
+    } else if (within(data_a[i], data_b[i], WARN_ULPS, abs_tolerance)) {
+        state->result.warning_cnt++;
+    } else {
+        float diff = fabsf((float)data_a[i] - (float)data_b[i]);
+        if (diff > state->result.max_diff) state->result.max_diff = diff;
+        state->result.fail_cnt++;
+        state->fail_idx.push_back(i);
+    }
+}
+
+void matmul_block_scalar(half* out, const half* in, const half* weight, int n, int k, int mi, int n_begin,
+                         int n_end, half alpha, half beta)
+{
+    float temp[MATMUL_N_BLOCK] = {0};
+    for (int ki = 0; ki < k; ki++) {
+        half a = in[(size_t)mi * k + ki];
+        const half* w = weight + (size_t)ki * n;
+        for (int ni = n_begin; ni < n_end; ni++) {
+            temp[ni - n_begin] += (a * w[ni]);
+        }
+    }
+    for (int ni = n_begin; ni < n_end; ni++) {
+        size_t out_idx = (size_t)mi * n + ni;
+        out[out_idx] = alpha * temp[ni - n_begin] + beta * out[out_idx];
+    }
+}
+
+#ifdef PIM_REF_X86_SIMD
+PIM_REF_AVX2 inline __m256 load_half8(const half* p) { return _mm256_cvtph_ps(_mm_loadu_si128((const __m128i*)p)); }
+PIM_REF_AVX2 inline void store_half8(half* p, __m256 v)
+{
+    _mm_storeu_si128((__m128i*)p, _mm256_cvtps_ph(v, _MM_FROUND_TO_NEAREST_INT));
+}
+
+PIM_REF_AVX2 void add_avx2(half* out, const half* in0, const half* in1, size_t len, bool is_mul)
+{
+    size_t i = 0;
+    for (; i + 8 <= len; i += 8) {
+        __m256 a = load_half8(in0 + i);
+        __m256 b = load_half8(in1 + i);
+        store_half8(out + i, is_mul ? _mm256_mul_ps(a, b) : _mm256_add_ps(a, b));
+    }
+    for (; i < len; i++) {
+        out[i] = is_mul ? in0[i] * in1[i] : in0[i] + in1[i];
+    }
+}
+
+PIM_REF_AVX2 void relu_avx2(half* data, size_t len)
+{
+    const __m256i abs_mask = _mm256_set1_epi16(0x7fff);
+    const __m256i nan_min = _mm256_set1_epi16(0x7c01);
+    const __m256i zero = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 16 <= len; i += 16) {
+        __m256i v = _mm256_loadu_si256((const __m256i*)(data + i));
+        __m256i mag = _mm256_and_si256(v, abs_mask);
+        /* negative and neither -0 nor nan */
+        __m256i neg = _mm256_cmpgt_epi16(zero, v);
+        neg = _mm256_and_si256(neg, _mm256_cmpgt_epi16(mag, zero));
+        neg = _mm256_and_si256(neg, _mm256_cmpgt_epi16(nan_min, mag));
+        _mm256_storeu_si256((__m256i*)(data + i), _mm256_andnot_si256(neg, v));
+    }
+    for (; i < len; i++) {
+        if (data[i] < 0) data[i] = 0;
+    }
+}
+
+/* products are rounded to half before they are added, as half * half is */
+PIM_REF_AVX2 void matmul_block_avx2(half* out, const half* in, const half* weight, int n, int k, int mi,
+                                    int n_begin, half alpha, half beta)
+{
+    __m256 acc[MATMUL_N_BLOCK / 8];
+    for (int v = 0; v < MATMUL_N_BLOCK / 8; v++) acc[v] = _mm256_setzero_ps();
+
+    for (int ki = 0; ki < k; ki++) {
+        __m256 a = _mm256_set1_ps((float)in[(size_t)mi * k + ki]);
+        const half* w = weight + (size_t)ki * n + n_begin;
+        for (int v = 0; v < MATMUL_N_BLOCK / 8; v++) {
+            __m128i prod = _mm256_cvtps_ph(_mm256_mul_ps(a, load_half8(w + v * 8)), _MM_FROUND_TO_NEAREST_INT);
+            acc[v] = _mm256_add_ps(acc[v], _mm256_cvtph_ps(prod));
+        }
+    }
+
+    float temp[MATMUL_N_BLOCK];
+    for (int v = 0; v < MATMUL_N_BLOCK / 8; v++) _mm256_storeu_ps(temp + v * 8, acc[v]);
+    for (int j = 0; j < MATMUL_N_BLOCK; j++) {
+        size_t out_idx = (size_t)mi * n + n_begin + j;
+        out[out_idx] = alpha * temp[j] + beta * out[out_idx];
+    }
+}
+
+PIM_REF_AVX2 void compare_avx2(const half* data_a, const half* data_b, size_t begin, size_t end,
+                               float abs_tolerance, CompareState* state)
+{
+    const __m256 abs_mask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff));
+    const __m256 pass_tol = _mm256_set1_ps(PASS_ABS_TOLERANCE);
+    const __m256 warn_tol = _mm256_set1_ps(abs_tolerance);
+    const __m128i sign = _mm_set1_epi16((short)0x8000);
+    const __m128i pass_lim = _mm_set1_epi16(PASS_ULPS + 1);
+    const __m128i warn_lim = _mm_set1_epi16(WARN_ULPS + 1);
+    const __m128i zero = _mm_setzero_si128();
+    size_t i = begin;
+
+    for (; i + 8 <= end; i += 8) {
+        __m128i a = _mm_loadu_si128((const __m128i*)(data_a + i));
+        __m128i b = _mm_loadu_si128((const __m128i*)(data_b + i));
+        __m256 diff = _mm256_and_ps(_mm256_sub_ps(_mm256_cvtph_ps(a), _mm256_cvtph_ps(b)), abs_mask);
+        int pass_abs = _mm256_movemask_ps(_mm256_cmp_ps(diff, pass_tol, _CMP_LE_OQ));
+        int warn_abs = _mm256_movemask_ps(_mm256_cmp_ps(diff, warn_tol, _CMP_LE_OQ));
+
+        /* the ulp distance only counts with equal signs, where it fits in 15 bits */
+        __m128i same_sign = _mm_cmpeq_epi16(_mm_and_si128(_mm_xor_si128(a, b), sign), zero);
+        __m128i ulps = _mm_abs_epi16(_mm_sub_epi16(a, b));
+        __m128i pass_ulp = _mm_and_si128(same_sign, _mm_cmpgt_epi16(pass_lim, ulps));
+        __m128i warn_ulp = _mm_and_si128(same_sign, _mm_cmpgt_epi16(warn_lim, ulps));
+        int pass = pass_abs | _mm_movemask_epi8(_mm_packs_epi16(pass_ulp, zero));
+        int warn = (warn_abs | _mm_movemask_epi8(_mm_packs_epi16(warn_ulp, zero))) & ~pass;
+        int fail = ~(pass | warn) & 0xff;
+
+        state->result.pass_cnt += _mm_popcnt_u32(pass);
+        state->result.warning_cnt += _mm_popcnt_u32(warn);
+        for (; fail != 0; fail &= fail - 1) {
+            compare_one(data_a, data_b, i + __builtin_ctz(fail), abs_tolerance, state);
+        }
+    }
+    for (; i < end; i++) {
+        compare_one(data_a, data_b, i, abs_tolerance, state);
+    }
+}
+#endif
+
+const bool g_use_simd = check_simd();
+
+void add_or_mul(half* out, const half* in0, const half* in1, size_t len, bool is_mul)
+{
+    parallel_for(len, MIN_ELEMS_PER_THREAD, [&](size_t tid, size_t begin, size_t end) {
+#ifdef PIM_REF_X86_SIMD
+        if (g_use_simd) {
+            add_avx2(out + begin, in0 + begin, in1 + begin, end - begin, is_mul);
+            return;
+        }
+#endif
+        for (size_t i = begin; i < end; i++) {
+            out[i] = is_mul ? in0[i] * in1[i] : in0[i] + in1[i];
+        }
+    });
+}
+} /* namespace */
+
+void set_num_threads(int num_threads)
+{
+    if (num_threads <= 0) num_threads = std::max(1u, std::thread::hardware_concurrency());
+    g_num_threads.store(num_threads);
+}
+
+int get_num_threads(void)
+{
+    int num_threads = g_num_threads.load();
+    if (num_threads <= 0) {
+        num_threads = get_env_num_threads();
+        g_num_threads.store(num_threads);
+    }
+    return num_threads;
+}
+
+bool is_simd_enabled(void) { return g_use_simd; }
+void add(half* out, const half* in0, const half* in1, size_t len) { add_or_mul(out, in0, in1, len, false); }
+void mul(half* out, const half* in0, const half* in1, size_t len) { add_or_mul(out, in0, in1, len, true); }
+void relu(half* data, size_t len)
+{
+    parallel_for(len, MIN_ELEMS_PER_THREAD, [&](size_t tid, size_t begin, size_t end) {
+#ifdef PIM_REF_X86_SIMD
+        if (g_use_simd) {
+            relu_avx2(data + begin, end - begin);
+            return;
+        }
+#endif
+        for (size_t i = begin; i < end; i++) {
+            if (data[i] < 0) data[i] = 0;
+        }
+    });
+}
+
+void transpose(half* out, const half* in, int row, int col)
+{
+    size_t row_tiles = (row + TRANSPOSE_TILE - 1) / TRANSPOSE_TILE;
+    size_t col_tiles = (col + TRANSPOSE_TILE - 1) / TRANSPOSE_TILE;
+    size_t min_tiles = MIN_ELEMS_PER_THREAD / (TRANSPOSE_TILE * TRANSPOSE_TILE);
+
+    parallel_for(row_tiles * col_tiles, min_tiles, [&](size_t tid, size_t begin, size_t end) {
+        for (size_t t = begin; t < end; t++) {
+            int r0 = (t / col_tiles) * TRANSPOSE_TILE;
+            int c0 = (t % col_tiles) * TRANSPOSE_TILE;
+            int r1 = std::min(row, r0 + TRANSPOSE_TILE);
+            int c1 = std::min(col, c0 + TRANSPOSE_TILE);
+            for (int ri = r0; ri < r1; ri++) {
+                for (int ci = c0; ci < c1; ci++) {
+                    out[(size_t)ci * row + ri] = in[(size_t)ri * col + ci];
+                }
+            }
+        }
+    });
+}
+
+void matmul(half* out, const half* in, const half* weight, int m, int n, int k, half alpha, half beta)
+{
+    size_t n_blocks = (n + MATMUL_N_BLOCK - 1) / MATMUL_N_BLOCK;
+    size_t macs_per_task = std::max((size_t)k * MATMUL_N_BLOCK, (size_t)1);
+
+    parallel_for((size_t)m * n_blocks, MIN_MACS_PER_THREAD / macs_per_task, [&](size_t tid, size_t begin, size_t end) {
+        for (size_t t = begin; t < end; t++) {
+            int mi = t / n_blocks;
+            int n_begin = (t % n_blocks) * MATMUL_N_BLOCK;
+            int n_end = std::min(n, n_begin + MATMUL_N_BLOCK);
+#ifdef PIM_REF_X86_SIMD
+            if (g_use_simd && n_end - n_begin == MATMUL_N_BLOCK) {
+                matmul_block_avx2(out, in, weight, n, k, mi, n_begin, alpha, beta);
+                continue;
+            }
+#endif
+            matmul_block_scalar(out, in, weight, n, k, mi, n_begin, n_end, alpha, beta);
+        }
+    });
+}
+
+size_t compare_half_relative(const half* data_a, const half* data_b, size_t size, float abs_tolerance,
+                             CompareResult* result, std::vector<size_t>* fail_idx)
+{
+    size_t max_threads = get_num_threads();
+    std::vector<CompareState> states(max_threads);
+
+    parallel_for(size, MIN_ELEMS_PER_THREAD, [&](size_t tid, size_t begin, size_t end) {
+        CompareState& state = states[tid];
+        state.result = {0, 0, 0, 0.0f};
+#ifdef PIM_REF_X86_SIMD
+        if (g_use_simd) {
+            compare_avx2(data_a, data_b, begin, end, abs_tolerance, &state);
+            return;
+        }
+#endif
+        for (size_t i = begin; i < end; i++) {
+            compare_one(data_a, data_b, i, abs_tolerance, &state);
+        }
+    });
+
+    /* ranges are in thread order, so the failed indices stay sorted */
+    CompareResult total = {0, 0, 0, 0.0f};
+    for (auto& state : states) {
+        total.pass_cnt += state.result.pass_cnt;
+        total.warning_cnt += state.result.warning_cnt;
+        total.fail_cnt += state.result.fail_cnt;
+        if (state.result.max_diff > total.max_diff) total.max_diff = state.result.max_diff;
+        if (fail_idx != nullptr) fail_idx->insert(fail_idx->end(), state.fail_idx.begin(), state.fail_idx.end());
+    }
+    if (result != nullptr) *result = total;
+    return total.fail_cnt;
+}
+} /* namespace reference */
+} /* namespace runtime */
+} /* namespace pim */
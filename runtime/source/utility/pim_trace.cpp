@@ -0,0 +1,193 @@
+/*
+ * Copyright (C) 2022 Samsung Electronics Co. LTD
+ *
+ * This software is a property of Samsung Electronics.
+ * No part of this software, either material or conceptual may be copied or distributed, transmitted,
+ * transcribed, stored in a retrieval system or translated into any human or computer language in any form by any means,
+ * electronic, mechanical, manual or otherwise, or disclosed
+ * to third parties without the express written permission of Samsung Electronics.
+ * (Use of the Software is restricted to non-commercial, personal or academic, research purpose only)
+ */
+
+#include "utility/pim_trace.h"
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "utility/pim_log.h"
+
+namespace pim
+{
+namespace runtime
+{
+namespace trace
+{
+std::atomic<bool> g_trace_enabled(false);
+
+namespace
+{
+struct ThreadBuffer {
+    std::mutex lock; /* only contended while the buffer is exported or cleared */
+    std::vector<TraceEvent> events;
+    size_t head = 0; /* next slot to write */
+    size_t count = 0;
+    uint64_t dropped = 0;
+    uint32_t tid = 0;
+};
+
+std::mutex g_registry_lock;
+std::vector<std::shared_ptr<ThreadBuffer>> g_buffers;
+std::atomic<size_t> g_buffer_events(PIM_TRACE_DEFAULT_BUFFER_EVENTS);
+thread_local std::shared_ptr<ThreadBuffer> t_buffer;
+
+ThreadBuffer* get_thread_buffer(void)
+{
+    if (t_buffer == nullptr) {
+        auto buffer = std::make_shared<ThreadBuffer>();
+        buffer->events.resize(g_buffer_events.load());
+        std::lock_guard<std::mutex> guard(g_registry_lock);
+        buffer->tid = (uint32_t)g_buffers.size() + 1;
+        g_buffers.push_back(buffer);
+        t_buffer = buffer;
+    }
+    return t_buffer.get();
+}
+
+void write_event(FILE* fp, const TraceEvent& event, int pid, uint32_t tid, bool first)
+{
+    uint64_t dur_ns = event.end_ns > event.begin_ns ? event.end_ns - event.begin_ns : 0;
+
+    /* timestamps are in microseconds with nanosecond fraction */
+    fprintf(fp, "%s\n{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"pid\":%d,\"tid\":%u", first ? "" : ",",
+            event.name, event.category, pid, tid);
+    fprintf(fp, ",\"ts\":%" PRIu64 ".%03" PRIu64 ",\"dur\":%" PRIu64 ".%03" PRIu64, event.begin_ns / 1000,
+            event.begin_ns % 1000, dur_ns / 1000, dur_ns % 1000);
+    fprintf(fp, ",\"args\":{\"shape\":\"%ux%ux%ux%u\",\"bytes\":%" PRIu64 ",\"stream\":\"0x%" PRIxPTR "\"}}",
+            event.shape[0], event.shape[1], event.shape[2], event.shape[3], event.bytes, (uintptr_t)event.stream);
+}
+}  // namespace
+
+uint64_t now_ns(void)
+{
+    struct timespec tp;
+    clock_gettime(CLOCK_MONOTONIC, &tp);
+    return (uint64_t)tp.tv_sec * 1000000000 + tp.tv_nsec;
+}
+
+void set_enabled(bool enable) { g_trace_enabled.store(enable, std::memory_order_relaxed); }
+void set_buffer_events(size_t num_events)
+{
+    if (num_events > 0) g_buffer_events.store(num_events);
+}
+
+void configure_from_env(void)
+{
+    if (const char* env_n = std::getenv("PIM_TRACE_BUFFER_EVENTS")) {
+        set_buffer_events(strtoull(env_n, nullptr, 10));
+    }
+    if (const char* env_t = std::getenv("PIM_TRACE")) {
+        set_enabled(atoi(env_t) != 0);
+    }
+}
+
+void record(const TraceEvent& event)
+{
+    ThreadBuffer* buffer = get_thread_buffer();
+    std::lock_guard<std::mutex> guard(buffer->lock);
+
+    if (buffer->events.empty()) return;
+    /* the ring keeps the latest events and counts the overwritten ones */
+    buffer->events[buffer->head] = event;
+    buffer->head = (buffer->head + 1) % buffer->events.size();
+    if (buffer->count < buffer->events.size()) {
+        buffer->count++;
+    } else {
+        buffer->dropped++;
+    }
+}
+
+void record(const char* name, const char* category, uint64_t begin_ns)
+{
+    if (begin_ns == 0) return;
+
+    TraceEvent event = {name, category, begin_ns, now_ns(), {0, 0, 0, 0}, 0, nullptr};
+    record(event);
+}
+
+void clear(void)
+{
+    std::lock_guard<std::mutex> registry_guard(g_registry_lock);
+    for (auto& buffer : g_buffers) {
+        std::lock_guard<std::mutex> guard(buffer->lock);
+        buffer->events.assign(g_buffer_events.load(), TraceEvent());
+        buffer->head = 0;
+        buffer->count = 0;
+        buffer->dropped = 0;
+    }
+}
+
+size_t get_num_events(void)
+{
+    size_t num_events = 0;
+    std::lock_guard<std::mutex> registry_guard(g_registry_lock);
+    for (auto& buffer : g_buffers) {
+        std::lock_guard<std::mutex> guard(buffer->lock);
+        num_events += buffer->count;
+    }
+    return num_events;
+}
+
+uint64_t get_num_dropped(void)
+{
+    uint64_t num_dropped = 0;
+    std::lock_guard<std::mutex> registry_guard(g_registry_lock);
+    for (auto& buffer : g_buffers) {
+        std::lock_guard<std::mutex> guard(buffer->lock);
+        num_dropped += buffer->dropped;
+    }
+    return num_dropped;
+}
+
+int dump(const char* file_path)
+{
+    DLOG(INFO) << "[START] " << __FUNCTION__ << " called";
+    if (file_path == nullptr) return -1;
+
+    FILE* fp = fopen(file_path, "w");
+    if (fp == nullptr) {
+        DLOG(ERROR) << "fail to open trace file " << file_path;
+        return -1;
+    }
+
+    int pid = (int)getpid();
+    bool first = true;
+    uint64_t num_dropped = 0;
+    fprintf(fp, "{\"traceEvents\":[");
+    {
+        std::lock_guard<std::mutex> registry_guard(g_registry_lock);
+        for (auto& buffer : g_buffers) {
+            std::lock_guard<std::mutex> guard(buffer->lock);
+            size_t capacity = buffer->events.size();
+            size_t start = (buffer->head + capacity - buffer->count) % (capacity > 0 ? capacity : 1);
+            for (size_t i = 0; i < buffer->count; i++) {
+                write_event(fp, buffer->events[(start + i) % capacity], pid, buffer->tid, first);
+                first = false;
+            }
+            num_dropped += buffer->dropped;
+        }
+    }
+    fprintf(fp, "\n],\"displayTimeUnit\":\"ns\",\"otherData\":{\"dropped_events\":%" PRIu64 "}}\n", num_dropped);
+
+    int ret = ferror(fp) ? -1 : 0;
+    if (fclose(fp) != 0) ret = -1;
+
+    DLOG(INFO) << "[END] " << __FUNCTION__ << " called";
+    return ret;
+}
+} /* namespace trace */
+} /* namespace runtime */
+} /* namespace pim */
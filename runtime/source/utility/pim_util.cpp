@@ -10,7 +10,18 @@
  */
 
 #include "utility/pim_util.h"
+#include <algorithm>
+#include <thread>
+#include <vector>
 #include "half.hpp"
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+/* square tile of transpose_fp16, both tiles (8KB each) stay in L1 */
+#define TRANSPOSE_TILE 64
+/* minimum number of tiles handed to one thread by transpose_fp16 */
+#define MIN_TILES_PER_THREAD 16
 
 __host__ void get_pim_block_info(PimBlockInfo* pbi) { memcpy(pbi, &vega20_pbi, sizeof(PimBlockInfo)); }
 
@@ -47,24 +58,88 @@ void set_pimbo_t(PimBo* dst, PimBo* src)
     dst->bshape_r.h = src->bshape_r.w;
 }
 
-void transpose_pimbo(PimBo* dst, PimBo* src)
+#if defined(__SSE2__)
+static inline void transpose_8x8(uint16_t* dst, size_t dst_pitch, const uint16_t* src, size_t src_pitch)
 {
-    int batch = src->bshape.n;
-    int channel = src->bshape.c;
-    int row = src->bshape.h;
-    int col = src->bshape.w;
-    half_float::half* in = reinterpret_cast<half_float::half*>(src->data);
-    half_float::half* out = reinterpret_cast<half_float::half*>(dst->data);
-
-    for (int iter = 0; iter < batch * channel; iter++) {
-        for (int ri = 0; ri < row; ri++) {
-            for (int ci = 0; ci < col; ci++) {
-                out[ci * row + ri] = in[ri * col + ci];
-            }
+    __m128i a[8], t[8];
+    for (int i = 0; i < 8; i++) a[i] = _mm_loadu_si128((const __m128i*)(src + i * src_pitch));
+    for (int i = 0; i < 4; i++) {
+        t[i] = _mm_unpacklo_epi16(a[i * 2], a[i * 2 + 1]);
+        t[i + 4] = _mm_unpackhi_epi16(a[i * 2], a[i * 2 + 1]);
+    }
+    /* t[0..3] hold columns 0-3 and t[4..7] columns 4-7 of row pairs */
+    for (int i = 0; i < 2; i++) {
+        __m128i lo0 = _mm_unpacklo_epi32(t[i * 4], t[i * 4 + 1]);
+        __m128i hi0 = _mm_unpackhi_epi32(t[i * 4], t[i * 4 + 1]);
+        __m128i lo1 = _mm_unpacklo_epi32(t[i * 4 + 2], t[i * 4 + 3]);
+        __m128i hi1 = _mm_unpackhi_epi32(t[i * 4 + 2], t[i * 4 + 3]);
+        uint16_t* d = dst + i * 4 * dst_pitch;
+        _mm_storeu_si128((__m128i*)d, _mm_unpacklo_epi64(lo0, lo1));
+        _mm_storeu_si128((__m128i*)(d + dst_pitch), _mm_unpackhi_epi64(lo0, lo1));
+        _mm_storeu_si128((__m128i*)(d + 2 * dst_pitch), _mm_unpacklo_epi64(hi0, hi1));
+        _mm_storeu_si128((__m128i*)(d + 3 * dst_pitch), _mm_unpackhi_epi64(hi0, hi1));
+    }
+}
+#endif
+
+void transpose_fp16_tile(uint16_t* dst, size_t dst_pitch, const uint16_t* src, size_t src_pitch, int rows, int cols)
+{
+    int r = 0;
+#if defined(__SSE2__)
+    for (; r + 8 <= rows; r += 8) {
+        int c = 0;
+        for (; c + 8 <= cols; c += 8) {
+            transpose_8x8(dst + c * dst_pitch + r, dst_pitch, src + r * src_pitch + c, src_pitch);
+        }
+        for (; c < cols; c++) {
+            for (int ri = r; ri < r + 8; ri++) dst[c * dst_pitch + ri] = src[ri * src_pitch + c];
+        }
+    }
+#endif
+    for (; r < rows; r++) {
+        for (int c = 0; c < cols; c++) dst[c * dst_pitch + r] = src[r * src_pitch + c];
+    }
+}
+
+void transpose_fp16(void* dst, const void* src, size_t batch, size_t row, size_t col)
+{
+    size_t row_tiles = (row + TRANSPOSE_TILE - 1) / TRANSPOSE_TILE;
+    size_t col_tiles = (col + TRANSPOSE_TILE - 1) / TRANSPOSE_TILE;
+    size_t num_tiles = batch * row_tiles * col_tiles;
+    size_t num_threads = std::min((size_t)std::max(1u, std::thread::hardware_concurrency()),
+                                  std::max(num_tiles / MIN_TILES_PER_THREAD, (size_t)1));
+
+    auto transpose_tiles = [&](size_t begin, size_t end) {
+        for (size_t t = begin; t < end; t++) {
+            size_t b = t / (row_tiles * col_tiles);
+            size_t r = (t / col_tiles) % row_tiles * TRANSPOSE_TILE;
+            size_t c = t % col_tiles * TRANSPOSE_TILE;
+            const uint16_t* in = (const uint16_t*)src + b * row * col;
+            uint16_t* out = (uint16_t*)dst + b * row * col;
+            int rows = std::min(row - r, (size_t)TRANSPOSE_TILE);
+            int cols = std::min(col - c, (size_t)TRANSPOSE_TILE);
+            transpose_fp16_tile(out + c * row + r, row, in + r * col + c, col, rows, cols);
         }
-        in += row * col;
-        out += row * col;
+    };
+
+    std::vector<std::thread> workers;
+    size_t per_thread = (num_tiles + num_threads - 1) / num_threads;
+    for (size_t t = 1; t < num_threads; t++) {
+        size_t begin = t * per_thread;
+        size_t end = std::min(num_tiles, begin + per_thread);
+        if (begin >= end) break;
+        workers.emplace_back(transpose_tiles, begin, end);
     }
+    /* the calling thread takes the first range */
+    transpose_tiles(0, std::min(num_tiles, per_thread));
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+void transpose_pimbo(PimBo* dst, PimBo* src)
+{
+    transpose_fp16(dst->data, src->data, (size_t)src->bshape.n * src->bshape.c, src->bshape.h, src->bshape.w);
 }
 
 size_t get_aligned_size(PimDesc* pim_desc, PimMemFlag mem_flag, PimBo* pim_bo)
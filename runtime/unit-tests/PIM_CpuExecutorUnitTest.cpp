@@ -0,0 +1,352 @@
+/*
+ * Copyright (C) 2022 Samsung Electronics Co. LTD
+ *
+ * This software is a property of Samsung Electronics.
+ * No part of this software, either material or conceptual may be copied or distributed, transmitted,
+ * transcribed, stored in a retrieval system or translated into any human or computer language in any form by any means,
+ * electronic, mechanical, manual or otherwise, or disclosed
+ * to third parties without the express written permission of Samsung Electronics.
+ * (Use of the Software is restricted to non-commercial, personal or academic, research purpose only)
+ */
+
+#include <gtest/gtest.h>
+#include <math.h>
+#include <string.h>
+#include <random>
+#include <vector>
+#include "executor/cpu/CpuPimExecutor.h"
+#include "half.hpp"
+#include "manager/PimGemmWeightReorder.h"
+#include "manager/PimManager.h"
+#include "utility/pim_util.h"
+
+using namespace pim::runtime::executor;
+using namespace pim::runtime::manager;
+
+static uint16_t to_half(float f)
+{
+    half_float::half h(f);
+    uint16_t bits;
+    memcpy(&bits, &h, sizeof(bits));
+    return bits;
+}
+
+static float to_float(uint16_t bits)
+{
+    half_float::half h;
+    memcpy(&h, &bits, sizeof(bits));
+    return (float)h;
+}
+
+static PimBo make_bo(int n, int c, int h, int w, int h_r, int w_r, std::vector<uint16_t>* buf)
+{
+    PimBo bo;
+    memset(&bo, 0, sizeof(bo));
+    buf->assign((size_t)n * c * h * w, 0);
+    bo.bshape = {(uint32_t)n, (uint32_t)c, (uint32_t)h, (uint32_t)w};
+    bo.bshape_r = {(uint32_t)n, (uint32_t)c, (uint32_t)h_r, (uint32_t)w_r};
+    bo.precision = PIM_FP16;
+    bo.size = buf->size() * sizeof(uint16_t);
+    bo.size_r = (size_t)n * c * h_r * w_r * sizeof(uint16_t);
+    bo.mem_type = MEM_TYPE_PIM;
+    bo.data_layout_type = PimDataLayoutType::RAW;
+    bo.data = buf->data();
+    return bo;
+}
+
+static std::shared_ptr<CpuPimExecutor> get_cpu_executor(void)
+{
+    PimManager* pim_manager = PimManager::get_instance(RT_TYPE_CPU, PIM_FP16);
+    return std::make_shared<CpuPimExecutor>(pim_manager, nullptr, PIM_FP16);
+}
+
+TEST(UnitTest, CpuExecutor_Elementwise)
+{
+    /* odd length covers the scalar tails of the vector loops */
+    int len = 3 * 65536 + 5;
+    std::vector<uint16_t> a_buf, b_buf, out_buf;
+    PimBo a = make_bo(1, 1, 1, len, 1, len, &a_buf);
+    PimBo b = make_bo(1, 1, 1, len, 1, len, &b_buf);
+    PimBo out = make_bo(1, 1, 1, len, 1, len, &out_buf);
+    std::mt19937 gen(7);
+    std::uniform_real_distribution<float> dist(-8.0f, 8.0f);
+    for (int i = 0; i < len; i++) {
+        a_buf[i] = to_half(dist(gen));
+        b_buf[i] = to_half(dist(gen));
+    }
+    auto executor = get_cpu_executor();
+
+    ASSERT_EQ(executor->execute_add(&out, &a, &b, nullptr, true), 0);
+    for (int i = 0; i < len; i++) {
+        ASSERT_EQ(out_buf[i], to_half(to_float(a_buf[i]) + to_float(b_buf[i]))) << "add at " << i;
+    }
+    ASSERT_EQ(executor->execute_mul(&out, &a, &b, nullptr, true), 0);
+    for (int i = 0; i < len; i++) {
+        ASSERT_EQ(out_buf[i], to_half(to_float(a_buf[i]) * to_float(b_buf[i]))) << "mul at " << i;
+    }
+    ASSERT_EQ(executor->execute_relu(&out, &a, nullptr, true), 0);
+    for (int i = 0; i < len; i++) {
+        ASSERT_EQ(out_buf[i], to_float(a_buf[i]) > 0.0f ? a_buf[i] : 0) << "relu at " << i;
+    }
+    ASSERT_EQ(executor->execute_copy(&out, &b, nullptr, true), 0);
+    EXPECT_EQ(memcmp(out_buf.data(), b_buf.data(), out.size), 0);
+}
+
+TEST(UnitTest, CpuExecutor_Scalar_Broadcast)
+{
+    int len = 2 * 65536 + 3;
+    std::vector<uint16_t> a_buf, out_buf;
+    PimBo a = make_bo(1, 1, 1, len, 1, len, &a_buf);
+    PimBo out = make_bo(1, 1, 1, len, 1, len, &out_buf);
+    std::mt19937 gen(5);
+    std::uniform_real_distribution<float> dist(-8.0f, 8.0f);
+    for (auto& v : a_buf) v = to_half(dist(gen));
+    uint16_t scalar = to_half(-1.375f);
+    auto executor = get_cpu_executor();
+
+    ASSERT_EQ(executor->execute_add_scalar(&out, scalar, &a, nullptr, true), 0);
+    for (int i = 0; i < len; i++) {
+        ASSERT_EQ(out_buf[i], to_half(to_float(a_buf[i]) + to_float(scalar))) << "add scalar at " << i;
+    }
+    ASSERT_EQ(executor->execute_mul_scalar(&out, scalar, &a, nullptr, true), 0);
+    for (int i = 0; i < len; i++) {
+        ASSERT_EQ(out_buf[i], to_half(to_float(a_buf[i]) * to_float(scalar))) << "mul scalar at " << i;
+    }
+}
+
+TEST(UnitTest, CpuExecutor_BatchNorm)
+{
+    int n = 2, c = 16, h = 8, w = 256;
+    double epsilon = 1e-5;
+    std::vector<uint16_t> in_buf, out_buf, beta_buf, gamma_buf, mean_buf, var_buf;
+    PimBo in = make_bo(n, c, h, w, h, w, &in_buf);
+    PimBo out = make_bo(n, c, h, w, h, w, &out_buf);
+    PimBo beta = make_bo(1, c, 1, 1, 1, 1, &beta_buf);
+    PimBo gamma = make_bo(1, c, 1, 1, 1, 1, &gamma_buf);
+    PimBo mean = make_bo(1, c, 1, 1, 1, 1, &mean_buf);
+    PimBo var = make_bo(1, c, 1, 1, 1, 1, &var_buf);
+    std::mt19937 gen(11);
+    std::uniform_real_distribution<float> dist(-2.0f, 2.0f);
+    for (auto& v : in_buf) v = to_half(dist(gen));
+    for (int ch = 0; ch < c; ch++) {
+        beta_buf[ch] = to_half(dist(gen));
+        gamma_buf[ch] = to_half(dist(gen));
+        mean_buf[ch] = to_half(dist(gen));
+        var_buf[ch] = to_half(fabsf(dist(gen)) + 0.1f);
+    }
+
+    ASSERT_EQ(get_cpu_executor()->execute_bn(&out, &in, &beta, &gamma, &mean, &var, epsilon, nullptr, true), 0);
+    for (size_t i = 0; i < in_buf.size(); i++) {
+        int ch = (i / (h * w)) % c;
+        double ref = (to_float(in_buf[i]) - to_float(mean_buf[ch])) / sqrt(to_float(var_buf[ch]) + epsilon) *
+                         to_float(gamma_buf[ch]) +
+                     to_float(beta_buf[ch]);
+        ASSERT_NEAR(to_float(out_buf[i]), ref, 1e-2 + 2e-3 * fabs(ref)) << "bn at " << i;
+    }
+}
+
+struct GemmCase {
+    PimGemmOrder order;
+    int batch;
+    int m, k, n;         /* real sizes */
+    int k_pad, n_pad;    /* padded sizes of the buffer objects */
+    bool transposed;     /* RAW weight stored as the transpose of its shape */
+    PimDataLayoutType layout;
+    PimActFunc act_func;
+};
+
+static void test_gemm(const GemmCase& t)
+{
+    bool i_x_w = (t.order == I_X_W);
+    std::mt19937 gen(t.m * 131 + t.k * 7 + t.n);
+    std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+    std::vector<uint16_t> in_buf, wei_buf, bias_buf, out_buf, src_buf;
+
+    PimBo in = i_x_w ? make_bo(1, t.batch, t.m, t.k_pad, t.m, t.k, &in_buf)
+                     : make_bo(1, t.batch, t.k_pad, t.m, t.k, t.m, &in_buf);
+    PimBo wei = i_x_w ? make_bo(1, t.batch, t.k_pad, t.n_pad, t.k, t.n, &wei_buf)
+                      : make_bo(1, t.batch, t.n_pad, t.k_pad, t.n, t.k, &wei_buf);
+    PimBo bias = i_x_w ? make_bo(1, t.batch, t.m, t.n_pad, t.m, t.n, &bias_buf)
+                       : make_bo(1, t.batch, t.n_pad, t.m, t.n, t.m, &bias_buf);
+    PimBo out = i_x_w ? make_bo(1, t.batch, t.m, t.n_pad, t.m, t.n, &out_buf)
+                      : make_bo(1, t.batch, t.n_pad, t.m, t.n, t.m, &out_buf);
+    wei.transposed = t.transposed;
+
+    /* padding holds garbage which must not reach the result */
+    for (auto& v : in_buf) v = to_half(100.0f);
+    for (auto& v : wei_buf) v = to_half(100.0f);
+    for (auto& v : out_buf) v = to_half(100.0f);
+
+    size_t in_stride = (size_t)t.m * t.k_pad;
+    size_t wei_stride = (size_t)t.k_pad * t.n_pad;
+    size_t out_stride = (size_t)t.m * t.n_pad;
+    std::vector<float> x((size_t)t.batch * t.m * t.k), wt((size_t)t.batch * t.k * t.n);
+    for (int b = 0; b < t.batch; b++) {
+        for (int i = 0; i < t.m; i++) {
+            for (int p = 0; p < t.k; p++) {
+                uint16_t v = to_half(dist(gen));
+                x[((size_t)b * t.m + i) * t.k + p] = to_float(v);
+                in_buf[b * in_stride + (i_x_w ? i * t.k_pad + p : p * t.m + i)] = v;
+            }
+        }
+        for (int p = 0; p < t.k; p++) {
+            for (int o = 0; o < t.n; o++) {
+                uint16_t v = to_half(dist(gen));
+                wt[((size_t)b * t.k + p) * t.n + o] = to_float(v);
+                /* out-major [o][p] or in-major [p][o] storage */
+                bool out_major = (t.layout != PimDataLayoutType::RAW) || (i_x_w == t.transposed);
+                wei_buf[b * wei_stride + (out_major ? (size_t)o * t.k_pad + p : (size_t)p * t.n_pad + o)] = v;
+            }
+        }
+    }
+    for (size_t i = 0; i < bias_buf.size(); i++) bias_buf[i] = to_half(dist(gen));
+
+    if (t.layout != PimDataLayoutType::RAW) {
+        /* PIM layouts are built from the out-major source, as the weight preload does */
+        src_buf = wei_buf;
+        std::fill(wei_buf.begin(), wei_buf.end(), 0);
+        PimBlockInfo pbi = vega20_pbi;
+        PimGemmWeightReorder reorder(&pbi);
+        int ret = (t.layout == PimDataLayoutType::CHWISE_GEMM_WEIGHT)
+                      ? reorder.reorder_chwise(wei_buf.data(), wei.size, src_buf.data(), &wei, t.order)
+                      : reorder.reorder_aligned(wei_buf.data(), wei.size, src_buf.data(), &wei, t.order);
+        ASSERT_EQ(ret, 0);
+        wei.data_layout_type = t.layout;
+    }
+
+    auto executor = get_cpu_executor();
+    executor->set_gemm_order(t.order);
+    ASSERT_EQ(executor->execute_gemm(&out, &in, &wei, &bias, t.act_func, nullptr, true), 0);
+
+    for (int b = 0; b < t.batch; b++) {
+        for (int i = 0; i < t.m; i++) {
+            for (int o = 0; o < t.n_pad; o++) {
+                size_t idx = b * out_stride + (i_x_w ? (size_t)i * t.n_pad + o : (size_t)o * t.m + i);
+                if (o >= t.n) {
+                    ASSERT_EQ(out_buf[idx], 0) << "padding at " << idx;
+                    continue;
+                }
+                double ref = to_float(bias_buf[idx]);
+                for (int p = 0; p < t.k; p++) {
+                    ref += (double)x[((size_t)b * t.m + i) * t.k + p] * wt[((size_t)b * t.k + p) * t.n + o];
+                }
+                if (t.act_func == ACT_RELU && ref < 0.0) ref = 0.0;
+                ASSERT_NEAR(to_float(out_buf[idx]), ref, 1e-2 + 2e-3 * fabs(ref)) << "output at " << idx;
+            }
+        }
+    }
+}
+
+TEST(UnitTest, CpuExecutor_Gemm_IxW)
+{
+    test_gemm({I_X_W, 1, 4, 256, 512, 256, 512, false, PimDataLayoutType::RAW, NONE});
+}
+
+TEST(UnitTest, CpuExecutor_Gemm_IxW_Padded_Relu)
+{
+    test_gemm({I_X_W, 2, 3, 200, 500, 256, 512, false, PimDataLayoutType::RAW, ACT_RELU});
+}
+
+TEST(UnitTest, CpuExecutor_Gemm_IxW_Transposed)
+{
+    test_gemm({I_X_W, 1, 2, 256, 300, 256, 300, true, PimDataLayoutType::RAW, NONE});
+}
+
+TEST(UnitTest, CpuExecutor_Gemm_WxI)
+{
+    test_gemm({W_X_I, 1, 4, 256, 512, 256, 512, false, PimDataLayoutType::RAW, ACT_RELU});
+}
+
+TEST(UnitTest, CpuExecutor_Gemm_WxI_Transposed)
+{
+    test_gemm({W_X_I, 2, 1, 128, 384, 128, 384, true, PimDataLayoutType::RAW, NONE});
+}
+
+TEST(UnitTest, CpuExecutor_Gemm_IxW_Aligned)
+{
+    test_gemm({I_X_W, 1, 2, 256, 4096, 256, 4096, false, PimDataLayoutType::ALIGNED_GEMM_WEIGHT, ACT_RELU});
+}
+
+TEST(UnitTest, CpuExecutor_Gemm_IxW_Chwise)
+{
+    test_gemm({I_X_W, 4, 1, 1024, 1024, 1024, 1024, false, PimDataLayoutType::CHWISE_GEMM_WEIGHT, NONE});
+}
+
+TEST(UnitTest, CpuExecutor_Gemm_WxI_Chwise)
+{
+    test_gemm({W_X_I, 8, 2, 256, 512, 256, 512, false, PimDataLayoutType::CHWISE_GEMM_WEIGHT, NONE});
+}
+
+TEST(UnitTest, CpuExecutor_Gemv_Accumulate)
+{
+    /* custom gemv with is_gemv_add adds the product to the current output */
+    int k = 256, n = 1000;
+    std::vector<uint16_t> in_buf, wei_buf, out_buf;
+    PimBo in = make_bo(1, 1, 1, k, 1, k, &in_buf);
+    PimBo wei = make_bo(1, 1, k, n, k, n, &wei_buf);
+    PimBo out = make_bo(1, 1, 1, n, 1, n, &out_buf);
+    for (int p = 0; p < k; p++) in_buf[p] = to_half((p % 5) * 0.25f);
+    for (size_t i = 0; i < wei_buf.size(); i++) wei_buf[i] = to_half(((int)(i % 7) - 3) * 0.125f);
+    for (int o = 0; o < n; o++) out_buf[o] = to_half(1.5f);
+
+    auto executor = get_cpu_executor();
+    executor->set_gemm_order(I_X_W);
+    ASSERT_EQ(executor->execute_custom_gemv(&out, &in, &wei, true, nullptr, true), 0);
+    for (int o = 0; o < n; o++) {
+        double ref = 1.5;
+        for (int p = 0; p < k; p++) ref += to_float(in_buf[p]) * to_float(wei_buf[(size_t)p * n + o]);
+        ASSERT_NEAR(to_float(out_buf[o]), ref, 1e-2 + 2e-3 * fabs(ref)) << "output at " << o;
+    }
+}
+
+TEST(UnitTest, CpuExecutor_Graph_Replay)
+{
+    /* relu(a + b) * s + t followed by a gemv, replayed twice against the same ops run eagerly */
+    int len = 4096, n = 256;
+    std::vector<uint16_t> a_buf, b_buf, t0_buf, t1_buf, out_buf, wei_buf, gemv_buf, ref_buf, ref_gemv_buf;
+    PimBo a = make_bo(1, 1, 1, len, 1, len, &a_buf);
+    PimBo b = make_bo(1, 1, 1, len, 1, len, &b_buf);
+    PimBo t0 = make_bo(1, 1, 1, len, 1, len, &t0_buf);
+    PimBo t1 = make_bo(1, 1, 1, len, 1, len, &t1_buf);
+    PimBo out = make_bo(1, 1, 1, len, 1, len, &out_buf);
+    PimBo wei = make_bo(1, 1, len, n, len, n, &wei_buf);
+    PimBo gemv = make_bo(1, 1, 1, n, 1, n, &gemv_buf);
+    std::mt19937 gen(11);
+    std::uniform_real_distribution<float> dist(-2.0f, 2.0f);
+    for (auto& v : wei_buf) v = to_half(dist(gen) * 0.0625f);
+
+    PimGraph graph;
+    graph.nodes.push_back(make_graph_node(OP_ELT_ADD, &t0, &a, &b));
+    graph.nodes.push_back(make_graph_node(OP_RELU, &t1, &t0));
+    graph.nodes.push_back(make_graph_node(OP_ELT_MUL_SCALAR, &t0, &t1));
+    graph.nodes.back().scalar = to_half(0.75f);
+    graph.nodes.push_back(make_graph_node(OP_ELT_ADD_SCALAR, &out, &t0));
+    graph.nodes.back().scalar = to_half(-0.5f);
+    graph.nodes.push_back(make_graph_node(OP_GEMM, &gemv, &out, &wei));
+
+    auto executor = get_cpu_executor();
+    ASSERT_EQ(executor->instantiate_graph(&graph), 0);
+    for (int iter = 0; iter < 2; iter++) {
+        /* operand data is read on every replay */
+        for (int i = 0; i < len; i++) {
+            a_buf[i] = to_half(dist(gen));
+            b_buf[i] = to_half(dist(gen));
+        }
+        ASSERT_EQ(executor->execute_graph(&graph, nullptr, true), 0);
+        ref_buf = out_buf;
+        ref_gemv_buf = gemv_buf;
+
+        ASSERT_EQ(executor->execute_add(&t0, &a, &b, nullptr, true), 0);
+        ASSERT_EQ(executor->execute_relu(&t1, &t0, nullptr, true), 0);
+        ASSERT_EQ(executor->execute_mul_scalar(&t0, to_half(0.75f), &t1, nullptr, true), 0);
+        ASSERT_EQ(executor->execute_add_scalar(&out, to_half(-0.5f), &t0, nullptr, true), 0);
+        executor->set_gemm_order(I_X_W);
+        ASSERT_EQ(executor->execute_gemm(&gemv, &out, &wei, nullptr, NONE, nullptr, true), 0);
+        EXPECT_EQ(ref_buf, out_buf) << "replay " << iter;
+        EXPECT_EQ(ref_gemv_buf, gemv_buf) << "replay " << iter;
+    }
+
+    /* nodes which have no replay path are rejected */
+    graph.nodes.push_back(make_graph_node(OP_DUMMY, &out, &a));
+    EXPECT_NE(executor->execute_graph(&graph, nullptr, true), 0);
+}
@@ -0,0 +1,126 @@
+/*
+ * Copyright (C) 2022 Samsung Electronics Co. LTD
+ *
+ * This software is a property of Samsung Electronics.
+ * No part of this software, either material or conceptual may be copied or distributed, transmitted,
+ * transcribed, stored in a retrieval system or translated into any human or computer language in any form by any means,
+ * electronic, mechanical, manual or otherwise, or disclosed
+ * to third parties without the express written permission of Samsung Electronics.
+ * (Use of the Software is restricted to non-commercial, personal or academic, research purpose only)
+ */
+
+#include <gtest/gtest.h>
+#include <stdlib.h>
+#include <string.h>
+#include <thread>
+#include <vector>
+#include "executor/PimCrfBinGen.h"
+#include "manager/PimManager.h"
+
+using namespace pim::runtime::executor;
+using namespace pim::runtime::manager;
+
+/* the cpu runtime keeps device memory in host memory, so CRF binaries can be read back directly */
+static PimManager* get_cpu_manager(void) { return PimManager::get_instance(RT_TYPE_CPU, PIM_FP16); }
+
+/* smallest data size whose loop counter is lc */
+static int get_size_of_lc(PimCrfBinGen* crf_gen, PimOpType op_type, int lc)
+{
+    int size = 0;
+    int step = 64 * 1024;
+    while (crf_gen->get_loop_counter(op_type, size) < lc) size += step;
+    return size;
+}
+
+TEST(UnitTest, CrfArena_SharedByLoopCounter)
+{
+    PimCrfBinGen crf_gen(get_cpu_manager());
+    ASSERT_EQ(crf_gen.initialize(), 0);
+
+    int size0 = get_size_of_lc(&crf_gen, OP_ELT_ADD, 2);
+    int size1 = size0 + 64 * 1024;
+    ASSERT_EQ(crf_gen.get_loop_counter(OP_ELT_ADD, size1), 2);
+
+    uint8_t* crf0 = crf_gen.find_crf(OP_ELT_ADD, size0);
+    ASSERT_NE(crf0, nullptr);
+    EXPECT_EQ(crf_gen.find_crf(OP_ELT_ADD, size1), crf0);
+    EXPECT_EQ((uint8_t*)crf_gen.make_crf_bin(OP_ELT_ADD, size1), crf0);
+
+    /* neighbouring loop counters are neighbouring slots */
+    uint8_t* crf1 = crf_gen.find_crf(OP_ELT_ADD, get_size_of_lc(&crf_gen, OP_ELT_ADD, 3));
+    EXPECT_EQ(crf1 - crf0, 128);
+    EXPECT_NE(crf_gen.find_crf(OP_ELT_MUL, size0), crf0);
+
+    PimOpType ops[] = {OP_ELT_ADD, OP_ELT_MUL, OP_RELU, OP_COPY, OP_BN, OP_ELT_ADD_SCALAR, OP_ELT_MUL_SCALAR};
+    for (auto op_type : ops) {
+        for (int lc = CRF_ARENA_MIN_LC; lc < 8; lc++) {
+            uint8_t expected[128] = {0};
+            int crf_size = 0;
+            crf_gen.create_pim_cmd(op_type, lc);
+            crf_gen.change_to_binary(expected, &crf_size);
+
+            uint8_t* crf = crf_gen.find_crf(op_type, get_size_of_lc(&crf_gen, op_type, lc));
+            ASSERT_NE(crf, nullptr);
+            EXPECT_EQ(memcmp(crf, expected, crf_size), 0) << "op " << op_type << " lc " << lc;
+        }
+    }
+
+    EXPECT_EQ(crf_gen.deinitialize(), 0);
+    EXPECT_EQ(crf_gen.find_crf(OP_ELT_ADD, size0), nullptr);
+}
+
+TEST(UnitTest, CrfArena_OutOfRange)
+{
+    setenv("PIM_CRF_ARENA_MAX_LC", "3", 1);
+    PimCrfBinGen crf_gen(get_cpu_manager());
+    unsetenv("PIM_CRF_ARENA_MAX_LC");
+    ASSERT_EQ(crf_gen.get_arena_max_lc(), 3);
+    ASSERT_EQ(crf_gen.initialize(), 0);
+
+    /* loop counters past the arena are created once and shared by every size with the same loop counter */
+    int size0 = get_size_of_lc(&crf_gen, OP_RELU, 10);
+    int size1 = size0 + 64 * 1024;
+    EXPECT_EQ(crf_gen.find_crf(OP_RELU, size0), nullptr);
+    uint8_t* crf = (uint8_t*)crf_gen.make_crf_bin(OP_RELU, size0);
+    ASSERT_NE(crf, nullptr);
+    EXPECT_EQ(crf_gen.find_crf(OP_RELU, size1), crf);
+    EXPECT_EQ((uint8_t*)crf_gen.make_crf_bin(OP_RELU, size1), crf);
+
+    /* gemv depends on the tile tree mode and is never preloaded */
+    EXPECT_EQ(crf_gen.find_crf(OP_GEMV, 1024 * sizeof(uint16_t)), nullptr);
+    uint8_t* gemv_crf = (uint8_t*)crf_gen.make_crf_bin(OP_GEMV, 1024 * sizeof(uint16_t));
+    EXPECT_EQ(crf_gen.find_crf(OP_GEMV, 1024 * sizeof(uint16_t)), gemv_crf);
+
+    EXPECT_EQ(crf_gen.deinitialize(), 0);
+}
+
+TEST(UnitTest, CrfArena_ConcurrentLookup)
+{
+    setenv("PIM_CRF_ARENA_MAX_LC", "15", 1);
+    PimCrfBinGen crf_gen(get_cpu_manager());
+    unsetenv("PIM_CRF_ARENA_MAX_LC");
+    ASSERT_EQ(crf_gen.initialize(), 0);
+
+    int num_thread = 8;
+    int num_lc = 32;
+    std::vector<std::vector<uint8_t*>> result(num_thread, std::vector<uint8_t*>(num_lc, nullptr));
+    std::vector<std::thread> workers;
+    for (int t = 0; t < num_thread; t++) {
+        workers.emplace_back([&crf_gen, &result, t, num_lc]() {
+            for (int lc = 0; lc < num_lc; lc++) {
+                int size = get_size_of_lc(&crf_gen, OP_ELT_MUL, lc) + (t % 2) * 64 * 1024;
+                uint8_t* crf = crf_gen.find_crf(OP_ELT_MUL, size);
+                if (crf == nullptr) crf = (uint8_t*)crf_gen.make_crf_bin(OP_ELT_MUL, size);
+                result[t][lc] = crf;
+            }
+        });
+    }
+    for (auto& worker : workers) worker.join();
+
+    for (int lc = 0; lc < num_lc; lc++) {
+        ASSERT_NE(result[0][lc], nullptr);
+        for (int t = 1; t < num_thread; t++) EXPECT_EQ(result[t][lc], result[0][lc]);
+    }
+
+    EXPECT_EQ(crf_gen.deinitialize(), 0);
+}
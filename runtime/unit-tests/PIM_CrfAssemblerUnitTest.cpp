@@ -0,0 +1,190 @@
+/*
+ * Copyright (C) 2022 Samsung Electronics Co. LTD
+ *
+ * This software is a property of Samsung Electronics.
+ * No part of this software, either material or conceptual may be copied or distributed, transmitted,
+ * transcribed, stored in a retrieval system or translated into any human or computer language in any form by any means,
+ * electronic, mechanical, manual or otherwise, or disclosed
+ * to third parties without the express written permission of Samsung Electronics.
+ * (Use of the Software is restricted to non-commercial, personal or academic, research purpose only)
+ */
+
+#include <gtest/gtest.h>
+#include <stdio.h>
+#include <string.h>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "executor/PimCrfAssembler.h"
+#include "executor/PimCrfBinGen.h"
+#include "manager/PimManager.h"
+
+using namespace pim::runtime::executor;
+using namespace pim::runtime::manager;
+
+/* elt_add_crf of pim_crf_bins.h */
+static const uint8_t elt_add_crf[32] = {0x00, 0x00, 0x80, 0x98, 0x00, 0x80, 0x18, 0x1B, 0x07, 0x00, 0x00,
+                                        0x00, 0x04, 0x00, 0x00, 0xE0, 0x00, 0x00, 0x00, 0xF0, 0x00, 0x00,
+                                        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
+
+static const char* relu_program =
+    "# relu of both bank halves\n"
+    "FILL GRF_A[0], EVEN_BANK, relu, auto\n"
+    "NOP 16x\n"
+    "fill grf_b, odd_bank, relu, auto   # lower case and a missing index are accepted\n"
+    "NOP 15x\n"
+    "NOP\n"
+    "JUMP lc [PC - 6]\n"
+    "EXIT\n";
+
+TEST(UnitTest, CrfAssembler_Assemble)
+{
+    PimCrfAssembler assembler;
+    PimCrfProgram program;
+
+    ASSERT_EQ(assembler.assemble(relu_program, &program), 0);
+    ASSERT_EQ(program.cmds.size(), 7u);
+    EXPECT_EQ(program.cmds[0].type_, PimCmdType::FILL);
+    EXPECT_EQ(program.cmds[0].is_relu_, 1);
+    EXPECT_EQ(program.cmds[0].is_auto_, 1);
+    EXPECT_EQ(program.cmds[1].loop_counter_, 15);
+    EXPECT_EQ(program.cmds[2].dst_, PimOpdType::GRF_B);
+    EXPECT_EQ(program.cmds[2].src0_, PimOpdType::ODD_BANK);
+    EXPECT_EQ(program.cmds[4].loop_counter_, 0);
+    EXPECT_EQ(program.cmds[5].type_, PimCmdType::JUMP);
+    EXPECT_EQ(program.cmds[5].loop_offset_, 6);
+    ASSERT_EQ(program.lc_jumps.size(), 1u);
+    EXPECT_EQ(program.lc_jumps[0], 5);
+
+    PimCommand mad(PimCmdType::MAD, PimOpdType::GRF_A, PimOpdType::EVEN_BANK, PimOpdType::SRF_M, PimOpdType::SRF_A, 1);
+    ASSERT_EQ(assembler.assemble("MAD GRF_A[0], EVEN_BANK, SRF_M[0], SRF_A[0], auto\n"
+                                 "NOP 7x\nNOP\nJUMP 3x [PC - 4]\nEXIT",
+                                 &program),
+              0);
+    EXPECT_EQ(program.cmds[0].to_int(), mad.to_int());
+    EXPECT_EQ(program.cmds[3].loop_counter_, 3);
+    EXPECT_TRUE(program.lc_jumps.empty());
+}
+
+TEST(UnitTest, CrfAssembler_Rejects)
+{
+    PimCrfAssembler assembler;
+    PimCrfProgram program;
+
+    EXPECT_NE(assembler.assemble("SUB GRF_A[0], GRF_A[0], EVEN_BANK, auto\nEXIT", &program), 0);
+    EXPECT_NE(assembler.assemble("ADD GRF_C[0], GRF_A[0], EVEN_BANK\nEXIT", &program), 0);
+    EXPECT_NE(assembler.assemble("ADD GRF_A[16], GRF_A[0], EVEN_BANK\nEXIT", &program), 0);
+    EXPECT_NE(assembler.assemble("ADD GRF_A[0], EVEN_BANK\nEXIT", &program), 0);
+    EXPECT_NE(assembler.assemble("ADD GRF_A[0], GRF_A[0], EVEN_BANK, relu\nEXIT", &program), 0);
+    EXPECT_NE(assembler.assemble("NOP 0x\nEXIT", &program), 0);
+    EXPECT_NE(assembler.assemble("# nothing\n", &program), 0);
+
+    /* the text parses, but the program breaks the ISA rules */
+    EXPECT_NE(assembler.assemble("NOP\nEXIT", &program), 0);
+    EXPECT_NE(assembler.assemble("FILL GRF_A[0], EVEN_BANK, auto\nNOP 8x\nJUMP 0x [PC - 2]\nEXIT", &program), 0);
+    EXPECT_NE(assembler.assemble("FILL GRF_A, EVEN_BANK, auto\nADD GRF_A, GRF_A, EVEN_BANK, auto\n"
+                                 "MUL GRF_A, GRF_A, EVEN_BANK, auto\nEXIT",
+                                 &program),
+              0);
+
+    std::string too_long;
+    for (int i = 0; i < 16; i++) too_long += "FILL GRF_A[0], EVEN_BANK, auto\nNOP 8x\n";
+    too_long += "EXIT\n";
+    EXPECT_NE(assembler.assemble(too_long, &program), 0);
+}
+
+TEST(UnitTest, CrfAssembler_RoundTrip)
+{
+    PimCrfAssembler assembler;
+    PimCrfProgram program;
+    std::string text;
+
+    /* the hand written binary of pim_crf_bins.h */
+    ASSERT_EQ(assembler.disassemble(elt_add_crf, sizeof(elt_add_crf), &text), 0);
+    EXPECT_NE(text.find("FILL GRF_A[0], EVEN_BANK"), std::string::npos);
+    EXPECT_NE(text.find("ADD GRF_B[0], GRF_A[0], ODD_BANK, auto"), std::string::npos);
+    EXPECT_NE(text.find("EXIT"), std::string::npos);
+
+    /* every word of a disassembled program assembles back to the same encoding */
+    PimCrfBinGen crf_gen(PimManager::get_instance(RT_TYPE_CPU, PIM_FP16));
+    PimBo dummy;
+    memset(&dummy, 0, sizeof(dummy));
+    std::vector<PimEltChainStep> steps{{ELT_CHAIN_ADD, &dummy, 0}, {ELT_CHAIN_MUL_SCALAR, nullptr, 0x3800}};
+    PimEltChainProgram chain;
+    ASSERT_EQ(crf_gen.create_elt_chain_cmd(steps.data(), steps.size(), 5, &chain), 0);
+
+    std::vector<uint32_t> binary;
+    for (auto& cmd : chain.cmds) binary.push_back(cmd.to_int());
+    ASSERT_EQ(assembler.disassemble((uint8_t*)binary.data(), binary.size() * sizeof(uint32_t), &text), 0);
+    ASSERT_EQ(assembler.assemble(text, &program), 0);
+    ASSERT_EQ(program.cmds.size(), chain.cmds.size());
+    for (size_t i = 0; i < binary.size(); i++) EXPECT_EQ(program.cmds[i].to_int(), binary[i]) << i;
+
+    EXPECT_NE(assembler.disassemble(elt_add_crf, 7, &text), 0);
+}
+
+TEST(UnitTest, CrfAssembler_LoadProgram)
+{
+    PimCrfAssembler assembler;
+    PimCrfProgram program;
+    std::string path = "crf_assembler_unit_test.crf";
+    {
+        std::ofstream file(path);
+        file << relu_program;
+    }
+    ASSERT_EQ(assembler.assemble_file(path, &program), 0);
+    remove(path.c_str());
+    EXPECT_NE(assembler.assemble_file(path, &program), 0);
+    ASSERT_EQ(assembler.assemble(relu_program, &program), 0);
+
+    setenv("PIM_CRF_ARENA_MAX_LC", "7", 1);
+    PimCrfBinGen arena_gen(PimManager::get_instance(RT_TYPE_CPU, PIM_FP16));
+    unsetenv("PIM_CRF_ARENA_MAX_LC");
+    ASSERT_EQ(arena_gen.initialize(), 0);
+
+    /* one size inside the arena and one past it, both take the loaded program with their own loop counter */
+    int sizes[] = {4 * 1024 * 1024, 32 * 1024 * 1024};
+    uint8_t* before = arena_gen.find_crf(OP_RELU, sizes[0]);
+    ASSERT_NE(arena_gen.make_crf_bin(OP_RELU, sizes[1]), nullptr);
+    uint64_t version = arena_gen.get_crf_version();
+    ASSERT_EQ(arena_gen.set_crf_program(OP_RELU, program), 0);
+    /* graphs compare the version to drop launch state which holds the freed binary */
+    EXPECT_NE(arena_gen.get_crf_version(), version);
+    EXPECT_EQ(arena_gen.find_crf(OP_RELU, sizes[0]), before);
+    EXPECT_EQ(arena_gen.find_crf(OP_RELU, sizes[1]), nullptr);
+
+    for (int size : sizes) {
+        uint8_t* crf = (uint8_t*)arena_gen.make_crf_bin(OP_RELU, size);
+        ASSERT_NE(crf, nullptr);
+        std::vector<PimCommand> cmds(program.cmds);
+        cmds[5].loop_counter_ = arena_gen.get_loop_counter(OP_RELU, size);
+        for (size_t i = 0; i < cmds.size(); i++) {
+            uint32_t word;
+            memcpy(&word, crf + i * sizeof(uint32_t), sizeof(word));
+            EXPECT_EQ(word, cmds[i].to_int()) << "size " << size << " cmd " << i;
+        }
+    }
+
+    version = arena_gen.get_crf_version();
+    EXPECT_NE(arena_gen.set_crf_program(OP_GEMM, program), 0);
+    EXPECT_NE(arena_gen.set_crf_program(OP_ELT_CHAIN, program), 0);
+    EXPECT_EQ(arena_gen.get_crf_version(), version);
+
+    /* a program with more statements than the kernel drives leaves the loaded one in place */
+    std::string long_text;
+    for (int i = 0; i <= PIM_OP_MAX_STATEMENTS; i++) long_text += "MOV GRF_A[0], EVEN_BANK, auto\n";
+    long_text += "EXIT\n";
+    PimCrfProgram long_program;
+    ASSERT_EQ(assembler.assemble(long_text, &long_program), 0);
+    PimOpStmtArgs stmt_args = arena_gen.get_stmt_args(OP_RELU);
+    int crf_size = arena_gen.get_crf_size(OP_RELU, sizes[0]);
+    std::vector<uint8_t> arena_crf(arena_gen.find_crf(OP_RELU, sizes[0]),
+                                   arena_gen.find_crf(OP_RELU, sizes[0]) + program.cmds.size() * sizeof(uint32_t));
+    EXPECT_NE(arena_gen.set_crf_program(OP_RELU, long_program), 0);
+    EXPECT_EQ(arena_gen.get_crf_version(), version);
+    EXPECT_EQ(memcmp(&arena_gen.get_stmt_args(OP_RELU), &stmt_args, sizeof(stmt_args)), 0);
+    EXPECT_EQ(arena_gen.get_crf_size(OP_RELU, sizes[0]), crf_size);
+    EXPECT_EQ(memcmp(arena_gen.find_crf(OP_RELU, sizes[0]), arena_crf.data(), arena_crf.size()), 0);
+    EXPECT_NE(arena_gen.make_crf_bin(OP_RELU, sizes[1]), nullptr);
+    EXPECT_EQ(arena_gen.deinitialize(), 0);
+}
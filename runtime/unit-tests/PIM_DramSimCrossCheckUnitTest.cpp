@@ -0,0 +1,404 @@
+/*
+ * Copyright (C) 2022 Samsung Electronics Co. LTD
+ *
+ * This software is a property of Samsung Electronics.
+ * No part of this software, either material or conceptual may be copied or distributed, transmitted,
+ * transcribed, stored in a retrieval system or translated into any human or computer language in any form by any means,
+ * electronic, mechanical, manual or otherwise, or disclosed
+ * to third parties without the express written permission of Samsung Electronics.
+ * (Use of the Software is restricted to non-commercial, personal or academic, research purpose only)
+ */
+
+#include <gtest/gtest.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include "FP16.h"
+#include "PIMBlock.h"
+#include "PIMCmd.h"
+#include "emulator/PimFunctionalSimulator.h"
+#include "emulator/PimSimBackend.h"
+#include "emulator/PimSimInstance.h"
+#include "emulator/PimTraceFile.h"
+#include "executor/PimCrfBinGen.h"
+#include "manager/PimManager.h"
+#include "tools/emulator_api/PimSimulator.h"
+#include "utility/pim_debug.hpp"
+
+using namespace pim::runtime::emulator;
+using namespace pim::runtime::executor;
+using namespace pim::runtime::manager;
+
+#define REG_ROW (0x3fff)
+#define NUM_CHAN (64)
+
+/* records the coalesced trace of a single op kernel, one 32B record per column command in the order of the kernel */
+class OpTraceRecorder
+{
+   public:
+    OpTraceRecorder(PimFunctionalSimulator* sim) : sim_(sim) {}
+
+    uint64_t addr(uint32_t chan, uint32_t bg, uint32_t bank, uint32_t row, uint32_t col)
+    {
+        PimFuncAddr fa = {chan, 0, bg, bank, row, col, 0};
+        return sim_->encode_addr(fa);
+    }
+
+    void push(char cmd, uint32_t chan, int gidx, uint64_t addr, const void* data)
+    {
+        PimMemTraceData trace;
+        memset(&trace, 0, sizeof(trace));
+        if (data != nullptr) memcpy(trace.data, data, sizeof(trace.data));
+        trace.addr = addr;
+        trace.block_id = chan;
+        trace.thread_id = gidx * 2;
+        trace.cmd = cmd;
+        traces.push_back(trace);
+    }
+
+    /*
+     * operand[1] is unused by unary ops, num_wb is the W and R commands the kernel issues per output.
+     * without is_wb_per_half both halves are computed first and the W and R commands follow the odd one, as in BN.
+     */
+    void record_kernel(const uint8_t* crf_binary, int crf_size, const uint8_t* srf_binary, const PimOpStmtArgs& args,
+                       int num_wb, const uint64_t* operand, uint64_t output, int num_tile, bool is_wb_per_half = true)
+    {
+        /* the HAB_PIM image of the kernels, which also sets byte 13 */
+        uint8_t ctrl_on[32] = {0};
+        uint8_t ctrl_off[32] = {0};
+        ctrl_on[0] = 1;
+        ctrl_on[13] = 1;
+        uint32_t sb_hab[4][2] = {{2, 0}, {2, 1}, {0, 0}, {0, 1}};
+
+        for (uint32_t ch = 0; ch < NUM_CHAN; ch++) {
+            for (int i = 0; i < 4; i++) push('W', ch, 0, addr(ch, sb_hab[i][0], sb_hab[i][1], 0x27ff, 0x1f), nullptr);
+            for (int i = 0; i < (crf_size + 31) / 32; i++) {
+                push('W', ch, i, addr(ch, 0, 1, REG_ROW, 0x4 + i), crf_binary + i * 32);
+                push('R', ch, i, addr(ch, 0, 1, REG_ROW, 0x4 + i), nullptr);
+            }
+            if (srf_binary != nullptr) {
+                push('W', ch, 0, addr(ch, 0, 0, REG_ROW, 0x1), srf_binary);
+                push('R', ch, 0, addr(ch, 0, 0, REG_ROW, 0x1), nullptr);
+            }
+            push('W', ch, 0, addr(ch, 0, 0, REG_ROW, 0x0), ctrl_on);
+            push('R', ch, 0, addr(ch, 0, 0, REG_ROW, 0x0), nullptr);
+
+            for (int t = 0; t < num_tile; t++) {
+                for (uint32_t bank = 0; bank < 2; bank++) {
+                    int begin = (bank == 0) ? 0 : args.num_even_stmt;
+                    int end = (bank == 0) ? args.num_even_stmt : args.num_stmt;
+                    for (int stmt = begin; stmt < end; stmt++) {
+                        for (int g = 0; g < args.stmt_cols[stmt]; g++) {
+                            uint64_t col_addr = addr(ch, 0, bank, (t * 8 + g) / 32, (t * 8 + g) % 32);
+                            push('R', ch, g, operand[args.stmt_src[stmt]] + col_addr, nullptr);
+                        }
+                    }
+                    /* every thread issues its write back commands in turn, W before the closing R */
+                    if (!is_wb_per_half && bank == 0) continue;
+                    for (int wb = 0; wb < num_wb; wb++) {
+                        uint32_t wb_bank = (is_wb_per_half || wb > 0) ? bank : 0;
+                        for (int g = 0; g < 8; g++) {
+                            uint64_t col_addr = addr(ch, 0, wb_bank, (t * 8 + g) / 32, (t * 8 + g) % 32);
+                            push((wb == num_wb - 1) ? 'R' : 'W', ch, g, output + col_addr, nullptr);
+                        }
+                    }
+                }
+            }
+
+            push('W', ch, 0, addr(ch, 0, 0, REG_ROW, 0x0), ctrl_off);
+            push('R', ch, 0, addr(ch, 0, 0, REG_ROW, 0x0), nullptr);
+            for (uint32_t bank = 0; bank < 2; bank++) {
+                push('W', ch, bank, addr(ch, 0, bank, 0x2fff, 0x1f), nullptr);
+                push('R', ch, bank, addr(ch, 0, bank, 0x2fff, 0x1f), nullptr);
+            }
+        }
+    }
+
+    std::vector<PimMemTraceData> traces;
+
+   private:
+    PimFunctionalSimulator* sim_;
+};
+
+static std::vector<fp16> random_fp16(size_t num, float lo, float hi, int seed)
+{
+    std::mt19937 gen(seed);
+    std::uniform_real_distribution<float> dist(lo, hi);
+    std::vector<fp16> data(num);
+    for (auto& d : data) d = convertF2H(dist(gen));
+    return data;
+}
+
+/* feeds every event of a recorded trace file to the functional model and to DRAMSim2 */
+static int replay_trace_file(const std::string& path, PimFunctionalSimulator* func_sim, PimSimulator* dram_sim)
+{
+    PimTraceReader reader;
+    PimTraceEvent event;
+    int ret = 0;
+
+    if (reader.open(path) != 0) return -1;
+    while ((ret = reader.next_event(&event)) == 1) {
+        if (event.type == TRACE_EVENT_PRELOAD) {
+            std::vector<uint8_t> data(event.size);
+            if (reader.read_preload(data.data()) != 0) return -1;
+            func_sim->preload_data_with_addr(event.addr, data.data(), event.size);
+            dram_sim->preload_data_with_addr(event.addr, data.data(), event.size);
+        } else if (event.type == TRACE_EVENT_KERNEL) {
+            std::vector<PimMemTraceData> trace(event.num_trace);
+            if (reader.read_trace(trace.data(), trace.size()) != (int64_t)trace.size()) return -1;
+            func_sim->execute_kernel(trace.data(), trace.size());
+            dram_sim->execute_kernel(trace.data(), trace.size());
+        }
+    }
+    reader.close();
+    return ret;
+}
+
+TEST(UnitTest, DramSimCrossCheck_CmdEncoding)
+{
+    std::vector<PimCommand> cmds{
+        PimCommand(PimCmdType::FILL, PimOpdType::GRF_A, PimOpdType::EVEN_BANK, 1, 0, 0, 0, 1),
+        PimCommand(PimCmdType::ADD, PimOpdType::GRF_B, PimOpdType::GRF_B, PimOpdType::ODD_BANK, 1),
+        PimCommand(PimCmdType::MUL, PimOpdType::GRF_A, PimOpdType::GRF_A, PimOpdType::EVEN_BANK, 1, 3, 5, 0),
+        PimCommand(PimCmdType::MAC, PimOpdType::GRF_B, PimOpdType::GRF_A, PimOpdType::ODD_BANK, 1, 0, 0, 7),
+        PimCommand(PimCmdType::MAD, PimOpdType::GRF_A, PimOpdType::EVEN_BANK, PimOpdType::SRF_M,
+                   PimOpdType::SRF_A, 1, 0, 0, 2),
+        PimCommand(PimCmdType::NOP, 23),
+        PimCommand(PimCmdType::JUMP, 7, 2),
+        PimCommand(PimCmdType::EXIT, 0)};
+
+    /* the runtime and DRAMSim2 have to agree on every field of the CRF word */
+    for (auto& cmd : cmds) {
+        DRAMSim::PIMCmd dram_cmd;
+        dram_cmd.fromInt(cmd.to_int());
+        EXPECT_EQ(dram_cmd.toInt(), cmd.to_int()) << cmd.to_str();
+        EXPECT_EQ((int)dram_cmd.type_, (int)cmd.type_) << cmd.to_str();
+        if (cmd.type_ == PimCmdType::NOP || cmd.type_ == PimCmdType::JUMP) {
+            EXPECT_EQ(dram_cmd.loopCounter_, cmd.loop_counter_) << cmd.to_str();
+            if (cmd.type_ == PimCmdType::JUMP) EXPECT_EQ(dram_cmd.loopOffset_, cmd.loop_offset_) << cmd.to_str();
+        } else if (cmd.type_ != PimCmdType::EXIT) {
+            EXPECT_EQ((int)dram_cmd.dst_, (int)cmd.dst_) << cmd.to_str();
+            EXPECT_EQ((int)dram_cmd.src0_, (int)cmd.src0_) << cmd.to_str();
+            EXPECT_EQ((int)dram_cmd.src1_, (int)cmd.src1_) << cmd.to_str();
+            EXPECT_EQ(dram_cmd.isAuto_, cmd.is_auto_) << cmd.to_str();
+            EXPECT_EQ(dram_cmd.isRelu_, cmd.is_relu_) << cmd.to_str();
+        }
+    }
+}
+
+TEST(UnitTest, DramSimCrossCheck_RecordedTraces)
+{
+    PimCrfBinGen crf_gen(PimManager::get_instance(RT_TYPE_CPU, PIM_FP16));
+    PimFunctionalSimulator addr_sim;
+    DRAMSim::PIMBlock pim_block(DRAMSim::PIMPrecision::FP16);
+    std::string rocm_path = ROCM_PATH;
+    int num_tile = 2;
+    size_t num_elem = (size_t)num_tile * 256 * 1024 / sizeof(fp16);
+    size_t data_size = num_elem * sizeof(fp16);
+    uint64_t base[3] = {0, data_size, 2 * data_size};
+    fp16 scalar = convertF2H(-1.5f);
+
+    for (auto op_type : {OP_ELT_ADD, OP_ELT_MUL, OP_RELU, OP_ELT_ADD_SCALAR, OP_ELT_MUL_SCALAR}) {
+        bool is_binary = (op_type == OP_ELT_ADD || op_type == OP_ELT_MUL);
+        bool is_scalar = (op_type == OP_ELT_ADD_SCALAR || op_type == OP_ELT_MUL_SCALAR);
+        std::vector<fp16> in0 = random_fp16(num_elem, -4.0f, 4.0f, 11 + op_type);
+        std::vector<fp16> in1 = random_fp16(num_elem, -4.0f, 4.0f, 31 + op_type);
+
+        uint8_t crf_binary[128] = {0};
+        uint8_t srf_binary[32] = {0};
+        int crf_size = 0;
+        crf_gen.create_pim_cmd(op_type, crf_gen.get_loop_counter(op_type, data_size));
+        crf_gen.change_to_binary(crf_binary, &crf_size);
+        if (is_scalar) {
+            uint16_t h_scalar;
+            memcpy(&h_scalar, &scalar, sizeof(h_scalar));
+            ASSERT_EQ(crf_gen.preprocess_srf_scalar(op_type, h_scalar, srf_binary), 0);
+        }
+
+        OpTraceRecorder recorder(&addr_sim);
+        recorder.record_kernel(crf_binary, crf_size, is_scalar ? srf_binary : nullptr,
+                               crf_gen.get_stmt_args(op_type), is_binary ? 3 : 2, base, base[2], num_tile);
+
+        char path[] = "/tmp/pim_cross_check_XXXXXX";
+        int fd = mkstemp(path);
+        ASSERT_GE(fd, 0);
+        close(fd);
+        PimTraceWriter writer;
+        ASSERT_EQ(writer.open(path), 0);
+        EXPECT_EQ(writer.write_preload(base[0], in0.data(), data_size), 0);
+        if (is_binary) EXPECT_EQ(writer.write_preload(base[1], in1.data(), data_size), 0);
+        EXPECT_EQ(writer.write_kernel(recorder.traces.data(), recorder.traces.size()), 0);
+        EXPECT_EQ(writer.close(), 0);
+
+        PimFunctionalSimulator func_sim;
+        PimSimulator dram_sim;
+        func_sim.initialize();
+        dram_sim.initialize(rocm_path + "/include/dramsim2/ini/HBM2_samsung_2M_16B_x64.ini",
+                            rocm_path + "/include/dramsim2/ini/system_hbm_vega20.ini", 256 * 64 * 2, 64, 1);
+        EXPECT_EQ(replay_trace_file(path, &func_sim, &dram_sim), 0) << get_pim_op_string(op_type);
+        unlink(path);
+
+        std::vector<fp16> func_out(num_elem);
+        std::vector<fp16> dram_out(num_elem);
+        func_sim.read_result((uint16_t*)func_out.data(), base[2], data_size);
+        dram_sim.read_result((uint16_t*)dram_out.data(), base[2], data_size);
+        dram_sim.deinitialize();
+        EXPECT_EQ(memcmp(func_out.data(), dram_out.data(), data_size), 0) << get_pim_op_string(op_type);
+
+        /* both models against the lane arithmetic of the DRAMSim2 PIM block, RELU has no block op of its own */
+        if (op_type == OP_RELU) continue;
+        int num_mismatch = 0;
+        for (size_t b = 0; b < num_elem / 16; b++) {
+            DRAMSim::BurstType src0(&in0[b * 16]);
+            DRAMSim::BurstType src1(&in1[b * 16]);
+            DRAMSim::BurstType srf_m, srf_a, dst;
+            for (int l = 0; l < 16; l++) srf_m.fp16Data_[l] = scalar;
+            if (op_type == OP_ELT_ADD) pim_block.add(dst, src0, src1);
+            if (op_type == OP_ELT_MUL) pim_block.mul(dst, src0, src1);
+            if (op_type == OP_ELT_ADD_SCALAR) pim_block.add(dst, src0, srf_m);
+            if (op_type == OP_ELT_MUL_SCALAR) pim_block.mad(dst, src0, srf_m, srf_a);
+            if (memcmp(dst.u8Data_, &func_out[b * 16], sizeof(dst.u8Data_)) != 0) num_mismatch++;
+        }
+        EXPECT_EQ(num_mismatch, 0) << get_pim_op_string(op_type);
+    }
+}
+
+TEST(UnitTest, DramSimCrossCheck_SimBackendInstances)
+{
+    PimCrfBinGen crf_gen(PimManager::get_instance(RT_TYPE_CPU, PIM_FP16));
+    PimFunctionalSimulator addr_sim;
+    std::string rocm_path = ROCM_PATH;
+    std::string dev_ini = rocm_path + "/include/dramsim2/ini/HBM2_samsung_2M_16B_x64.ini";
+    std::string sys_ini = rocm_path + "/include/dramsim2/ini/system_hbm_vega20.ini";
+    int num_tile = 2;
+    size_t num_elem = (size_t)num_tile * 256 * 1024 / sizeof(fp16);
+    size_t data_size = num_elem * sizeof(fp16);
+    uint64_t base[3] = {0, data_size, 2 * data_size};
+    size_t gemv_dim = 4096;
+    std::vector<fp16> in0 = random_fp16(num_elem, -4.0f, 4.0f, 51);
+    std::vector<fp16> in1 = random_fp16(num_elem, -4.0f, 4.0f, 52);
+
+    uint8_t crf_binary[128] = {0};
+    int crf_size = 0;
+    crf_gen.create_pim_cmd(OP_ELT_ADD, crf_gen.get_loop_counter(OP_ELT_ADD, data_size));
+    crf_gen.change_to_binary(crf_binary, &crf_size);
+    OpTraceRecorder recorder(&addr_sim);
+    recorder.record_kernel(crf_binary, crf_size, nullptr, crf_gen.get_stmt_args(OP_ELT_ADD), 3, base, base[2],
+                           num_tile);
+
+    /* the prebuilt simulator is the reference for the worker instances, including the GEMV lane reduction */
+    PimSimulator dram_sim;
+    std::vector<fp16> ref_out(num_elem);
+    std::vector<fp16> ref_gemv(gemv_dim);
+    dram_sim.initialize(dev_ini, sys_ini, 256 * 64 * 2, 64, 1);
+    dram_sim.preload_data_with_addr(base[0], in0.data(), data_size);
+    dram_sim.preload_data_with_addr(base[1], in1.data(), data_size);
+    dram_sim.execute_kernel(recorder.traces.data(), recorder.traces.size());
+    dram_sim.read_result((uint16_t*)ref_out.data(), base[2], data_size);
+    dram_sim.read_result_gemv((uint16_t*)ref_gemv.data(), base[0], gemv_dim);
+    dram_sim.deinitialize();
+
+    for (const char* num_threads : {"1", "4"}) {
+        PimSimBackend backend;
+        std::vector<fp16> out(num_elem);
+        std::vector<fp16> gemv(gemv_dim);
+        setenv("PIM_EMULATOR_NUM_THREADS", num_threads, 1);
+        backend.initialize(dev_ini, sys_ini, 256 * 64 * 2, 64, 1);
+        unsetenv("PIM_EMULATOR_NUM_THREADS");
+        ASSERT_EQ(backend.get_num_sims(), atoi(num_threads));
+
+        EXPECT_EQ(backend.preload_data_with_addr(base[0], in0.data(), data_size), 0);
+        EXPECT_EQ(backend.preload_data_with_addr(base[1], in1.data(), data_size), 0);
+        EXPECT_EQ(backend.execute_kernel(recorder.traces.data(), recorder.traces.size()), 0);
+        EXPECT_EQ(backend.read_result((uint16_t*)out.data(), base[2], data_size), 0);
+        EXPECT_EQ(backend.read_result_gemv((uint16_t*)gemv.data(), base[0], gemv_dim), 0);
+        EXPECT_EQ(memcmp(ref_out.data(), out.data(), data_size), 0) << num_threads;
+        EXPECT_EQ(memcmp(ref_gemv.data(), gemv.data(), gemv_dim * sizeof(fp16)), 0) << num_threads;
+    }
+}
+
+/* the scheduled programs against the padded ones of PIM_CRF_SCHEDULE=0, on both models */
+TEST(UnitTest, DramSimCrossCheck_ScheduledPrograms)
+{
+    setenv("PIM_CRF_SCHEDULE", "0", 1);
+    PimCrfBinGen padded_gen(PimManager::get_instance(RT_TYPE_CPU, PIM_FP16));
+    unsetenv("PIM_CRF_SCHEDULE");
+    PimCrfBinGen scheduled_gen(PimManager::get_instance(RT_TYPE_CPU, PIM_FP16));
+    PimCrfBinGen* crf_gens[2] = {&padded_gen, &scheduled_gen};
+    PimFunctionalSimulator addr_sim;
+    std::string rocm_path = ROCM_PATH;
+    int num_tile = 2;
+    size_t num_elem = (size_t)num_tile * 256 * 1024 / sizeof(fp16);
+    size_t data_size = num_elem * sizeof(fp16);
+    uint64_t base[3] = {0, data_size, 2 * data_size};
+    fp16 scalar = convertF2H(-1.5f);
+    fp16 bn_srf[16];
+    for (int i = 0; i < 16; i++) bn_srf[i] = convertF2H(i < 8 ? 0.5f + 0.25f * i : -1.0f + 0.125f * i);
+
+    std::vector<PimMemTraceData> preload(2 * data_size / 32);
+    std::vector<uint64_t> out_addrs(data_size / 32);
+    for (size_t i = 0; i < out_addrs.size(); i++) out_addrs[i] = base[2] + i * 32;
+
+    for (auto op_type :
+         {OP_ELT_ADD, OP_ELT_MUL, OP_RELU, OP_COPY, OP_BN, OP_ELT_ADD_SCALAR, OP_ELT_MUL_SCALAR}) {
+        bool is_binary = (op_type == OP_ELT_ADD || op_type == OP_ELT_MUL);
+        bool is_scalar = (op_type == OP_ELT_ADD_SCALAR || op_type == OP_ELT_MUL_SCALAR);
+        std::vector<fp16> in0 = random_fp16(num_elem, -4.0f, 4.0f, 71 + op_type);
+        std::vector<fp16> in1 = random_fp16(num_elem, -4.0f, 4.0f, 91 + op_type);
+        std::vector<fp16> func_out[2];
+        uint64_t cycles[2];
+
+        for (int i = 0; i < 2; i++) {
+            PimCrfBinGen* crf_gen = crf_gens[i];
+            uint8_t crf_binary[128] = {0};
+            uint8_t srf_binary[32] = {0};
+            int crf_size = 0;
+            crf_gen->create_pim_cmd(op_type, crf_gen->get_loop_counter(op_type, data_size));
+            crf_gen->change_to_binary(crf_binary, &crf_size);
+            if (is_scalar) {
+                uint16_t h_scalar;
+                memcpy(&h_scalar, &scalar, sizeof(h_scalar));
+                ASSERT_EQ(crf_gen->preprocess_srf_scalar(op_type, h_scalar, srf_binary), 0);
+            }
+            if (op_type == OP_BN) memcpy(srf_binary, bn_srf, sizeof(srf_binary));
+
+            OpTraceRecorder recorder(&addr_sim);
+            recorder.record_kernel(crf_binary, crf_size, (is_scalar || op_type == OP_BN) ? srf_binary : nullptr,
+                                   crf_gen->get_stmt_args(op_type), is_binary || op_type == OP_BN ? 3 : 2, base,
+                                   base[2], num_tile, op_type != OP_BN);
+
+            PimFunctionalSimulator func_sim;
+            func_sim.initialize();
+            func_sim.preload_data_with_addr(base[0], in0.data(), data_size);
+            func_sim.preload_data_with_addr(base[1], in1.data(), data_size);
+            func_sim.execute_kernel(recorder.traces.data(), recorder.traces.size());
+            func_out[i].resize(num_elem);
+            func_sim.read_result((uint16_t*)func_out[i].data(), base[2], data_size);
+
+            PimSimInstance dram_sim;
+            std::vector<fp16> dram_out(num_elem);
+            dram_sim.initialize(rocm_path + "/include/dramsim2/ini/HBM2_samsung_2M_16B_x64.ini",
+                                rocm_path + "/include/dramsim2/ini/system_hbm_vega20.ini", 256 * 64 * 2, 64);
+            for (size_t b = 0; b < preload.size(); b++) {
+                const uint8_t* src = (b < preload.size() / 2) ? (uint8_t*)in0.data() : (uint8_t*)in1.data();
+                memset(&preload[b], 0, sizeof(preload[b]));
+                memcpy(preload[b].data, src + (b % (preload.size() / 2)) * 32, 32);
+                preload[b].addr = b * 32;
+                preload[b].cmd = 'W';
+            }
+            dram_sim.write_bursts(preload.data(), preload.size());
+            cycles[i] = dram_sim.execute_kernel(recorder.traces.data(), recorder.traces.size());
+            dram_sim.read_bursts(out_addrs.data(), out_addrs.size(), (uint8_t*)dram_out.data());
+            EXPECT_EQ(memcmp(func_out[i].data(), dram_out.data(), data_size), 0) << get_pim_op_string(op_type);
+        }
+
+        EXPECT_EQ(memcmp(func_out[0].data(), func_out[1].data(), data_size), 0) << get_pim_op_string(op_type);
+        EXPECT_LE(cycles[1], cycles[0]) << get_pim_op_string(op_type);
+        std::cout << get_pim_op_string(op_type) << " padded: " << cycles[0] << " cycles, scheduled: " << cycles[1]
+                  << " cycles" << std::endl;
+    }
+}
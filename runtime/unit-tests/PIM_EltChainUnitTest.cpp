@@ -0,0 +1,377 @@
+/*
+ * Copyright (C) 2022 Samsung Electronics Co. LTD
+ *
+ * This software is a property of Samsung Electronics.
+ * No part of this software, either material or conceptual may be copied or distributed, transmitted,
+ * transcribed, stored in a retrieval system or translated into any human or computer language in any form by any means,
+ * electronic, mechanical, manual or otherwise, or disclosed
+ * to third parties without the express written permission of Samsung Electronics.
+ * (Use of the Software is restricted to non-commercial, personal or academic, research purpose only)
+ */
+
+#include <gtest/gtest.h>
+#include <string.h>
+#include <algorithm>
+#include <random>
+#include <vector>
+#include "executor/PimCrfBinGen.h"
+#include "executor/PimCrfScheduler.h"
+#include "executor/PimCrfValidator.h"
+#include "executor/cpu/CpuPimExecutor.h"
+#include "half.hpp"
+#include "manager/PimManager.h"
+#include "utility/pim_debug.hpp"
+
+using namespace pim::runtime::executor;
+using namespace pim::runtime::manager;
+
+static uint16_t to_half(float f)
+{
+    half_float::half h(f);
+    uint16_t bits;
+    memcpy(&bits, &h, sizeof(bits));
+    return bits;
+}
+
+static float to_float(uint16_t bits)
+{
+    half_float::half h;
+    memcpy(&h, &bits, sizeof(bits));
+    return (float)h;
+}
+
+static PimBo make_vector_bo(int len, std::vector<uint16_t>* buf)
+{
+    PimBo bo;
+    memset(&bo, 0, sizeof(bo));
+    buf->assign(len, 0);
+    bo.bshape = {1, 1, 1, (uint32_t)len};
+    bo.bshape_r = bo.bshape;
+    bo.precision = PIM_FP16;
+    bo.size = len * sizeof(uint16_t);
+    bo.size_r = bo.size;
+    bo.mem_type = MEM_TYPE_PIM;
+    bo.data_layout_type = PimDataLayoutType::RAW;
+    bo.data = buf->data();
+    return bo;
+}
+
+/* column commands consumed by the commands of one bank half, up to its write back NOP */
+static int count_half_commands(const std::vector<PimCommand>& cmds)
+{
+    int num_cmd = 0;
+    for (auto& cmd : cmds) {
+        if (cmd.type_ == PimCmdType::NOP && cmd.loop_counter_ == 23) break;
+        num_cmd += (cmd.type_ == PimCmdType::NOP) ? cmd.loop_counter_ + 1 : 8;
+    }
+    return num_cmd;
+}
+
+TEST(UnitTest, CrfValidator_Rules)
+{
+    PimCrfValidator validator;
+    PimCommand fill(PimCmdType::FILL, PimOpdType::GRF_A, PimOpdType::EVEN_BANK, 1);
+    PimCommand add(PimCmdType::ADD, PimOpdType::GRF_A, PimOpdType::GRF_A, PimOpdType::EVEN_BANK, 1);
+    PimCommand exit_cmd(PimCmdType::EXIT, 0);
+
+    std::vector<PimCommand> elt_add{fill, add, PimCommand(PimCmdType::NOP, 22), PimCommand(PimCmdType::NOP, 0),
+                                    PimCommand(PimCmdType::JUMP, 3, 5), exit_cmd};
+    EXPECT_EQ(validator.validate(elt_add), 0);
+
+    /* a dependent ADD right after ADD needs two NOP cycles */
+    std::vector<PimCommand> back_to_back{fill, add, add, exit_cmd};
+    EXPECT_GT(validator.check_hazard(back_to_back), 0);
+    std::vector<PimCommand> spaced{fill, add, PimCommand(PimCmdType::NOP, 7), add, exit_cmd};
+    EXPECT_EQ(validator.check_hazard(spaced), 0);
+
+    /* MUL has no GRF and SRF_A pair, and MAC can not write GRF_A */
+    std::vector<PimCommand> bad_pair{PimCommand(PimCmdType::MUL, PimOpdType::GRF_A, PimOpdType::GRF_A,
+                                                PimOpdType::SRF_A, 1),
+                                     exit_cmd};
+    EXPECT_NE(validator.check_cmd_validation(bad_pair), 0);
+    std::vector<PimCommand> bad_mac{PimCommand(PimCmdType::MAC, PimOpdType::GRF_A, PimOpdType::GRF_B,
+                                               PimOpdType::EVEN_BANK, 1),
+                                    exit_cmd};
+    EXPECT_NE(validator.check_cmd_validation(bad_mac), 0);
+
+    /* ISA restrictions around NOP and JUMP */
+    std::vector<PimCommand> nop_first{PimCommand(PimCmdType::NOP, 0), fill, exit_cmd};
+    EXPECT_NE(validator.check_isa_restriction(nop_first), 0);
+    std::vector<PimCommand> jump_after_nop{fill, PimCommand(PimCmdType::NOP, 7), PimCommand(PimCmdType::JUMP, 1, 2),
+                                           exit_cmd};
+    EXPECT_NE(validator.check_isa_restriction(jump_after_nop), 0);
+    std::vector<PimCommand> zero_jump{fill, PimCommand(PimCmdType::JUMP, 0, 1), exit_cmd};
+    EXPECT_NE(validator.check_isa_restriction(zero_jump), 0);
+
+    /* only the pair of multicycle NOPs is rejected, not a multicycle NOP followed by NOP 0 */
+    std::vector<PimCommand> two_nops{fill, PimCommand(PimCmdType::NOP, 3), PimCommand(PimCmdType::NOP, 3), exit_cmd};
+    EXPECT_NE(validator.check_isa_restriction(two_nops), 0);
+    std::vector<PimCommand> split_nop{fill, PimCommand(PimCmdType::NOP, 3), PimCommand(PimCmdType::NOP, 0),
+                                      exit_cmd};
+    EXPECT_EQ(validator.check_isa_restriction(split_nop), 0);
+}
+
+TEST(UnitTest, CrfScheduler_MinimalNop)
+{
+    PimCrfScheduler scheduler;
+    std::vector<PimCommand> cmds;
+    PimCommand fill(PimCmdType::FILL, PimOpdType::GRF_A, PimOpdType::EVEN_BANK, 1);
+    PimCommand add(PimCmdType::ADD, PimOpdType::GRF_A, PimOpdType::GRF_A, PimOpdType::EVEN_BANK, 1);
+    PimCommand mad(PimCmdType::MAD, PimOpdType::GRF_A, PimOpdType::GRF_A, PimOpdType::SRF_M, PimOpdType::SRF_A, 1);
+
+    /* FILL from the bank forwards to ADD, ADD and MAD on a register result need two and three cycles */
+    EXPECT_EQ(scheduler.push_cmd(fill), 0);
+    EXPECT_EQ(scheduler.push_cmd(add), 0);
+    EXPECT_EQ(scheduler.push_cmd(add), 2);
+    EXPECT_EQ(scheduler.push_cmd(mad), 2);
+    EXPECT_EQ(scheduler.push_cmd(add), 3);
+    EXPECT_EQ(scheduler.get_num_cycle(), 5 * 8 + 7);
+
+    /* kernel cycles merge with the NOP in front of them and JUMP never follows a multicycle NOP */
+    scheduler.push_nop(24);
+    ASSERT_EQ(scheduler.finish(3, &cmds), 0);
+    EXPECT_EQ(cmds.size() % 8, 0u);
+    auto jump = std::find_if(cmds.begin(), cmds.end(), [](const PimCommand& c) { return c.type_ == PimCmdType::JUMP; });
+    ASSERT_NE(jump, cmds.end());
+    EXPECT_EQ((jump - 1)->type_, PimCmdType::NOP);
+    EXPECT_EQ((jump - 1)->loop_counter_, 0);
+    EXPECT_EQ((jump - 2)->loop_counter_, 22);
+    EXPECT_EQ(jump->loop_offset_, jump - cmds.begin() + 1);
+
+    /* a body which runs once has no JUMP */
+    ASSERT_EQ(scheduler.finish(0, &cmds), 0);
+    EXPECT_EQ(std::count_if(cmds.begin(), cmds.end(), [](const PimCommand& c) { return c.type_ == PimCmdType::JUMP; }),
+              0);
+}
+
+TEST(UnitTest, CrfBinGen_SingleOpPrograms)
+{
+    PimCrfBinGen crf_gen(PimManager::get_instance(RT_TYPE_CPU, PIM_FP16));
+    PimCrfValidator validator;
+
+    for (auto op_type : {OP_ELT_ADD, OP_ELT_MUL, OP_RELU, OP_COPY, OP_BN, OP_ELT_ADD_SCALAR, OP_ELT_MUL_SCALAR}) {
+        for (int lc : {0, 3}) {
+            uint8_t crf_binary[128];
+            int crf_size = 0;
+            crf_gen.create_pim_cmd(op_type, lc);
+            crf_gen.change_to_binary(crf_binary, &crf_size);
+
+            std::vector<PimCommand> cmds(crf_size / sizeof(uint32_t));
+            for (size_t i = 0; i < cmds.size(); i++) {
+                uint32_t val;
+                memcpy(&val, crf_binary + i * sizeof(uint32_t), sizeof(val));
+                cmds[i].from_int(val);
+            }
+            EXPECT_EQ(validator.validate(cmds), 0) << get_pim_op_string(op_type) << " lc " << lc;
+            EXPECT_EQ(crf_gen.get_crf_size(op_type, lc == 0 ? 1024 : 4 << 20), crf_size);
+        }
+    }
+
+    /* every statement of a binary op is a full instruction, the first of each pair fills with the first vector */
+    const PimOpStmtArgs& add_args = crf_gen.get_stmt_args(OP_ELT_ADD);
+    EXPECT_EQ(add_args.num_stmt, 4);
+    EXPECT_EQ(add_args.num_even_stmt, 2);
+    for (int i = 0; i < add_args.num_stmt; i++) {
+        EXPECT_EQ(add_args.stmt_cols[i], 8);
+        EXPECT_EQ(add_args.stmt_src[i], i % 2);
+    }
+    EXPECT_EQ(crf_gen.get_stmt_args(OP_RELU).num_stmt, 2);
+    EXPECT_EQ(crf_gen.get_stmt_args(OP_ELT_MUL_SCALAR).num_even_stmt, 1);
+
+    /* BN used to spend a whole statement on each hazard between its MADs */
+    const PimOpStmtArgs& bn_args = crf_gen.get_stmt_args(OP_BN);
+    int num_col = 0;
+    for (int i = 0; i < bn_args.num_stmt; i++) num_col += bn_args.stmt_cols[i];
+    EXPECT_EQ(bn_args.num_even_stmt, 3);
+    EXPECT_EQ(bn_args.num_stmt, 7);
+    EXPECT_EQ(num_col, 39);
+}
+
+TEST(UnitTest, CrfBinGen_PaddedOpPrograms)
+{
+    setenv("PIM_CRF_SCHEDULE", "0", 1);
+    PimCrfBinGen padded_gen(PimManager::get_instance(RT_TYPE_CPU, PIM_FP16));
+    unsetenv("PIM_CRF_SCHEDULE");
+    PimCrfBinGen crf_gen(PimManager::get_instance(RT_TYPE_CPU, PIM_FP16));
+
+    /* the padded programs drive the kernels with a whole statement per instruction and hazard */
+    for (auto op_type : {OP_ELT_ADD, OP_ELT_MUL, OP_RELU, OP_COPY, OP_BN, OP_ELT_ADD_SCALAR, OP_ELT_MUL_SCALAR}) {
+        const PimOpStmtArgs& args = padded_gen.get_stmt_args(op_type);
+        const PimOpStmtArgs& scheduled_args = crf_gen.get_stmt_args(op_type);
+        int num_col = 0;
+        int scheduled_col = 0;
+        for (int i = 0; i < args.num_stmt; i++) {
+            EXPECT_EQ(args.stmt_cols[i], 8) << get_pim_op_string(op_type);
+            num_col += args.stmt_cols[i];
+        }
+        for (int i = 0; i < scheduled_args.num_stmt; i++) scheduled_col += scheduled_args.stmt_cols[i];
+        EXPECT_LE(scheduled_col, num_col) << get_pim_op_string(op_type);
+    }
+    EXPECT_EQ(padded_gen.get_stmt_args(OP_ELT_ADD).num_stmt, 4);
+    EXPECT_EQ(padded_gen.get_stmt_args(OP_RELU).num_stmt, 2);
+    EXPECT_EQ(padded_gen.get_stmt_args(OP_BN).num_stmt, 7);
+
+    /* the padded BN body with its JUMP and EXIT takes two rows of eight commands */
+    uint8_t crf_binary[128];
+    int crf_size = 0;
+    padded_gen.create_pim_cmd(OP_BN, 3);
+    padded_gen.change_to_binary(crf_binary, &crf_size);
+    EXPECT_EQ(crf_size, 64);
+    EXPECT_EQ(padded_gen.get_crf_size(OP_BN, 4 << 20), crf_size);
+}
+
+TEST(UnitTest, EltChain_ScheduleSavings)
+{
+    PimCrfBinGen crf_gen(PimManager::get_instance(RT_TYPE_CPU, PIM_FP16));
+    PimCrfValidator validator;
+    PimBo dummy;
+    memset(&dummy, 0, sizeof(dummy));
+
+    std::vector<std::vector<PimEltChainStep>> chains{
+        {{ELT_CHAIN_ADD, &dummy, 0}, {ELT_CHAIN_RELU, nullptr, 0}},
+        {{ELT_CHAIN_ADD, &dummy, 0}, {ELT_CHAIN_MUL, &dummy, 0}},
+        {{ELT_CHAIN_MUL, &dummy, 0}, {ELT_CHAIN_MUL_SCALAR, nullptr, to_half(0.5f)}, {ELT_CHAIN_RELU, nullptr, 0}},
+        {{ELT_CHAIN_ADD, &dummy, 0},
+         {ELT_CHAIN_MUL, &dummy, 0},
+         {ELT_CHAIN_RELU, nullptr, 0},
+         {ELT_CHAIN_MUL_SCALAR, nullptr, to_half(0.5f)},
+         {ELT_CHAIN_ADD_SCALAR, nullptr, to_half(1.0f)}}};
+
+    for (size_t i = 0; i < chains.size(); i++) {
+        PimEltChainProgram program;
+        ASSERT_EQ(crf_gen.create_elt_chain_cmd(chains[i].data(), chains[i].size(), 3, &program), 0);
+        EXPECT_EQ(validator.validate(program.cmds), 0);
+
+        /* a hazard used to cost a whole statement of eight column commands per bank half and tile */
+        int num_col = 0;
+        int num_hazard = 0;
+        for (auto cols : program.stmt_cols) {
+            num_col += cols;
+            if (cols < 8) num_hazard++;
+        }
+        int stmt_col = program.stmt_cols.size() * 8;
+        EXPECT_GT(num_hazard, 0);
+        EXPECT_LT(num_col, stmt_col);
+        printf("chain %zu : %d hazards, %d column commands per bank half instead of %d\n", i, num_hazard, num_col,
+               stmt_col);
+    }
+}
+
+TEST(UnitTest, EltChain_Program)
+{
+    PimCrfBinGen crf_gen(PimManager::get_instance(RT_TYPE_CPU, PIM_FP16));
+    PimCrfValidator validator;
+    PimBo dummy;
+    memset(&dummy, 0, sizeof(dummy));
+
+    /* relu((x + a) * b) * 0.5 + 1 */
+    std::vector<PimEltChainStep> steps{{ELT_CHAIN_ADD, &dummy, 0},
+                                       {ELT_CHAIN_MUL, &dummy, 0},
+                                       {ELT_CHAIN_RELU, nullptr, 0},
+                                       {ELT_CHAIN_MUL_SCALAR, nullptr, to_half(0.5f)},
+                                       {ELT_CHAIN_ADD_SCALAR, nullptr, to_half(1.0f)}};
+    PimEltChainProgram program;
+    ASSERT_EQ(crf_gen.create_elt_chain_cmd(steps.data(), steps.size(), 3, &program), 0);
+
+    EXPECT_EQ(validator.validate(program.cmds), 0);
+    EXPECT_EQ(program.cmds.size() % 8, 0u);
+    EXPECT_LE(program.cmds.size(), 32u);
+    EXPECT_EQ(program.num_operand, 2);
+    EXPECT_TRUE(program.use_srf);
+    EXPECT_EQ(to_float(program.scale), 0.5f);
+    EXPECT_EQ(to_float(program.shift), 1.0f);
+
+    /* the kernel issues the column commands of every statement, so both sides have to agree */
+    int num_col = 0;
+    for (auto cols : program.stmt_cols) num_col += cols;
+    EXPECT_EQ(program.stmt_cols.size(), program.stmt_src.size());
+    EXPECT_EQ(count_half_commands(program.cmds), num_col);
+    EXPECT_EQ(program.stmt_src[0], 0);
+    EXPECT_EQ(program.stmt_src[1], 1);
+    EXPECT_NE(std::find(program.stmt_src.begin(), program.stmt_src.end(), 2), program.stmt_src.end());
+    EXPECT_EQ(program.cmds[0].type_, PimCmdType::FILL);
+    EXPECT_EQ(program.cmds[1].type_, PimCmdType::ADD);
+
+    /* a relu or scalar step on the input is applied while the bank is loaded */
+    std::vector<PimEltChainStep> relu_first{{ELT_CHAIN_RELU, nullptr, 0}, {ELT_CHAIN_ADD, &dummy, 0}};
+    ASSERT_EQ(crf_gen.create_elt_chain_cmd(relu_first.data(), relu_first.size(), 0, &program), 0);
+    EXPECT_EQ(program.cmds[0].type_, PimCmdType::FILL);
+    EXPECT_EQ(program.cmds[0].is_relu_, 1);
+    EXPECT_FALSE(program.use_srf);
+    EXPECT_EQ(validator.validate(program.cmds), 0);
+
+    std::vector<PimEltChainStep> scalar_only{{ELT_CHAIN_ADD_SCALAR, nullptr, to_half(2.0f)},
+                                             {ELT_CHAIN_MUL_SCALAR, nullptr, to_half(3.0f)}};
+    ASSERT_EQ(crf_gen.create_elt_chain_cmd(scalar_only.data(), scalar_only.size(), 1, &program), 0);
+    EXPECT_EQ(program.cmds[0].type_, PimCmdType::MAD);
+    EXPECT_EQ(program.cmds[0].src0_, PimOpdType::EVEN_BANK);
+    EXPECT_EQ(program.stmt_src.size(), 1u);
+    EXPECT_EQ(to_float(program.scale), 3.0f);
+    EXPECT_EQ(to_float(program.shift), 6.0f);
+}
+
+TEST(UnitTest, EltChain_Rejects)
+{
+    PimCrfBinGen crf_gen(PimManager::get_instance(RT_TYPE_CPU, PIM_FP16));
+    PimEltChainProgram program;
+    PimBo dummy;
+    memset(&dummy, 0, sizeof(dummy));
+
+    /* the SRF holds one scale and shift pair */
+    std::vector<PimEltChainStep> split_scalars{{ELT_CHAIN_MUL_SCALAR, nullptr, to_half(2.0f)},
+                                               {ELT_CHAIN_ADD, &dummy, 0},
+                                               {ELT_CHAIN_ADD_SCALAR, nullptr, to_half(1.0f)}};
+    EXPECT_NE(crf_gen.create_elt_chain_cmd(split_scalars.data(), split_scalars.size(), 1, &program), 0);
+
+    std::vector<PimEltChainStep> many_operands(ELT_CHAIN_MAX_OPERANDS + 1, {ELT_CHAIN_ADD, &dummy, 0});
+    EXPECT_NE(crf_gen.create_elt_chain_cmd(many_operands.data(), many_operands.size(), 1, &program), 0);
+
+    /* every vector operand fits, but the hazard NOPs of a long chain overflow the CRF */
+    std::vector<PimEltChainStep> long_chain;
+    for (int i = 0; i < ELT_CHAIN_MAX_OPERANDS; i++) {
+        long_chain.push_back({ELT_CHAIN_ADD, &dummy, 0});
+        long_chain.push_back({ELT_CHAIN_RELU, nullptr, 0});
+    }
+    EXPECT_NE(crf_gen.create_elt_chain_cmd(long_chain.data(), long_chain.size(), 1, &program), 0);
+}
+
+TEST(UnitTest, EltChain_CpuReference)
+{
+    int len = 65536 + 3;
+    std::vector<uint16_t> x_buf, a_buf, b_buf, out_buf;
+    PimBo x = make_vector_bo(len, &x_buf);
+    PimBo a = make_vector_bo(len, &a_buf);
+    PimBo b = make_vector_bo(len, &b_buf);
+    PimBo out = make_vector_bo(len, &out_buf);
+    std::mt19937 gen(5);
+    std::uniform_real_distribution<float> dist(-4.0f, 4.0f);
+    for (int i = 0; i < len; i++) {
+        x_buf[i] = to_half(dist(gen));
+        a_buf[i] = to_half(dist(gen));
+        b_buf[i] = to_half(dist(gen));
+    }
+
+    std::vector<PimEltChainStep> steps{{ELT_CHAIN_ADD, &a, 0},
+                                       {ELT_CHAIN_RELU, nullptr, 0},
+                                       {ELT_CHAIN_MUL, &b, 0},
+                                       {ELT_CHAIN_MUL_SCALAR, nullptr, to_half(0.5f)},
+                                       {ELT_CHAIN_ADD_SCALAR, nullptr, to_half(-1.0f)}};
+    auto executor = std::make_shared<CpuPimExecutor>(PimManager::get_instance(RT_TYPE_CPU, PIM_FP16), nullptr,
+                                                     PIM_FP16);
+    ASSERT_EQ(executor->execute_elt_chain(&out, &x, steps.data(), steps.size(), nullptr, true), 0);
+
+    for (int i = 0; i < len; i++) {
+        /* every step rounds to FP16 like the unfused ops */
+        float acc = to_float(to_half(to_float(x_buf[i]) + to_float(a_buf[i])));
+        acc = std::max(acc, 0.0f);
+        acc = to_float(to_half(acc * to_float(b_buf[i])));
+        acc = to_float(to_half(acc * 0.5f));
+        acc = to_float(to_half(acc - 1.0f));
+        ASSERT_NEAR(to_float(out_buf[i]), acc, 1e-2f + 1e-3f * fabs(acc)) << "at " << i;
+    }
+
+    /* bad chains are rejected before running */
+    std::vector<PimEltChainStep> no_operand{{ELT_CHAIN_MUL, nullptr, 0}};
+    EXPECT_NE(executor->execute_elt_chain(&out, &x, no_operand.data(), no_operand.size(), nullptr, true), 0);
+    EXPECT_NE(executor->execute_elt_chain(&out, &x, steps.data(), 0, nullptr, true), 0);
+}
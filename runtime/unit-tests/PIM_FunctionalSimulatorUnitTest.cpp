@@ -0,0 +1,336 @@
+/*
+ * Copyright (C) 2022 Samsung Electronics Co. LTD
+ *
+ * This software is a property of Samsung Electronics.
+ * No part of this software, either material or conceptual may be copied or distributed, transmitted,
+ * transcribed, stored in a retrieval system or translated into any human or computer language in any form by any means,
+ * electronic, mechanical, manual or otherwise, or disclosed
+ * to third parties without the express written permission of Samsung Electronics.
+ * (Use of the Software is restricted to non-commercial, personal or academic, research purpose only)
+ */
+
+#include <gtest/gtest.h>
+#include <string.h>
+#include <random>
+#include <string>
+#include <vector>
+#include "emulator/PimFunctionalSimulator.h"
+#include "emulator/PimSimBackend.h"
+
+using namespace pim::runtime::emulator;
+using namespace pim::runtime::executor;
+using half_float::half;
+
+#define REG_ROW (0x3fff)
+
+/* builds the coalesced trace the PIM kernels would record, one 32B record per column command */
+class TraceBuilder
+{
+   public:
+    TraceBuilder(PimFunctionalSimulator* sim) : sim_(sim) {}
+
+    uint64_t addr(uint32_t chan, uint32_t bg, uint32_t bank, uint32_t row, uint32_t col)
+    {
+        PimFuncAddr fa = {chan, 0, bg, bank, row, col, 0};
+        return sim_->encode_addr(fa);
+    }
+
+    void write(uint64_t addr, const void* data)
+    {
+        PimMemTraceData trace;
+        memset(&trace, 0, sizeof(trace));
+        if (data != nullptr) memcpy(trace.data, data, sizeof(trace.data));
+        trace.addr = addr;
+        trace.cmd = 'W';
+        traces.push_back(trace);
+    }
+
+    void read(uint64_t addr)
+    {
+        PimMemTraceData trace;
+        memset(&trace, 0, sizeof(trace));
+        trace.addr = addr;
+        trace.cmd = 'R';
+        traces.push_back(trace);
+    }
+
+    void program_crf(uint32_t chan, const std::vector<PimCommand>& cmds)
+    {
+        uint32_t crf[32] = {0};
+        for (size_t i = 0; i < cmds.size(); i++) crf[i] = cmds[i].to_int();
+        for (int i = 0; i < 4; i++) write(addr(chan, 0, 1, REG_ROW, 0x4 + i), crf + i * 8);
+    }
+
+    void set_pim_mode(uint32_t chan, bool on, bool zero_grf_b = false)
+    {
+        uint8_t ctrl[32] = {0};
+        ctrl[0] = on ? 1 : 0;
+        ctrl[21] = zero_grf_b ? 1 : 0;
+        write(addr(chan, 0, 0, REG_ROW, 0x0), ctrl);
+    }
+
+    std::vector<PimMemTraceData> traces;
+
+   private:
+    PimFunctionalSimulator* sim_;
+};
+
+static std::vector<half> random_half(size_t num, float lo, float hi, int seed)
+{
+    std::mt19937 gen(seed);
+    std::uniform_real_distribution<float> dist(lo, hi);
+    std::vector<half> data(num);
+    for (auto& d : data) d = half(dist(gen));
+    return data;
+}
+
+TEST(UnitTest, FunctionalSimulator_AddrRoundTrip)
+{
+    PimFunctionalSimulator sim;
+    std::mt19937_64 gen(7);
+
+    for (int i = 0; i < 1000; i++) {
+        uint64_t addr = gen() & ((1ULL << 40) - 1) & ~31ULL;
+        EXPECT_EQ(sim.encode_addr(sim.decode_addr(addr)), addr);
+    }
+
+    PimFuncAddr fa = sim.decode_addr(sim.encode_addr({63, 0, 3, 2, 0x3fff, 0x1f, 0}));
+    EXPECT_EQ(fa.chan, 63u);
+    EXPECT_EQ(fa.bg, 3u);
+    EXPECT_EQ(fa.bank, 2u);
+    EXPECT_EQ(fa.row, 0x3fffu);
+    EXPECT_EQ(fa.col, 0x1fu);
+}
+
+/* elt_add of num_tile tiles, same program and access order as the PIM kernel */
+static void make_elt_add_trace(TraceBuilder* tb, const uint64_t* base, int num_tile)
+{
+    std::vector<PimCommand> cmds{
+        PimCommand(PimCmdType::FILL, PimOpdType::GRF_A, PimOpdType::EVEN_BANK),
+        PimCommand(PimCmdType::ADD, PimOpdType::GRF_A, PimOpdType::GRF_A, PimOpdType::EVEN_BANK, 1),
+        PimCommand(PimCmdType::NOP, 23),
+        PimCommand(PimCmdType::FILL, PimOpdType::GRF_B, PimOpdType::ODD_BANK),
+        PimCommand(PimCmdType::ADD, PimOpdType::GRF_B, PimOpdType::GRF_B, PimOpdType::ODD_BANK, 1),
+        PimCommand(PimCmdType::NOP, 23),
+        PimCommand(PimCmdType::JUMP, num_tile - 1, 7),
+        PimCommand(PimCmdType::EXIT, 0)};
+
+    for (uint32_t ch = 0; ch < 64; ch++) {
+        tb->program_crf(ch, cmds);
+        tb->set_pim_mode(ch, true);
+        for (int t = 0; t < num_tile; t++) {
+            for (uint32_t bank = 0; bank < 2; bank++) {
+                for (int g = 0; g < 8; g++) tb->read(base[0] + tb->addr(ch, 0, bank, 0, t * 8 + g));
+                for (int g = 0; g < 8; g++) tb->read(base[1] + tb->addr(ch, 0, bank, 0, t * 8 + g));
+                for (int g = 0; g < 8; g++) {
+                    tb->write(base[2] + tb->addr(ch, 0, bank, 0, t * 8 + g), nullptr);
+                    tb->write(base[2] + tb->addr(ch, 0, bank, 0, t * 8 + g), nullptr);
+                    tb->read(base[2] + tb->addr(ch, 0, bank, 0, t * 8 + g));
+                }
+            }
+        }
+        tb->set_pim_mode(ch, false);
+    }
+}
+
+TEST(UnitTest, FunctionalSimulator_EltAdd)
+{
+    PimFunctionalSimulator sim;
+    TraceBuilder tb(&sim);
+    int num_tile = 3;
+    /* one tile covers eight columns of every bank of every channel */
+    size_t num_elem = (size_t)num_tile * 256 * 1024 / sizeof(half);
+    uint64_t base[3] = {1ULL << 36, 2ULL << 36, 3ULL << 36};
+
+    sim.initialize();
+    std::vector<half> in0 = random_half(num_elem, -4.0f, 4.0f, 1);
+    std::vector<half> in1 = random_half(num_elem, -4.0f, 4.0f, 2);
+    sim.preload_data_with_addr(base[0], in0.data(), num_elem * sizeof(half));
+    sim.preload_data_with_addr(base[1], in1.data(), num_elem * sizeof(half));
+    make_elt_add_trace(&tb, base, num_tile);
+    sim.execute_kernel(tb.traces.data(), tb.traces.size());
+
+    std::vector<half> out(num_elem);
+    sim.read_result((uint16_t*)out.data(), base[2], num_elem * sizeof(half));
+    int num_mismatch = 0;
+    for (size_t i = 0; i < num_elem; i++) {
+        half expected = in0[i] + in1[i];
+        if (memcmp(&out[i], &expected, sizeof(half)) != 0) num_mismatch++;
+    }
+    EXPECT_EQ(num_mismatch, 0);
+}
+
+TEST(UnitTest, FunctionalSimulator_Gemv)
+{
+    PimFunctionalSimulator sim;
+    TraceBuilder tb(&sim);
+    /* two input tiles of 128 and one output tile */
+    int in_dim = 256;
+    int out_dim = 8 * 8 * 64;
+    uint64_t w_base = 1ULL << 36;
+    uint64_t out_base = 2ULL << 36;
+
+    sim.initialize();
+    std::vector<half> weight = random_half((size_t)out_dim * in_dim, -1.0f, 1.0f, 3);
+    std::vector<half> input = random_half(in_dim, -1.0f, 1.0f, 4);
+
+    /* emulator layout of PimGemmWeightReorder, column c of the row pair holds output c % 8 and chunk c / 8 */
+    for (uint32_t ch = 0; ch < 64; ch++) {
+        for (int pb = 0; pb < 8; pb++) {
+            for (int x = 0; x < 2; x++) {
+                for (int c = 0; c < 64; c++) {
+                    int out = (ch * 8 + pb) * 8 + c % 8;
+                    int chunk = x * 8 + c / 8;
+                    uint64_t addr = w_base + tb.addr(ch, pb / 2, (pb % 2) * 2 + x, c / 32, c % 32);
+                    sim.preload_data_with_addr(addr, &weight[(size_t)out * in_dim + chunk * 16], 32);
+                }
+            }
+        }
+    }
+
+    std::vector<PimCommand> cmds{
+        PimCommand(PimCmdType::MAC, PimOpdType::GRF_B, PimOpdType::GRF_A, PimOpdType::EVEN_BANK, 1, 0, 0, 0),
+        PimCommand(PimCmdType::JUMP, 7, 2),
+        PimCommand(PimCmdType::MAC, PimOpdType::GRF_B, PimOpdType::GRF_A, PimOpdType::ODD_BANK, 1, 0, 0, 0),
+        PimCommand(PimCmdType::JUMP, 7, 2), PimCommand(PimCmdType::NOP, 23), PimCommand(PimCmdType::EXIT, 0)};
+
+    for (uint32_t ch = 0; ch < 64; ch++) {
+        tb.program_crf(ch, cmds);
+        tb.set_pim_mode(ch, true, true);
+        for (uint32_t x = 0; x < 2; x++) {
+            for (int g = 0; g < 8; g++) tb.write(tb.addr(ch, 0, x, REG_ROW, 0x8 + g), &input[(x * 8 + g) * 16]);
+            for (int g = 0; g < 8; g++) {
+                for (int r = 0; r < 2; r++) {
+                    for (int c = g; c < 32; c += 8) tb.read(w_base + tb.addr(ch, 0, x, r, c));
+                }
+            }
+        }
+        for (int g = 0; g < 8; g++) {
+            tb.write(out_base + tb.addr(ch, 0, 1, 0, g), nullptr);
+            tb.write(out_base + tb.addr(ch, 0, 1, 0, g), nullptr);
+            tb.read(out_base + tb.addr(ch, 0, 1, 0, g));
+        }
+        tb.set_pim_mode(ch, false);
+    }
+    sim.execute_kernel(tb.traces.data(), tb.traces.size());
+
+    std::vector<half> out(out_dim);
+    sim.read_result_gemv((uint16_t*)out.data(), out_base, out_dim);
+
+    int num_mismatch = 0;
+    for (int o = 0; o < out_dim; o++) {
+        /* the lanes accumulate in chunk order with FP16 rounding, then the lanes are summed */
+        half lanes[16];
+        for (int l = 0; l < 16; l++) lanes[l] = half(0.0f);
+        for (int k = 0; k < in_dim / 16; k++) {
+            for (int l = 0; l < 16; l++) lanes[l] += input[k * 16 + l] * weight[(size_t)o * in_dim + k * 16 + l];
+        }
+        half expected(0.0f);
+        for (int l = 0; l < 16; l++) expected += lanes[l];
+        if (memcmp(&out[o], &expected, sizeof(half)) != 0) num_mismatch++;
+    }
+    EXPECT_EQ(num_mismatch, 0);
+}
+
+TEST(UnitTest, SimBackend_ChannelParallel)
+{
+    PimFunctionalSimulator addr_sim;
+    TraceBuilder tb(&addr_sim);
+    int num_tile = 2;
+    size_t num_elem = (size_t)num_tile * 256 * 1024 / sizeof(half);
+    uint64_t base[3] = {0, num_elem * sizeof(half), 2 * num_elem * sizeof(half)};
+    std::vector<half> in0 = random_half(num_elem, -4.0f, 4.0f, 5);
+    std::vector<half> in1 = random_half(num_elem, -4.0f, 4.0f, 6);
+    make_elt_add_trace(&tb, base, num_tile);
+
+    /* the prebuilt simulator, the worker instances twice, then the functional model */
+    const char* num_threads[] = {"1", "3", "3"};
+    std::vector<std::vector<half>> outs;
+    std::vector<uint64_t> cycles;
+    std::string rocm_path = ROCM_PATH;
+    for (int i = 0; i < 4; i++) {
+        PimSimBackend backend;
+        if (i < 3) {
+            setenv("PIM_EMULATOR_NUM_THREADS", num_threads[i], 1);
+        } else {
+            setenv("PIM_EMULATOR_MODE", "functional", 1);
+        }
+        backend.initialize(rocm_path + "/include/dramsim2/ini/HBM2_samsung_2M_16B_x64.ini",
+                           rocm_path + "/include/dramsim2/ini/system_hbm_vega20.ini", 256 * 64 * 2, 64, 1);
+        unsetenv("PIM_EMULATOR_NUM_THREADS");
+        unsetenv("PIM_EMULATOR_MODE");
+        EXPECT_EQ(backend.get_mode(), (i < 3) ? EMULATOR_TIMING : EMULATOR_FUNCTIONAL);
+        if (i < 3) EXPECT_EQ(backend.get_num_sims(), atoi(num_threads[i]));
+
+        EXPECT_EQ(backend.preload_data_with_addr(base[0], in0.data(), num_elem * sizeof(half)), 0);
+        EXPECT_EQ(backend.preload_data_with_addr(base[1], in1.data(), num_elem * sizeof(half)), 0);
+        EXPECT_EQ(backend.execute_kernel(tb.traces.data(), tb.traces.size()), 0);
+        cycles.push_back(backend.get_kernel_cycle());
+        EXPECT_EQ(backend.get_cycle(), cycles.back());
+        outs.emplace_back(num_elem);
+        EXPECT_EQ(backend.read_result((uint16_t*)outs.back().data(), base[2], num_elem * sizeof(half)), 0);
+    }
+
+    for (int i = 1; i < 4; i++) EXPECT_EQ(memcmp(outs[0].data(), outs[i].data(), num_elem * sizeof(half)), 0);
+    /* only the worker instances count cycles, and the worker processes do not make them depend on scheduling */
+    EXPECT_EQ(cycles[0], 0);
+    EXPECT_GT(cycles[1], 0);
+    EXPECT_EQ(cycles[1], cycles[2]);
+    EXPECT_EQ(cycles[3], 0);
+}
+
+TEST(UnitTest, SimBackend_ChunkedTrace)
+{
+    PimFunctionalSimulator addr_sim;
+    TraceBuilder tb(&addr_sim);
+    int num_tile = 2;
+    size_t num_elem = (size_t)num_tile * 256 * 1024 / sizeof(half);
+    uint64_t base[3] = {0, num_elem * sizeof(half), 2 * num_elem * sizeof(half)};
+    std::vector<half> in0 = random_half(num_elem, -4.0f, 4.0f, 7);
+    std::vector<half> in1 = random_half(num_elem, -4.0f, 4.0f, 8);
+    make_elt_add_trace(&tb, base, num_tile);
+
+    /* the executor copies the trace channel by channel, a chunk is the records of 8 channels */
+    std::vector<size_t> chunk_end;
+    for (size_t i = 0; i < tb.traces.size(); i++) {
+        uint32_t chunk = addr_sim.decode_addr(tb.traces[i].addr).chan / 8;
+        if (i + 1 == tb.traces.size() || addr_sim.decode_addr(tb.traces[i + 1].addr).chan / 8 != chunk) {
+            chunk_end.push_back(i + 1);
+        }
+    }
+    ASSERT_EQ(chunk_end.size(), 8u);
+
+    std::string rocm_path = ROCM_PATH;
+    for (const char* mode : {"timing", "functional"}) {
+        std::vector<std::vector<half>> outs;
+        std::vector<uint64_t> cycles;
+        for (int chunked = 0; chunked < 2; chunked++) {
+            PimSimBackend backend;
+            /* two instances, since only the worker instances count cycles */
+            setenv("PIM_EMULATOR_MODE", mode, 1);
+            setenv("PIM_EMULATOR_NUM_THREADS", "2", 1);
+            backend.initialize(rocm_path + "/include/dramsim2/ini/HBM2_samsung_2M_16B_x64.ini",
+                               rocm_path + "/include/dramsim2/ini/system_hbm_vega20.ini", 256 * 64 * 2, 64, 1);
+            unsetenv("PIM_EMULATOR_MODE");
+            unsetenv("PIM_EMULATOR_NUM_THREADS");
+
+            backend.preload_data_with_addr(base[0], in0.data(), num_elem * sizeof(half));
+            backend.preload_data_with_addr(base[1], in1.data(), num_elem * sizeof(half));
+            if (chunked) {
+                size_t begin = 0;
+                for (size_t end : chunk_end) {
+                    backend.execute_kernel(&tb.traces[begin], end - begin);
+                    begin = end;
+                }
+            } else {
+                backend.execute_kernel(tb.traces.data(), tb.traces.size());
+            }
+            cycles.push_back(backend.get_cycle());
+            outs.emplace_back(num_elem);
+            backend.read_result((uint16_t*)outs.back().data(), base[2], num_elem * sizeof(half));
+        }
+        EXPECT_EQ(memcmp(outs[0].data(), outs[1].data(), num_elem * sizeof(half)), 0) << mode;
+        /* simulated one after another, the chunks can only take longer than the whole kernel */
+        EXPECT_LE(cycles[0], cycles[1]) << mode;
+    }
+}
@@ -0,0 +1,728 @@
+/*
+ * Copyright (C) 2022 Samsung Electronics Co. LTD
+ *
+ * This software is a property of Samsung Electronics.
+ * No part of this software, either material or conceptual may be copied or distributed, transmitted,
+ * transcribed, stored in a retrieval system or translated into any human or computer language in any form by any means,
+ * electronic, mechanical, manual or otherwise, or disclosed
+ * to third parties without the express written permission of Samsung Electronics.
+ * (Use of the Software is restricted to non-commercial, personal or academic, research purpose only)
+ */
+
+#include <gtest/gtest.h>
+#include <string.h>
+#include <chrono>
+#include <vector>
+#include "manager/PimGemmWeightReorder.h"
+#include "manager/cpu/CpuMemoryManager.h"
+#include "utility/pim_util.h"
+
+using namespace pim::runtime::manager;
+
+static PimBlockInfo test_pbi = vega20_pbi;
+static PimBlockInfo* pbi_ = &test_pbi;
+
+/* per-transfer walk the reorder engine replaces, kept as the byte-exact reference */
+static int ref_chwise_gemm_weight(PimBo* dst, PimBo* src, PimGemmOrder gemm_order_)
+{
+    int ret = 0;
+
+    int num_grf_A = pbi_->num_grf;
+    int num_grf_B = pbi_->num_grf;
+    int num_pim_blocks = pbi_->num_pim_blocks;
+    int num_pim_chan = pbi_->num_pim_chan;
+    int num_pim_rank = pbi_->num_pim_rank;
+    int num_banks = pbi_->num_banks;
+    int num_bank_groups = pbi_->num_bank_groups;
+    int trans_size = pbi_->trans_size;
+
+    char* dst_data = nullptr;
+    char* src_data = nullptr;
+
+    int cidx = 0;
+    int rank = 0;
+    int bg = 0;
+    int bank = 0;
+    uint32_t col = 0;
+    uint32_t row = 0;
+    uint64_t addr = 0;
+    uint32_t even_s_row = 0;  // starting_row;
+    uint32_t even_s_col = 0;  // starting_col;
+    uint32_t odd_s_row = 0;   // starting_row;
+    uint32_t odd_s_col = 0;   // starting_col;
+
+    int type_size = (src->precision == PIM_FP16) ? 2 : 1;
+
+    int in_tile_size = num_grf_A;
+    int out_tile_size = num_grf_B * num_pim_blocks * num_pim_chan * num_pim_rank;
+    int data_offset = 0;
+
+    int iter_cnt = 0;
+    int in_cnt = 0;
+
+    if (gemm_order_ == I_X_W) {
+        iter_cnt = src->bshape.n * src->bshape.c * src->bshape.w / PIM_GEMV_OUT_ALIGN;
+        in_cnt = src->bshape.h * type_size / trans_size;
+    } else {
+        iter_cnt = src->bshape.n * src->bshape.c * src->bshape.h / PIM_GEMV_OUT_ALIGN;
+        in_cnt = src->bshape.w * type_size / trans_size;
+    }
+
+    for (int iter = 0; iter < iter_cnt; iter++) {
+        cidx = 0;
+        rank = 0;
+        bg = 0;
+        bank = 0;
+        col = 0;
+        row = 0;
+        addr = 0;
+        even_s_row = 0;
+        even_s_col = 0;
+        odd_s_row = 0;
+        odd_s_col = 0;
+        dst_data = (char*)dst->data + data_offset;
+        src_data = (char*)src->data + data_offset;
+
+        for (int x = 0; x < in_cnt; x += in_tile_size) {
+            if ((x / in_tile_size) % 2 == 0) {
+                for (int tiled_y = 0; tiled_y < out_tile_size; tiled_y += num_grf_B) {
+                    col = even_s_col;
+                    row = even_s_row;
+
+                    for (int grfb_idx = 0; grfb_idx < num_grf_B; grfb_idx++) {
+                        for (int grfa_idx = 0; grfa_idx < num_grf_A; grfa_idx++) {
+                            addr = addr_gen_safe(cidx, rank, bg, bank, row, col);
+#ifdef EMULATOR
+                            int d_idx = (tiled_y + grfa_idx) * in_cnt + x + grfb_idx;
+#else
+                            int d_idx = (tiled_y + grfb_idx) * in_cnt + x + grfa_idx;
+#endif
+                            memcpy(dst_data + addr, src_data + d_idx * trans_size, trans_size);
+                            col++;
+                        }
+                    }
+
+                    bank += (num_banks / num_pim_blocks);
+
+                    if (bank >= (num_banks / num_bank_groups)) {
+                        bg++;
+                        bank = 0;
+                    }
+
+                    if (bg >= num_bank_groups) {
+                        bg = 0;
+                        rank++;
+                    }
+
+                    if (rank >= num_pim_rank) {
+                        rank = 0;
+                        cidx++;
+                    }
+
+                    if (cidx >= num_pim_chan) {
+                        cidx = 0;
+                        even_s_row = row;
+                        even_s_col = col;
+                    }
+                }
+            } else if ((x / in_tile_size) % 2 == 1) {
+                for (int tiled_y = 0; tiled_y < out_tile_size; tiled_y += num_grf_B) {
+                    col = odd_s_col;
+                    row = odd_s_row;
+
+                    for (int grfb_idx = 0; grfb_idx < num_grf_B; grfb_idx++) {
+                        for (int grfa_idx = 0; grfa_idx < num_grf_A; grfa_idx++) {
+                            addr = addr_gen_safe(cidx, rank, bg, bank + 1, row, col);
+#ifdef EMULATOR
+                            int d_idx = (tiled_y + grfa_idx) * in_cnt + x + grfb_idx;
+#else
+                            int d_idx = (tiled_y + grfb_idx) * in_cnt + x + grfa_idx;
+#endif
+                            memcpy(dst_data + addr, src_data + d_idx * trans_size, trans_size);
+                            col++;
+                        }
+                    }
+
+                    bank += (num_banks / num_pim_blocks);
+
+                    if (bank >= (num_banks / num_bank_groups)) {
+                        bg++;
+                        bank = 0;
+                    }
+
+                    if (bg >= num_bank_groups) {
+                        bg = 0;
+                        rank++;
+                    }
+
+                    if (rank >= num_pim_rank) {
+                        rank = 0;
+                        cidx++;
+                    }
+
+                    if (cidx >= num_pim_chan) {
+                        cidx = 0;
+                        odd_s_row = row;
+                        odd_s_col = col;
+                    }
+                }
+            }
+        }
+        data_offset += (src->bshape.h * PIM_GEMV_OUT_ALIGN * sizeof(half));
+    }
+    dst->data_layout_type = PimDataLayoutType::CHWISE_GEMM_WEIGHT;
+
+    return ret;
+}
+
+static int ref_aligned_gemm_weight(PimBo* dst, PimBo* src, PimGemmOrder gemm_order_)
+{
+    int ret = 0;
+    int num_grf_A = pbi_->num_grf;
+    int num_grf_B = pbi_->num_grf;
+    int num_pim_blocks = pbi_->num_pim_blocks;
+    int num_pim_chan = pbi_->num_pim_chan;
+    int num_pim_rank = pbi_->num_pim_rank;
+    int num_banks = pbi_->num_banks;
+    int num_bank_groups = pbi_->num_bank_groups;
+    int trans_size = pbi_->trans_size;
+
+    int in_tile_size = num_grf_A;
+    int out_tile_size = num_grf_B * num_pim_blocks * num_pim_chan * num_pim_rank;
+    char* dst_data = nullptr;
+    char* src_data = nullptr;
+    int data_offset = 0;
+    int iter_cnt = src->bshape.n * src->bshape.c;
+
+    int cidx = 0;
+    int rank = 0;
+    int bg = 0;
+    int bank = 0;
+    uint32_t col = 0;
+    uint32_t row = 0;
+    uint64_t addr = 0;
+    uint32_t even_s_row = 0;  // starting_row;
+    uint32_t even_s_col = 0;  // starting_col;
+    uint32_t odd_s_row = 0;   // starting_row;
+    uint32_t odd_s_col = 0;   // starting_col;
+
+    int type_size = (src->precision == PIM_FP16) ? 2 : 1;
+
+    int out_cnt = 0;
+    int in_cnt = 0;
+
+    if (gemm_order_ == I_X_W) {
+        out_cnt = src->bshape.w;
+        in_cnt = src->bshape.h * type_size / trans_size;
+    } else {
+        out_cnt = src->bshape.h;
+        in_cnt = src->bshape.w * type_size / trans_size;
+    }
+
+    for (int iter = 0; iter < iter_cnt; iter++) {
+        cidx = 0;
+        rank = 0;
+        bg = 0;
+        bank = 0;
+        col = 0;
+        row = 0;
+        addr = 0;
+        even_s_row = 0;
+        even_s_col = 0;
+        odd_s_row = 0;
+        odd_s_col = 0;
+        dst_data = (char*)dst->data + data_offset;
+        src_data = (char*)src->data + data_offset;
+
+        for (int y = 0; y < out_cnt; y += out_tile_size) {
+            for (int x = 0; x < in_cnt; x += in_tile_size) {
+                if ((x / in_tile_size) % 2 == 0) {
+                    for (int tiled_y = 0; tiled_y < out_tile_size; tiled_y += num_grf_B) {
+                        col = even_s_col;
+                        row = even_s_row;
+
+                        for (int grfb_idx = 0; grfb_idx < num_grf_B; grfb_idx++) {
+                            for (int grfa_idx = 0; grfa_idx < num_grf_A; grfa_idx++) {
+                                addr = addr_gen_safe(cidx, rank, bg, bank, row, col);
+#ifdef EMULATOR
+                                int d_idx = (y + tiled_y + grfa_idx) * in_cnt + x + grfb_idx;
+#else
+                                int d_idx = (y + tiled_y + grfb_idx) * in_cnt + x + grfa_idx;
+#endif
+                                memcpy(dst_data + addr, src_data + d_idx * trans_size, trans_size);
+                                col++;
+                            }
+                        }
+
+                        bank += (num_banks / num_pim_blocks);
+
+                        if (bank >= (num_banks / num_bank_groups)) {
+                            bg++;
+                            bank = 0;
+                        }
+
+                        if (bg >= num_bank_groups) {
+                            bg = 0;
+                            rank++;
+                        }
+
+                        if (rank >= num_pim_rank) {
+                            rank = 0;
+                            cidx++;
+                        }
+
+                        if (cidx >= num_pim_chan) {
+                            cidx = 0;
+                            even_s_row = row;
+                            even_s_col = col;
+                        }
+                    }
+                } else if ((x / in_tile_size) % 2 == 1) {
+                    for (int tiled_y = 0; tiled_y < out_tile_size; tiled_y += num_grf_B) {
+                        col = odd_s_col;
+                        row = odd_s_row;
+
+                        for (int grfb_idx = 0; grfb_idx < num_grf_B; grfb_idx++) {
+                            for (int grfa_idx = 0; grfa_idx < num_grf_A; grfa_idx++) {
+                                addr = addr_gen_safe(cidx, rank, bg, bank + 1, row, col);
+#ifdef EMULATOR
+                                int d_idx = (y + tiled_y + grfa_idx) * in_cnt + x + grfb_idx;
+#else
+                                int d_idx = (y + tiled_y + grfb_idx) * in_cnt + x + grfa_idx;
+#endif
+                                memcpy(dst_data + addr, src_data + d_idx * trans_size, trans_size);
+                                col++;
+                            }
+                        }
+
+                        bank += (num_banks / num_pim_blocks);
+
+                        if (bank >= (num_banks / num_bank_groups)) {
+                            bg++;
+                            bank = 0;
+                        }
+
+                        if (bg >= num_bank_groups) {
+                            bg = 0;
+                            rank++;
+                        }
+
+                        if (rank >= num_pim_rank) {
+                            rank = 0;
+                            cidx++;
+                        }
+
+                        if (cidx >= num_pim_chan) {
+                            cidx = 0;
+                            odd_s_row = row;
+                            odd_s_col = col;
+                        }
+                    }
+                }
+            }
+        }
+        data_offset += (src->bshape.h * src->bshape.w * sizeof(half));
+    }
+    dst->data_layout_type = PimDataLayoutType::ALIGNED_GEMM_WEIGHT;
+
+    return ret;
+}
+
+static PimBo make_weight(int n, int c, int h, int w, void* data)
+{
+    PimBo bo;
+    memset(&bo, 0, sizeof(bo));
+    bo.bshape = {(uint32_t)n, (uint32_t)c, (uint32_t)h, (uint32_t)w};
+    bo.bshape_r = bo.bshape;
+    bo.precision = PIM_FP16;
+    bo.size = (size_t)n * c * h * w * sizeof(uint16_t);
+    bo.mem_type = MEM_TYPE_HOST;
+    bo.data = data;
+    return bo;
+}
+
+static void test_reorder(int n, int c, int h, int w, PimGemmOrder gemm_order, bool is_chwise)
+{
+    size_t size = (size_t)n * c * h * w * sizeof(uint16_t);
+    std::vector<char> src(size), ref(size, 0x5a), out(size, 0x5a);
+    for (size_t i = 0; i < size; i++) src[i] = (char)(i * 131 + i / 7);
+
+    PimBo src_bo = make_weight(n, c, h, w, src.data());
+    PimBo ref_bo = make_weight(n, c, h, w, ref.data());
+    PimGemmWeightReorder reorder(pbi_);
+
+    if (is_chwise) {
+        ref_chwise_gemm_weight(&ref_bo, &src_bo, gemm_order);
+    } else {
+        ref_aligned_gemm_weight(&ref_bo, &src_bo, gemm_order);
+    }
+    int ret = is_chwise ? reorder.reorder_chwise(out.data(), size, src.data(), &src_bo, gemm_order)
+                        : reorder.reorder_aligned(out.data(), size, src.data(), &src_bo, gemm_order);
+    EXPECT_EQ(ret, 0);
+    EXPECT_EQ(memcmp(ref.data(), out.data(), size), 0);
+
+    /* restoring the reordered weight gives back the source */
+    std::vector<char> back(size, 0x5a);
+    ret = is_chwise ? reorder.restore_chwise(back.data(), &src_bo, out.data(), size, gemm_order)
+                    : reorder.restore_aligned(back.data(), &src_bo, out.data(), size, gemm_order);
+    EXPECT_EQ(ret, 0);
+    EXPECT_EQ(memcmp(src.data(), back.data(), size), 0);
+}
+
+TEST(UnitTest, GemmWeightReorder_Aligned_IxW) { test_reorder(1, 1, 1024, 4096, I_X_W, false); }
+TEST(UnitTest, GemmWeightReorder_Aligned_IxW_Batch) { test_reorder(2, 1, 256, 4096, I_X_W, false); }
+TEST(UnitTest, GemmWeightReorder_Aligned_WxI) { test_reorder(1, 1, 4096, 1024, W_X_I, false); }
+TEST(UnitTest, GemmWeightReorder_Chwise_IxW) { test_reorder(1, 4, 1024, 1024, I_X_W, true); }
+TEST(UnitTest, GemmWeightReorder_Chwise_WxI) { test_reorder(1, 8, 512, 256, W_X_I, true); }
+
+/* benchmark, run with --gtest_also_run_disabled_tests */
+TEST(UnitTest, DISABLED_GemmWeightReorder_Aligned_Latency)
+{
+    const int h = 4096;
+    const int w = 4096;
+    size_t size = (size_t)h * w * sizeof(uint16_t);
+    std::vector<char> src(size), ref(size), out(size);
+    for (size_t i = 0; i < size; i++) src[i] = (char)(i * 131 + i / 7);
+
+    PimBo src_bo = make_weight(1, 1, h, w, src.data());
+    PimBo ref_bo = make_weight(1, 1, h, w, ref.data());
+    PimGemmWeightReorder reorder(pbi_);
+
+    auto start = std::chrono::high_resolution_clock::now();
+    ref_aligned_gemm_weight(&ref_bo, &src_bo, I_X_W);
+    auto mid = std::chrono::high_resolution_clock::now();
+    reorder.reorder_aligned(out.data(), size, src.data(), &src_bo, I_X_W);
+    auto end = std::chrono::high_resolution_clock::now();
+
+    std::chrono::duration<double, std::milli> ref_time = mid - start;
+    std::chrono::duration<double, std::milli> time = end - mid;
+    std::cout << h << "x" << w << " reference: " << ref_time.count() << " ms, engine: " << time.count() << " ms"
+              << std::endl;
+}
+
+TEST(UnitTest, GemmWeightReorder_Out_Of_Bounds)
+{
+    /* a destination smaller than the layout is reported instead of overrun */
+    std::vector<char> src(1024 * 4096 * sizeof(uint16_t)), out(src.size() / 2);
+    PimBo src_bo = make_weight(1, 1, 1024, 4096, src.data());
+    PimGemmWeightReorder reorder(pbi_);
+
+    EXPECT_NE(reorder.reorder_aligned(out.data(), out.size(), src.data(), &src_bo, I_X_W), 0);
+}
+
+static void test_reorder_transposed(int n, int c, int h, int w, PimGemmOrder gemm_order, bool is_chwise)
+{
+    /* the stored [in][out] weight is reordered as transpose_pimbo followed by the reorder would do it */
+    size_t size = (size_t)n * c * h * w * sizeof(uint16_t);
+    std::vector<char> stored(size), raw(size), ref(size, 0x5a), out(size, 0x5a);
+    for (size_t i = 0; i < size; i++) stored[i] = (char)(i * 131 + i / 7);
+    transpose_fp16(raw.data(), stored.data(), (size_t)n * c, h, w);
+
+    PimBo bo = make_weight(n, c, h, w, raw.data());
+    PimGemmWeightReorder reorder(pbi_);
+    int ret = is_chwise ? reorder.reorder_chwise(ref.data(), size, raw.data(), &bo, gemm_order)
+                        : reorder.reorder_aligned(ref.data(), size, raw.data(), &bo, gemm_order);
+    ASSERT_EQ(ret, 0);
+
+    ret = is_chwise ? reorder.reorder_chwise(out.data(), size, stored.data(), &bo, gemm_order, true)
+                    : reorder.reorder_aligned(out.data(), size, stored.data(), &bo, gemm_order, true);
+    EXPECT_EQ(ret, 0);
+    EXPECT_EQ(memcmp(ref.data(), out.data(), size), 0);
+
+    std::vector<char> back(size, 0x5a);
+    ret = is_chwise ? reorder.restore_chwise(back.data(), &bo, out.data(), size, gemm_order, true)
+                    : reorder.restore_aligned(back.data(), &bo, out.data(), size, gemm_order, true);
+    EXPECT_EQ(ret, 0);
+    EXPECT_EQ(memcmp(stored.data(), back.data(), size), 0);
+}
+
+TEST(UnitTest, GemmWeightReorder_Transposed_Aligned_IxW) { test_reorder_transposed(1, 1, 1024, 4096, I_X_W, false); }
+TEST(UnitTest, GemmWeightReorder_Transposed_Aligned_IxW_Batch)
+{
+    test_reorder_transposed(2, 1, 256, 4096, I_X_W, false);
+}
+TEST(UnitTest, GemmWeightReorder_Transposed_Chwise_IxW) { test_reorder_transposed(1, 4, 1024, 1024, I_X_W, true); }
+TEST(UnitTest, GemmWeightReorder_Transposed_Aligned_WxI)
+{
+    /* W_X_I rows run along w, so a row is a run of a stored column which may end inside the row */
+    test_reorder_transposed(1, 1, 4096, 1024, W_X_I, false);
+    test_reorder_transposed(1, 1, 4096, 3072, W_X_I, false);
+}
+TEST(UnitTest, GemmWeightReorder_Transposed_Chwise_WxI) { test_reorder_transposed(1, 8, 512, 256, W_X_I, true); }
+
+/* benchmark, run with --gtest_also_run_disabled_tests */
+TEST(UnitTest, DISABLED_GemmWeightReorder_Transposed_Latency)
+{
+    const int h = 4096;
+    const int w = 4096;
+    size_t size = (size_t)h * w * sizeof(uint16_t);
+    std::vector<char> stored(size), raw(size), out(size);
+    for (size_t i = 0; i < size; i++) stored[i] = (char)(i * 131 + i / 7);
+
+    PimBo bo = make_weight(1, 1, h, w, raw.data());
+    PimGemmWeightReorder reorder(pbi_);
+
+    auto start = std::chrono::high_resolution_clock::now();
+    transpose_fp16(raw.data(), stored.data(), 1, h, w);
+    reorder.reorder_aligned(out.data(), size, raw.data(), &bo, I_X_W);
+    auto mid = std::chrono::high_resolution_clock::now();
+    reorder.reorder_aligned(out.data(), size, stored.data(), &bo, I_X_W, true);
+    auto end = std::chrono::high_resolution_clock::now();
+
+    std::chrono::duration<double, std::milli> split_time = mid - start;
+    std::chrono::duration<double, std::milli> time = end - mid;
+    std::cout << h << "x" << w << " transpose then reorder: " << split_time.count()
+              << " ms, transposed source: " << time.count() << " ms" << std::endl;
+}
+
+TEST(UnitTest, GemmWeightReorder_Transpose_Fp16)
+{
+    /* edges of the 64x64 tiles and of the 8x8 vector blocks */
+    int batch = 3, row = 67, col = 1029;
+    std::vector<uint16_t> in((size_t)batch * row * col), out(in.size()), ref(in.size());
+    for (size_t i = 0; i < in.size(); i++) in[i] = (uint16_t)(i * 2654435761u >> 7);
+
+    transpose_fp16(out.data(), in.data(), batch, row, col);
+    for (int b = 0; b < batch; b++) {
+        for (int r = 0; r < row; r++) {
+            for (int c = 0; c < col; c++) {
+                ref[(size_t)b * row * col + c * row + r] = in[(size_t)b * row * col + r * col + c];
+            }
+        }
+    }
+    EXPECT_EQ(out, ref);
+}
+
+static void test_reorder_tiled(int n, int c, int h, int w, PimGemmOrder gemm_order, bool is_chwise,
+                               bool src_transposed, size_t tile_size, size_t min_tiles)
+{
+    /* tiles staged one by one, as the preload pipeline does, give the same layout as a single reorder */
+    size_t size = (size_t)n * c * h * w * sizeof(uint16_t);
+    size_t pim_size = 2 * size; /* odd input tiles leave the rows of the odd banks behind */
+    std::vector<char> src(size), ref(pim_size, 0x5a), out(pim_size, 0x5a);
+    for (size_t i = 0; i < size; i++) src[i] = (char)(i * 131 + i / 7);
+
+    PimBo bo = make_weight(n, c, h, w, src.data());
+    PimGemmWeightReorder reorder(pbi_);
+    int ret = is_chwise ? reorder.reorder_chwise(ref.data(), pim_size, src.data(), &bo, gemm_order, src_transposed)
+                        : reorder.reorder_aligned(ref.data(), pim_size, src.data(), &bo, gemm_order, src_transposed);
+    ASSERT_EQ(ret, 0);
+
+    PimGemmWeightReorder::ReorderPlan plan;
+    ASSERT_EQ(reorder.plan_tiles(&bo, pim_size, gemm_order, is_chwise, src_transposed, tile_size, &plan), 0);
+    EXPECT_GE(plan.tiles.size(), min_tiles);
+
+    std::vector<char> src_stage(plan.max_raw_size), dst_stage(plan.max_pim_size);
+    uint64_t pim_end = 0;
+    for (size_t t = 0; t < plan.tiles.size(); t++) {
+        const PimGemmWeightReorder::ReorderTile& tile = plan.tiles[t];
+        EXPECT_GE(tile.pim_offset, pim_end);
+        EXPECT_EQ(tile.row_size * tile.num_rows, tile.raw_size);
+        pim_end = tile.pim_offset + tile.pim_size;
+
+        for (uint64_t r = 0; r < tile.num_rows; r++) {
+            memcpy(src_stage.data() + r * tile.row_size, src.data() + tile.src_offset + r * tile.src_pitch,
+                   tile.row_size);
+        }
+        if (!tile.covered) memcpy(dst_stage.data(), out.data() + tile.pim_offset, tile.pim_size);
+        ASSERT_EQ(reorder.reorder_tile(dst_stage.data(), src_stage.data(), plan, t), 0);
+        memcpy(out.data() + tile.pim_offset, dst_stage.data(), tile.pim_size);
+    }
+    EXPECT_EQ(memcmp(ref.data(), out.data(), pim_size), 0);
+}
+
+TEST(UnitTest, GemmWeightReorder_Tiled_Aligned_IxW) { test_reorder_tiled(1, 1, 256, 16384, I_X_W, false, false, 1, 4); }
+TEST(UnitTest, GemmWeightReorder_Tiled_Aligned_WxI)
+{
+    test_reorder_tiled(1, 2, 16384, 256, W_X_I, false, false, 4 << 20, 4);
+}
+TEST(UnitTest, GemmWeightReorder_Tiled_Chwise_IxW) { test_reorder_tiled(1, 8, 512, 2048, I_X_W, true, false, 1, 4); }
+TEST(UnitTest, GemmWeightReorder_Tiled_Transposed_Slab)
+{
+    /* sweeps are 4096 columns of one stored matrix */
+    test_reorder_tiled(2, 1, 256, 16384, I_X_W, false, true, 1, 8);
+}
+TEST(UnitTest, GemmWeightReorder_Tiled_Transposed_Whole)
+{
+    /* a sweep holds four stored matrices */
+    test_reorder_tiled(1, 8, 1024, 1024, I_X_W, true, true, 1, 2);
+}
+TEST(UnitTest, GemmWeightReorder_Tiled_Transposed_Straddle)
+{
+    /* a sweep ends inside a stored matrix, tiles grow to whole matrices */
+    test_reorder_tiled(1, 8, 256, 3072, I_X_W, true, true, 1, 2);
+}
+TEST(UnitTest, GemmWeightReorder_Tiled_Transposed_WxI)
+{
+    /* sweeps are whole columns of one stored matrix, or end inside a column and grow to whole matrices */
+    test_reorder_tiled(1, 2, 16384, 256, W_X_I, false, true, 1, 8);
+    test_reorder_tiled(1, 2, 12288, 256, W_X_I, false, true, 1, 2);
+}
+TEST(UnitTest, GemmWeightReorder_Tiled_Odd_Input_Tiles)
+{
+    /* odd banks take fewer rows than even ones, tiles sharing rows are merged */
+    test_reorder_tiled(1, 1, 384, 16384, I_X_W, false, false, 1, 1);
+    test_reorder_tiled(1, 1, 384, 16384, I_X_W, false, false, 4 << 20, 1);
+}
+
+static void test_block_bases(int n, int c, int h, int w, PimGemmOrder gemm_order, bool is_chwise)
+{
+    /* the transfers the device kernel moves from the block bases give the same layout as the host reorder */
+    size_t size = (size_t)n * c * h * w * sizeof(uint16_t);
+    size_t pim_size = 2 * size;
+    std::vector<char> src(size), ref(pim_size, 0x5a), out(pim_size, 0x5a);
+    for (size_t i = 0; i < size; i++) src[i] = (char)(i * 131 + i / 7);
+
+    PimBo bo = make_weight(n, c, h, w, src.data());
+    PimGemmWeightReorder reorder(pbi_);
+    int ret = is_chwise ? reorder.reorder_chwise(ref.data(), pim_size, src.data(), &bo, gemm_order)
+                        : reorder.reorder_aligned(ref.data(), pim_size, src.data(), &bo, gemm_order);
+    ASSERT_EQ(ret, 0);
+
+    int in_cnt = 0;
+    std::vector<PimGemmWeightReorder::BlockBase> bases;
+    ASSERT_EQ(reorder.plan_block_bases(&bo, pim_size, gemm_order, is_chwise, &bases, &in_cnt), 0);
+
+    int num_grf = pbi_->num_grf;
+    int trans_size = pbi_->trans_size;
+    uint32_t num_col_per_row = pbi_->num_col / pbi_->bl;
+    uint64_t row_stride = addr_gen(0, 0, 0, 0, 1, 0);
+    for (size_t b = 0; b < bases.size(); b++) {
+        const PimGemmWeightReorder::BlockBase& base = bases[b];
+        /* neighbouring blocks of a channel group share their address but the channel */
+        if (b % pbi_->num_pim_chan != 0) EXPECT_EQ(base.col, bases[b - 1].col);
+        for (int t = 0; t < num_grf * num_grf; t++) {
+#ifdef EMULATOR
+            uint64_t idx = (uint64_t)(t % num_grf) * in_cnt + t / num_grf;
+#else
+            uint64_t idx = (uint64_t)(t / num_grf) * in_cnt + t % num_grf;
+#endif
+            uint32_t col = base.col + t;
+            uint64_t pos =
+                base.dst_base + (col / num_col_per_row) * row_stride + addr_gen(0, 0, 0, 0, 0, col % num_col_per_row);
+            memcpy(out.data() + pos, src.data() + base.src_base + idx * trans_size, trans_size);
+        }
+    }
+    EXPECT_EQ(memcmp(ref.data(), out.data(), pim_size), 0);
+
+    /* a destination smaller than the layout is reported */
+    EXPECT_NE(reorder.plan_block_bases(&bo, size / 2, gemm_order, is_chwise, &bases, &in_cnt), 0);
+}
+
+TEST(UnitTest, GemmWeightReorder_Block_Bases_Aligned_IxW) { test_block_bases(2, 1, 256, 4096, I_X_W, false); }
+TEST(UnitTest, GemmWeightReorder_Block_Bases_Aligned_WxI) { test_block_bases(1, 1, 4096, 1024, W_X_I, false); }
+TEST(UnitTest, GemmWeightReorder_Block_Bases_Chwise_IxW) { test_block_bases(1, 4, 1024, 1024, I_X_W, true); }
+TEST(UnitTest, GemmWeightReorder_Block_Bases_Odd_Input_Tiles) { test_block_bases(1, 1, 384, 4096, I_X_W, false); }
+
+TEST(UnitTest, GemmWeightReorder_Unpad_Aligned_Source)
+{
+    /* 1000 of 1024 inputs in 800 of 1024 rows, unpadding in place gives back the packed rows */
+    PimBo bo = make_weight(2, 1, 1024, 1024, nullptr);
+    bo.bshape_r = {2, 1, 1000, 800};
+    size_t packed_size = (size_t)2 * 1000 * 800 * sizeof(uint16_t);
+    std::vector<char> packed(packed_size), padded(bo.size, 0x5a);
+    for (size_t i = 0; i < packed_size; i++) packed[i] = (char)(i * 131 + i / 7);
+
+    PimGemmWeightReorder::pad_aligned_source(padded.data(), packed.data(), &bo);
+    EXPECT_EQ(padded[1000 * sizeof(uint16_t)], 0);
+    PimGemmWeightReorder::unpad_aligned_source(padded.data(), padded.data(), &bo);
+    EXPECT_EQ(memcmp(packed.data(), padded.data(), packed_size), 0);
+}
+
+/* converting to the PIM layout and restoring it gives back the packed bshape_r weight */
+static void test_restore(int n, int c, int in_h, int in_w, int out_h, int out_w, PimGemmOrder gemm_order,
+                         bool transposed, PimDataLayoutType layout)
+{
+    PimGemmDesc desc;
+    memset(&desc, 0, sizeof(desc));
+    desc.precision = PIM_FP16;
+    desc.gemm_order = gemm_order;
+    desc.in_bshape_r = {(uint32_t)n, (uint32_t)c, (uint32_t)in_h, (uint32_t)in_w};
+    if (gemm_order == W_X_I)
+        desc.wei_bshape_r = {(uint32_t)n, (uint32_t)c, (uint32_t)out_h, (uint32_t)in_h};
+    else
+        desc.wei_bshape_r = {(uint32_t)n, (uint32_t)c, (uint32_t)in_w, (uint32_t)out_w};
+    desc.bias_bshape_r = {(uint32_t)n, (uint32_t)c, (uint32_t)out_h, (uint32_t)out_w};
+    desc.out_bshape_r = {(uint32_t)n, (uint32_t)c, (uint32_t)out_h, (uint32_t)out_w};
+    align_gemm_shape(&desc);
+
+    PimBShape& bs = desc.wei_bshape;
+    PimBShape& bs_r = desc.wei_bshape_r;
+    size_t size = (size_t)bs.n * bs.c * bs.h * bs.w * sizeof(uint16_t);
+    size_t packed_size = (size_t)bs_r.n * bs_r.c * bs_r.h * bs_r.w * sizeof(uint16_t);
+    std::vector<char> raw(size, 0), pim(size, 0x5a), back(size, 0x5a);
+    for (size_t i = 0; i < packed_size; i++) raw[i] = (char)(i * 131 + i / 7);
+
+    PimBo raw_bo = make_weight(bs.n, bs.c, bs.h, bs.w, raw.data());
+    PimBo pim_bo = make_weight(bs.n, bs.c, bs.h, bs.w, pim.data());
+    PimBo back_bo = make_weight(bs.n, bs.c, bs.h, bs.w, back.data());
+    raw_bo.bshape_r = bs_r;
+    back_bo.bshape_r = bs_r;
+    pim_bo.mem_type = MEM_TYPE_PIM;
+
+    CpuMemoryManager manager(std::make_shared<pim::runtime::manager::PimDevice>(), PIM_FP16);
+    manager.set_gemm_order(gemm_order);
+    ASSERT_EQ(manager.convert_data_layout(&pim_bo, &raw_bo, false, nullptr, transposed), 0);
+    EXPECT_EQ(pim_bo.data_layout_type, layout);
+
+    EXPECT_EQ(manager.restore_data_layout(&back_bo, &pim_bo, false, nullptr, transposed), 0);
+    EXPECT_EQ(back_bo.data_layout_type, PimDataLayoutType::RAW);
+    EXPECT_EQ(memcmp(raw.data(), back.data(), packed_size), 0);
+}
+
+TEST(UnitTest, GemmWeightReorder_Restore_Aligned_IxW)
+{
+    test_restore(1, 1, 1, 1024, 1, 4096, I_X_W, false, PimDataLayoutType::ALIGNED_GEMM_WEIGHT);
+}
+TEST(UnitTest, GemmWeightReorder_Restore_Aligned_WxI)
+{
+    test_restore(1, 1, 1024, 1, 4096, 1, W_X_I, false, PimDataLayoutType::ALIGNED_GEMM_WEIGHT);
+}
+TEST(UnitTest, GemmWeightReorder_Restore_Chwise_IxW)
+{
+    test_restore(1, 64, 1, 256, 1, 64, I_X_W, false, PimDataLayoutType::CHWISE_GEMM_WEIGHT);
+}
+TEST(UnitTest, GemmWeightReorder_Restore_Padded_IxW)
+{
+    test_restore(1, 1, 1, 1000, 1, 800, I_X_W, false, PimDataLayoutType::ALIGNED_GEMM_WEIGHT);
+}
+TEST(UnitTest, GemmWeightReorder_Restore_Padded_WxI)
+{
+    test_restore(2, 1, 1000, 1, 800, 1, W_X_I, false, PimDataLayoutType::ALIGNED_GEMM_WEIGHT);
+}
+TEST(UnitTest, GemmWeightReorder_Restore_Transposed_IxW)
+{
+    test_restore(1, 1, 1, 1024, 1, 4096, I_X_W, true, PimDataLayoutType::ALIGNED_GEMM_WEIGHT);
+}
+TEST(UnitTest, GemmWeightReorder_Restore_Transposed_Chwise_IxW)
+{
+    test_restore(1, 4, 1, 1024, 1, 1024, I_X_W, true, PimDataLayoutType::CHWISE_GEMM_WEIGHT);
+}
+TEST(UnitTest, GemmWeightReorder_Restore_Transposed_WxI)
+{
+    test_restore(1, 1, 1024, 1, 4096, 1, W_X_I, true, PimDataLayoutType::ALIGNED_GEMM_WEIGHT);
+}
+
+/* benchmark, run with --gtest_also_run_disabled_tests */
+TEST(UnitTest, DISABLED_GemmWeightReorder_Restore_Latency)
+{
+    const int h = 4096;
+    const int w = 4096;
+    size_t size = (size_t)h * w * sizeof(uint16_t);
+    std::vector<char> raw(size), pim(size), back(size);
+    for (size_t i = 0; i < size; i++) raw[i] = (char)(i * 131 + i / 7);
+
+    PimBo raw_bo = make_weight(1, 1, h, w, raw.data());
+    PimBo pim_bo = make_weight(1, 1, h, w, pim.data());
+    PimBo back_bo = make_weight(1, 1, h, w, back.data());
+    pim_bo.mem_type = MEM_TYPE_PIM;
+
+    CpuMemoryManager manager(std::make_shared<pim::runtime::manager::PimDevice>(), PIM_FP16);
+    manager.set_gemm_order(I_X_W);
+    manager.convert_data_layout(&pim_bo, &raw_bo, false, nullptr, false);
+
+    auto start = std::chrono::high_resolution_clock::now();
+    manager.restore_data_layout(&back_bo, &pim_bo, false, nullptr, false);
+    std::chrono::duration<double, std::milli> time = std::chrono::high_resolution_clock::now() - start;
+    std::cout << h << "x" << w << " restore: " << time.count() << " ms" << std::endl;
+}
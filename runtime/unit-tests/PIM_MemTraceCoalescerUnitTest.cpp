@@ -10,6 +10,8 @@
  */
 
 #include <gtest/gtest.h>
+#include <chrono>
+#include "emulator/PimTraceCoalescer.h"
 
 #define TRANS_SIZE 0x10
 
@@ -223,3 +225,148 @@ TEST(PIMRuntimeUnitTest, Coalesce_1Thread_1Channel)
     set_verify_file("../runtime/unit-tests/test-traces/32byte_1channel_output.txt");
     EXPECT_TRUE(test_pim_trace_parser() == 0);
 }
+
+std::vector<PimMemTraceData> load_fmtd16(std::string file_name, int num_chan, int num_repeat)
+{
+    TraceParser p;
+    p.parse(file_name);
+    std::vector<Cmd> &cmds = p.get_trace_data();
+    std::vector<PimMemTraceData> fmtd16;
+
+    for (int ch = 0; ch < num_chan; ch++) {
+        for (int r = 0; r < num_repeat; r++) {
+            for (int i = 0; i < (int)cmds.size(); i++) {
+                PimMemTraceData trace;
+                memset(&trace, 0, sizeof(trace));
+                trace.block_id = ch;
+                trace.thread_id = i % 32;
+                trace.addr = (cmds[i].type_ == Barrier) ? 0 : cmds[i].data_;
+                trace.cmd = (cmds[i].type_ == Barrier) ? 'B' : (cmds[i].type_ == MemRead) ? 'R' : 'W';
+                if (cmds[i].type_ == MemWrite) {
+                    for (int b = 0; b < 16; b++) {
+                        unsigned int byte = 0;
+                        sscanf(&cmds[i].write_data_[b * 2], "%2x", &byte);
+                        trace.data[b] = byte;
+                    }
+                }
+                fmtd16.push_back(trace);
+            }
+        }
+    }
+    return fmtd16;
+}
+
+bool is_same_fmtd32(PimMemTraceData *lhs, PimMemTraceData *rhs, int size)
+{
+    for (int i = 0; i < size; i++) {
+        if (lhs[i].cmd != rhs[i].cmd || lhs[i].addr != rhs[i].addr || lhs[i].block_id != rhs[i].block_id ||
+            lhs[i].thread_id != rhs[i].thread_id) {
+            return false;
+        }
+        if (lhs[i].cmd == 'W' && memcmp(lhs[i].data, rhs[i].data, 32) != 0) return false;
+    }
+    return true;
+}
+
+TEST(PIMRuntimeUnitTest, Coalesce_Runtime_1Channel)
+{
+    std::vector<PimMemTraceData> fmtd16 =
+        load_fmtd16("../runtime/unit-tests/test-traces/16byte_1channel_input.txt", 1, 1);
+    std::vector<PimMemTraceData> fmtd32(fmtd16.size());
+    int fmtd32_size = 0;
+
+    pim::runtime::emulator::TraceParser coalescer;
+    coalescer.coalesce_trace(fmtd32.data(), &fmtd32_size, fmtd16.data(), fmtd16.size());
+
+    TraceParser verify;
+    verify.parse("../runtime/unit-tests/test-traces/32byte_1channel_output.txt");
+    std::vector<Cmd> &expected = verify.get_trace_data();
+
+    ASSERT_EQ(fmtd32_size, (int)expected.size());
+    for (int i = 0; i < fmtd32_size; i++) {
+        char cmd = (expected[i].type_ == Barrier) ? 'B' : (expected[i].type_ == MemRead) ? 'R' : 'W';
+        EXPECT_EQ(fmtd32[i].cmd, cmd);
+        if (cmd != 'B') EXPECT_EQ(fmtd32[i].addr, (uint64_t)expected[i].data_);
+    }
+}
+
+TEST(PIMRuntimeUnitTest, Coalesce_Interleaved_Halves)
+{
+    PimMemTraceData fmtd16[6];
+    memset(fmtd16, 0, sizeof(fmtd16));
+    const char cmds[] = {'B', 'W', 'W', 'W', 'W', 'R'};
+    const uint64_t addrs[] = {0, 0x1010, 0x2000, 0x1000, 0x2010, 0x1000};
+    for (int i = 0; i < 6; i++) {
+        fmtd16[i].cmd = cmds[i];
+        fmtd16[i].addr = addrs[i];
+        fmtd16[i].thread_id = i;
+        memset(fmtd16[i].data, i, 16);
+    }
+
+    PimMemTraceData fmtd32[6];
+    int fmtd32_size = 0;
+    pim::runtime::emulator::TraceParser coalescer(1);
+    coalescer.coalesce_trace(fmtd32, &fmtd32_size, fmtd16, 6);
+
+    /* both write pairs merge across the record in between, the read stays after them */
+    ASSERT_EQ(fmtd32_size, 4);
+    EXPECT_EQ(fmtd32[1].addr, 0x1000u);
+    EXPECT_EQ(fmtd32[1].data[0], 3);
+    EXPECT_EQ(fmtd32[1].data[16], 1);
+    EXPECT_EQ(fmtd32[2].addr, 0x2000u);
+    EXPECT_EQ(fmtd32[2].data[0], 2);
+    EXPECT_EQ(fmtd32[2].data[16], 4);
+    EXPECT_EQ(fmtd32[3].cmd, 'R');
+}
+
+TEST(PIMRuntimeUnitTest, Coalesce_64Channel_Matches_Serial)
+{
+    const int num_chan = 64;
+    const int num_repeat = 256;
+    std::vector<PimMemTraceData> fmtd16 =
+        load_fmtd16("../runtime/unit-tests/test-traces/16byte_1channel_input.txt", num_chan, num_repeat);
+    std::vector<PimMemTraceData> fmtd32_serial(fmtd16.size());
+    std::vector<PimMemTraceData> fmtd32(fmtd16.size());
+    int fmtd32_serial_size = 0;
+    int fmtd32_size = 0;
+
+    pim::runtime::emulator::TraceParser serial_coalescer(1);
+    pim::runtime::emulator::TraceParser coalescer;
+    serial_coalescer.coalesce_trace(fmtd32_serial.data(), &fmtd32_serial_size, fmtd16.data(), fmtd16.size());
+    coalescer.coalesce_trace(fmtd32.data(), &fmtd32_size, fmtd16.data(), fmtd16.size());
+
+    ASSERT_EQ(fmtd32_size, fmtd32_serial_size);
+    EXPECT_TRUE(is_same_fmtd32(fmtd32.data(), fmtd32_serial.data(), fmtd32_size));
+}
+
+/* benchmark, run with --gtest_also_run_disabled_tests */
+TEST(PIMRuntimeUnitTest, DISABLED_Coalesce_64Channel_Throughput)
+{
+    const int num_chan = 64;
+    const int num_repeat = 256;
+    const int num_iter = 10;
+    std::vector<PimMemTraceData> fmtd16 =
+        load_fmtd16("../runtime/unit-tests/test-traces/16byte_1channel_input.txt", num_chan, num_repeat);
+    std::vector<PimMemTraceData> fmtd32(fmtd16.size());
+    int fmtd32_size = 0;
+
+    pim::runtime::emulator::TraceParser serial_coalescer(1);
+    pim::runtime::emulator::TraceParser coalescer;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < num_iter; i++) {
+        serial_coalescer.coalesce_trace(fmtd32.data(), &fmtd32_size, fmtd16.data(), fmtd16.size());
+    }
+    auto mid = std::chrono::steady_clock::now();
+    for (int i = 0; i < num_iter; i++) {
+        coalescer.coalesce_trace(fmtd32.data(), &fmtd32_size, fmtd16.data(), fmtd16.size());
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    double serial_sec = std::chrono::duration<double>(mid - start).count();
+    double parallel_sec = std::chrono::duration<double>(end - mid).count();
+    double num_records = (double)fmtd16.size() * num_iter;
+    std::cout << "coalesce " << fmtd16.size() << " records x " << num_iter << " iter" << std::endl;
+    std::cout << "  1 thread  : " << num_records / serial_sec / 1e6 << " M records/s" << std::endl;
+    std::cout << "  N threads : " << num_records / parallel_sec / 1e6 << " M records/s" << std::endl;
+}
@@ -0,0 +1,177 @@
+/*
+ * Copyright (C) 2022 Samsung Electronics Co. LTD
+ *
+ * This software is a property of Samsung Electronics.
+ * No part of this software, either material or conceptual may be copied or distributed, transmitted,
+ * transcribed, stored in a retrieval system or translated into any human or computer language in any form by any means,
+ * electronic, mechanical, manual or otherwise, or disclosed
+ * to third parties without the express written permission of Samsung Electronics.
+ * (Use of the Software is restricted to non-commercial, personal or academic, research purpose only)
+ */
+
+#include <gtest/gtest.h>
+#include <string.h>
+#include <random>
+#include <vector>
+#include "utility/pim_reference.h"
+
+using half_float::half;
+using namespace pim::runtime::reference;
+
+/* the scalar loops the reference kernels replace */
+static void scalar_matmul(half* input, half* weight, half* output, int m, int n, int k, half alpha, half beta)
+{
+    for (int mi = 0; mi < m; mi++) {
+        for (int ni = 0; ni < n; ni++) {
+            float temp = 0;
+            for (int ki = 0; ki < k; ki++) {
+                temp += (input[mi * k + ki] * weight[ki * n + ni]);
+            }
+            int out_idx = mi * n + ni;
+            output[out_idx] = alpha * temp + beta * output[out_idx];
+        }
+    }
+}
+
+static bool scalar_within(half data_a, half data_b, int allow_bit_cnt, float absTolerance = 0.001)
+{
+    uint16_t Ai = *((uint16_t*)&data_a);
+    uint16_t Bi = *((uint16_t*)&data_b);
+
+    if (fabs((float)data_a - (float)data_b) <= absTolerance) return true;
+    if ((Ai & (1 << 15)) != (Bi & (1 << 15))) return Ai == Bi;
+    return abs(Ai - Bi) <= (1 << allow_bit_cnt);
+}
+
+static std::vector<half> make_data(size_t size, float range, int seed)
+{
+    std::mt19937 gen(seed);
+    std::uniform_real_distribution<float> dis(-range, range);
+    std::vector<half> data(size);
+    for (size_t i = 0; i < size; i++) data[i] = half(dis(gen));
+    return data;
+}
+
+static size_t count_mismatch(const std::vector<half>& a, const std::vector<half>& b)
+{
+    size_t num_mismatch = 0;
+    for (size_t i = 0; i < a.size(); i++) {
+        if (memcmp(&a[i], &b[i], sizeof(half)) != 0) num_mismatch++;
+    }
+    return num_mismatch;
+}
+
+TEST(UnitTest, Reference_Elementwise)
+{
+    /* wide range so sums and products overflow and underflow, plus zeros, infinities, subnormals and nans */
+    size_t len = (1 << 20) + 13;
+    std::vector<half> in0 = make_data(len, 60000.0f, 1);
+    std::vector<half> in1 = make_data(len, 4.0f, 2);
+    uint16_t specials[] = {0x0000, 0x8000, 0x7c00, 0xfc00, 0x0001, 0x8001,
+                           0x03ff, 0x83ff, 0x7bff, 0xfbff, 0x7e00, 0xfd01};
+    for (size_t i = 0; i < sizeof(specials) / sizeof(specials[0]); i++) {
+        *((uint16_t*)&in0[i * 101]) = specials[i];
+        *((uint16_t*)&in1[i * 103 + 1]) = specials[i];
+    }
+
+    for (int num_threads : {1, 4}) {
+        set_num_threads(num_threads);
+        std::vector<half> out(len), golden(len);
+
+        add(out.data(), in0.data(), in1.data(), len);
+        for (size_t i = 0; i < len; i++) golden[i] = in0[i] + in1[i];
+        EXPECT_EQ(count_mismatch(out, golden), 0u);
+
+        mul(out.data(), in0.data(), in1.data(), len);
+        for (size_t i = 0; i < len; i++) golden[i] = in0[i] * in1[i];
+        EXPECT_EQ(count_mismatch(out, golden), 0u);
+
+        out = golden = in0;
+        relu(out.data(), len);
+        for (size_t i = 0; i < len; i++) {
+            if (golden[i] < 0) golden[i] = 0;
+        }
+        EXPECT_EQ(count_mismatch(out, golden), 0u);
+    }
+    set_num_threads(0);
+}
+
+TEST(UnitTest, Reference_Transpose)
+{
+    int row = 300, col = 1027;
+    std::vector<half> in = make_data((size_t)row * col, 100.0f, 3);
+    std::vector<half> out((size_t)row * col), golden((size_t)row * col);
+
+    transpose(out.data(), in.data(), row, col);
+    for (int ri = 0; ri < row; ri++) {
+        for (int ci = 0; ci < col; ci++) golden[ci * row + ri] = in[ri * col + ci];
+    }
+    EXPECT_EQ(count_mismatch(out, golden), 0u);
+}
+
+TEST(UnitTest, Reference_Matmul)
+{
+    /* n leaves a partial column block, beta reads the previous output */
+    int shapes[][3] = {{1, 4096, 1024}, {4, 1000, 777}, {3, 7, 64}};
+    for (auto& shape : shapes) {
+        int m = shape[0], n = shape[1], k = shape[2];
+        std::vector<half> in = make_data((size_t)m * k, 1.0f, m);
+        std::vector<half> weight = make_data((size_t)k * n, 1.0f, n);
+        std::vector<half> out = make_data((size_t)m * n, 2.0f, k);
+        std::vector<half> golden = out;
+
+        matmul(out.data(), in.data(), weight.data(), m, n, k, half(0.5f), half(0.25f));
+        scalar_matmul(in.data(), weight.data(), golden.data(), m, n, k, half(0.5f), half(0.25f));
+        EXPECT_EQ(count_mismatch(out, golden), 0u) << m << "x" << n << "x" << k;
+    }
+}
+
+TEST(UnitTest, Reference_Compare)
+{
+    size_t size = (1 << 20) + 5;
+    float abs_tolerance = 0.0001f;
+    std::vector<half> golden = make_data(size, 10.0f, 4);
+    std::vector<half> data = golden;
+
+    /* nudge elements by growing ulp distances, across zero and with flipped signs */
+    std::mt19937 gen(5);
+    for (size_t i = 0; i < size; i += 1 + gen() % 64) {
+        uint16_t& bits = *((uint16_t*)&data[i]);
+        int kind = gen() % 4;
+        if (kind == 0) bits ^= 0x8000;
+        if (kind == 1) bits += gen() % 600;
+        if (kind == 2) bits -= gen() % 20;
+        if (kind == 3) bits = gen() % 0x10000;
+    }
+
+    CompareResult golden_result = {0, 0, 0, 0.0f};
+    std::vector<size_t> golden_fail;
+    for (size_t i = 0; i < size; i++) {
+        if (scalar_within(data[i], golden[i], 4)) {
+            golden_result.pass_cnt++;
+        } else if (scalar_within(data[i], golden[i], 8, abs_tolerance)) {
+            golden_result.warning_cnt++;
+        } else {
+            golden_result.fail_cnt++;
+            golden_fail.push_back(i);
+        }
+    }
+    ASSERT_GT(golden_result.warning_cnt, 0u);
+    ASSERT_GT(golden_result.fail_cnt, 0u);
+
+    for (int num_threads : {1, 3}) {
+        set_num_threads(num_threads);
+        CompareResult result;
+        std::vector<size_t> fail_idx;
+        EXPECT_EQ(compare_half_relative(data.data(), golden.data(), size, abs_tolerance, &result, &fail_idx),
+                  golden_result.fail_cnt);
+        EXPECT_EQ(result.pass_cnt, golden_result.pass_cnt);
+        EXPECT_EQ(result.warning_cnt, golden_result.warning_cnt);
+        EXPECT_EQ(fail_idx, golden_fail);
+    }
+    set_num_threads(0);
+
+    CompareResult result;
+    EXPECT_EQ(compare_half_relative(golden.data(), golden.data(), size, abs_tolerance, &result), 0u);
+    EXPECT_EQ(result.pass_cnt, size);
+}
@@ -0,0 +1,244 @@
+/*
+ * Copyright (C) 2022 Samsung Electronics Co. LTD
+ *
+ * This software is a property of Samsung Electronics.
+ * No part of this software, either material or conceptual may be copied or distributed, transmitted,
+ * transcribed, stored in a retrieval system or translated into any human or computer language in any form by any means,
+ * electronic, mechanical, manual or otherwise, or disclosed
+ * to third parties without the express written permission of Samsung Electronics.
+ * (Use of the Software is restricted to non-commercial, personal or academic, research purpose only)
+ */
+
+#include <gtest/gtest.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <vector>
+#include "manager/simple_heap.hpp"
+
+#define HEAP_ALIGN 4096
+
+static std::atomic<int> live_blocks(0);
+
+/* host memory stands in for the PIM area */
+class HostBlockAllocator
+{
+   public:
+    explicit HostBlockAllocator(size_t block_size = 64 << 20, int max_blocks = 16)
+        : block_size_(block_size), max_blocks_(max_blocks)
+    {
+    }
+    void* alloc(size_t request_size, size_t& allocated_size, int host_id) const
+    {
+        void* ptr = nullptr;
+        if (live_blocks >= max_blocks_) return nullptr;
+        if (posix_memalign(&ptr, HEAP_ALIGN, block_size_) != 0) return nullptr;
+        allocated_size = block_size_;
+        live_blocks++;
+        return ptr;
+    }
+    void free(void* ptr, size_t length) const
+    {
+        std::free(ptr);
+        live_blocks--;
+    }
+    size_t block_size(void) const { return block_size_; }
+    void* get_pim_base() { return nullptr; }
+
+   private:
+    size_t block_size_;
+    int max_blocks_;
+};
+
+typedef SimpleHeap<HostBlockAllocator> HostHeap;
+
+TEST(UnitTest, SimpleHeap_Aligned_Without_Overlap)
+{
+    HostHeap heap(HostBlockAllocator(), HEAP_ALIGN);
+    std::vector<std::pair<uintptr_t, size_t>> allocs;
+    size_t sizes[] = {1, 100, HEAP_ALIGN, HEAP_ALIGN + 1, 3 * HEAP_ALIGN, 20 * HEAP_ALIGN, 1000000};
+
+    for (int iter = 0; iter < 4; iter++) {
+        for (size_t size : sizes) {
+            void* ptr = heap.alloc(size, 0);
+            ASSERT_NE(ptr, nullptr);
+            EXPECT_EQ((uintptr_t)ptr % HEAP_ALIGN, 0);
+            allocs.push_back(std::make_pair((uintptr_t)ptr, size));
+        }
+    }
+    std::sort(allocs.begin(), allocs.end());
+    for (size_t i = 1; i < allocs.size(); i++) {
+        EXPECT_LE(allocs[i - 1].first + allocs[i - 1].second, allocs[i].first);
+    }
+    /* small buffers are rounded to the alignment, not to 2MB */
+    EXPECT_EQ(live_blocks, 1);
+
+    for (auto& alloc : allocs) {
+        EXPECT_TRUE(heap.free((void*)alloc.first));
+    }
+    heap.trim();
+    EXPECT_EQ(live_blocks, 0);
+}
+
+TEST(UnitTest, SimpleHeap_Reject_Invalid_Free)
+{
+    HostHeap heap(HostBlockAllocator(), HEAP_ALIGN);
+    void* ptr = heap.alloc(HEAP_ALIGN, 0);
+
+    EXPECT_TRUE(heap.free(nullptr));
+    EXPECT_FALSE(heap.free((char*)ptr + HEAP_ALIGN));
+    EXPECT_TRUE(heap.free(ptr));
+    EXPECT_FALSE(heap.free(ptr));
+    EXPECT_EQ(heap.alloc(heap.max_alloc() + 1, 0), nullptr);
+}
+
+TEST(UnitTest, SimpleHeap_Reclaim_Thread_Caches)
+{
+    /* memory kept by another thread is returned to the heap when it runs out, like the single PIM block */
+    size_t block_size = 32 * HEAP_ALIGN;
+    HostHeap heap(HostBlockAllocator(block_size, 1), HEAP_ALIGN);
+    void* base = heap.alloc(block_size, 0);
+    ASSERT_NE(base, nullptr);
+    ASSERT_TRUE(heap.free(base));
+
+    std::thread worker([&]() {
+        std::vector<void*> ptrs;
+        for (int i = 0; i < 16; i++) ptrs.push_back(heap.alloc(HEAP_ALIGN, 0));
+        for (void* ptr : ptrs) EXPECT_TRUE(heap.free(ptr));
+    });
+    worker.join();
+
+    void* ptr = heap.alloc(block_size, 0);
+    EXPECT_EQ(ptr, base);
+    EXPECT_TRUE(heap.free(ptr));
+    heap.trim();
+    EXPECT_EQ(live_blocks, 0);
+}
+
+TEST(UnitTest, SimpleHeap_Flush_Cache_On_Thread_Exit)
+{
+    HostHeap heap(HostBlockAllocator(), HEAP_ALIGN);
+
+    std::thread worker([&]() {
+        std::vector<void*> ptrs;
+        for (int i = 0; i < 16; i++) ptrs.push_back(heap.alloc(HEAP_ALIGN, 0));
+        for (void* ptr : ptrs) EXPECT_TRUE(heap.free(ptr));
+        /* the frees are kept by this thread, so the block is still in use */
+        EXPECT_GT(heap.in_use_size(), 0);
+    });
+    worker.join();
+
+    EXPECT_EQ(heap.in_use_size(), 0);
+    heap.trim();
+    EXPECT_EQ(live_blocks, 0);
+}
+
+TEST(UnitTest, SimpleHeap_Thread_Cache_Byte_Limit)
+{
+    /* with 1MB units a thread may keep only a few buffers */
+    size_t align_size = 1024 * 1024;
+    HostHeap heap(HostBlockAllocator(64 * align_size), align_size);
+    size_t cached_units = HostHeap::THREAD_CACHE_BYTES / align_size;
+
+    std::vector<void*> ptrs;
+    for (size_t i = 0; i < 2 * cached_units; i++) ptrs.push_back(heap.alloc(align_size, 0));
+    for (void* ptr : ptrs) EXPECT_TRUE(heap.free(ptr));
+    EXPECT_EQ(heap.in_use_size(), 64 * align_size);
+
+    /* the buffers over the limit went back to the heap and are merged into one fragment */
+    void* ptr = heap.alloc(cached_units * align_size, 0);
+    EXPECT_EQ(ptr, ptrs[cached_units]);
+    EXPECT_TRUE(heap.free(ptr));
+    heap.trim();
+    EXPECT_EQ(live_blocks, 0);
+}
+
+TEST(UnitTest, SimpleHeap_MultiThread_Stress)
+{
+    HostHeap heap(HostBlockAllocator(), HEAP_ALIGN);
+    const int num_threads = 8;
+    const int num_iters = 20000;
+    std::atomic<int> errors(0);
+    std::vector<std::thread> workers;
+
+    for (int t = 0; t < num_threads; t++) {
+        workers.emplace_back([&, t]() {
+            std::mt19937 gen(t);
+            std::uniform_int_distribution<int> units_dist(1, 24); /* both cached and heap sizes */
+            std::vector<std::pair<uint8_t*, size_t>> live;
+
+            for (int i = 0; i < num_iters; i++) {
+                if (live.size() < 32 && (live.empty() || gen() % 2)) {
+                    size_t size = units_dist(gen) * HEAP_ALIGN - gen() % HEAP_ALIGN;
+                    uint8_t* ptr = (uint8_t*)heap.alloc(size, 0);
+                    if (ptr == nullptr || (uintptr_t)ptr % HEAP_ALIGN != 0) {
+                        errors++;
+                        continue;
+                    }
+                    memset(ptr, t + 1, size);
+                    live.push_back(std::make_pair(ptr, size));
+                } else {
+                    size_t idx = gen() % live.size();
+                    uint8_t* ptr = live[idx].first;
+                    size_t size = live[idx].second;
+                    /* another thread writing into this buffer means overlapping allocations */
+                    if (ptr[0] != t + 1 || ptr[size / 2] != t + 1 || ptr[size - 1] != t + 1) errors++;
+                    if (!heap.free(ptr)) errors++;
+                    live[idx] = live.back();
+                    live.pop_back();
+                }
+            }
+            for (auto& alloc : live) {
+                if (!heap.free(alloc.first)) errors++;
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    EXPECT_EQ(errors, 0);
+    heap.trim();
+    EXPECT_EQ(live_blocks, 0);
+}
+
+static double measure_alloc_latency(HostHeap& heap, int num_threads, int num_iters)
+{
+    std::vector<std::thread> workers;
+    auto start = std::chrono::high_resolution_clock::now();
+
+    for (int t = 0; t < num_threads; t++) {
+        workers.emplace_back([&, t]() {
+            void* ptrs[8];
+            for (int i = 0; i < num_iters; i++) {
+                for (int j = 0; j < 8; j++) ptrs[j] = heap.alloc((j + 1) * HEAP_ALIGN, 0);
+                for (int j = 0; j < 8; j++) heap.free(ptrs[j]);
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::high_resolution_clock::now() - start;
+    return elapsed.count() / ((double)num_iters * 8);
+}
+
+/* benchmark, run with --gtest_also_run_disabled_tests */
+TEST(UnitTest, DISABLED_SimpleHeap_Alloc_Latency)
+{
+    HostHeap heap(HostBlockAllocator(), HEAP_ALIGN);
+    const int num_iters = 20000;
+
+    for (int num_threads : {1, 4}) {
+        double ns = measure_alloc_latency(heap, num_threads, num_iters);
+        std::cout << "SimpleHeap alloc+free latency, " << num_threads << " threads: " << ns << " ns" << std::endl;
+    }
+    heap.trim();
+    EXPECT_EQ(live_blocks, 0);
+}
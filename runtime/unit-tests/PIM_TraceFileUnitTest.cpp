@@ -0,0 +1,151 @@
+/*
+ * Copyright (C) 2022 Samsung Electronics Co. LTD
+ *
+ * This software is a property of Samsung Electronics.
+ * No part of this software, either material or conceptual may be copied or distributed, transmitted,
+ * transcribed, stored in a retrieval system or translated into any human or computer language in any form by any means,
+ * electronic, mechanical, manual or otherwise, or disclosed
+ * to third parties without the express written permission of Samsung Electronics.
+ * (Use of the Software is restricted to non-commercial, personal or academic, research purpose only)
+ */
+
+#include <gtest/gtest.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <random>
+#include <string>
+#include <vector>
+#include "emulator/PimTraceFile.h"
+
+using namespace pim::runtime::emulator;
+
+/* channel-major kernel trace, mostly reads walking the columns of each channel */
+static std::vector<PimMemTraceData> make_trace(int num_chan, int num_per_chan, int seed)
+{
+    std::mt19937_64 gen(seed);
+    std::vector<PimMemTraceData> trace;
+
+    for (int ch = 0; ch < num_chan; ch++) {
+        uint64_t addr = (uint64_t)ch << 8;
+        for (int i = 0; i < num_per_chan; i++) {
+            PimMemTraceData rec;
+            memset(&rec, 0, sizeof(rec));
+            int kind = gen() % 16;
+            rec.block_id = ch;
+            rec.thread_id = (i / 8) % 64;
+            rec.cmd = (kind == 0) ? 'W' : (kind == 1) ? 'B' : (kind == 2) ? 'O' : 'R';
+            if (rec.cmd != 'B') {
+                /* mostly forward strides, sometimes a jump back */
+                addr = (gen() % 8 == 0) ? addr - 0x4000 * (gen() % 4) : addr + 0x2000;
+                rec.addr = addr;
+            }
+            if (rec.cmd == 'W') {
+                for (int d = 0; d < 32; d++) rec.data[d] = gen();
+            }
+            trace.push_back(rec);
+        }
+    }
+    return trace;
+}
+
+static bool same_record(const PimMemTraceData& a, const PimMemTraceData& b)
+{
+    return a.cmd == b.cmd && a.addr == b.addr && a.block_id == b.block_id && a.thread_id == b.thread_id &&
+           memcmp(a.data, b.data, sizeof(a.data)) == 0;
+}
+
+TEST(UnitTest, TraceFile_RoundTrip)
+{
+    std::string path = "trace_file_unit_test.pimtrace";
+    std::vector<PimMemTraceData> kernels[2] = {make_trace(64, 500, 1), make_trace(3, 2000, 2)};
+    std::vector<uint8_t> image(100000);
+    for (size_t i = 0; i < image.size(); i++) image[i] = i * 7;
+
+    PimTraceWriter writer;
+    ASSERT_EQ(writer.open(path), 0);
+    ASSERT_EQ(writer.write_preload(0x123400, image.data(), image.size()), 0);
+    ASSERT_EQ(writer.write_kernel(kernels[0].data(), kernels[0].size()), 0);
+    ASSERT_EQ(writer.write_kernel(kernels[1].data(), kernels[1].size()), 0);
+    ASSERT_EQ(writer.close(), 0);
+
+    /* reads carry no payload and the addresses are short deltas */
+    uint64_t raw_size = (kernels[0].size() + kernels[1].size()) * sizeof(PimMemTraceData);
+    EXPECT_LT(writer.get_file_size() - image.size(), raw_size / 5);
+
+    PimTraceReader reader;
+    PimTraceEvent event;
+    ASSERT_EQ(reader.open(path), 0);
+    ASSERT_EQ(reader.next_event(&event), 1);
+    ASSERT_EQ(event.type, TRACE_EVENT_PRELOAD);
+    EXPECT_EQ(event.addr, 0x123400u);
+    ASSERT_EQ(event.size, image.size());
+    std::vector<uint8_t> loaded(event.size);
+    ASSERT_EQ(reader.read_preload(loaded.data()), 0);
+    EXPECT_EQ(loaded, image);
+
+    for (auto& kernel : kernels) {
+        ASSERT_EQ(reader.next_event(&event), 1);
+        ASSERT_EQ(event.type, TRACE_EVENT_KERNEL);
+        ASSERT_EQ(event.num_trace, kernel.size());
+
+        /* streamed in uneven pieces */
+        std::vector<PimMemTraceData> trace(kernel.size());
+        size_t pos = 0;
+        int64_t num_read;
+        while ((num_read = reader.read_trace(&trace[pos], 777)) > 0) pos += num_read;
+        ASSERT_EQ(num_read, 0);
+        ASSERT_EQ(pos, kernel.size());
+        int num_mismatch = 0;
+        for (size_t i = 0; i < kernel.size(); i++) {
+            if (!same_record(trace[i], kernel[i])) num_mismatch++;
+        }
+        EXPECT_EQ(num_mismatch, 0);
+    }
+    EXPECT_EQ(reader.next_event(&event), 0);
+
+    /* events that are not read are skipped */
+    ASSERT_EQ(reader.open(path), 0);
+    ASSERT_EQ(reader.next_event(&event), 1);
+    ASSERT_EQ(reader.next_event(&event), 1);
+    ASSERT_EQ(reader.next_event(&event), 1);
+    EXPECT_EQ(event.num_trace, kernels[1].size());
+    PimMemTraceData rec;
+    ASSERT_EQ(reader.read_trace(&rec, 1), 1);
+    EXPECT_TRUE(same_record(rec, kernels[1][0]));
+    reader.close();
+    remove(path.c_str());
+}
+
+TEST(UnitTest, TraceFile_Rejects)
+{
+    std::string path = "trace_file_unit_test.pimtrace";
+    std::vector<PimMemTraceData> kernel = make_trace(8, 100, 3);
+    PimTraceWriter writer;
+    PimTraceReader reader;
+    PimTraceEvent event;
+
+    ASSERT_EQ(writer.open(path), 0);
+    kernel[5].cmd = 'X';
+    EXPECT_NE(writer.write_kernel(kernel.data(), kernel.size()), 0);
+    kernel[5].cmd = 'R';
+    ASSERT_EQ(writer.write_kernel(kernel.data(), kernel.size()), 0);
+    ASSERT_EQ(writer.close(), 0);
+
+    /* a truncated file is reported, not read past */
+    FILE* fp = fopen(path.c_str(), "r+b");
+    ASSERT_NE(fp, nullptr);
+    ASSERT_EQ(ftruncate(fileno(fp), writer.get_file_size() - 10), 0);
+    fclose(fp);
+    ASSERT_EQ(reader.open(path), 0);
+    ASSERT_EQ(reader.next_event(&event), 1);
+    std::vector<PimMemTraceData> trace(kernel.size());
+    EXPECT_EQ(reader.read_trace(trace.data(), trace.size()), -1);
+
+    fp = fopen(path.c_str(), "wb");
+    ASSERT_NE(fp, nullptr);
+    fputs("not a trace", fp);
+    fclose(fp);
+    EXPECT_NE(reader.open(path), 0);
+    remove(path.c_str());
+}
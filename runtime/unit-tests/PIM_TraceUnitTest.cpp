@@ -0,0 +1,123 @@
+/*
+ * Copyright (C) 2022 Samsung Electronics Co. LTD
+ *
+ * This software is a property of Samsung Electronics.
+ * No part of this software, either material or conceptual may be copied or distributed, transmitted,
+ * transcribed, stored in a retrieval system or translated into any human or computer language in any form by any means,
+ * electronic, mechanical, manual or otherwise, or disclosed
+ * to third parties without the express written permission of Samsung Electronics.
+ * (Use of the Software is restricted to non-commercial, personal or academic, research purpose only)
+ */
+
+#include <gtest/gtest.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "utility/pim_trace.h"
+
+using namespace pim::runtime;
+
+static size_t count_substr(const std::string& text, const std::string& pattern)
+{
+    size_t count = 0;
+    for (size_t pos = text.find(pattern); pos != std::string::npos; pos = text.find(pattern, pos + 1)) count++;
+    return count;
+}
+
+static std::string read_file(const char* path)
+{
+    std::ifstream in(path);
+    std::stringstream ss;
+    ss << in.rdbuf();
+    return ss.str();
+}
+
+TEST(UnitTest, Trace_Disabled)
+{
+    trace::set_enabled(false);
+    trace::clear();
+    {
+        trace::TraceScope scope("ExecuteAdd");
+        scope.add_bytes(128);
+    }
+    EXPECT_EQ(trace::get_num_events(), 0u);
+}
+
+TEST(UnitTest, Trace_MultiThread_Dump)
+{
+    PimBo bo;
+    memset(&bo, 0, sizeof(bo));
+    bo.bshape = {1, 2, 3, 256};
+    bo.size = 1 * 2 * 3 * 256 * sizeof(uint16_t);
+
+    trace::clear();
+    trace::set_enabled(true);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++) {
+        threads.emplace_back([&bo]() {
+            for (int i = 0; i < 100; i++) {
+                trace::TraceScope scope("ExecuteRelu");
+                scope.add_bo(&bo);
+                scope.add_bo(&bo);
+            }
+        });
+    }
+    for (auto& t : threads) t.join();
+    trace::set_enabled(false);
+    EXPECT_EQ(trace::get_num_events(), 400u);
+
+    char path[] = "/tmp/pim_trace_XXXXXX";
+    int fd = mkstemp(path);
+    ASSERT_GE(fd, 0);
+    close(fd);
+    ASSERT_EQ(trace::dump(path), 0);
+    std::string json = read_file(path);
+    remove(path);
+
+    EXPECT_EQ(json.find("{\"traceEvents\":["), 0u);
+    EXPECT_EQ(count_substr(json, "\"ph\":\"X\""), 400u);
+    EXPECT_EQ(count_substr(json, "\"shape\":\"1x2x3x256\",\"bytes\":6144"), 400u);
+    EXPECT_NE(json.find("\"dropped_events\":0"), std::string::npos);
+}
+
+TEST(UnitTest, Trace_Ring_Keeps_Latest)
+{
+    trace::set_buffer_events(8);
+    trace::clear();
+    trace::set_enabled(true);
+    std::thread worker([]() {
+        for (int i = 0; i < 20; i++) {
+            trace::TraceScope scope("ExecuteMul");
+            scope.add_bytes(i);
+        }
+    });
+    worker.join();
+    trace::set_enabled(false);
+
+    EXPECT_EQ(trace::get_num_events(), 8u);
+    EXPECT_EQ(trace::get_num_dropped(), 12u);
+
+    char path[] = "/tmp/pim_trace_XXXXXX";
+    int fd = mkstemp(path);
+    ASSERT_GE(fd, 0);
+    close(fd);
+    ASSERT_EQ(trace::dump(path), 0);
+    std::string json = read_file(path);
+    remove(path);
+
+    /* the oldest surviving event is exported first */
+    size_t first = json.find("\"bytes\":12,");
+    size_t last = json.find("\"bytes\":19,");
+    EXPECT_NE(first, std::string::npos);
+    EXPECT_NE(last, std::string::npos);
+    EXPECT_LT(first, last);
+    EXPECT_EQ(json.find("\"bytes\":11,"), std::string::npos);
+
+    trace::set_buffer_events(PIM_TRACE_DEFAULT_BUFFER_EVENTS);
+    trace::clear();
+}
@@ -0,0 +1,194 @@
+/*
+ * Copyright (C) 2022 Samsung Electronics Co. LTD
+ *
+ * This software is a property of Samsung Electronics.
+ * No part of this software, either material or conceptual may be copied or distributed, transmitted,
+ * transcribed, stored in a retrieval system or translated into any human or computer language in any form by any means,
+ * electronic, mechanical, manual or otherwise, or disclosed
+ * to third parties without the express written permission of Samsung Electronics.
+ * (Use of the Software is restricted to non-commercial, personal or academic, research purpose only)
+ */
+
+#include <gtest/gtest.h>
+#include <string.h>
+#include <vector>
+#include "manager/PimWeightCache.h"
+#include "utility/pim_hash.h"
+
+using namespace pim::runtime;
+using namespace pim::runtime::manager;
+
+static PimContentHash hash_by_lanes(const std::vector<uint64_t>& data, size_t size)
+{
+    /* same reduction as the device kernel: lanes -> chunk -> buffer */
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(data.data());
+    uint64_t chunk_cnt = hash::num_chunks(size);
+    std::vector<uint64_t> chunks(2 * chunk_cnt);
+    uint64_t lanes[2 * PIM_HASH_LANES];
+
+    for (uint64_t c = 0; c < chunk_cnt; c++) {
+        for (int lane = 0; lane < PIM_HASH_LANES; lane++) {
+            hash::hash_lane(bytes, size, c, lane, &lanes[2 * lane], &lanes[2 * lane + 1]);
+        }
+        hash::hash_chunk_from_lanes(lanes, c, &chunks[2 * c], &chunks[2 * c + 1]);
+    }
+    return hash::hash_from_chunks(chunks.data(), chunk_cnt, size);
+}
+
+static PimWeightKey make_key(uint64_t seed, uint32_t w)
+{
+    PimWeightKey key;
+    memset(&key, 0, sizeof(key));
+    key.hash.h0 = seed;
+    key.hash.h1 = ~seed;
+    key.bshape = {1, 1, 256, w};
+    key.bshape_r = key.bshape;
+    key.precision = PIM_FP16;
+    key.size = 256 * w * 2;
+    key.gemm_order = I_X_W;
+    return key;
+}
+
+static PimBo* make_bo(size_t size)
+{
+    PimBo* bo = new PimBo;
+    memset(bo, 0, sizeof(*bo));
+    bo->size = size;
+    return bo;
+}
+
+TEST(UnitTest, Hash_Content_Sensitive)
+{
+    const size_t size = 3 * PIM_HASH_CHUNK_WORDS * sizeof(uint64_t) + 6;
+    std::vector<uint64_t> data(hash::num_words(size));
+    for (size_t i = 0; i < data.size(); i++) data[i] = i * 0x9e3779b97f4a7c15ULL;
+
+    PimContentHash ref = hash::hash_host_memory(data.data(), size);
+    EXPECT_TRUE(ref == hash::hash_host_memory(data.data(), size));
+    EXPECT_TRUE(ref == hash_by_lanes(data, size));
+
+    /* bytes past the end of the buffer are not part of the content */
+    data.back() ^= 0xff00000000000000ULL;
+    EXPECT_TRUE(ref == hash::hash_host_memory(data.data(), size));
+
+    /* a single flipped bit, two swapped words and a shorter size all change the hash */
+    std::vector<uint64_t> flipped = data;
+    flipped[PIM_HASH_CHUNK_WORDS + 17] ^= 1;
+    EXPECT_FALSE(ref == hash::hash_host_memory(flipped.data(), size));
+
+    std::vector<uint64_t> swapped = data;
+    std::swap(swapped[3], swapped[3 + PIM_HASH_LANES]);
+    EXPECT_FALSE(ref == hash::hash_host_memory(swapped.data(), size));
+
+    EXPECT_FALSE(ref == hash::hash_host_memory(data.data(), size - 2));
+}
+
+TEST(UnitTest, WeightCache_Lru_Eviction)
+{
+    const size_t bo_size = 1024;
+    PimWeightCache cache(3 * bo_size);
+    std::vector<PimEvictedWeight> evicted;
+    PimBo* bos[4];
+
+    for (int i = 0; i < 3; i++) {
+        bos[i] = make_bo(bo_size);
+        EXPECT_EQ(cache.find(make_key(i, 512)), nullptr);
+        EXPECT_EQ(cache.insert(make_key(i, 512), bos[i], &evicted), bos[i]);
+    }
+    EXPECT_TRUE(evicted.empty());
+
+    /* touch 0 so that 1 becomes the least recently used entry */
+    EXPECT_EQ(cache.find(make_key(0, 512)), bos[0]);
+    /* same content hash with another shape is a different weight */
+    EXPECT_EQ(cache.find(make_key(0, 256)), nullptr);
+
+    bos[3] = make_bo(bo_size);
+    cache.insert(make_key(3, 512), bos[3], &evicted);
+    ASSERT_EQ(evicted.size(), 1);
+    EXPECT_EQ(evicted[0].pim_wei, bos[1]);
+    EXPECT_EQ(cache.find(make_key(1, 512)), nullptr);
+
+    PimWeightCacheStats stats;
+    cache.get_stats(&stats);
+    EXPECT_EQ(stats.hits, 1);
+    EXPECT_EQ(stats.misses, 5);
+    EXPECT_EQ(stats.evictions, 1);
+    EXPECT_EQ(stats.entries, 3);
+    EXPECT_EQ(stats.used_bytes, 3 * bo_size);
+
+    /* shrinking the budget drops the oldest entries first */
+    evicted.clear();
+    cache.set_budget(bo_size, &evicted);
+    ASSERT_EQ(evicted.size(), 2);
+    EXPECT_EQ(evicted[0].pim_wei, bos[2]);
+    EXPECT_EQ(evicted[1].pim_wei, bos[0]);
+
+    evicted.clear();
+    cache.clear(&evicted);
+    ASSERT_EQ(evicted.size(), 1);
+    EXPECT_EQ(evicted[0].pim_wei, bos[3]);
+    for (auto* bo : bos) delete bo;
+}
+
+TEST(UnitTest, WeightCache_Oversized_And_Duplicate)
+{
+    PimWeightCache cache(1024);
+    std::vector<PimEvictedWeight> evicted;
+    PimBo* small = make_bo(512);
+    PimBo* large = make_bo(4096);
+    PimBo* dup = make_bo(4096);
+
+    cache.insert(make_key(1, 512), small, &evicted);
+    /* an entry above the budget replaces everything but is still served */
+    EXPECT_EQ(cache.insert(make_key(2, 512), large, &evicted), large);
+    ASSERT_EQ(evicted.size(), 1);
+    EXPECT_EQ(evicted[0].pim_wei, small);
+    EXPECT_EQ(cache.find(make_key(2, 512)), large);
+
+    /* a second insert of the same weight hands the new copy back for release */
+    evicted.clear();
+    EXPECT_EQ(cache.insert(make_key(2, 512), dup, &evicted), large);
+    ASSERT_EQ(evicted.size(), 1);
+    EXPECT_EQ(evicted[0].pim_wei, dup);
+
+    evicted.clear();
+    cache.clear(&evicted);
+    delete small;
+    delete large;
+    delete dup;
+}
+
+TEST(UnitTest, WeightCache_Pinned_Eviction)
+{
+    PimWeightCache cache(1024);
+    std::vector<PimEvictedWeight> evicted;
+    PimBo* used = make_bo(1024);
+    PimBo* next = make_bo(1024);
+    void* streams[2] = {(void*)0x10, (void*)0x20};
+
+    /* a pinned weight leaves the cache on eviction but is only handed back by its last unpin */
+    EXPECT_EQ(cache.insert(make_key(1, 512), used, &evicted, true), used);
+    EXPECT_EQ(cache.find(make_key(1, 512), true), used);
+    cache.insert(make_key(2, 512), next, &evicted);
+    EXPECT_TRUE(evicted.empty());
+    EXPECT_EQ(cache.find(make_key(1, 512)), nullptr);
+
+    cache.unpin(used, streams[0], &evicted);
+    EXPECT_TRUE(evicted.empty());
+    cache.unpin(used, streams[1], &evicted);
+    ASSERT_EQ(evicted.size(), 1);
+    EXPECT_EQ(evicted[0].pim_wei, used);
+    EXPECT_EQ(evicted[0].streams, std::vector<void*>(streams, streams + 2));
+
+    /* an unpinned weight carries the streams of its users to the eviction */
+    evicted.clear();
+    EXPECT_EQ(cache.find(make_key(2, 512), true), next);
+    cache.unpin(next, streams[1], &evicted);
+    cache.set_budget(0, &evicted);
+    ASSERT_EQ(evicted.size(), 1);
+    EXPECT_EQ(evicted[0].pim_wei, next);
+    EXPECT_EQ(evicted[0].streams, std::vector<void*>(1, streams[1]));
+
+    delete used;
+    delete next;
+}
@@ -157,14 +157,18 @@ make_install_fn()
 if [ $target_device = "amd" ]; then
     make_install_opencl_binary()
     {
-        ./examples/OpenCLPimIntegrationTests --gtest_filter=*create_ocl_kernel_binary*
-        sudo cp ocl_pimk.bin ${ROCM_PATH}/opencl/bin/
+        PIM_OCL_CACHE_DIR=. ./examples/OpenCLPimIntegrationTests --gtest_filter=*create_ocl_kernel_binary*
+        sudo cp ocl_pimk-*.bin ${ROCM_PATH}/opencl/bin/
+        # unkeyed copy of the newest binary, loaded as is when the kernel sources are not installed
+        sudo cp $(ls -t ocl_pimk-*.bin | head -n 1) ${ROCM_PATH}/opencl/bin/ocl_pimk.bin
     }
 else
     make_install_opencl_binary()
     {
-        ./examples/OpenCLPimIntegrationTests --gtest_filter=*create_ocl_kernel_binary*
-        sudo cp ocl_pimk.bin ${PIM_PATH}/opencl/bin/
+        PIM_OCL_CACHE_DIR=. ./examples/OpenCLPimIntegrationTests --gtest_filter=*create_ocl_kernel_binary*
+        sudo cp ocl_pimk-*.bin ${PIM_PATH}/opencl/bin/
+        # unkeyed copy of the newest binary, loaded as is when the kernel sources are not installed
+        sudo cp $(ls -t ocl_pimk-*.bin | head -n 1) ${PIM_PATH}/opencl/bin/ocl_pimk.bin
     }
 fi
 if [ $target_device = "amd" ]; then
@@ -175,7 +179,7 @@ if [ $target_device = "amd" ]; then
             sudo rm -f ${ROCM_PATH}/include/pim_data_types.h
             sudo rm -f ${ROCM_PATH}/lib/libdramsim2.so
             sudo rm -rf ${ROCM_PATH}/include/dramsim2
-            sudo rm -f ${ROCM_PATH}/opencl/bin/ocl_pimk.bin
+            sudo rm -f ${ROCM_PATH}/opencl/bin/ocl_pimk*.bin
         }
 else
     uninstall_fn()
@@ -185,7 +189,7 @@ else
             sudo rm -f ${PIM_PATH}/include/pim_data_types.h
             sudo rm -f ${PIM_PATH}/lib/libdramsim2.so
             sudo rm -rf ${PIM_PATH}/include/dramsim2
-            sudo rm -f ${PIM_PATH}/opencl/bin/ocl_pimk.bin
+            sudo rm -f ${PIM_PATH}/opencl/bin/ocl_pimk*.bin
         }
 fi
 
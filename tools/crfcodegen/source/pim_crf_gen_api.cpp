@@ -10,17 +10,29 @@
 
 #include "pim_crf_gen_api.h"
 #include "PimCrfBinGen.h"
-#include "PimValidationChecker.h"
+#include "executor/PimCrfValidator.h"
 using namespace crfgen_offline;
 
 PimCrfBinGen pim_gen;
-PimValidationChecker vc;
+pim::runtime::executor::PimCrfValidator vc;
+
+/* the runtime validator checks the commands by their CRF encoding */
+static std::vector<pim::runtime::executor::PimCommand> to_runtime_cmds(std::vector<PimCommand>& pim_cmd_vec)
+{
+    std::vector<pim::runtime::executor::PimCommand> cmds(pim_cmd_vec.size());
+
+    for (int i = 0; i < (int)pim_cmd_vec.size(); i++) {
+        cmds[i].from_int(pim_cmd_vec[i].to_int());
+    }
+
+    return cmds;
+}
 
 int ConvertToBinary(std::vector<PimCommand>& pim_cmd_vec, uint32_t* crf_binary)
 {
     int ret = 0;
 
-    ret = vc.validation_check(pim_cmd_vec);
+    ret = (vc.validate(to_runtime_cmds(pim_cmd_vec)) == 0) ? 1 : 0;
     if (ret != 0) {
         pim_gen.convert_to_binary(pim_cmd_vec, crf_binary);
 
@@ -33,8 +45,9 @@ int ConvertToBinary(std::vector<PimCommand>& pim_cmd_vec, uint32_t* crf_binary)
 int ConvertToBinary(PimCommand pim_cmd, uint32_t* crf_binary)
 {
     int ret = 0;
+    std::vector<PimCommand> pim_cmd_vec{pim_cmd};
 
-    ret = vc.check_validate_pair(pim_cmd);
+    ret = (vc.check_cmd_validation(to_runtime_cmds(pim_cmd_vec)) == 0) ? 1 : 0;
     if (ret != 0) {
         pim_gen.convert_to_binary(pim_cmd, crf_binary);
         return ret;
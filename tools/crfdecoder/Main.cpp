@@ -8,23 +8,118 @@
  * to third parties without the express written permission of Samsung Electronics.
  */
 
+#include <string.h>
+#include <fstream>
 #include <iostream>
+#include <iterator>
+#include <vector>
 #include "PimCmd.h"
 
+/* the tables are device constants in the runtime, here they are plain host arrays */
+#define __constant__
+#include "pim_crf_bins.h"
+
+void print_usage(void)
+{
+    printf("./crfdecoder <hex_value> [<hex_value> ...]\n");
+    printf("./crfdecoder -f <crf_binary_file>\n");
+    printf("./crfdecoder -b    (dumps the binaries of pim_crf_bins.h)\n");
+}
+
+void decode_crf(const uint8_t* binary, int size)
+{
+    char line[32];
+
+    for (int i = 0; i < size / (int)sizeof(uint32_t); i++) {
+        /* from_int leaves the flags of the previous word set, so each word gets a fresh command */
+        crfgen_offline::PimCommand cmd;
+        uint32_t val;
+        memcpy(&val, binary + i * sizeof(uint32_t), sizeof(val));
+        cmd.from_int(val);
+        snprintf(line, sizeof(line), "%2d : 0x%08x : ", i, val);
+        std::cout << line << cmd.to_str() << std::endl;
+    }
+}
+
+/* mode change bursts are not CRF programs, only their nonzero bytes are meaningful */
+void dump_burst(const uint8_t* binary, int size)
+{
+    char line[32];
+
+    for (int i = 0; i < size; i++) {
+        if (binary[i] == 0) continue;
+        snprintf(line, sizeof(line), "  byte %2d : 0x%02x", i, binary[i]);
+        std::cout << line << std::endl;
+    }
+}
+
+void dump_crf_bins(void)
+{
+    struct {
+        const char* name;
+        const uint8_t* binary;
+        bool is_crf;
+    } bins[] = {{"null_bst", null_bst, false},
+                {"elt_add_crf", elt_add_crf, true},
+                {"elt_add_hab_to_hab_pim", elt_add_hab_to_hab_pim, false},
+                {"elt_add_hab_pim_to_hab", elt_add_hab_pim_to_hab, false},
+                {"elt_mul_crf", elt_mul_crf, true},
+                {"elt_mul_hab_to_hab_pim", elt_mul_hab_to_hab_pim, false},
+                {"elt_mul_hab_pim_to_hab", elt_mul_hab_pim_to_hab, false},
+                {"relu_crf", relu_crf, true},
+                {"relu_hab_to_hab_pim", relu_hab_to_hab_pim, false},
+                {"relu_hab_pim_to_hab", relu_hab_pim_to_hab, false},
+                {"gemv_crf", gemv_crf, true},
+                {"gemv_hab_to_hab_pim", gemv_hab_to_hab_pim, false},
+                {"gemv_hab_pim_to_hab", gemv_hab_pim_to_hab, false},
+                {"bn_crf", bn_crf, true},
+                {"bn_hab_to_hab_pim", bn_hab_to_hab_pim, false},
+                {"bn_hab_pim_to_hab", bn_hab_pim_to_hab, false}};
+    /* SRF operands, not commands */
+    (void)bn_srf_data;
+
+    for (auto& bin : bins) {
+        std::cout << bin.name << std::endl;
+        if (bin.is_crf) {
+            decode_crf(bin.binary, 32);
+        } else {
+            dump_burst(bin.binary, 32);
+        }
+    }
+}
+
 int main(int argc, char* argv[])
 {
     std::cout << "crf decoder" << std::endl;
 
-    if (argc != 2) {
-        printf("./crfdecoder <hex_value>\n");
+    if (argc < 2) {
+        print_usage();
         exit(1);
     }
-    unsigned int val = std::stoul(argv[1], nullptr, 16);
 
-    crfgen_offline::PimCommand cmd;
-
-    cmd.from_int((uint32_t)val);
-    std::cout << cmd.to_str() << std::endl;
+    if (strcmp(argv[1], "-b") == 0) {
+        dump_crf_bins();
+    } else if (strcmp(argv[1], "-f") == 0) {
+        if (argc != 3) {
+            print_usage();
+            exit(1);
+        }
+        std::ifstream file(argv[2], std::ios::binary);
+        if (!file.is_open()) {
+            printf("fail to open %s\n", argv[2]);
+            exit(1);
+        }
+        std::vector<uint8_t> binary((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        if (binary.size() % sizeof(uint32_t) != 0) {
+            printf("%s is not a multiple of CRF words\n", argv[2]);
+            exit(1);
+        }
+        decode_crf(binary.data(), binary.size());
+    } else {
+        std::vector<uint32_t> vals;
+        for (int i = 1; i < argc; i++) vals.push_back((uint32_t)std::stoul(argv[i], nullptr, 16));
+        decode_crf((uint8_t*)vals.data(), vals.size() * sizeof(uint32_t));
+    }
 
     return 0;
 }
@@ -6,15 +6,29 @@
 #include <stdlib.h>
 #include <algorithm>
 #include <chrono>
+#include <functional>
 #include <iostream>
 #include <string>
+#include <vector>
 #include "half.hpp"
 #include "parser.h"
 #include "pim_runtime_api.h"
+#include "utility/pim_debug.hpp"
 #include "utility/pim_log.h"
 
 using namespace std;
 
+/* statistics of the measured iterations, in seconds */
+struct PerfStats {
+    double min = 0.0;
+    double p50 = 0.0;
+    double p90 = 0.0;
+    double p99 = 0.0;
+    double max = 0.0;
+    double mean = 0.0;
+    double stddev = 0.0;
+};
+
 class PerformanceAnalyser
 {
    public:
@@ -28,15 +42,26 @@ class PerformanceAnalyser
     int set_device();
     void print_time_data();
     void print_analytical_data();
+    int write_results(bool validated);
     virtual int ExecuteTest() = 0;
+    void run_iterations(std::function<void(void)> op);
+    void run_steps(std::function<void(void)> issue_op);
     void calculate_gflops(double flt_ops);
+    void calculate_bandwidth(double bytes);
     std::chrono::duration<double> calculate_elapsed_time();
-    void calculate_avg_time();
+    void calculate_statistics();
 
    protected:
+    int write_json(const string& file_name, bool validated);
+    int write_csv(const string& file_name, bool validated);
+
     int num_iter;
+    int num_warmup;
     int num_batch;
+    int chain;
+    bool use_graph;
     double gflops;
+    double bandwidth;
     int device_id;
     Parser* parser;
     int input_width;
@@ -51,21 +76,10 @@ class PerformanceAnalyser
     PimRuntimeType platform;
     std::chrono::duration<double> time_duration;
     std::chrono::duration<double> start_up_time;
-    std::chrono::duration<double> avg_kernel_time;
     std::chrono::duration<double> kernel_execution_time;
+    std::vector<double> samples;
+    PerfStats stats;
     std::chrono::time_point<std::chrono::high_resolution_clock> start, end;
 };
 
-int compare_data(char* data_A, char* data_b, size_t size);
-void set_half_data(half_float::half* buffer, half_float::half value, size_t size);
-void set_rand_half_data(half_float::half* buffer, half_float::half variation, size_t size);
-int compare_half_Ulps_and_absoulte(half_float::half data_a, half_float::half data_b, int allow_bit_cnt,
-                                   float absTolerance = 0.001);
-int compare_half_relative(half_float::half* data_a, half_float::half* data_b, int size, float absTolerance = 0.0001);
-void addCPU(half_float::half* inp1, half_float::half* inp2, half_float::half* output, int length);
-void matmulCPU(half_float::half* input, half_float::half* weight, half_float::half* output, int m, int n, int k,
-               half_float::half alpha, half_float::half beta);
-void addBiasCPU(half_float::half* output, half_float::half* bias, int size);
-void reluCPU(half_float::half* data, int size);
-
 #endif
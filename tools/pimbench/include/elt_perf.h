@@ -11,9 +11,11 @@ class PimEltTest
     ~PimEltTest();
     void prepare(float variation = 0.01f);
     void execute_op(bool block = true);
+    void issue_op();
     void finalize();
     int validate(float epsilon = 1e-5);
     double get_flt_ops();
+    double get_bytes();
 
    private:
     unsigned n_;
@@ -41,10 +43,12 @@ class PimReluTest
     ~PimReluTest();
     void prepare(float variation = 0.01f);
     void execute_op(bool block = true);
+    void issue_op();
     void finalize();
     int validate(float epsilon = 1e-5);
     void calculate_relu_cpu(half_float::half* input, half_float::half* output, int input_len);
     double get_flt_ops();
+    double get_bytes();
 
    private:
     unsigned n_;
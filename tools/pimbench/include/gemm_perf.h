@@ -12,10 +12,12 @@ class PimGemmTest
     ~PimGemmTest();
     void prepare(float alpha = 1.0f, float beta = 0.0f, float variation = 0.01f);
     void execute_op(bool block = true);
+    void issue_op();
     void finalize();
     void run_with_explicit_reordering(bool use_device_weight, bool block = true, unsigned niter = 1);
     int validate(float epsilon = 1e-2);
     double get_flt_ops();
+    double get_bytes();
 
    private:
     bool is_support_activation(const PimActFunc& act) { return (act == ACT_RELU || act == NONE) ? true : false; }
@@ -16,6 +16,7 @@ class Parser
     Parser(){};
     string get_order() { return order; };
     int get_num_iter() { return num_iter; };
+    int get_num_warmup() { return num_warmup; };
     int parse_args(int argc, char* argv[]);
     int get_has_bias() { return has_bias; };
     int get_num_batch() { return num_batch; };
@@ -29,6 +30,10 @@ class Parser
     int get_inp_height() { return input_height; };
     int get_out_height() { return output_height; };
     string get_act_function() { return act_function; };
+    string get_json_file() { return json_file; };
+    string get_csv_file() { return csv_file; };
+    int get_use_graph() { return use_graph; };
+    int get_chain() { return chain; };
     ~Parser(){};
 
    private:
@@ -39,9 +44,14 @@ class Parser
     string platform = "hip";
     string precision = "fp16";
     string act_function = "relu";
-    int num_iter = 2;  // considering the first iter as warm up iter.
+    string json_file = "";
+    string csv_file = "";
+    int num_iter = 2;
+    int num_warmup = 1;
     int has_bias = 1;
     int device_id = 0;
+    int use_graph = 0;
+    int chain = 1;
     int num_batch = -1;
     int input_width = -1;
     int num_channels = -1;
@@ -0,0 +1,39 @@
+#ifndef _PIM_REORDER_PERF_H_
+#define _PIM_REORDER_PERF_H_
+
+#include "common_perf.h"
+#include "pim_data_types.h"
+
+class PimReorderTest
+{
+   public:
+    PimReorderTest(unsigned n, unsigned c, unsigned in_h, unsigned in_w, unsigned out_h, unsigned out_w,
+                   PimGemmOrder gemm_order);
+    ~PimReorderTest();
+    void prepare();
+    void reorder(bool on_device);
+    void finalize(bool on_device);
+    int validate();
+    double get_bytes();
+
+   private:
+    PimGemmOrder gemm_order_;
+
+    PimGemmDesc* desc_;
+    PimBo* h_w_;
+    PimBo* d_w_;
+    PimBo* reordered_w_;
+    PimBo* h_host_reordered_;    // weight reordered by the host converter
+    PimBo* h_device_reordered_;  // weight reordered by the device kernels
+};
+
+class PimReorderTestFixture : public PerformanceAnalyser
+{
+   public:
+    PimReorderTestFixture();
+
+   protected:
+    int ExecuteTest();
+};
+
+#endif
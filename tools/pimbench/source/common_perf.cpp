@@ -1,12 +1,48 @@
 #include <common_perf.h>
-#include <random>
+#include <math.h>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <utility>
 #include "pim_runtime_api.h"
 
-PerformanceAnalyser::PerformanceAnalyser() { parser = new Parser(); }
+namespace
+{
+struct ResultField {
+    string name;
+    string value;
+    bool is_string;
+};
+
+string format_number(double value, int precision)
+{
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(precision) << value;
+    return oss.str();
+}
+
+/* nearest-rank percentile of sorted samples */
+double percentile(const std::vector<double>& sorted, double pct)
+{
+    size_t rank = (size_t)ceil(pct / 100.0 * sorted.size());
+    return sorted[rank > 0 ? rank - 1 : 0];
+}
+}  // namespace
+
+PerformanceAnalyser::PerformanceAnalyser() : chain(1), use_graph(false), gflops(0.0), bandwidth(0.0)
+{
+    parser = new Parser();
+}
+
 PerformanceAnalyser::~PerformanceAnalyser() { delete parser; }
 void PerformanceAnalyser::SetArgs()
 {
-    platform = (parser->get_platform() == "opencl") ? RT_TYPE_OPENCL : RT_TYPE_HIP;
+    if (parser->get_platform() == "opencl")
+        platform = RT_TYPE_OPENCL;
+    else if (parser->get_platform() == "cpu")
+        platform = RT_TYPE_CPU;
+    else
+        platform = RT_TYPE_HIP;
     precision = (parser->get_precision() == "fp16") ? PIM_FP16 : PIM_INT8;
     order = (parser->get_order() == "i_x_w") ? I_X_W : W_X_I;
     operation = parser->get_operation();
@@ -18,6 +54,9 @@ void PerformanceAnalyser::SetArgs()
     output_width = parser->get_out_width();
     device_id = parser->get_device_id();
     num_iter = parser->get_num_iter();
+    num_warmup = parser->get_num_warmup();
+    chain = parser->get_chain();
+    use_graph = parser->get_use_graph() != 0;
 }
 
 int PerformanceAnalyser::SetUp(int argc, char* argv[])
@@ -42,169 +81,197 @@ std::chrono::duration<double> PerformanceAnalyser::calculate_elapsed_time()
     return time_duration;
 }
 
-void PerformanceAnalyser::calculate_avg_time() { kernel_execution_time = avg_kernel_time / (double)(num_iter); }
-void PerformanceAnalyser::calculate_gflops(double flt_ops) { gflops = flt_ops / (double)kernel_execution_time.count(); }
-void PerformanceAnalyser::print_analytical_data()
-{
-    std::cout << "Time analytics: \nPlatform: " << parser->get_platform() << std::endl;
-    std::cout << "Time taken to initialize PIM : " << start_up_time.count() * 1000 << " ms\n";
-    std::cout << "Time taken to execute operation : " << kernel_execution_time.count() * 1000 << " ms\n";
-    std::cout << "GFlops : " << gflops << " gflops\n";
-}
-
-int PerformanceAnalyser::set_device()
+void PerformanceAnalyser::run_iterations(std::function<void(void)> op)
 {
-    int ret = 0;
-    if (platform == RT_TYPE_HIP) {
-        ret = PimSetDevice(device_id);
-    } else {
-        DLOG(WARNING) << "Device cant be set for desired platform\n";
+    for (int i = 0; i < num_warmup; i++) {
+        op();
     }
-    return ret;
-}
 
-int compare_data(char* data_a, char* data_b, size_t size)
-{
-    int ret = 0;
-
-    for (int i = 0; i < size; i++) {
-        // std::cout << (int)data_a[i] << " : " << (int)data_b[i] << std::endl;
-        if (data_a[i] != data_b[i]) {
-            ret = -1;
-            break;
-        }
+    samples.clear();
+    samples.reserve(num_iter);
+    for (int i = 0; i < num_iter; i++) {
+        Tick();
+        op();
+        Tock();
+        samples.push_back(calculate_elapsed_time().count());
     }
-    return ret;
+    calculate_statistics();
 }
 
-void set_half_data(half_float::half* buffer, half_float::half value, size_t size)
+void PerformanceAnalyser::run_steps(std::function<void(void)> issue_op)
 {
-    for (int i = 0; i < size; i++) {
-        buffer[i] = value;
+    /* a step issues the op chain times without blocking and waits once at the end */
+    if (!use_graph) {
+        run_iterations([&]() {
+            for (int i = 0; i < chain; i++) issue_op();
+            PimSynchronize();
+        });
+        return;
     }
-}
-
-void set_rand_half_data(half_float::half* buffer, half_float::half variation, size_t size)
-{
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_real_distribution<> dis(-variation, variation);
 
-    for (size_t i = 0; i < size; i++) {
-        buffer[i] = half_float::half(dis(gen));
+    PimGraph* graph = nullptr;
+    int ret = PimBeginGraphCapture();
+    for (int i = 0; i < chain && ret == 0; i++) issue_op();
+    if (ret == 0) ret = PimEndGraphCapture(&graph);
+    if (ret != 0) {
+        DLOG(ERROR) << "fail to capture graph\n";
+        samples.clear();
+        calculate_statistics();
+        return;
     }
+    run_iterations([&]() { PimLaunchGraph(graph, nullptr, true); });
+    PimDestroyGraph(graph);
 }
 
-int compare_half_Ulps_and_absoulte(half_float::half data_a, half_float::half data_b, int allow_bit_cnt,
-                                   float absTolerance)
+void PerformanceAnalyser::calculate_statistics()
 {
-    uint16_t Ai = *((uint16_t*)&data_a);
-    uint16_t Bi = *((uint16_t*)&data_b);
+    stats = PerfStats();
+    if (samples.empty()) return;
 
-    float diff = fabs((float)data_a - (float)data_b);
-    int maxUlpsDiff = 1 << allow_bit_cnt;
+    std::vector<double> sorted(samples);
+    std::sort(sorted.begin(), sorted.end());
+    double sum = 0.0;
+    for (double t : sorted) sum += t;
+    stats.mean = sum / sorted.size();
 
-    if (diff <= absTolerance) {
-        return true;
-    }
+    double sq_sum = 0.0;
+    for (double t : sorted) sq_sum += (t - stats.mean) * (t - stats.mean);
+    stats.stddev = (sorted.size() > 1) ? sqrt(sq_sum / (sorted.size() - 1)) : 0.0;
 
-    if ((Ai & (1 << 15)) != (Bi & (1 << 15))) {
-        if (Ai == Bi) return true;
-        return false;
-    }
+    stats.min = sorted.front();
+    stats.max = sorted.back();
+    stats.p50 = percentile(sorted, 50.0);
+    stats.p90 = percentile(sorted, 90.0);
+    stats.p99 = percentile(sorted, 99.0);
+    kernel_execution_time = std::chrono::duration<double>(stats.mean);
+}
 
-    // Find the difference in ULPs.
-    int ulpsDiff = abs(Ai - Bi);
+void PerformanceAnalyser::calculate_gflops(double flt_ops)
+{
+    gflops = flt_ops / (double)kernel_execution_time.count() / 1e9;
+}
 
-    if (ulpsDiff <= maxUlpsDiff) return true;
+void PerformanceAnalyser::calculate_bandwidth(double bytes)
+{
+    bandwidth = bytes / (double)kernel_execution_time.count() / 1e9;
+}
 
-    return false;
+void PerformanceAnalyser::print_analytical_data()
+{
+    std::cout << "Time analytics: \nPlatform: " << parser->get_platform() << std::endl;
+    std::cout << "Time taken to initialize PIM : " << start_up_time.count() * 1000 << " ms\n";
+    std::cout << "Iterations : " << num_iter << " (warmup : " << num_warmup << ")\n";
+    std::cout << "Time taken to execute operation : " << kernel_execution_time.count() * 1000 << " ms\n";
+    std::cout << "min / p50 / p90 / p99 / max : " << stats.min * 1000 << " / " << stats.p50 * 1000 << " / "
+              << stats.p90 * 1000 << " / " << stats.p99 * 1000 << " / " << stats.max * 1000 << " ms\n";
+    std::cout << "Standard deviation : " << stats.stddev * 1000 << " ms\n";
+    std::cout << "Ops per step : " << chain << (use_graph ? " (graph)" : " (eager)") << ", time per op : "
+              << stats.mean / chain * 1e6 << " us\n";
+    std::cout << "GFlops : " << gflops << " gflops\n";
+    std::cout << "Bandwidth : " << bandwidth << " GB/s\n";
 }
 
-int compare_half_relative(half_float::half* data_a, half_float::half* data_b, int size, float absTolerance)
+static std::vector<ResultField> get_result_fields(Parser* parser, const PerfStats& stats, double start_up_ms,
+                                                  double gflops, double bandwidth, int num_warmup, int num_iter,
+                                                  int chain, bool use_graph, bool validated)
+{
+    /* fixed field order and precision keep the files diffable between builds */
+    return {
+        {"platform", parser->get_platform(), true},
+        {"operation", parser->get_operation(), true},
+        {"order", parser->get_order(), true},
+        {"n", std::to_string(parser->get_num_batch()), false},
+        {"c", std::to_string(parser->get_num_chan()), false},
+        {"i_h", std::to_string(parser->get_inp_height()), false},
+        {"i_w", std::to_string(parser->get_inp_width()), false},
+        {"o_h", std::to_string(parser->get_out_height()), false},
+        {"o_w", std::to_string(parser->get_out_width()), false},
+        {"warmup_iter", std::to_string(num_warmup), false},
+        {"num_iter", std::to_string(num_iter), false},
+        {"graph", std::to_string(use_graph ? 1 : 0), false},
+        {"chain", std::to_string(chain), false},
+        {"init_ms", format_number(start_up_ms, 6), false},
+        {"min_ms", format_number(stats.min * 1000, 6), false},
+        {"p50_ms", format_number(stats.p50 * 1000, 6), false},
+        {"p90_ms", format_number(stats.p90 * 1000, 6), false},
+        {"p99_ms", format_number(stats.p99 * 1000, 6), false},
+        {"max_ms", format_number(stats.max * 1000, 6), false},
+        {"mean_ms", format_number(stats.mean * 1000, 6), false},
+        {"stddev_ms", format_number(stats.stddev * 1000, 6), false},
+        {"per_op_us", format_number(stats.mean / chain * 1e6, 6), false},
+        {"gflops", format_number(gflops, 6), false},
+        {"bandwidth_gbps", format_number(bandwidth, 6), false},
+        {"validation", validated ? "pass" : "fail", true},
+    };
+}
+
+int PerformanceAnalyser::write_results(bool validated)
 {
-    int pass_cnt = 0;
-    int warning_cnt = 0;
-    int fail_cnt = 0;
     int ret = 0;
-    std::vector<int> fail_idx;
-    std::vector<float> fail_data_pim;
-    std::vector<float> fail_data_goldeny;
-
-    float max_diff = 0.0;
-    int pass_bit_cnt = 4;
-    int warn_bit_cnt = 8;
-
-    for (int i = 0; i < size; i++) {
-        // std::cout<<"data_a : "<<data_a[i]<<" , data_b : "<<data_b[i]<<std::endl;
-        if (compare_half_Ulps_and_absoulte(data_a[i], data_b[i], pass_bit_cnt)) {
-            // std::cout << "c data_a : " << (float)data_a[i] << " data_b : " << (float)data_b[i] << std::endl;
-            pass_cnt++;
-        } else if (compare_half_Ulps_and_absoulte(data_a[i], data_b[i], warn_bit_cnt, absTolerance)) {
-            // std::cout << "w data_a : " << (float)data_a[i] << " data_b : " << (float)data_b[i] << std::endl;
-            warning_cnt++;
-        } else {
-            if (abs(float(data_a[i]) - float(data_b[i])) > max_diff) {
-                max_diff = abs(float(data_a[i]) - float(data_b[i]));
-            }
-            //  std::cout << "f data_a : " << (float)data_a[i] << " data_b : "  <<(float)data_b[i]  << std::endl;
+    string json_file = parser->get_json_file();
+    string csv_file = parser->get_csv_file();
 
-            fail_idx.push_back(pass_cnt + warning_cnt + fail_cnt);
-            fail_data_pim.push_back((float)data_a[i]);
-            fail_data_goldeny.push_back((float)data_b[i]);
+    if (json_file != "") ret |= write_json(json_file, validated);
+    if (csv_file != "") ret |= write_csv(csv_file, validated);
+    return ret;
+}
 
-            fail_cnt++;
-            ret = 1;
-        }
+int PerformanceAnalyser::write_json(const string& file_name, bool validated)
+{
+    std::ofstream out(file_name, std::ios::trunc);
+    if (!out.is_open()) {
+        DLOG(ERROR) << "fail to open " << file_name << "\n";
+        return -1;
     }
 
-    int quasi_cnt = pass_cnt + warning_cnt;
-    if (ret) {
-        printf("relative - pass_cnt : %d, warning_cnt : %d, fail_cnt : %d, pass ratio : %f, max diff : %f\n", pass_cnt,
-               warning_cnt, fail_cnt,
-               ((float)quasi_cnt / ((float)fail_cnt + (float)warning_cnt + (float)pass_cnt) * 100), max_diff);
-#ifdef DEBUG_PIM
-        for (int i = 0; i < fail_idx.size(); i++) {
-            std::cout << fail_idx[i] << " pim : " << fail_data_pim[i] << " golden :" << fail_data_goldeny[i]
-                      << std::endl;
+    auto fields = get_result_fields(parser, stats, start_up_time.count() * 1000, gflops, bandwidth, num_warmup,
+                                    num_iter, chain, use_graph, validated);
+    out << "{\n";
+    for (size_t i = 0; i < fields.size(); i++) {
+        out << "    \"" << fields[i].name << "\": ";
+        if (fields[i].is_string) {
+            out << "\"" << fields[i].value << "\"";
+        } else {
+            out << fields[i].value;
         }
-#endif
+        out << ((i + 1 < fields.size()) ? ",\n" : "\n");
     }
-    return ret;
+    out << "}\n";
+    return out.good() ? 0 : -1;
 }
 
-void addCPU(half_float::half* inp1, half_float::half* inp2, half_float::half* output, int length)
+int PerformanceAnalyser::write_csv(const string& file_name, bool validated)
 {
-    for (int i = 0; i < length; i++) {
-        output[i] = inp1[i] + inp2[i];
+    bool is_empty = true;
+    {
+        std::ifstream in(file_name);
+        is_empty = !in.is_open() || in.peek() == std::ifstream::traits_type::eof();
     }
-}
 
-void matmulCPU(half_float::half* input, half_float::half* weight, half_float::half* output, int m, int n, int k,
-               half_float::half alpha, half_float::half beta)
-{
-    for (int mi = 0; mi < m; mi++) {
-        for (int ni = 0; ni < n; ni++) {
-            float temp = 0;
-            for (int ki = 0; ki < k; ki++) {
-                temp += (input[mi * k + ki] * weight[ki * n + ni]);
-            }
-            int out_idx = mi * n + ni;
-            output[out_idx] = alpha * temp + beta * output[out_idx];
-        }
+    std::ofstream out(file_name, std::ios::app);
+    if (!out.is_open()) {
+        DLOG(ERROR) << "fail to open " << file_name << "\n";
+        return -1;
     }
-}
 
-void addBiasCPU(half_float::half* output, half_float::half* bias, int size)
-{
-    for (int i = 0; i < size; i++) {
-        output[i] += bias[i];
+    auto fields = get_result_fields(parser, stats, start_up_time.count() * 1000, gflops, bandwidth, num_warmup,
+                                    num_iter, chain, use_graph, validated);
+    if (is_empty) {
+        for (size_t i = 0; i < fields.size(); i++) out << (i ? "," : "") << fields[i].name;
+        out << "\n";
     }
+    for (size_t i = 0; i < fields.size(); i++) out << (i ? "," : "") << fields[i].value;
+    out << "\n";
+    return out.good() ? 0 : -1;
 }
 
-void reluCPU(half_float::half* data, int size)
+int PerformanceAnalyser::set_device()
 {
-    for (int i = 0; i < size; i++) {
-        if (data[i] < 0) data[i] = 0;
+    int ret = 0;
+    if (platform == RT_TYPE_HIP) {
+        ret = PimSetDevice(device_id);
+    } else if (platform != RT_TYPE_CPU) {
+        DLOG(WARNING) << "Device cant be set for desired platform\n";
     }
+    return ret;
 }
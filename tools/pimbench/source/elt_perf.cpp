@@ -55,6 +55,7 @@ void PimEltTest::execute_op(bool block)
     if (!block) PimSynchronize();
 }
 
+void PimEltTest::issue_op() { PimExecuteAdd(d_o_, d_i_1_, d_i_2_, nullptr, false); }
 void PimEltTest::finalize() { PimCopyMemory(h_o_, d_o_, PIM_TO_HOST); }
 int PimEltTest::validate(float epsilon)
 {
@@ -62,6 +63,8 @@ int PimEltTest::validate(float epsilon)
 }
 
 double PimEltTest::get_flt_ops() { return flt_ops_; }
+/* two operands read and one result written */
+double PimEltTest::get_bytes() { return (2.0 * in_size_ + out_size_) * sizeof(half); }
 PimReluTest::PimReluTest(unsigned n, unsigned c, unsigned in_h, unsigned in_w, PimPrecision precision)
     : n_(n), c_(c), in_h_(in_h), in_w_(in_w), out_h_(in_h), out_w_(in_w), precision_(precision)
 {
@@ -108,6 +111,7 @@ void PimReluTest::execute_op(bool block)
     if (!block) PimSynchronize();
 }
 
+void PimReluTest::issue_op() { PimExecuteRelu(d_o_, d_i_, nullptr, false); }
 void PimReluTest::finalize() { PimCopyMemory(h_o_, d_o_, PIM_TO_HOST); }
 int PimReluTest::validate(float epsilon)
 {
@@ -115,24 +119,16 @@ int PimReluTest::validate(float epsilon)
 }
 
 double PimReluTest::get_flt_ops() { return flt_ops_; }
+double PimReluTest::get_bytes() { return ((double)in_size_ + out_size_) * sizeof(half); }
 int PimEltTestFixture::ExecuteTest()
 {
     PimEltTest pimEltTest = PimEltTest(num_batch, num_channels, input_height, input_width, precision);
     pimEltTest.prepare();
 
-    // warmup
-    pimEltTest.execute_op(true);
-
-    avg_kernel_time = std::chrono::duration<double>::zero();
-    for (int i = 0; i < num_iter; i++) {
-        Tick();
-        pimEltTest.execute_op(block);
-        Tock();
-        avg_kernel_time += calculate_elapsed_time();
-    }
+    run_steps([&]() { pimEltTest.issue_op(); });
     pimEltTest.finalize();
-    calculate_avg_time();
-    calculate_gflops(pimEltTest.get_flt_ops());
+    calculate_gflops(pimEltTest.get_flt_ops() * chain);
+    calculate_bandwidth(pimEltTest.get_bytes() * chain);
     return pimEltTest.validate();
 }
 
@@ -141,18 +137,9 @@ int PimReluTestFixture::ExecuteTest()
     PimReluTest pimReluTest = PimReluTest(num_batch, num_channels, input_height, input_width, precision);
     pimReluTest.prepare();
 
-    // warmup
-    pimReluTest.execute_op(true);
-
-    avg_kernel_time = std::chrono::duration<double>::zero();
-    for (int i = 0; i < num_iter; i++) {
-        Tick();
-        pimReluTest.execute_op(block);
-        Tock();
-        avg_kernel_time += calculate_elapsed_time();
-    }
+    run_steps([&]() { pimReluTest.issue_op(); });
     pimReluTest.finalize();
-    calculate_avg_time();
-    calculate_gflops(pimReluTest.get_flt_ops());
+    calculate_gflops(pimReluTest.get_flt_ops() * chain);
+    calculate_bandwidth(pimReluTest.get_bytes() * chain);
     return pimReluTest.validate();
 }
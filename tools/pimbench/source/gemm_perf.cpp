@@ -116,6 +116,7 @@ void PimGemmTest::execute_op(bool block)
     if (!block) PimSynchronize();
 }
 
+void PimGemmTest::issue_op() { (void)PimExecuteGemm(d_o_, d_i_, d_w_, d_b_, act_, gemm_order_, nullptr, false); }
 void PimGemmTest::finalize() { PimCopyMemory(h_o_, d_o_, DEVICE_TO_HOST); }
 void PimGemmTest::run_with_explicit_reordering(bool use_device_weight, bool block, unsigned niter)
 {
@@ -138,6 +139,13 @@ int PimGemmTest::validate(float epsilon)
 }
 
 double PimGemmTest::get_flt_ops() { return flt_ops_; }
+double PimGemmTest::get_bytes()
+{
+    double elems = (double)in_size_ + wgt_size_ + out_size_;
+    if (has_bias_) elems += out_size_;
+    return elems * sizeof(half);
+}
+
 PimGemmTestFixture::PimGemmTestFixture() {}
 int PimGemmTestFixture::ExecuteTest()
 {
@@ -147,19 +155,10 @@ int PimGemmTestFixture::ExecuteTest()
                                           output_width, act, has_bias, order);
     pimGemmTest.prepare();
 
-    // warmup
-    pimGemmTest.execute_op(true);
-
-    avg_kernel_time = std::chrono::duration<double>::zero();
-    for (int i = 0; i < num_iter; i++) {
-        Tick();
-        pimGemmTest.execute_op(block);
-        Tock();
-        avg_kernel_time += calculate_elapsed_time();
-    }
+    run_steps([&]() { pimGemmTest.issue_op(); });
     pimGemmTest.finalize();
-    calculate_avg_time();
-    calculate_gflops(pimGemmTest.get_flt_ops());
+    calculate_gflops(pimGemmTest.get_flt_ops() * chain);
+    calculate_bandwidth(pimGemmTest.get_bytes() * chain);
     return pimGemmTest.validate();
 }
 
@@ -169,18 +168,11 @@ int PimGemmTestFixture::ExecuteTestExplicitReordering()
     PimGemmTest pimGemmTest = PimGemmTest(num_batch, num_channels, input_height, input_width, output_height,
                                           output_width, act, has_bias, order);
     pimGemmTest.prepare();
-    pimGemmTest.run_with_explicit_reordering(use_device_weight, block);
-
-    avg_kernel_time = std::chrono::duration<double>::zero();
-    for (int i = 0; i < num_iter; i++) {
-        Tick();
-        pimGemmTest.run_with_explicit_reordering(use_device_weight, block);
-        Tock();
-        avg_kernel_time += calculate_elapsed_time();
-    }
+
+    run_iterations([&]() { pimGemmTest.run_with_explicit_reordering(use_device_weight, block); });
     pimGemmTest.finalize();
-    calculate_avg_time();
     calculate_gflops(pimGemmTest.get_flt_ops());
+    calculate_bandwidth(pimGemmTest.get_bytes());
 
     return pimGemmTest.validate();
 }
@@ -8,14 +8,14 @@ int Parser::parse_args(int argc, char* argv[])
         return -1;
     }
     if (argc < 6) {
-        DLOG(ERROR) << "plt(hip/opencl) , op , n_b , n_c , i_h , i_w are minimum require args\n";
+        DLOG(ERROR) << "plt(hip/opencl/cpu) , op , n_b , n_c , i_h , i_w are minimum require args\n";
         return -1;
     }
 
     std::vector<std::string> args(argv, argv + argc);
     for (size_t i = 1; i < args.size(); ++i) {
         string option = args[i];
-        if (option == "-plt") {
+        if (option == "-plt" || option == "-platform") {
             platform = args[i + 1];
         } else if (option == "pcsn") {
             precision = args[i + 1];
@@ -46,6 +46,16 @@ int Parser::parse_args(int argc, char* argv[])
             return -1;
         } else if (option == "-i") {
             num_iter = stoi(args[i + 1]);
+        } else if (option == "-w") {
+            num_warmup = stoi(args[i + 1]);
+        } else if (option == "-graph") {
+            use_graph = stoi(args[i + 1]);
+        } else if (option == "-chain") {
+            chain = stoi(args[i + 1]);
+        } else if (option == "-json") {
+            json_file = args[i + 1];
+        } else if (option == "-csv") {
+            csv_file = args[i + 1];
         }
     }
     if (!check_validity()) {
@@ -58,7 +68,7 @@ int Parser::parse_args(int argc, char* argv[])
 
 bool Parser::check_validity()
 {
-    if (platform != "hip" && platform != "opencl") {
+    if (platform != "hip" && platform != "opencl" && platform != "cpu") {
         std::cout << "platform : " << platform << std::endl;
         DLOG(ERROR) << "invalid platform provided\n";
         return false;
@@ -79,7 +89,17 @@ bool Parser::check_validity()
         return false;
     }
 
-    if (operation == "gemm") {
+    if (num_iter < 1 || num_warmup < 0) {
+        DLOG(ERROR) << "at least one measured iteration and no negative warmup iterations are required\n";
+        return false;
+    }
+
+    if (chain < 1) {
+        DLOG(ERROR) << "at least one op per step is required\n";
+        return false;
+    }
+
+    if (operation == "gemm" || operation == "reorder") {
         if (order == "") {
             DLOG(ERROR) << "compute order is missing\n";
             return false;
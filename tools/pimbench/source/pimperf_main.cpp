@@ -1,5 +1,6 @@
 #include "elt_perf.h"
 #include "gemm_perf.h"
+#include "reorder_perf.h"
 #include "utils.h"
 
 int main(int argc, char* argv[])
@@ -22,6 +23,9 @@ int main(int argc, char* argv[])
             } else if (op == "relu") {
                 analyser = new PimReluTestFixture();
                 continue;
+            } else if (op == "reorder") {
+                analyser = new PimReorderTestFixture();
+                continue;
             } else {
                 DLOG(ERROR) << "Pim doesnt support provided operation\n";
                 return -1;
@@ -34,6 +38,7 @@ int main(int argc, char* argv[])
         if (ret == 0) {
             int success = analyser->ExecuteTest();
             analyser->print_analytical_data();
+            ret = analyser->write_results(success == 0);
         }
     } else {
         print_help();
@@ -0,0 +1,97 @@
+/*
+ * Copyright (C) 2022 Samsung Electronics Co. LTD
+ *
+ * This software is a property of Samsung Electronics.
+ * No part of this software, either material or conceptual may be copied or distributed, transmitted,
+ * transcribed, stored in a retrieval system or translated into any human or computer language in any form by any means,
+ * electronic, mechanical, manual or otherwise, or disclosed
+ * to third parties without the express written permission of Samsung Electronics.
+ */
+#include "reorder_perf.h"
+#include <string.h>
+
+using half_float::half;
+using namespace std;
+
+PimReorderTest::PimReorderTest(unsigned n, unsigned c, unsigned in_h, unsigned in_w, unsigned out_h, unsigned out_w,
+                               PimGemmOrder gemm_order)
+    : gemm_order_(gemm_order), reordered_w_(nullptr), h_host_reordered_(nullptr), h_device_reordered_(nullptr)
+{
+    desc_ = PimCreateGemmDesc(n, c, in_h, in_w, out_h, out_w, PIM_FP16, gemm_order);
+    h_w_ = PimCreateBo(desc_, MEM_TYPE_HOST, GEMM_WEIGHT);
+    d_w_ = PimCreateBo(desc_, MEM_TYPE_DEVICE, GEMM_WEIGHT);
+}
+
+PimReorderTest::~PimReorderTest()
+{
+    if (reordered_w_ != nullptr) PimDestroyBo(reordered_w_);
+    if (h_host_reordered_ != nullptr) PimDestroyBo(h_host_reordered_);
+    if (h_device_reordered_ != nullptr) PimDestroyBo(h_device_reordered_);
+    PimDestroyBo(h_w_);
+    PimDestroyBo(d_w_);
+    PimDestroyGemmDesc(desc_);
+}
+
+void PimReorderTest::prepare()
+{
+    set_rand_half_data((half*)h_w_->data, half(1.0), h_w_->size / sizeof(half));
+    PimCopyMemory(d_w_, h_w_, HOST_TO_DEVICE);
+}
+
+void PimReorderTest::reorder(bool on_device)
+{
+    if (reordered_w_ != nullptr) PimDestroyBo(reordered_w_);
+    reordered_w_ = PimConvertGemmWeight(d_w_, gemm_order_, on_device);
+    PimSynchronize();
+}
+
+void PimReorderTest::finalize(bool on_device)
+{
+    if (reordered_w_ == nullptr) return;
+
+    PimBShape* bs = &reordered_w_->bshape;
+    PimBo** h_out = on_device ? &h_device_reordered_ : &h_host_reordered_;
+    if (*h_out == nullptr) *h_out = PimCreateBo(bs->n, bs->c, bs->h, bs->w, PIM_FP16, MEM_TYPE_HOST);
+    PimCopyMemory(*h_out, reordered_w_, PIM_TO_HOST);
+}
+
+int PimReorderTest::validate()
+{
+    /* the device kernels have to give the bytes of the host converter */
+    if (h_host_reordered_ == nullptr || h_device_reordered_ == nullptr ||
+        h_host_reordered_->size != h_device_reordered_->size) {
+        return -1;
+    }
+    return memcmp(h_host_reordered_->data, h_device_reordered_->data, h_host_reordered_->size) == 0 ? 0 : -1;
+}
+
+double PimReorderTest::get_bytes() { return 2.0 * d_w_->size; }
+
+PimReorderTestFixture::PimReorderTestFixture() {}
+int PimReorderTestFixture::ExecuteTest()
+{
+    PimReorderTest pimReorderTest = PimReorderTest(num_batch, num_channels, input_height, input_width, output_height,
+                                                   output_width, order);
+    pimReorderTest.prepare();
+
+    run_iterations([&]() { pimReorderTest.reorder(false); });
+    pimReorderTest.finalize(false);
+    double host_ms = stats.mean * 1000;
+
+    /* the per element kernels are only selected for this comparison */
+    setenv("PIM_REORDER_KERNEL", "element", 1);
+    run_iterations([&]() { pimReorderTest.reorder(true); });
+    unsetenv("PIM_REORDER_KERNEL");
+    double element_ms = stats.mean * 1000;
+
+    run_iterations([&]() { pimReorderTest.reorder(true); });
+    pimReorderTest.finalize(true);
+    double block_ms = stats.mean * 1000;
+
+    std::cout << "Reorder on host : " << host_ms << " ms\n";
+    std::cout << "Reorder by per element kernels : " << element_ms << " ms\n";
+    std::cout << "Reorder by block kernels : " << block_ms << " ms (x" << element_ms / block_ms
+              << " over per element kernels, x" << host_ms / block_ms << " over host)\n";
+    calculate_bandwidth(pimReorderTest.get_bytes());
+    return pimReorderTest.validate();
+}
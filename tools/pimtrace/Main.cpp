@@ -0,0 +1,167 @@
+/*
+ * Copyright (C) 2022 Samsung Electronics Co. LTD
+ *
+ * This software is a property of Samsung Electronics.
+ * No part of this software, either material or conceptual may be copied or distributed, transmitted,
+ * transcribed, stored in a retrieval system or translated into any human or computer language in any form by any means,
+ * electronic, mechanical, manual or otherwise, or disclosed
+ * to third parties without the express written permission of Samsung Electronics.
+ * (Use of the Software is restricted to non-commercial, personal or academic, research purpose only)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <chrono>
+#include <string>
+#include <vector>
+#include "emulator/PimSimBackend.h"
+#include "emulator/PimTraceFile.h"
+
+using namespace pim::runtime::emulator;
+
+void print_usage(void)
+{
+    printf("./pimtrace record <trace_file> <command> [<args> ...]\n");
+    printf("    runs an emulator build PIM application and records its preloads and kernel traces\n");
+    printf("./pimtrace replay <trace_file> [-m timing|functional] [-t <num_threads>]\n");
+    printf("    feeds a recorded trace into the simulator and reports the time spent per kernel\n");
+    printf("./pimtrace info <trace_file>\n");
+    printf("    prints the events and the record mix of a trace\n");
+}
+
+int record_trace(const char* trace_file, char** argv)
+{
+    setenv("PIM_EMULATOR_RECORD", trace_file, 1);
+    execvp(argv[0], argv);
+    perror(argv[0]);
+    return -1;
+}
+
+int replay_trace(const char* trace_file, int argc, char** argv)
+{
+    for (int i = 0; i < argc; i++) {
+        if (strcmp(argv[i], "-m") == 0 && i + 1 < argc) {
+            setenv("PIM_EMULATOR_MODE", argv[++i], 1);
+        } else if (strcmp(argv[i], "-t") == 0 && i + 1 < argc) {
+            setenv("PIM_EMULATOR_NUM_THREADS", argv[++i], 1);
+        } else {
+            print_usage();
+            return -1;
+        }
+    }
+    /* never record the replay itself */
+    unsetenv("PIM_EMULATOR_RECORD");
+
+    PimTraceReader reader;
+    if (reader.open(trace_file) != 0) {
+        printf("fail to open %s\n", trace_file);
+        return -1;
+    }
+
+    std::string rocm_path = ROCM_PATH;
+    PimSimBackend sim;
+    sim.initialize(rocm_path + "/include/dramsim2/ini/HBM2_samsung_2M_16B_x64.ini",
+                   rocm_path + "/include/dramsim2/ini/system_hbm_vega20.ini", 256 * 64 * 2, 64, 1);
+    printf("mode : %s, simulator instances : %d\n", sim.get_mode() == EMULATOR_FUNCTIONAL ? "functional" : "timing",
+           sim.get_num_sims());
+
+    PimTraceEvent event;
+    std::vector<uint8_t> data;
+    std::vector<PimMemTraceData> trace;
+    int num_kernel = 0;
+    double total_ms = 0.0;
+    int ret;
+
+    while ((ret = reader.next_event(&event)) > 0) {
+        if (event.type == TRACE_EVENT_PRELOAD) {
+            data.resize(event.size);
+            if (reader.read_preload(data.data()) != 0) break;
+            sim.preload_data_with_addr(event.addr, data.data(), event.size);
+            continue;
+        }
+
+        trace.resize(event.num_trace);
+        if (reader.read_trace(trace.data(), trace.size()) != (int64_t)trace.size()) break;
+
+        auto start = std::chrono::high_resolution_clock::now();
+        sim.execute_kernel(trace.data(), trace.size());
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - start;
+        total_ms += elapsed.count();
+        printf("kernel %4d : %10zu records %12.3f ms\n", num_kernel++, trace.size(), elapsed.count());
+    }
+    if (ret != 0) {
+        printf("%s is corrupt after %d kernels\n", trace_file, num_kernel);
+        return -1;
+    }
+
+    printf("%d kernels, %.3f ms\n", num_kernel, total_ms);
+    return 0;
+}
+
+int print_info(const char* trace_file)
+{
+    PimTraceReader reader;
+    if (reader.open(trace_file) != 0) {
+        printf("fail to open %s\n", trace_file);
+        return -1;
+    }
+
+    PimTraceEvent event;
+    std::vector<PimMemTraceData> trace(4096);
+    uint64_t num_preload = 0, preload_bytes = 0, num_kernel = 0, num_cmds[4] = {0};
+    const char cmds[] = {'R', 'W', 'O', 'B'};
+    int ret;
+
+    while ((ret = reader.next_event(&event)) > 0) {
+        if (event.type == TRACE_EVENT_PRELOAD) {
+            num_preload++;
+            preload_bytes += event.size;
+            continue;
+        }
+
+        num_kernel++;
+        int64_t num_read;
+        while ((num_read = reader.read_trace(trace.data(), trace.size())) > 0) {
+            for (int64_t i = 0; i < num_read; i++) {
+                num_cmds[strchr(cmds, trace[i].cmd) - cmds]++;
+            }
+        }
+        if (num_read < 0) {
+            ret = -1;
+            break;
+        }
+    }
+    if (ret != 0) {
+        printf("%s is corrupt\n", trace_file);
+        return -1;
+    }
+
+    uint64_t num_trace = num_cmds[0] + num_cmds[1] + num_cmds[2] + num_cmds[3];
+    printf("preloads : %lu (%lu bytes)\n", num_preload, preload_bytes);
+    printf("kernels  : %lu\n", num_kernel);
+    printf("records  : %lu (R %lu, W %lu, O %lu, B %lu)\n", num_trace, num_cmds[0], num_cmds[1], num_cmds[2],
+           num_cmds[3]);
+    printf("records take %lu bytes as PimMemTraceData\n", num_trace * sizeof(PimMemTraceData));
+    return 0;
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc < 3) {
+        print_usage();
+        return -1;
+    }
+
+    if (strcmp(argv[1], "record") == 0 && argc > 3) {
+        return record_trace(argv[2], argv + 3);
+    } else if (strcmp(argv[1], "replay") == 0) {
+        return replay_trace(argv[2], argc - 3, argv + 3);
+    } else if (strcmp(argv[1], "info") == 0) {
+        return print_info(argv[2]);
+    }
+
+    print_usage();
+    return -1;
+}